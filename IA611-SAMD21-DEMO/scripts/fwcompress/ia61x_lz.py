@@ -0,0 +1,160 @@
+"""LZ compressor for IA61x download images (firmware, SysConfig).
+
+Produces a C header in the style of the Bin2Hex output, holding the compressed
+stream as a byte array. The firmware decodes it block by block with
+IA61x_lz_read_block() (src/IA61x_lz.c) while the previous block is on the bus.
+
+Stream format: a flag byte announces the next 8 items, LSB first. A set bit is a
+literal byte, a clear bit a 16 bit little endian match token, bits 0-9 holding
+offset - 1 and bits 10-15 length - 3. The 1 KB window matches IA61x_LZ_WINDOW.
+
+Usage:
+    python ia61x_lz.py <array name> <input .bin or Bin2Hex .h> <output .h>
+
+Example:
+    python ia61x_lz.py VQ_Bin ../../src/IA611/IA611_FW_Bin_SPI.h ../../src/IA611/IA611_FW_Bin_SPI_lz.h
+"""
+
+import os
+import re
+import struct
+import sys
+
+OFFSET_BITS = 10
+WINDOW = 1 << OFFSET_BITS
+MIN_MATCH = 3
+MAX_MATCH = (1 << (16 - OFFSET_BITS)) - 1 + MIN_MATCH
+MAX_CHAIN = 256
+
+
+def load_image(path):
+    """Raw image bytes from a .bin file or a Bin2Hex uint16_t header."""
+    if not path.lower().endswith(".h"):
+        with open(path, "rb") as f:
+            return f.read()
+
+    with open(path, "r") as f:
+        text = f.read()
+    body = text[text.index("{") + 1:text.rindex("}")]
+    words = [int(w, 16) for w in re.findall(r"0x[0-9a-fA-F]+", body)]
+    # The SAMD21 is little endian, the array is streamed as it sits in flash.
+    return struct.pack("<%dH" % len(words), *words)
+
+
+def longest_match(data, pos, chains):
+    best_len, best_off = 0, 0
+    limit = min(MAX_MATCH, len(data) - pos)
+    if limit < MIN_MATCH:
+        return 0, 0
+
+    for cand in reversed(chains.get(data[pos:pos + MIN_MATCH], [])[-MAX_CHAIN:]):
+        if pos - cand > WINDOW:
+            break
+        length = 0
+        while length < limit and data[cand + length] == data[pos + length]:
+            length += 1
+        if length > best_len:
+            best_len, best_off = length, pos - cand
+            if length == limit:
+                break
+    return best_len, best_off
+
+
+def compress(data):
+    out = bytearray()
+    chains = {}
+    items = []
+    pos = 0
+
+    def insert(p):
+        chains.setdefault(data[p:p + MIN_MATCH], []).append(p)
+
+    while pos < len(data):
+        length, offset = longest_match(data, pos, chains)
+        if length >= MIN_MATCH and pos + 1 < len(data):
+            # Lazy evaluation: emit a literal if the next position matches longer.
+            insert(pos)
+            next_len, _ = longest_match(data, pos + 1, chains)
+            chains[data[pos:pos + MIN_MATCH]].pop()
+            if next_len > length + 1:
+                length = 0
+
+        if length >= MIN_MATCH:
+            items.append((offset, length))
+            for p in range(pos, pos + length):
+                insert(p)
+            pos += length
+        else:
+            items.append(data[pos])
+            insert(pos)
+            pos += 1
+
+    for group in range(0, len(items), 8):
+        chunk = items[group:group + 8]
+        flags = 0
+        body = bytearray()
+        for bit, item in enumerate(chunk):
+            if isinstance(item, int):
+                flags |= 1 << bit
+                body.append(item)
+            else:
+                offset, length = item
+                body += struct.pack("<H", (offset - 1) | ((length - MIN_MATCH) << OFFSET_BITS))
+        out.append(flags)
+        out += body
+    return bytes(out)
+
+
+def decompress(stream, raw_size):
+    """Reference decoder, mirrors IA61x_lz_read_block()."""
+    out = bytearray()
+    src = 0
+    flags = bits = 0
+    while len(out) < raw_size:
+        if bits == 0:
+            flags = stream[src]
+            src += 1
+            bits = 8
+        if flags & 1:
+            out.append(stream[src])
+            src += 1
+        else:
+            token = stream[src] | (stream[src + 1] << 8)
+            src += 2
+            offset = (token & (WINDOW - 1)) + 1
+            for _ in range((token >> OFFSET_BITS) + MIN_MATCH):
+                out.append(out[-offset] if offset <= len(out) else 0)
+        flags >>= 1
+        bits -= 1
+    return bytes(out)
+
+
+def write_header(path, name, stream, raw_size, source):
+    with open(path, "w") as f:
+        f.write("/** %s autogen header file, source %s **/\n\n" % (os.path.basename(sys.argv[0]), os.path.basename(source)))
+        f.write("#define %s_LZ_RAW_SIZE %d\n\n" % (name, raw_size))
+        f.write("const uint8_t %s_lz[] = {" % name)
+        for i, b in enumerate(stream):
+            f.write(("\n\t" if i % 16 == 0 else "") + "0x%02x" % b + ("," if i + 1 < len(stream) else ""))
+        f.write("}; /** Size:%d **/\n\n" % len(stream))
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__)
+        sys.exit(-1)
+
+    name, source, target = sys.argv[1:4]
+    data = load_image(source)
+    stream = compress(data)
+
+    if decompress(stream, len(data)) != data:
+        print("Error :: round trip check failed for %s" % source)
+        sys.exit(-1)
+
+    write_header(target, name, stream, len(data), source)
+    print("%s: %d -> %d bytes (%.1f%%)" % (name, len(data), len(stream), 100.0 * len(stream) / len(data)))
+
+
+if __name__ == "__main__":
+    main()
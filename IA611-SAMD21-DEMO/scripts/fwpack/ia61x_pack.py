@@ -0,0 +1,115 @@
+"""Packer for the IA61x image container.
+
+Collects the IA61x download images (firmware program, SysConfig, keyword
+models) into one binary blob. src/IA61x_images.S links the blob into flash with
+.incbin and the drivers look the sections up by ID (src/IA61x_image.c).
+
+Layout, all fields little endian:
+    header   16 bytes   magic "I6FW", version, section count, total size, CRC32 of the table
+    table    20 bytes   per section: id, flags, offset, size, raw size, CRC32
+    payload             sections, each 4 byte aligned
+
+The section CRC32 (zlib polynomial) covers the stored bytes padded with zeros
+to a multiple of 4, which is what the SAMD21 DSU computes. Sections with equal
+stored bytes share one payload. Program and SysConfig images are LZ compressed
+(see scripts/fwcompress) unless --raw is given or compression does not help.
+
+Usage:
+    python ia61x_pack.py [--raw] <output .bin> <SECTION>=<input .bin or Bin2Hex .h> ...
+
+Sections:
+    PROGRAM_UART, PROGRAM_SPI, PROGRAM_I2C, SYSCONFIG, KEYWORD0 .. KEYWORD15
+
+Example:
+    python ia61x_pack.py ../../src/IA611/ia61x_images_uart.bin PROGRAM_UART=../../src/IA611/IA611_FW_Bin_UART.h SYSCONFIG=../../src/IA611/trill_sys_config.h
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "fwcompress"))
+import ia61x_lz
+
+MAGIC = b"I6FW"
+VERSION = 1
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<HHIIII")
+FLAG_LZ = 0x0001
+
+SECTION_IDS = {
+    "PROGRAM_UART": 0x0101,
+    "PROGRAM_SPI": 0x0102,
+    "PROGRAM_I2C": 0x0103,
+    "SYSCONFIG": 0x0200,
+}
+SECTION_IDS.update({"KEYWORD%d" % n: 0x0300 + n for n in range(16)})
+
+# Keyword models go out through WDB as they are, only boot loader images can be compressed.
+COMPRESSIBLE = ("PROGRAM_UART", "PROGRAM_SPI", "PROGRAM_I2C", "SYSCONFIG")
+
+
+def pad4(data):
+    return data + b"\0" * (-len(data) % 4)
+
+
+def crc32(data):
+    return zlib.crc32(pad4(data)) & 0xFFFFFFFF
+
+
+def pack(sections, raw):
+    table = []
+    payload = bytearray()
+    stored = {}
+    offset = HEADER.size + ENTRY.size * len(sections)
+
+    for name, path in sections:
+        data = ia61x_lz.load_image(path)
+        flags = 0
+        blob = data
+        if not raw and name in COMPRESSIBLE:
+            packed = ia61x_lz.compress(data)
+            if len(packed) < len(data):
+                blob, flags = packed, FLAG_LZ
+
+        if blob not in stored:
+            stored[blob] = offset + len(payload)
+            payload += pad4(blob)
+        table.append((SECTION_IDS[name], flags, stored[blob], len(blob), len(data), crc32(blob)))
+        print("%-13s %6d -> %6d bytes at 0x%05x%s" % (name, len(data), len(blob), stored[blob],
+                                                    " (lz)" if flags & FLAG_LZ else ""))
+
+    entries = b"".join(ENTRY.pack(*e) for e in table)
+    total = offset + len(payload)
+    header = HEADER.pack(MAGIC, VERSION, len(table), total, crc32(entries))
+    return header + entries + bytes(payload)
+
+
+def main():
+    args = sys.argv[1:]
+    raw = "--raw" in args
+    args = [a for a in args if a != "--raw"]
+    if len(args) < 2:
+        print(__doc__)
+        sys.exit(-1)
+
+    sections = []
+    for arg in args[1:]:
+        name, _, path = arg.partition("=")
+        if name not in SECTION_IDS or not path:
+            print("Error :: unknown section '%s'" % arg)
+            sys.exit(-1)
+        if any(name == s[0] for s in sections):
+            print("Error :: section %s given twice" % name)
+            sys.exit(-1)
+        sections.append((name, path))
+
+    image = pack(sections, raw)
+    with open(args[0], "wb") as f:
+        f.write(image)
+    print("%s: %d bytes, %d sections" % (args[0], len(image), len(sections)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,207 @@
+"""Compiler for IA61x route programs.
+
+Turns a route description (the command sequence of a VoiceWake or preset) into a
+checked table of 16 bit words, written as a C header in the style of the
+Bin2Hex output. The driver runs the table with IA61x_route_run()
+(src/IA61x_route.c), which checks it and sends it as one cmd_batch.
+
+Table layout, 16 bit words:
+    header   4 words    magic 0x5052 ("RP"), version, step count, check
+    step     4 words    command, data, expected response, flags << 8 | timeout
+
+The check is the one's complement of the 16 bit sum of all step words. Flags
+are the IA61x_BATCH_xxx bits of IA61x.h plus IA61x_ROUTE_SHADOW, set by the
+'shadow' option: the step is left out if the parameter shadow says IA61x already
+has the value. A route stop, route selection or preset resets the algorithm
+parameters, so 'shadow' is refused on any step after one of them.
+
+Route description, one step per line, '#' starts a comment:
+    <command> <data> [expect=<word>] [timeout=<n>] [any] [optional] [stop] [noresp] [shadow]
+    ALGO_PARAM <parameter id> <value> [shadow]
+
+<command> is a name from COMMANDS or a command word like 0x8033. The expected
+response defaults to the data word. ALGO_PARAM expands to SET_ALGO_PARAM_ID and
+a chained SET_ALGO_PARAM. 'shadow' is only taken by SET_DIGITAL_GAIN and
+ALGO_PARAM.
+
+Usage:
+    python ia61x_route.py <array name> <input .route> <output .h>
+
+Example:
+    python ia61x_route.py VOICEWAKE_ROUTE routes/voicewake_i2c.route ../../src/IA611/route_voicewake_i2c.h
+"""
+
+import os
+import sys
+
+MAGIC = 0x5052
+VERSION = 1
+MAX_STEPS = 24              # IA61x_ROUTE_MAX_STEPS
+
+# Keep in sync with IA61x.h
+BATCH_NO_RESP = 0x01
+BATCH_ANY_RESP = 0x02
+BATCH_CHAINED = 0x04
+BATCH_OPTIONAL = 0x08
+BATCH_STOP = 0x10
+ROUTE_SHADOW = 0x80
+CMD_NO_RESP_MASK = 0x9000
+
+COMMANDS = {
+    "SYNC": 0x8000,
+    "SET_DIGITAL_GAIN": 0x8015,
+    "SET_ALGO_PARAM_ID": 0x8017,
+    "SET_ALGO_PARAM": 0x8018,
+    "SET_EVENT_RESP": 0x801A,
+    "SAMPLE_RATE": 0x8030,
+    "SET_PRESET": 0x8031,
+    "SELECT_ROUTE": 0x8032,
+    "STOP_ROUTE": 0x8033,
+    "BUFF_DATA_FMT": 0x8034,
+    "FRAME_SIZE": 0x8035,
+    "LOW_POWER_MODE": 0x9010,
+}
+NAMES = {v: k for k, v in COMMANDS.items()}
+
+OPTION_FLAGS = {"any": BATCH_ANY_RESP, "optional": BATCH_OPTIONAL, "stop": BATCH_STOP, "noresp": BATCH_NO_RESP,
+                "shadow": ROUTE_SHADOW}
+
+# Commands after which IA61x runs with default algorithm parameters
+RESETS = (COMMANDS["STOP_ROUTE"], COMMANDS["SELECT_ROUTE"], COMMANDS["SET_PRESET"])
+
+
+class RouteError(Exception):
+    pass
+
+
+def word(text):
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise RouteError("'%s' is not a number" % text)
+    if not 0 <= value <= 0xFFFF:
+        raise RouteError("'%s' does not fit 16 bits" % text)
+    return value
+
+
+def command(text):
+    if text.upper() in COMMANDS:
+        return COMMANDS[text.upper()]
+    value = word(text)
+    if not value & 0x8000:
+        raise RouteError("0x%04x is not a command word" % value)
+    return value
+
+
+def parse_step(tokens):
+    cmd, data = command(tokens[0]), word(tokens[1])
+    step = {"cmd": cmd, "data": data, "expect": data, "flags": 0, "timeout": 1}
+
+    for opt in tokens[2:]:
+        key, _, value = opt.partition("=")
+        if key == "expect" and value:
+            step["expect"] = word(value)
+        elif key == "timeout" and value:
+            step["timeout"] = word(value)
+            if not 1 <= step["timeout"] <= 255:
+                raise RouteError("timeout must be 1 .. 255")
+        elif opt in OPTION_FLAGS:
+            step["flags"] |= OPTION_FLAGS[opt]
+        else:
+            raise RouteError("unknown option '%s'" % opt)
+
+    if (cmd & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK:
+        step["flags"] |= BATCH_NO_RESP
+    if (step["flags"] & ROUTE_SHADOW) and cmd != COMMANDS["SET_DIGITAL_GAIN"]:
+        raise RouteError("'shadow' is only taken by SET_DIGITAL_GAIN and ALGO_PARAM")
+    return step
+
+
+def parse(path):
+    steps = []
+    with open(path, "r") as f:
+        for number, line in enumerate(f, 1):
+            tokens = line.split("#", 1)[0].split()
+            if not tokens:
+                continue
+            try:
+                if tokens[0].upper() == "ALGO_PARAM":
+                    if len(tokens) not in (3, 4) or tokens[3:] not in ([], ["shadow"]):
+                        raise RouteError("ALGO_PARAM takes a parameter id, a value and optionally 'shadow'")
+                    param = parse_step(["SET_ALGO_PARAM_ID", tokens[1]])
+                    value = parse_step(["SET_ALGO_PARAM", tokens[2]])
+                    value["flags"] |= BATCH_CHAINED
+                    if tokens[3:]:
+                        param["flags"] |= ROUTE_SHADOW
+                        value["flags"] |= ROUTE_SHADOW
+                    steps += [param, value]
+                    continue
+                if len(tokens) < 2:
+                    raise RouteError("a step needs a command and a data word")
+                steps.append(parse_step(tokens))
+            except RouteError as e:
+                raise RouteError("%s:%d: %s" % (os.path.basename(path), number, e))
+    return steps
+
+
+def validate(steps):
+    if not steps:
+        raise RouteError("route has no steps")
+    if len(steps) > MAX_STEPS:
+        raise RouteError("route has %d steps, at most %d fit" % (len(steps), MAX_STEPS))
+    reset = None
+    for i, step in enumerate(steps):
+        # The shadow predates the reset, a skip would leave the default in place
+        if (step["flags"] & ROUTE_SHADOW) and reset is not None:
+            raise RouteError("step %d: 'shadow' after %s at step %d" % (i, NAMES[steps[reset]["cmd"]], reset))
+        if (step["cmd"] & ~(CMD_NO_RESP_MASK & ~0x8000)) in RESETS:
+            reset = i
+        # A parameter value only lands on the ID selected right before it
+        if step["cmd"] == COMMANDS["SET_ALGO_PARAM"]:
+            if i == 0 or steps[i - 1]["cmd"] != COMMANDS["SET_ALGO_PARAM_ID"]:
+                raise RouteError("step %d: SET_ALGO_PARAM must follow SET_ALGO_PARAM_ID" % i)
+            step["flags"] |= BATCH_CHAINED
+            if steps[i - 1]["flags"] & ROUTE_SHADOW:
+                step["flags"] |= ROUTE_SHADOW
+
+
+def assemble(steps):
+    words = []
+    for step in steps:
+        words += [step["cmd"], step["data"], step["expect"], (step["flags"] << 8) | step["timeout"]]
+    check = ~sum(words) & 0xFFFF
+    return [MAGIC, VERSION, len(steps), check] + words
+
+
+def write_header(path, name, steps, table, source):
+    with open(path, "w") as f:
+        f.write("/** %s autogen header file, source %s **/\n\n" % (os.path.basename(sys.argv[0]), os.path.basename(source)))
+        f.write("const uint16_t %s[] = {\n" % name)
+        f.write("\t0x%04x,0x%04x,0x%04x,0x%04x,\n" % tuple(table[:4]))
+        for i, step in enumerate(steps):
+            w = table[4 + 4 * i:8 + 4 * i]
+            f.write("\t0x%04x,0x%04x,0x%04x,0x%04x%s  /* %s */\n" % (w[0], w[1], w[2], w[3], "," if i + 1 < len(steps) else " ",
+                                                                 NAMES.get(step["cmd"], "0x%04x" % step["cmd"])))
+        f.write("}; /** Steps:%d **/\n" % len(steps))
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__)
+        sys.exit(-1)
+
+    name, source, target = sys.argv[1:4]
+    try:
+        steps = parse(source)
+        validate(steps)
+    except RouteError as e:
+        print("Error :: %s" % e)
+        sys.exit(-1)
+
+    table = assemble(steps)
+    write_header(target, name, steps, table, source)
+    print("%s: %d steps, %d bytes" % (name, len(steps), 2 * len(table)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+"""Decoder for the IA61x bus trace export.
+
+The demo sends its bus trace ring (src/IA61x_trace.c) as binary when 'b' is
+typed on the EDBG console. This script either captures it from the COM port or
+reads a capture saved to a file, and prints one line per transaction.
+
+Export layout, little endian:
+    header   16 bytes   magic "TRCE" (0x54524345), version, entry size,
+                        entries recorded, entries that follow
+    entry    12 bytes   timestamp us, command word, data word, length,
+                        op, status
+
+Usage:
+    python ia61x_trace.py <COM port>        capture from the demo
+    python ia61x_trace.py <file.bin>        decode a saved capture
+
+Example:
+    python ia61x_trace.py COM5
+"""
+
+import os
+import struct
+import sys
+
+MAGIC = 0x54524345
+VERSION = 1
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<IHHHBb")
+
+# Keep in sync with IA61x_trace_op in IA61x_trace.h
+RX = 0x80
+OPS = {
+    0x00: "boot",
+    0x01: "cmd",
+    0x02: "put",
+    0x03: "wdb",
+    RX | 0x01: "resp",
+    RX | 0x02: "get",
+    RX | 0x03: "rdb",
+}
+
+
+def capture(port):
+    import serial
+
+    with serial.Serial(port, 115200, timeout=2) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"b")
+        data = ser.read(HEADER.size)
+        if len(data) < HEADER.size:
+            sys.exit("No answer on %s" % port)
+        count = HEADER.unpack(data)[4]
+        data += ser.read(count * ENTRY.size)
+    return data
+
+
+def decode(data):
+    if len(data) < HEADER.size:
+        sys.exit("Capture too short")
+
+    magic, version, entry_size, head, count = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or entry_size != ENTRY.size:
+        sys.exit("Not an IA61x bus trace (magic 0x%08X, version %d)" % (magic, version))
+    if len(data) < HEADER.size + count * entry_size:
+        sys.exit("Capture holds fewer than %d entries" % count)
+
+    print("Bus trace, %d transactions, last %d" % (head, count))
+    print("%8s %2s %-4s %6s %6s %6s %6s %10s %10s"
+          % ("#", "", "op", "word", "data", "len", "status", "at us", "delta us"))
+
+    prev = None
+    for i in range(count):
+        us, word, value, length, op, status = ENTRY.unpack_from(data, HEADER.size + i * entry_size)
+        if prev is None or op == 0x00:
+            prev = us
+        print("%8d %2s %-4s 0x%04X 0x%04X %6d %6d %10d %10d"
+              % (head - count + i, "rx" if op & RX else "tx", OPS.get(op, "?"),
+                 word, value, length, status, us, (us - prev) & 0xFFFFFFFF))
+        prev = us
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.exit(__doc__)
+
+    if os.path.isfile(argv[1]):
+        with open(argv[1], "rb") as f:
+            data = f.read()
+    else:
+        data = capture(argv[1])
+
+    decode(data)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,4853 @@
+/** ia61x_lz.py autogen header file, source IA611_FW_Bin_SPI.h **/
+
+#define VQ_Bin_LZ_RAW_SIZE 88368
+
+const uint8_t VQ_Bin_lz[] = {
+	0xff,0x41,0x55,0x44,0x49,0x45,0x4e,0x43,0x45,0xff,0x00,0x02,0x00,0x00,0xe0,0x2d,
+	0xfe,0x62,0xff,0x07,0x00,0x00,0x00,0xc4,0x09,0x60,0x20,0xfd,0x10,0x07,0x00,0x90,
+	0x28,0x00,0x20,0xe7,0x80,0xfb,0x06,0x20,0x0a,0x00,0x00,0x01,0x01,0x56,0x65,0xff,
+	0x72,0x3a,0x45,0x58,0x50,0x5f,0x49,0x41,0xff,0x36,0x31,0x30,0x5f,0x41,0x31,0x31,
+	0x30,0x77,0x2e,0x39,0x39,0x02,0x00,0x5f,0x42,0x39,0x00,0x04,0x7f,0x5f,0x4b,0x4e,
+	0x5f,0x56,0x51,0x00,0x00,0x34,0xfb,0x5e,0x0b,0x04,0x00,0x29,0x00,0x20,0x09,0x03,
+	0xff,0x38,0x09,0x00,0x07,0x0b,0x05,0xe0,0x08,0xfb,0x07,0x80,0x4f,0x08,0x3e,0x02,
+	0x3e,0x04,0x18,0xef,0x05,0x02,0x01,0x00,0x07,0x08,0x03,0x10,0x10,0xff,0x00,0x11,
+	0x11,0x00,0x12,0x12,0x00,0x13,0xff,0x13,0x00,0x14,0x14,0x00,0x15,0x15,0x00,0xdf,
+	0x16,0x0c,0x00,0x17,0x0d,0x47,0x18,0x18,0x19,0x57,0x60,0x20,0x6c,0x03,0x00,0x2c,
+	0x03,0x00,0x54,0x03,0x00,0x5f,0x4c,0x1a,0x60,0x20,0x74,0x03,0x00,0xac,0x03,0x00,
+	0xfd,0xd0,0x03,0x00,0x58,0x1b,0x60,0x20,0x08,0x1c,0x37,0x60,0x20,0x70,0x03,0x00,
+	0x74,0x1d,0x17,0x00,0x07,0x00,0xf5,0x28,0x07,0x00,0xbc,0x03,0x00,0x98,0x1e,0x60,
+	0x20,0xd5,0xb4,0x03,0x00,0xcc,0x03,0x00,0xe4,0x03,0x00,0x04,0x1f,0x57,0x60,0x20,
+	0x20,0x03,0x00,0x3c,0x03,0x00,0x88,0x03,0x00,0x7d,0xac,0x03,0x00,0x00,0x20,0x60,
+	0x20,0x80,0x03,0x00,0xd5,0xb0,0x03,0x00,0xcc,0x03,0x00,0xe8,0x03,0x00,0x60,0x21,
+	0x57,0x60,0x20,0x7c,0x03,0x00,0x98,0x03,0x00,0xac,0x03,0x00,0xd5,0x18,0x13,0x00,
+	0xc8,0x07,0x00,0xf0,0x6b,0x00,0x80,0x83,0xff,0x00,0x00,0x83,0x83,0x01,0x00,0x0b,
+	0x83,0xff,0x0b,0x00,0x8c,0x83,0x0c,0x00,0x8d,0x83,0xff,0x0d,0x00,0x0e,0x83,0x02,
+	0x00,0x10,0x83,0xff,0x03,0x00,0x1a,0x83,0x04,0x00,0x20,0x83,0xff,0x05,0x00,0x21,
+	0x83,0x06,0x00,0x24,0x83,0xff,0x07,0x00,0xae,0x83,0x08,0x00,0xad,0x83,0xff,0x23,
+	0x00,0xaf,0x83,0x09,0x00,0xb1,0x83,0xff,0x0e,0x00,0x6d,0x83,0x0a,0x00,0xc0,0x83,
+	0xff,0x15,0x00,0xd2,0x83,0x16,0x00,0x22,0x83,0xff,0x17,0x00,0x9c,0x83,0x18,0x00,
+	0xc6,0x83,0xff,0x1d,0x00,0xc9,0x83,0x1e,0x00,0xca,0x83,0xff,0x1f,0x00,0xcb,0x83,
+	0x20,0x00,0xef,0x83,0xff,0x21,0x00,0xc2,0x83,0x19,0x00,0xc4,0x83,0xff,0x1a,0x00,
+	0xa5,0x86,0x00,0x00,0xa8,0x86,0xff,0x01,0x00,0xa6,0x84,0x00,0x00,0xaa,0x84,0xff,
+	0x01,0x00,0x6e,0x84,0x02,0x00,0xbc,0x84,0xff,0x03,0x00,0x3a,0x84,0x04,0x00,0xbb,
+	0x84,0xff,0x05,0x00,0x4e,0x84,0x07,0x00,0x16,0x85,0xff,0x00,0x00,0x97,0x85,0x01,
+	0x00,0x98,0x85,0xff,0x02,0x00,0x27,0x85,0x03,0x00,0xec,0x85,0xff,0x04,0x00,0x13,
+	0x81,0x02,0x00,0x14,0x81,0x7f,0x03,0x00,0x95,0x81,0x04,0x00,0x1d,0x03,0x00,0xff,
+	0xb0,0x81,0x07,0x00,0xb2,0x81,0x00,0x00,0xff,0xb3,0x81,0x01,0x00,0xb4,0x81,0x05,
+	0x00,0xff,0xb5,0x81,0x06,0x00,0x48,0x81,0x0a,0x00,0xff,0xcf,0x81,0x0b,0x00,0xb6,
+	0x0e,0x00,0x00,0xff,0xb7,0x0e,0x01,0x00,0xb8,0x0e,0x02,0x00,0xff,0x39,0x0e,0x03,
+	0x00,0xf2,0x83,0x0f,0x00,0xff,0xf3,0x83,0x10,0x00,0x74,0x83,0x11,0x00,0xff,0x75,
+	0x83,0x12,0x00,0xf6,0x83,0x13,0x00,0xff,0xf7,0x83,0x14,0x00,0x91,0x89,0x00,0x00,
+	0xff,0xbe,0x83,0x1b,0x00,0xbd,0x83,0x1c,0x00,0xef,0xa3,0x83,0x22,0x00,0x00,0x54,
+	0x40,0x1f,0x00,0x7f,0x00,0x80,0x3e,0x00,0x00,0xc0,0x5d,0x0c,0x00,0xf5,0x7d,0x0b,
+	0x00,0xbb,0x07,0x00,0x77,0x01,0x00,0x00,0xf7,0xee,0x02,0x00,0x00,0x88,0x01,0x02,
+	0x03,0x01,0xfe,0x0f,0x24,0x0a,0x40,0x02,0x01,0x0c,0x22,0x03,0xff,0x24,0x02,0x24,
+	0x06,0x24,0x25,0x07,0x00,0xff,0x10,0x10,0x01,0x50,0x08,0x00,0x05,0x50,0xf5,0x0c,
+	0x03,0x00,0x20,0x0b,0x00,0x10,0x00,0x02,0x50,0xf5,0x00,0x07,0x00,0x04,0x0f,0x00,
+	0x04,0x10,0x06,0x50,0xaf,0xfe,0xff,0xff,0xff,0xcb,0x06,0x08,0x03,0x00,0x16,0x92,
+	0x03,0x00,0xf7,0x0f,0x00,0x4f,0x04,0xfb,0x07,0x00,0x81,0x04,0xe0,0x7a,0x07,0x00,
+	0x04,0x07,0x00,0xff,0x6b,0xfe,0xff,0xe0,0x06,0x2a,0x2f,0x74,0x05,0x03,0x00,0x14,
+	0x03,0x00,0xe5,0x37,0x30,0x00,0x14,0xd2,0x2f,0x04,0x06,0xb6,0x04,0x03,0x00,0x17,
+	0x10,0x04,0x80,0x01,0xa5,0x00,0x43,0x07,0x1f,0x37,0x10,0x33,0x04,0x12,0x03,0x00,
+	0x9b,0x7a,0x27,0x00,0x21,0x3f,0x04,0xeb,0xff,0xff,0x00,0x77,0x70,0xf9,0x22,0x5f,
+	0x30,0x37,0x04,0x0b,0x0b,0x0d,0x0d,0x0d,0xc3,0x0e,0x0f,0x07,0x20,0x00,0x00,0x07,
+	0x00,0x00,0x34,0x0c,0x01,0x8b,0x07,0x00,0x32,0x00,0xff,0x0f,0x14,0x0b,0x24,0x1f,
+	0x08,0x10,0xf3,0x14,0x18,0x11,0x2c,0x00,0x2c,0x07,0x02,0x00,0x06,0xbb,0x0c,0x03,
+	0x43,0xf0,0x81,0x00,0x07,0x87,0x04,0x0d,0xd9,0x02,0x47,0x1c,0x43,0x3c,0x0d,0x11,
+	0x45,0x64,0x07,0x80,0xdb,0x00,0x08,0xcb,0x34,0x08,0x05,0x0f,0x2c,0x0c,0x08,0x5c,
+	0x85,0x64,0x73,0x00,0x62,0x00,0x29,0x43,0x38,0x06,0x43,0xb8,0xe3,0x2a,0x00,0x00,
+	0xfc,0x63,0x18,0x1f,0x07,0x00,0x00,0xe8,0xe9,0x59,0x23,0x07,0x07,0x00,0x5b,0x27,
+	0x0b,0x00,0xee,0x5c,0x74,0x2b,0x07,0x0f,0x00,0x5d,0x2f,0x0b,0x00,0xee,0x5e,0x33,
+	0x0b,0xb7,0x00,0xee,0x60,0x37,0x0f,0xee,0x62,0x3f,0x14,0x01,0xbf,0x00,0xf5,0x0f,
+	0x08,0x04,0x0f,0x07,0x00,0xfb,0xaa,0x07,0x00,0x1f,0x07,0x00,0xfe,0x07,0x00,0x3f,
+	0x07,0x00,0xf9,0xaa,0x07,0x00,0x17,0x07,0x00,0xfd,0x07,0x00,0x2f,0x07,0x00,0xff,
+	0xfa,0x07,0x00,0x5f,0x27,0x40,0x00,0x10,0x0c,0x04,0x7f,0xaa,0x17,0x10,0x0f,0x17,
+	0x10,0x1f,0x17,0x10,0x3f,0x3f,0x10,0x17,0xcc,0x3f,0x10,0x47,0x04,0x00,0x10,0x47,
+	0x0c,0x27,0x34,0x00,0x10,0x45,0x06,0x47,0x08,0xff,0x47,0x10,0x27,0x04,0x1f,0x0c,
+	0x04,0x1f,0x00,0x95,0x03,0x17,0x08,0x17,0x07,0x08,0x04,0x47,0x00,0x07,0x04,0x02,
+	0x88,0x47,0x08,0x27,0x2c,0x07,0x04,0x02,0x47,0x08,0x17,0x04,0x47,0x0c,0x04,0xaa,
+	0x1f,0x10,0x02,0x47,0x10,0x04,0x47,0x10,0x02,0x47,0x10,0x01,0x10,0x47,0x10,0x27,
+	0x24,0x0f,0x0c,0x3f,0x0c,0x02,0x17,0x00,0x2f,0x0c,0x37,0x0c,0xc1,0x01,0xc7,0x10,
+	0x17,0x04,0x47,0x1d,0x3f,0x24,0x17,0x24,0xfa,0x0f,0xb5,0x03,0x17,0x10,0x0e,0x37,
+	0x10,0x07,0x06,0x0f,0x0c,0x07,0x76,0x17,0x10,0x01,0x0e,0x2f,0x1c,0x03,0x00,0xfc,
+	0x5f,0x00,0x8e,0x17,0x0c,0x03,0x07,0x1f,0xfc,0x49,0xc9,0x05,0xc5,0x05,0x03,0xfa,
+	0xd7,0x06,0x0f,0x23,0x2c,0x0f,0x01,0x07,0x01,0xff,0xb9,0x00,0x93,0x02,0x01,0x08,
+	0x0b,0x02,0x0b,0x0f,0x00,0x0b,0xfa,0x0f,0x00,0x03,0x35,0x00,0x0f,0x02,0x07,0x02,
+	0xff,0xf5,0x03,0x1f,0x00,0x03,0x1b,0x04,0x17,0x02,0x0b,0x02,0xe3,0x0f,0x01,0x1f,
+	0x04,0x1d,0x04,0x0f,0x04,0x0f,0x02,0x17,0x3f,0x01,0x07,0x02,0x03,0x02,0x03,0x21,
+	0x04,0x01,0x30,0xf7,0x17,0x02,0x11,0x2f,0x00,0x0b,0x01,0x05,0x01,0x3a,0x8b,0x2c,
+	0x1f,0x35,0x00,0xff,0x03,0x0f,0x53,0x10,0x2b,0x0c,0x34,0xa8,0x2a,0x0f,0x00,0x0b,
+	0x21,0x00,0x05,0x02,0x4b,0x1c,0x1f,0x34,0xe3,0x17,0x02,0x23,0x0c,0x1f,0x44,0x93,
+	0x00,0x02,0x1f,0x02,0xd1,0xff,0x00,0x10,0x2f,0x04,0xc3,0x04,0x0f,0x13,0x10,0x00,
+	0x00,0xaf,0xc8,0x89,0x60,0x20,0x03,0x04,0xe8,0x03,0x10,0x41,0xff,0x4c,0x47,0x4f,
+	0x5f,0x4c,0x41,0x42,0x45,0xff,0x4c,0x3a,0x20,0x4b,0x4e,0x5f,0x45,0x78,0xff,0x31,
+	0x5f,0x31,0x2e,0x30,0x2e,0x31,0x38,0xe6,0x50,0x14,0x5c,0x30,0x4b,0x39,0x00,0x04,
+	0x54,0xf8,0xff,0xe9,0xff,0x03,0x24,0x13,0x04,0x55,0x07,0x00,0x01,0x02,0x03,0xff,
+	0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0xff,0x0c,0x0d,0x0e,0x0f,0x10,0x11,0x12,
+	0x13,0xff,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0xff,0x1c,0x1d,0x1e,0x1f,0x20,
+	0x95,0x42,0xdd,0xff,0xb7,0x64,0x00,0x1f,0xb8,0x31,0x86,0x3c,0xff,0xb8,0x03,0x15,
+	0x3e,0xb8,0xe5,0x3c,0x1e,0xff,0xb8,0x04,0xba,0xb9,0xb7,0x2b,0xe9,0x90,0xff,0x9f,
+	0xa4,0xa2,0xd8,0x37,0x27,0x62,0x57,0xff,0x38,0x22,0x18,0x97,0x38,0xce,0x44,0xaf,
+	0xff,0x38,0x68,0x37,0xad,0x38,0x9b,0x92,0x8d,0xff,0x38,0xec,0x5f,0x23,0x38,0x20,
+	0xa9,0x9c,0xff,0xa0,0xed,0xe1,0x38,0xb8,0x34,0x55,0xb5,0xff,0xb8,0xa4,0x33,0xfb,
+	0xb8,0x6c,0xf8,0x0f,0xff,0xb9,0xfd,0xb2,0x0c,0xb9,0x64,0x93,0xe3,0xff,0xb8,0x09,
+	0x02,0x82,0xb8,0x53,0x39,0x94,0xff,0x21,0x38,0x71,0x90,0x38,0x33,0x78,0x0c,0xff,
+	0x39,0x84,0x06,0x41,0x39,0x7c,0x8e,0x5b,0xff,0x39,0xa0,0xfe,0x54,0x39,0x53,0x0c,
+	0x2b,0xff,0x39,0x92,0x1e,0xc2,0x38,0x0e,0xe3,0x24,0xff,0xa1,0xb3,0xf6,0xd4,0xb8,
+	0x2a,0xe1,0x4d,0xff,0xb9,0x0a,0xa6,0x8c,0xb9,0x97,0x1a,0x9f,0xff,0xb9,0xb4,0x88,
+	0x99,0xb9,0x1c,0x57,0x75,0xff,0xb9,0x5f,0x88,0x0a,0xb9,0x5a,0x48,0x1c,0xff,0xa1,
+	0x5d,0x91,0x16,0x39,0x2f,0xea,0x90,0xff,0x39,0xd6,0x26,0xc5,0x39,0xa4,0x18,0xde,
+	0xff,0x39,0xd7,0x75,0xd5,0x39,0xd0,0xe2,0xa9,0xff,0x39,0x43,0x21,0x3f,0x39,0x62,
+	0x19,0x8f,0xff,0xa1,0x05,0x3d,0x4e,0xb9,0x72,0xcf,0xc5,0xff,0xb9,0x32,0x1b,0x06,
+	0xba,0x00,0x95,0x16,0xff,0xba,0xcf,0x44,0x10,0xba,0x4b,0xee,0xe4,0xff,0xb9,0xc9,
+	0x64,0x80,0xb9,0x75,0xd2,0x83,0xff,0x22,0x8d,0xbf,0x89,0x39,0x3b,0xc1,0x03,0xff,
+	0x3a,0xf6,0x2a,0x32,0x3a,0xbc,0x88,0x47,0xff,0x3a,0x9d,0xae,0x3e,0x3a,0x6a,0xea,
+	0x16,0xff,0x3a,0xea,0xde,0xa8,0x39,0xa2,0x18,0xdc,0xff,0xa1,0xb2,0x55,0xb4,0xb9,
+	0x8f,0x1a,0x2c,0xff,0xba,0x93,0x39,0x68,0xba,0x08,0xc3,0x81,0xff,0xba,0xd5,0x7f,
+	0x77,0xba,0xa6,0x7d,0x43,0xff,0xba,0x67,0x52,0xda,0xb9,0x64,0x64,0x22,0xff,0xa2,
+	0xd8,0x44,0xe8,0x39,0xae,0x44,0x5d,0xff,0x3a,0x43,0x05,0x95,0x3a,0x32,0x41,0xa6,
+	0xff,0x3a,0x05,0x4a,0x9e,0x3a,0xc3,0xa6,0x79,0xff,0x3a,0xa0,0x2f,0x0b,0x3a,0xe4,
+	0xf5,0x1a,0xff,0xa2,0xa9,0xa2,0x13,0xba,0x45,0x71,0x8c,0xff,0xba,0xed,0xe8,0xbc,
+	0xba,0xa4,0x79,0xd2,0xff,0xba,0xb2,0x21,0xc8,0xba,0x04,0xa0,0x9d,0xff,0xba,0xf2,
+	0x8b,0x2f,0xba,0x54,0xb8,0x22,0xff,0x23,0x4d,0xc7,0x39,0x3a,0x7d,0x89,0xb0,0xff,
+	0x3a,0x3e,0x37,0xed,0x3a,0x62,0x04,0x04,0xff,0x3b,0x4d,0xd2,0xfa,0x3a,0xf4,0x5e,
+	0xc5,0xff,0x3a,0x98,0x9f,0x5b,0x3a,0x1b,0x5c,0x4b,0xff,0xa2,0xdf,0x0e,0x68,0xba,
+	0x16,0x5b,0xdc,0xff,0xba,0xbd,0xf2,0x13,0xbb,0x46,0x92,0x24,0xff,0xbb,0xd9,0x3e,
+	0x1c,0xbb,0xa8,0xc4,0xf5,0xff,0xba,0x43,0xac,0x88,0xba,0x0a,0xb2,0x63,0xff,0x22,
+	0x51,0x4b,0x90,0x3a,0x12,0xf9,0x08,0xff,0x3b,0xf0,0xe0,0x37,0x3b,0x8a,0x7e,0x4c,
+	0xff,0x3b,0x02,0x1e,0x42,0x3b,0x52,0xa7,0x18,0xff,0x3b,0x76,0xc6,0xa9,0x3a,0xb2,
+	0x6b,0x7b,0xff,0xa2,0x7a,0x42,0xb3,0xba,0x5e,0x30,0x2a,0xff,0xbb,0x8d,0x84,0x64,
+	0xbb,0xb1,0x35,0x7e,0xff,0xbb,0x2e,0x65,0x71,0xbb,0x15,0xea,0x3d,0xff,0xbb,0x7c,
+	0x52,0xd3,0xba,0xbd,0xfe,0x88,0xff,0x22,0xa6,0x68,0xdf,0x3a,0xe7,0x43,0x54,0xff,
+	0x3b,0xfd,0xa0,0x8e,0x3b,0x9b,0xd0,0x9e,0xff,0x3b,0xa3,0xf7,0x96,0x3b,0x33,0xd1,
+	0x6d,0xff,0x3b,0xd7,0x7a,0x04,0x3b,0xaf,0x6e,0x93,0xff,0xa2,0x38,0x76,0x0c,0xbb,
+	0x82,0xac,0x85,0xff,0xbb,0x8e,0xf5,0xb3,0xbb,0x10,0xc4,0xc8,0xff,0xbb,0xa3,0x3d,
+	0xbf,0xbb,0x68,0xf7,0x96,0xff,0xbb,0x08,0x9a,0x28,0xbb,0xd1,0xc3,0x9c,0xff,0x22,
+	0x5f,0xb9,0x33,0x3b,0x6f,0x8d,0xab,0xff,0x3b,0x11,0xb3,0xe7,0x3b,0x6a,0xb1,0x01,
+	0xff,0x3c,0xa6,0x00,0xf8,0x3b,0x91,0x8f,0xc4,0xff,0x3b,0x89,0x78,0x5c,0x3b,0xc1,
+	0xc1,0xa4,0xff,0xa2,0x7e,0x4a,0x6d,0xbb,0x9a,0xb9,0xe3,0xff,0xbb,0xd5,0xad,0x1a,
+	0xbc,0x6c,0x40,0x2e,0xff,0xbc,0xe6,0xbc,0x27,0xbc,0xaa,0xec,0x05,0xff,0xbc,0x6b,
+	0x6a,0x97,0xbb,0xc1,0x33,0xab,0xff,0x22,0xc9,0xef,0xa5,0x3b,0xe2,0xe3,0x20,0xff,
+	0x3c,0x24,0x08,0x5d,0x3c,0x80,0x15,0x7c,0xff,0x3c,0xd3,0xf7,0x75,0x3c,0x48,0x57,
+	0x47,0xff,0x3c,0x56,0x23,0xe5,0x3b,0x9d,0xee,0xaf,0xff,0xa2,0x89,0x8d,0x02,0xbc,
+	0x91,0x8c,0x81,0xff,0xbc,0xd9,0xb3,0xb6,0xbc,0xb8,0xb0,0xd6,0xff,0xbc,0x56,0xcd,
+	0xd8,0xbc,0x0a,0xda,0xb6,0xff,0xbc,0x33,0x43,0x5c,0xbc,0x4b,0xd2,0xb2,0xff,0x22,
+	0x53,0xfb,0x8d,0x3c,0x77,0x34,0x19,0xff,0x3d,0x1e,0x6e,0x70,0x3d,0x19,0xc6,0xa2,
+	0xff,0x3d,0x4b,0xa1,0xc8,0x3d,0x4f,0x6e,0xe6,0xff,0x3d,0xde,0x7a,0xf9,0x3d,0xfa,
+	0x03,0x00,0x01,0x3e,0x07,0x04,0x0f,0x04,0x17,0x04,0x1f,0x04,0x27,0x04,0x2f,0x04,
+	0x37,0x04,0x00,0x3f,0x04,0x47,0x04,0x4f,0x04,0x57,0x04,0x5f,0x04,0x67,0x04,0x6f,
+	0x04,0x77,0x04,0x00,0x7f,0x04,0x87,0x04,0x8f,0x04,0x97,0x04,0x9f,0x04,0xa7,0x04,
+	0xaf,0x04,0xb7,0x04,0x00,0xbf,0x04,0xc7,0x04,0xcf,0x04,0xd7,0x04,0xdf,0x04,0xe7,
+	0x04,0xef,0x04,0xf7,0x04,0x00,0xff,0x04,0x07,0x05,0x0f,0x05,0x17,0x05,0x1f,0x05,
+	0x27,0x05,0x2f,0x05,0x37,0x05,0x00,0x3f,0x05,0x47,0x05,0x4f,0x05,0x57,0x05,0x5f,
+	0x05,0x67,0x05,0x6f,0x05,0x77,0x05,0x00,0x7f,0x05,0x87,0x05,0x8f,0x05,0x97,0x05,
+	0x9f,0x05,0xa7,0x05,0xaf,0x05,0xb7,0x05,0x00,0xbf,0x05,0xc7,0x05,0xcf,0x05,0xd7,
+	0x05,0xdf,0x05,0xe7,0x05,0xef,0x05,0xf7,0x05,0x00,0xff,0x05,0x07,0x06,0x0f,0x06,
+	0x17,0x06,0x1f,0x06,0x27,0x06,0x2f,0x06,0x37,0x06,0x00,0x3f,0x06,0x47,0x06,0x4f,
+	0x06,0x57,0x06,0x5f,0x06,0x67,0x06,0x6f,0x06,0x77,0x06,0x00,0x7f,0x06,0x87,0x06,
+	0x8f,0x06,0x97,0x06,0x9f,0x06,0xa7,0x06,0xaf,0x06,0xb7,0x06,0x00,0xbf,0x06,0xc7,
+	0x06,0xcf,0x06,0xd7,0x06,0xdf,0x06,0xe7,0x06,0xef,0x06,0xf7,0x06,0x00,0xff,0x06,
+	0x07,0x07,0x0f,0x07,0x17,0x07,0x1f,0x07,0x27,0x07,0x2f,0x07,0x37,0x07,0x00,0x3f,
+	0x07,0x47,0x07,0x4f,0x07,0x57,0x07,0x5f,0x07,0x67,0x07,0x6f,0x07,0x77,0x07,0x00,
+	0x7f,0x07,0x87,0x07,0x8f,0x07,0x97,0x07,0x9f,0x07,0xa7,0x07,0xaf,0x07,0xb7,0x07,
+	0x00,0xbf,0x07,0xc7,0x07,0xcf,0x07,0xd7,0x07,0xdf,0x07,0xe7,0x07,0xef,0x07,0xf7,
+	0x07,0xfe,0xff,0x07,0x43,0x21,0x3f,0x39,0xd0,0xe2,0xa9,0xff,0x39,0xd7,0x75,0xd5,
+	0x39,0xa4,0x18,0xde,0xff,0x39,0xd6,0x26,0xc5,0x39,0x2f,0xea,0x90,0xff,0x39,0x5d,
+	0x91,0x16,0x39,0x5a,0x48,0x1c,0xff,0xa1,0x5f,0x88,0x0a,0xb9,0x1c,0x57,0x75,0xff,
+	0xb9,0xb4,0x88,0x99,0xb9,0x97,0x1a,0x9f,0xff,0xb9,0x0a,0xa6,0x8c,0xb9,0x2a,0xe1,
+	0x4d,0xff,0xb9,0xb3,0xf6,0xd4,0xb8,0x0e,0xe3,0x24,0xff,0xa1,0x92,0x1e,0xc2,0x38,
+	0x53,0x0c,0x2b,0xff,0x39,0xa0,0xfe,0x54,0x39,0x7c,0x8e,0x5b,0xff,0x39,0x84,0x06,
+	0x41,0x39,0x33,0x78,0x0c,0xff,0x39,0x38,0x71,0x90,0x38,0x53,0x39,0x94,0xff,0x21,
+	0x09,0x02,0x82,0xb8,0x64,0x93,0xe3,0xff,0xb8,0xfd,0xb2,0x0c,0xb9,0x6c,0xf8,0x0f,
+	0xff,0xb9,0xa4,0x33,0xfb,0xb8,0x34,0x55,0xb5,0xff,0xb8,0xed,0xe1,0x38,0xb8,0x20,
+	0xa9,0x9c,0xff,0xa0,0xec,0x5f,0x23,0x38,0x9b,0x92,0x8d,0xff,0x38,0x68,0x37,0xad,
+	0x38,0xce,0x44,0xaf,0xff,0x38,0x22,0x18,0x97,0x38,0x27,0x62,0x57,0xff,0x38,0xa4,
+	0xa2,0xd8,0x37,0x2b,0xe9,0x90,0xff,0x9f,0x04,0xba,0xb9,0xb7,0xe5,0x3c,0x1e,0xff,
+	0xb8,0x03,0x15,0x3e,0xb8,0x31,0x86,0x3c,0xff,0xb8,0x64,0x00,0x1f,0xb8,0x95,0x42,
+	0xdd,0xfb,0xb7,0x00,0x00,0x20,0x6d,0x46,0x3c,0xbb,0x85,0xff,0xbf,0x2e,0xb7,0xc8,
+	0x0b,0x48,0x3b,0xc9,0xff,0xd0,0xce,0x3b,0xb3,0xee,0x1f,0x3c,0x28,0xff,0x7c,0x5b,
+	0x3c,0xe4,0xf9,0x8c,0x3c,0x37,0xff,0x9a,0xad,0x3c,0x9b,0x8c,0xcf,0x3c,0x57,0xff,
+	0xbd,0xf2,0x3c,0x69,0x8b,0x0b,0x3d,0xfe,0xff,0x40,0x1e,0x3d,0x5a,0x73,0x31,0x3d,
+	0x63,0xff,0x15,0x45,0x3d,0xc7,0x19,0x59,0x3d,0x7a,0xff,0x72,0x6d,0x3d,0x8e,0x08,
+	0x81,0x3d,0x66,0xff,0x73,0x8b,0x3d,0x2a,0xf2,0x95,0x3d,0x41,0xff,0x7d,0xa0,0x3d,
+	0xbe,0x0c,0xab,0x3d,0xe1,0xff,0x98,0xb5,0x3d,0xcc,0x19,0xc0,0x3d,0xa0,0xff,0x87,
+	0xca,0x3d,0xd3,0xda,0xd4,0x3d,0x28,0xff,0x0b,0xdf,0x3d,0x12,0x12,0xe9,0x3d,0xb4,
+	0xff,0xe7,0xf2,0x3d,0xb6,0x84,0xfc,0x3d,0x24,0xff,0xf1,0x02,0x3e,0x52,0x7d,0x07,
+	0x3e,0x7e,0xff,0xe3,0x0b,0x3e,0xc5,0x20,0x10,0x3e,0x44,0xff,0x32,0x14,0x3e,0xe4,
+	0x15,0x18,0x3e,0xc1,0xff,0xc8,0x1b,0x3e,0x06,0x49,0x1f,0x3e,0x21,0xff,0x95,0x22,
+	0x3e,0xf8,0xaa,0x25,0x3e,0x35,0xff,0xb6,0x27,0x3e,0x6e,0x89,0x2c,0x3e,0xe8,0xff,
+	0x15,0x2f,0x3e,0x0a,0x65,0x31,0x3e,0x0c,0xff,0x76,0x33,0x3e,0x67,0x48,0x35,0x3e,
+	0x5d,0xff,0xdc,0x36,0x3e,0xf0,0x31,0x38,0x3e,0xe9,0xff,0x49,0x39,0x3e,0xcc,0x24,
+	0x3a,0x3e,0x2f,0xff,0xc4,0x3a,0x3e,0x1c,0x29,0x3b,0x3e,0x69,0xff,0x55,0x3b,0x3e,
+	0xed,0x4a,0x3b,0x3e,0x46,0xff,0x0c,0x3b,0x3e,0x8d,0x9b,0x3a,0x3e,0xa4,0xff,0xfb,
+	0x39,0x3e,0x6f,0x2f,0x39,0x3e,0x11,0xff,0x3a,0x38,0x3e,0xb0,0x1e,0x37,0x3e,0xf8,
+	0xff,0xe0,0x35,0x3e,0x94,0x84,0x34,0x3e,0xed,0xff,0x0c,0x33,0x3e,0xf2,0x7d,0x31,
+	0x3e,0x90,0xff,0xdb,0x2f,0x3e,0xb7,0x29,0x2e,0x3e,0x55,0xff,0x6c,0x2c,0x3e,0x16,
+	0xa7,0x2a,0x3e,0xe8,0xff,0xdd,0x28,0x3e,0xfd,0x14,0x27,0x3e,0xbe,0xff,0x4f,0x25,
+	0x3e,0x19,0x92,0x23,0x3e,0x76,0xff,0xdf,0x21,0x3e,0xfb,0x3a,0x20,0x3e,0x54,0xff,
+	0xa8,0x1e,0x3e,0x20,0x2a,0x1d,0x3e,0x83,0xff,0xc3,0x1b,0x3e,0xd9,0x76,0x1a,0x3e,
+	0x80,0xff,0x46,0x19,0x3e,0xd2,0x34,0x18,0x3e,0x11,0xff,0xe3,0x15,0x3e,0x8a,0xcd,
+	0x17,0x3e,0xc4,0xff,0x40,0x17,0x3e,0x80,0xd4,0x16,0x3e,0x01,0xff,0x89,0x16,0x3e,
+	0x03,0x5e,0x16,0x3e,0xca,0xff,0x53,0x16,0x3e,0x05,0x69,0x16,0x3e,0xb6,0xff,0x9d,
+	0x16,0x3e,0x4a,0xf0,0x16,0x3e,0xb3,0xff,0x5f,0x17,0x3e,0x60,0xea,0x17,0x3e,0x7a,
+	0xfb,0x8e,0x18,0xb3,0x00,0x19,0x3e,0x19,0x1b,0x1a,0xff,0x3e,0x6d,0xff,0x1a,0x3e,
+	0x45,0xf4,0x1b,0xff,0x3e,0x44,0xf7,0x1c,0x3e,0x10,0x06,0x1e,0xbf,0x3e,0x3f,0x1d,
+	0x1f,0x3e,0x75,0x6b,0x00,0xd1,0xff,0x5a,0x21,0x3e,0x70,0x7b,0x22,0x3e,0x70,0xff,
+	0x99,0x23,0x3e,0xab,0xb1,0x24,0x3e,0xc6,0xff,0xc1,0x25,0x3e,0x22,0xc7,0x26,0x3e,
+	0x98,0xff,0xbe,0x27,0x3e,0x11,0xa6,0x28,0x3e,0x31,0xff,0x7b,0x29,0x3e,0x9b,0x3b,
+	0x2a,0x3e,0x79,0xff,0xe5,0x2a,0x3e,0xf7,0x76,0x2b,0x3e,0x3d,0xff,0xee,0x2b,0x3e,
+	0xfd,0x49,0x2c,0x3e,0x2b,0xfe,0x27,0x01,0xb9,0xaa,0x2c,0x3e,0x21,0xae,0x2c,0xff,
+	0x3e,0xde,0x92,0x2c,0x3e,0xef,0x58,0x2c,0xff,0x3e,0x33,0x32,0x28,0x3e,0xcf,0x2f,
+	0x2a,0xfb,0x3e,0x74,0x33,0x00,0x75,0xae,0x28,0x3e,0xde,0xff,0xc9,0x27,0x3e,0xc8,
+	0xcf,0x26,0x3e,0x09,0xff,0xc2,0x25,0x3e,0xfd,0xa2,0x24,0x3e,0xbc,0xff,0x74,0x23,
+	0x3e,0x2a,0x3a,0x22,0x3e,0xa1,0xff,0xf5,0x20,0x3e,0x47,0xaa,0x1f,0x3e,0x79,0xff,
+	0x5a,0x1e,0x3e,0xe1,0x09,0x1d,0x3e,0x1f,0xbf,0xbb,0x1b,0x3e,0x15,0x71,0x1a,0x3b,
+	0x01,0x19,0xff,0x3e,0x87,0xf8,0x17,0x3e,0x0b,0xd0,0x16,0xff,0x3e,0x56,0xb8,0x15,
+	0x3e,0xd0,0xb4,0x14,0xff,0x3e,0x93,0xc7,0x13,0x3e,0x06,0xf4,0x12,0xff,0x3e,0xbc,
+	0x3b,0x12,0x3e,0xdc,0xa1,0x11,0xff,0x3e,0xf6,0x27,0x11,0x3e,0xe1,0xcf,0x10,0xff,
+	0x3e,0xb7,0x9b,0x10,0x3e,0x3f,0x8c,0x10,0xff,0x3e,0x0e,0xa3,0x10,0x3e,0xeb,0xe0,
+	0x10,0xff,0x3e,0xa2,0x46,0x11,0x3e,0xed,0xd3,0x11,0xff,0x3e,0x55,0x89,0x12,0x3e,
+	0x95,0x66,0x13,0xff,0x3e,0xa1,0x6a,0x14,0x3e,0xaf,0x94,0x15,0xff,0x3e,0xf8,0xe3,
+	0x16,0x3e,0x60,0x56,0x18,0xff,0x3e,0x9a,0xea,0x19,0x3e,0x29,0xd0,0x17,0xff,0x3e,
+	0x90,0x15,0x1c,0x3e,0x5d,0xe1,0x1d,0xff,0x3e,0x6d,0xc8,0x1f,0x3e,0xde,0xc7,0x21,
+	0xff,0x3e,0x55,0xdd,0x23,0x3e,0xe2,0x04,0x26,0xff,0x3e,0x60,0x3b,0x28,0x3e,0xe1,
+	0x7c,0x2a,0xff,0x3e,0xfc,0xc5,0x2c,0x3e,0x7f,0x12,0x2f,0xff,0x3e,0xf6,0x5d,0x31,
+	0x3e,0x2f,0xa4,0x33,0xfb,0x3e,0xb5,0xc3,0x01,0x13,0x0f,0x38,0x3e,0xd4,0xff,0x2a,
+	0x3a,0x3e,0xfd,0x2e,0x3c,0x3e,0x1a,0xff,0x17,0x3e,0x3e,0x2f,0xde,0x3f,0x3e,0x0a,
+	0xff,0x80,0x41,0x3e,0xf5,0xf7,0x42,0x3e,0x78,0xff,0x41,0x44,0x3e,0xde,0x57,0x45,
+	0x3e,0x37,0xff,0x37,0x46,0x3e,0x0e,0xdb,0x46,0x3e,0xb8,0xff,0x3f,0x47,0x3e,0x46,
+	0x61,0x47,0x3e,0x0c,0xff,0x3c,0x47,0x3e,0xa3,0xcc,0x46,0x3e,0x6b,0xff,0x10,0x46,
+	0x3e,0xfb,0x03,0x45,0x3e,0xb5,0xff,0xa4,0x43,0x3e,0x06,0xf1,0x41,0x3e,0x0c,0xff,
+	0xe6,0x3f,0x3e,0xba,0x82,0x3d,0x3e,0x7e,0xff,0xc5,0x3a,0x3e,0x08,0xad,0x37,0x3e,
+	0x58,0xff,0x39,0x34,0x3e,0x62,0x69,0x30,0x3e,0x68,0xff,0x3d,0x2c,0x3e,0xbe,0x69,
+	0x2a,0x3e,0x06,0xff,0x2d,0x24,0x3e,0xe0,0x0f,0x1f,0x3e,0xb7,0xff,0x96,0x19,0x3e,
+	0x55,0xc2,0x13,0x3e,0x8e,0xff,0x94,0x0d,0x3e,0x39,0x0f,0x07,0x3e,0xf4,0xff,0x34,
+	0x00,0x3e,0xbf,0x10,0xf2,0x3d,0x33,0xff,0x18,0xe3,0x3d,0x9c,0x87,0xd3,0x3d,0x6c,
+	0xff,0x66,0xc3,0x3d,0xd2,0xbb,0xb2,0x3d,0x74,0xff,0x90,0xa1,0x3d,0x3b,0xed,0x8f,
+	0x3d,0x16,0xff,0xb7,0x7b,0x3d,0x97,0xca,0x56,0x3d,0x53,0xff,0x29,0x31,0x3d,0xc7,
+	0xe8,0x0a,0x3d,0xbc,0xff,0x3d,0xc8,0x3c,0x8e,0x88,0x73,0x3c,0xb1,0xff,0x4d,0xaa,
+	0x3b,0xd2,0x97,0x94,0xbb,0x4c,0xff,0x70,0x6a,0xbc,0x3c,0x73,0xc5,0xbc,0x48,0xff,
+	0xd3,0x0a,0xbd,0xd8,0xd0,0x32,0xbd,0x4b,0xff,0x9a,0x5a,0xbd,0xb4,0x0b,0x81,0xbd,
+	0x30,0xff,0x98,0x94,0xbd,0xdc,0xe6,0xa7,0xbd,0x22,0xff,0xec,0xba,0xbd,0xf1,0x9c,
+	0xcd,0xbd,0xa6,0xff,0xed,0xdf,0xbd,0xed,0xd3,0xf1,0xbd,0xa5,0xff,0xa2,0x01,0xbe,
+	0xe3,0x1b,0x0a,0xbe,0x3b,0xff,0x51,0x12,0xbe,0x71,0x3d,0x1a,0xbe,0xd7,0xff,0xdc,
+	0x21,0xbe,0x3f,0xe5,0x28,0xbe,0x50,0xff,0x6d,0x30,0xbe,0x43,0x56,0x37,0xbe,0xa0,
+	0xff,0xe1,0x3d,0xbe,0xfe,0x0b,0x44,0xbe,0xb3,0xff,0xd1,0x49,0xbe,0x98,0x2f,0x4f,
+	0xbe,0x10,0xff,0x23,0x54,0xbe,0x7a,0xa9,0x58,0xbe,0x01,0xff,0xc1,0x5c,0xbe,0xcf,
+	0x67,0x60,0xbe,0xd8,0xff,0x9c,0x63,0xbe,0xcc,0x5e,0x66,0xbe,0x69,0xff,0xad,0x68,
+	0xbe,0x6a,0x88,0x6a,0xbe,0x13,0xff,0xf0,0x6b,0xbe,0xa8,0xe4,0x6c,0xbe,0x77,0xff,
+	0x67,0x6d,0xbe,0xd1,0x79,0x6d,0xbe,0x04,0xff,0x1d,0x6d,0xbe,0xe7,0x52,0x6c,0xbe,
+	0xd6,0xff,0x1d,0x6b,0xbe,0x6f,0x80,0x69,0xbe,0x52,0xff,0x7d,0x67,0xbe,0xa4,0x17,
+	0x65,0xbe,0x48,0xff,0x52,0x62,0xbe,0xe8,0x30,0x5f,0xbe,0x31,0xff,0xb7,0x5b,0xbe,
+	0xcd,0xe8,0x57,0xbe,0x69,0xff,0xc9,0x53,0xbe,0x35,0x5d,0x4f,0xbe,0x65,0xff,0xa8,
+	0x4a,0xbe,0xe6,0xae,0x45,0xbe,0xeb,0xff,0x74,0x40,0xbe,0x61,0xfe,0x3a,0xbe,0xbe,
+	0xff,0x4f,0x35,0xbe,0xad,0x6c,0x2f,0xbe,0xa3,0xff,0x59,0x29,0xbe,0x4c,0x1a,0x23,
+	0xbe,0x53,0xff,0xb2,0x1c,0xbe,0xe8,0x6b,0x16,0xbe,0xc3,0xff,0x0c,0x0d,0xbe,0x90,
+	0x49,0x06,0xbe,0xbd,0x7f,0xe1,0xfe,0xbd,0xb3,0x0c,0xf1,0xbd,0x2f,0x01,0xff,0xbd,
+	0x7d,0x09,0xd5,0xbd,0x3a,0xe5,0xc6,0xff,0xbd,0x31,0xaf,0xb8,0xbd,0xd8,0x6a,0xaa,
+	0xff,0xbd,0x1e,0x1b,0x9c,0xbd,0x89,0xc2,0x8d,0xff,0xbd,0x29,0xc6,0x7e,0xbd,0xc5,
+	0xfc,0x61,0xff,0xbd,0xe2,0x2a,0x45,0xbd,0x49,0x52,0x28,0xff,0xbd,0x66,0x73,0x0b,
+	0xbd,0x12,0x1d,0xdd,0xff,0xbc,0x20,0x46,0xa3,0xbc,0x55,0xbf,0x52,0xff,0xbc,0x02,
+	0x9c,0xbd,0xbb,0x8f,0x78,0xaa,0xff,0x3a,0xf2,0x9f,0x09,0x3c,0x2d,0x2d,0x7e,0xff,
+	0x3c,0xb3,0x7f,0xb9,0x3c,0x9c,0x0f,0xf4,0xff,0x3c,0xd6,0x64,0x17,0x3d,0x9f,0xd8,
+	0x34,0xff,0x3d,0x36,0x64,0x52,0x3d,0x3b,0x08,0x70,0xff,0x3d,0x4a,0xe2,0x86,0x3d,
+	0x42,0xcc,0x95,0xff,0x3d,0x22,0xc1,0xa4,0x3d,0xb6,0xbf,0xb3,0xff,0x3d,0x18,0xc6,
+	0xc2,0x3d,0xd4,0xd1,0xd1,0xff,0x3d,0x65,0xe0,0xe0,0x3d,0xe9,0xed,0xef,0xff,0x3d,
+	0xa9,0xf5,0xfe,0x3d,0xfd,0xf9,0x06,0xef,0x3e,0xf5,0xbc,0x0b,0x93,0x0a,0x76,0xaa,
+	0x1c,0xff,0x3e,0xb8,0xaf,0x23,0x3e,0x51,0xa1,0x2a,0xff,0x3e,0x53,0x7b,0x31,0x3e,
+	0xce,0x39,0x38,0xff,0x3e,0x0a,0xd8,0x3e,0x3e,0xd7,0x51,0x45,0xff,0x3e,0xb2,0xa1,
+	0x4b,0x3e,0x5d,0xc2,0x51,0xff,0x3e,0x14,0xae,0x57,0x3e,0x14,0x5f,0x5d,0xff,0x3e,
+	0xcd,0xce,0x62,0x3e,0x38,0xf7,0x67,0xff,0x3e,0x42,0xd1,0x6c,0x3e,0x9f,0x56,0x71,
+	0xff,0x3e,0x3d,0x80,0x75,0x3e,0x49,0x47,0x79,0xff,0x3e,0xb1,0xa4,0x7c,0x3e,0xe6,
+	0x91,0x7f,0xff,0x3e,0x0c,0x04,0x81,0x3e,0x3b,0x00,0x82,0xff,0x3e,0x38,0xba,0x82,
+	0x3e,0x23,0x2f,0x83,0xff,0x3e,0xf7,0x5b,0x83,0x3e,0xf3,0x3d,0x83,0xff,0x3e,0x78,
+	0xd2,0x82,0x3e,0x2b,0x17,0x82,0xff,0x3e,0x35,0x0a,0x81,0x3e,0x82,0x53,0x7f,0xff,
+	0x3e,0x79,0xe8,0x7b,0x3e,0xf2,0xd0,0x77,0xff,0x3e,0xe1,0x0b,0x73,0x3e,0x39,0x98,
+	0x6d,0xff,0x3e,0xfb,0x75,0x67,0x3e,0x33,0xa6,0x60,0xff,0x3e,0xed,0x29,0x59,0x3e,
+	0x4f,0x04,0x51,0xff,0x3e,0x7e,0x38,0x48,0x3e,0xd4,0x47,0x40,0xff,0x3e,0xc4,0xd1,
+	0x35,0x3e,0xdd,0x08,0x2b,0xff,0x3e,0xbc,0xae,0x1f,0x3e,0xc5,0xcb,0x13,0xff,0x3e,
+	0x23,0x69,0x07,0x3e,0x21,0x22,0xf5,0xff,0x3d,0x1f,0x9d,0xda,0x3d,0xa4,0x5a,0xbf,
+	0xff,0x3d,0xa3,0x73,0xa3,0x3d,0x88,0x02,0x87,0xff,0x3d,0x08,0x46,0x54,0x3d,0xa1,
+	0xe3,0x19,0xff,0x3d,0x0c,0x33,0xbe,0x3c,0x62,0x94,0x10,0xff,0x3c,0xa8,0xd7,0xb5,
+	0xbb,0x5e,0x8d,0xa2,0xff,0xbc,0x4b,0x3d,0x0b,0xbd,0xad,0x5d,0x44,0xff,0xbd,0x68,
+	0x66,0x7c,0xbd,0x3c,0x8b,0x99,0xff,0xbd,0xb0,0x16,0xb4,0xbd,0x95,0xb5,0xcd,0xff,
+	0xbd,0x90,0x49,0xe6,0xbd,0xc0,0xb3,0xfd,0xff,0xbd,0x64,0xeb,0x09,0xbe,0x6f,0x4b,
+	0x14,0xff,0xbe,0xe5,0xec,0x1d,0xbe,0xf0,0xc2,0x26,0xff,0xbe,0x05,0xc2,0x2e,0xbe,
+	0x65,0xdf,0x35,0xff,0xbe,0xa1,0x11,0x3c,0xbe,0x8b,0x4f,0x41,0xff,0xbe,0x10,0x92,
+	0x45,0xbe,0xa2,0xd2,0x48,0xff,0xbe,0x46,0x0c,0x4b,0xbe,0x4f,0x3b,0x4c,0xff,0xbe,
+	0x20,0x5d,0x4c,0xbe,0xef,0x70,0x4b,0xff,0xbe,0xbc,0x76,0x49,0xbe,0xd9,0x07,0x49,
+	0xff,0xbe,0x55,0x50,0x41,0xbe,0xfe,0x64,0x3c,0xff,0xbe,0x35,0x7d,0x36,0xbe,0x88,
+	0x9f,0x2f,0xff,0xbe,0x9d,0xd4,0x27,0xbe,0xa2,0x25,0x1f,0xff,0xbe,0x99,0x9d,0x15,
+	0xbe,0x4d,0x48,0x0b,0xff,0xbe,0x61,0x33,0x00,0xbe,0xf9,0xd9,0xe8,0xff,0xbd,0x2d,
+	0x09,0xd0,0xbd,0x23,0x15,0xb6,0xff,0xbd,0x5a,0x20,0x9b,0xbd,0x51,0x9e,0x7e,0xff,
+	0xbd,0x14,0x8e,0x45,0xbd,0xcc,0x5d,0x0b,0xff,0xbd,0x1f,0xba,0xa0,0xbc,0x4e,0xe9,
+	0xa6,0xff,0xbb,0xd4,0x3d,0x1b,0x3c,0x96,0xab,0xc4,0xff,0x3c,0x61,0x62,0x1d,0x3d,
+	0x7e,0xa2,0x57,0xff,0x3d,0xc1,0x61,0x88,0x3d,0x57,0x3a,0xa4,0xff,0x3d,0x29,0x33,
+	0xbf,0x3d,0xbb,0x25,0xd9,0xff,0x3d,0x92,0xec,0xf1,0x3d,0xee,0xb1,0x04,0xff,0x3e,
+	0x07,0xb5,0x0f,0x3e,0x52,0xef,0x19,0xff,0x3e,0x9c,0x51,0x23,0x3e,0x85,0xce,0x2b,
+	0xff,0x3e,0x36,0x59,0x33,0x3e,0x68,0xe6,0x39,0xff,0x3e,0x27,0x6c,0x3f,0x3e,0x93,
+	0xe2,0x43,0xff,0x3e,0x14,0x42,0x47,0x3e,0xf0,0x85,0x49,0xff,0x3e,0x3b,0xaa,0x4a,
+	0x3e,0xd0,0x43,0x4d,0xff,0x3e,0x9a,0x7b,0x48,0x3e,0x41,0x63,0x46,0xff,0x3e,0x38,
+	0x2e,0x43,0x3e,0x37,0xe1,0x3e,0xff,0x3e,0x38,0x81,0x39,0x3e,0x1a,0x16,0x33,0xff,
+	0x3e,0xfc,0xa7,0x2b,0x3e,0x5b,0x41,0x23,0xff,0x3e,0x03,0xee,0x19,0x3e,0xcb,0xba,
+	0x0f,0xff,0x3e,0x63,0xb6,0x04,0x3e,0xfc,0xdf,0xf1,0xff,0x3d,0x4e,0xf1,0xd8,0x3d,
+	0x03,0xc4,0xbe,0xff,0x3d,0xa6,0x7d,0xa3,0x3d,0x54,0x45,0x87,0xff,0x3d,0x0b,0x87,
+	0x54,0x3d,0x24,0x44,0x19,0xff,0x3d,0x9a,0x2e,0xba,0x3c,0xa3,0x5d,0x01,0xff,0x3c,
+	0xfe,0x1e,0xe5,0xbb,0xa5,0x04,0xb3,0xff,0xbc,0x15,0xec,0x15,0xbd,0x95,0x89,0x51,
+	0xff,0xbd,0x5e,0x02,0x86,0xbd,0x67,0x84,0xa2,0xff,0xbd,0xcc,0x21,0xbe,0xbd,0x64,
+	0xb2,0xd8,0xff,0xbd,0xbf,0x10,0xf2,0xbd,0x95,0x0b,0x05,0xff,0xbe,0xca,0x51,0x10,
+	0xbe,0xbc,0xca,0x1a,0xff,0xbe,0x7b,0x67,0x24,0xbe,0x65,0x1a,0x2d,0xff,0xbe,0x28,
+	0xd7,0x34,0xbe,0x7d,0x92,0x3b,0xff,0xbe,0x39,0x43,0x41,0xbe,0x3b,0xe1,0x45,0xff,
+	0xbe,0x38,0x66,0x49,0xbe,0xb2,0x64,0x4e,0xff,0xbe,0x42,0x25,0x4e,0xbe,0x10,0x21,
+	0x4e,0xff,0xbe,0x1a,0xf9,0x4c,0xbe,0x36,0xaf,0x4a,0xff,0xbe,0x95,0x47,0x47,0xbe,
+	0x75,0xc7,0x42,0xff,0xbe,0xeb,0x35,0x3d,0xbe,0x9d,0x9b,0x36,0xff,0xbe,0x82,0x02,
+	0x2f,0xbe,0x21,0x76,0x26,0xff,0xbe,0xcd,0x02,0x1d,0xbe,0x6b,0xb6,0x12,0xef,0xbe,
+	0x30,0xa0,0x07,0x03,0x00,0xf7,0xbd,0xd6,0xff,0xad,0xde,0xbd,0x48,0x8d,0xc4,0xbd,
+	0xf8,0xff,0x62,0xa9,0xbd,0x2b,0x55,0x8d,0xbd,0xdf,0xff,0x15,0x61,0xbd,0x24,0x58,
+	0x26,0xbd,0x55,0xff,0x83,0xd5,0xbc,0x2f,0x8d,0x3a,0xbc,0x76,0xff,0x1f,0x5b,0x3b,
+	0x7f,0xdb,0x93,0x3c,0x69,0xff,0xc0,0x05,0x3d,0x19,0xdc,0x40,0x3d,0x93,0xff,0xf4,
+	0x7a,0x3d,0xdb,0xdf,0x99,0x3d,0x42,0xff,0x7b,0xb5,0x3d,0x35,0x2a,0xd0,0x3d,0xb8,
+	0xff,0xcc,0xe9,0x3d,0x32,0x22,0x01,0x3e,0x30,0xff,0xba,0x0c,0x3e,0x7f,0xa1,0x17,
+	0x3e,0xcd,0xff,0xcb,0x21,0x3e,0x9d,0x2e,0x2b,0x3e,0xc2,0xff,0xc0,0x33,0x3e,0x96,
+	0x79,0x3b,0x3e,0x8b,0xff,0x52,0x42,0x3e,0x28,0xd3,0x48,0x3e,0x4a,0xff,0x61,0x4e,
+	0x3e,0x00,0x57,0x52,0x3e,0x1c,0xff,0x5d,0x55,0x3e,0x25,0x74,0x57,0x3e,0x34,0xff,
+	0x9e,0x58,0x3e,0xa5,0xdd,0x58,0x3e,0xb5,0xff,0x37,0x58,0x3e,0x1c,0xb1,0x56,0x3e,
+	0x33,0xff,0x51,0x54,0x3e,0x92,0x1f,0x51,0x3e,0xe1,0xff,0x24,0x4d,0x3e,0x59,0x6b,
+	0x48,0x3e,0x76,0xff,0xfd,0x42,0x3e,0x7d,0xe6,0x3c,0x3e,0xc2,0xff,0x32,0x36,0x3e,
+	0x1c,0xef,0x2e,0x3e,0xe9,0xff,0x28,0x27,0x3e,0xcc,0xed,0x1e,0x3e,0x30,0xff,0x4c,
+	0x16,0x3e,0x3b,0x52,0x0d,0x3e,0x5a,0xff,0x0e,0x04,0x3e,0xfb,0x1e,0xf5,0x3d,0x21,
+	0xff,0xc8,0xe1,0x3d,0xfc,0x34,0xce,0x3d,0x04,0xff,0x82,0xba,0x3d,0x89,0xcb,0xa6,
+	0x3d,0xb3,0xff,0x2c,0x93,0x3d,0x8d,0x7f,0x7f,0x3d,0x47,0xff,0x3c,0x59,0x3d,0x06,
+	0xc0,0x33,0x3d,0x82,0xff,0x38,0x0f,0x3d,0x13,0xa2,0xd7,0x3c,0xb3,0xff,0x62,0x93,
+	0x3c,0xb1,0xfa,0x23,0x3c,0x6f,0x7f,0xa6,0x1d,0x3b,0x85,0xe9,0x9c,0xbb,0x17,0x01,
+	0xff,0xbc,0xc7,0x3e,0x92,0xbc,0x49,0xff,0xc1,0xfb,0xbc,0x00,0x00,0x00,0xa5,0x80,
+	0x9b,0xba,0x24,0xff,0xfd,0xac,0xba,0x42,0xde,0xbc,0xba,0xa8,0xff,0xef,0xca,0xba,
+	0xad,0x00,0xd7,0xba,0x5c,0xff,0xe4,0xe0,0xba,0xc6,0x72,0xe8,0xba,0x59,0xff,0x88,
+	0xed,0xba,0x3a,0x07,0xf0,0xba,0x40,0xff,0xd8,0xef,0xba,0x4d,0xe9,0xec,0xba,0xfa,
+	0xff,0x2f,0xe7,0xba,0x41,0xa8,0xde,0xba,0x27,0xff,0x55,0xd3,0xba,0xbc,0x40,0xc5,
+	0xba,0x20,0xff,0x7d,0xb4,0xba,0x26,0x23,0xa1,0xba,0xaf,0xff,0x52,0x8b,0xba,0xed,
+	0x67,0x66,0xba,0xa5,0xff,0xe9,0x31,0xba,0x2f,0x2a,0xf3,0xb9,0x75,0xff,0x84,0x77,
+	0xb9,0xcf,0x5f,0x2f,0x36,0xc4,0xff,0x1c,0x83,0x39,0xf8,0x23,0x04,0x3a,0x84,0xff,
+	0xcf,0x47,0x3a,0x4b,0xf4,0x85,0x3a,0x84,0xff,0xe0,0xa7,0x3a,0xf0,0x52,0xc9,0x3a,
+	0x49,0xff,0xf0,0xe9,0x3a,0x7b,0xae,0x04,0x3b,0x83,0xff,0x9e,0x13,0x3b,0xf0,0x9a,
+	0x21,0x3b,0x21,0xff,0x77,0x2e,0x3b,0xf9,0x07,0x3a,0x3b,0x5d,0xff,0x24,0x44,0x3b,
+	0x0a,0xa5,0x4c,0x3b,0x6d,0xff,0x65,0x53,0x3b,0x7a,0x44,0x58,0x3b,0xfe,0xff,0x23,
+	0x5b,0x3b,0xf6,0xe9,0x5b,0x3b,0x95,0xff,0x80,0x5a,0x3b,0x66,0xd6,0x56,0x3b,0x00,
+	0xff,0xdf,0x50,0x3b,0x01,0x93,0x48,0x3b,0xe5,0xff,0xef,0x3d,0x3b,0x5d,0xf9,0x30,
+	0x3b,0xf6,0xff,0xb7,0x21,0x3b,0xa0,0x3a,0x10,0x3b,0x50,0xff,0x2b,0xf9,0x3a,0xc6,
+	0xc5,0xcd,0x3a,0xbb,0xff,0x84,0x9e,0x3a,0xf2,0x65,0x57,0x3a,0x60,0xff,0x96,0xd6,
+	0x39,0x98,0xcf,0xd0,0xb7,0x2a,0xff,0x77,0xfa,0xb9,0xe3,0xed,0x77,0xba,0x25,0xff,
+	0xd3,0xba,0xba,0x33,0xaf,0xfa,0xba,0x59,0xff,0x80,0x1d,0xbb,0x02,0x9c,0x3d,0xbb,
+	0x43,0xff,0x60,0x5d,0xbb,0xc5,0x80,0x7c,0xbb,0x2d,0xff,0x58,0x8d,0xbb,0x81,0xd0,
+	0x9b,0xbb,0x85,0xff,0x82,0xa9,0xbb,0x90,0x47,0xb6,0xbb,0xe0,0xff,0xf9,0xc1,0xbb,
+	0xb8,0x74,0xcc,0xbb,0x9d,0xff,0x94,0xd5,0xbb,0xff,0x37,0xdd,0xbb,0x6a,0xff,0x3f,
+	0xe3,0xbb,0x98,0x8d,0xe7,0xbb,0x5c,0xff,0x08,0xea,0xbb,0x3a,0x98,0xea,0xbb,0x4f,
+	0xff,0x29,0xe9,0xbb,0x56,0xab,0xe5,0xbb,0xb9,0xff,0x11,0xe0,0xbb,0x14,0x54,0xd8,
+	0xbb,0x4d,0xff,0x6e,0xce,0xbb,0xce,0x60,0xc2,0xbb,0x9f,0xff,0x30,0xb4,0xbb,0x66,
+	0xe7,0xa3,0xbb,0x91,0xff,0x93,0x91,0xbb,0x00,0x91,0x7a,0xbb,0x64,0xff,0x3c,0x4e,
+	0xbb,0x58,0x63,0x1e,0xbb,0xf3,0xff,0x91,0xd6,0xba,0xfe,0xe5,0x54,0xba,0x25,0xff,
+	0x78,0x5d,0x38,0x33,0x9e,0x79,0x3a,0x03,0xff,0x6c,0xf6,0x3a,0x2a,0x74,0x39,0x3b,
+	0x7d,0xff,0xae,0x78,0x3b,0x6b,0x35,0x9c,0x3b,0x45,0xff,0x15,0xbc,0x3b,0xc7,0xb4,
+	0xdb,0x3b,0x56,0xff,0xd0,0xfa,0x3b,0x94,0x91,0x0c,0x3c,0xa3,0xff,0x33,0x1b,0x3c,
+	0x72,0x2b,0x29,0x3c,0x92,0xff,0x55,0x36,0x3c,0x33,0x90,0x42,0x3c,0xf0,0xff,0xb8,
+	0x4d,0x3c,0xa8,0xae,0x57,0x3c,0xe5,0xff,0x51,0x60,0x3c,0x74,0x84,0x67,0x3c,0xcf,
+	0xff,0x29,0x6d,0x3c,0x8b,0x27,0x71,0x3c,0xe7,0xff,0x64,0x73,0x3c,0x57,0xcd,0x73,
+	0x3c,0x90,0xff,0x4d,0x72,0x3c,0x0c,0xd6,0x6e,0x3c,0x37,0xff,0x5a,0x69,0x3c,0xac,
+	0xd1,0x61,0x3c,0x8d,0xff,0x36,0x58,0x3c,0x2d,0x87,0x4c,0x3c,0xe5,0xff,0xc6,0x3e,
+	0x3c,0x96,0xfb,0x2e,0x3c,0x91,0xff,0x2f,0x1d,0x3c,0x3a,0x72,0x09,0x3c,0xcd,0xff,
+	0xac,0xe7,0x3b,0xd1,0xe6,0xb8,0x3b,0x5d,0xff,0xc9,0x86,0x3b,0x62,0x27,0x23,0x3b,
+	0x47,0xff,0x69,0x4c,0x3a,0x87,0xeb,0x83,0xba,0x60,0xff,0x5b,0x3b,0xbb,0xf2,0x2c,
+	0x9c,0xbb,0xbd,0xff,0x13,0xdc,0xbb,0x58,0x7b,0x0e,0xbc,0x1d,0xff,0x32,0x2f,0xbc,
+	0x5d,0xf3,0x4f,0xbc,0x9c,0xff,0x80,0x70,0xbc,0x77,0x4d,0x88,0xbc,0x72,0xff,0x00,
+	0x98,0xbc,0xb2,0x37,0xa7,0xbc,0xa9,0xff,0xd1,0xb5,0xbc,0x27,0xac,0xc3,0xbc,0xfe,
+	0xff,0xa4,0xd0,0xbc,0x6a,0x9a,0xdc,0xbc,0x13,0xff,0x6b,0xe7,0xbc,0x6b,0xf5,0xf0,
+	0xbc,0xc7,0xff,0x19,0xf9,0xbc,0xe8,0xb8,0xff,0xbc,0x68,0xff,0x5a,0x02,0xbd,0x7d,
+	0xf8,0x03,0xbd,0x62,0xff,0xa9,0x04,0xbd,0xb8,0x60,0x04,0xbd,0xda,0xff,0x12,0x03,
+	0xbd,0x9d,0xb5,0x00,0xbd,0x8d,0xff,0x7f,0xfa,0xbc,0x29,0x53,0xf1,0xbc,0x43,0xff,
+	0xd9,0xe5,0xbc,0x5e,0x07,0xd8,0xbc,0xc4,0xff,0xd6,0xc7,0xbc,0x43,0x43,0xb5,0xbc,
+	0xd0,0xff,0x4b,0xa0,0xbc,0xee,0xf2,0x88,0xbc,0x22,0xff,0x7c,0x5e,0xbc,0x89,0x0f,
+	0x47,0xbc,0x66,0xff,0xa0,0xd3,0xbb,0xed,0x14,0x23,0xbb,0x5b,0xff,0x72,0xe4,0x3a,
+	0x42,0xfc,0xcb,0x3b,0xb1,0xff,0x57,0x33,0x3c,0x68,0x31,0x82,0x3c,0x00,0xff,0x70,
+	0xac,0x3c,0xa7,0x45,0xd8,0x3c,0xd4,0xff,0xc6,0x02,0x3d,0x32,0x10,0x1a,0x3d,0xf2,
+	0xff,0xe9,0x31,0x3d,0x47,0x3e,0x4a,0x3d,0x1f,0xff,0xf6,0x62,0x3d,0x90,0xf9,0x7b,
+	0x3d,0x17,0xff,0x98,0x8a,0x3d,0x3e,0x40,0x97,0x3d,0x80,0xff,0xe8,0xa3,0x3d,0xc1,
+	0x83,0xb0,0x3d,0xd9,0xff,0x04,0xbd,0x3d,0x83,0x5e,0xc9,0x3d,0xa5,0xff,0x83,0xd5,
+	0x3d,0x9d,0x66,0xe1,0x3d,0x76,0xff,0xfb,0xec,0x3d,0x8f,0x34,0xf8,0x3d,0x30,0xff,
+	0x83,0x01,0x3e,0xe6,0xb1,0x06,0x3e,0xe8,0xff,0xa0,0x0b,0x3e,0x73,0x4a,0x10,0x3e,
+	0x8b,0xff,0xa9,0x14,0x3e,0xf1,0xb8,0x18,0x3e,0xef,0xff,0x73,0x1c,0x3e,0x95,0xd6,
+	0x1f,0x3e,0xb1,0xff,0xdc,0x22,0x3e,0xdc,0x82,0x25,0x3e,0xef,0xff,0xc5,0x27,0x3e,
+	0x90,0xa3,0x29,0x3e,0x1e,0xff,0x19,0x2b,0x3e,0x4a,0x25,0x2c,0x3e,0x82,0x1f,0xc6,
+	0x2c,0x3e,0x83,0xfc,0x07,0x0c,0x0f,0x04,0x17,0x04,0x00,0x1f,0x04,0x27,0x04,0x2f,
+	0x04,0x37,0x04,0x3f,0x04,0x47,0x04,0x4f,0x04,0x57,0x04,0x00,0x5f,0x04,0x67,0x04,
+	0x6f,0x04,0x77,0x04,0x7f,0x04,0x87,0x04,0x8f,0x04,0x97,0x04,0x00,0x9f,0x04,0xa7,
+	0x04,0xaf,0x04,0xb7,0x04,0xbf,0x04,0xc7,0x04,0xcf,0x04,0xd7,0x04,0x00,0xdf,0x04,
+	0xe7,0x04,0xef,0x04,0xf7,0x04,0xff,0x04,0x07,0x05,0x0f,0x05,0x17,0x05,0x70,0x1f,
+	0x05,0x27,0x05,0x2f,0x05,0x37,0x05,0x47,0x3e,0x2f,0x47,0x09,0x00,0x4f,0x05,0x57,
+	0x05,0x5f,0x05,0x67,0x05,0x6f,0x05,0x77,0x05,0x7f,0x05,0x87,0x05,0x00,0x8f,0x05,
+	0x97,0x05,0x9f,0x05,0xa7,0x05,0xaf,0x05,0xb7,0x05,0xbf,0x05,0xc7,0x05,0x00,0xcf,
+	0x05,0xd7,0x05,0xdf,0x05,0xe7,0x05,0xef,0x05,0xf7,0x05,0xff,0x05,0x07,0x06,0x00,
+	0x0f,0x06,0x17,0x06,0x1f,0x06,0x27,0x06,0x2f,0x06,0x37,0x06,0x3f,0x06,0x47,0x06,
+	0x00,0x4f,0x06,0x57,0x06,0x5f,0x06,0x67,0x06,0x6f,0x06,0x77,0x06,0x7f,0x06,0x87,
+	0x06,0x00,0x8f,0x06,0x97,0x06,0x9f,0x06,0xa7,0x06,0xaf,0x06,0xb7,0x06,0xbf,0x06,
+	0xc7,0x06,0x00,0xcf,0x06,0xd7,0x06,0xdf,0x06,0xe7,0x06,0xef,0x06,0xf7,0x06,0xff,
+	0x06,0x07,0x07,0x00,0x0f,0x07,0x17,0x07,0x1f,0x07,0x27,0x07,0x2f,0x07,0x37,0x07,
+	0x3f,0x07,0x47,0x07,0x00,0x4f,0x07,0x57,0x07,0x5f,0x07,0x67,0x07,0x6f,0x07,0x77,
+	0x07,0x7f,0x07,0x87,0x07,0x00,0x8f,0x07,0x97,0x07,0x9f,0x07,0xa7,0x07,0xaf,0x07,
+	0xb7,0x07,0xbf,0x07,0xc7,0x07,0x80,0xcf,0x07,0xd7,0x07,0xdf,0x07,0xe7,0x07,0xef,
+	0x07,0xf7,0x07,0xff,0x07,0x6a,0xff,0x3f,0xe3,0xbb,0xff,0x37,0xdd,0xbb,0x9d,0xff,
+	0x94,0xd5,0xbb,0xb8,0x74,0xcc,0xbb,0xe0,0xff,0xf9,0xc1,0xbb,0x90,0x47,0xb6,0xbb,
+	0x85,0xff,0x82,0xa9,0xbb,0x81,0xd0,0x9b,0xbb,0x2d,0xff,0x58,0x8d,0xbb,0xc5,0x80,
+	0x7c,0xbb,0x43,0xff,0x60,0x5d,0xbb,0x02,0x9c,0x3d,0xbb,0x59,0xff,0x80,0x1d,0xbb,
+	0x33,0xaf,0xfa,0xba,0x25,0xff,0xd3,0xba,0xba,0xe3,0xed,0x77,0xba,0x2a,0xff,0x77,
+	0xfa,0xb9,0x98,0xcf,0xd0,0xb7,0x60,0xff,0x96,0xd6,0x39,0xf2,0x65,0x57,0x3a,0xbb,
+	0xff,0x84,0x9e,0x3a,0xc6,0xc5,0xcd,0x3a,0x50,0xff,0x2b,0xf9,0x3a,0xa0,0x3a,0x10,
+	0x3b,0xf6,0xff,0xb7,0x21,0x3b,0x5d,0xf9,0x30,0x3b,0xe5,0xff,0xef,0x3d,0x3b,0x01,
+	0x93,0x48,0x3b,0x00,0xff,0xdf,0x50,0x3b,0x66,0xd6,0x56,0x3b,0x95,0xff,0x80,0x5a,
+	0x3b,0xf6,0xe9,0x5b,0x3b,0xfe,0xff,0x23,0x5b,0x3b,0x7a,0x44,0x58,0x3b,0x6d,0xff,
+	0x65,0x53,0x3b,0x0a,0xa5,0x4c,0x3b,0x5d,0xff,0x24,0x44,0x3b,0xf9,0x07,0x3a,0x3b,
+	0x21,0xff,0x77,0x2e,0x3b,0xf0,0x9a,0x21,0x3b,0x83,0xff,0x9e,0x13,0x3b,0x7b,0xae,
+	0x04,0x3b,0x49,0xff,0xf0,0xe9,0x3a,0xf0,0x52,0xc9,0x3a,0x84,0xff,0xe0,0xa7,0x3a,
+	0x4b,0xf4,0x85,0x3a,0x84,0xff,0xcf,0x47,0x3a,0xf8,0x23,0x04,0x3a,0xc4,0xff,0x1c,
+	0x83,0x39,0xcf,0x5f,0x2f,0x36,0x75,0xff,0x84,0x77,0xb9,0x2f,0x2a,0xf3,0xb9,0xa5,
+	0xff,0xe9,0x31,0xba,0xed,0x67,0x66,0xba,0xaf,0xff,0x52,0x8b,0xba,0x26,0x23,0xa1,
+	0xba,0x20,0xff,0x7d,0xb4,0xba,0xbc,0x40,0xc5,0xba,0x27,0xff,0x55,0xd3,0xba,0x41,
+	0xa8,0xde,0xba,0xfa,0xff,0x2f,0xe7,0xba,0x4d,0xe9,0xec,0xba,0x40,0xff,0xd8,0xef,
+	0xba,0x3a,0x07,0xf0,0xba,0x59,0xff,0x88,0xed,0xba,0xc6,0x72,0xe8,0xba,0x5c,0xff,
+	0xe4,0xe0,0xba,0xad,0x00,0xd7,0xba,0xa8,0xff,0xef,0xca,0xba,0x42,0xde,0xbc,0xba,
+	0x24,0xff,0xfd,0xac,0xba,0xa5,0x80,0x9b,0xba,0x00,0xfe,0x00,0x30,0x49,0x79,0x9e,
+	0x33,0x0f,0x3a,0x9f,0xff,0xb4,0x40,0xac,0x94,0x1f,0x89,0xbc,0xa0,0xff,0x35,0x57,
+	0x55,0xfc,0xb5,0x0d,0xf5,0x3c,0xff,0xa0,0x86,0x9c,0x79,0x36,0xd7,0xc5,0xa3,0xff,
+	0xb6,0x5a,0x75,0x80,0x20,0xe9,0x23,0x01,0xff,0x37,0xc0,0xfb,0x1c,0xb7,0x18,0x45,
+	0xd1,0xff,0x20,0xe7,0x48,0x5d,0x37,0xd0,0xe8,0x80,0xff,0xb7,0xad,0x8f,0x0c,0x22,
+	0x92,0xea,0xa9,0xff,0x37,0xd9,0xb1,0xc0,0xb7,0x07,0x35,0x8a,0xff,0xa0,0x3f,0xe5,
+	0xf2,0x37,0x85,0x2d,0x07,0xff,0xb8,0xea,0xfd,0x32,0xa1,0xd9,0x0b,0x25,0xff,0x38,
+	0x1e,0x34,0x35,0xb8,0x6f,0x99,0x2d,0xff,0xa2,0x88,0x03,0x58,0x38,0xb8,0xaf,0x6a,
+	0xff,0xb8,0x8d,0xed,0x77,0x22,0xed,0x4e,0x89,0xff,0x38,0x79,0xf2,0x93,0xb8,0x46,
+	0xf9,0x63,0xff,0x22,0x16,0x90,0xaa,0x38,0xca,0x8c,0xb6,0xff,0xb8,0xc4,0x23,0xbb,
+	0xa0,0xbd,0xe8,0xcf,0xff,0x38,0x9e,0x4a,0xdd,0xb8,0x05,0xc2,0x07,0xff,0xa3,0x63,
+	0x7d,0xf9,0x38,0x88,0x28,0x04,0xff,0xb9,0x53,0xc3,0x29,0x23,0xb9,0xb9,0x13,0xff,
+	0x39,0xb0,0xe2,0x1b,0xb9,0x58,0xf0,0x8f,0xff,0x22,0x93,0xf8,0x2c,0x39,0x61,0xe7,
+	0x35,0xff,0xb9,0x45,0xdb,0x7e,0x23,0xa6,0x8f,0x48,0xff,0x39,0xbb,0x4a,0x52,0xb9,
+	0x25,0x90,0x75,0xff,0xa2,0x59,0x93,0x66,0x39,0x39,0x22,0x71,0xff,0xb9,0xa3,0x60,
+	0x96,0x22,0x92,0x8c,0x83,0xff,0x39,0x88,0x41,0x89,0xb9,0xd3,0x72,0x8e,0xff,0xa3,
+	0xed,0x1b,0x95,0x39,0x4c,0x42,0x9b,0xff,0xb9,0xcb,0x04,0x07,0x23,0x6a,0x03,0xa8,
+	0xff,0x39,0x3a,0x9f,0xae,0xb9,0xa3,0x35,0x4a,0xff,0xa3,0x85,0x4f,0xbc,0x39,0xef,
+	0x64,0xc3,0xff,0xb9,0x02,0xc4,0x59,0x23,0x20,0x0d,0xd2,0xff,0x39,0xd7,0xa0,0xd9,
+	0xb9,0xaf,0x4b,0x57,0xff,0xa2,0x53,0x4a,0xe9,0x39,0x2c,0x61,0xf1,0xff,0xb9,0x0c,
+	0xf6,0xa3,0x23,0xe0,0x0a,0x01,0xff,0x3a,0x59,0x5a,0x05,0xba,0xcc,0x8a,0x2f,0xff,
+	0x23,0x8d,0x3f,0x0e,0x3a,0xe4,0xd5,0x12,0xff,0xba,0x70,0x3a,0xeb,0x23,0xa6,0x4b,
+	0x1c,0xff,0x3a,0xbd,0x2b,0x21,0xba,0x4d,0x66,0xfb,0xff,0x23,0x28,0x38,0x2b,0x3a,
+	0x49,0x65,0x30,0xff,0xba,0x00,0xba,0x22,0x24,0x02,0x0f,0x3b,0xff,0x3a,0x89,0x8c,
+	0x40,0xba,0x22,0xb3,0xfc,0xff,0x21,0xbd,0xda,0x4b,0x3a,0x6c,0xac,0x51,0xff,0xba,
+	0xd3,0xdf,0x5a,0x24,0xf6,0xa6,0x5d,0xff,0x3a,0xe4,0xd0,0x63,0xba,0x98,0x73,0x1e,
+	0xff,0xa4,0x4a,0x80,0x70,0x3a,0xe6,0x06,0x77,0xff,0xba,0x17,0x5e,0x0d,0x24,0x4f,
+	0x3a,0x82,0xff,0x3a,0x80,0xae,0x85,0xba,0xbc,0x17,0x83,0xff,0xa3,0x7d,0xc9,0x8c,
+	0x3a,0x52,0x71,0x90,0xff,0xba,0x89,0x9a,0xeb,0x22,0x56,0xf6,0x97,0xff,0x3a,0x87,
+	0xd4,0x9b,0xba,0x6b,0xb9,0xf1,0xff,0xa3,0x4a,0xca,0xa3,0x3a,0x32,0xe2,0xa7,0xff,
+	0xba,0x2e,0x9d,0x96,0x23,0x69,0x4f,0xb0,0xff,0x3a,0x0e,0xa5,0xb4,0xba,0x6e,0x93,
+	0x3f,0xff,0xa4,0x71,0x91,0xbd,0x3a,0xda,0x28,0xc2,0xff,0xba,0x32,0x21,0xbe,0xa3,
+	0x78,0x9d,0xcb,0xff,0x3a,0xae,0x7b,0xd0,0xba,0x67,0xef,0x07,0xff,0xa3,0xee,0x82,
+	0xda,0x3a,0xf9,0xac,0xdf,0xff,0xba,0xa7,0xfb,0xec,0x24,0x98,0x51,0xea,0xff,0x3a,
+	0x83,0xcd,0xef,0xba,0xb5,0xe4,0x2f,0xff,0x24,0xec,0x1c,0xfb,0x3a,0xe1,0x78,0x00,
+	0xff,0xbb,0x50,0xc0,0x97,0x24,0x32,0x7d,0x06,0xff,0x3b,0x1a,0x98,0x09,0xbb,0xa3,
+	0xa4,0xf6,0xff,0x23,0x95,0x01,0x10,0x3b,0x56,0x51,0x13,0xff,0xbb,0x1d,0xfc,0xd1,
+	0x24,0xe2,0x29,0x1a,0xff,0x3b,0xdb,0xb3,0x1d,0xbb,0x06,0x94,0xa0,0xff,0xa4,0xb5,
+	0x06,0x25,0x3b,0xef,0xd0,0x28,0xff,0xbb,0xd1,0xf4,0x24,0x24,0x59,0xab,0x30,0xff,
+	0x3b,0x37,0xbd,0x34,0xbb,0xbb,0xa3,0x30,0xff,0xa3,0x9f,0x2e,0x3d,0x3b,0x59,0x90,
+	0x41,0xff,0xbb,0x1b,0xe9,0x8d,0x24,0x34,0xab,0x4a,0xff,0x3b,0xb0,0x66,0x4f,0xbb,
+	0xdb,0x96,0xa0,0xff,0x24,0xa4,0x40,0x59,0x3b,0xf6,0x61,0x5e,0xff,0xbb,0xaf,0x75,
+	0xb5,0xa3,0x2d,0x15,0x69,0xff,0x3b,0x98,0xaa,0x6e,0xbb,0x4e,0x6f,0xa5,0xff,0xa4,
+	0x9e,0x56,0x7a,0x3b,0xb5,0x38,0x80,0xff,0xbb,0xae,0xe6,0x1c,0x25,0x2a,0x9e,0x86,
+	0xff,0x3b,0xe8,0xf8,0x89,0xbb,0x65,0xfc,0x55,0xff,0xa4,0x8c,0x05,0x91,0x3b,0xb8,
+	0xba,0x94,0xff,0xbb,0x73,0x01,0x2a,0x24,0xd2,0x8b,0x9c,0xff,0x3b,0xdd,0xab,0xa0,
+	0xbb,0xde,0x19,0x52,0xff,0xa3,0x56,0x66,0xa9,0x3b,0x0d,0x06,0xae,0xff,0xbb,0xd0,
+	0x17,0xb9,0x24,0x4b,0xd9,0xb7,0xff,0x3b,0x87,0x13,0xbd,0xbb,0x1e,0x6d,0x2a,0xff,
+	0x24,0x9a,0x3c,0xc8,0x3b,0x56,0x34,0xce,0xff,0xbb,0xb1,0x2c,0x18,0x24,0x33,0x04,
+	0xdb,0xff,0x3b,0x3d,0xe8,0xe1,0xbb,0x45,0xbb,0x5e,0xff,0xa3,0xdb,0xcb,0xf0,0x3b,
+	0x0a,0xdc,0xf8,0xff,0xbb,0x82,0x2a,0xd7,0x24,0xfe,0x34,0x05,0xff,0x3c,0xb3,0xff,
+	0x09,0xbc,0xce,0xb5,0xc1,0xff,0xa4,0xe0,0x86,0x14,0x3c,0x95,0x54,0x1a,0xff,0xbc,
+	0x32,0x79,0xec,0x24,0x2a,0x39,0x27,0xff,0x3c,0x77,0x6a,0x2e,0xbc,0x7b,0x0d,0x68,
+	0xff,0xa3,0x5f,0x9d,0x3e,0x3c,0xec,0xc8,0x47,0xff,0xbc,0x91,0x16,0x48,0x23,0xa3,
+	0xce,0x5c,0xff,0x3c,0xf0,0xf0,0x68,0xbc,0x74,0x60,0x6b,0xff,0xa3,0xa4,0xb3,0x82,
+	0x3c,0xc5,0x20,0x8b,0xff,0xbc,0xcb,0xcb,0x1f,0x25,0x74,0x8a,0x9f,0xff,0x3c,0xe3,
+	0x12,0xac,0xbc,0xf1,0xc4,0x6d,0xff,0xa3,0x6c,0xe8,0xcb,0x3c,0x2e,0x90,0xe0,0xff,
+	0xbc,0xad,0x21,0x95,0x24,0xa6,0xa2,0x0c,0xff,0x3d,0x84,0xdc,0x20,0xbd,0x3b,0x36,
+	0x6f,0xff,0xa3,0x31,0x82,0x61,0x3d,0x89,0x03,0x8d,0xff,0xbd,0xec,0xbb,0x95,0x24,
+	0xb5,0x1b,0x0d,0xff,0x3e,0xde,0x21,0x8d,0xbe,0x9f,0xaa,0xaa,0x00,0x07,0x08,0x0f,
+	0x04,0x17,0x04,0x1f,0x04,0x27,0x04,0x2f,0x04,0x37,0x04,0x3f,0x04,0x00,0x47,0x04,
+	0x4f,0x04,0x57,0x04,0x5f,0x04,0x67,0x04,0x6f,0x04,0x77,0x04,0x7f,0x04,0x00,0x87,
+	0x04,0x8f,0x04,0x97,0x04,0x9f,0x04,0xa7,0x04,0xaf,0x04,0xb7,0x04,0xbf,0x04,0x00,
+	0xc7,0x04,0xcf,0x04,0xd7,0x04,0xdf,0x04,0xe7,0x04,0xef,0x04,0xf7,0x04,0xff,0x04,
+	0x00,0x07,0x05,0x0f,0x05,0x17,0x05,0x1f,0x05,0x27,0x05,0x2f,0x05,0x37,0x05,0x3f,
+	0x05,0x00,0x47,0x05,0x4f,0x05,0x57,0x05,0x5f,0x05,0x67,0x05,0x6f,0x05,0x77,0x05,
+	0x7f,0x05,0x00,0x87,0x05,0x8f,0x05,0x97,0x05,0x9f,0x05,0xa7,0x05,0xaf,0x05,0xb7,
+	0x05,0xbf,0x05,0x00,0xc7,0x05,0xcf,0x05,0xd7,0x05,0xdf,0x05,0xe7,0x05,0xef,0x05,
+	0xf7,0x05,0xff,0x05,0x00,0x07,0x06,0x0f,0x06,0x17,0x06,0x1f,0x06,0x27,0x06,0x2f,
+	0x06,0x37,0x06,0x3f,0x06,0x00,0x47,0x06,0x4f,0x06,0x57,0x06,0x5f,0x06,0x67,0x06,
+	0x6f,0x06,0x77,0x06,0x7f,0x06,0x00,0x87,0x06,0x8f,0x06,0x97,0x06,0x9f,0x06,0xa7,
+	0x06,0xaf,0x06,0xb7,0x06,0xbf,0x06,0x00,0xc7,0x06,0xcf,0x06,0xd7,0x06,0xdf,0x06,
+	0xe7,0x06,0xef,0x06,0xf7,0x06,0xff,0x06,0x00,0x07,0x07,0x0f,0x07,0x17,0x07,0x1f,
+	0x07,0x27,0x07,0x2f,0x07,0x37,0x07,0x3f,0x07,0x00,0x47,0x07,0x4f,0x07,0x57,0x07,
+	0x5f,0x07,0x67,0x07,0x6f,0x07,0x77,0x07,0x7f,0x07,0x00,0x87,0x07,0x8f,0x07,0x97,
+	0x07,0x9f,0x07,0xa7,0x07,0xaf,0x07,0xb7,0x07,0xbf,0x07,0x00,0xc7,0x07,0xcf,0x07,
+	0xd7,0x07,0xdf,0x07,0xe7,0x07,0xef,0x07,0xf7,0x07,0xff,0x07,0xff,0x00,0xba,0x22,
+	0x24,0x49,0x65,0x30,0xba,0xff,0x28,0x38,0x2b,0x3a,0x4d,0x66,0xfb,0x23,0xff,0xbd,
+	0x2b,0x21,0xba,0xa6,0x4b,0x1c,0x3a,0xff,0x70,0x3a,0xeb,0x23,0xe4,0xd5,0x12,0xba,
+	0xff,0x8d,0x3f,0x0e,0x3a,0xcc,0x8a,0x2f,0x23,0xff,0x59,0x5a,0x05,0xba,0xe0,0x0a,
+	0x01,0x3a,0xff,0x0c,0xf6,0xa3,0x23,0x2c,0x61,0xf1,0xb9,0xff,0x53,0x4a,0xe9,0x39,
+	0xaf,0x4b,0x57,0xa2,0xff,0xd7,0xa0,0xd9,0xb9,0x20,0x0d,0xd2,0x39,0xff,0x02,0xc4,
+	0x59,0x23,0xef,0x64,0xc3,0xb9,0xff,0x85,0x4f,0xbc,0x39,0xa3,0x35,0x4a,0xa3,0xff,
+	0x3a,0x9f,0xae,0xb9,0x6a,0x03,0xa8,0x39,0xff,0xcb,0x04,0x07,0x23,0x4c,0x42,0x9b,
+	0xb9,0xff,0xed,0x1b,0x95,0x39,0xd3,0x72,0x8e,0xa3,0xff,0x88,0x41,0x89,0xb9,0x92,
+	0x8c,0x83,0x39,0xff,0xa3,0x60,0x96,0x22,0x39,0x22,0x71,0xb9,0xff,0x59,0x93,0x66,
+	0x39,0x25,0x90,0x75,0xa2,0xff,0xbb,0x4a,0x52,0xb9,0xa6,0x8f,0x48,0x39,0xff,0x45,
+	0xdb,0x7e,0x23,0x61,0xe7,0x35,0xb9,0xff,0x93,0xf8,0x2c,0x39,0x58,0xf0,0x8f,0x22,
+	0xff,0xb0,0xe2,0x1b,0xb9,0xb9,0xb9,0x13,0x39,0xff,0x53,0xc3,0x29,0x23,0x88,0x28,
+	0x04,0xb9,0xff,0x63,0x7d,0xf9,0x38,0x05,0xc2,0x07,0xa3,0xff,0x9e,0x4a,0xdd,0xb8,
+	0xbd,0xe8,0xcf,0x38,0xff,0xc4,0x23,0xbb,0xa0,0xca,0x8c,0xb6,0xb8,0xff,0x16,0x90,
+	0xaa,0x38,0x46,0xf9,0x63,0x22,0xff,0x79,0xf2,0x93,0xb8,0xed,0x4e,0x89,0x38,0xff,
+	0x8d,0xed,0x77,0x22,0xb8,0xaf,0x6a,0xb8,0xff,0x88,0x03,0x58,0x38,0x6f,0x99,0x2d,
+	0xa2,0xff,0x1e,0x34,0x35,0xb8,0xd9,0x0b,0x25,0x38,0xff,0xea,0xfd,0x32,0xa1,0x85,
+	0x2d,0x07,0xb8,0xff,0x3f,0xe5,0xf2,0x37,0x07,0x35,0x8a,0xa0,0xff,0xd9,0xb1,0xc0,
+	0xb7,0x92,0xea,0xa9,0x37,0xff,0xad,0x8f,0x0c,0x22,0xd0,0xe8,0x80,0xb7,0xff,0xe7,
+	0x48,0x5d,0x37,0x18,0x45,0xd1,0x20,0xff,0xc0,0xfb,0x1c,0xb7,0xe9,0x23,0x01,0x37,
+	0xff,0x5a,0x75,0x80,0x20,0xd7,0xc5,0xa3,0xb6,0xff,0x86,0x9c,0x79,0x36,0x0d,0xf5,
+	0x3c,0xa0,0xff,0x57,0x55,0xfc,0xb5,0x89,0xbc,0xa0,0x35,0xff,0x40,0xac,0x94,0x1f,
+	0x0f,0x3a,0x9f,0xb4,0xdf,0x49,0x79,0x9e,0x33,0x00,0x00,0xb4,0x01,0x01,0xdf,0x02,
+	0x01,0x02,0x02,0x03,0x03,0x04,0x02,0x03,0xf3,0x03,0x04,0x07,0x14,0x03,0x04,0x03,
+	0x04,0x04,0x05,0x78,0x0f,0x34,0x07,0x14,0x03,0x04,0x04,0x05,0x05,0x06,0x1f,0x74,
+	0x78,0x0f,0x34,0x07,0x14,0x03,0x04,0x05,0x06,0x06,0x07,0x3f,0xf4,0xf0,0x1f,0x74,
+	0x0f,0x34,0x07,0x14,0x03,0x04,0x06,0x07,0x07,0x08,0x06,0xff,0x00,0x00,0x01,0x05,
+	0x05,0x03,0x00,0x0b,0x14,0x0d,0x0c,0x17,0x2c,0xc0,0x1b,0x24,0x2f,0x64,0x37,0x54,
+	0x5f,0xd4,0x6f,0xb4,0x5f,0xb8,0x80,0x40,0xff,0xc0,0x20,0xa0,0x60,0xe0,0x10,0x90,
+	0x50,0xff,0xd0,0x30,0xb0,0x70,0xf0,0x08,0x88,0x48,0xff,0xc8,0x28,0xa8,0x68,0xe8,
+	0x18,0x98,0x58,0xff,0xd8,0x38,0xb8,0x78,0xf8,0x04,0x84,0x44,0xff,0xc4,0x24,0xa4,
+	0x64,0xe4,0x14,0x94,0x54,0xff,0xd4,0x34,0xb4,0x74,0xf4,0x0c,0x8c,0x4c,0xff,0xcc,
+	0x2c,0xac,0x6c,0xec,0x1c,0x9c,0x5c,0xff,0xdc,0x3c,0xbc,0x7c,0xfc,0x02,0x82,0x42,
+	0xff,0xc2,0x22,0xa2,0x62,0xe2,0x12,0x92,0x52,0xff,0xd2,0x32,0xb2,0x72,0xf2,0x0a,
+	0x8a,0x4a,0xff,0xca,0x2a,0xaa,0x6a,0xea,0x1a,0x9a,0x5a,0xff,0xda,0x3a,0xba,0x7a,
+	0xfa,0x06,0x86,0x46,0xff,0xc6,0x26,0xa6,0x66,0xe6,0x16,0x96,0x56,0xff,0xd6,0x36,
+	0xb6,0x76,0xf6,0x0e,0x8e,0x4e,0xff,0xce,0x2e,0xae,0x6e,0xee,0x1e,0x9e,0x5e,0xff,
+	0xde,0x3e,0xbe,0x7e,0xfe,0x01,0x81,0x41,0xff,0xc1,0x21,0xa1,0x61,0xe1,0x11,0x91,
+	0x51,0xff,0xd1,0x31,0xb1,0x71,0xf1,0x09,0x89,0x49,0xff,0xc9,0x29,0xa9,0x69,0xe9,
+	0x19,0x99,0x59,0xff,0xd9,0x39,0xb9,0x79,0xf9,0x05,0x85,0x45,0xff,0xc5,0x25,0xa5,
+	0x65,0xe5,0x15,0x95,0x55,0xff,0xd5,0x35,0xb5,0x75,0xf5,0x0d,0x8d,0x4d,0xff,0xcd,
+	0x2d,0xad,0x6d,0xed,0x1d,0x9d,0x5d,0xff,0xdd,0x3d,0xbd,0x7d,0xfd,0x03,0x83,0x43,
+	0xff,0xc3,0x23,0xa3,0x63,0xe3,0x13,0x93,0x53,0xff,0xd3,0x33,0xb3,0x73,0xf3,0x0b,
+	0x8b,0x4b,0xff,0xcb,0x2b,0xab,0x6b,0xeb,0x1b,0x9b,0x5b,0xff,0xdb,0x3b,0xbb,0x7b,
+	0xfb,0x07,0x87,0x47,0xff,0xc7,0x27,0xa7,0x67,0xe7,0x17,0x97,0x57,0xff,0xd7,0x37,
+	0xb7,0x77,0xf7,0x0f,0x8f,0x4f,0xff,0xcf,0x2f,0xaf,0x6f,0xef,0x1f,0x9f,0x5f,0xdf,
+	0xdf,0x3f,0xbf,0x7f,0xff,0x01,0x01,0x00,0x02,0xaa,0x03,0x00,0x03,0x03,0x00,0x05,
+	0x03,0x00,0x0a,0x03,0x00,0x13,0xaa,0x03,0x00,0x25,0x03,0x00,0x47,0x03,0x00,0x8e,
+	0x03,0x00,0x16,0xfa,0x24,0x00,0x2c,0x24,0x00,0x4c,0x04,0x00,0x00,0x98,0xff,0x08,
+	0x00,0x00,0x18,0x11,0x00,0x00,0x30,0x85,0x22,0x03,0x00,0x44,0x3f,0xff,0x3f,0xff,
+	0x3f,0xff,0x3f,0xe7,0x53,0xff,0x68,0x61,0x70,0x69,0x72,0x6f,0x54,0x61,0xff,0x73,
+	0x6b,0x00,0x4b,0x4e,0x5f,0x45,0x78,0xff,0x31,0x5f,0x31,0x2e,0x30,0x2e,0x31,0x38,
+	0xfe,0x1a,0x01,0x54,0x72,0x69,0x6c,0x6c,0x20,0x70,0xff,0x72,0x6f,0x63,0x65,0x73,
+	0x73,0x20,0x73,0xbf,0x74,0x61,0x72,0x74,0x65,0x64,0x17,0x00,0x50,0xef,0x4c,0x00,
+	0x00,0x43,0x3b,0x01,0x74,0x70,0x20,0xff,0x66,0x61,0x69,0x6c,0x00,0x46,0x69,0x72,
+	0xff,0x73,0x74,0x20,0x50,0x61,0x72,0x61,0x6d,0xff,0x65,0x74,0x65,0x72,0x20,0x76,
+	0x61,0x6c,0xbf,0x75,0x65,0x20,0x73,0x65,0x74,0x2b,0x00,0x53,0xdf,0x65,0x63,0x6f,
+	0x6e,0x64,0x1c,0x4c,0x53,0x65,0xfd,0x74,0x17,0x18,0x3a,0x42,0x61,0x64,0x20,0x69,
+	0x3f,0x6e,0x70,0x75,0x74,0x20,0x70,0x13,0x14,0x3e,0x00,0xfb,0x00,0x47,0x23,0x80,
+	0x61,0x75,0x74,0x68,0x5f,0xff,0x63,0x68,0x5f,0x72,0x65,0x73,0x70,0x5f,0xf8,0x91,
+	0x04,0xa5,0x00,0x37,0x14,0x42,0x6c,0x6f,0x63,0x6b,0xf3,0x50,0x74,0x3b,0x00,0x08,
+	0x04,0x53,0x69,0x7a,0x65,0xff,0x20,0x69,0x73,0x20,0x65,0x78,0x63,0x65,0xff,0x65,
+	0x64,0x69,0x6e,0x67,0x20,0x61,0x6c,0x1b,0x6c,0x6f,0xd5,0x00,0x20,0x73,0x19,0x00,
+	0x4b,0x04,0x00,0x05,0xaf,0x4f,0x70,0x65,0x6e,0x0b,0x04,0x74,0xff,0x04,0x5f,0xf7,
+	0x69,0x6e,0x69,0xab,0x00,0x43,0x46,0x47,0x49,0xfe,0x13,0x04,0x5c,0x30,0x00,0x00,
+	0x46,0x54,0x50,0xfd,0x6b,0x0b,0x04,0x75,0x6e,0x6b,0x6e,0x6f,0x77,0xdf,0x6e,0x00,
+	0x6e,0x6f,0x6e,0x3b,0x08,0x63,0x68,0xbf,0x65,0x63,0x6b,0x73,0x75,0x6d,0x0b,0x24,
+	0x20,0x7f,0x28,0x38,0x2d,0x62,0x69,0x74,0x29,0x13,0x08,0x7b,0x72,0x63,0x56,0x05,
+	0x00,0x43,0x52,0x43,0x16,0x18,0xb6,0x13,0x00,0x31,0x36,0x13,0x14,0x31,0x36,0x2b,
+	0x24,0x32,0x6d,0x34,0x17,0x14,0x32,0x34,0x17,0x24,0x33,0x32,0x17,0x14,0x7b,0x33,
+	0x32,0x17,0x18,0x72,0x65,0x70,0x33,0x07,0x10,0xbf,0x65,0x61,0x74,0x28,0x33,0x29,
+	0x0b,0x0c,0x35,0xfa,0x13,0x20,0x35,0x13,0x04,0x68,0x37,0x34,0x00,0x48,0xf7,0x61,
+	0x6d,0x6d,0xfb,0x00,0x28,0x37,0x2c,0x34,0xd6,0x3b,0x08,0x68,0x38,0x13,0x1c,0x38,
+	0x13,0x14,0x31,0x32,0xbc,0xab,0x08,0x17,0x14,0x31,0x32,0x2c,0x38,0x18,0x04,0x67,
+	0xf7,0x32,0x34,0x31,0x7f,0x04,0x47,0x6f,0x6c,0x61,0xdd,0x79,0x98,0x00,0x2c,0x31,
+	0x32,0x2f,0x08,0x73,0x65,0xbf,0x63,0x64,0x65,0x64,0x32,0x32,0xcc,0x04,0x53,0xff,
+	0x45,0x43,0x2d,0x44,0x45,0x43,0x28,0x32,0xdf,0x32,0x2c,0x31,0x36,0x29,0x1b,0x14,
+	0x33,0x39,0x7c,0xb8,0x04,0x1b,0x14,0x33,0x39,0x2c,0x33,0x32,0x1b,0x18,0xef,0x37,
+	0x32,0x36,0x34,0x1b,0x1c,0x37,0x32,0x2c,0xbd,0x36,0x85,0x04,0x76,0x32,0x37,0x00,
+	0x3d,0x02,0x76,0xff,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x61,0xff,0x6c,0x20,0x72,
+	0x31,0x2f,0x32,0x20,0x4b,0xab,0x3d,0x37,0x1b,0x04,0x39,0x1b,0x4c,0x39,0x1b,0x00,
+	0x33,0x9a,0x1b,0x40,0x33,0x1b,0x10,0x36,0x31,0x13,0x09,0x1f,0x38,0x36,0xb8,0x1f,
+	0x00,0x1a,0x00,0x73,0x00,0x70,0x32,0x33,0x1f,0x38,0x32,0xfe,0x3f,0x08,0x37,0x20,
+	0x28,0x70,0x75,0x6e,0x63,0xdf,0x74,0x75,0x72,0x65,0x64,0x9f,0x0c,0x70,0x33,0xdd,
+	0x34,0x2b,0x38,0x33,0x2f,0x34,0x2b,0x4c,0x34,0x35,0x6e,0x2b,0x38,0x34,0x2f,0x35,
+	0x2b,0x4c,0x35,0x36,0x2b,0x38,0xd9,0x35,0xa3,0x08,0x2b,0x40,0x36,0x37,0x2b,0x38,
+	0x36,0x2f,0xed,0x37,0x2b,0x4c,0x37,0x38,0x2b,0x38,0x37,0x2f,0x38,0x0a,0x2b,0x44,
+	0x39,0x07,0x5d,0x39,0x2b,0x3c,0x07,0x59,0x2b,0x40,0x07,0x59,0x80,0x2b,0x40,0x07,
+	0x59,0x2b,0x40,0x07,0x59,0x2b,0x40,0x07,0x59,0x2b,0x30,0x72,0xff,0x73,0x38,0x00,
+	0x52,0x65,0x65,0x64,0x2d,0xff,0x53,0x6f,0x6c,0x6f,0x6d,0x6f,0x6e,0x2c,0x7f,0x20,
+	0x32,0x32,0x33,0x2f,0x32,0x35,0x44,0x0a,0xfe,0x00,0x00,0x2c,0xa1,0x60,0x20,0x7c,
+	0xb8,0x60,0xfd,0x20,0x0e,0x10,0x00,0x10,0x5f,0x00,0x20,0x28,0xff,0xe5,0x01,0x20,
+	0x22,0x02,0x00,0x00,0x80,0xf3,0x56,0x00,0x17,0x18,0x00,0x14,0x44,0x0f,0x60,0x20,
+	0x7d,0x08,0x07,0x00,0xc4,0x18,0x60,0x20,0x03,0x07,0x00,0xdf,0xe0,0x36,0x60,0x20,
+	0x05,0x07,0x00,0x04,0x3b,0xf7,0x60,0x20,0x06,0x07,0x00,0x54,0x61,0x60,0x20,0x7d,
+	0x04,0x07,0x00,0xe4,0x3f,0x60,0x20,0x07,0x07,0x00,0x5f,0x9c,0x49,0x60,0x20,0x09,
+	0x3b,0x10,0xff,0x00,0x00,0xdb,0x0c,0x71,0x2f,0x0c,0x30,0x7c,0x27,0x0c,0x2c,0x7f,
+	0x57,0x60,0x20,0x10,0x07,0x10,0x11,0x07,0x10,0x12,0x07,0x10,0xd5,0x13,0x07,0x10,
+	0x14,0x07,0x10,0x15,0x07,0x00,0x78,0x81,0x67,0x60,0x20,0x02,0x4f,0x20,0x06,0x00,
+	0x01,0x00,0x04,0x14,0xd6,0x00,0x00,0x07,0x00,0x00,0xac,0x22,0x3b,0x20,0xff,0x01,
+	0xf8,0x1f,0x3c,0x61,0x08,0x00,0xf0,0x44,0x42,0x55,0x47,0x48,0x2f,0x45,0x41,0x44,
+	0x00,0x4b,0xec,0x01,0x1c,0xc4,0x17,0x14,0xff,0x80,0x10,0x60,0x20,0x80,0x14,0x60,
+	0x20,0xbf,0xd4,0x13,0x60,0x20,0xe4,0x1d,0xef,0x1d,0xd0,0xef,0x29,0x00,0x20,0x40,
+	0x03,0x00,0x42,0x00,0x24,0xfe,0x30,0x10,0x02,0x03,0x07,0x04,0x0a,0x0a,0x0c,0x2f,
+	0x2b,0x60,0x20,0xb0,0x03,0x04,0x2c,0x2f,0x00,0x03,0x00,0xff,0xf8,0x2f,0x60,0x20,
+	0x58,0x30,0x60,0x20,0xfb,0xe8,0x32,0x07,0x00,0x31,0x60,0x20,0x34,0x35,0x7f,0x60,
+	0x20,0xe0,0x2d,0x60,0x20,0x50,0x17,0x00,0x55,0x6c,0x07,0x00,0xc8,0x03,0x00,0xa4,
+	0x03,0x00,0x80,0x03,0x00,0x5f,0x70,0x6f,0x60,0x20,0x0c,0x33,0x00,0x14,0x0b,0x00,
+	0x3f,0x88,0x39,0x60,0x20,0xd0,0x3a,0x0b,0x00,0x07,0x00,0x7d,0x38,0x03,0x00,0x7c,
+	0x37,0x60,0x20,0x68,0x03,0x00,0xf5,0x48,0x2f,0x02,0xc0,0x03,0x00,0x34,0x3c,0x60,
+	0x20,0xcd,0xa8,0x03,0x00,0x1c,0x3d,0x67,0x00,0x03,0x00,0x78,0x3e,0xd7,0x60,0x20,
+	0xa0,0x3b,0x02,0xdc,0x03,0x00,0x94,0x48,0xf7,0x60,0x20,0xcc,0x03,0x00,0x08,0x5f,
+	0x60,0x20,0xbf,0x4c,0x53,0x60,0x20,0xd8,0x60,0x6f,0x00,0x5b,0xd4,0x6f,0x00,0x03,
+	0x00,0x88,0x03,0x00,0xa0,0x03,0x00,0xc0,0x56,0xcf,0x60,0x20,0x60,0x59,0x7f,0x00,
+	0x0b,0x00,0xac,0x5e,0xfb,0x60,0x20,0x62,0x35,0x0a,0x0d,0x10,0x13,0x19,0xdf,0x28,
+	0x1f,0x11,0x29,0x2a,0xab,0x02,0x10,0x00,0xeb,0x20,0x64,0x1f,0x30,0x30,0x00,0x08,
+	0x29,0x20,0x48,0xff,0x65,0x6c,0x6c,0x6f,0x20,0x66,0x72,0x6f,0xff,0x6d,0x20,0x49,
+	0x41,0x36,0x31,0x31,0x21,0x00,0xf6,0xfd,0x00,0xfc,0x00,0xfc,0x00,0xfc,0x00,0xfc,
+	0x00,0xfc,0x00,0xfc,0x00,0x5c,0xe7,0x61,0x00,0x20,0x0e,0x24,0xfe,0x02,0x04,0x05,
+	0x06,0xbf,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0f,0x04,0x5c,0x57,0x52,0x00,0x20,0x03,
+	0x04,0x64,0x03,0x10,0x6c,0x03,0x00,0x55,0x78,0x03,0x00,0x8c,0x03,0x00,0x94,0x03,
+	0x00,0xa0,0x03,0x00,0x55,0xa8,0x03,0x00,0xb8,0x03,0x00,0xc0,0x03,0x00,0xd0,0x03,
+	0x00,0x53,0xd8,0x52,0x53,0x1c,0x3f,0x34,0xe8,0x03,0x00,0xf0,0x03,0x00,0x7d,0xfc,
+	0x03,0x00,0x04,0x53,0x00,0x20,0x10,0x03,0x00,0x55,0x14,0x03,0x00,0x24,0x03,0x00,
+	0x28,0x03,0x00,0x38,0x03,0x00,0x55,0x40,0x03,0x00,0x50,0x03,0x00,0x58,0x03,0x00,
+	0x68,0x03,0x00,0x55,0x74,0x03,0x00,0x84,0x03,0x00,0x90,0x03,0x00,0xa0,0x03,0x00,
+	0x55,0xac,0x03,0x00,0xbc,0x03,0x00,0xc0,0x03,0x00,0xd8,0x03,0x00,0xd5,0xdc,0x03,
+	0x00,0xf4,0x03,0x00,0xf8,0x4f,0x04,0x54,0x00,0xab,0x20,0x18,0x03,0x00,0x30,0x03,
+	0x00,0x38,0x03,0x00,0x5c,0xaa,0x03,0x00,0x64,0x03,0x00,0x88,0x03,0x00,0x90,0x03,
+	0x00,0xb4,0xaa,0x03,0x00,0xbc,0x03,0x00,0xe0,0x03,0x00,0xe8,0x03,0x00,0x0c,0xa9,
+	0x55,0x7f,0x00,0x03,0x00,0x38,0x03,0x00,0x40,0x03,0x00,0x64,0xaa,0x03,0x00,0x6c,
+	0x03,0x00,0x90,0x03,0x00,0x98,0x03,0x00,0xbc,0xaa,0x03,0x00,0xc4,0x03,0x00,0xe8,
+	0x03,0x00,0xf0,0x2b,0x04,0x56,0xd7,0x00,0x20,0x1c,0x03,0x00,0x40,0x03,0x00,0x44,
+	0x56,0xd4,0x3b,0x2d,0x00,0x84,0x6d,0x03,0x00,0x4f,0x03,0x00,0xaf,0x01,0x57,0x00,
+	0x00,0x1d,0x03,0x00,0xed,0x03,0x00,0x9b,0x03,0x00,0xfb,0x27,0x01,0x1f,0x0c,0x99,
+	0x45,0x00,0x00,0xa5,0xff,0x4e,0x00,0x00,0x47,0x5d,0x00,0x00,0xf3,0xff,0x76,0x00,
+	0x00,0xb7,0x7e,0x00,0x00,0x5f,0xf5,0x69,0x3f,0x24,0x4f,0x3b,0x00,0x1d,0x01,0xed,
+	0x01,0xfb,0x9b,0x01,0x33,0x04,0x99,0x45,0xa5,0x4e,0x47,0x5f,0x5d,0xf3,0x76,0xb7,
+	0x7e,0x25,0x0c,0x01,0x03,0x20,0x11,0x00,0x0b,0x40,0x07,0x24,0x2f,0x34,0x01,0x1b,
+	0x30,0x3f,0x74,0x4f,0x74,0x20,0x23,0x64,0x7b,0x64,0x33,0x44,0x6f,0xa4,0xcb,0x54,
+	0x00,0x1b,0xa1,0x27,0x54,0xd0,0x7f,0x54,0x6b,0xb5,0x07,0x55,0x3b,0x54,0x15,0x03,
+	0x00,0x78,0x02,0xef,0x60,0x20,0x20,0x57,0x77,0x02,0x00,0x01,0x50,0xdf,0x0c,0x60,
+	0x01,0x50,0x3c,0x07,0x00,0x04,0x00,0x77,0x05,0x50,0x00,0x03,0x00,0x04,0x00,0x02,
+	0x07,0x00,0xff,0x02,0x50,0xc0,0x1c,0x00,0x20,0x23,0x00,0xf7,0x04,0x00,0x48,0x1b,
+	0x00,0x00,0x00,0x40,0x20,0xfb,0xa0,0x00,0x0b,0x03,0x5d,0x40,0x20,0xcc,0x10,0xd7,
+	0xad,0xde,0x84,0xaf,0x02,0x80,0x03,0x00,0x04,0x20,0xec,0x1b,0x00,0x03,0x00,0xcd,
+	0x10,0x1c,0x00,0x03,0x00,0x20,0xdd,0x42,0x60,0x04,0x03,0x60,0x20,0xf0,0x03,0xe4,
+	0x13,0xff,0x20,0x61,0x00,0x21,0xdc,0xff,0x12,0x02,0xff,0x00,0x21,0xdb,0xff,0x0c,
+	0x04,0x49,0x02,0xbf,0x21,0xda,0xff,0x42,0xa0,0x76,0x07,0x00,0xd9,0xb7,0xff,0x0c,
+	0x14,0x06,0x08,0x1c,0xf4,0x06,0x00,0xd8,0xf7,0xff,0x3c,0xe4,0x06,0x00,0xd7,0xff,
+	0x42,0xa1,0xfd,0xff,0x07,0x00,0xd6,0xff,0x3c,0xc4,0x49,0x02,0xff,0x56,0x01,0x04,
+	0x0c,0x11,0x10,0x49,0x13,0xff,0x00,0x48,0x13,0x10,0x20,0x00,0x02,0xa0,0xff,0x00,
+	0x11,0xd1,0xff,0x31,0xd1,0xff,0x30,0xbd,0xe6,0x0e,0x04,0x15,0x09,0x00,0xc5,0x55,
+	0x00,0xcf,0xfe,0x46,0x00,0x38,0x02,0x40,0x43,0x10,0x21,0xcd,0xe7,0xff,0xdc,0x34,
+	0x04,0x00,0x64,0x08,0xcc,0xff,0xf1,0x77,0xcc,0xff,0x06,0xf0,0x04,0x21,0xc7,0xff,
+	0x2c,0x00,0xfb,0xa0,0x02,0x0a,0x00,0x11,0xc9,0xff,0x28,0x01,0xff,0x11,0xc8,0xff,
+	0x48,0x01,0x00,0x12,0x40,0xff,0x0c,0x15,0x00,0x55,0xa1,0x7c,0xf6,0x50,0xff,0x66,
+	0x30,0x11,0xc5,0xff,0x78,0x01,0x50,0xff,0x77,0x20,0x79,0x01,0x11,0xc3,0xff,0x00,
+	0xfd,0xf4,0x5b,0x04,0x78,0x01,0x60,0x77,0x10,0x79,0xff,0x01,0x78,0x04,0x1c,0x47,
+	0x79,0x04,0xc5,0xdb,0x01,0x00,0x1f,0x10,0x05,0x01,0x19,0x14,0x00,0xf4,0xfd,0x03,
+	0x26,0x00,0x0d,0xf0,0x00,0x0c,0x07,0x81,0xff,0xb7,0xff,0x1b,0x77,0x87,0x37,0xfa,
+	0x0d,0xff,0xf0,0x36,0x41,0x00,0x21,0xb5,0xff,0x82,0xff,0x22,0x39,0x0c,0x0a,0xe0,
+	0x08,0x00,0x82,0xfb,0x22,0x2c,0x05,0x00,0x1d,0xf0,0x00,0x00,0x51,0xff,0x48,0x00,
+	0x00,0x28,0x04,0x60,0x20,0x70,0xeb,0x23,0x61,0xdf,0x03,0x08,0x89,0x00,0xf0,0x7f,
+	0xff,0xef,0xff,0x1f,0x00,0x20,0x35,0x01,0x68,0x54,0x00,0xfb,0x20,0x64,0x43,0x01,
+	0x81,0xf9,0xff,0x3d,0xf0,0xf2,0x2f,0x10,0x90,0x0f,0x00,0x47,0x05,0x20,0x04,0x00,
+	0x20,0xa9,0xd0,0x0b,0x04,0xa3,0x01,0xf4,0x0b,0x00,0xa4,0x5e,0x01,0xc8,0xcf,0x18,
+	0x00,0x20,0xa0,0x0b,0x00,0x7b,0x15,0x28,0xe5,0xff,0x01,0x20,0x10,0x5f,0x00,0x20,
+	0x60,0x0e,0xbe,0xcb,0x01,0x02,0x00,0x20,0x70,0x2c,0x56,0x00,0x2e,0xdf,0x00,0x20,
+	0xf8,0x42,0x60,0x17,0x08,0xd4,0x0b,0xff,0x60,0x20,0xc8,0x20,0x00,0x20,0x40,0x42,
+	0xc7,0x0f,0x00,0x20,0x2f,0x00,0x09,0x01,0x0f,0x08,0xcc,0x24,0xfe,0x0b,0x00,0x29,
+	0x00,0x20,0x08,0x43,0x40,0x20,0xff,0x00,0x1e,0x01,0x50,0xff,0x0f,0x00,0x00,0x5f,
+	0xff,0x00,0xf0,0xff,0xff,0x08,0x04,0x4e,0xeb,0x05,0xf7,0x02,0x00,0x0b,0x03,0x00,
+	0xff,0xff,0xfd,0xff,0xf5,0x14,0x0c,0x04,0x5e,0x13,0x00,0xfe,0x00,0x50,0x58,0xff,
+	0x31,0x60,0x20,0x4c,0x53,0x60,0x20,0x80,0xa9,0x14,0x57,0x00,0x73,0x04,0x51,0x47,
+	0x00,0x0a,0x3b,0x00,0xff,0x37,0x00,0x00,0x6c,0x97,0x00,0x20,0x58,0x9f,0x00,0xaf,
+	0x00,0x3f,0xbc,0x06,0x40,0x20,0xd0,0xaa,0xea,0x00,0x17,0x00,0x5f,0x2f,0x80,0x00,
+	0x00,0x19,0x03,0x00,0xd1,0x0f,0x00,0x49,0xa0,0xd7,0x00,0x2d,0x04,0x2e,0x0f,0x00,
+	0x19,0x04,0x48,0x2f,0x00,0xf5,0x5c,0x03,0x00,0x20,0x8b,0x00,0x00,0xbe,0x04,0x50,
+	0xeb,0x00,0x0e,0x77,0x02,0xfe,0x6b,0x04,0x04,0x50,0x9e,0xff,0x28,0x00,0x20,0x1c,
+	0x23,0x00,0x20,0x10,0xef,0x10,0x40,0x20,0x14,0xcb,0x00,0x00,0x0e,0x01,0xf3,0x50,
+	0x4c,0x0f,0x00,0x42,0x05,0x6c,0x4e,0x60,0x20,0xff,0x1c,0x4f,0x60,0x20,0x14,0x28,
+	0x60,0x20,0xff,0x7c,0x27,0x60,0x20,0xcc,0x26,0x60,0x20,0xff,0xe4,0x21,0x60,0x20,
+	0x3c,0x4a,0x60,0x20,0x5f,0xb4,0x23,0x60,0x20,0xec,0x13,0x00,0xd4,0x1b,0x00,0x95,
+	0x38,0x37,0x00,0xe4,0x33,0x04,0x04,0xbb,0x01,0x67,0x00,0x0c,0x2f,0x2b,0x60,0x20,
+	0xb0,0x03,0x04,0x2c,0x2f,0x00,0x03,0x00,0xcb,0xf0,0x2a,0x2b,0x01,0x2f,0x2b,0x00,
+	0xb3,0x00,0x58,0x30,0x57,0x60,0x20,0x05,0x27,0x00,0x3c,0x33,0x00,0x90,0x2b,0x00,
+	0xfd,0x40,0x07,0x00,0x20,0x2b,0x00,0x20,0x12,0x34,0xff,0x00,0x00,0x49,0x4f,0x53,
+	0x54,0x52,0x45,0x7f,0x41,0x4d,0x00,0x00,0x43,0x21,0xc4,0x2b,0x00,0xfd,0x10,0x17,
+	0x00,0x44,0x42,0x55,0x47,0x48,0x45,0x57,0x41,0x44,0xc0,0x2b,0x00,0x44,0x2b,0x00,
+	0x9c,0x9f,0x01,0xfd,0xd8,0x0b,0x00,0x00,0x40,0x90,0x02,0xff,0x0f,0x6c,0x4a,0x01,
+	0x4e,0x01,0x00,0x10,0x5b,0x01,0xff,0xf3,0x56,0x01,0xd7,0xa4,0x00,0x40,0x33,0x00,
+	0x50,0x03,0x00,0x00,0xd0,0xb7,0x07,0x00,0x34,0x07,0x04,0x00,0x40,0x09,0x01,0xbf,
+	0x2b,0xff,0xe4,0x8c,0x03,0x30,0x0f,0x04,0x80,0xb0,0x02,0xff,0x01,0x6b,0x00,0x0f,
+	0xa2,0x0b,0x78,0x41,0x00,0x87,0x6c,0x6b,0x00,0xac,0x83,0x07,0x0f,0x00,0x08,0x40,
+	0xdb,0x01,0x70,0x27,0x00,0xe0,0xca,0x03,0x00,0xa0,0x03,0x00,0x10,0x0f,0x00,0xd5,
+	0x03,0x50,0x14,0xaf,0x14,0x40,0x20,0xfc,0x77,0x00,0x70,0x03,0x00,0x30,0x52,0x87,
+	0x00,0x48,0x03,0x06,0x03,0x00,0x58,0x03,0x00,0x34,0x0f,0x00,0xde,0x47,0x00,0xfe,
+	0xff,0xff,0x7f,0x89,0x01,0x04,0x00,0xc5,0xd2,0x93,0x05,0x00,0x18,0x07,0xd3,0x01,
+	0x10,0x00,0x12,0x34,0xdd,0x14,0x10,0x08,0xff,0xff,0xf7,0x1f,0x00,0x80,0x00,0xf9,
+	0x60,0x33,0x00,0x2e,0x08,0xff,0xff,0xfb,0x04,0x59,0xf8,0x4b,0x00,0x77,0x05,0x00,
+	0x00,0x38,0xd0,0x0b,0x00,0x4c,0xde,0x0b,0x04,0xfe,0xff,0x3f,0x10,0x5f,0x02,0x00,
+	0x00,0x7f,0x33,0x90,0x00,0x80,0xff,0x3f,0x8c,0x9f,0x00,0xfb,0x64,0x19,0x20,0x00,
+	0x40,0x0d,0x5f,0x80,0xbb,0xfe,0x07,0x08,0x61,0xb0,0x66,0x60,0x20,0xfc,0x67,0x4f,
+	0x60,0x20,0x54,0x68,0x63,0x01,0x03,0x00,0x38,0x0b,0x00,0xff,0xc4,0x62,0x60,0x20,
+	0xe0,0x61,0x60,0x20,0x5f,0x18,0x63,0x60,0x20,0x40,0x0b,0x00,0xa8,0x03,0x00,0x65,
+	0xc4,0x17,0x00,0x90,0x2b,0x04,0x13,0x00,0x14,0x69,0x53,0x02,0xff,0x3e,0x00,0x00,
+	0xec,0x0d,0x00,0x00,0xdd,0xfd,0x0e,0x07,0x00,0x1d,0x00,0x00,0x8c,0x6f,0x60,0xbb,
+	0x20,0xc0,0x03,0x00,0x30,0x71,0x60,0x77,0x04,0x1f,0xce,0x9e,0x00,0x00,0x4c,0x70,
+	0x57,0x00,0x03,0x00,0x00,0x02,0xc7,0x20,0x50,0x78,0x9b,0x08,0x45,0x03,0xb8,0x04,
+	0x00,0x10,0xed,0x00,0xc9,0x00,0x80,0x7c,0xa3,0x08,0x1f,0x50,0x90,0xbe,0x33,0x00,
+	0x04,0x77,0x60,0x20,0x58,0x07,0x00,0xe0,0x56,0x07,0x00,0x48,0x22,0x23,0x03,0x78,
+	0x0f,0x00,0x7a,0xeb,0x01,0xf9,0x7b,0x53,0x00,0xdb,0x00,0xb0,0x2f,0x00,0x20,0x94,
+	0xde,0x2f,0x05,0x00,0x02,0x50,0x50,0x03,0x00,0xcc,0x7d,0x4a,0x0f,0x02,0x7e,0x93,
+	0x00,0x30,0x1b,0x00,0x03,0x00,0xd0,0x03,0x00,0x35,0xf0,0x03,0x00,0x20,0x03,0x00,
+	0x00,0x31,0x2b,0x03,0x07,0x00,0x7d,0x98,0x2f,0x00,0x58,0x7f,0x60,0x20,0xdc,0x03,
+	0x00,0xfb,0x10,0x80,0xcb,0x00,0x1f,0x00,0x00,0xc0,0x5d,0x54,0xd7,0x02,0x17,0x00,
+	0x5c,0x43,0x00,0x58,0x03,0x00,0x4c,0x03,0x00,0xd5,0x54,0x03,0x00,0x78,0x1f,0x00,
+	0x50,0x03,0x00,0xe0,0x81,0x7a,0x7f,0x00,0x86,0xb3,0x00,0x10,0x06,0x50,0x10,0x43,
+	0x00,0xff,0xff,0x3f,0x00,0x00,0xa8,0x84,0x60,0x20,0xdf,0xa0,0x85,0x60,0x20,0x03,
+	0xb9,0x00,0xff,0xef,0xb2,0x5f,0x01,0x39,0x03,0x01,0x03,0x00,0x60,0x59,0xf3,0x00,
+	0x56,0xfc,0x2b,0x00,0x49,0x01,0xa4,0x88,0x60,0x20,0xe8,0x89,0x57,0x60,0x20,0x2c,
+	0x03,0x00,0x10,0x7f,0x00,0x0c,0x13,0x00,0x3f,0xba,0x49,0x0c,0x2c,0x40,0x04,0x38,
+	0x02,0x03,0x00,0xf5,0x80,0x03,0x00,0xc0,0x0b,0x04,0x02,0x00,0x40,0x4c,0xfe,0xcf,
+	0x00,0x36,0x41,0x00,0x51,0xf1,0xfe,0x71,0xff,0xf1,0xfe,0x28,0x15,0x72,0x27,0x47,
+	0x26,0xff,0x02,0x27,0x88,0x17,0xc8,0x35,0x4d,0x07,0xff,0x26,0x08,0x16,0x68,0x05,
+	0xb8,0x34,0xa8,0xff,0x14,0x8c,0x56,0x98,0x15,0xa7,0x99,0x01,0xff,0x69,0x04,0x5e,
+	0x0b,0xd4,0x82,0x00,0x00,0xff,0xdc,0x22,0x5e,0x0c,0xc5,0xa2,0x00,0x01,0xdf,0xd8,
+	0x22,0x1d,0xf0,0x00,0x3b,0x00,0x31,0xe3,0xff,0xfe,0x82,0x23,0x46,0xcc,0xe8,0xbe,
+	0x04,0xff,0x0a,0x14,0x07,0x00,0xa1,0x1b,0xa5,0x21,0xff,0x00,0x91,0xdf,0xfe,0xa9,
+	0x69,0xa2,0x23,0xff,0x47,0xb8,0x1a,0x9d,0x0a,0x0e,0x0b,0x72,0xff,0x00,0x07,0x01,
+	0xc1,0x1b,0xb8,0x09,0x8c,0xef,0x4b,0xe0,0x0b,0x00,0x15,0x00,0x8b,0x22,0xaa,0xbf,
+	0x92,0xc8,0x19,0x66,0x0c,0xec,0x3f,0x0c,0x21,0xff,0xd3,0xfe,0x88,0x62,0xa1,0xd4,
+	0xfe,0xe0,0xaf,0x08,0x00,0x88,0x42,0x04,0x04,0x52,0x04,0x00,0xb2,0xff,0x22,0x49,
+	0x92,0x22,0x60,0x82,0x22,0x46,0xff,0xa1,0xce,0xfe,0xb0,0x99,0xa0,0x98,0x09,0x3f,
+	0x99,0x9a,0x88,0xa8,0x88,0x18,0x19,0x00,0x13,0x00,0xfb,0x88,0x68,0x09,0x08,0x65,
+	0x20,0x03,0x25,0xbf,0xff,0x02,0xa5,0x18,0x03,0xe5,0x78,0x05,0xe5,0xeb,0xf7,0x03,
+	0x4d,0x00,0x00,0x8f,0x08,0xc3,0xfe,0x88,0xfd,0xe3,0x1e,0x00,0x2d,0x0a,0x65,0xf2,
+	0xff,0x41,0xdf,0xbc,0xfe,0x82,0x24,0x2c,0x0d,0x00,0xa1,0xbc,0xff,0xfe,0xd1,0xbe,
+	0xfe,0xc1,0xb9,0xfe,0x9e,0xfb,0xbd,0xeb,0x8f,0x00,0x1d,0x1b,0xb9,0x0d,0xb2,0xff,
+	0x6c,0x10,0x99,0x5a,0x65,0x1a,0x00,0x0c,0xff,0x1a,0x25,0x24,0x00,0x65,0xf3,0xff,
+	0x25,0xff,0xf7,0xff,0x91,0xb7,0xfe,0xb2,0x24,0x5b,0xff,0x92,0x09,0x31,0xa2,0x24,
+	0x57,0xc1,0xb5,0xff,0xfe,0xba,0xb9,0xb2,0x0b,0x00,0xb9,0x0c,0xff,0xa0,0x99,0xa0,
+	0xad,0x02,0xb1,0xb2,0xfe,0x5f,0xc0,0x20,0x00,0x88,0xf3,0x8a,0x00,0x0b,0xa5,0x04,
+	0xed,0x13,0x04,0x00,0x1d,0xf0,0x6f,0x00,0x81,0xaa,0xfe,0xff,0x31,0xac,0xfe,0x82,
+	0x08,0x08,0xa1,0xac,0xef,0xfe,0x5e,0x28,0x02,0x5c,0x00,0x59,0x1b,0x37,0xff,0xba,
+	0x1d,0x9d,0x0a,0x90,0xb3,0xc0,0x3b,0xff,0xbb,0xb0,0xb2,0x21,0x16,0x0b,0x01,0x26,
+	0xdf,0x1b,0x02,0x76,0x9b,0x0a,0x3f,0x00,0x2e,0x79,0xff,0x09,0x20,0x81,0x00,0x80,
+	0x22,0xa5,0xe4,0xff,0x06,0x25,0xfe,0x01,0xe5,0xfb,0x05,0x25,0xff,0x63,0x06,0xa5,
+	0x62,0x07,0x25,0x75,0x07,0xff,0x61,0xa2,0xfe,0x41,0xa2,0xfe,0xa1,0x9e,0xff,0xfe,
+	0x81,0x9f,0xfe,0x91,0x9d,0xfe,0xd1,0xff,0x90,0xfe,0xc1,0x91,0xfe,0xb1,0x98,0xfe,
+	0xff,0x22,0x4d,0x06,0x22,0x4d,0x00,0x21,0x97,0xff,0xfe,0xb2,0x6c,0x14,0xb1,0x9c,
+	0xfe,0x92,0xff,0x62,0xa4,0x82,0x62,0x7f,0xa2,0x62,0x8b,0xff,0x52,0x22,0x63,0xa2,
+	0x22,0xa1,0x42,0x62,0xff,0x63,0x59,0x06,0x41,0x95,0xfe,0x42,0x62,0xff,0x8a,0x51,
+	0x87,0xfe,0x22,0xd2,0x01,0x25,0xff,0x4d,0x08,0xcd,0x05,0x50,0xd4,0xc0,0x88,0xff,
+	0x22,0xe1,0x92,0xfe,0x91,0x93,0xfe,0xb1,0xff,0x91,0xfe,0xfd,0x0a,0x98,0x39,0xad,
+	0x03,0xff,0x30,0xbb,0xc0,0xf0,0x99,0x82,0x92,0x6e,0xfd,0x7c,0xb7,0x00,0xa2,0x22,
+	0x5a,0x92,0x2a,0x14,0xff,0x6c,0x0b,0xb0,0x99,0x10,0x92,0x6a,0x14,0xbf,0x82,0x22,
+	0x23,0xa2,0x22,0x6e,0x16,0x00,0x25,0xf3,0xec,0xff,0x44,0x05,0x0f,0x06,0x71,0xfe,
+	0x50,0x54,0x7f,0xa0,0x22,0x65,0x14,0x32,0x65,0x16,0x57,0x15,0xff,0xb1,0x6c,0xfe,
+	0x30,0x80,0x60,0x92,0x2b,0xff,0x14,0x2a,0xc3,0xa2,0x2b,0x16,0x3e,0x99,0xff,0x2c,
+	0x9e,0xe1,0x03,0xac,0x22,0xce,0xc8,0xff,0x69,0x3e,0xe1,0x02,0xac,0x22,0x90,0x28,
+	0xff,0x10,0xc7,0x3a,0x17,0xc0,0xda,0xc0,0xca,0xff,0xe2,0xe2,0x6b,0x14,0xd2,0x6b,
+	0x16,0x2e,0x7b,0xa2,0x3b,0x0a,0x01,0xa5,0x1b,0xe5,0x01,0x26,0x01,0xfb,0x0c,0x02,
+	0xeb,0x0d,0x81,0x58,0xfe,0x88,0x38,0xcf,0xbd,0x03,0xad,0x02,0x9f,0x09,0x13,0x10,
+	0x53,0xfe,0x4f,0xcd,0x04,0x88,0x88,0x15,0x10,0x13,0x10,0x4e,0x13,0x04,0xfd,0x78,
+	0x13,0x20,0x61,0x00,0x91,0x61,0xfe,0x82,0xff,0x09,0x1d,0xa2,0x09,0x20,0xb2,0x09,
+	0x1f,0xff,0xc2,0x09,0x1e,0xc2,0x41,0x00,0xb2,0x41,0xff,0x01,0xa2,0x41,0x02,0x92,
+	0x09,0x21,0x92,0xff,0x41,0x03,0x8e,0x78,0x0a,0x00,0x07,0x00,0xff,0x55,0x1b,0xae,
+	0x71,0x1a,0x00,0x47,0x00,0xff,0x81,0x1b,0xa5,0x7a,0x03,0x51,0x56,0xfe,0xf7,0x1e,
+	0x61,0x32,0x84,0x08,0x20,0x42,0x90,0x4a,0xff,0x45,0x32,0x04,0x00,0x81,0x52,0xfe,
+	0xce,0xff,0x03,0x0b,0x20,0x80,0x00,0xa0,0x22,0x3e,0xf3,0xa3,0x3d,0x1a,0x08,0x5f,
+	0x00,0xad,0x03,0x81,0x4c,0xff,0xfe,0x98,0x11,0xf2,0x04,0x01,0x6a,0xe2,0xff,0xe2,
+	0x0e,0x00,0xd2,0x04,0x02,0x00,0x1f,0x7f,0x40,0x00,0xee,0xa1,0xee,0xdd,0x6b,0x2a,
+	0x00,0x7f,0xac,0x22,0xde,0x99,0x3c,0x01,0x27,0x2a,0x00,0x9f,0x9e,0x71,0x1d,0x00,
+	0x27,0x5b,0x00,0x32,0x00,0x1b,0xff,0x22,0x20,0x20,0x74,0x66,0x42,0xa6,0x0c,0xcf,
+	0x4a,0x65,0x75,0x03,0xb3,0x0c,0x27,0x0d,0x61,0x00,0xef,0xad,0x02,0x21,0x39,0x2a,
+	0x06,0x92,0x22,0x8c,0xde,0x05,0x00,0x99,0x01,0x0c,0x09,0x06,0x00,0x81,0x2b,0xbf,
+	0xfe,0x88,0x08,0x92,0x62,0x8c,0x3a,0x00,0xb1,0xdd,0x33,0x1d,0x04,0xb2,0x62,0x93,
+	0x05,0x00,0xa8,0x01,0xee,0x04,0x00,0xa2,0x62,0x8c,0x3b,0x0c,0x81,0x00,0x59,0xff,
+	0x61,0x69,0x71,0xc1,0x2c,0xfe,0x81,0x12,0xff,0xfe,0xb1,0x2b,0xfe,0x49,0x51,0x20,
+	0xd0,0x7f,0xb4,0x41,0x0b,0xfe,0x80,0xdd,0x11,0xa8,0x01,0xff,0xa2,0x24,0x46,0x99,
+	0x01,0x32,0x41,0x00,0xff,0x98,0x01,0x88,0x58,0xa2,0x2a,0x20,0xce,0xcf,0x99,0x6b,
+	0x24,0x00,0x9b,0x0c,0xc6,0x08,0x9e,0x71,0xf9,0x4d,0xff,0x00,0x9b,0x08,0x26,0x1a,
+	0x0c,0x82,0x24,0xff,0x46,0x82,0x28,0x1e,0x88,0x38,0x0c,0x1a,0x7c,0x3e,0x0d,0x5b,
+	0x04,0x71,0xfd,0xfd,0x88,0xe7,0x0e,0x00,0xfe,0x63,0x04,0x88,0x37,0xc1,0x12,0xfe,
+	0xf1,0x13,0xfe,0x62,0x0c,0x4d,0x0a,0x21,0xf2,0xfd,0xf0,0xee,0x3f,0x10,0xe9,0x01,
+	0xa2,0x22,0x46,0x61,0x08,0x71,0x00,0xae,0x62,0x2c,0x1f,0xe7,0x1f,0x62,0x38,0x22,
+	0x62,0x20,0x88,0xf7,0xf7,0xad,0x04,0x0f,0x0f,0x61,0x00,0x8e,0xf9,0xed,0xda,0x60,
+	0x0b,0x1e,0xb1,0x35,0x0d,0x2e,0x71,0x0d,0xf8,0x35,0x15,0xf2,0x09,0x23,0x05,0x0c,
+	0x4a,0xa5,0x60,0x03,0xfe,0x77,0x03,0xfd,0xff,0xbd,0x01,0x8e,0xed,0xdd,0xff,0x5e,
+	0xe0,0x03,0x1c,0x22,0xce,0x01,0x09,0xfe,0x5e,0x00,0xa1,0x1b,0xde,0x9c,0x7a,0x01,
+	0x87,0xff,0x01,0xad,0x1b,0x1e,0x99,0xec,0x01,0x27,0xf3,0x00,0xad,0x76,0x00,0x3f,
+	0x18,0x0c,0x0a,0xe5,0xf9,0x3f,0xff,0x0c,0x4a,0x25,0x5e,0x03,0xa7,0x12,0x9b,0x16,
+	0xff,0x41,0xe1,0xfd,0x5e,0xe1,0xd7,0x01,0x47,0xfe,0x76,0x00,0x8e,0x12,0x06,0x00,
+	0x07,0x09,0x59,0xdd,0x1b,0x58,0x01,0x52,0x64,0x88,0x05,0x00,0x72,0x64,0xfd,0x89,
+	0x05,0x00,0x62,0x64,0x8a,0x1d,0xf0,0x66,0x5f,0x12,0x16,0x31,0xd8,0xfd,0x0d,0x00,
+	0x32,0x19,0x38,0xfb,0x22,0x1d,0xb2,0x05,0x24,0x85,0x50,0x99,0x20,0xf6,0x08,0x04,
+	0x64,0x85,0x05,0x00,0x82,0x24,0x86,0x60,0xdd,0x88,0x0e,0x04,0x82,0x64,0x86,0xe3,
+	0x0d,0xa1,0xa8,0x7f,0xfd,0x82,0x2a,0x23,0xa2,0x2a,0x6e,0x56,0x11,0xce,0x13,0x04,
+	0x3e,0xc2,0xd2,0x78,0x08,0x27,0x00,0x22,0x63,0xfd,0x8c,0x27,0x0c,0x1c,0x03,0x5e,
+	0x9d,0xd6,0x0e,0xee,0x05,0x05,0x4e,0x1f,0x02,0x8f,0x02,0xa1,0x1b,0x76,0x7f,0xa2,
+	0x23,0x92,0x25,0x57,0x3a,0x99,0x25,0x00,0xfd,0x98,0x10,0x06,0x49,0x09,0x82,0x25,
+	0x58,0x3a,0xf6,0x85,0x04,0x88,0x08,0x04,0x00,0x6e,0x78,0x03,0x60,0xff,0x80,0x00,
+	0x80,0x22,0xb1,0xaf,0xfd,0xd1,0xfd,0xb1,0xa1,0x04,0xc2,0x2b,0x88,0xd0,0xcc,0x10,
+	0xde,0x08,0x04,0x6b,0x88,0xa1,0xaa,0x11,0x04,0xa2,0x6b,0xf9,0x8d,0x5f,0x01,0xeb,
+	0x00,0x87,0xfd,0x62,0x24,0x57,0xf7,0x60,0x62,0xa0,0x13,0x00,0x68,0x06,0x51,0xa6,
+	0xfe,0x1b,0x04,0x59,0x06,0x42,0x24,0x58,0x40,0x42,0xb6,0x12,0x04,0x48,0x04,0x04,
+	0x00,0x39,0x04,0x87,0x0c,0x31,0xef,0x80,0xfd,0x88,0xe3,0x9f,0x05,0xa3,0xae,0x2a,
+	0xf7,0x3a,0x00,0x27,0xee,0x0e,0x41,0x7a,0xfd,0x92,0xff,0x04,0x06,0x0e,0x19,0x05,
+	0x01,0x07,0x01,0xff,0x59,0x1b,0xa1,0x7a,0xfd,0xa2,0x0a,0x08,0xff,0x65,0x9e,0x03,
+	0x52,0x44,0x06,0xe1,0x94,0xef,0xfd,0xd2,0xa0,0x76,0x3f,0x00,0xd2,0x6e,0x83,0xfb,
+	0xc1,0x92,0x58,0x04,0xb1,0x84,0xfd,0x52,0x6c,0xff,0x8f,0xb2,0x0b,0x24,0xf2,0x24,
+	0x12,0x8c,0xff,0x8b,0xcc,0x6f,0x82,0x04,0x0c,0xcc,0x18,0x9f,0x00,0x70,0x00,0x88,
+	0xf3,0x99,0x17,0x03,0x01,0xc1,0xff,0x00,0x21,0x66,0xfd,0x51,0x85,0xfd,0x6d,0xff,
+	0x01,0x91,0x86,0xfd,0xb1,0x86,0xfd,0x31,0xdf,0x5e,0xfd,0xce,0x86,0xdd,0x04,0x0a,
+	0xd9,0x01,0xff,0xa2,0x23,0x46,0xd9,0x11,0xc9,0x31,0x88,0xff,0xaa,0xb9,0x41,0x99,
+	0x51,0x8e,0x48,0x04,0x7d,0x28,0xe6,0x04,0x8e,0x71,0x27,0x0e,0x67,0xd3,0x01,0xff,
+	0x88,0x42,0xae,0x4a,0x0b,0x28,0x00,0x00,0x9f,0x84,0x22,0xce,0xff,0xfd,0xfd,0x09,
+	0x54,0x00,0xb8,0xff,0x81,0xb0,0xa8,0x74,0xbe,0x71,0xc9,0x5e,0xff,0xc1,0x02,0x80,
+	0x22,0xf6,0x49,0x12,0x60,0xff,0x8a,0xa0,0x88,0x08,0xb0,0xa0,0x74,0xbd,0xec,0x62,
+	0x06,0xb6,0x05,0x65,0x83,0x54,0x00,0x46,0xf0,0xff,0xfe,0x6f,0x0f,0x31,0x43,0xfd,
+	0xc2,0x23,0x46,0xae,0xfd,0x6a,0x70,0x0c,0xd2,0x6c,0x22,0x92,0x23,0x46,0xff,0xb1,
+	0x68,0xfd,0x21,0x41,0xfd,0xd2,0x69,0xef,0x23,0xfe,0x43,0x68,0x56,0x00,0x89,0x1b,
+	0x89,0xff,0x01,0x89,0x11,0x88,0x02,0xfe,0x5f,0x1e,0xff,0x01,0x07,0x00,0x61,0x1b,
+	0xce,0x61,0xdf,0xf3,0xe0,0x81,0x72,0x02,0x19,0x05,0x22,0x2c,0x0a,0xbe,0x73,0x10,
+	0x0c,0x7b,0x14,0x3b,0x00,0xa2,0x69,0x20,0x67,0x09,0xff,0x98,0x52,0x9c,0xf9,0x72,
+	0x19,0x06,0x82,0xff,0x29,0x01,0x9c,0x27,0x66,0x17,0x02,0x00,0xff,0x20,0x00,0x76,
+	0x97,0x0a,0x62,0x08,0x00,0xff,0x60,0x60,0x64,0x67,0x13,0x0e,0x4b,0x88,0xff,0x98,
+	0x09,0x56,0xe9,0xfd,0x0c,0x03,0x39,0xfb,0x62,0x2d,0x8d,0x02,0x8c,0x04,0x89,0x04,
+	0x8c,0xff,0x05,0x99,0x05,0x99,0x62,0xee,0xfe,0xf3,0xf6,0x57,0x01,0x45,0x1b,0x1b,
+	0x0a,0x92,0x02,0x01,0x82,0xff,0x02,0x00,0xa1,0x1a,0xfd,0x90,0xb0,0x64,0xff,0x77,
+	0x68,0x24,0x7e,0x09,0xcc,0x00,0xe7,0xff,0x01,0x69,0x1b,0xa2,0x2a,0x46,0xc0,0xbb,
+	0xff,0x11,0xba,0xaa,0xa8,0x2a,0x88,0x0a,0xcd,0xaf,0x03,0x4e,0xd4,0x3b,0xf0,0x02,
+	0xa5,0x20,0x17,0x77,0xdb,0x69,0x1c,0x1f,0x38,0x00,0xa7,0x1f,0x1c,0xa2,0x2a,0xff,
+	0x49,0xa0,0xab,0xa0,0xa8,0x0a,0x88,0x3a,0xfa,0x3a,0x0c,0x07,0x1a,0x3c,0xb7,0xbc,
+	0x0e,0xb8,0x03,0xf6,0x1f,0x04,0xdd,0x04,0x19,0x10,0x88,0x3a,0xdd,0x04,0xcf,0x3e,
+	0xc3,0x3b,0x00,0x2c,0x20,0x9f,0x04,0x51,0xf4,0x7f,0xfc,0x52,0x25,0x46,0x4e,0x24,
+	0x36,0x18,0x08,0xdf,0x5e,0x45,0xe8,0x01,0x87,0x95,0x01,0x8e,0xa3,0xfd,0x54,0x2b,
+	0x02,0x65,0x1b,0x66,0x93,0x31,0xa8,0xff,0x65,0x16,0xba,0x06,0x82,0x1a,0x07,0xb8,
+	0xff,0x02,0x87,0xbb,0x28,0x88,0x2a,0x80,0x8b,0xfe,0x8a,0x01,0x5e,0xa5,0x3b,0x40,
+	0x80,0x01,0xa4,0xfe,0x3d,0x05,0x69,0x65,0x4e,0x24,0x39,0x5e,0x21,0xff,0x03,0xa4,
+	0x22,0x90,0x26,0x83,0x1d,0xf0,0xff,0xa8,0x65,0xcc,0x6a,0x0c,0x22,0x1d,0xf0,0xba,
+	0x03,0x04,0xc2,0x34,0x04,0xc7,0xbb,0x1e,0x34,0x44,0x66,0xdf,0x7a,0x0b,0x1e,0x02,
+	0x02,0x73,0x01,0x41,0x1b,0xfe,0x2a,0x04,0x98,0x02,0x92,0xc9,0xf8,0x90,0x4a,0xe7,
+	0x83,0x2d,0x04,0x3a,0x0c,0xd7,0x05,0xe1,0x00,0x81,0xef,0xd1,0xfc,0x88,0xe8,0x2e,
+	0x00,0x5d,0x0a,0xb6,0xff,0x42,0x02,0x06,0x40,0x00,0xad,0x01,0xe5,0xff,0xe3,0x05,
+	0x41,0xcf,0xfc,0xae,0x00,0x0b,0xfb,0x01,0x27,0xad,0x01,0x9e,0x54,0x1c,0x20,0x80,
+	0xbf,0x01,0x84,0x22,0x9e,0x71,0x1d,0x61,0x03,0x81,0x7f,0x1b,0xa5,0x90,0x06,0x31,
+	0xc0,0xfc,0x19,0x02,0x7f,0x0c,0x89,0x99,0x41,0xae,0x4a,0x6b,0x68,0x0a,0xf7,0xbe,
+	0x71,0x6b,0x5e,0x02,0x80,0x22,0xb9,0x51,0xff,0x88,0x0a,0xc2,0xc1,0x10,0xde,0x0c,
+	0x0b,0xfb,0x00,0xa7,0xe9,0x0d,0xe2,0x01,0x20,0xc2,0x23,0xdf,0x4b,0x4e,0xb7,0xcd,
+	0x08,0xbc,0x07,0xe0,0xdd,0xff,0xd1,0xda,0xcc,0xd2,0x0c,0x43,0xc2,0x0c,0xff,0x41,
+	0xa1,0xdb,0xfc,0xd2,0x61,0x10,0x77,0xff,0xec,0x05,0xf2,0x13,0xac,0xa7,0x1f,0x0a,
+	0xf7,0xbe,0x44,0xea,0x0c,0x01,0x85,0x1b,0xa5,0xee,0xff,0x02,0x61,0xc0,0xfc,0x26,
+	0x22,0x3d,0xa1,0xef,0xd4,0xfc,0xce,0x04,0xb4,0x06,0xa0,0x22,0x65,0xff,0x95,0xff,
+	0xa1,0xd1,0xfc,0x98,0xa1,0xc2,0xff,0x06,0x45,0x99,0x8a,0x66,0x29,0x03,0xb8,0xff,
+	0x91,0xb9,0x7a,0xdc,0xbc,0xd2,0x06,0x44,0xfb,0xdc,0x6d,0x87,0x00,0xa8,0x6a,0x0c,
+	0x19,0x99,0xff,0x41,0x88,0x0a,0x0c,0x9b,0xde,0x0c,0x0c,0xb9,0x24,0x2f,0x04,0x76,
+	0x00,0x9e,0xb2,0x07,0xf7,0x00,0x55,0xff,0x1b,0x66,0x12,0x02,0x06,0x22,0x00,0x66,
+	0xff,0x32,0x02,0x86,0x20,0x00,0x26,0x22,0x07,0xdf,0x7e,0x00,0x02,0x00,0x27,0x0e,
+	0x01,0xd2,0x01,0xff,0x20,0xb2,0x23,0x4b,0x4c,0x4c,0xd0,0xcc,0xff,0xd1,0xca,0xbb,
+	0xb2,0x0b,0x41,0x77,0x6b,0xff,0x08,0xe2,0x21,0x10,0xe2,0xce,0xf8,0x56,0xdf,0x3e,
+	0x12,0x4e,0x0c,0x02,0xbd,0x02,0x41,0x1b,0xff,0xf8,0xf1,0x26,0x8f,0x1d,0x21,0xb4,
+	0xfc,0xff,0x82,0x02,0x8e,0xcc,0x38,0x0c,0x0a,0xa5,0xff,0x0e,0x03,0x92,0x04,0xf4,
+	0x66,0x19,0x0a,0xbd,0xa2,0x0f,0x00,0x4a,0x81,0xaf,0xfc,0x65,0x00,0x91,0xff,0x85,
+	0xfc,0x92,0x09,0x30,0x99,0x11,0xf6,0xf3,0xa9,0x12,0x2e,0x01,0xdc,0x0a,0xde,0x04,
+	0x0c,0x20,0xfd,0x80,0x83,0x00,0x25,0x7e,0x06,0xa8,0xf1,0xe5,0xff,0x20,0x03,0x0c,
+	0x02,0x81,0x79,0xfc,0x88,0xf7,0xf8,0xad,0x05,0xc6,0x0b,0x92,0x21,0x10,0x72,0xff,
+	0x44,0x07,0x29,0xf1,0x26,0x89,0x60,0xc1,0xff,0x9b,0xfc,0xb2,0x13,0xac,0xc7,0x9b,
+	0x57,0xff,0x92,0x23,0x6f,0x8c,0xd9,0x26,0x59,0x0b,0xff,0xf6,0x99,0x08,0x0c,0x8d,
+	0xd9,0xf1,0x46,0xff,0x00,0x00,0x79,0xf1,0xf1,0x69,0xfc,0x82,0xff,0x06,0x45,0x72,
+	0x6f,0x12,0x16,0x72,0xf7,0xff,0xcc,0x48,0x92,0x06,0x44,0x16,0xf9,0xf6,0xff,0x82,
+	0x23,0x46,0x88,0x68,0x88,0x68,0xae,0xff,0x51,0x39,0x02,0x87,0x00,0x85,0x1b,0x92,
+	0xfb,0x41,0x30,0x52,0x00,0xe0,0xba,0x11,0x79,0xe1,0xff,0xa1,0x71,0xfc,0x91,0x8c,
+	0xfc,0xb9,0xd1,0xff,0x9e,0x7a,0xba,0x2c,0x00,0x00,0x8c,0x22,0xff,0xa5,0x48,0x02,
+	0x46,0xe1,0xff,0xc1,0x72,0xdd,0xfc,0xc5,0x03,0xd2,0x2c,0x94,0x05,0x00,0xd9,0xb1,
+	0xfe,0x04,0x00,0xc2,0x2c,0x94,0xa7,0x6c,0x28,0xe2,0xff,0x06,0x44,0xcc,0xae,0x0c,
+	0x18,0x8e,0x84,0xfd,0x7f,0x09,0x01,0x81,0x1b,0xf9,0xf1,0x0c,0x3a,0xbb,0xbe,0x0e,
+	0x98,0x0f,0xde,0x00,0x0e,0x07,0x08,0xa5,0xff,0x93,0xff,0x06,0x01,0x00,0x0c,0x19,
+	0x92,0xf7,0x44,0x04,0xa2,0x7a,0x00,0x0a,0xf7,0x82,0x23,0xcf,0x31,0xae,0x03,0x0b,
+	0xfe,0x01,0xd2,0x09,0xc6,0xd7,0xef,0xff,0x72,0x44,0x02,0xc7,0x00,0xad,0x07,0xa5,
+	0xff,0x6c,0x01,0x92,0x2a,0x11,0x07,0x69,0x11,0xe7,0xbe,0x44,0xfa,0x3c,0x03,0xbe,
+	0x01,0xd2,0x02,0x0c,0xff,0xaa,0xa9,0xf1,0x06,0xcf,0xff,0x0c,0x2b,0xdf,0xb9,0xf1,
+	0x46,0xcd,0xff,0x63,0x02,0x61,0x00,0x7f,0x31,0x34,0xfc,0x41,0x37,0xfc,0x32,0xc0,
+	0x00,0xdf,0xe4,0x29,0x01,0x38,0xe3,0x43,0x00,0xbd,0x01,0xff,0x88,0x34,0xae,0x2a,
+	0x3c,0x1f,0xe7,0x1f,0x5f,0xa5,0x1b,0xae,0x43,0x4d,0x76,0x00,0x81,0x5a,0x04,0xff,
+	0x26,0x1a,0x04,0x0c,0x2a,0x65,0x8f,0x02,0xff,0xa1,0x2b,0xfc,0xa8,0x9a,0x88,0x3a,
+	0x0c,0xcf,0x7b,0xce,0x00,0x0d,0x92,0x08,0x1b,0x00,0x88,0xf4,0xf3,0xad,0x02,0x44,
+	0x09,0xb7,0x06,0x61,0x00,0xcd,0x01,0xff,0xb2,0x22,0x12,0x92,0x22,0x11,0x42,0x02,
+	0xff,0x4e,0x81,0x1f,0xfc,0x31,0x32,0xfc,0xbe,0xef,0x99,0x5a,0x80,0x20,0xfa,0x02,
+	0xa0,0xa0,0x04,0xff,0xa2,0x42,0x4e,0x32,0x13,0x50,0x8e,0x48,0x7d,0x9b,0x57,0x08,
+	0xbe,0x71,0x09,0x20,0x81,0x9c,0x02,0xff,0x90,0x33,0x63,0x39,0x11,0x92,0x02,0x4e,
+	0xff,0xad,0x08,0x88,0x38,0x20,0x99,0xa0,0x9e,0xef,0x49,0xdd,0x00,0xc7,0x1e,0x00,
+	0x9e,0x71,0x2b,0xfb,0x00,0x67,0x7e,0x0c,0xdd,0x03,0xcd,0x04,0xae,0x77,0x2a,0x3b,
+	0x02,0xa5,0x07,0xee,0x00,0x0a,0xff,0x0a,0xdf,0x25,0x7d,0xff,0x1d,0xf0,0x6f,0x00,
+	0xa1,0x03,0xff,0xfc,0xa2,0x2a,0x46,0xbd,0x01,0xa8,0xea,0xff,0x29,0x01,0xa5,0x96,
+	0x00,0xc2,0xca,0xf9,0xfb,0xbe,0x01,0x5b,0x07,0xa1,0x1b,0xc0,0x2b,0x93,0xdc,0x94,
+	0x04,0xe7,0x03,0xa1,0xfa,0xfb,0x23,0x00,0xae,0x4a,0x7d,0xeb,0x77,0x08,0x25,0x4f,
+	0x00,0x0c,0x02,0x3b,0x00,0xff,0x21,0x01,0x71,0xf4,0xfb,0xa2,0x27,0x46,0xff,0x61,
+	0xf5,0xfb,0x51,0x1e,0xfc,0x48,0xea,0xff,0x2e,0xd2,0x18,0x5e,0x20,0x02,0x54,0x22,
+	0xdf,0x7e,0xc8,0x39,0x5c,0x40,0x07,0x00,0x3e,0x39,0xbb,0x2c,0x5c,0x0f,0x04,0x1e,
+	0x9c,0x1b,0x78,0x02,0x55,0xff,0x1b,0x0e,0xb2,0xbd,0x5a,0x60,0x02,0xcc,0xbf,0x22,
+	0x8e,0xed,0x3e,0x5a,0xe0,0x27,0x04,0xee,0xf7,0x3f,0x5a,0xc0,0x07,0x00,0x6e,0x3f,
+	0x38,0x02,0xfd,0x47,0x1f,0x00,0x87,0x92,0x49,0xa8,0x03,0xa5,0xff,0xa8,0x03,0x1d,
+	0xf0,0x22,0x21,0x18,0x2e,0xff,0x20,0x69,0x05,0x47,0x01,0x49,0x1b,0x97,0xff,0x12,
+	0x04,0x2c,0x68,0x87,0x92,0x16,0x92,0x7f,0x21,0x15,0x66,0x19,0x10,0xa8,0x96,0x3c,
+	0x31,0x6f,0x4c,0x79,0x97,0x92,0x15,0x3c,0xa5,0xc5,0x44,0x00,0xff,0x28,0x03,0x40,
+	0x22,0xa0,0x28,0xd2,0xa2,0xff,0x02,0x00,0x52,0x13,0x02,0x3e,0xfb,0xb9,0xfb,0x1e,
+	0xe7,0xa8,0x03,0x97,0x9a,0x05,0xb2,0x44,0xff,0x4f,0x06,0x29,0x00,0x56,0x4a,0x05,
+	0xad,0xbf,0x02,0x1e,0x91,0x38,0x00,0x47,0x13,0x01,0x76,0xff,0xa8,0x29,0xb8,0x0a,
+	0xb0,0xd8,0x75,0x80,0xff,0xcb,0x01,0x30,0xeb,0x10,0x80,0xee,0x11,0xff,0xe0,0xcc,
+	0x20,0xb0,0xb8,0x41,0x30,0xbb,0xff,0x10,0xd0,0xbb,0x20,0xce,0xbb,0x3a,0x40,0xed,
+	0x81,0x7f,0x01,0xbe,0x79,0x6e,0x0d,0xad,0x01,0xb2,0xff,0x24,0x11,0xce,0x44,0xcd,
+	0x92,0x80,0x01,0xff,0x64,0x22,0x65,0x08,0x02,0xc2,0x14,0x26,0xff,0x56,0x4c,0x05,
+	0xd8,0xf4,0xd2,0x64,0x10,0xf7,0x46,0x03,0x00,0x0d,0x00,0x52,0xc5,0xfc,0x5e,0xff,
+	0x50,0xe2,0x40,0x80,0x01,0x48,0x22,0xfc,0xff,0xbc,0x92,0x24,0x10,0x50,0xa2,0x41,
+	0xac,0xff,0xea,0x76,0x9a,0x29,0x88,0x02,0x80,0xb8,0xff,0x75,0x80,0xa8,0x01,0x30,
+	0xc8,0x10,0x80,0xff,0xcc,0x11,0xc0,0xaa,0x20,0x80,0x88,0x41,0xff,0x30,0x88,0x10,
+	0xb0,0x88,0x20,0xae,0x88,0x9d,0x32,0x2e,0x00,0xa4,0x22,0x8e,0x62,0x10,0x34,0x00,
+	0x9a,0xff,0xa5,0xa2,0x64,0x10,0xb2,0x24,0x12,0xc2,0xff,0x24,0x11,0xba,0xb5,0xb2,
+	0x64,0x12,0xc7,0xff,0xbb,0x05,0xc2,0x04,0x4f,0x16,0x6c,0xf2,0xf2,0xec,0x08,0xab,
+	0xec,0x20,0x71,0x00,0x92,0x04,0x4f,0xdc,0xff,0x7c,0xdc,0x59,0xc8,0xf4,0xde,0x44,
+	0x1a,0xd7,0x01,0x47,0x01,0x1a,0x02,0x06,0xf1,0x0e,0x65,0x64,0x6c,0xe4,0x01,0xe2,
+	0x02,0x01,0x67,0x06,0x23,0x25,0x63,0x14,0x00,0xff,0xc2,0x26,0x41,0xdc,0x2c,0xa8,
+	0x6a,0xb9,0xff,0x41,0x88,0x0a,0xc2,0xc1,0x10,0xde,0x04,0xf7,0x0b,0x01,0x87,0x4e,
+	0x0c,0x91,0x80,0xfb,0x5e,0x7b,0x69,0xca,0x39,0x02,0x85,0x1b,0x65,0xe2,0xe6,0x01,
+	0xff,0xa8,0x03,0x65,0x55,0x02,0x7e,0x43,0x0a,0xfe,0xfa,0x09,0xa2,0x61,0x15,0xa2,
+	0x61,0x14,0xad,0xbf,0x04,0x7e,0x20,0xfc,0x36,0x00,0xdf,0x00,0x7e,0xff,0xb0,0xfd,
+	0x36,0x80,0x00,0x48,0x22,0xe5,0xff,0x90,0xff,0x16,0x5a,0x18,0x70,0x3c,0x05,0xff,
+	0x22,0x61,0x18,0xd2,0x21,0x17,0xe2,0x21,0xff,0x16,0x70,0xf0,0xf4,0xf2,0x61,0x15,
+	0xad,0xff,0x0e,0xe2,0x1e,0x01,0xee,0x71,0x4b,0x34,0xff,0x00,0x01,0x80,0x22,0xde,
+	0x74,0x6c,0x00,0xfd,0x87,0x44,0x00,0x65,0x92,0xff,0x56,0x0a,0x19,0xff,0x81,0x98,
+	0xfb,0x87,0x12,0x05,0x91,0x97,0xff,0xfb,0x97,0x92,0x01,0x0c,0x13,0x22,0x61,0xef,
+	0x19,0x4e,0x1c,0x09,0xa6,0x00,0x41,0x1b,0xae,0xbb,0x4a,0x63,0x6b,0x08,0x3e,0x71,
+	0xa9,0x2e,0x08,0x9e,0x7b,0x71,0x8b,0xfd,0x03,0x80,0x22,0xb9,0x91,0xaa,0x04,0xbf,
+	0x20,0xde,0x0c,0x0b,0x00,0xa7,0xaa,0x0c,0x82,0xff,0x27,0x46,0x88,0x68,0x88,0x68,
+	0xae,0x51,0x77,0x39,0x02,0x87,0xa3,0x03,0x92,0x41,0x34,0x14,0x00,0xff,0xe0,0xba,
+	0x11,0x39,0xf1,0xa1,0x63,0xfb,0xff,0x91,0x82,0xfb,0xb9,0xe1,0x9e,0x7a,0xba,0xff,
+	0x2c,0x80,0x00,0x8c,0x22,0xe5,0x04,0x02,0xff,0x21,0x61,0xfb,0xc2,0x02,0x44,0x56,
+	0xdc,0xff,0x0d,0xd1,0x4e,0xfb,0xd2,0x0d,0x30,0xd2,0xff,0x61,0x10,0xf6,0xad,0x12,
+	0xae,0x00,0x0b,0xfe,0x12,0x09,0xde,0x04,0x0c,0x30,0x00,0x00,0xa0,0xdf,0x22,0x25,
+	0x30,0x06,0xe2,0x24,0x00,0x0e,0xdc,0xff,0xa2,0x17,0xac,0x50,0xfa,0xc0,0x56,0x1f,
+	0x7d,0x0a,0xdf,0x02,0x2e,0x70,0xbb,0x01,0x67,0x3b,0x02,0xff,0xb9,0x81,0xa8,0x6a,
+	0x92,0x02,0xcf,0x99,0xfc,0x87,0x18,0x32,0x15,0xc2,0x26,0x48,0xc2,0xcc,0xfe,0xff,
+	0x56,0x3c,0x12,0xae,0x46,0x7d,0x01,0xa7,0x7f,0x00,0x89,0x1b,0xd9,0x81,0xa9,0x91,
+	0x38,0x00,0xff,0xa8,0x6a,0x88,0x0a,0x0c,0x9b,0xde,0x0c,0xe3,0x0c,0x28,0x5b,0x04,
+	0x28,0x00,0x13,0x00,0x92,0x02,0xce,0x7f,0xa8,0x6a,0x9e,0x71,0x9b,0x01,0x47,0xda,
+	0x00,0xdb,0xb9,0x81,0x4a,0x34,0x39,0x81,0x23,0x00,0xc2,0x02,0xff,0xcc,0x92,0x27,
+	0x4b,0xae,0x4a,0x6b,0x08,0xfe,0x24,0x04,0xc0,0xbb,0xd1,0xba,0x99,0x92,0x09,0xbd,
+	0x43,0x77,0x04,0x0c,0xcd,0xce,0x41,0x2b,0x04,0x65,0xde,0x2b,0x04,0x1d,0xf0,0xa5,
+	0x7e,0xe7,0x02,0xa2,0x61,0xdf,0x11,0x4e,0xa4,0x3b,0x30,0x3f,0x06,0xa5,0x5a,0xee,
+	0x14,0x00,0x9e,0x00,0x03,0xd3,0x08,0xa1,0x44,0xfb,0xff,0xcc,0xb9,0xcc,0x93,0x22,
+	0x61,0x15,0xa0,0xef,0xa2,0x20,0x25,0xb5,0xf3,0x01,0xf6,0x79,0x02,0xff,0x86,0x38,
+	0xff,0x56,0xf3,0xc9,0xb2,0x21,0xff,0x19,0xd2,0x11,0x2a,0x00,0xbb,0x11,0xa0,0xff,
+	0xab,0x10,0xa0,0xad,0x20,0x65,0xb3,0xff,0xff,0x86,0x32,0xff,0xc1,0x39,0xfb,0xc7,
+	0x12,0xef,0x5a,0x52,0x61,0x19,0x31,0x00,0xce,0xf0,0xf9,0xff,0x00,0x87,0x01,0x45,
+	0x1b,0xd1,0x35,0xfb,0xff,0x81,0xff,0xfa,0x92,0x13,0x00,0xa8,0x44,0xef,0x8e,0x48,
+	0x3b,0x32,0x86,0x05,0xde,0x99,0x3c,0xef,0x1f,0xe7,0x1f,0xa5,0x96,0x01,0x2d,0x00,
+	0x07,0xfc,0x6a,0x02,0x88,0x00,0x26,0x1a,0x04,0x0c,0x2a,0xa5,0xd3,0x41,0x02,0x87,
+	0x3b,0x3d,0x0a,0x87,0x79,0x00,0x25,0x7a,0xfe,0xa8,0x08,0x15,0x46,0x85,0xff,0xae,
+	0x52,0xd9,0xfe,0x5c,0x02,0x99,0x1b,0x99,0x81,0x06,0xb6,0xff,0xff,0x36,0x41,0x00,
+	0xae,0x50,0x0b,0x00,0x47,0xfe,0x95,0x06,0x22,0xff,0x2d,0x0a,0xbe,0x1a,0xbc,0xfb,
+	0x02,0x47,0x6a,0x01,0xa5,0x23,0xff,0x31,0xf4,0xff,0xfa,0x91,0x18,0xfb,0xa1,0x16,
+	0xfb,0x81,0xff,0xdf,0xfa,0xa9,0x52,0x99,0x82,0x88,0x28,0x5f,0x0c,0x4b,0xae,0x53,
+	0x2c,0x5a,0x00,0x95,0x5a,0x04,0xff,0xd1,0xd8,0xfa,0xa9,0x42,0xd8,0x5d,0xd9,0xff,
+	0xd2,0xc2,0x13,0x50,0xb1,0xd2,0xfa,0xda,0xff,0xcc,0xc9,0xe2,0xb2,0x2b,0x46,0x29,
+	0xeb,0xfb,0x1d,0xf0,0x53,0x00,0x58,0x03,0x4e,0x08,0x02,0xfe,0xf3,0x0a,0x50,0x24,
+	0x93,0x1d,0xf0,0x00,0x00,0xfe,0x13,0x00,0x41,0x06,0xfb,0xc0,0x20,0x00,0x22,0xdf,
+	0x24,0x81,0x20,0x20,0x74,0x08,0x00,0x42,0x24,0xff,0x80,0x40,0x48,0x75,0x80,0x44,
+	0x11,0x40,0x6f,0x22,0x20,0x2e,0x73,0x2c,0x04,0x81,0x1b,0x3b,0x08,0xff,0xa8,0x03,
+	0x25,0x7c,0xff,0x8e,0x07,0x02,0xbe,0x7b,0x02,0xa1,0x1b,0xa0,0x28,0x83,0x3e,0x04,
+	0x00,0xff,0x36,0x61,0x00,0x81,0xd0,0xfa,0x88,0x68,0xff,0x21,0xdd,0xfa,0xce,0xc8,
+	0x03,0x01,0x07,0xf7,0x00,0x55,0x1b,0x43,0x00,0x92,0x22,0x93,0x90,0xff,0x90,0x04,
+	0x56,0xb9,0x0b,0x81,0xb6,0xfa,0xfb,0x88,0xe8,0x94,0x00,0x41,0xb0,0xfa,0xb1,0xb2,
+	0xff,0xfa,0xa2,0x24,0x46,0x32,0x4b,0x00,0xa8,0xff,0x6a,0x39,0x01,0x88,0x0a,0xcd,
+	0x01,0xde,0xfd,0x08,0xdc,0x19,0x0c,0x0a,0xa5,0x97,0x02,0xa2,0x7b,0xad,0xff,0x3a,
+	0x08,0x87,0xa0,0x99,0x10,0x08,0x04,0x7f,0x62,0x87,0x82,0x24,0x38,0x0c,0x0a,0x79,
+	0x07,0xdf,0xde,0xfa,0xc1,0xdf,0xfa,0xee,0x00,0xd1,0xc2,0xdd,0xfa,0x19,0x00,0x32,
+	0x62,0x8b,0x05,0x08,0x8d,0x1c,0xbe,0x0d,0x04,0xa2,0x68,0x81,0x3c,0xef,0x07,0x00,
+	0xf2,0xef,0x68,0x80,0xe2,0xa1,0x41,0x04,0xe2,0x6c,0x81,0xbb,0x3c,0xcb,0x07,0x00,
+	0xb2,0x6c,0x80,0x26,0x08,0x8f,0xf7,0xa2,0xa1,0x00,0x08,0x00,0x82,0x29,0x88,0xa0,
+	0x7b,0x88,0x20,0x08,0x04,0x69,0x88,0x7c,0x0f,0x27,0x04,0xef,0x2d,0x81,0xf0,0xee,
+	0x69,0x04,0xe2,0x6d,0x81,0xf7,0xc2,0xa0,0x76,0x08,0x00,0xc2,0x6d,0x83,0x0c,0xfd,
+	0x0b,0x39,0x04,0x62,0x8f,0x06,0xff,0xff,0x0c,0xf9,0x12,0xe1,0x00,0xf7,0x00,0x48,
+	0x03,0x40,0x28,0x74,0xff,0x40,0x30,0x74,0xf6,0x53,0x02,0xb6,0x82,0xff,0x03,0x0c,
+	0x82,0x1d,0xf0,0x81,0x7f,0xfa,0xff,0x91,0x83,0xfa,0x22,0x58,0x74,0x3e,0x89,0xf5,
+	0x22,0x00,0x03,0x85,0x1f,0x15,0x81,0xa2,0xfa,0xcc,0xff,0xea,0xa1,0xb6,0xfa,0xa9,
+	0x72,0xbd,0x03,0xff,0xad,0x02,0x65,0x02,0x00,0x2d,0x0a,0x1d,0xff,0xf0,0x87,0x9a,
+	0x05,0xa1,0xb2,0xfa,0x46,0xff,0xfa,0xff,0xa0,0xa0,0x74,0xa5,0xfa,0x00,0xdf,0xcc,
+	0x6a,0xde,0xfe,0xfa,0x1f,0x02,0x45,0x1b,0xef,0xa8,0xfa,0x06,0xf5,0xe7,0x05,0x58,
+	0x72,0x9c,0xff,0x05,0x42,0x05,0x00,0x49,0x03,0xde,0x04,0xff,0x08,0xa0,0x20,0x00,
+	0x54,0x22,0x89,0x72,0xff,0xc6,0x00,0x00,0x0c,0x09,0x99,0x03,0x0c,0xfd,0x72,0x63,
+	0x0d,0x41,0x00,0x98,0x03,0x21,0x5f,0xff,0xfa,0x90,0xa8,0x74,0x90,0x90,0x74,0xac,
+	0xff,0xf9,0x26,0x19,0x11,0x26,0x29,0x5e,0x0e,0xfb,0x39,0x72,0x89,0x02,0xc1,0x1b,
+	0xa1,0x85,0xfa,0xfd,0xa9,0x43,0x02,0x92,0x22,0x4e,0x90,0xb2,0x41,0xfd,0xb9,0x33,
+	0x08,0x25,0xf4,0x00,0x16,0x5a,0xff,0xff,0xc8,0x2a,0xc0,0xc2,0x41,0xc9,0x03,0xc6,
+	0xff,0xfa,0xff,0x0c,0x0a,0x65,0xf1,0x00,0x7e,0xfb,0x0a,0x09,0x76,0x00,0x59,0x1b,
+	0x46,0x01,0x00,0xff,0xb8,0x2a,0x98,0x1a,0xba,0x99,0xc1,0x62,0xff,0xfa,0xd1,0x54,
+	0xfa,0xb1,0x5f,0xfa,0xc2,0xff,0x2c,0x2d,0xa2,0x22,0x4e,0xd0,0xbb,0xc0,0xff,0xc0,
+	0xbb,0xc0,0x90,0x9b,0xc0,0xa0,0x99,0xff,0xc0,0x86,0xec,0xff,0xe5,0xef,0x00,0x16,
+	0xff,0x1a,0xfb,0xd8,0x1a,0xd0,0xd2,0x41,0xd9,0xaf,0x03,0xc6,0xe9,0xff,0x87,0x04,
+	0x81,0xa8,0x01,0xa9,0xff,0x21,0xa9,0x31,0xa8,0x03,0x0c,0x89,0x92,0xff,0x51,0x00,
+	0xa0,0x20,0x74,0xa0,0x88,0x74,0xdf,0x0e,0x38,0x0b,0x01,0xc7,0x57,0x00,0xbe,0x02,
+	0xff,0x3a,0x00,0x27,0x01,0x8d,0x1b,0xb1,0x64,0xff,0xfa,0xbe,0x5b,0xda,0x0a,0x07,
+	0x00,0x91,0xff,0x1b,0xa5,0x15,0x02,0x2e,0xa2,0x3b,0x24,0xbd,0x00,0x80,0x03,0x1e,
+	0xd1,0x3c,0x24,0x88,0x07,0x25,0xff,0x40,0x02,0x86,0x04,0x00,0xae,0xa0,0xeb,0xfa,
+	0x15,0x00,0x48,0x15,0x1c,0x16,0x01,0xec,0xfa,0xa1,0xff,0x2a,0xfa,0xa8,0x9a,0x98,
+	0x41,0xb2,0x11,0x5f,0x0a,0x8e,0x4a,0x3c,0x22,0x51,0x07,0xbe,0x49,0x07,0xce,0x7e,
+	0x02,0x9e,0x71,0x3b,0x74,0x02,0x51,0x0b,0xb8,0x21,0x6d,0xbe,0x93,0x1a,0x22,0x11,
+	0x47,0x03,0x06,0xf1,0x43,0x05,0xff,0x88,0x03,0x42,0x12,0x22,0x00,0x88,0x11,0x3f,
+	0x80,0x44,0x20,0x4e,0x72,0x12,0x93,0x01,0xb3,0x0a,0xff,0x61,0x00,0x38,0x03,0x30,
+	0x80,0x14,0x56,0xff,0x38,0x05,0xcd,0x01,0x91,0x26,0xfa,0x81,0xdf,0x12,0xfa,0xae,
+	0x42,0xd4,0x51,0x08,0x49,0x01,0xff,0x88,0x98,0xa9,0x21,0x92,0x19,0x50,0xad,0xff,
+	0x08,0x88,0x38,0x3e,0x99,0x6b,0x00,0x67,0xbb,0x01,0xad,0x66,0x00,0x1d,0x00,0xc7,
+	0x66,0x0c,0xec,0xff,0x4a,0x42,0x42,0x4e,0x42,0x62,0x12,0xd1,0xff,0x39,0xfa,0xb2,
+	0x22,0x11,0x42,0x42,0x4f,0xff,0x30,0xc0,0xf4,0xd0,0xbb,0x10,0xc0,0xbb,0xc3,0x20,
+	0xbe,0x5e,0x18,0x09,0x06,0x03,0x04,0x03,0x07,0x88,0x03,0xeb,0x6e,0x08,0x18,0x07,
+	0x55,0x17,0x00,0xad,0x03,0xe5,0xff,0x2e,0x05,0x98,0x03,0x9c,0xc9,0xe1,0xfa,0xef,
+	0xf9,0x1e,0xc1,0x3a,0x74,0x01,0xa5,0x1b,0xee,0xef,0x5e,0x1b,0x01,0x27,0x28,0x02,
+	0xee,0x71,0x0d,0x3e,0xd3,0x03,0x81,0x1b,0x65,0xdb,0x05,0xdc,0x0d,0xbb,0x04,0xef,
+	0x82,0x7e,0x58,0x09,0x95,0x08,0xae,0xff,0x06,0xbb,0x1f,0xe7,0x11,0x03,0x2e,0xb2,
+	0x32,0xda,0x01,0xa5,0xff,0x1b,0xac,0xe7,0xec,0xe9,0xd8,0x03,0xc2,0xff,0x08,0x02,
+	0xd0,0x48,0x74,0x47,0x97,0x15,0xff,0x56,0xdc,0xfe,0xd0,0xa0,0x74,0x6e,0x58,0x7d,
+	0x19,0x66,0x03,0x81,0x1b,0xde,0xff,0xf2,0x88,0x00,0xff,0x45,0x1b,0xf0,0x7c,0x11,
+	0x3b,0x77,0x7a,0xff,0x88,0x72,0x08,0x00,0x46,0xf3,0xff,0x9c,0xbf,0x49,0x3e,0xb6,
+	0x48,0x03,0x47,0x16,0x02,0x67,0xff,0x28,0x0c,0x26,0x2a,0x09,0x91,0x00,0xfa,0xff,
+	0x0c,0x82,0x22,0x49,0x0d,0x1d,0xf0,0xc1,0xff,0xcf,0xf9,0xc2,0x2c,0x49,0xa9,0xab,
+	0xc0,0xbf,0xc6,0xa0,0xc8,0x0c,0xc9,0x9b,0x7b,0x08,0x61,0xbf,0x00,0xb8,0xa2,0xae,
+	0x42,0x94,0x73,0x00,0x81,0xef,0x1b,0x4e,0xab,0xd9,0xbf,0x00,0x65,0x1b,0xac,0xff,
+	0x5a,0xcd,0x01,0xb9,0x01,0x88,0x3a,0x9e,0x3b,0x33,0x0d,0x73,0x09,0x9e,0x71,0x1b,
+	0x9b,0x08,0x14,0x01,0xf7,0xbe,0x07,0x09,0xfb,0x0f,0x9b,0x83,0xc6,0xff,0xef,0xff,
+	0x4e,0x72,0xac,0x18,0x08,0xc9,0x92,0x2d,0xfd,0x09,0x6b,0x09,0xad,0x02,0xbd,0x03,
+	0x25,0xf3,0xef,0xff,0x5e,0x7a,0xb4,0x50,0x00,0xc5,0x1b,0xb8,0xff,0xa2,0x47,0x1b,
+	0x21,0xa8,0x92,0x39,0x11,0xd5,0xcd,0x4d,0x00,0xb9,0xed,0x0b,0x07,0xed,0x13,0x79,
+	0xae,0xbb,0xba,0x3a,0xe0,0x08,0xb0,0xa9,0x83,0x46,0x20,0x0a,0xfe,0x6f,0x0f,0x51,
+	0xa8,0xf9,0x41,0xd0,0xf9,0x82,0xff,0x25,0x18,0xad,0x02,0x47,0x98,0x04,0x98,0xff,
+	0x03,0x92,0x65,0x18,0x88,0x3a,0xb8,0x03,0xfe,0x38,0x00,0x2d,0x0a,0x26,0x7a,0x02,
+	0x42,0x65,0xfd,0x18,0x73,0x0d,0xd6,0xf3,0x00,0xae,0x51,0x0b,0xfb,0x02,0x47,0x54,
+	0x00,0x25,0xef,0x01,0x0c,0x02,0xfe,0x15,0x00,0xa1,0xad,0xf9,0x82,0x2a,0x26,0xa2,
+	0xff,0x2a,0x27,0x66,0x18,0x02,0x00,0x20,0x00,0xff,0x76,0xa8,0x08,0xb2,0x1a,0x00,
+	0xb7,0x13,0xff,0x04,0xa2,0xca,0x14,0x0c,0x0a,0xcc,0xca,0xda,0x2e,0x00,0x03,0x2e,
+	0x08,0xec,0x01,0x2b,0x01,0x32,0x1a,0xff,0x03,0x48,0x4a,0x16,0x43,0x04,0xad,0x02,
+	0xff,0x62,0x14,0x00,0x1e,0xc1,0x33,0x7e,0xe0,0xff,0x03,0xa4,0x22,0x5e,0x34,0x1d,
+	0x20,0x80,0xfe,0x7a,0x02,0x6e,0xb0,0xe4,0x80,0x80,0x00,0x48,0xff,0x22,0xe5,0x14,
+	0xff,0xac,0x5a,0xe8,0x01,0xff,0x59,0x31,0xd8,0x11,0xad,0x0e,0xe2,0x1e,0xef,0x01,
+	0xee,0x71,0x2b,0x9a,0x0a,0xde,0x72,0x6c,0xfe,0x1e,0x09,0x25,0x17,0xff,0xdc,0x3a,
+	0x56,0xa3,0xbd,0xfb,0xcd,0x05,0x6e,0xb6,0x3a,0x0b,0xec,0x05,0x25,0xdf,0xe6,0x01,
+	0x86,0x02,0x00,0x0d,0x14,0x65,0xe5,0xf9,0x01,0x25,0x0a,0xeb,0x09,0x81,0xa5,0xf9,
+	0x58,0xb2,0x7f,0x42,0x13,0x00,0x80,0x55,0x10,0x50,0xaa,0x06,0x15,0xb2,0xca,0x12,
+	0x00,0xc3,0x12,0x16,0xc3,0x16,0x18,0x14,0x17,0x00,0xff,0x28,0xb2,0xc0,0x20,0x00,
+	0x28,0x02,0x20,0xe7,0x20,0xf4,0x2e,0xfa,0x1a,0x2f,0x04,0x28,0xb2,0x41,0xfb,0x91,
+	0xf9,0x1a,0x08,0x40,0x22,0x10,0x20,0x20,0x79,0xf5,0x1d,0x20,0x6b,0x0c,0x8a,0xf9,
+	0x58,0xc2,0x6b,0x20,0xdd,0xc2,0x6b,0x30,0x18,0x58,0xb2,0x6d,0x0c,0x49,0xc2,0xf7,
+	0x4e,0x75,0x02,0x6f,0x1c,0x88,0x03,0x80,0x20,0xff,0x34,0x47,0x68,0x07,0x0c,0x4a,
+	0x65,0xdf,0xff,0xfe,0x06,0x01,0x00,0x0c,0x1a,0xe5,0xde,0xff,0xfe,0x0c,0x1a,0x25,
+	0x3a,0x02,0x41,0x3e,0xbf,0xf9,0x82,0x24,0x24,0xad,0x02,0x8a,0x01,0x81,0xef,0x7f,
+	0xf9,0x3d,0x0a,0xcb,0x05,0x0a,0xa5,0x38,0xef,0x02,0x82,0x24,0x2c,0x0a,0x00,0x20,
+	0xa3,0xc0,0xb3,0x9e,0x08,0x47,0x04,0x21,0x02,0x29,0x93,0x67,0x0c,0x81,0xff,0x32,
+	0xf9,0x22,0x13,0x00,0x82,0x28,0x25,0xe6,0x34,0x08,0x20,0xaa,0x21,0x30,0x83,0x0a,
+	0xa2,0x03,0x00,0xff,0xb1,0x28,0xf9,0x26,0x6a,0x1d,0x82,0x2b,0xfd,0x26,0x24,0x00,
+	0x91,0x51,0xf9,0xae,0x73,0x02,0xf6,0x7b,0x0e,0x9a,0x5a,0xe2,0x02,0xa5,0x1b,0x90,
+	0x2a,0xfe,0x2c,0x00,0xae,0x4b,0x6b,0x01,0x87,0x00,0x89,0xff,0x1b,0xb9,0x01,0x98,
+	0x03,0xa8,0x6a,0x90,0x7f,0x98,0x74,0x99,0x11,0x88,0x0a,0xcd,0x57,0x06,0xfb,0x00,
+	0xa7,0x57,0x0e,0xa2,0x11,0x02,0xc6,0xef,0xfd,0xff,0xfb,0x08,0xb8,0xb2,0xa8,0x03,
+	0x25,0xe7,0xeb,0x01,0x8e,0x6d,0x14,0x28,0x8f,0x08,0x61,0x00,0xc8,0x3f,0x03,0xb1,
+	0x24,0xf9,0xd6,0xec,0x38,0x0a,0x18,0x04,0xb3,0xa5,0xcb,0x9c,0x09,0x79,0x00,0xb2,
+	0x2b,0x34,0x1a,0x0a,0xff,0xd2,0x1b,0x00,0xde,0xac,0x5b,0x64,0x81,0xff,0x00,0x64,
+	0x22,0xc1,0x02,0xf9,0xd1,0x2d,0x7f,0xf9,0xc2,0x1c,0xac,0xde,0x0c,0x22,0xf7,0x0b,
+	0xfc,0x43,0x06,0x39,0x04,0xe5,0xc7,0x01,0x86,0xf0,0xff,0xfe,0xed,0x03,0x02,0xe1,
+	0xfa,0xf8,0xd9,0x01,0xbd,0xff,0x01,0xd2,0x5e,0x2c,0x25,0xd4,0xff,0x06,0xf3,0xf3,
+	0xff,0x7f,0x04,0xf4,0x00,0xae,0x21,0x94,0x00,0xff,0xc7,0x01,0x1d,0x1b,0x0e,0x82,
+	0x49,0x01,0xfd,0x87,0x90,0x03,0x27,0x34,0x0c,0x81,0xf5,0xf8,0x3b,0x2e,0x88,0xd9,
+	0x15,0x9e,0x8a,0xd2,0xe4,0x08,0xe3,0x0d,0x7f,0x03,0x41,0x16,0xf9,0xb6,0x22,0x03,
+	0x8c,0x04,0xd7,0x2e,0x84,0xa2,0x22,0x00,0x8d,0xc7,0x19,0x28,0x03,0xfb,0x26,0x12,
+	0x18,0x08,0x41,0x0e,0xf9,0x2e,0x84,0xfd,0xc2,0x1b,0x20,0x61,0x00,0x0c,0x08,0x89,
+	0x01,0xff,0x28,0x03,0x92,0xa0,0x80,0x2e,0x28,0xe4,0xfe,0x75,0x03,0x49,0x1b,0x5e,
+	0x22,0xca,0x5c,0xe0,0xff,0x02,0xc0,0x22,0x0e,0x07,0x04,0x03,0xe7,0xbf,0x00,0x41,
+	0x1b,0xa0,0x49,0x83,0xc7,0x01,0x1f,0xff,0x02,0xad,0x02,0x81,0xe9,0xf8,0xbd,0x01,
+	0xef,0xce,0x03,0x0d,0x00,0x85,0x13,0x98,0x01,0x2e,0xdf,0xa2,0x3b,0x1f,0xe7,0x1f,
+	0x85,0x03,0xb4,0x30,0xff,0xb0,0x99,0x10,0x99,0x01,0xd8,0x03,0x81,0xfd,0xe0,0x23,
+	0x00,0x40,0xdd,0x10,0xde,0x99,0x3c,0xfb,0x01,0x27,0x78,0x01,0x9e,0x71,0x0d,0x00,
+	0x27,0xcc,0xfc,0x0f,0x45,0x00,0x1c,0x02,0xe5,0x06,0x93,0x10,0x41,0xea,0xb5,0xf8,
+	0xaf,0x18,0xb2,0xaf,0x30,0x41,0xe2,0x1b,0x1c,0xe2,0xfe,0x93,0x2a,0x41,0xdc,0xf8,
+	0x28,0x03,0x2e,0x74,0x29,0x52,0x14,0x18,0x2f,0x0c,0xd6,0x2f,0x1c,0x92,0x65,0x09,
+	0x2f,0x14,0xff,0x21,0xa2,0xf8,0x82,0x22,0x28,0xa2,0x13,0xcd,0x00,0x81,0x00,0x82,
+	0x22,0x65,0x06,0x82,0x0c,0x00,0x36,0xff,0x81,0x00,0x41,0x9e,0xf8,0x71,0x9a,0xf8,
+	0xff,0xb2,0x02,0x0b,0x82,0x04,0x0d,0x92,0x27,0xbf,0x4b,0x3e,0x47,0x6a,0x08,0x47,
+	0x1f,0x02,0xb0,0xff,0xaa,0xd1,0xaa,0x99,0x38,0x63,0x62,0x09,0xff,0x43,0x92,0x09,
+	0x41,0x32,0x23,0x13,0x99,0xff,0x61,0x66,0x18,0x13,0xc8,0xd3,0xd2,0x02,0xff,0x04,
+	0xe2,0x02,0x08,0xf8,0xc3,0xf9,0x01,0xff,0xe2,0x41,0x04,0xd2,0x41,0x05,0xc9,0x21,
+	0xdf,0x81,0xcf,0xf8,0x88,0x08,0x97,0x0a,0xa1,0xb7,0x7f,0xf8,0x92,0x04,0x0d,0xee,
+	0x54,0xc5,0x1b,0x01,0xff,0x81,0x1b,0x59,0xa4,0xcc,0xe9,0xc1,0x8b,0xbf,0xf8,0xdd,
+	0x0a,0x5e,0x8d,0xab,0xa1,0x01,0x8d,0xff,0x1b,0xb2,0x4c,0x0b,0x26,0x1e,0x05,0xf2,
+	0xff,0x03,0x26,0x66,0x1f,0x2e,0xc1,0xc3,0xf8,0xff,0x9e,0xbb,0x8d,0x1f,0x67,0x1f,
+	0x1d,0x1b,0x7e,0x7a,0x03,0xb2,0x2c,0x83,0xd0,0xbb,0x10,0x08,0x04,0xdf,0x6c,0x83,
+	0xa2,0xaf,0xbf,0x08,0x00,0x82,0x29,0xf7,0x88,0xa0,0x88,0x11,0x04,0x82,0x69,0x88,
+	0xe5,0xdf,0x18,0x02,0x5e,0x83,0x6b,0x96,0x01,0x85,0x1b,0xff,0xb2,0x43,0x25,0xe2,
+	0x04,0x0d,0x5e,0x4e,0xff,0x07,0x01,0x07,0x01,0x59,0x1b,0x79,0x71,0xff,0xb1,0x6c,
+	0xf8,0xa8,0x71,0xb2,0x2b,0x49,0xff,0xb0,0xaa,0xa0,0xa8,0xfa,0x79,0x51,0x8e,0xff,
+	0x4a,0x3c,0x24,0x00,0x00,0x80,0x22,0xde,0x2b,0x08,0x09,0x6f,0x01,0xa1,0x77,0x01,
+	0x4b,0x8a,0x08,0x9b,0x00,0x7f,0xc8,0x71,0x7e,0x73,0x8d,0x80,0x21,0x1c,0x00,0xff,
+	0xd0,0xc0,0x74,0xc9,0x71,0x66,0x4c,0xc3,0xff,0xb2,0xa0,0xff,0xa2,0x03,0x24,0xb7,
+	0x1a,0xef,0x05,0xa5,0x9d,0x05,0x0b,0x00,0xb2,0x43,0x24,0xfe,0x5a,0x00,0x52,0x44,
+	0x0c,0xf2,0x04,0x09,0x0e,0xff,0x1e,0x99,0x06,0x87,0x00,0xc5,0x1b,0x82,0xff,0x24,
+	0x10,0xa1,0x7f,0xf8,0xa2,0x64,0x18,0xff,0x90,0x88,0x20,0x82,0x64,0x10,0x66,0x1f,
+	0xff,0x04,0x0c,0x6a,0x25,0x17,0x02,0xc1,0x7d,0xef,0xf8,0x59,0xa3,0xb2,0x2c,0x00,
+	0x4c,0x6c,0x66,0xff,0x1b,0x13,0xd8,0x21,0xe2,0x01,0x05,0xf8,0xff,0x01,0x82,0x01,
+	0x04,0x82,0x42,0x08,0xf9,0xff,0xc3,0xe2,0x42,0x04,0xd9,0xd3,0xee,0x54,0xf7,0x99,
+	0x02,0xa7,0x79,0x07,0xa6,0xda,0x05,0xa7,0x7f,0x01,0x61,0x1b,0xae,0xa6,0x5b,0x03,
+	0x07,0x04,0xff,0xb7,0x16,0x0d,0xc8,0x61,0xd1,0x85,0xf8,0xff,0x07,0x6c,0x0a,0xd2,
+	0x2d,0x6d,0x66,0x1d,0xff,0x04,0xcc,0x1e,0xa5,0xa4,0xfe,0xf2,0x24,0xff,0x1a,0x66,
+	0x1f,0x18,0x81,0x39,0xf8,0x52,0x7f,0x64,0x1a,0x7e,0x78,0xda,0x09,0x27,0x2c,0x01,
+	0xf7,0xa5,0x92,0x01,0x4b,0x01,0xcc,0x19,0xa5,0xa2,0xff,0xfe,0xa8,0xb3,0x66,0x1a,
+	0x04,0x25,0xa2,0xff,0xfe,0x59,0xb3,0xb1,0x5e,0xf8,0x52,0x44,0xff,0x09,0x52,0x44,
+	0x0a,0x79,0x2b,0x59,0x1b,0xff,0x52,0x4b,0x18,0x59,0x4b,0x5e,0x8b,0xcc,0xff,0x60,
+	0x01,0x02,0x80,0x22,0x52,0x4c,0x74,0xbe,0xcb,0x16,0x81,0x6b,0xf8,0x88,0x18,0x8f,
+	0x09,0x91,0xff,0x24,0xf8,0x92,0x29,0x49,0x2d,0x0a,0xa2,0xff,0x29,0x10,0x88,0x3a,
+	0x2c,0xab,0xce,0x00,0xfe,0xb4,0x1a,0xa1,0x36,0xf8,0xa2,0x0a,0x44,0x5e,0xfb,0x1a,
+	0x43,0x10,0x00,0xc5,0x1b,0xad,0x03,0xe1,0xdf,0x1d,0xf8,0x1e,0xc1,0x3f,0xab,0x0a,
+	0xfe,0x71,0xfb,0x0b,0x01,0x33,0x05,0x3e,0x8e,0x4d,0x00,0x47,0xfe,0x07,0x00,0x25,
+	0x65,0x05,0x91,0x40,0xf8,0x3e,0xdb,0x79,0x78,0x15,0x08,0x89,0x89,0x67,0x0b,0x0c,
+	0x04,0xf7,0x5e,0x00,0x03,0x1e,0x00,0xa1,0x1b,0x76,0xa3,0xff,0x0e,0x20,0x84,0xa0,
+	0x88,0x08,0x1b,0x44,0xff,0x40,0x40,0x74,0x26,0x08,0x01,0x1b,0x55,0xf7,0x4e,0x00,
+	0x08,0x19,0x08,0x3d,0xf0,0x76,0xa8,0xbf,0x0e,0x20,0x94,0xa0,0x98,0x49,0x1b,0x0c,
+	0x09,0xfe,0x1b,0x00,0x22,0x02,0x43,0x0e,0x62,0xc8,0x08,0xff,0x27,0x00,0xc1,0x1b,
+	0x87,0x12,0x04,0xf0,0xff,0x25,0x11,0x1d,0xf0,0x21,0x12,0xf8,0x22,0xf9,0x02,0xbc,
+	0x08,0x8b,0x02,0x9d,0x03,0x82,0x09,0x41,0xff,0x62,0x22,0x13,0x31,0x0d,0xf8,0x3e,
+	0x08,0xfd,0x94,0x9c,0x00,0x69,0x1b,0x0c,0x04,0x60,0x74,0xff,0xb0,0x30,0x54,0xb0,
+	0xae,0x45,0x0b,0x1c,0xff,0x87,0x06,0x85,0x1b,0x25,0xa9,0x06,0x81,0xff,0xee,0xf7,
+	0xb2,0x03,0x90,0xc2,0x05,0x84,0x7f,0x88,0xa8,0xa0,0xbb,0x82,0xa8,0x57,0xd0,0x00,
+	0x9f,0xae,0x77,0x44,0x80,0x20,0xdc,0x01,0x68,0x00,0x66,0xff,0x24,0xcd,0xa2,0xc2,
+	0x28,0xce,0x10,0x0b,0xff,0xc4,0x00,0x00,0xa0,0x22,0x25,0x65,0xfe,0xdf,0x46,0x3d,
+	0x00,0x99,0x11,0x41,0x00,0xd0,0x94,0xff,0x11,0x99,0x31,0x56,0x04,0x0a,0x72,0x02,
+	0xff,0x40,0xa8,0x11,0xa5,0xf3,0xff,0x91,0xe0,0xff,0xf7,0xc8,0xd6,0xa9,0x21,0x92,
+	0x29,0x10,0xff,0xb8,0x92,0xa9,0x01,0x90,0x93,0x24,0x66,0xdf,0x79,0x0d,0xa2,0x02,
+	0x3c,0x4b,0x06,0x0a,0xf0,0x7f,0xaa,0x11,0x06,0x01,0x00,0xb0,0xa9,0x0a,0x00,0xbf,
+	0x66,0x1c,0x18,0x7e,0x71,0x4b,0x7b,0x00,0x81,0xff,0x1b,0x65,0xa1,0x06,0xe8,0x41,
+	0xa0,0x71,0xff,0x41,0xe0,0xda,0x82,0xe0,0x7d,0x93,0x86,0xff,0x06,0x00,0xd8,0xc6,
+	0x26,0x79,0x12,0xc2,0xff,0x02,0x3c,0xa0,0xad,0x82,0xb0,0xbc,0xa0,0xff,0xb8,0x0b,
+	0x65,0x9f,0x06,0x7d,0x0a,0x86,0xff,0x00,0x00,0xf0,0x7d,0x11,0xae,0x45,0xcb,0xf7,
+	0x1c,0x87,0x07,0x3f,0x01,0x9e,0x06,0xc8,0x01,0xff,0xd2,0x05,0x74,0xe8,0x21,0xfe,
+	0x53,0x18,0xff,0x02,0x07,0x01,0x91,0x1b,0x80,0x97,0xa0,0xff,0x90,0xee,0x82,0xa0,
+	0xff,0x82,0x80,0xff,0xff,0xa0,0xf0,0xdd,0x82,0xe7,0xbd,0x22,0x91,0x7f,0xe8,0xf7,
+	0x0c,0xe8,0x8e,0x89,0xd2,0x62,0x09,0xfb,0x1d,0xf0,0x3a,0x14,0x65,0x9a,0x06,0x72,
+	0x03,0xff,0x91,0xc2,0x05,0x74,0xa0,0x77,0x82,0xbd,0xff,0x07,0x51,0xb1,0xf7,0x78,
+	0x31,0x88,0xa5,0xaf,0x6a,0x77,0xa8,0x17,0xf0,0x08,0x04,0xf0,0x14,0x3e,0xff,0x54,
+	0x58,0x9e,0xc0,0x02,0xac,0x22,0x56,0xbb,0xc8,0xf1,0xf8,0x00,0x6e,0xb6,0x3c,0x65,
+	0x00,0xa5,0xbf,0x1b,0xa5,0x55,0xfe,0x0c,0x02,0x13,0x16,0x52,0x7f,0x22,0x13,0x0c,
+	0x27,0x4e,0x45,0x02,0x51,0x01,0xff,0x65,0x1b,0x30,0x92,0xa0,0x98,0x09,0x26,0xff,
+	0x09,0x76,0x90,0xa8,0x34,0x26,0x1a,0x02,0xff,0x66,0x2a,0x65,0x61,0x9a,0xf7,0x62,
+	0x26,0xff,0x49,0x60,0x6a,0xa0,0x68,0xf6,0x79,0x01,0x7f,0x49,0x11,0x88,0x36,0x1e,
+	0xc1,0x3b,0x60,0x03,0x7f,0xa5,0x1b,0x6e,0xa6,0x3d,0x00,0x87,0x07,0x00,0x7e,0x6f,
+	0x00,0x92,0x03,0x41,0x2e,0x29,0xca,0x15,0x00,0xff,0x61,0x1b,0x77,0x69,0x0c,0x88,
+	0x85,0x66,0xff,0x18,0x0f,0x91,0xbc,0xf7,0x92,0x09,0x8e,0xdf,0xcc,0x69,0x0e,0x04,
+	0x0a,0x57,0x00,0x41,0x1b,0x7f,0xcd,0x01,0xa9,0x11,0x8e,0x46,0x3b,0x71,0x0b,0x77,
+	0x6e,0xa6,0x39,0x41,0x08,0x9e,0x71,0x0d,0xfb,0x03,0xfe,0x81,0x0b,0x1b,0x22,0x20,
+	0x20,0x74,0x66,0x42,0xfd,0x80,0x93,0x14,0x42,0x22,0x13,0x7e,0x01,0x06,0xd6,0xa7,
+	0x0b,0x4e,0x44,0x99,0x28,0x4d,0x99,0x04,0x3a,0x02,0xff,0x66,0x4a,0x3c,0x51,0x74,
+	0xf7,0x52,0x25,0x7f,0x49,0x50,0x5a,0xa0,0x58,0xf5,0x69,0x99,0x04,0xed,0x35,0x99,
+	0x14,0x5e,0xa5,0x99,0x18,0xad,0x05,0x79,0x6e,0x18,0x00,0x7e,0x71,0x0b,0x78,0x08,
+	0x1e,0xc1,0x18,0x18,0xfa,0x70,0x10,0xa9,0x5b,0x0a,0x41,0x00,0x71,0x8f,0xf7,0xdf,
+	0x5d,0x02,0x2e,0x42,0x36,0x3f,0x00,0x81,0x1b,0xff,0x5e,0x53,0x08,0x01,0xa7,0x00,
+	0x55,0x1b,0xff,0x87,0x13,0x28,0xd1,0x9f,0xf7,0xd8,0x2d,0xff,0x26,0x63,0x0c,0xad,
+	0x05,0xbd,0x03,0xcd,0xff,0x04,0xe0,0x0d,0x00,0x2d,0x0a,0x1d,0xf0,0xfe,0x0c,0x18,
+	0x69,0xd2,0x2d,0x0a,0x16,0xda,0xfe,0xff,0x0c,0x22,0x1d,0xf0,0xe1,0x98,0xf7,0x4e,
+	0xff,0xce,0xcf,0x03,0x07,0x00,0x61,0x1b,0x69,0xff,0xd2,0xf2,0x47,0x0d,0x06,0xfa,
+	0xff,0x4e,0xfb,0x72,0xc8,0xc0,0x00,0x81,0x1b,0x8e,0x72,0xd2,0xfe,0x7d,0x08,0x1d,
+	0xf0,0x88,0x75,0x88,0xd8,0x40,0xef,0xb0,0x74,0xad,0x05,0xa3,0x05,0x3a,0x39,0x00,
+	0xde,0x04,0x09,0x87,0xda,0x1f,0xe7,0x1d,0x00,0xa7,0x13,0xff,0x05,0xc2,0x05,0x43,
+	0xa7,0x1c,0x05,0x62,0xff,0x47,0x0d,0xc6,0xea,0xff,0xd8,0x85,0x5e,0xef,0xa5,0x3c,
+	0x08,0x47,0x20,0x00,0xc0,0xb3,0xd1,0xff,0xba,0xbd,0xe5,0x2c,0x02,0x2d,0x0a,0x56,
+	0xdf,0x2a,0xf8,0x32,0x45,0x43,0x63,0x0b,0x26,0x93,0xff,0x46,0xd1,0x78,0xf7,0xd8,
+	0x3d,0x26,0x83,0x87,0x0c,0xad,0x02,0x9a,0x24,0x0c,0x00,0xcf,0x01,0x0f,0x08,0xae,
+	0xff,0x2a,0x3e,0x1e,0xc7,0x1f,0xa5,0x1b,0xe7,0xff,0x94,0xe6,0x98,0x14,0x16,0x19,
+	0xfe,0xf8,0xef,0xd5,0x5e,0x2f,0xce,0x45,0x02,0xc5,0x1b,0xb8,0xff,0xc5,0xb9,0x09,
+	0xa8,0x14,0x0c,0x28,0x89,0xff,0x1a,0x1d,0xf0,0xc8,0x04,0x6e,0x0c,0x02,0xfa,0x15,
+	0x00,0x55,0x9f,0x00,0xd1,0x4e,0xf7,0xd2,0x0d,0x6f,0x8d,0xde,0x74,0x02,0xaf,0x10,
+	0xe9,0x19,0x8f,0x0d,0xff,0x41,0x00,0x91,0x19,0xf7,0x92,0x29,0x46,0xff,0x98,0x69,
+	0x92,0x29,0x13,0x88,0xd9,0x66,0xff,0x28,0x04,0x22,0x19,0x18,0x1d,0xf0,0x81,0x3f,
+	0x58,0xf7,0x88,0x48,0xad,0x02,0xcc,0x00,0x7a,0x04,0xee,0xb7,0x09,0x81,0x53,0xf7,
+	0x80,0x08,0x88,0x58,0xad,0xfd,0x02,0x84,0x00,0x08,0x00,0x6d,0x0a,0x2e,0xaa,0xff,
+	0x03,0x00,0x47,0x01,0x59,0x1b,0x71,0x0b,0xff,0xf7,0xb2,0x04,0x0f,0xc2,0x04,0x0e,
+	0x16,0xff,0x7b,0x08,0x56,0x2c,0x04,0x92,0x27,0x10,0xfe,0x55,0x03,0x26,0x79,0x39,
+	0xb8,0x92,0xc8,0xd5,0xfe,0x4b,0x0b,0xa9,0x24,0x66,0x2c,0x19,0xe8,0xc5,0xff,0xd2,
+	0x02,0x3c,0xc9,0x01,0xa0,0xae,0x82,0xfb,0xb0,0xbd,0x33,0x03,0x25,0x6c,0x06,0x98,
+	0x01,0xff,0xa2,0x54,0x06,0x46,0x0d,0x00,0x81,0xf8,0xff,0xf6,0x82,0x28,0x46,0x88,
+	0x68,0x88,0x68,0xfe,0x56,0x00,0x98,0xd5,0xc6,0xf9,0xff,0x92,0x07,0xbf,0x0a,0x66,
+	0x19,0x1b,0xb8,0x92,0x97,0x03,0x81,0x9b,0xf1,0xf6,0x9a,0x0b,0xa9,0x24,0x23,0x1c,
+	0x36,0x00,0x98,0xff,0xd5,0x66,0x29,0x1a,0xa2,0x04,0x0e,0x8c,0xff,0x1a,0xb6,0x7a,
+	0x0a,0x4e,0x8a,0xfc,0x01,0xff,0xc7,0x00,0xc1,0x1b,0xa7,0x3c,0x07,0xd8,0xff,0xc5,
+	0xf0,0xdd,0x11,0xd2,0x54,0x06,0x0b,0xff,0x33,0x9e,0x63,0xf4,0x84,0x80,0x01,0x58,
+	0xf7,0x22,0x2d,0x06,0x57,0x09,0x51,0x23,0xf7,0x88,0xfd,0x65,0x3b,0x00,0x41,0xdd,
+	0xf6,0x32,0x24,0x46,0x7f,0x3c,0x8a,0x3e,0x43,0x6b,0x00,0x47,0x0b,0x01,0xff,0x25,
+	0x20,0xfe,0x2d,0x0a,0xc8,0x73,0xae,0xfb,0x73,0x3f,0x21,0x0a,0xf9,0xda,0xfe,0x7a,
+	0x8d,0xfe,0xb6,0x09,0xde,0x8a,0x4e,0x1f,0xe7,0x1e,0x85,0xff,0x1b,0xe9,0xca,0xd1,
+	0x18,0xf7,0xb8,0x8c,0xff,0xb9,0x75,0xb1,0x17,0xf7,0xa8,0xbc,0xa9,0xff,0x05,0x98,
+	0x9c,0xa1,0x16,0xf7,0x99,0x25,0xff,0x91,0x16,0xf7,0x88,0xac,0x89,0x35,0xf8,0xff,
+	0x6c,0x81,0x15,0xf7,0xf9,0x55,0xf1,0x14,0xff,0xf7,0xe8,0x1c,0xe9,0x85,0xa9,0x6c,
+	0xf9,0xff,0xbc,0xd9,0xcc,0xe1,0x12,0xf7,0xb9,0x1c,0xff,0x89,0x9c,0x99,0xac,0x81,
+	0x08,0xf7,0x91,0xff,0x11,0xf7,0xb1,0x0f,0xf7,0xe9,0x8c,0xd8,0xff,0x0c,0xd9,0x15,
+	0xb9,0x0c,0xa8,0x63,0xa9,0xff,0x45,0x99,0x63,0x82,0x08,0x00,0x56,0x68,0xff,0x05,
+	0x51,0xd2,0xf6,0x0c,0x04,0xd0,0x74,0xff,0x11,0x50,0x64,0xb0,0xae,0x46,0x0b,0x1c,
+	0xff,0x87,0x06,0x85,0x1b,0xe5,0x5a,0x06,0x82,0xff,0x05,0x90,0x6e,0x56,0x4b,0x02,
+	0x07,0x00,0xff,0x91,0x1b,0xa0,0x88,0x82,0xb0,0x88,0xa0,0xff,0x80,0x66,0x82,0xad,
+	0x06,0x65,0x11,0xfe,0x9f,0x81,0xaf,0xf6,0x88,0x98,0xe5,0x03,0x07,0x0b,0xde,0xeb,
+	0x55,0x3e,0x07,0x00,0x91,0xee,0x06,0x7a,0x82,0xae,0xff,0x78,0x54,0x80,0x20,0x00,
+	0x80,0x22,0x40,0xff,0x40,0x74,0x66,0x24,0xad,0xb2,0xc3,0x28,0xef,0x2e,0xa2,0x3c,
+	0x02,0x25,0x04,0xe5,0x14,0xfe,0xff,0xa8,0x12,0xb8,0x1a,0xa8,0x0a,0x2e,0xbb,0x7d,
+	0xfc,0x07,0x02,0xad,0x1b,0xe5,0x0b,0xfe,0x0b,0x09,0xff,0x31,0x9c,0xf6,0x32,0x23,
+	0x47,0x81,0xde,0xff,0xf6,0x21,0xeb,0xf6,0x48,0xe3,0x49,0x68,0xf3,0x29,0xe3,0xe4,
+	0x01,0x17,0x00,0x41,0xe8,0xf6,0x38,0xff,0x14,0x48,0x04,0x20,0x53,0x34,0x52,0xc5,
+	0xbf,0xfd,0x50,0x43,0x93,0x2d,0x04,0x17,0x0c,0x5d,0xff,0x02,0x21,0xe1,0xf6,0x28,
+	0x02,0x8c,0x42,0xff,0x32,0x02,0x40,0x57,0x13,0x01,0x0c,0x02,0xfe,0x5b,0x13,0x41,
+	0xdc,0xf6,0x88,0x04,0x48,0x14,0xbf,0x20,0x48,0x83,0x2e,0x44,0x03,0xf3,0x02,0x65,
+	0xef,0x1b,0x40,0x23,0x83,0x1b,0x10,0xad,0x02,0x65,0xdf,0xfc,0xff,0x2e,0x4a,0x08,
+	0x16,0x08,0xa0,0x28,0xfd,0x83,0x6f,0x16,0x82,0xd2,0x01,0x82,0x08,0x03,0xff,0x32,
+	0x62,0x1e,0xcc,0xc8,0xbe,0xcd,0x6a,0xff,0x4c,0x00,0x01,0x1c,0x22,0x65,0x78,0x06,
+	0xdf,0xc6,0xff,0xff,0xce,0x1a,0xca,0x03,0x1f,0x59,0xff,0x1b,0x98,0xc2,0xa1,0xc8,
+	0xf6,0xc1,0x8a,0xff,0xf6,0xb0,0x99,0x10,0xa7,0x99,0x09,0xd8,0xff,0xf2,0xc2,0x2c,
+	0x30,0xe8,0xd2,0xd7,0xbc,0xff,0x11,0xa2,0xc2,0x30,0xbe,0x00,0x0c,0x08,0xff,0xc7,
+	0x00,0xa1,0x1b,0x25,0x06,0xfe,0x0c,0xff,0x12,0x1d,0xf0,0xd8,0xe2,0xe2,0xce,0x10,
+	0xdf,0xee,0x72,0xdd,0xa4,0x01,0xfd,0x00,0xde,0x72,0xf9,0xe2,0xdb,0x12,0x67,0x0c,
+	0x31,0x66,0xf6,0x98,0x73,0xbe,0x6c,0x00,0xc2,0x22,0x11,0xc9,0x09,0x71,0x00,0x2e,
+	0xf9,0x18,0x0b,0x03,0xac,0x02,0xa1,0xb0,0xf6,0xb1,0xb1,0xe7,0xf6,0xe0,0x0c,0xd9,
+	0x02,0x74,0x00,0xb8,0x73,0x0c,0xff,0x0a,0xa9,0x0b,0xcc,0xb2,0xae,0x73,0x1a,0xfe,
+	0x32,0x01,0x81,0x1b,0xa5,0x1a,0x01,0x1d,0xf0,0xe7,0x0c,0xfa,0x25,0x06,0x04,0x47,
+	0x0c,0xad,0x02,0xe5,0xff,0xef,0xff,0x71,0x53,0xf6,0xb8,0x87,0x91,0xff,0xa4,0xf6,
+	0x99,0x0b,0x82,0x0a,0x40,0x6d,0xff,0x0a,0x27,0x98,0x17,0x2e,0x35,0x4c,0x00,0xff,
+	0x87,0x01,0xc1,0x1b,0x47,0x3c,0x0c,0x1c,0xff,0xfa,0x65,0x17,0x01,0x9c,0xd5,0x26,
+	0x15,0xbf,0x52,0x26,0x25,0x5f,0x0e,0x06,0x62,0x07,0x41,0xff,0x1b,0x0c,0x02,0xcc,
+	0x32,0x2c,0x0a,0xa5,0xff,0x15,0x01,0xe8,0x87,0x0c,0x0d,0xd9,0x0e,0xff,0x1d,0xf0,
+	0xc2,0x26,0x1f,0xa2,0xd6,0x01,0xff,0xbe,0x46,0xda,0x40,0x01,0x02,0x80,0x22,0xff,
+	0x88,0x0a,0x40,0x20,0x60,0x4a,0xd3,0x4e,0xff,0x88,0x2d,0xbe,0xe1,0x03,0xac,0x22,
+	0xde,0xff,0xd2,0x68,0x1e,0xe1,0x02,0xac,0x22,0x80,0xff,0x22,0x10,0x20,0xec,0xc0,
+	0xea,0xeb,0xd7,0xff,0x3e,0xbe,0x2a,0xed,0xe9,0x0a,0x46,0xee,0xbf,0xff,0xc2,0x26,
+	0x21,0xb8,0xe6,0x38,0x00,0xce,0xff,0xfb,0xfa,0x42,0x01,0x03,0x44,0x22,0xc2,0xdf,
+	0x26,0x23,0xb2,0x26,0x25,0x49,0x04,0xfa,0xfa,0xf9,0x44,0x10,0x04,0xa3,0x0c,0xa5,
+	0xe5,0xff,0xb1,0x2a,0xff,0xf6,0xc8,0x8b,0x91,0x7c,0xf6,0x99,0x0c,0xfe,0xa3,0x00,
+	0xc8,0x8b,0x27,0x98,0x14,0xf6,0x33,0xff,0x11,0xdc,0x63,0x92,0x2a,0x20,0x82,0x2a,
+	0xff,0x1f,0x28,0xda,0x90,0x88,0xc0,0x8a,0x22,0xdf,0x46,0x00,0x00,0x0c,0x02,0xf1,
+	0x00,0x0c,0x1d,0xff,0xf0,0x66,0x13,0x0f,0x92,0x2a,0x22,0x82,0xaf,0x2a,0x21,0x28,
+	0xea,0x1a,0x08,0x86,0x75,0x03,0x2a,0x7f,0x24,0x82,0x2a,0x23,0x22,0x2a,0x25,0x2b,
+	0x0c,0xfb,0xf5,0xff,0x5b,0x04,0x20,0xac,0x34,0xa6,0x9a,0xff,0x02,0x20,0xa8,0x21,
+	0xa0,0xa0,0x74,0x65,0xff,0xdf,0xff,0x20,0x90,0x34,0xdc,0x99,0x16,0x7f,0x6a,0x05,
+	0x20,0x94,0x34,0xfe,0x59,0xea,0x04,0xff,0x55,0x1b,0x26,0x19,0x60,0x26,0x29,0x69,
+	0xdf,0x26,0x39,0x46,0x0c,0x22,0x56,0x00,0x39,0x1a,0xff,0x9c,0x3a,0x92,0x1a,0x7f,
+	0x81,0x49,0xf6,0xff,0x8c,0xb9,0xa2,0x08,0x05,0x82,0x08,0x06,0xbf,0x9a,0xaa,0xaa,
+	0x88,0x82,0x53,0x78,0x00,0x1d,0xbf,0xf0,0x0e,0x29,0x62,0x00,0x27,0xa8,0x03,0x1d,
+	0xff,0xf0,0xb1,0xfe,0xf5,0xb2,0x2b,0x11,0xae,0xfb,0x01,0x09,0x42,0x00,0xa1,0x1b,
+	0xb0,0x9a,0x83,0xbf,0x92,0x53,0x00,0x86,0xf6,0xff,0x24,0x04,0x92,0xff,0x2a,0x1e,
+	0x90,0xc2,0x41,0xc2,0x53,0x00,0xdf,0x1d,0xf0,0xb2,0x2a,0x1f,0xbf,0x00,0x46,0x01,
+	0xef,0x00,0xb2,0x2a,0x21,0xad,0x00,0xb0,0x99,0xc0,0x3f,0x86,0xf8,0xff,0xb2,0x2a,
+	0x23,0xa9,0x00,0x0b,0x04,0xbc,0xa1,0x00,0xa3,0x09,0x6d,0x02,0x2d,0x03,0x24,0x03,
+	0xd5,0xff,0xff,0x31,0xe9,0xf5,0xb8,0x83,0x91,0x3c,0xfe,0xa7,0x0d,0x67,0x98,0x0c,
+	0xcd,0x05,0x40,0xb0,0xbf,0x74,0xad,0x02,0x25,0xe3,0xfd,0xf9,0x08,0xd8,0x9f,0x83,
+	0x0c,0x0c,0xc9,0x0d,0xd3,0x0e,0x9f,0x02,0xd2,0xff,0xff,0xc1,0xdd,0xf5,0xb8,0x8c,
+	0x91,0x31,0xfe,0x2f,0x0c,0xd8,0x8c,0x27,0x98,0x0b,0xcd,0x05,0xff,0xbd,0x04,0xad,
+	0x03,0x25,0xe1,0xfd,0xc6,0xbe,0x30,0x00,0x03,0x39,0x0d,0x2d,0x03,0xcf,0x12,0x20,
+	0xff,0x68,0x74,0xad,0x06,0x25,0xcf,0xff,0x0c,0xef,0x1b,0xb2,0x55,0x00,0x5d,0x08,
+	0x2f,0xe2,0x2a,0xff,0x16,0xac,0x9e,0x61,0xcc,0xf5,0xdd,0x05,0xff,0xcd,0x04,0x98,
+	0x76,0xbd,0x03,0x20,0xa0,0xff,0x74,0xe9,0x09,0xe0,0x0e,0x00,0xc8,0x76,0xf7,0xae,
+	0x2a,0x3b,0xf7,0x02,0xa5,0x1b,0xbe,0x7c,0x77,0x0a,0x02,0x87,0x94,0x02,0x25,0xf5,
+	0x00,0x80,0x00,0xff,0x2d,0x0b,0x8c,0x72,0x1c,0x9a,0x65,0xf4,0xf1,0x00,0x28,0x05,
+	0x44,0x0b,0x87,0x0c,0xc8,0xff,0x20,0x80,0x7f,0x14,0xa0,0x88,0xb0,0x32,0x68,0x2b,
+	0x13,0x14,0xff,0x25,0xc7,0xff,0xe0,0xb3,0x11,0x20,0x90,0xff,0x14,0x27,0xe2,0x07,
+	0xa0,0x89,0xa0,0xb2,0xff,0x58,0x4c,0x1d,0xf0,0xa0,0xc9,0xb0,0xb2,0xfb,0x5c,0x54,
+	0x97,0x22,0xc4,0xff,0x92,0xda,0x01,0xff,0x20,0xb0,0x14,0xa0,0xbb,0xa0,0x42,0x4b,
+	0xef,0x9b,0x3e,0x8b,0xa8,0xe0,0x02,0x91,0x1b,0x82,0xdb,0x49,0x02,0x23,0x1c,0xa5,
+	0xc2,0x5b,0x14,0x48,0xaa,0xf7,0x42,0x48,0xab,0xcb,0x08,0xc1,0x00,0x41,0x9c,0xff,
+	0xf5,0xae,0x44,0x6c,0x28,0x80,0x00,0x88,0xbf,0x22,0xce,0x71,0x6b,0x28,0x00,0x3e,
+	0x03,0xb9,0xdf,0x51,0xae,0x4a,0x69,0x00,0xab,0x04,0x9e,0x71,0xfd,0x45,0x48,0x0b,
+	0x59,0x01,0x88,0x0a,0x0c,0xcd,0xff,0xce,0x41,0x0b,0x00,0xa7,0x01,0x61,0x1b,0xff,
+	0xe0,0x08,0x00,0x21,0xe0,0xf5,0x28,0x02,0xff,0x2e,0xd2,0x03,0x50,0x80,0x00,0x54,
+	0x22,0xbf,0x82,0x03,0xbe,0x2e,0xb2,0x3c,0xe4,0x08,0x2e,0xfb,0xa2,0x3d,0x07,0x08,
+	0x8e,0x48,0xfe,0x1f,0xe7,0xff,0x01,0x7d,0x1b,0xfe,0xa8,0x09,0x00,0x47,0xfe,0x69,
+	0x03,0x76,0xa9,0x16,0xf2,0x0b,0x9a,0x82,0xff,0x0a,0xaa,0xe7,0x1f,0x01,0x1b,0xdd,
+	0xee,0xff,0xa8,0x6a,0x42,0x01,0x00,0x60,0x22,0x1b,0xff,0xcc,0x4b,0xbb,0xd2,0x41,
+	0x2c,0x2e,0xa2,0xff,0x3b,0x2a,0x80,0x01,0xa4,0x22,0x65,0xc6,0xff,0x03,0x82,0x24,
+	0x46,0x88,0x68,0x88,0x68,0xbf,0x52,0x41,0x2f,0xa2,0x01,0x23,0x67,0x00,0x98,0x7f,
+	0xa1,0xa2,0x51,0x18,0xb2,0x23,0x10,0x0d,0x00,0xff,0xa2,0x41,0x2e,0x52,0x53,0x42,
+	0x52,0x53,0xff,0x5b,0x52,0x53,0x5c,0xb2,0x63,0x11,0x66,0xff,0x29,0x18,0xb1,0xc7,
+	0xf5,0xc8,0x91,0xb0,0xff,0xba,0xa0,0xbe,0x4b,0x0a,0x1c,0x87,0x06,0xff,0x81,0x1b,
+	0xa0,0xac,0x82,0x65,0x07,0x06,0xff,0x86,0x00,0x00,0xa2,0x01,0x21,0xc2,0x22,0xff,
+	0x13,0xa2,0x43,0xbc,0x52,0x53,0x5d,0x4e,0xf7,0x7c,0x04,0x01,0x99,0x06,0x61,0x65,
+	0xf5,0xd8,0xff,0x76,0xbd,0x01,0xce,0x7d,0x0a,0x2a,0x80,0xfc,0xe3,0x00,0xf4,0x03,
+	0x98,0x01,0x4d,0x0a,0xb1,0x71,0xff,0xf5,0xdc,0xb9,0xe1,0x72,0xf5,0x98,0xf2,0xff,
+	0xe2,0x2e,0x30,0x90,0x9e,0x83,0x86,0x03,0xf7,0x00,0x4e,0x01,0xca,0x06,0xa1,0x1b,
+	0xf1,0x84,0xf7,0xf5,0x49,0x9f,0x81,0x02,0x63,0x32,0xa2,0x26,0xff,0x3e,0x9a,0xaa,
+	0xa2,0x6b,0x7e,0x82,0x22,0xff,0x1d,0xd2,0x26,0x3f,0xc2,0x22,0x1c,0x0e,0xfb,0x08,
+	0x9a,0x53,0x00,0x61,0x1b,0xda,0xcc,0xc2,0xff,0x6b,0x7f,0xe8,0x76,0x59,0x0e,0xa2,
+	0x43,0xff,0xbd,0xad,0x02,0x52,0x46,0x01,0x25,0xbb,0xfd,0x03,0xf4,0x1b,0x12,0xcc,
+	0x64,0x2c,0x1a,0x65,0xff,0xd6,0x00,0x06,0xed,0xff,0x2c,0x2a,0xe5,0xef,0xd5,0x00,
+	0x06,0xeb,0x43,0x0b,0xe5,0x70,0x00,0xff,0x2d,0x0a,0xe5,0xbc,0x03,0x91,0x53,0xf5,
+	0xff,0x0c,0x08,0x82,0x69,0x7e,0x82,0x69,0x7f,0xfb,0x1d,0xf0,0x17,0x00,0x32,0xc2,
+	0x40,0x82,0x03,0xff,0xc1,0x56,0x38,0x07,0x41,0x3b,0xf5,0x98,0xbf,0x74,0x82,0x22,
+	0x12,0x89,0x09,0xff,0x00,0xb8,0xff,0x74,0x0c,0x0a,0xae,0x7b,0x0a,0x05,0xa7,0xfe,
+	0x84,0x01,0xa5,0xd1,0x00,0xa8,0xf3,0xce,0x42,0xfd,0xdb,0x91,0x09,0xa5,0xb6,0xfd,
+	0xa2,0x23,0x11,0xf7,0xce,0x42,0xeb,0x0d,0x0c,0xb5,0xfd,0x42,0x22,0xff,0x1e,0xd2,
+	0x23,0x11,0xee,0x43,0xfa,0x4c,0xee,0xc2,0x05,0xee,0x73,0x0b,0x87,0x01,0x81,0x1b,
+	0xde,0xef,0x73,0x2c,0x08,0xc7,0x07,0x00,0xa5,0xb3,0xfd,0xfe,0xcb,0x02,0x02,0xa5,
+	0xa8,0xff,0x26,0x1a,0x15,0xbe,0x07,0x00,0xae,0xff,0xae,0x2a,0x3f,0x22,0x02,0xa5,
+	0xaf,0x1b,0xa0,0x2f,0x93,0x80,0x02,0x12,0x03,0x00,0xfa,0xe7,0xa5,0xcb,0x00,0x08,
+	0x04,0x2f,0x16,0x25,0xa1,0xff,0xff,0x61,0x18,0xf5,0xb8,0x86,0x91,0x6e,0xf5,0xfe,
+	0x13,0x0b,0x27,0x98,0x3c,0xbc,0x93,0xbc,0x74,0xff,0xad,0x03,0xbd,0x04,0x25,0xd0,
+	0x00,0xc1,0xff,0x26,0xf5,0xc2,0x0c,0x44,0x2d,0x0a,0x9c,0xff,0xec,0x51,0x67,0xf5,
+	0x0c,0x0b,0x5e,0xa5,0xfb,0x3c,0x04,0x4e,0x04,0x25,0xad,0xfd,0xbd,0x03,0xfe,0x0c,
+	0x14,0xc0,0xc4,0x63,0x65,0xad,0xfd,0xe8,0xff,0x86,0x0c,0x0d,0xd9,0x0e,0x1d,0xf0,
+	0xfe,0x7f,0xf4,0xf2,0x00,0x27,0x01,0x45,0x1b,0x5f,0x0c,0xff,0xb1,0x01,0xf5,0xd8,
+	0x8b,0xc1,0x5a,0xf5,0xff,0xc9,0x0d,0xb8,0x4b,0x0e,0x2b,0x6e,0x03,0xff,0x07,0x01,
+	0xc1,0x1b,0xe7,0x1b,0x0e,0x0e,0xff,0x4b,0xbf,0x01,0x87,0x00,0xc1,0x1b,0xf7,0xf3,
+	0x1b,0x03,0x15,0x07,0xd9,0x02,0x98,0xff,0xcc,0x7a,0xef,0x4c,0x6a,0xe5,0xc1,0x29,
+	0x0b,0x82,0x2a,0x43,0xff,0x87,0x33,0x1f,0x98,0xfa,0x37,0x39,0x1a,0xef,0x3e,0xb3,
+	0x3a,0x03,0x71,0x08,0xff,0x00,0x1c,0xff,0x1a,0xe5,0x3d,0x01,0x2d,0x0a,0xdc,0x8a,
+	0x7f,0x4c,0x5a,0x65,0xbf,0x00,0x1d,0xf0,0x2e,0x00,0x9b,0xbe,0x00,0x1f,0x00,0x0a,
+	0x47,0x1f,0x00,0x39,0x00,0x86,0xbf,0xf0,0xff,0x4c,0x6a,0xa5,0xbd,0xdd,0x0c,0x36,
+	0xff,0x61,0x00,0xa8,0x02,0xa2,0x0a,0x00,0x25,0xef,0x93,0xff,0xce,0x42,0x1b,0x06,
+	0x81,0x1b,0x42,0xff,0x51,0x00,0xe2,0x0a,0x40,0xd2,0x0c,0x00,0xdf,0xb8,0x12,0xee,
+	0x0d,0x75,0x51,0x01,0x85,0x1b,0xff,0xd2,0x2a,0x15,0x21,0xd8,0xf4,0xf1,0x33,0xff,
+	0xf5,0x9c,0x6d,0x98,0x72,0xd9,0x09,0x88,0xff,0xca,0x87,0x3f,0x2e,0xad,0x0c,0xb0,
+	0xb0,0xff,0xf4,0xcd,0x01,0xe0,0x0d,0x00,0x4d,0x0a,0xff,0x06,0x0a,0x00,0x8c,0x34,
+	0x1c,0x7a,0x65,0xff,0xb8,0x00,0x9c,0x33,0x0c,0x3a,0xce,0x31,0x77,0x0b,0x01,0x67,
+	0x48,0x00,0xde,0x00,0x0e,0x3b,0x0a,0xd7,0x25,0xb3,0xfd,0xbb,0x00,0x0c,0x2b,0x10,
+	0xa8,0x72,0xef,0x5e,0x7a,0x0a,0x02,0x1f,0x04,0x65,0xb5,0x00,0xf7,0x86,0xf1,0xff,
+	0xff,0x00,0xa1,0x00,0x0e,0x22,0xff,0xa8,0x5e,0x40,0x02,0xc4,0x22,0x16,0xe8,0xff,
+	0x0d,0x66,0x52,0x1d,0xa2,0x13,0x00,0xa5,0xff,0x88,0xff,0xb2,0x13,0x00,0x25,0xdf,
+	0x03,0xfe,0x8a,0x01,0x14,0xad,0x02,0xbd,0x04,0xcd,0x05,0x7f,0x25,0xa0,0x03,0x1c,
+	0x4a,0x25,0xb2,0xd1,0x00,0xfe,0x1f,0x04,0x86,0xff,0x42,0x13,0x00,0x68,0x13,0xef,
+	0x58,0x23,0xae,0x2a,0xf9,0x0c,0xa5,0xb0,0x00,0xbf,0x92,0x22,0x19,0x16,0xf9,0xfc,
+	0x2d,0x08,0x06,0xff,0x65,0x9a,0x03,0x16,0x3a,0xfc,0x1e,0xa1,0x77,0x3b,0x02,0x87,
+	0x1c,0x00,0x4e,0xd3,0x66,0x8a,0x00,0xdf,0x49,0x1b,0x6e,0x71,0x0c,0xe3,0x08,0x6e,
+	0x36,0xff,0x3d,0xbe,0xa1,0x03,0xa4,0x22,0xde,0x3c,0xfd,0x74,0x9b,0x01,0xad,0x1b,
+	0x30,0x4b,0x93,0xa5,0xff,0x58,0x00,0xe8,0x01,0x39,0x81,0x5e,0x3e,0xff,0x07,0x1e,
+	0xc7,0x1e,0x55,0x1b,0x0c,0x03,0xff,0x20,0xa3,0xa0,0xf2,0x2a,0x36,0x9c,0xdf,0xff,
+	0x30,0x80,0x14,0x70,0x44,0x10,0x92,0x1a,0xff,0x4c,0x99,0x21,0x80,0x44,0x20,0x42,
+	0x41,0xff,0x04,0x82,0x2a,0x36,0x8e,0x71,0x3a,0x20,0xfe,0x38,0x07,0xa5,0x56,0x00,
+	0x1b,0x33,0x30,0x30,0xff,0x74,0x66,0x43,0xd0,0x1c,0x2a,0x65,0xa8,0xff,0x00,0xa1,
+	0x8f,0xf4,0xc2,0x2a,0x35,0xbe,0xef,0x4a,0x7c,0x80,0x21,0x1d,0x00,0xc2,0x6a,0x35,
+	0xfc,0x92,0x00,0x2e,0x02,0x22,0x3a,0x66,0x18,0x12,0xc2,0xbb,0x22,0x3b,0x50,0x03,
+	0x3e,0xa3,0x3b,0x69,0x0a,0x65,0xfb,0xe8,0xff,0xda,0x00,0x0c,0x82,0x22,0x19,0xb2,
+	0xff,0xd2,0x01,0xae,0x4b,0x8b,0x76,0x01,0x02,0xfb,0x78,0x22,0xe3,0x02,0x3d,0x0a,
+	0xb1,0x7e,0xf4,0xff,0x4d,0x0a,0xd8,0x81,0xb8,0x7b,0xce,0x1c,0x77,0x06,0x04,0x47,
+	0x3f,0x01,0xde,0x6c,0x29,0xbe,0x02,0xff,0xa5,0x1b,0x99,0x0b,0x9e,0x71,0x4a,0x24,
+	0xfe,0xd0,0x06,0xe5,0x4d,0x00,0xc8,0x41,0x39,0x91,0xff,0xbc,0x5c,0x0c,0x03,0x92,
+	0x22,0x3b,0xac,0xff,0x69,0x90,0xa3,0xa0,0xd8,0x0a,0x9c,0xfd,0xfe,0xa9,0x04,0x66,
+	0x10,0x20,0x93,0xb0,0x92,0x19,0xff,0x54,0x99,0x61,0x80,0x66,0x20,0x62,0x41,0x7f,
+	0x14,0xe8,0x0a,0xee,0x71,0x7a,0x24,0xab,0x04,0xfb,0xe5,0x4b,0xab,0x14,0xca,0x88,
+	0x91,0xcc,0x68,0xff,0x1c,0x3a,0x65,0x9d,0x00,0x06,0x01,0x00,0xff,0x1c,0x5a,0xe5,
+	0x9c,0x00,0x92,0x12,0x64,0x7f,0x1b,0x99,0x92,0x52,0x64,0x86,0xa4,0x8f,0x05,0xff,
+	0x61,0x00,0x21,0x5d,0xf4,0x6e,0x00,0x05,0xfe,0x2a,0x01,0xa1,0x1b,0xc0,0x20,0x00,
+	0x6e,0x71,0xfd,0x08,0x86,0x02,0x81,0x1b,0x87,0x13,0x66,0x0e,0x6b,0x93,0x09,0xb6,
+	0x02,0xc1,0x15,0x04,0x99,0x01,0x04,0x00,0xff,0x28,0x01,0x1d,0xf0,0xa8,0x04,0x38,
+	0x14,0xff,0x2e,0x1a,0x0b,0x5e,0xa1,0x03,0x58,0x22,0xff,0xb8,0x14,0xb0,0xac,0x34,
+	0xb6,0x9a,0x02,0xf7,0x06,0x3e,0x00,0x02,0x00,0x56,0x1b,0x0c,0x30,0xff,0xac,0x34,
+	0xa6,0x9a,0x02,0x30,0xa8,0x21,0xff,0xa0,0xa0,0x74,0xe5,0x6c,0xff,0x30,0x90,0xff,
+	0x34,0xec,0xf9,0x16,0xca,0x17,0x30,0x94,0xff,0x34,0x16,0xe9,0x18,0x0b,0xc9,0x16,
+	0x2c,0xff,0x19,0xd2,0xc9,0xfe,0x16,0x9d,0x1a,0xe2,0x7f,0xc9,0xfd,0x16,0x2e,0x19,
+	0x8e,0x08,0x5e,0x00,0xff,0x00,0x41,0x1b,0xa8,0x04,0x31,0x98,0xf4,0xff,0x66,0x1a,
+	0x28,0xf8,0x14,0xf9,0x03,0x86,0xff,0xe5,0xff,0x66,0x39,0x58,0x9c,0x3a,0x92,0xff,
+	0x1a,0x7f,0x8c,0xe9,0x81,0x7a,0xf4,0xa2,0xff,0x08,0x05,0x82,0x08,0x06,0x9a,0xaa,
+	0xaa,0x7f,0x88,0x82,0x54,0x02,0x5e,0x07,0x09,0xd8,0x01,0xff,0x41,0x1b,0x5e,0x2a,
+	0x89,0x5e,0x81,0x03,0xff,0xc0,0x22,0x71,0x58,0xf4,0xb8,0x03,0x77,0xbb,0x1b,0x0b,
+	0x85,0x0c,0xc6,0x31,0x00,0x02,0x00,0x56,0xf7,0x69,0x08,0xa1,0x16,0x00,0x14,0xa7,
+	0x9b,0x40,0xff,0xa1,0x76,0xf4,0xa8,0x0a,0x16,0x5a,0xf4,0xf7,0xe5,0xb9,0xff,0xbc,
+	0x00,0xa9,0x01,0x86,0xce,0xff,0xff,0x66,0x29,0x13,0xd2,0x22,0x11,0xce,0xfb,0x01,
+	0x0b,0xab,0x0a,0xd0,0xbc,0x83,0xb2,0x54,0xbf,0x02,0x86,0xe9,0xff,0x0c,0x29,0xe2,
+	0x08,0x46,0x7f,0xc6,0xff,0x1c,0xea,0xe5,0x8a,0x00,0x0c,0x00,0xdf,0x59,0x01,0x06,
+	0xc3,0xff,0x57,0x0c,0xb0,0xa8,0xfd,0x41,0xce,0x04,0x5f,0xff,0x8c,0x9a,0x25,0xb5,
+	0xee,0x49,0x0c,0x06,0xbc,0xff,0x23,0x0c,0xba,0xff,0xb0,0xff,0xa8,0x74,0x65,0x5e,
+	0xff,0x16,0xfa,0x09,0xbf,0xc2,0x2a,0x17,0x16,0x9c,0xed,0x12,0x01,0x9c,0xff,0x34,
+	0xf6,0x99,0x0f,0xc6,0x03,0x00,0x1c,0xf7,0xca,0x25,0x86,0x4a,0x0c,0x46,0xb0,0xff,
+	0xb0,0xfb,0x98,0x74,0x67,0x03,0x90,0xee,0xc0,0x56,0x5e,0xff,0xeb,0x98,0x72,0x82,
+	0x2a,0x17,0xc9,0x09,0xcf,0xae,0x34,0x2b,0x80,0xaa,0x05,0x07,0x02,0xa8,0x72,0xdf,
+	0x6e,0x7a,0x0a,0x03,0xc7,0x75,0x01,0x25,0x83,0xf7,0x00,0xc6,0xa4,0x54,0x04,0xe5,
+	0x58,0xff,0xcd,0xff,0x0a,0x16,0x0a,0x05,0xd2,0x2a,0x18,0x16,0xef,0x2d,0xe8,0xb8,
+	0x03,0x8b,0x14,0x74,0xe2,0x0c,0xfb,0x40,0xa0,0x46,0x00,0xee,0xe6,0x98,0x72,0xb0,
+	0xff,0xa0,0xf4,0x82,0x2c,0x18,0xd9,0x09,0xb2,0xf3,0x14,0x02,0x44,0x00,0x6a,0x00,
+	0xb8,0x72,0x79,0x03,0x7f,0xa9,0x01,0x6e,0x7b,0x0a,0x03,0xa7,0x72,0x07,0xff,0x7e,
+	0x00,0xc6,0x91,0xff,0x2e,0xf2,0xf9,0x7a,0x50,0x02,0x45,0xc4,0x05,0x59,0x01,0xc6,
+	0x8d,0xb8,0x0c,0xff,0xc6,0x8b,0xff,0xb2,0x2a,0x1f,0x92,0x2a,0xff,0x20,0x46,0x01,
+	0x00,0xb2,0x2a,0x21,0x92,0xff,0x2a,0x22,0xb0,0x99,0xc0,0x86,0x00,0x00,0xff,0x92,
+	0x2a,0x1e,0x90,0xc2,0x41,0xc2,0x54,0xf7,0x02,0xee,0xec,0x35,0x0c,0xb2,0x2a,0x23,
+	0x92,0xfb,0x2a,0x24,0x1c,0x00,0x46,0xf9,0xff,0x00,0x36,0xdf,0x41,0x00,0x4e,0xd2,
+	0x33,0xd1,0x02,0x1d,0x1b,0xff,0x42,0x14,0x74,0x20,0x88,0x41,0x8e,0x44,0xfd,0x62,
+	0x48,0x01,0xad,0x1b,0x40,0x23,0x83,0x1d,0xfd,0xf0,0x4b,0x02,0x41,0x00,0x51,0x19,
+	0xf4,0x28,0x7f,0x05,0x31,0xc6,0xf3,0x8e,0x52,0x14,0x19,0x00,0xff,0x61,0x1b,0x42,
+	0x48,0x03,0x32,0x23,0x4e,0xff,0x32,0xd3,0xfb,0x32,0xc3,0xb8,0x3e,0xb3,0xfb,0x3a,
+	0x09,0x9f,0x07,0xa5,0x78,0x00,0xbd,0x03,0xff,0xad,0x02,0xa5,0x4f,0xff,0x61,0xbe,
+	0xf3,0xdf,0x38,0x05,0x5e,0x42,0xe9,0xa6,0x0b,0x92,0x66,0xff,0x11,0xa8,0xd3,0xb8,
+	0xe3,0xac,0xca,0xae,0xff,0x2b,0x02,0x70,0x00,0x00,0x54,0x22,0xd2,0xff,0x23,0x1e,
+	0x5a,0xca,0xd7,0xbc,0x20,0x0c,0xff,0x8b,0x25,0x56,0xfd,0xa2,0x62,0x10,0xa9,0xbf,
+	0xf2,0x5e,0xa5,0x3b,0x00,0x47,0x41,0x00,0x25,0xbd,0x55,0x0f,0x00,0x12,0xa2,0x62,
+	0x11,0xb2,0x00,0x22,0xff,0xc3,0x40,0xe8,0xf2,0x82,0x26,0x15,0x82,0xff,0x62,0x13,
+	0x82,0x62,0x14,0xf2,0x26,0x17,0xff,0xf2,0x62,0x15,0x9c,0xbe,0x92,0x22,0x11,0xff,
+	0x9c,0x69,0xa2,0x23,0x11,0x9c,0x1a,0xad,0xed,0x03,0x68,0x00,0xae,0x2a,0x88,0x0f,
+	0xa0,0x2b,0x93,0xff,0x86,0x01,0x00,0x0c,0xfa,0xa5,0x6c,0x00,0xff,0x0c,0x12,0x9d,
+	0x03,0xce,0x04,0x0a,0x1f,0xfd,0xe7,0x08,0x02,0x76,0xac,0x18,0xa2,0x43,0x9a,0xff,
+	0xa2,0x43,0x9b,0xa2,0x49,0xaa,0xae,0x89,0xff,0xb3,0x60,0x80,0x00,0x94,0x22,0x4e,
+	0x79,0x3f,0xb9,0x22,0x01,0x00,0x84,0x22,0xd8,0x00,0xd7,0x00,0xff,0xa2,0x02,0x00,
+	0xe5,0x3f,0xff,0xe2,0x2a,0xff,0x1a,0x81,0xed,0xf3,0xac,0xbe,0x98,0xca,0xff,0x97,
+	0x38,0x0e,0xcd,0x04,0xad,0x02,0x30,0xff,0xb0,0xf4,0xdd,0x05,0xe0,0x0e,0x00,0x86,
+	0x8f,0x02,0x00,0xcd,0x04,0xd4,0x04,0x0d,0x08,0x6d,0x20,0x46,0xfd,0x00,0x68,0x00,
+	0x8c,0xb2,0x0c,0x1c,0xce,0x65,0x77,0x0a,0x03,0x67,0xe5,0x00,0xe5,0x64,0x00,0x2a,
+	0x05,0xfe,0x53,0x04,0x91,0xce,0xf3,0x98,0x09,0xbc,0x79,0xff,0x32,0xd9,0x01,0xa2,
+	0x03,0x01,0x2e,0x00,0xfd,0x04,0x93,0x0a,0x5e,0x1a,0x53,0x60,0x80,0x02,0xff,0xc4,
+	0x22,0xa2,0x29,0x14,0x0e,0x2a,0x02,0xfe,0x18,0x01,0x55,0x1b,0x21,0x75,0xf3,0x88,
+	0x72,0xff,0xa9,0x08,0xe0,0x0a,0x00,0x98,0x72,0x49,0xef,0x09,0x0e,0x0a,0x02,0x04,
+	0x0b,0x1d,0xf0,0x0c,0xff,0x02,0x1d,0xf0,0x42,0x43,0x7d,0x4e,0x83,0xff,0xea,0x05,
+	0x27,0x01,0x8d,0x1b,0x65,0x5f,0xfd,0x00,0xab,0x0c,0xbe,0x04,0x0a,0x02,0x07,0x02,
+	0xff,0xa1,0x1b,0xe5,0x42,0xfd,0x3d,0x0a,0xbe,0xf7,0xc3,0x3c,0x06,0xb0,0x05,0x65,
+	0x44,0xfd,0x81,0x7f,0xb2,0xf3,0x80,0x82,0xa0,0x39,0x08,0x7f,0x14,0xff,0x0c,0x0a,
+	0x25,0xfd,0xff,0x91,0x5b,0xf3,0xff,0x81,0xac,0xf3,0x92,0x29,0x46,0x88,0x08,0xdf,
+	0x82,0x69,0x16,0x1d,0xf0,0x17,0x00,0x58,0x22,0x7f,0x88,0x32,0x4a,0x55,0x5e,0x72,
+	0x27,0x67,0x00,0xef,0x81,0x1b,0x1e,0x34,0x74,0x07,0x55,0x1b,0x76,0xff,0x94,0x29,
+	0xb8,0x02,0x7e,0xa3,0x2c,0x00,0xff,0x21,0x01,0xac,0x22,0xc9,0x32,0xa2,0x0a,0xff,
+	0x00,0x8a,0xbb,0xa2,0x4b,0x00,0x68,0x12,0xff,0x88,0x32,0x6e,0xe8,0xc7,0xe0,0x20,
+	0x00,0xdf,0x60,0x22,0x9e,0x72,0x38,0x32,0x08,0x3d,0xf0,0xea,0x47,0x08,0x6e,0xd2,
+	0x00,0x47,0xd2,0x00,0x3d,0xf0,0x76,0xff,0xa4,0x0c,0x52,0x02,0x30,0x3e,0xa5,0xb2,
+	0xfd,0x40,0x26,0x04,0x1b,0x66,0x22,0xa0,0xff,0x1d,0xf7,0xf0,0x2d,0x06,0x33,0x12,
+	0x31,0x9b,0xf3,0x38,0x5f,0x03,0x38,0xb3,0x3e,0x72,0xd8,0x04,0x81,0xd8,0x00,0xdf,
+	0x36,0x81,0x00,0x31,0x96,0x13,0x00,0x88,0xb3,0xf7,0x8e,0x08,0x05,0x49,0x01,0x59,
+	0x1b,0x0c,0x12,0xff,0x1d,0xf0,0xad,0x03,0xb2,0x02,0x00,0xa5,0xff,0xfa,0xff,0xae,
+	0xa0,0xe8,0x1f,0xe7,0x01,0xf7,0x49,0x1b,0x87,0xf2,0x03,0x21,0x00,0x81,0x2f,0xff,
+	0xf3,0x30,0x6a,0xa0,0x98,0xd6,0x8e,0x48,0xf7,0xe9,0x20,0x21,0x4d,0x03,0x99,0xd6,
+	0x48,0x12,0xfe,0x0c,0x03,0xe2,0x23,0x13,0xb8,0xb3,0x98,0x73,0xef,0xae,0x7a,0x3f,
+	0x08,0x30,0x06,0x0e,0x2b,0x7d,0xfe,0x5b,0x00,0xc1,0x1b,0x40,0x41,0x21,0xb1,0x36,
+	0xff,0xf3,0x82,0x0b,0x44,0x80,0xdf,0x93,0xda,0xff,0xd4,0x7e,0x0e,0x0d,0xa6,0x01,
+	0x01,0x58,0xff,0x22,0xd2,0x63,0x13,0xe8,0x83,0xa1,0x1b,0xff,0xf3,0xe0,0x99,0xc0,
+	0xd7,0x39,0x23,0x51,0xff,0x2e,0xf3,0xb1,0x77,0xf3,0x1e,0xa1,0x3c,0xfd,0x02,0xc3,
+	0x05,0xe5,0x7d,0x05,0xa8,0x22,0xc2,0xff,0x02,0x00,0xd1,0x74,0xf3,0xdc,0xda,0x0c,
+	0xff,0x0f,0xf9,0x41,0xf9,0x51,0x06,0x1f,0x00,0xff,0x82,0x2a,0x39,0x1b,0x88,0x82,
+	0x6a,0x39,0x7f,0x81,0x0f,0xf3,0x88,0xf8,0xad,0x07,0x70,0x00,0xff,0x2d,0x05,0x1d,
+	0xf0,0xe2,0x03,0x4a,0xf8,0xff,0xd6,0x00,0xcc,0x11,0x40,0xee,0x01,0xf0,0xff,0xf0,
+	0x34,0x80,0xff,0x01,0xf0,0xcc,0x20,0xff,0xe0,0xcc,0x20,0xd0,0xcc,0x20,0xc9,0x41,
+	0xff,0x98,0xb3,0x00,0xb9,0x11,0xb0,0xb4,0x20,0xff,0xb9,0x51,0x66,0x29,0x05,0xa2,
+	0x63,0x11,0xff,0x86,0x03,0x00,0x81,0xfc,0xf2,0x82,0x28,0x7f,0x12,0xb2,0x23,0x11,
+	0x40,0xc1,0x21,0x41,0x00,0xff,0xd1,0x27,0xf3,0xe1,0x5b,0xf3,0xa8,0xd6,0xff,0xa9,
+	0x01,0x92,0x16,0x1a,0xe9,0x11,0xd2,0xff,0x0d,0x8c,0xe1,0x5a,0xf3,0xb1,0x56,0xf3,
+	0xff,0xe0,0xdd,0x20,0xb7,0x99,0x03,0x1b,0xca,0xff,0xc9,0x01,0xd9,0x31,0xf1,0x54,
+	0xf3,0xf9,0xff,0x21,0xf2,0x05,0x44,0x3e,0x2f,0x02,0x66,0xfe,0x22,0x07,0x80,0xea,
+	0x03,0x91,0xff,0xf2,0xb1,0xff,0x51,0xf3,0xad,0x02,0x8e,0x79,0xcc,0x08,0xff,0x47,
+	0x00,0x8d,0x1b,0xe5,0xe3,0xff,0xb1,0xff,0xfb,0xf2,0xa1,0x17,0xf3,0xa2,0x6b,0x6b,
+	0xff,0xad,0x02,0xce,0x04,0x0b,0x24,0x00,0x00,0x5f,0xa0,0x22,0xa5,0xe2,0xff,0x0c,
+	0x0c,0x80,0x0c,0x04,0xef,0xe1,0xff,0xcd,0x04,0x77,0x00,0xad,0x02,0x25,0x7d,0xe1,
+	0x16,0x00,0x31,0xdd,0xf2,0x1e,0xb1,0xed,0x0c,0xff,0x25,0xe0,0xff,0xa8,0x93,0x88,
+	0x3a,0x0c,0xcf,0x7b,0xce,0x00,0x0d,0x8e,0x0a,0x97,0x00,0x1e,0xf8,0xbf,0xf5,0x00,
+	0x07,0x01,0x45,0x1b,0xab,0x09,0xc1,0xff,0x30,0xf3,0xc8,0x0c,0xb8,0x8c,0xa2,0xa4,
+	0xdf,0x18,0xb7,0x3a,0x03,0xb9,0x80,0x02,0x32,0x2c,0xff,0x13,0xbd,0x03,0xa5,0x5f,
+	0x05,0xa0,0xb3,0xef,0x82,0x46,0xfb,0xff,0x23,0x08,0x81,0x27,0xf3,0xff,0x88,0x08,
+	0x48,0x88,0x78,0xa8,0x20,0x44,0xaf,0xc0,0x4e,0x78,0x86,0x45,0x0e,0x32,0x45,0x12,
+	0x92,0xff,0x29,0xb8,0x68,0x6e,0xc3,0x2d,0xe0,0x20,0xfe,0x45,0x02,0xd9,0xa8,0x7a,
+	0xbb,0xb2,0x0b,0x00,0xff,0xb2,0x4c,0x00,0xa8,0x78,0x78,0xa8,0xae,0x37,0xe7,0xc6,
+	0xc0,0x45,0x0a,0x78,0xa7,0x45,0x1a,0x4f,0x00,0xff,0xa1,0x00,0x2e,0x52,0x38,0x7c,
+	0xe0,0x03,0xdf,0xa4,0x22,0x9e,0x98,0x06,0x0c,0x0a,0x98,0x04,0xff,0x56,0xc9,0x08,
+	0xb1,0x15,0xf3,0x28,0x14,0xf7,0x4e,0x00,0x0a,0xdd,0x08,0x4e,0x71,0x0c,0x00,0xfd,
+	0xc7,0x32,0x00,0x25,0x63,0x05,0x98,0xb5,0x20,0xff,0x30,0x74,0x30,0x99,0xc0,0x16,
+	0x99,0x0c,0xff,0x21,0xa7,0xf2,0xa8,0x92,0x16,0x0a,0x10,0xff,0x16,0x43,0x0c,0xa1,
+	0xa1,0xf2,0xa2,0x2a,0xff,0x46,0x0c,0x39,0x99,0x01,0xae,0x4a,0x6b,0xfb,0x28,0x00,
+	0x27,0x02,0xbe,0x71,0x5b,0x00,0x87,0xfe,0x32,0x00,0xb9,0x41,0x88,0x0a,0xc2,0xc1,
+	0x10,0xdf,0xde,0x0c,0x0b,0x00,0xa7,0xef,0x0c,0xb1,0xae,0xff,0xf2,0xc2,0x01,0x23,
+	0xc2,0x45,0x4a,0xb2,0xff,0x0b,0x44,0x9c,0xbb,0xa1,0xfa,0xf2,0xbe,0xfb,0x00,0x0c,
+	0x59,0x01,0xa1,0x1b,0x25,0x0f,0xfd,0xff,0xe1,0xa4,0xf2,0xd1,0xf8,0xf2,0xf1,0xf7,
+	0xff,0xf2,0xf2,0x6e,0x69,0xd2,0x6e,0x6a,0x62,0xff,0x62,0x12,0xa8,0x92,0x86,0x1a,
+	0x00,0x26,0xff,0x19,0x03,0x0c,0x22,0x1d,0xf0,0x88,0x14,0xbf,0x80,0x30,0xe4,0xfe,
+	0x28,0xa4,0x9e,0x02,0x61,0xf7,0x1b,0xad,0x02,0x17,0x01,0xcf,0xff,0x4e,0xaa,0xfd,
+	0xd2,0x3d,0x01,0x65,0x1b,0x5a,0x9a,0x42,0x49,0xf9,0x30,0xc4,0x02,0x15,0x00,0x65,
+	0xce,0xff,0x4e,0x0a,0xfd,0xb2,0xca,0x00,0x81,0x1b,0x5e,0x25,0x3a,0x00,0xfe,0x9f,
+	0x06,0x76,0xaa,0x07,0xb2,0x02,0x30,0x47,0xef,0x1b,0x07,0x1b,0x22,0xea,0x06,0x1d,
+	0xf0,0x3e,0x2d,0x82,0x0c,0x03,0x01,0x85,0xe5,0x07,0x12,0x03,0x0c,0xeb,0x03,0xef,
+	0x62,0x12,0x49,0x01,0x9c,0x01,0x5b,0x1e,0xc1,0xf5,0x3d,0x3d,0x00,0xa5,0xac,0x04,
+	0x2d,0x0a,0x56,0x4a,0xff,0xfe,0x49,0x85,0x49,0x95,0x49,0xa5,0x42,0xef,0x65,0x13,
+	0x5e,0x95,0x4e,0x18,0x4e,0x79,0xd9,0x9b,0x20,0x81,0xe7,0x00,0x39,0xb5,0x3e,0x0c,
+	0x67,0x07,0x60,0xbf,0xf2,0x32,0x23,0x46,0x51,0x75,0x05,0x00,0x1a,0xdf,0x5e,0x35,
+	0x64,0x1f,0xe7,0x2d,0x02,0x5e,0x73,0x7d,0x72,0xa3,0x03,0x81,0x1b,0xf0,0x20,0x00,
+	0x02,0x00,0xff,0x76,0xa2,0x07,0x4e,0x83,0x03,0x60,0x20,0xdf,0x01,0x84,0x22,0x0c,
+	0x02,0x33,0x08,0xae,0x50,0xfd,0x0b,0xc3,0x0b,0x25,0xfe,0xfc,0x2d,0x0a,0xbe,0xff,
+	0xbb,0x2c,0x02,0x87,0x01,0x1d,0x1b,0xa5,0xff,0xff,0xfc,0x81,0x50,0xf2,0x8e,0x48,
+	0x5a,0xff,0x00,0x07,0x04,0x81,0x1b,0x8e,0x72,0x6b,0xfe,0x42,0x08,0xe5,0xfb,0xfc,
+	0x91,0x47,0xf2,0xa2,0xff,0x62,0x11,0xa1,0xa7,0xf2,0x92,0x29,0x46,0xdf,0x29,0x0a,
+	0x22,0x69,0x1a,0x43,0x08,0x91,0x42,0xff,0xf2,0x51,0xad,0xf2,0x81,0xad,0xf2,0x62,
+	0xff,0x29,0x51,0x58,0x05,0x62,0x68,0x00,0x81,0xff,0x55,0xf2,0x72,0x15,0x24,0x72,
+	0x56,0x00,0xdf,0x3e,0x38,0x82,0x00,0x67,0x85,0x00,0x3e,0x66,0xdd,0x17,0xf2,0x09,
+	0x2e,0x76,0x13,0x07,0x08,0x76,0xa2,0xff,0x1c,0x50,0x43,0xa0,0x60,0xa3,0xa0,0x80,
+	0xff,0xb3,0x90,0xb2,0x1b,0x69,0xb2,0x5a,0x05,0xbf,0x32,0x5a,0x04,0x7e,0x74,0x33,
+	0x99,0x00,0x80,0xff,0x22,0x30,0x30,0x74,0xd2,0x29,0x51,0xc8,0xff,0x95,0xd0,0xcc,
+	0xa0,0xd1,0x2e,0xf2,0xe2,0x7f,0xcc,0x34,0xee,0x7d,0x7c,0x8e,0x01,0xea,0x00,0xc7,
+	0xce,0x7d,0x82,0x3d,0x08,0x36,0x06,0x87,0x06,0x31,0x27,0xff,0xf2,0x71,0x3a,0xf2,
+	0x32,0x03,0x0b,0x82,0xff,0x17,0x6b,0x66,0x13,0x03,0x0c,0x42,0x1d,0xff,0xf0,0x16,
+	0x68,0x05,0x51,0x8a,0xf2,0x58,0xff,0x05,0x92,0x25,0x15,0x56,0xb9,0x04,0xc8,0xff,
+	0xe5,0xa1,0x1b,0xf2,0x1b,0xec,0xe9,0xe5,0xf7,0xd2,0x2a,0x51,0x4d,0x00,0x29,0x0c,
+	0xc8,0xa5,0xfd,0xb8,0x0b,0x04,0xc0,0xbb,0xc0,0xde,0xcc,0x4b,0xff,0x7e,0xc1,0x02,
+	0xac,0x22,0xb9,0x0c,0xa2,0xff,0x2a,0x51,0x98,0xa5,0xa0,0x99,0xa0,0x88,0xff,0x19,
+	0x1b,0x88,0x89,0x19,0x28,0xa5,0x62,0xff,0x17,0x6b,0x88,0xe5,0x2a,0x66,0x0b,0x66,
+	0xdf,0x8e,0xc6,0x6f,0x40,0x40,0xaf,0x02,0xf9,0xe5,0xf6,0x2b,0x05,0x0c,0x62,0x63,
+	0x0d,0x0a,0xf2,0x71,0x1d,0xaa,0x73,0x0c,0x6c,0x73,0x20,0x6d,0x73,0x08,0x16,0x73,
+	0x04,0xf5,0xd7,0xa1,0xfe,0xf1,0x73,0x00,0xf5,0x73,0x18,0xb5,0xb8,0xf5,0xf5,0x73,
+	0x44,0xb5,0x73,0x1c,0xb5,0x62,0x17,0x6c,0xeb,0x88,0xf5,0x73,0x28,0xf5,0x73,0x24,
+	0x01,0xf2,0x51,0xff,0x55,0xf2,0x32,0x13,0x6a,0x58,0x05,0x9c,0xff,0x03,0x82,0x25,
+	0x14,0xcc,0xb8,0x5c,0x88,0xff,0x2e,0xe8,0x79,0x4c,0xe0,0x02,0x60,0x22,0xff,0xf6,
+	0xb9,0x01,0x1d,0xf0,0xc1,0xe2,0xf1,0xff,0xb8,0x95,0xc2,0x2c,0x51,0xba,0xb2,0xc0,
+	0xff,0xbb,0xa0,0xa8,0x0b,0x1b,0xaa,0xa9,0x0b,0xfe,0x23,0x15,0x41,0xf2,0xf1,0x61,
+	0x46,0xf2,0x42,0xff,0x14,0x6a,0x68,0x06,0x9c,0x04,0x82,0x26,0xfa,0x3b,0x28,0xb6,
+	0x3b,0x04,0xb1,0xd3,0xf1,0xa8,0x96,0xff,0xb2,0x2b,0x51,0xaa,0xa2,0xb0,0xaa,0xa0,
+	0xfb,0x39,0x0a,0x37,0x0c,0x61,0x00,0x30,0x30,0xf4,0xff,0x81,0xcf,0xf1,0x91,0xcb,
+	0xf1,0x41,0x37,0xef,0xf2,0x82,0x08,0x0b,0xd9,0x01,0x48,0x04,0x66,0xfd,0x18,0xef,
+	0x08,0x71,0xdd,0xf1,0xa2,0x17,0x6d,0xff,0x16,0x4a,0x06,0xb2,0x24,0x17,0x56,0xab,
+	0xff,0x05,0x39,0x01,0x16,0xd3,0x05,0xc2,0x24,0xff,0x10,0xb8,0xc4,0x52,0x17,0x6d,
+	0x6a,0xac,0xff,0xba,0x55,0xc0,0x55,0xe0,0x50,0x50,0xf4,0xff,0x57,0xb3,0x18,0xbd,
+	0x02,0xcd,0x03,0x25,0xfb,0xdb,0xfc,0x1b,0x08,0x3a,0xcc,0xc2,0x64,0x10,0xb7,0x2e,
+	0x00,0x03,0xc0,0x01,0x41,0x1b,0x18,0x00,0x05,0xff,0x65,0xd9,0xfc,0xb8,0xc4,0x5a,
+	0x22,0x50,0xff,0x33,0xc0,0x3e,0x30,0xec,0x60,0x41,0x01,0xdf,0x48,0x22,0xe0,0xcc,
+	0x11,0x23,0x00,0x56,0x73,0xff,0xfb,0x61,0xae,0xf1,0x62,0x26,0x51,0x06,0xfb,0x03,
+	0x00,0xff,0x04,0x0c,0x32,0x1d,0xf0,0xb8,0xdd,0xc4,0x43,0x00,0xde,0xa8,0x1e,0x26,
+	0x00,0x1c,0x22,0xff,0xe0,0xee,0x11,0xe0,0xec,0xc0,0x6e,0xfb,0xf7,0x4e,0xde,0xe1,
+	0x4b,0x01,0xe9,0x0f,0xd2,0x2d,0xff,0x51,0xa8,0xc4,0x88,0x01,0xd0,0xaa,0xa0,0x7f,
+	0xd8,0x1a,0xda,0x88,0x8e,0x7a,0x12,0x23,0x2e,0xff,0x9e,0xf1,0x91,0x9a,0xf1,0x81,
+	0xb0,0xf1,0xdc,0xb2,0x01,0xc4,0x00,0xa2,0x18,0x6e,0xb5,0x15,0x0a,0x07,0xfb,0x51,
+	0x00,0xb5,0x01,0xb2,0x25,0x18,0x56,0x5b,0xff,0x06,0x42,0x25,0x11,0x6e,0x34,0x24,
+	0x80,0xff,0x20,0x01,0xac,0x22,0x42,0x65,0x11,0x22,0xff,0x43,0x00,0xe8,0xd5,0xd2,
+	0x25,0x11,0xfe,0xff,0x49,0x12,0xc0,0x41,0x01,0x88,0x22,0xe0,0xff,0x22,0x11,0x20,
+	0xdd,0xc0,0xfe,0xee,0x4d,0xfd,0xbe,0x72,0x04,0xd9,0x0e,0xc2,0x29,0x51,0xb8,0xf5,
+	0xd5,0x6a,0x05,0x1b,0x6a,0x01,0x1b,0x28,0xd5,0x72,0xff,0x18,0x6e,0xae,0x45,0x1b,
+	0x1f,0xe7,0x1f,0xde,0xe1,0x02,0x77,0x28,0x40,0x40,0x45,0x00,0x2e,0x88,0xff,0xf7,
+	0xe0,0x40,0x00,0xac,0x22,0xb0,0x77,0x7f,0xa0,0xa7,0xb7,0x02,0x82,0x65,0x11,0xcf,
+	0x21,0xff,0x41,0xe2,0xf1,0x20,0x98,0x74,0x20,0x30,0xef,0x74,0x4e,0x44,0x08,0xa4,
+	0x03,0x81,0x1b,0x4e,0xff,0x63,0x72,0x00,0x27,0x00,0xc1,0x1b,0x87,0xff,0x93,0x0d,
+	0x26,0x29,0x3c,0x9e,0x09,0x0b,0x7f,0x01,0x07,0x00,0x55,0x1b,0x26,0x19,0x9e,0x01,
+	0x7f,0xad,0x09,0x9e,0xab,0x2d,0x00,0x67,0xf3,0x03,0xf7,0x2e,0x63,0xd9,0xd9,0x00,
+	0xc1,0x1b,0x40,0xc3,0xff,0xa0,0xa2,0x6c,0x13,0x06,0x04,0x00,0x76,0xff,0xad,0x0d,
+	0x40,0xb9,0xa0,0xae,0x7b,0x39,0xbb,0x20,0x21,0x35,0x03,0x90,0x90,0x74,0x62,0x04,
+	0xd1,0xdf,0x5f,0xf1,0xb1,0x75,0xf1,0x13,0x01,0xc2,0x1b,0x7f,0x68,0xf6,0x63,0x75,
+	0x2e,0x23,0x09,0x34,0x00,0xff,0x55,0x1b,0x0c,0x0a,0x16,0x53,0x01,0x26,0xff,0x13,
+	0x02,0x76,0x93,0x0f,0xb0,0xe9,0x90,0xdf,0xe2,0x1e,0x69,0x1b,0x99,0x30,0x00,0xaa,
+	0xae,0xff,0xa0,0xa0,0xf4,0x46,0x00,0x00,0x0c,0x0a,0xff,0xb0,0xf3,0x90,0xf2,0x1f,
+	0x69,0xaa,0xac,0xee,0x45,0x01,0x2e,0xcf,0xfb,0x32,0x00,0xad,0x1b,0x25,0xff,0xbe,
+	0xfc,0x66,0x23,0x08,0x98,0xa4,0x2b,0xff,0x99,0x99,0xe4,0x86,0xe8,0xff,0x66,0x43,
+	0xff,0x0c,0xa8,0xc4,0x2b,0xaa,0xe0,0xaa,0x11,0xff,0xa2,0x64,0x10,0x86,0xe4,0xff,
+	0x66,0x33,0xff,0x08,0xb8,0xb4,0x2b,0xbb,0xb9,0xf4,0x86,0xff,0xe1,0xff,0x66,0x53,
+	0x83,0xc8,0xd4,0x2b,0xfd,0xcc,0xc0,0x09,0x11,0x86,0xdd,0xff,0xe2,0x14,0xef,0x24,
+	0xd0,0xac,0xa0,0x0e,0x00,0xce,0xce,0x5b,0xfb,0x00,0x07,0xbb,0x00,0x65,0xb9,0xfc,
+	0xc8,0xb4,0xff,0xa8,0xd4,0xb8,0xc4,0x9e,0x44,0xac,0x80,0xbd,0x21,0xca,0x07,0x74,
+	0xfa,0x40,0x41,0x07,0x00,0x2e,0xef,0xaa,0xfb,0x60,0x41,0x26,0x01,0xe0,0xbb,0x11,
+	0xff,0xb2,0x64,0x10,0xa2,0x64,0x11,0x9e,0xf0,0xbf,0xf9,0x20,0x41,0x01,0x44,0x22,
+	0xbb,0x05,0x21,0xff,0x99,0xf1,0x28,0x02,0x91,0x2e,0xf1,0xa1,0xdf,0x2a,0xf1,0xce,
+	0x12,0x08,0x13,0x09,0xb2,0x12,0xef,0x00,0xb2,0x54,0x00,0x3e,0x03,0xa9,0x03,0x8e,
+	0xbb,0x89,0xb2,0xe9,0x09,0x22,0x55,0x00,0x59,0x01,0x36,0x07,0x6e,0x65,0x02,0x43,
+	0x01,0xf8,0x0d,0x3b,0x00,0x0b,0x05,0x07,0x04,0xff,0xbe,0x04,0x0a,0x0c,0x47,0x00,
+	0xa1,0x1b,0xff,0x25,0xb0,0xfc,0x2d,0x0a,0xbe,0x86,0x1c,0xff,0x04,0x47,0x01,0x1d,
+	0x1b,0xa5,0xb1,0xfc,0xff,0xa1,0x2c,0xf1,0xf2,0x1a,0x69,0xe2,0x1a,0xff,0x68,0xfa,
+	0xee,0xe9,0x92,0xd2,0x1a,0x6a,0xff,0xea,0xdd,0xd9,0xa2,0xe2,0x1a,0x6b,0xda,0xff,
+	0xee,0xe9,0xb2,0xb2,0x1a,0x6c,0xea,0xbb,0xd7,0xbe,0x72,0xcc,0x98,0x00,0x80,0x94,
+	0x06,0x9e,0x3a,0xff,0xdd,0xa0,0x41,0x00,0x8c,0x22,0xde,0x72,0xfb,0xee,0xc0,0x12,
+	0x04,0xe9,0xf2,0xc2,0x62,0x10,0xbf,0xba,0x99,0x9e,0x72,0xd9,0x20,0x21,0x08,0x99,
+	0xff,0x11,0x92,0x62,0x11,0xe2,0x1a,0x69,0xf2,0x9f,0x1a,0x6b,0x82,0x1a,0x6d,0x3d,
+	0x00,0x4e,0x00,0xc2,0xff,0x1a,0x68,0x8a,0xbb,0xfa,0xdd,0xea,0xcc,0xff,0xa2,0x1a,
+	0x6e,0xda,0xcc,0xca,0xbb,0xba,0xf9,0xaa,0x3a,0x09,0x6e,0x01,0xae,0x62,0x4b,0x00,
+	0x47,0xff,0x00,0x85,0x1b,0xe5,0xa6,0xfc,0xb1,0xf5,0xff,0xf0,0x81,0x5f,0xf1,0x98,
+	0x6b,0x29,0x08,0xbf,0xa2,0x6b,0x11,0x22,0x69,0x1e,0xb3,0x16,0xa1,0xff,0x05,0xf1,
+	0x4e,0x4a,0x05,0x01,0xe7,0x00,0xf7,0x8d,0x1b,0x0e,0xbf,0x11,0xb2,0x2a,0x71,0xa1,
+	0xff,0x57,0xf1,0x3a,0xbb,0x25,0xe7,0x04,0x9e,0xfd,0x4a,0x9f,0x01,0x01,0x7d,0x1b,
+	0xa0,0x9b,0x83,0xff,0x90,0x95,0x63,0xc6,0xff,0xff,0xc1,0x53,0xff,0xf1,0xd1,0x51,
+	0xf1,0x90,0xb0,0x34,0x40,0xff,0xf2,0xb0,0xe8,0x1f,0x80,0x9b,0x11,0x40,0xff,0xbb,
+	0x11,0xd0,0xee,0x10,0xe0,0xeb,0x20,0xfd,0xc0,0x05,0x00,0xe9,0x20,0xe9,0x1f,0x66,
+	0x22,0xef,0x11,0xe2,0x24,0x13,0x13,0x24,0xe2,0x64,0x13,0xfe,0x1f,0x0d,0x61,0xea,
+	0xf0,0xb1,0xd9,0xf0,0x91,0xff,0xd4,0xf0,0xc2,0x26,0x60,0xb2,0x0b,0x09,0xff,0x98,
+	0x49,0xc0,0xa2,0xb0,0xa8,0x1a,0xc0,0xff,0x99,0xb0,0x98,0x19,0x66,0x1b,0x08,0xa0,
+	0xff,0x38,0x34,0x90,0xa8,0x34,0x46,0x01,0x00,0xff,0xa0,0x3c,0x34,0x90,0xac,0x34,
+	0xae,0x03,0xfb,0x7c,0x03,0x72,0x05,0xc7,0x92,0x48,0x30,0x40,0xff,0x74,0x21,0xc4,
+	0xf0,0x66,0x1b,0x12,0xd1,0xff,0xf2,0xf0,0xd2,0x0d,0x8e,0xfc,0x8d,0x82,0xff,0x22,
+	0x34,0xad,0x04,0xe0,0x08,0x00,0x46,0xff,0x03,0x00,0x82,0x22,0x37,0x4e,0xa4,0x3b,
+	0x7c,0xf8,0x09,0x10,0x00,0xae,0x29,0x1b,0x60,0x20,0xb7,0x03,0xff,0x65,0xdb,0x04,
+	0xa2,0x62,0x61,0xb1,0xcb,0xff,0xf0,0xe5,0xda,0x04,0x98,0x36,0xb1,0xca,0xff,0xf0,
+	0xa0,0x99,0x82,0x92,0x6b,0x7c,0x1d,0x7f,0xf0,0x51,0x24,0xf1,0xce,0xf8,0xf7,0xe6,
+	0x00,0xff,0xa1,0x1b,0xc0,0x20,0x00,0xb2,0x25,0x10,0xf7,0xc0,0xbb,0x10,0x08,0x04,
+	0x65,0x10,0xa2,0x22,0x7f,0x72,0x82,0x22,0x3e,0xae,0x4a,0x1b,0xd9,0x09,0xee,0x4b,
+	0x00,0xa1,0x1a,0xf1,0x19,0x00,0x92,0x25,0x10,0xff,0xa0,0x99,0x10,0xad,0x04,0x70,
+	0x99,0x20,0xb6,0x0d,0x04,0x65,0x10,0x70,0x00,0x0c,0x0b,0x7b,0x04,0xe4,0xfd,0xff,
+	0x3f,0x09,0x9e,0xf0,0x81,0x11,0xf1,0xb1,0xdf,0xa3,0xf0,0x92,0x2a,0x61,0xd3,0x00,
+	0x9e,0xe8,0xfd,0x42,0x5c,0x00,0x65,0x1b,0x66,0x1b,0x0a,0x82,0xef,0x2a,0x34,0x0c,
+	0x3a,0xa4,0x10,0x2a,0x37,0xbe,0xcf,0x00,0x0a,0x01,0x27,0x75,0x00,0x10,0x00,0x0c,
+	0x12,0xbb,0x1d,0xf0,0x9b,0x0b,0x4e,0x72,0x79,0x8a,0x0b,0xc6,0xff,0x20,0x00,0x41,
+	0x01,0xf1,0xc2,0x04,0x00,0xff,0x71,0x01,0xf1,0xce,0xa0,0x86,0x1f,0xe7,0xbf,0x1e,
+	0x49,0x1b,0x0e,0x7a,0xd5,0x84,0x02,0xcd,0xff,0x1b,0x27,0x9a,0x57,0xc0,0xd5,0x41,
+	0x70,0xef,0xdd,0xa0,0xd8,0x0d,0x7f,0x04,0x04,0x01,0xe8,0xff,0x0d,0x90,0x90,0x44,
+	0x00,0x19,0x40,0x00,0xff,0x85,0xa1,0xe0,0xa8,0x20,0x60,0x88,0x30,0xff,0x8e,0xee,
+	0x6f,0x7e,0xe0,0x02,0xac,0x22,0xb7,0xf0,0xae,0x93,0x21,0x00,0xa9,0x0d,0x23,0x00,
+	0x57,0xff,0x69,0x22,0xa1,0x78,0xf0,0xb1,0xee,0xf0,0xff,0xa2,0x2a,0x61,0xa5,0xca,
+	0x04,0xa0,0xca,0xff,0x90,0xce,0x4c,0x4b,0x1e,0xc7,0x1e,0x61,0xef,0x1b,0xb0,0xcc,
+	0x10,0xc5,0x01,0xc2,0xcc,0xfc,0xff,0x56,0x9c,0xff,0xc2,0x04,0x02,0xc0,0xa0,0xff,
+	0x44,0x5e,0x7a,0xb4,0x80,0x40,0x01,0xd0,0xdf,0x22,0x0c,0x09,0x2d,0x09,0xcf,0x12,
+	0x7e,0x69,0x7d,0x05,0x50,0x01,0x1d,0x1b,0x6e,0x6e,0x04,0x07,0x08,0xdf,0x8e,0xf7,
+	0xf2,0x00,0xc7,0xbb,0x00,0x3d,0xf0,0xff,0x76,0xa2,0x27,0x32,0x06,0x30,0x47,0x13,
+	0xff,0x19,0x26,0x34,0x16,0xa2,0x27,0x58,0x5a,0xed,0xaa,0x71,0x00,0xa8,0x0a,0x04,
+	0x00,0x98,0x0a,0x80,0xfd,0x99,0x48,0x05,0x99,0x0a,0x4e,0x44,0x15,0xa0,0xef,0x80,
+	0x00,0x60,0x22,0x4b,0x10,0x2e,0xb2,0x3a,0xbb,0x00,0x47,0x9c,0x01,0x25,0xf1,0xff,
+	0xf3,0x08,0x2e,0xf7,0xa2,0x3b,0x01,0xac,0x05,0x25,0xf0,0xff,0x2d,0xb5,0x0a,0x23,
+	0x14,0xa2,0xc0,0x0d,0xe5,0xee,0x13,0x1c,0xad,0x7f,0x02,0x21,0x47,0xf0,0x82,0x22,
+	0x36,0x2f,0x01,0x9f,0x82,0x22,0x2c,0x2d,0x0a,0x07,0x00,0x3f,0x00,0x61,0xff,0x00,
+	0x81,0xba,0xf0,0x82,0x18,0x00,0x8e,0xfb,0x61,0x0a,0x1d,0x01,0x81,0x1b,0x65,0xfd,
+	0xff,0xff,0x41,0x3e,0xf0,0x5e,0x22,0xbc,0x1e,0x87,0xff,0x1f,0xc1,0x1b,0x21,0x42,
+	0xf0,0x22,0x02,0xff,0x0b,0x0c,0xd9,0x27,0x39,0x42,0x26,0x82,0xef,0x3f,0x82,0x24,
+	0x3c,0x7d,0x05,0x08,0x00,0x1a,0xff,0xb2,0xb2,0x0b,0x00,0xa1,0xa6,0xf0,0xb0,0xfb,
+	0xb0,0x24,0x42,0x05,0x2a,0x10,0xc0,0x99,0x10,0xdd,0xb0,0xce,0x09,0x9e,0x7a,0x02,
+	0x8c,0x00,0x81,0x1b,0xff,0xa1,0x44,0xf0,0xbd,0x03,0x82,0x24,0x3e,0x3f,0xa0,0xa2,
+	0xa0,0xa2,0x2a,0x64,0xa2,0x05,0xd1,0x03,0xfc,0xa6,0x05,0x23,0x0f,0xc1,0x63,0xf0,
+	0x9e,0x69,0x0f,0xf9,0x08,0x0a,0x05,0x34,0x00,0xe2,0x2c,0x80,0xf0,0xee,0x7e,0x3d,
+	0x04,0xe2,0x6c,0x80,0xd2,0xaf,0xbf,0x3d,0x06,0xf7,0x2c,0x88,0xd0,0x46,0x0e,0x6c,
+	0x88,0xa1,0x3c,0x7d,0xf0,0x08,0x00,0x82,0x29,0x90,0xa0,0x88,0x11,0x04,0xf7,0xae,
+	0x03,0x0b,0xc5,0x02,0xa1,0x1b,0xce,0x00,0xdd,0x0d,0x74,0x0a,0x8e,0x79,0x0e,0xea,
+	0x00,0x91,0x1b,0xf7,0xe5,0x7f,0xfc,0x13,0x0f,0x81,0x15,0xf0,0x82,0xff,0x08,0x09,
+	0x66,0x18,0x5e,0xa1,0x85,0xf0,0xdf,0xb1,0x30,0xf0,0xe1,0x7c,0x3e,0x04,0x92,0x2b,
+	0xfb,0x86,0xa0,0x6f,0x0e,0x6b,0x86,0x0c,0xc8,0x86,0xfe,0x85,0x00,0x00,0x00,0x82,
+	0xc8,0xfc,0x56,0x98,0xf7,0xff,0x7c,0x8f,0x15,0x00,0xd2,0x2e,0x10,0xf0,0x7d,0xdd,
+	0x5d,0x04,0xd2,0x6e,0x10,0xc1,0x78,0x30,0x04,0xdf,0xa2,0x2b,0x86,0xc0,0xaa,0x11,
+	0x04,0x91,0x75,0xdf,0xf0,0xa2,0x6b,0x86,0x06,0x2f,0x00,0x92,0xc9,0xff,0xfc,0x56,
+	0x99,0xff,0x81,0xf6,0xef,0x82,0xf3,0x28,0x3d,0x3c,0x09,0xcb,0x04,0x81,0x00,0x41,
+	0x09,0xff,0xf0,0x31,0xf4,0xef,0xae,0x44,0x08,0x02,0xbd,0x27,0xf2,0x03,0x27,0xb8,
+	0x03,0x0c,0xa9,0x01,0x98,0xef,0x43,0x2e,0x09,0xbb,0x6d,0x0b,0xb7,0x12,0x03,0xfe,
+	0xfb,0x04,0x81,0xec,0xef,0x88,0xe8,0xa9,0x01,0xfe,0x37,0x00,0xa9,0x21,0x66,0x32,
+	0x04,0x0c,0x0a,0xff,0xa5,0x70,0xfc,0x78,0x43,0xb1,0xf7,0xef,0xff,0x51,0xe2,0xef,
+	0x92,0x24,0x60,0x99,0x31,0xff,0xa2,0x25,0x61,0x25,0xa5,0x04,0x62,0x14,0xef,0xe6,
+	0xae,0x8a,0x3a,0xcf,0x09,0x80,0x66,0x82,0xff,0x25,0xe1,0xff,0xc8,0x31,0xd0,0xe2,
+	0x11,0xff,0xc0,0x77,0xb0,0xb8,0x17,0xc0,0xc2,0xb0,0xff,0xc9,0x51,0xc8,0x1c,0xe9,
+	0x41,0xb0,0xb0,0xff,0x34,0xc0,0xc0,0x34,0xc7,0xab,0x58,0x25,0xff,0xcd,0xff,0xd1,
+	0xeb,0xef,0xd2,0x0d,0x23,0xff,0xec,0x2d,0xdd,0x06,0x82,0x25,0x35,0xc8,0xff,0x51,
+	0xf2,0x24,0x63,0xb2,0x07,0x04,0xc2,0xff,0x0c,0x04,0xf0,0xe8,0x34,0xb0,0xb4,0x41,
+	0xff,0xf0,0xfc,0x34,0xce,0xc4,0xda,0x01,0xc7,0xfc,0xca,0x0f,0x23,0x1c,0xb8,0x17,
+	0xc8,0x1c,0xf0,0xe0,0xfd,0x34,0x48,0x00,0xf0,0xf4,0x34,0xce,0xc0,0x6a,0xef,0x00,
+	0xe7,0x00,0x49,0x21,0x04,0xad,0x02,0xa5,0xff,0xba,0xff,0x06,0x1b,0x00,0xb7,0xac,
+	0x64,0xff,0xad,0x02,0x25,0xba,0xff,0x25,0xc7,0xff,0xf6,0x34,0x08,0xa9,0x11,0x36,
+	0x68,0x81,0xc9,0xef,0x82,0xef,0x08,0x23,0xec,0x28,0x84,0x84,0xd8,0x11,0x66,0x7b,
+	0x1d,0x0c,0x5c,0x00,0xb4,0xff,0x06,0x01,0x6f,0x04,0xfb,0xb3,0xff,0x0a,0x01,0xd2,
+	0xff,0xe8,0x43,0x66,0xff,0x3e,0x07,0x0c,0x1a,0x65,0x5f,0xfc,0x25,0xff,0x55,0xfc,
+	0x29,0x43,0x20,0xa0,0x74,0x25,0xdf,0x80,0xff,0x5e,0x62,0x57,0xda,0x01,0xc1,0x1b,
+	0xff,0xb1,0x15,0xf0,0xa2,0x25,0x60,0x72,0x43,0xff,0x07,0xba,0xaa,0xa2,0x0a,0x00,
+	0xe5,0xd0,0xff,0xff,0xc8,0x41,0xb2,0x24,0x60,0xca,0xbb,0xff,0xb8,0x0b,0x61,0x09,
+	0xf0,0xa1,0x0f,0xf0,0xff,0x5e,0x4b,0x0d,0x00,0x47,0x1c,0x55,0x1b,0xff,0xda,0xdb,
+	0x88,0x1b,0x80,0xf0,0x34,0x60,0xef,0xef,0xa0,0xe8,0x0e,0xb9,0x01,0xc8,0x0b,0x98,
+	0x7f,0x0e,0x47,0x68,0x05,0x90,0xcc,0x20,0xef,0x01,0xff,0x90,0xcc,0x10,0x82,0x03,
+	0xf4,0x9d,0x0c,0xff,0x66,0x18,0x07,0xa0,0x8c,0x20,0xf0,0xc8,0xf7,0x83,0x9d,0x0c,
+	0x5c,0x07,0x0e,0xc2,0x2d,0x80,0xff,0x8b,0xbb,0x5e,0x0c,0x5d,0xa2,0x01,0x00,0xdf,
+	0x78,0x22,0x66,0x62,0x04,0x83,0x00,0xcd,0xff,0xff,0x88,0x01,0x68,0x41,0x8a,0x66,
+	0xd8,0x16,0xff,0x07,0xfd,0x02,0x66,0x22,0x10,0xa8,0x93,0xcf,0x88,0x3a,0x0c,0xcb,
+	0x6f,0x16,0xc3,0x00,0x66,0x62,0xff,0x02,0xe5,0x72,0xfc,0x98,0x16,0xa2,0x03,0xff,
+	0x04,0x90,0x90,0x05,0x16,0x89,0x0f,0x66,0xdf,0x1a,0x10,0x82,0x25,0x31,0x99,0x02,
+	0x00,0x47,0xae,0x21,0x0c,0x72,0x43,0x04,0x35,0x08,0x3b,0x35,0x20,0x56,0xff,0xb2,
+	0x09,0x0c,0x0a,0x25,0x51,0xfc,0x25,0xdf,0xbf,0xff,0x91,0x8a,0xef,0x7c,0x00,0x72,
+	0x69,0xef,0x91,0x82,0x25,0x2c,0x19,0x00,0xc1,0x98,0xef,0xff,0x21,0x7c,0xef,0xb2,
+	0x24,0x63,0x81,0xde,0xff,0xef,0x91,0xdc,0xef,0xb0,0xf4,0x34,0xb0,0xff,0xd8,0x34,
+	0xb0,0xec,0x41,0x80,0xee,0x11,0xff,0x40,0xdd,0x11,0x90,0xdd,0x10,0x80,0xee,0xfd,
+	0x10,0x74,0x01,0x0e,0xbb,0xf8,0x1e,0x07,0x00,0xff,0xad,0x1b,0x80,0xbb,0x10,0xe0,
+	0xdd,0x20,0xdf,0xf0,0xbb,0x20,0xd0,0xbb,0xd1,0x06,0xa2,0x22,0xed,0x7b,0xa9,0x02,
+	0xb0,0xaa,0x0b,0x08,0x62,0x7b,0xae,0xff,0x34,0x6b,0x0c,0x47,0x00,0x9d,0x1b,0x65,
+	0xff,0x80,0x04,0xb1,0xcb,0xef,0x50,0xaa,0x01,0xdf,0xb0,0xaa,0x10,0xb1,0xca,0x6f,
+	0x04,0x92,0x22,0xef,0x7c,0xb0,0x99,0x10,0x06,0x13,0x62,0x7c,0x11,0xff,0xc7,0xef,
+	0x82,0x25,0x30,0xa1,0xc4,0xef,0xfe,0x81,0x00,0x06,0x0d,0x00,0x98,0x43,0x26,0x19,
+	0xff,0x02,0x66,0x39,0x02,0x25,0xb5,0xff,0x82,0xbd,0x25,0xdf,0x06,0xce,0x43,0x4d,
+	0x01,0xc0,0x06,0xd2,0xff,0x43,0x05,0xae,0x7e,0xfb,0x01,0xe7,0x00,0xff,0x1d,0x1b,
+	0xce,0x4c,0xd9,0x01,0x67,0x01,0xdf,0x7d,0x1b,0xc0,0x9b,0x83,0x43,0x04,0x6a,0x86,
+	0x7f,0x81,0x37,0xef,0x88,0xf8,0xa8,0x21,0x41,0x04,0xfb,0x46,0xff,0x7b,0x03,0xe1,
+	0xa9,0xef,0xa1,0xb2,0x7f,0xef,0xb1,0x52,0xef,0xce,0x72,0xfd,0xf7,0x00,0x9c,0xdd,
+	0x0b,0x7a,0x03,0xe0,0x99,0x10,0x7a,0x0f,0x61,0x07,0x6c,0x7e,0x05,0x04,0x82,0x2b,
+	0x86,0xb7,0xf8,0x08,0x08,0x00,0xff,0xf2,0x2b,0x86,0xa7,0x0f,0xf6,0xf1,0x43,0xf7,
+	0xef,0xa1,0x20,0xa3,0x04,0xe2,0x2c,0x90,0xf0,0xfd,0xee,0x2c,0x04,0xb1,0x1f,0xef,
+	0xe2,0x6c,0x90,0xff,0x82,0x2a,0x23,0xa2,0x2a,0x6e,0xd2,0x4b,0xfd,0x05,0x6f,0x1b,
+	0x61,0x00,0x81,0x16,0xef,0x21,0xfd,0x18,0x83,0x03,0x52,0x92,0x02,0x05,0x56,0x48,
+	0xdf,0x06,0x8c,0x19,0x65,0xf8,0x43,0x02,0x3e,0x17,0xfd,0xfb,0xad,0x00,0x1d,0x1b,
+	0x1e,0xc1,0x3f,0x01,0x7d,0x27,0x6a,0x02,0xfe,0x71,0x0e,0x00,0x27,0xbd,0x00,0xf7,
+	0xee,0x83,0x8d,0x94,0x01,0x81,0x1b,0x65,0x22,0xef,0x03,0x1e,0xc1,0x3a,0x4e,0x02,
+	0xa5,0x1b,0x8e,0xfb,0x53,0x0b,0x60,0x03,0x85,0x1b,0x8e,0x71,0x0d,0xfe,0x1a,0x08,
+	0xa5,0x20,0x03,0x0c,0x3a,0xbe,0x0f,0xdd,0x0c,0xa8,0x09,0xde,0x00,0x0e,0x07,0x08,
+	0xe5,0x3a,0xff,0xfc,0xa1,0xfd,0xee,0x0c,0x19,0x92,0x42,0xef,0x06,0x92,0x6a,0x12,
+	0x7b,0x0c,0x41,0x00,0x8c,0xff,0xd2,0x26,0x22,0x0b,0x0e,0x12,0x1a,0x00,0xfd,0x27,
+	0x96,0x02,0x0c,0x72,0x1d,0xf0,0x0c,0x6a,0xff,0xe5,0xbf,0xff,0x2d,0x0a,0x1d,0xf0,
+	0x46,0x7d,0xfd,0xff,0x04,0x0c,0x98,0x8e,0xa3,0x02,0x3f,0x00,0xff,0x65,0x1b,0x1d,
+	0xf0,0xa8,0x14,0xa5,0xa8,0xff,0xff,0x91,0x17,0xef,0x0c,0x18,0x9e,0x9a,0xfd,0x52,
+	0x78,0x08,0x90,0x28,0x83,0xf0,0x22,0x11,0xde,0x19,0x00,0x04,0x0e,0xea,0xf2,0x9d,
+	0x00,0x55,0x1b,0xfe,0xd3,0x14,0xb1,0x66,0xef,0x21,0xf7,0xee,0x91,0xff,0x66,0xef,
+	0xd1,0x65,0xef,0xa2,0x22,0x60,0xdf,0xce,0x65,0xfe,0x01,0xc7,0xcc,0x00,0xe9,0x01,
+	0xff,0xc9,0x4a,0xd2,0x6a,0x00,0x9e,0x7a,0xc8,0x7d,0x01,0xa8,0x04,0xde,0x7a,0x69,
+	0x01,0xa7,0x07,0x00,0xff,0x76,0xa8,0x0d,0xa0,0xc9,0xb0,0xbe,0x7c,0xff,0x09,0x20,
+	0x21,0x00,0x80,0x22,0x90,0x90,0xff,0x74,0x91,0x5a,0xef,0xd9,0x2a,0x92,0x6a,0xff,
+	0x10,0x31,0xe7,0xee,0xf1,0x13,0xef,0xce,0xdf,0x58,0xf8,0x1e,0xe7,0x1e,0x7b,0x09,
+	0xe2,0x2f,0xfb,0x8b,0x80,0x4e,0x09,0xe2,0x6f,0x8b,0xd2,0x03,0xff,0x22,0xd0,0xd0,
+	0x24,0x2e,0xdd,0xfe,0x1d,0xf7,0x27,0x1e,0xad,0x1c,0x04,0xb8,0x4c,0xe0,0xbb,0xfd,
+	0x10,0x43,0x0e,0xb9,0x4c,0x91,0x3d,0xef,0xa1,0xfb,0xe5,0xee,0x0a,0x00,0x81,0x49,
+	0xef,0x92,0x6a,0xef,0x80,0xbe,0x00,0x1a,0xb7,0x16,0xa2,0x22,0x72,0xff,0x25,0x9c,
+	0xff,0xa2,0x03,0x23,0x9c,0xea,0xff,0x0c,0x4a,0xe5,0x98,0xff,0x81,0xd0,0xee,0x77,
+	0x1e,0xb1,0x3a,0xcf,0x0b,0xce,0x03,0x0d,0xc6,0x00,0xfe,0x25,0x08,0x0c,0x4a,0xa5,
+	0x98,0xff,0x0c,0x02,0xec,0xd0,0x04,0x07,0x01,0xae,0x08,0x0a,0x0f,0xa5,0x14,0xfc,
+	0x7f,0x2d,0x0a,0xbe,0x36,0xfc,0x00,0x87,0xcd,0x00,0xff,0x25,0x16,0xfc,0x81,0xa7,
+	0xee,0x82,0x28,0x4f,0x46,0x22,0x68,0x26,0x27,0x08,0xcb,0x01,0xe9,0x0f,0x00,0xff,
+	0x6b,0x22,0x22,0x13,0xd1,0xcf,0xee,0x5e,0xff,0x18,0xbc,0x01,0xa7,0x01,0xc9,0x1b,
+	0x92,0xff,0x03,0x41,0x41,0xa4,0xee,0x77,0x69,0x4d,0xff,0xa2,0x04,0x0b,0x26,0x8a,
+	0x47,0x31,0x9a,0xbf,0xee,0x0c,0x0b,0xbe,0x73,0xfa,0x68,0x00,0x8d,0xff,0x1b,0x25,
+	0x35,0xfc,0xc1,0x23,0xef,0xa2,0xdf,0x23,0x49,0xbe,0x54,0xb9,0xde,0x09,0x99,0x01,
+	0xff,0xa2,0x2a,0x10,0xca,0xbb,0xcd,0x01,0x88,0xef,0x3a,0xbe,0x5b,0x0d,0x66,0x00,
+	0x81,0x1b,0xbe,0xeb,0x71,0x1b,0xba,0x00,0x81,0x94,0x08,0x1b,0xbe,0x72,0x7d,0xb2,
+	0x0c,0x08,0x1d,0xf0,0xce,0x8d,0xd2,0xce,0x0a,0xff,0x1d,0xf0,0x36,0xa1,0x00,0x91,
+	0xb3,0xee,0xff,0x62,0xd9,0xff,0x82,0x26,0x11,0x42,0x22,0xbf,0x13,0x0e,0x18,0x4a,
+	0x01,0xe7,0xce,0x01,0xa8,0xff,0xd4,0xe1,0x7f,0xee,0x66,0x2a,0x15,0xc2,0xff,0x02,
+	0x3f,0x66,0x1c,0x0f,0x1c,0x1a,0xd1,0xff,0xaa,0xee,0xa2,0x4d,0x0d,0xde,0x0f,0x05,
+	0xfe,0x36,0x00,0x41,0x1b,0xe2,0x2e,0x6f,0xe9,0x81,0xff,0x9c,0x0e,0x26,0x5e,0x0e,
+	0xad,0x02,0xbd,0xff,0x03,0x65,0xf4,0xff,0x5d,0x0a,0x66,0x1a,0xff,0x02,0x46,0x30,
+	0x00,0xa2,0x03,0x43,0xce,0xef,0x1a,0x08,0x04,0xc7,0xed,0x00,0x8e,0x0a,0xab,0xff,
+	0x05,0xa7,0x01,0x81,0x1b,0x92,0x02,0x3c,0xff,0x26,0x59,0x0f,0x0c,0x59,0xa1,0x99,
+	0xee,0xdf,0x92,0x4a,0x0d,0x9e,0x05,0x41,0x0c,0xc7,0x1a,0xff,0x0a,0xbe,0xaa,0x7d,
+	0x03,0xa7,0x00,0x61,0xff,0x1b,0xd7,0x9a,0x04,0x0c,0x0a,0x65,0x28,0xff,0xfc,0xa2,
+	0x03,0x41,0xe1,0xa8,0xee,0x0e,0xfb,0x0a,0x47,0x8f,0x02,0x61,0x1b,0xfd,0x0e,0xf2,
+	0xff,0x2f,0x6d,0x66,0x1f,0x07,0xad,0x07,0xa5,0xfd,0x26,0x1a,0x04,0x4e,0x0a,0x8b,
+	0x00,0x67,0x00,0xff,0x6d,0x1b,0x92,0x26,0x10,0x90,0x93,0x24,0xff,0x26,0x19,0x5a,
+	0x26,0x49,0x57,0xae,0xf9,0xfd,0xf9,0x7b,0x02,0x45,0x1b,0xb1,0x83,0xee,0x0c,0xef,
+	0xda,0xae,0x8b,0xd5,0xd2,0x08,0xc2,0x06,0x0c,0xff,0x26,0x1c,0x05,0xd2,0x04,0x26,
+	0x66,0x1d,0xff,0x2a,0xe2,0x26,0x40,0xf8,0x71,0xf9,0x41,0xff,0xdc,0x5e,0xa1,0x4c,
+	0xee,0xa2,0x2a,0x49,0xff,0xa8,0xaa,0x88,0x3a,0x0c,0x2b,0xde,0x00,0xbf,0x0c,0x24,
+	0x00,0x00,0xa0,0x22,0x12,0x01,0xae,0xf9,0x02,0xfc,0x02,0xab,0x00,0x65,0x80,0xff,
+	0x8c,0x45,0xff,0xa2,0xc2,0x38,0xa5,0x69,0xfd,0x2d,0x05,0xff,0x1d,0xf0,0x51,0x87,
+	0xee,0x81,0x86,0xee,0xff,0x52,0x05,0x00,0xb9,0x71,0x82,0x08,0x04,0xff,0x8c,0x95,
+	0xcc,0x78,0x92,0x03,0x43,0x92,0xff,0xc9,0xf8,0x16,0x19,0x1f,0x37,0x6a,0x25,0xff,
+	0xb1,0x50,0xee,0xc8,0xd4,0xa2,0x0b,0x90,0xff,0xae,0x71,0x5c,0x9e,0xe1,0x02,0x80,
+	0x22,0xff,0x56,0x0c,0x1b,0xd2,0x02,0x40,0xd7,0x3a,0xff,0x04,0x0b,0xe5,0x56,0x6e,
+	0x24,0xce,0x14,0xfd,0x09,0xe0,0x08,0xf2,0x03,0x43,0x66,0x8f,0x19,0xff,0x88,0xd4,
+	0x66,0x28,0x07,0x0e,0xf2,0xf9,0xfb,0x03,0x07,0xa6,0x00,0xbe,0x52,0x0a,0x00,0x07,
+	0xff,0x02,0x89,0x1b,0x65,0x32,0x04,0xa9,0xa6,0xff,0x92,0x03,0x01,0x90,0x90,0x34,
+	0x66,0x19,0xed,0x0c,0x41,0x09,0xa0,0xfd,0x0f,0x0c,0x26,0x39,0x02,0xb7,0x66,0x49,
+	0x06,0x12,0x08,0xa8,0xfd,0xf5,0x00,0xb1,0xff,0x4d,0xee,0x77,0x6a,0x14,0xcd,0x0b,
+	0xc2,0xff,0x0c,0x8e,0x8c,0xcc,0xbe,0xdb,0x3e,0x00,0x7e,0x68,0x06,0xe2,0x44,0x24,
+	0x72,0x4d,0x74,0x6a,0x01,0xff,0xf2,0xca,0xd1,0x16,0x1f,0x11,0x82,0xca,0xff,0xd0,
+	0x16,0xb8,0x10,0xb2,0xca,0xcf,0x16,0xff,0x5b,0x10,0xc2,0xca,0xce,0x16,0xfc,0x0f,
+	0xff,0xd2,0xca,0xf9,0x16,0x9d,0x0f,0xe2,0xca,0xff,0xca,0x16,0x3e,0x0f,0xa2,0x06,
+	0xf4,0x66,0xff,0x1a,0x12,0xa2,0x04,0x24,0xbe,0x44,0x8c,0xfe,0x1f,0x09,0x65,0x02,
+	0x03,0x5d,0x0a,0x56,0x0a,0xff,0xf1,0xf2,0x03,0x41,0x81,0x0e,0xee,0x17,0xff,0x6f,
+	0x5c,0xad,0x08,0xa2,0x0a,0x0b,0x72,0xdf,0x46,0x0c,0xce,0x42,0x39,0xc7,0x02,0x81,
+	0x1b,0xff,0xa7,0x39,0x05,0xb2,0xca,0xf8,0x56,0xab,0xef,0x10,0x3e,0x0b,0x0a,0xca,
+	0x08,0x1e,0xc1,0x3d,0xbb,0x00,0x87,0x77,0x00,0x8e,0x4a,0x3b,0x66,0x0a,0xbe,0xef,
+	0x71,0x09,0x22,0x00,0x6b,0x03,0x9e,0x71,0x1b,0x7d,0x01,0x5b,0x12,0xad,0x05,0xbe,
+	0x41,0x2c,0x5b,0x0a,0xff,0x65,0xfc,0x02,0xcc,0x3a,0xc8,0x61,0x52,0xfb,0x4c,0x24,
+	0x65,0x00,0x8a,0xea,0xd1,0x34,0xee,0xbf,0xd2,0x2d,0x6a,0x5e,0x1d,0xd5,0xf3,0x03,
+	0xc1,0xff,0x1b,0xe2,0x03,0x43,0x2c,0x9f,0xf7,0x9e,0xff,0x10,0x81,0xe8,0xed,0x72,
+	0x66,0x1a,0x5e,0xef,0x78,0xda,0x07,0xe7,0xc7,0x02,0xa5,0xfe,0xfe,0xfe,0xea,0x00,
+	0x57,0x6a,0x08,0x72,0x46,0x09,0x52,0xfb,0x42,0x40,0x0b,0x00,0x92,0x06,0x0a,0xbd,
+	0x03,0xff,0xa0,0xa6,0x04,0xa0,0x97,0x93,0x92,0x46,0xbf,0x0a,0xad,0x02,0xe5,0x78,
+	0xfd,0x4d,0x00,0xca,0x3f,0xe5,0x81,0x68,0xee,0x88,0x08,0x1d,0x05,0x72,0x00,0xff,
+	0x5d,0x0a,0x16,0x0a,0x0e,0x91,0x05,0xee,0xff,0x92,0x09,0x8d,0xa1,0x03,0xee,0x1c,
+	0x0b,0xf7,0x90,0x9b,0x83,0x5f,0x02,0x46,0x8d,0xff,0x00,0xff,0x00,0xc1,0x00,0xee,
+	0x0c,0xdd,0xde,0x84,0xfd,0x4a,0x9d,0x00,0x85,0x1b,0xa2,0x4c,0x74,0xb2,0xff,0x03,
+	0x43,0xb2,0xcb,0xf9,0x16,0x5b,0xef,0xff,0xe1,0xf8,0xed,0x72,0x4e,0x18,0x06,0xbb,
+	0xff,0xff,0xae,0x4b,0x2b,0x1c,0x87,0x06,0x85,0xff,0x1b,0xe5,0x1e,0x04,0xf8,0x51,
+	0x88,0xc4,0xff,0xa0,0xff,0x82,0x87,0x3f,0x02,0x66,0x15,0xf7,0x07,0x0e,0x06,0xbd,
+	0x0d,0x0c,0x09,0x0b,0x89,0xff,0x56,0xa8,0xe3,0x0c,0xc9,0x99,0x71,0x98,0xff,0x71,
+	0x86,0x50,0xff,0xa1,0xbc,0xed,0xa2,0xff,0x2a,0x6d,0xce,0x5a,0x0d,0x1f,0xe7,0x00,
+	0xff,0x55,0x1b,0xb2,0x26,0x40,0x26,0x1b,0x51,0xbf,0xe1,0xb7,0xed,0xde,0x5d,0x3b,
+	0xd7,0x00,0xa5,0xef,0x1b,0xee,0x4e,0x9f,0xe1,0x03,0x89,0x1b,0x76,0xff,0xaf,0x30,
+	0x30,0x9b,0xa0,0x98,0x09,0x26,0xff,0x09,0x28,0x90,0x98,0x34,0x3e,0x19,0xfb,0xff,
+	0x60,0x21,0x01,0xc0,0x22,0xe6,0x59,0x17,0xff,0xe0,0xa9,0xa0,0xa8,0xfa,0x66,0x19,
+	0x07,0x9f,0x0e,0x0c,0x05,0x00,0xc7,0x5f,0x00,0xe7,0x09,0x01,0xff,0x0c,0xd5,0xb0,
+	0xb0,0x74,0xc9,0x61,0xd0,0xff,0xe5,0xc0,0x56,0x9e,0xe9,0x86,0x00,0x00,0xbf,0xd2,
+	0x4c,0x24,0xce,0xe7,0xfa,0x51,0x00,0x45,0xef,0x1b,0x7e,0xfd,0xf9,0x07,0x08,0xf2,
+	0x06,0x09,0xff,0x91,0x9d,0xed,0x88,0x81,0x8e,0x79,0xff,0xff,0xfe,0xe1,0x02,0x8c,
+	0x22,0x56,0xef,0xd1,0xfe,0xf8,0x01,0x66,0x4a,0x26,0xb1,0x27,0xee,0x32,0xff,0x02,
+	0x3c,0xba,0x33,0x32,0x03,0x00,0x46,0xff,0x00,0x00,0x0c,0xf3,0x82,0xc3,0xee,0x16,
+	0xff,0x58,0xcf,0x92,0x26,0x1a,0x66,0x19,0x20,0xff,0xa2,0x06,0x0d,0x56,0x6a,0xcf,
+	0x79,0xa4,0xff,0x46,0x3c,0xff,0x2c,0xbb,0xb7,0x9a,0x05,0xff,0xb1,0x1d,0xee,0x06,
+	0xf4,0xff,0x2c,0xcc,0xff,0xc7,0x1a,0xd6,0xb1,0x1b,0xee,0x46,0xf1,0x7f,0xff,0xe1,
+	0x8f,0xed,0xae,0x00,0x0b,0xaf,0x01,0xff,0xa1,0x1b,0xee,0x5e,0x0c,0x22,0x80,0x01,
+	0xdf,0x84,0x22,0xee,0x71,0x3d,0xc2,0x00,0x81,0x1b,0xff,0xa5,0xc0,0x02,0x81,0x81,
+	0xed,0x3e,0xa3,0xfd,0x3f,0xd8,0x08,0xf2,0x68,0x70,0xa5,0x62,0xff,0xff,0x91,0x7d,
+	0xed,0x72,0x69,0x70,0xc6,0x28,0xfe,0x5a,0x01,0x00,0x36,0x61,0x00,0x91,0x79,0xed,
+	0xff,0xa1,0x7b,0xed,0x42,0x22,0x13,0xb2,0x29,0xbf,0x49,0x8e,0x53,0x1e,0x01,0xc7,
+	0xf9,0x00,0xfe,0xef,0x49,0xdc,0x01,0x67,0xcb,0x01,0x2e,0x4b,0xad,0xfe,0xa6,0x03,
+	0x81,0x1b,0x1e,0x08,0x6b,0x01,0x47,0xff,0x01,0x69,0x1b,0x1e,0x1f,0x09,0x1f,0xe7,
+	0xff,0x01,0x59,0x1b,0x82,0x0a,0x0c,0x66,0x18,0xff,0x06,0x0c,0x49,0x99,0x01,0x86,
+	0x02,0x00,0xfb,0xb9,0x01,0x8f,0x02,0x97,0x1a,0x02,0xe7,0x1a,0x7f,0x58,0xc9,0x11,
+	0x88,0x32,0x2e,0xa2,0x57,0x02,0xae,0x6c,0x00,0xce,0x41,0x4d,0x92,0x00,0x61,0x4f,
+	0x06,0x98,0x17,0xb4,0xdc,0x39,0x18,0x08,0x01,0x85,0x04,0x80,0x06,0x07,0x04,0xfe,
+	0x18,0x00,0x1d,0xf0,0x92,0x0a,0xf4,0x66,0x19,0xfd,0x0d,0x40,0x00,0xa2,0xca,0xf3,
+	0xa0,0xbd,0x83,0xdf,0xb9,0x01,0x46,0xee,0xff,0x57,0x02,0xee,0x4e,0xfd,0xed,0x2b,
+	0x00,0x75,0x1b,0xe0,0xdb,0x83,0xbd,0xff,0x0d,0xc6,0xf9,0xff,0x9d,0x0d,0x46,0xe4,
+	0xfe,0xaf,0x08,0x41,0x00,0x31,0x50,0xed,0x82,0x03,0xff,0x0c,0xfc,0x08,0x92,0x22,
+	0x13,0x92,0x09,0x3f,0x26,0xec,0x89,0x81,0xdb,0xed,0x45,0x06,0x4d,0x00,0xff,0x2d,
+	0x0a,0xdc,0xca,0x92,0x23,0x49,0x9c,0xff,0x79,0xb1,0x72,0xed,0x9e,0x29,0x3c,0x02,
+	0xf6,0x85,0x08,0x8b,0xda,0xc8,0x0a,0xa9,0x9b,0x1d,0xf0,0xef,0x0c,0x02,0x1d,0xf0,
+	0xf3,0x0c,0xa1,0x3f,0xed,0xdb,0xa8,0x9a,0x00,0x03,0x01,0xa7,0x1a,0x00,0xce,0x00,
+	0xf7,0x09,0x00,0x87,0x3b,0x01,0x9e,0x71,0x0d,0x00,0xfe,0x00,0x13,0xc1,0x72,0xed,
+	0xd2,0xaf,0xbf,0xc0,0xff,0x20,0x00,0xb2,0x2c,0x88,0xd0,0xbb,0x10,0xfe,0x08,0x04,
+	0x6c,0x88,0xe5,0x47,0xff,0xa1,0xbf,0xff,0xed,0xaa,0xa2,0x21,0x2d,0xed,0xae,0x5a,
+	0xfd,0x0e,0x2a,0x08,0xe2,0x62,0x70,0xa5,0x4d,0xff,0xdf,0x0c,0x1b,0xbe,0x72,0x0a,
+	0xf3,0x00,0x8d,0x1b,0xff,0xe5,0x38,0xff,0xa5,0xe1,0xfb,0xae,0x41,0x37,0x0b,0x0f,
+	0x87,0x7c,0x05,0xe6,0xfb,0x97,0x15,0xf3,0x04,0xfd,0x47,0x8e,0x00,0xa5,0xa7,0x02,
+	0xc1,0x24,0xed,0xdf,0xb8,0x01,0xb2,0x4c,0x30,0x8b,0x0c,0x41,0x00,0xff,0x21,0x19,
+	0xed,0x31,0x1b,0xed,0x22,0x22,0xff,0x46,0x91,0x43,0xed,0x82,0x23,0x18,0x2e,0xfb,
+	0x42,0x6a,0x86,0x0b,0xa2,0x43,0x0d,0x97,0x18,0xf7,0x11,0x88,0x72,0xdb,0x10,0xa2,
+	0x23,0x18,0xa5,0xff,0x42,0xfc,0x06,0x0a,0x00,0x42,0x02,0x43,0xbf,0x92,0xa0,0xff,
+	0x97,0x14,0x1f,0x1a,0x18,0xb8,0xdf,0x82,0x2e,0xa2,0x3c,0x08,0x5d,0x04,0x40,0xcc,
+	0xff,0xd1,0xca,0xbb,0xe5,0x9f,0xff,0xcc,0x1a,0xff,0x42,0x42,0x43,0x0c,0x0d,0xd2,
+	0x43,0x0d,0xfc,0x64,0x04,0xe3,0x05,0x00,0xed,0x32,0x29,0x46,0x51,0xff,0x01,0xed,
+	0x38,0x63,0x82,0x05,0x0c,0xae,0xfb,0x43,0x37,0xc5,0x01,0x81,0x1b,0x0e,0x18,0x22,
+	0xfe,0xc7,0x0b,0x82,0x0a,0x26,0x92,0x0a,0x25,0x66,0xff,0x18,0x02,0x77,0x19,0x01,
+	0x1d,0xf0,0x81,0xf9,0x87,0x4f,0x05,0x93,0x07,0x2d,0x0a,0x56,0xea,0xfe,0x7f,0x92,
+	0x25,0x49,0x9c,0x59,0xb1,0x1e,0x50,0x49,0xff,0x92,0x05,0x09,0x66,0x19,0xcc,0xa2,
+	0x03,0xef,0x4b,0x2e,0x8a,0x04,0x14,0x00,0x55,0x1b,0xc8,0xff,0xe3,0xc0,0xc4,0xa0,
+	0xe2,0x0c,0x03,0x66,0xff,0x1e,0x67,0xb2,0x03,0x42,0x0b,0xdb,0xd7,0xff,0x94,0x5f,
+	0xe2,0x05,0xec,0xc9,0x01,0x5e,0xfb,0x1e,0x46,0x6a,0x03,0xc9,0x1b,0x6e,0x45,0x4a,
+	0xfb,0x01,0xe7,0x3c,0x00,0x65,0x3a,0xff,0xa1,0xdb,0xff,0xec,0xb1,0xee,0xec,0xa2,
+	0x2a,0x61,0xa5,0xff,0xe3,0x03,0xb2,0xa4,0x4c,0xb0,0xba,0x82,0xff,0xbe,0x4b,0x4c,
+	0x1e,0xc7,0x1e,0x61,0x1b,0xf7,0xc0,0xbb,0x10,0x03,0x03,0x00,0x00,0xb2,0xcb,0xff,
+	0xfc,0x56,0x9b,0xff,0x0c,0x0a,0x65,0xbe,0xbf,0xfb,0xad,0x06,0x25,0x37,0xff,0x51,
+	0x00,0xa8,0xff,0x01,0xa2,0x0a,0x00,0xe5,0x38,0x01,0x77,0x7f,0x16,0x04,0x0c,0x1a,
+	0xe5,0xbc,0xfb,0x7a,0x00,0xff,0x1b,0x44,0x40,0x40,0x74,0xa7,0x34,0x84,0xfe,0x8b,
+	0x00,0x16,0x09,0xf4,0x41,0xca,0xec,0x88,0xfd,0xe4,0xba,0x00,0x92,0x25,0x19,0xb8,
+	0xf4,0xcc,0xbf,0xc9,0xe0,0x0b,0x00,0x88,0x73,0xcd,0x10,0x1d,0x7d,0xf0,0x0d,0x00,
+	0x0c,0x3a,0xbe,0x12,0x0c,0x91,0x09,0xfb,0xde,0x00,0xc2,0x05,0xa1,0x1b,0xe5,0xaf,
+	0xfb,0xec,0x24,0x01,0x87,0x01,0xa1,0xb7,0x8d,0x00,0x46,0xa8,0x6a,0xff,0x22,0x2a,
+	0x13,0x88,0xa2,0x9c,0x38,0x1c,0xef,0x4b,0xce,0x5a,0xcd,0x1e,0x01,0x85,0x1b,0xee,
+	0xef,0x00,0x0a,0x01,0x27,0x29,0x00,0x25,0xad,0xfb,0xef,0x0c,0x0b,0xb9,0xa2,0xb7,
+	0x15,0x61,0xab,0xec,0xff,0x62,0x26,0x46,0x62,0x26,0x12,0x82,0x26,0xff,0x3a,0xbd,
+	0x03,0x37,0xf8,0x02,0x56,0xf5,0xfe,0x0a,0x00,0x31,0x91,0xeb,0xec,0xae,0x46,0xbd,
+	0xfc,0x38,0x00,0x58,0x02,0x08,0x07,0xca,0x80,0x01,0x58,0xf7,0x22,0x0e,0x0a,0x07,
+	0x00,0x00,0x40,0x22,0x92,0xff,0x09,0x00,0x90,0x27,0x83,0xae,0x4a,0x0c,0xff,0xd6,
+	0x80,0x00,0x54,0x22,0xa8,0x22,0x27,0xff,0x9c,0x05,0xe2,0x26,0x46,0xa7,0x1e,0x0d,
+	0xef,0x2e,0x07,0x43,0xda,0xb5,0x07,0xf2,0x26,0x45,0xff,0xa7,0x9f,0x29,0x92,0x26,
+	0x1c,0x82,0x26,0xff,0x1d,0x32,0xc6,0x6c,0x2d,0x03,0x97,0xb8,0xff,0x02,0x46,0x3a,
+	0x00,0xe2,0x26,0x32,0xa2,0xff,0x26,0x31,0xde,0x76,0xde,0xc0,0x21,0x01,0xff,0x80,
+	0x22,0xe2,0x66,0x32,0x56,0x7a,0x0c,0xff,0x2d,0x0c,0x06,0x34,0x00,0xc6,0x01,0x00,
+	0xff,0xae,0x42,0x23,0xda,0x80,0x00,0x80,0x22,0xff,0xf8,0x12,0x4a,0x8a,0x87,0xbf,
+	0x01,0x4d,0xff,0x0d,0x98,0x02,0xcd,0x04,0xaa,0xa9,0x25,0xdf,0x8d,0xfb,0x2e,0xa7,
+	0x9b,0xe0,0x00,0x65,0x1b,0xff,0xa8,0x22,0xc2,0xd6,0x01,0x4a,0xaa,0xae,0xff,0x72,
+	0x2c,0x82,0x81,0x02,0x80,0x22,0xc7,0xff,0x92,0x12,0xc8,0x12,0xc7,0x3a,0x0d,0xd2,
+	0x7f,0x26,0x47,0xbe,0x72,0x2d,0xa0,0x21,0x3b,0x00,0xff,0xd2,0x66,0x47,0x27,0x13,
+	0x68,0xa8,0xd6,0xff,0xe8,0xc6,0x66,0x15,0x03,0x4a,0xaa,0xa9,0xff,0xd6,0xe7,0x3a,
+	0x22,0x92,0x26,0x31,0x0c,0xbf,0x0a,0x5e,0x19,0x08,0x20,0x21,0xc0,0x00,0xc2,0xff,
+	0x26,0x3a,0x07,0xfc,0x0a,0x87,0xfc,0x07,0xff,0xf2,0x26,0x34,0x1b,0xff,0xf2,0x66,
+	0x34,0xff,0xb9,0xd6,0x82,0x66,0x31,0x66,0x15,0x3f,0xfe,0x18,0x00,0x87,0x7c,0x17,
+	0x92,0x26,0x3f,0xa7,0xff,0x99,0x11,0xd2,0x26,0x31,0xb2,0x26,0x43,0xff,0xd7,0xbb,
+	0x08,0xe1,0xf8,0xec,0xe0,0xcc,0xf7,0x10,0xc2,0x66,0x33,0x00,0x3d,0xf2,0x26,0x31,
+	0xff,0xcc,0x6f,0x81,0x63,0xec,0x82,0x08,0x03,0x7f,0xec,0xf8,0x87,0xfc,0x2d,0xa9,
+	0xe6,0x35,0x02,0xfe,0x4d,0x00,0xf9,0x19,0xa2,0x26,0x32,0x9c,0x3a,0xdf,0x1d,0xf0,
+	0xe1,0xed,0xec,0x44,0x00,0x2d,0x07,0xbe,0x31,0x0c,0xa8,0x22,0x06,0xcd,0xff,0x64,
+	0x14,0x1d,0xff,0xf0,0xad,0x04,0xb2,0x26,0x35,0xa5,0xc1,0x7f,0x03,0x82,0x26,0x34,
+	0xaa,0x88,0x82,0x11,0x04,0xfe,0x77,0x01,0xa2,0x02,0xbc,0x82,0xa0,0xff,0x87,0xff,
+	0x1a,0x11,0xc2,0x02,0xbd,0xdd,0x03,0x4e,0x7b,0xe4,0x3b,0x79,0x03,0xa5,0x1b,0x65,
+	0x93,0xc6,0x01,0xff,0x66,0x14,0x09,0x81,0x45,0xec,0x88,0xd8,0xfc,0xef,0x11,0xeb,
+	0x0f,0x51,0x41,0xec,0x61,0x43,0xec,0xff,0x71,0x43,0xec,0xb2,0x25,0x46,0x2e,0x92,
+	0xfd,0x3a,0xf9,0x02,0xa5,0x1b,0x3e,0xc3,0x38,0x5e,0xff,0xc0,0x03,0xa4,0x22,0x4e,
+	0x4b,0x23,0x01,0xbe,0xa9,0x05,0x6e,0xb8,0x02,0x10,0xc7,0xbf,0x02,0x0b,0xff,0xd9,
+	0x16,0x3d,0x12,0x66,0x49,0x21,0xe2,0xff,0x24,0x3b,0x9c,0xbe,0xf2,0x04,0xb5,0xa7,
+	0xef,0x9f,0x18,0x32,0x46,0x13,0x03,0x0c,0x04,0xcc,0xc7,0x54,0x88,0xd5,0x6d,0x0b,
+	0x06,0x00,0x5d,0x0c,0x88,0xe7,0xfe,0x67,0x06,0x24,0x3a,0x5d,0x0a,0x27,0x79,0x6f,
+	0xff,0x1e,0x39,0xcc,0x9e,0x80,0x00,0x6c,0x22,0xff,0xa2,0x24,0x20,0x92,0x24,0x22,
+	0x2a,0xd4,0xff,0xa7,0x39,0x01,0xcd,0x0d,0xb8,0x3c,0x28,0xff,0x0c,0xa2,0x14,0x52,
+	0x88,0x1c,0xba,0x22,0xff,0xb0,0xaa,0xa0,0xa9,0x3c,0xc7,0x9d,0x3a,0xff,0xb8,0x2c,
+	0xa7,0x98,0x0f,0x92,0x24,0x48,0xbf,0x0c,0x0a,0xae,0x7c,0x39,0x20,0x7c,0x05,0x92,
+	0xff,0x64,0x48,0xa7,0x9b,0x22,0xd2,0x24,0x48,0xff,0xc2,0x24,0x47,0xd7,0x9c,0x19,
+	0x81,0x35,0xff,0xec,0xf2,0x24,0x3a,0x80,0xff,0x20,0xf2,0xdf,0x64,0x3a,0xe2,0x06,
+	0x07,0x7d,0x00,0x66,0x1e,0xff,0x04,0x0c,0x9a,0x25,0x07,0xff,0xad,0x04,0xf7,0x2e,
+	0xb2,0x3c,0x57,0x02,0xa5,0x1b,0xa5,0xef,0xdf,0xff,0x88,0xf7,0xad,0x05,0x85,0x08,
+	0x92,0x24,0xff,0x3b,0x28,0x1c,0x3e,0x4c,0x29,0x3e,0xe1,0xee,0xdb,0x01,0x56,0x59,
+	0xf5,0x95,0x14,0xa9,0x11,0x17,0xff,0xf9,0x0b,0xa2,0x04,0xb5,0xb2,0xa0,0xff,0xff,
+	0xb0,0xaa,0xc0,0x56,0x3a,0x18,0x37,0x79,0xff,0x2f,0x3e,0xb3,0x3a,0x96,0x80,0x01,
+	0xa4,0xef,0x22,0xce,0x44,0x5d,0xf5,0x00,0x85,0x1b,0xa5,0xff,0xd3,0xff,0xc2,0x24,
+	0x3a,0x47,0xfc,0x16,0xff,0xd2,0x25,0x60,0x26,0x1d,0x10,0xa8,0x96,0x7f,0x88,0x3a,
+	0x0c,0x7b,0xce,0x00,0x0d,0x17,0x0b,0x3e,0x46,0x04,0x06,0x02,0x56,0x69,0x0c,0x77,
+	0x08,0x2f,0x00,0xff,0xa5,0x1b,0x25,0xe8,0xff,0xee,0x06,0x04,0xbf,0x01,0x07,0x00,
+	0x41,0x1b,0xa2,0x76,0x04,0x38,0x7f,0x2c,0x66,0x1a,0x16,0xc2,0x14,0x52,0x6e,0x00,
+	0xff,0xe0,0xcc,0x11,0xc9,0x31,0x67,0x79,0x56,0xff,0xd1,0x60,0xec,0xd0,0xd9,0x10,
+	0xd2,0x64,0x6f,0x3a,0x3e,0x08,0x04,0x46,0x00,0x41,0x1b,0x73,0x00,0xdd,0x8e,0x73,
+	0x24,0x65,0xcc,0xff,0x50,0x20,0xe3,0xff,0xff,0xe2,0x24,0x37,0x1b,0xee,0xee,0x74,
+	0x74,0x9e,0x1c,0x08,0x88,0xf7,0xa8,0x01,0x77,0x00,0x6b,0x3d,0x27,0xff,0x79,0x0b,
+	0x88,0x6b,0x88,0x28,0x0c,0x2a,0xee,0x0d,0x00,0x86,0xe8,0xff,0xe4,0x08,0xb2,0x24,
+	0x36,0xff,0x92,0x24,0x37,0xa9,0x01,0xb7,0x39,0x9a,0xff,0xb2,0x24,0x20,0xc2,0x24,
+	0x21,0xb7,0xbc,0xef,0x54,0xce,0x41,0x3a,0x86,0x01,0x80,0x22,0x2e,0xfb,0xb2,0x3d,
+	0x29,0x0d,0xc5,0xff,0xae,0xf8,0xf4,0xde,0x0a,0x00,0x45,0x1b,0x2e,0x0c,0x90,0x0c,
+	0xa2,0xc4,0xef,0x5c,0x3e,0xb3,0x3d,0x7e,0x08,0xa5,0xc3,0xff,0xbe,0xbd,0x00,0xbd,
+	0x02,0xae,0x54,0x1d,0x1a,0x00,0x61,0xff,0x1b,0x2e,0xcc,0xfa,0x42,0x81,0x02,0xac,
+	0xbf,0x22,0x25,0xc2,0xff,0x0c,0x04,0x8b,0x00,0x11,0xee,0x65,0x00,0x06,0x81,0xff,
+	0xde,0x00,0x27,0xf9,0xb7,0xff,0xa2,0x06,0x07,0x66,0x1a,0x07,0x0c,0x4a,0xf7,0xa5,
+	0xee,0xfe,0x6e,0x00,0x82,0x25,0x22,0xc2,0xff,0x24,0x1f,0xb0,0xe2,0x41,0xdd,0x0e,
+	0xad,0xaf,0x0c,0xbe,0x44,0x3f,0x3f,0x00,0x85,0x32,0x09,0x04,0xff,0xa1,0x62,0x24,
+	0x14,0x66,0x29,0x2e,0xa2,0xff,0x24,0x1f,0x82,0x25,0x12,0xb1,0xa8,0xeb,0xe7,0x60,
+	0xc1,0x41,0x17,0x00,0x14,0x00,0x06,0x17,0x00,0xff,0x37,0x79,0x8e,0x92,0x24,0x14,
+	0xb2,0x14,0xff,0x53,0xc2,0x24,0x35,0x97,0x3b,0x02,0x46,0xff,0xdc,0xff,0xca,0xab,
+	0xa2,0x54,0x53,0xc6,0xff,0xdd,0xff,0xad,0x06,0xb2,0x24,0x35,0xb9,0xff,0x21,0xe5,
+	0x92,0x03,0xbc,0x5a,0x0c,0x07,0xff,0xc8,0x21,0xb1,0x9a,0xeb,0x70,0xcc,0x82,0xaf,
+	0xca,0xbb,0xc8,0x31,0x48,0x08,0x20,0x0c,0x04,0xaa,0xfc,0xac,0x00,0x4a,0x0c,0xbe,
+	0x44,0x57,0xe0,0x20,0x01,0xff,0x84,0x22,0x70,0x70,0x74,0xb9,0x21,0xad,0xff,0x06,
+	0x65,0x8f,0x03,0xa7,0x37,0xca,0xcd,0xff,0x06,0x71,0x8a,0xeb,0xb1,0x8c,0xeb,0xde,
+	0xff,0x01,0x0a,0x92,0x80,0x00,0xa0,0x22,0xe5,0xef,0xb5,0xff,0x81,0x17,0x4c,0x06,
+	0xe1,0x96,0xeb,0xf7,0xd1,0x16,0xec,0x52,0x0e,0xd2,0x6e,0x6b,0xc2,0x7f,0x24,0x22,
+	0xb2,0x24,0x1f,0xad,0x02,0x5c,0x04,0xf7,0xe5,0x4a,0xfb,0x61,0x04,0x26,0x92,0x24,
+	0x20,0xff,0xb2,0x24,0x22,0xaa,0x99,0xca,0xbb,0xad,0x7f,0x04,0x92,0x64,0x26,0xb2,
+	0x64,0x22,0xa2,0x15,0xbf,0xe5,0xc8,0xff,0x6e,0xe6,0xf4,0x0a,0x00,0x45,0xfd,0x1b,
+	0x7b,0x07,0x22,0x40,0x26,0x0a,0x19,0x92,0xff,0x22,0x44,0x88,0xc2,0xb2,0x22,0x35,
+	0x90,0xff,0x94,0xc0,0x90,0x88,0x82,0x8a,0x83,0xa0,0xff,0xa8,0xc0,0x25,0x87,0x03,
+	0x2d,0x0a,0x1d,0xe7,0xf0,0x7c,0xf2,0x75,0x03,0x73,0x03,0x41,0x64,0xeb,0xff,0x42,
+	0x24,0x46,0x42,0x24,0x12,0xc1,0x65,0xff,0xeb,0x61,0xf8,0xeb,0x52,0x24,0x3a,0x81,
+	0xff,0x55,0xeb,0xf1,0xf7,0xeb,0x0e,0x35,0x5d,0xfe,0x8c,0x01,0x69,0x1b,0x60,0x55,
+	0x20,0x80,0x55,0xff,0x20,0x52,0x64,0x3a,0x82,0x0c,0x03,0xe8,0xff,0xd4,0xa2,0x24,
+	0x31,0x16,0xe8,0x1a,0x92,0xff,0x24,0x3d,0xb2,0x24,0x41,0x9e,0xee,0x7b,0xff,0x60,
+	0x21,0x00,0x60,0x22,0xb7,0x1a,0x05,0xdd,0xa7,0x21,0x01,0x6c,0x00,0xf0,0x27,0x08,
+	0x06,0x6a,0xff,0x00,0x77,0x3e,0x02,0xc6,0x8e,0x00,0x98,0xff,0xc4,0xea,0x99,0x70,
+	0xa9,0xc0,0xb8,0x01,0xff,0x25,0x80,0x03,0xc1,0x4d,0xeb,0xae,0x74,0xfd,0x4d,0x50,
+	0x00,0x85,0x1b,0xa7,0xf5,0x48,0xa2,0xff,0x24,0x3f,0xb2,0x24,0x3d,0x26,0x0a,0x3f,
+	0xff,0x26,0x0b,0x3c,0xe2,0x0c,0x03,0xbc,0x6e,0xff,0x97,0xf5,0x34,0x51,0x88,0xeb,
+	0xad,0x04,0xff,0xc2,0x24,0x41,0x52,0x05,0x06,0x25,0xf4,0xff,0xff,0xb2,0x24,0x3f,
+	0xa2,0x64,0x38,0xc2,0xff,0x24,0x43,0xad,0x04,0x25,0xf3,0xff,0xc1,0xff,0x3e,0xeb,
+	0x91,0xd3,0xeb,0x82,0x24,0x3a,0xff,0x5a,0xaa,0xa2,0x64,0x39,0x90,0x88,0x20,0xf7,
+	0x8e,0x74,0xad,0x4b,0x08,0x92,0x0c,0xeb,0xb2,0xff,0xc2,0xe8,0x90,0x2b,0x93,0x16,
+	0x22,0x11,0xff,0xac,0x39,0xe2,0x04,0xa0,0x82,0x24,0x30,0xff,0x60,0xf2,0x20,0x40,
+	0xee,0x01,0x80,0x80,0xff,0x34,0xf9,0x13,0xf1,0xc7,0xeb,0x80,0x88,0xff,0x01,0x80,
+	0xee,0x20,0xf0,0xee,0x20,0xee,0xef,0x73,0x03,0x62,0x00,0xc4,0x07,0x24,0x45,0xe2,
+	0xbf,0x04,0xa2,0x8e,0x44,0xe6,0x8a,0x7d,0x06,0x5d,0xff,0x06,0x66,0x1e,0x10,0x20,
+	0x71,0x41,0x70,0xff,0x77,0x90,0x70,0x71,0x41,0x0e,0x06,0x07,0xff,0xe0,0x80,0x00,
+	0x40,0x22,0x7d,0x02,0x97,0xff,0x98,0x30,0x88,0xc4,0xf2,0x24,0x33,0xb1,0xff,0xb0,
+	0xeb,0xa2,0x24,0x3a,0x87,0x3f,0x05,0xff,0xb0,0xaa,0x10,0xa2,0x64,0x3a,0xf2,0x24,
+	0xff,0x1c,0x92,0x24,0x1e,0xf7,0xb9,0x02,0x77,0xaf,0x7a,0x0d,0xb0,0x5a,0x3c,0x03,
+	0x1e,0xf0,0x00,0x5d,0xff,0x06,0x86,0x00,0x00,0x52,0xc4,0x6c,0xf8,0xff,0x35,0xb8,
+	0x05,0xfa,0xbb,0x66,0x2e,0x09,0xff,0xad,0x03,0xcd,0x07,0xe5,0x7c,0x03,0x46,0xdf,
+	0x05,0x00,0x81,0x0d,0xeb,0x09,0x02,0x82,0x28,0xe7,0x1b,0xad,0x0b,0xc9,0x16,0x16,
+	0x02,0x91,0x0a,0xeb,0xff,0x92,0x09,0xeb,0x3a,0x32,0xc1,0x68,0xeb,0xff,0xbc,0x29,
+	0xa2,0x24,0x30,0xe1,0x32,0xeb,0xbf,0xa0,0xb0,0xf4,0xce,0x0b,0x1f,0xd3,0x00,0x89,
+	0xff,0x1b,0x1b,0x9a,0x99,0x03,0xa2,0x24,0x39,0xff,0xa9,0x13,0x82,0x24,0x38,0x89,
+	0x23,0xf9,0x7f,0x33,0xf1,0x62,0xeb,0xe2,0x0e,0x8c,0xc1,0x00,0xff,0xe9,0x33,0xd2,
+	0x24,0x30,0x1b,0xdd,0xd2,0xff,0x64,0x30,0xa8,0x35,0x57,0x96,0x07,0xb2,0xbf,0x24,
+	0x33,0x7a,0xbb,0xb2,0x64,0x14,0x00,0x34,0xff,0x7a,0xaa,0xa9,0x35,0x5e,0x06,0xdd,
+	0xbe,0xff,0xe1,0x02,0x80,0x22,0xb8,0x15,0xb7,0x3a,0xff,0x03,0x0c,0x0c,0xc9,0x35,
+	0xd2,0x64,0x34,0xff,0x1d,0xf0,0x9d,0x0a,0xc6,0xeb,0xff,0x82,0xf6,0x6e,0x05,0x43,
+	0x8e,0xae,0x19,0x02,0xa7,0xbb,0x05,0xfe,0xab,0x0d,0x9d,0x0a,0xf8,0xe4,0x82,0x24,
+	0x3c,0xff,0xfe,0x74,0x0b,0x5e,0xe1,0x02,0x88,0x22,0x7f,0xa0,0x9b,0x93,0x9e,0x74,
+	0x48,0x1e,0x0a,0x04,0xf7,0x56,0x68,0xe5,0xa2,0x01,0x1b,0x8b,0x16,0xe8,0xff,0xe4,
+	0x92,0x0c,0x03,0x16,0x89,0xe4,0x50,0xff,0x89,0x05,0x56,0x28,0xe4,0xb7,0x3f,0x5f,
+	0xff,0x78,0xc4,0xba,0x77,0x82,0x04,0xe8,0x92,0x7f,0x24,0x35,0xf0,0x77,0xc0,0x99,
+	0x01,0x56,0x02,0xff,0x80,0x77,0x63,0x77,0xbb,0x16,0xac,0x2a,0xfe,0x31,0x05,0x41,
+	0xba,0x88,0x70,0x78,0xc0,0x72,0xff,0x64,0x40,0x0e,0x0d,0x0f,0xfe,0xe1,0x02,0xdb,
+	0x40,0x22,0x12,0x00,0x70,0x7b,0x10,0x04,0xf2,0x64,0xff,0x44,0x46,0x03,0x00,0xd2,
+	0x64,0x40,0xd2,0xdf,0x64,0x44,0x7e,0x00,0x0f,0x86,0x03,0xa1,0x1b,0xff,0x77,0x3e,
+	0x05,0xa7,0xbf,0x02,0x86,0x7a,0xff,0xff,0x79,0xe4,0x56,0x8a,0xdc,0x70,0xae,0xff,
+	0xc0,0xc6,0x73,0xff,0x7d,0x0b,0x86,0xe7,0xff,0xff,0x9d,0x0e,0x86,0x70,0xff,0x00,
+	0x00,0xee,0xc7,0x02,0x41,0xbc,0xea,0x9f,0x0e,0x51,0xbd,0xea,0xff,0x32,0x24,0x34,
+	0x82,0x05,0x03,0x9c,0xc3,0xff,0xcc,0x38,0x92,0x24,0x1b,0x9c,0x59,0x42,0xff,0x14,
+	0x52,0xf0,0x44,0x11,0x49,0x02,0xa2,0xff,0x05,0xeb,0x8c,0xea,0x8c,0xc4,0x0e,0x06,
+	0xfd,0x04,0x88,0x01,0x40,0x22,0x0c,0x04,0x49,0x02,0xf3,0x1d,0xf0,0xdd,0x02,0x3f,
+	0x08,0x21,0xac,0xea,0x41,0xff,0xaf,0xea,0x22,0x22,0x46,0x88,0xe4,0x22,0xfb,0x22,
+	0x12,0x7d,0x01,0x82,0x22,0x31,0x3d,0x0a,0xff,0xb8,0xd2,0xb2,0x62,0x3e,0x8e,0x72,
+	0x2a,0xff,0x08,0xc7,0x00,0x89,0x1b,0xe5,0x31,0xfe,0xef,0xbe,0x42,0x2a,0x09,0x0a,
+	0x04,0x25,0x31,0xfe,0xcf,0x88,0xf4,0xad,0x03,0x26,0x00,0x3f,0x0c,0x61,0x00,0xff,
+	0x61,0x9c,0xea,0x29,0x21,0xb1,0xe1,0xea,0xff,0x62,0x26,0x46,0xc1,0x9d,0xea,0xb2,
+	0x0b,0xff,0x05,0x62,0x26,0x12,0x39,0x11,0x4a,0xbb,0xff,0x72,0x26,0x35,0xb0,0xb0,
+	0xf4,0xd8,0xc6,0xff,0x70,0x4b,0x82,0x70,0x75,0x82,0x7e,0xcd,0xfd,0x63,0xd0,0x00,
+	0x61,0x1b,0x7d,0x03,0x47,0xbd,0x7f,0x01,0x4d,0x03,0x88,0xec,0xb9,0x31,0x43,0x00,
+	0xff,0xb8,0xd6,0x2d,0x0a,0x77,0xbb,0x02,0x06,0xff,0x3c,0x00,0xc2,0x26,0x31,0x70,
+	0xbb,0xc0,0xff,0xb2,0x66,0x3f,0x78,0x11,0xce,0x76,0x3a,0xfb,0x08,0xe7,0x6a,0x00,
+	0x65,0x2a,0xfe,0xbe,0x46,0xfb,0x3a,0x09,0x0a,0x04,0xe5,0x29,0xfe,0x9c,0xd5,0xff,
+	0x92,0x26,0x43,0xb2,0x26,0x3f,0xb2,0x66,0x37,0x3e,0x9e,0x76,0x96,0x0c,0x65,0x28,
+	0x20,0x00,0x96,0x0c,0xff,0xa5,0x27,0xfe,0xc2,0x26,0x19,0xb8,0xd6,0xff,0xa1,0x7c,
+	0xea,0xb2,0x66,0x45,0xc2,0x66,0xff,0x46,0xa2,0x0a,0x03,0x98,0x31,0x56,0x5a,0xff,
+	0x06,0x32,0x66,0x34,0x91,0x0f,0xeb,0xd2,0xff,0x26,0x3f,0xd9,0xe6,0xe2,0x26,0x3a,
+	0x90,0xff,0xee,0x20,0xe2,0x66,0x3a,0x42,0x26,0x35,0xff,0xad,0x07,0x58,0x21,0xbd,
+	0x04,0xa5,0x48,0xff,0x03,0xb1,0x70,0xea,0xc0,0x20,0x00,0xa9,0x7d,0x01,0x04,0x00,
+	0x98,0x01,0x40,0x99,0x82,0x07,0x00,0xef,0x52,0x66,0x1b,0x99,0x0f,0x04,0x32,0x66,
+	0x1e,0xff,0x32,0x66,0x1d,0xf1,0x7c,0xea,0x88,0x01,0xff,0x82,0x66,0x1c,0xf2,0x0f,
+	0x50,0x8c,0xdf,0xff,0x92,0x26,0x3a,0x07,0xf9,0x08,0xa1,0xfb,0xff,0xea,0xa0,0xa9,
+	0x10,0xa2,0x66,0x3a,0x88,0xb7,0xfb,0xad,0x02,0x09,0x09,0xac,0x39,0x99,0x00,0xa2,
+	0xbf,0x26,0x43,0xb7,0xb4,0x3c,0x40,0xc5,0x04,0x3d,0x5f,0xae,0x76,0x1a,0x08,0xa7,
+	0x2e,0x05,0x1e,0xa2,0x00,0xfb,0x1a,0x09,0x0a,0x04,0xa5,0x1d,0xfe,0xa2,0x26,0xff,
+	0x31,0x91,0xed,0xea,0x16,0xda,0xf7,0x46,0x6f,0xdc,0xff,0xd8,0xc6,0xf2,0x00,0xba,
+	0xbd,0xf4,0x0c,0xff,0x0e,0xf7,0xfc,0x9e,0xe1,0x03,0x44,0x22,0xbf,0x8c,0xda,0xc8,
+	0xc6,0xba,0xbc,0x42,0x00,0xbe,0xf7,0xf9,0xfa,0x5e,0x10,0x04,0x32,0x66,0x3d,0xad,
+	0x6f,0x03,0xae,0xff,0xfb,0xf8,0x02,0x45,0x1b,0xaf,0x0d,0x3f,0x61,0x40,0xea,0x20,
+	0x50,0x14,0x6d,0x01,0x67,0x01,0xff,0x60,0x55,0xb0,0x32,0x45,0xac,0x42,0x45,0xe9,
+	0xad,0x8c,0x05,0x1b,0x04,0x39,0x1b,0x30,0xbc,0x42,0x45,0xfd,0xbd,0x1b,0x10,0x51,
+	0x32,0xea,0x20,0x40,0x14,0xff,0x52,0x25,0x46,0x52,0x25,0x12,0x50,0x44,0xcf,0xb0,
+	0x32,0x64,0x2e,0x18,0x00,0x17,0x00,0x81,0x2c,0xff,0xea,0x82,0x28,0x46,0x82,0x28,
+	0x12,0x22,0xff,0x58,0x52,0x42,0x48,0xa1,0x3e,0x78,0x75,0xff,0x00,0x27,0x00,0x85,
+	0x1b,0x52,0x48,0xa2,0xff,0x66,0x14,0x04,0x0c,0x19,0x92,0x48,0xa2,0x9e,0x27,0x04,
+	0x81,0x00,0x21,0x22,0x24,0x06,0x22,0x02,0x91,0xff,0x4c,0xea,0x42,0x12,0x52,0xa2,
+	0x22,0x27,0xff,0x90,0x84,0xc0,0x9e,0x38,0x23,0x01,0x07,0xff,0x00,0x55,0x1b,0x90,
+	0x8a,0xc0,0x16,0xe8,0xff,0x22,0x5e,0x30,0xab,0x1c,0x87,0x06,0x1d,0xff,0x1b,0x25,
+	0x33,0x03,0x6d,0x0a,0xad,0x04,0xff,0xbd,0x06,0xa5,0x32,0x03,0x69,0x11,0x72,0xff,
+	0x05,0xbc,0x3d,0x0a,0x92,0x02,0xa2,0xf0,0xff,0xa4,0x11,0xa2,0x62,0x35,0x66,0x19,
+	0x0a,0xff,0x40,0xb4,0x90,0xb0,0xb1,0x21,0x4b,0xbb,0xff,0xb2,0x62,0x35,0xa2,0x15,
+	0x5c,0xbd,0x03,0xbf,0x25,0x30,0x03,0xae,0x72,0x6b,0xe2,0x00,0x85,0xff,0x1b,0xae,
+	0x42,0xcc,0x02,0x07,0x01,0x65,0xff,0x1b,0xa5,0xec,0xfa,0xa2,0xc2,0x4c,0xbe,0xb7,
+	0x00,0x0c,0x02,0x05,0x07,0xe5,0xeb,0x0d,0x00,0x5c,0xea,0x0d,0x18,0xea,0x0d,0x00,
+	0x7c,0x0d,0x14,0x25,0xea,0xfa,0xb7,0xae,0x52,0x1b,0x5b,0x0a,0xae,0x4a,0x3c,0x00,
+	0x00,0xaf,0x71,0x1b,0xe5,0xe8,0x20,0x00,0x6c,0x20,0x18,0xe8,0xff,0xfa,0xe1,0x39,
+	0xea,0xe2,0x0e,0x00,0x6e,0xfb,0xf5,0x94,0x26,0x00,0x1d,0x1b,0x0e,0x8e,0x0a,0xff,
+	0x1f,0xe7,0x01,0x59,0x1b,0xa8,0xb2,0xbd,0xff,0x04,0xc2,0x25,0x2d,0x25,0xe6,0xfa,
+	0x62,0xdf,0x22,0x35,0xa2,0x25,0x2d,0xae,0x00,0x27,0x03,0xff,0x49,0xe2,0x49,0xd2,
+	0xf2,0x02,0xb5,0xa0,0xff,0xb6,0x82,0xb9,0x21,0xf9,0x31,0xb9,0xc2,0xff,0xa8,0xb2,
+	0xae,0x71,0x0e,0x1f,0xe7,0x00,0xff,0x81,0x1b,0xe0,0x8f,0xc0,0x16,0x88,0x15,0xff,
+	0x42,0x62,0x12,0x42,0x62,0x11,0x92,0x22,0xff,0x36,0xa9,0xf2,0xbd,0x03,0xad,0x07,
+	0x60,0xff,0x99,0x82,0x99,0x41,0x92,0x62,0x10,0xe5,0xff,0x23,0x03,0xc1,0xdd,0xe9,
+	0x98,0x41,0xc8,0xff,0xac,0xf8,0x31,0xb8,0x21,0x8c,0x3c,0x1b,0xff,0xaa,0x30,0x7a,
+	0x82,0x42,0x62,0x16,0x42,0xff,0x62,0x15,0xd8,0x01,0xa0,0xc6,0x82,0xc2,0xff,0x62,
+	0x14,0x9a,0xdd,0xd2,0x62,0x13,0x2e,0xfd,0x10,0x4c,0x04,0x41,0x1b,0xe2,0x02,0xb5,
+	0xf8,0xff,0xa6,0xa7,0x1e,0x78,0x8c,0xbf,0xa2,0x05,0xfd,0xbc,0x01,0x01,0x20,0x03,
+	0x1b,0x7a,0x70,0x73,0xf7,0x82,0x88,0x11,0x8a,0x00,0x70,0xa8,0x82,0xe0,0xed,0xaa,
+	0x2a,0x01,0x20,0x92,0x1c,0x01,0x06,0x7a,0x99,0xff,0x90,0x93,0xa0,0x90,0x88,0x82,
+	0xa0,0xa8,0xff,0xa0,0xe0,0x88,0x11,0x82,0x62,0x24,0x65,0xf9,0x1d,0xa4,0x08,0x54,
+	0x00,0xc9,0xc2,0xae,0x42,0xbb,0xfe,0xd2,0x00,0x81,0x1b,0xe5,0xd9,0xfa,0x42,0x62,
+	0xff,0x22,0x42,0x62,0x21,0x42,0x62,0x26,0xc8,0xff,0xb2,0x42,0x62,0x25,0xb2,0x22,
+	0x20,0xce,0xff,0x4c,0xfd,0x1e,0x07,0x1e,0x61,0x1b,0xd0,0xff,0xcc,0x10,0xc2,0x62,
+	0x1f,0xca,0xbb,0xbe,0xef,0x4b,0x7c,0x1e,0x87,0x0f,0x00,0xc0,0xbb,0x10,0xff,0xb2,
+	0x62,0x23,0x42,0x62,0x30,0x42,0x62,0xff,0x31,0x42,0x62,0x32,0x42,0x62,0x34,0x42,
+	0xff,0x52,0x53,0x42,0x62,0x33,0x42,0x62,0x37,0xff,0x42,0x62,0x41,0x42,0x62,0x42,
+	0x42,0x62,0xff,0x43,0x42,0x62,0x47,0x42,0x62,0x48,0x61,0xdf,0xa8,0xe9,0xae,0x52,
+	0x1e,0xdf,0x01,0x61,0x1b,0xff,0xee,0x72,0xbd,0x1f,0xe7,0x1f,0x85,0x1b,0xff,0xd2,
+	0x62,0x3d,0xd2,0x62,0x3e,0xd2,0x62,0xef,0x3f,0xde,0x72,0x5b,0x79,0x00,0x89,0x1b,
+	0xde,0xfb,0x72,0x6c,0x2e,0x02,0x89,0x1b,0x4e,0x86,0x2a,0xff,0x5a,0x41,0x02,0x80,
+	0x22,0x25,0xd1,0xfa,0xff,0xa2,0x06,0x08,0xb1,0x33,0xea,0x92,0x22,0xff,0x3a,0xa0,
+	0xa0,0x04,0xd0,0xaa,0x01,0xb0,0xff,0x99,0x10,0xa0,0x99,0x20,0x92,0x62,0x3a,0xff,
+	0xf8,0xa6,0xb1,0x0a,0xea,0x8c,0x4f,0xb0,0xff,0xb9,0x20,0xb2,0x62,0x3a,0x0c,0x02,
+	0x1d,0x7f,0xf0,0xc1,0xbb,0xe9,0x3e,0x7c,0x92,0x5f,0x00,0xff,0x81,0x1b,0x1d,0xf0,
+	0x92,0x22,0x10,0xa9,0xff,0x01,0xc2,0x22,0x14,0x9a,0xda,0x42,0x62,0xef,0x1a,0x42,
+	0x62,0x19,0x6e,0x01,0xda,0xac,0xa2,0xff,0x62,0x17,0x90,0xab,0xc0,0xc0,0xaa,0xc0,
+	0xff,0xa2,0x62,0x18,0x16,0xa8,0xf4,0xbd,0x06,0xff,0x88,0x11,0x9a,0xac,0xa0,0xa6,
+	0xa0,0x70,0xff,0x78,0x82,0xe0,0x77,0x11,0x72,0x62,0x20,0xff,0x65,0x0c,0x03,0xf8,
+	0x11,0xc8,0x01,0xf0,0xff,0xf3,0x82,0xf0,0xfa,0x82,0x70,0xef,0xa0,0xff,0xe0,0xff,
+	0x11,0xf2,0x62,0x24,0xd2,0x25,0xf9,0x2d,0x0e,0x19,0x0c,0x01,0xe0,0xdd,0xc0,0xde,
+	0xcc,0xdf,0x2d,0x1e,0x07,0x1f,0xad,0x0c,0x05,0x7a,0xbc,0xdc,0x0e,0x01,0x0c,0x2d,
+	0xc6,0xbb,0xff,0x5b,0x0f,0x41,0x69,0x7f,0xe9,0x42,0x24,0x46,0x6e,0xff,0x03,0xdb,
+	0x00,0xdf,0xa1,0x1b,0x9e,0x91,0x95,0x30,0x0a,0x4e,0x44,0xff,0x22,0x00,0x27,0x01,
+	0x81,0x1b,0x76,0xa2,0xff,0x13,0x40,0x83,0xb0,0x62,0x48,0xac,0x62,0xff,0x48,0xad,
+	0x5e,0x78,0xa3,0x60,0x20,0x00,0xff,0x84,0x22,0x30,0x30,0x74,0x62,0x44,0xbc,0xff,
+	0x62,0x44,0xbd,0x52,0x64,0x2e,0x52,0x44,0xff,0xa2,0x52,0x64,0x36,0x52,0x44,0xa1,
+	0x52,0xff,0x64,0x3b,0x92,0x54,0x52,0x9e,0x74,0x72,0xf6,0x3e,0x00,0x85,0x1b,0x7f,
+	0x0b,0xa1,0x00,0x2e,0x52,0xff,0x38,0x01,0x87,0x01,0xa5,0x1b,0x8e,0xa3,0xfd,0x06,
+	0xf2,0x00,0x65,0x1b,0x66,0x93,0x14,0x98,0xff,0x04,0xa2,0xc9,0xfe,0x16,0x4a,0x0b,
+	0x66,0xff,0x49,0x02,0xc6,0x21,0x00,0x0c,0x22,0x1d,0xef,0xf0,0x16,0x8c,0x09,0x06,
+	0x04,0x71,0x4a,0xe9,0xff,0x98,0x04,0xa1,0x8c,0xe9,0xb2,0xd7,0x01,0xf7,0xde,0x29,
+	0x02,0x19,0x03,0x59,0x1b,0xb1,0xe0,0xff,0xe9,0x3e,0x44,0x1a,0x24,0x00,0x00,0x80,
+	0xbf,0x22,0x2e,0x71,0x0c,0x00,0xc7,0x34,0x01,0xa5,0xff,0x08,0x03,0x92,0x25,0x3a,
+	0x30,0x40,0x34,0xff,0x16,0x74,0x08,0x07,0xf9,0x02,0x46,0x20,0xff,0x00,0x0c,0x12,
+	0x1d,0xf0,0x66,0x19,0x18,0xff,0xd2,0x0a,0x00,0xdc,0x2d,0x38,0x14,0x16,0xff,0xb3,
+	0x0b,0x0b,0xe3,0x16,0x5e,0x14,0xf2,0xef,0xc3,0xfe,0x16,0xcf,0x57,0x08,0x5e,0x39,
+	0xdc,0xff,0x3e,0x61,0x03,0xd0,0x22,0x82,0x0a,0x00,0xff,0x56,0x28,0xf9,0x98,0x14,
+	0x90,0x98,0x74,0xff,0xf6,0x29,0x7e,0x92,0x65,0x3c,0xa8,0x14,0xd7,0xae,0x85,0x82,
+	0xad,0x00,0x9d,0xad,0x00,0x98,0x14,0xdf,0xbc,0x19,0x26,0x19,0x03,0x2f,0x04,0x92,
+	0x22,0xef,0x39,0x9e,0x74,0x12,0x62,0x0a,0x1d,0xf0,0xc8,0xbf,0x14,0xc0,0xc0,0x04,
+	0xce,0x7b,0x0e,0x14,0xd2,0xbf,0x22,0x3a,0xd0,0xd9,0x05,0xde,0x1e,0x18,0x92,0xff,
+	0x22,0x38,0x06,0xf4,0xff,0x37,0xf9,0x08,0xff,0xe1,0x30,0xe9,0xe2,0x0e,0x50,0x16,
+	0x1e,0xff,0xf7,0xf1,0x5b,0xe9,0xf2,0x0f,0x00,0x56,0xff,0x8f,0xf6,0x22,0x65,0x33,
+	0x56,0x04,0x04,0xff,0x81,0xb1,0xe9,0x30,0xa0,0x04,0x00,0xaa,0xff,0x11,0x80,0x89,
+	0x10,0xa0,0x88,0x20,0x82,0x9f,0x65,0x3a,0x22,0x67,0x12,0xb4,0x04,0x68,0x00,0xc1,
+	0xff,0x01,0xe9,0x62,0x47,0x08,0xb2,0x25,0x3a,0xff,0xc0,0xbb,0x20,0xb2,0x65,0x3a,
+	0x62,0x47,0xff,0x03,0x1d,0xf0,0xe1,0xa2,0xe9,0x22,0x47,0xff,0x08,0xd2,0x25,0x3a,
+	0xe0,0xdd,0x10,0xd2,0xff,0x65,0x3a,0x1d,0xf0,0xa1,0x01,0xe9,0xa2,0x7f,0x2a,0x46,
+	0xae,0x4a,0x69,0x00,0x87,0x71,0x00,0xef,0x9e,0x71,0x4b,0x28,0x0d,0x05,0xb9,0x51,
+	0x88,0xff,0x0a,0xc2,0xc1,0x10,0xde,0x0c,0x0b,0x00,0xfd,0xa7,0xb4,0x01,0xe0,0x08,
+	0x00,0x22,0x65,0x44,0xff,0xd1,0x97,0xe9,0xc2,0x25,0x3a,0xfe,0x51,0xff,0x3e,0x1f,
+	0xe7,0x1e,0x85,0x1b,0xe2,0x65,0xff,0x39,0xe2,0x65,0x38,0xe2,0x65,0x40,0xf2,0xfb,
+	0x45,0xa0,0x0e,0x07,0x65,0x3a,0xb2,0x27,0x41,0xff,0x62,0x67,0x12,0x66,0x1b,0x04,
+	0x81,0x1a,0xff,0xe9,0x29,0x28,0xa8,0x97,0xac,0x7a,0xcd,0xef,0x01,0x8e,0x4a,0x3b,
+	0x8b,0x0a,0xdd,0x0b,0x40,0xff,0x4b,0x93,0xe0,0x94,0x11,0x9e,0x71,0x0b,0xfb,0x01,
+	0x47,0xf8,0x07,0x08,0x00,0x2d,0x0a,0x1d,0x7d,0xf0,0x9f,0x00,0x6d,0x02,0xc6,0xd8,
+	0xff,0x63,0x05,0x7f,0x00,0x36,0x61,0x00,0xa1,0xde,0xe8,0x8a,0x04,0xf6,0x04,0x0b,
+	0x01,0x0c,0xd5,0x03,0xa1,0x1b,0xde,0x71,0xdd,0x0b,0x0c,0x09,0xae,0x4a,0x28,0x30,
+	0x0e,0xa8,0x13,0xff,0xa0,0xd9,0xb0,0xc2,0x4d,0xac,0xc2,0x4d,0xbf,0xad,0xbe,0x7d,
+	0xa9,0x20,0x21,0x30,0x02,0x90,0xff,0x90,0x74,0xc2,0x4a,0xbc,0xc2,0x4a,0xbd,0xff,
+	0xb2,0x6a,0x2e,0xb2,0x6a,0x3c,0xb2,0x4a,0xff,0xe8,0xe1,0xf8,0xe8,0xe2,0x5a,0x52,
+	0xee,0xef,0x7a,0x7a,0x00,0x47,0x2d,0x02,0x65,0x1d,0xfe,0xff,0x81,0xe1,0xe8,0x1e,
+	0xb1,0x3a,0x01,0xa7,0xce,0x2c,0x02,0xce,0x03,0x0d,0x5e,0x03,0xd5,0x08,0x0c,0x4a,
+	0xe7,0xe5,0x1c,0xfe,0x36,0x07,0xa7,0x02,0xbe,0x04,0x0a,0xff,0x0c,0x47,0x02,0xa1,
+	0x1b,0x25,0x99,0xfa,0x7f,0x2d,0x0a,0xbe,0x5d,0x9c,0x04,0xc7,0xa6,0x02,0xbf,0xa5,
+	0x9a,0xfa,0xa1,0xb9,0xe8,0x21,0x01,0x91,0xff,0xfd,0xe8,0x22,0x6a,0x12,0x82,0x09,
+	0x00,0xff,0x31,0xcc,0xe8,0xb2,0x09,0x04,0xdc,0x98,0xef,0xae,0x43,0xdb,0x02,0x89,
+	0x06,0x25,0x96,0xfa,0xdf,0xa9,0xb2,0xbe,0x43,0xdc,0x96,0x0a,0xe5,0x8f,0xff,0xfa,
+	0x06,0x0d,0x00,0xac,0x9b,0xae,0x53,0xff,0xcb,0x01,0xe7,0x01,0x95,0x1b,0xe5,0xd7,
+	0xff,0x02,0xb2,0x13,0x5c,0xa0,0xc0,0x74,0xc0,0xfb,0xac,0x11,0x71,0x03,0xba,0xba,
+	0xba,0xaa,0xa2,0xdf,0xca,0x5e,0x2e,0xaa,0xeb,0x3a,0x00,0xad,0x1b,0xfb,0x65,0x92,
+	0x3a,0x00,0xe1,0xa4,0xe8,0x0c,0x0d,0xff,0xd2,0x4e,0x08,0xf1,0x41,0xe9,0x29,0x0f,
+	0xfc,0xd6,0x06,0x33,0x07,0x91,0x9c,0xe8,0x92,0x29,0x46,0xff,0x98,0xa9,0x92,0x29,
+	0x16,0xad,0x02,0x82,0xff,0x03,0x12,0x92,0x09,0x30,0xbd,0x03,0xd1,0xff,0x3b,0xe9,
+	0x97,0x98,0x0a,0xc0,0xea,0x03,0xff,0xda,0xcc,0xc0,0xf1,0x13,0x00,0x20,0x00,0x9f,
+	0x81,0x37,0xe9,0x88,0x08,0xc5,0x00,0x3b,0x05,0x41,0xff,0x00,0x92,0x02,0x14,0xb1,
+	0x8e,0xe8,0x26,0xff,0x39,0x1c,0x66,0x29,0x0d,0xad,0x03,0x82,0xbf,0x2b,0x1c,0xcd,
+	0x05,0xbd,0x04,0x1d,0x08,0xcd,0x3f,0x05,0x82,0x2b,0x20,0xad,0x03,0x0d,0x10,0x67,
+	0x05,0xdf,0x81,0x88,0xe8,0x88,0xe8,0x0d,0x00,0xb8,0x23,0xff,0xcd,0x04,0x81,0x81,
+	0xe8,0x62,0x12,0x08,0xff,0x7d,0x0a,0x92,0x28,0x4a,0xa8,0x12,0x82,0xff,0x28,0x1a,
+	0x92,0xd9,0x01,0x6e,0x61,0xd9,0x7f,0x28,0x81,0x03,0xa4,0x22,0x99,0x01,0x23,0x00,
+	0xff,0x88,0x83,0x98,0x01,0xcc,0x68,0x98,0x09,0xff,0xcc,0x29,0xa8,0x73,0x9c,0x1a,
+	0x81,0x75,0xbd,0xe8,0x25,0x04,0x21,0xbd,0x04,0xcd,0x4e,0x04,0x98,0xdf,0x83,0x99,
+	0x73,0xdd,0x06,0x69,0x04,0x21,0x73,0xff,0xe8,0xad,0x03,0xa5,0xf7,0xff,0x88,0xf2,
+	0xfb,0xad,0x07,0x93,0x18,0x81,0x10,0xe9,0xc0,0x20,0xff,0x00,0x82,0x28,0x80,0x8c,
+	0x88,0x81,0x0c,0x9f,0xe9,0x88,0x18,0xad,0x02,0x1a,0x0c,0x1b,0x04,0x51,0xff,0x66,
+	0xe8,0x68,0xa5,0x42,0x03,0x0e,0x9c,0xff,0x16,0x66,0x24,0x0f,0xae,0x43,0x2b,0x1c,
+	0xfb,0x87,0x06,0x7e,0x03,0xc4,0x02,0xa0,0x86,0x82,0xff,0x89,0xb5,0x26,0x34,0x02,
+	0x66,0x44,0x0f,0xff,0x91,0x89,0xe8,0x92,0x09,0x98,0xb1,0x87,0xff,0xe8,0xa2,0x25,
+	0x45,0x8c,0x09,0xa9,0x4b,0x7f,0x81,0xfb,0xe8,0x88,0x28,0xbd,0x03,0x45,0x08,0x5f,
+	0x2d,0x0a,0x6e,0x0a,0x09,0x74,0x01,0x55,0x26,0x03,0xbb,0x99,0xb5,0x53,0x10,0x81,
+	0xf4,0xe8,0x6f,0x18,0xf0,0xf7,0xe8,0x88,0x38,0x6f,0x24,0x81,0xee,0xe8,0x58,0xef,
+	0x08,0x8e,0x78,0x36,0xf9,0x03,0xa5,0x1b,0x2e,0xff,0xa5,0x36,0xc0,0x40,0x01,0x60,
+	0x22,0x60,0xff,0x60,0x74,0x80,0x76,0xa0,0x58,0x07,0x56,0xed,0xc5,0x06,0x0a,0x28,
+	0x17,0xb7,0x0c,0x51,0x3c,0xe8,0xff,0x32,0x25,0x46,0x38,0xa3,0x0c,0x04,0x42,0xff,
+	0x43,0x55,0x4e,0x83,0x4b,0x5e,0xe0,0x03,0xbf,0x88,0x22,0x4e,0x94,0x3a,0x01,0x3b,
+	0x04,0xb0,0xff,0x9a,0x83,0xa1,0x59,0xe8,0x62,0x23,0x16,0xfe,0x6a,0x00,0x81,0x36,
+	0xe8,0x88,0xa8,0x9e,0x7a,0xdf,0xfa,0x00,0x07,0x08,0x91,0x50,0x06,0x91,0x31,0xff,
+	0xe8,0x82,0x29,0x19,0xa2,0x09,0x0a,0xae,0xfb,0x28,0x07,0x2c,0x00,0x59,0x1b,0xdc,
+	0x7a,0xa2,0xff,0x23,0x10,0x82,0x25,0x19,0xcd,0x07,0xae,0xef,0x4a,0x1b,0x01,0x27,
+	0xfa,0x0e,0x91,0x27,0xe8,0x7f,0x46,0x00,0x00,0x79,0x06,0xb1,0xc8,0xae,0x04,0xff,
+	0x72,0x6b,0xa4,0x66,0x12,0x04,0x72,0x69,0xbd,0x19,0xb2,0x03,0x21,0xe8,0xae,0x03,
+	0xef,0x06,0xa1,0xef,0x1b,0x4e,0x7c,0x9d,0xa9,0x00,0x81,0x1b,0xce,0xb3,0xc1,0x8e,
+	0x0f,0x00,0x89,0x02,0x81,0xfa,0xbb,0x0d,0x91,0xdf,0x18,0xe8,0x82,0x09,0x09,0x62,
+	0x00,0xcc,0xa8,0xdf,0x81,0xb7,0xe8,0x88,0x48,0xe3,0x10,0x56,0x3a,0xff,0x09,0x31,
+	0x0e,0xe8,0x42,0x23,0x46,0x82,0x4f,0x23,0x15,0x48,0xa4,0xeb,0x02,0x2d,0x03,0xa5,
+	0x6c,0x04,0xff,0x88,0xc4,0x82,0x28,0x13,0xa2,0xc4,0x34,0xfe,0x0a,0x00,0xa9,0x12,
+	0x82,0x23,0x17,0xce,0x44,0xf9,0x4b,0x48,0x0b,0x0f,0x00,0xa8,0x22,0xa0,0xa1,0x41,
+	0xff,0x65,0xee,0xff,0x82,0x23,0x19,0xcd,0x0a,0x77,0xae,0x42,0x1b,0x9a,0x17,0xc1,
+	0x13,0xe8,0x12,0x00,0x7f,0xa8,0x12,0xce,0x4c,0xab,0x01,0x67,0xd6,0x02,0xac,0x12,
+	0x00,0x0f,0x0c,0x9f,0x8b,0x4f,0x03,0x1d,0x0f,0x18,0xbe,0x73,0x01,0x0c,0xab,0x08,
+	0x0f,0x14,0x2e,0xc2,0x3b,0x75,0x14,0xdf,0x82,0x23,0x1d,0xa8,0x12,0x07,0x12,0xc1,
+	0x00,0xff,0x61,0xe8,0xe7,0x42,0x26,0x46,0x81,0xe9,0xff,0xe7,0x30,0x50,0x74,0x48,
+	0xa4,0x8e,0x48,0xfd,0xa9,0xda,0x08,0x99,0xd1,0x22,0x24,0x16,0x66,0xff,0x18,0x27,
+	0x0c,0x8a,0xae,0x71,0x4b,0x0e,0xfd,0x87,0x7b,0x00,0xa5,0x95,0xfa,0xae,0x00,0x0b,
+	0xfd,0x01,0x53,0x04,0xde,0x04,0x0c,0x24,0x00,0x00,0xff,0xa0,0x22,0xa5,0x56,0x01,
+	0x25,0x8d,0xfa,0x3f,0x4c,0x0a,0x25,0x7b,0xfd,0x3e,0x6c,0x00,0x1a,0x04,0xdf,0x3e,
+	0x75,0x08,0x06,0xc7,0xf8,0x01,0x62,0x24,0xff,0x10,0x80,0x83,0xd1,0x8a,0x66,0x92,
+	0x06,0xff,0x13,0x66,0x19,0x51,0x88,0xc4,0x88,0x88,0xe7,0xae,0x56,0x2b,0x59,0x08,
+	0x63,0x05,0xce,0xe7,0xb2,0xff,0x09,0x0a,0xc8,0x8a,0xa1,0xe0,0xe7,0xec,0xff,0x5b,
+	0x81,0xc8,0xe7,0xa2,0x24,0x10,0x82,0xdb,0x28,0x19,0x84,0x01,0x00,0x67,0xe4,0x0c,
+	0x81,0xc3,0xee,0x13,0x0c,0x1d,0xa8,0x1a,0x1a,0x05,0xd1,0x46,0x02,0xff,0x00,0x20,
+	0xb7,0xa0,0xc9,0x2b,0xa2,0x2a,0xff,0x2a,0xa9,0x4b,0x1b,0x77,0x70,0x70,0x74,0xff,
+	0x1b,0x33,0x30,0x30,0x74,0x3e,0x05,0x78,0xff,0x06,0xc7,0x01,0x91,0x1b,0x69,0x51,
+	0x71,0x7f,0xbb,0xe7,0x88,0xe7,0x61,0xb5,0xe7,0x5c,0x04,0xff,0xb7,0xe7,0x88,0xf7,
+	0x0c,0x03,0x32,0x69,0xfd,0x19,0x0c,0x00,0xa2,0xa4,0x00,0xa0,0xe3,0x13,0xff,0x90,
+	0xea,0x03,0x92,0xd9,0x19,0x92,0xc9,0xdb,0x64,0x90,0x9b,0x0b,0x88,0x97,0x19,0x00,
+	0xd1,0xcf,0xbf,0xe7,0x71,0x53,0xe8,0x0c,0x1c,0xe4,0x01,0xce,0xff,0x7d,0xfb,0xe4,
+	0x80,0x02,0x90,0x22,0xa2,0xff,0x0b,0x0a,0x32,0x6b,0x1b,0xb1,0xab,0xe7,0xfb,0xdc,
+	0x0a,0x7d,0x00,0xcd,0x07,0xb1,0x4c,0xe8,0xdf,0xa8,0x1a,0x65,0x6e,0x02,0x7f,0x00,
+	0x2c,0x00,0xff,0x39,0x02,0xb2,0x0b,0x0b,0xd1,0x4a,0xe8,0xff,0xa1,0x4a,0xe8,0x0e,
+	0x9b,0x1c,0x01,0xa7,0xff,0x01,0xc1,0x1b,0xc7,0x1b,0x09,0xa8,0x51,0xff,0xa8,0x2a,
+	0xe5,0xd3,0xff,0x06,0x03,0x00,0xff,0xc8,0x51,0xc8,0x2c,0xb1,0x41,0xe8,0xd0,0xff,
+	0xcc,0xc0,0xc0,0xab,0x83,0xd1,0x96,0xe7,0xff,0xa9,0x82,0xd2,0x0d,0xea,0x0c,0x19,
+	0xd0,0xff,0xd9,0x93,0xd9,0xa2,0x66,0x25,0x0d,0xe2,0xff,0x24,0x10,0xe2,0x0e,0x50,
+	0xe2,0xce,0xfb,0xff,0xe0,0xe9,0x93,0xe9,0x92,0x26,0x35,0x61,0xff,0xa2,0x26,0x46,
+	0x39,0xa1,0xae,0x4a,0x6b,0xfd,0x00,0x5b,0x05,0xbe,0x71,0x89,0x2c,0x00,0x00,0xff,
+	0x80,0x22,0x99,0x91,0x88,0x0a,0xc2,0xc1,0xbf,0x20,0xde,0x0c,0x0b,0x00,0xa7,0xbb,
+	0x0d,0xfd,0xff,0x07,0x50,0xc1,0x41,0xd2,0x01,0x30,0x92,0xbf,0x26,0x4b,0x8e,0xc4,
+	0x7a,0x08,0xe1,0x05,0xd0,0xff,0xaa,0xd1,0xaa,0x99,0x92,0x09,0x43,0x82,0xff,0x28,
+	0x6f,0xbd,0x02,0xde,0x23,0x89,0x34,0xff,0xa1,0x02,0x1c,0x22,0x9e,0x38,0x7e,0x42,
+	0x7f,0x00,0x01,0xac,0x22,0x3e,0x71,0x0a,0x87,0x01,0xff,0x81,0x1b,0xe5,0x37,0x02,
+	0x28,0xd1,0x1d,0xfd,0xf0,0x5b,0x07,0x73,0xe7,0x82,0x08,0x09,0xcc,0xbf,0xc8,0x81,
+	0x13,0xe8,0x88,0x58,0x9e,0x13,0x1d,0x6d,0xf0,0x51,0x07,0x00,0x00,0xb3,0x0a,0x6b,
+	0xe7,0xb3,0x02,0xff,0x21,0x6a,0xe7,0xd2,0x09,0x0c,0x66,0x18,0xff,0x16,0xb2,0x29,
+	0x1b,0x0c,0x8a,0xa9,0x01,0xff,0xfc,0x3b,0xc0,0xea,0x03,0x0b,0xcc,0xc0,0xfe,0x30,
+	0x09,0xc6,0x07,0x00,0x66,0x1d,0x1c,0x88,0x79,0xa2,0x4d,0x01,0x3e,0x00,0x0c,0x3a,
+	0xbe,0x12,0x5b,0x0e,0xf7,0xde,0x00,0x0e,0x07,0x08,0xa5,0x51,0xfa,0x88,0xfd,0xd2,
+	0x50,0x0a,0xb2,0x29,0x1a,0x66,0x1b,0x28,0x9f,0xb2,0xa0,0x79,0xa5,0x72,0x2d,0x06,
+	0x1d,0x08,0x1e,0xef,0xc1,0x3d,0x00,0x47,0x79,0x02,0xa5,0x33,0x01,0xff,0xd1,0x54,
+	0xe7,0xc8,0x01,0xce,0x8d,0x0a,0xff,0x08,0x27,0x01,0x85,0x1b,0xa5,0x57,0xfd,0xff,
+	0x0c,0x1a,0xe5,0xc2,0xff,0x46,0xf0,0xff,0xfe,0xd7,0x07,0x31,0xec,0xe7,0x51,0x48,
+	0xe7,0x20,0xff,0xa0,0x74,0x00,0x1a,0x40,0x8e,0x55,0x94,0xfe,0x68,0x02,0x81,0x1b,
+	0x8e,0x44,0x19,0x1f,0xe7,0xdf,0x1e,0xc5,0x1b,0x9e,0x44,0x70,0x07,0xa5,0x1b,0xf7,
+	0xae,0x48,0x02,0x07,0x00,0x59,0x1b,0x81,0xe0,0x77,0xe7,0x88,0x68,0x70,0x00,0xa0,
+	0x20,0xf4,0xbf,0x01,0xbf,0xa2,0x23,0xaa,0x40,0xaa,0x10,0x08,0x04,0x63,0x7f,0xaa,
+	0x92,0x05,0x0c,0x66,0x19,0x3a,0x0b,0x00,0xdf,0xb2,0x23,0x80,0xbc,0x1b,0xfe,0x0d,
+	0xb1,0xd3,0x6f,0xe7,0x81,0x33,0xe7,0x04,0x02,0xba,0x99,0x00,0x12,0xb9,0x98,0xac,
+	0x08,0x25,0x00,0xd2,0x63,0x81,0x05,0x00,0xc2,0xef,0x23,0xa3,0x40,0xcc,0x40,0x04,
+	0xc2,0x63,0xa3,0xfe,0x33,0x09,0x82,0x03,0x13,0xa2,0x22,0x16,0xd1,0x7f,0x24,0xe7,
+	0x0e,0x18,0x0b,0x1f,0xe7,0x70,0x00,0xff,0x92,0x0a,0x30,0xb7,0x99,0x05,0xc2,0x03,
+	0xff,0x12,0xc2,0x4a,0x30,0xd2,0x0d,0x09,0xcc,0xff,0xcd,0x81,0xbf,0xe7,0xcd,0x04,
+	0x88,0x78,0xe3,0xbd,0x03,0x51,0x09,0x4d,0x09,0x37,0x00,0x41,0x15,0xe7,0xff,0x42,
+	0x24,0x46,0x81,0x16,0xe7,0xad,0x02,0xbb,0x48,0xa4,0x75,0x01,0x31,0xb7,0xe7,0x46,
+	0x0b,0x08,0xf7,0x81,0x3b,0xe7,0x5e,0x00,0x82,0x63,0x81,0x81,0xcf,0xb1,0xe7,0x88,
+	0x88,0x31,0x00,0x0d,0x00,0x92,0x23,0xff,0x80,0xdc,0xa9,0x81,0x0c,0xe7,0x88,0xa8,
+	0x7e,0x57,0x0d,0xa2,0xa0,0xff,0xae,0x82,0x09,0xdf,0x00,0xff,0x85,0x1b,0x92,0x44,
+	0x54,0x92,0x44,0x55,0xfc,0xa3,0x15,0x1b,0x01,0xff,0xe6,0x32,0x23,0x46,0x81,0xff,
+	0xa2,0xe7,0x38,0xa3,0x88,0x98,0x32,0x23,0xfd,0x16,0x2d,0x00,0x21,0xfe,0xe6,0x88,
+	0x82,0xb1,0xcf,0xa8,0xe7,0xae,0x0a,0xe7,0x1b,0xed,0x0c,0x88,0xa2,0xfe,0x04,0x07,
+	0x99,0xe7,0xce,0x37,0x7a,0x18,0xc7,0xce,0x2e,0x02,0xae,0xea,0x32,0x3b,0x09,0x71,
+	0x00,0x22,0x69,0xf7,0x80,0x6c,0xf8,0x07,0x00,0xf2,0x2c,0x8a,0x80,0xbd,0xff,0xef,
+	0x04,0xf2,0x6c,0x8a,0x86,0x61,0x00,0x00,0xff,0x00,0xe2,0xce,0xfc,0x56,0x9e,0xff,
+	0x1c,0x7d,0x1d,0x38,0x05,0x2c,0x8a,0xd0,0xbb,0x20,0x08,0x04,0xf7,0x6c,0x8a,0x46,
+	0x1b,0x04,0xa2,0xca,0xfc,0x56,0xff,0x9a,0xff,0x92,0xa0,0xff,0x92,0x43,0x30,0xfc,
+	0x90,0x04,0x8f,0x00,0xad,0x02,0x21,0xda,0xe6,0x22,0xff,0x22,0x46,0x28,0xa2,0x88,
+	0xc2,0x88,0x78,0xfe,0x7a,0x04,0x0a,0x15,0x82,0xa0,0xff,0x87,0x1a,0xff,0x0d,0x22,
+	0x22,0x10,0x3c,0xc8,0xa0,0x88,0x9f,0xd1,0x8a,0x22,0x28,0x82,0x65,0x12,0x17,0x05,
+	0x74,0xf7,0xe7,0x88,0xa4,0x26,0x00,0x31,0xcd,0xe6,0x22,0x7d,0x23,0x35,0x00,0xae,
+	0x38,0x0b,0x00,0x47,0xb4,0x00,0xff,0x25,0x1c,0xfa,0xa2,0x62,0x16,0xc2,0x23,0xff,
+	0x46,0xc8,0xac,0x98,0xc2,0xd8,0x9c,0xd9,0xff,0x84,0xb8,0x1c,0xb9,0x94,0xb1,0x74,
+	0xe7,0xff,0xa8,0x8c,0xa9,0x64,0x88,0x99,0x89,0x74,0xff,0xf8,0xe9,0xf9,0x14,0xe8,
+	0xf9,0xe9,0x34,0xff,0xd8,0xa9,0xd9,0x04,0xb9,0x9c,0xa2,0x23,0xff,0x46,0xa8,0xaa,
+	0x81,0x6d,0xe7,0x89,0x1a,0xff,0xf2,0x23,0x46,0xf8,0xaf,0xe1,0x6c,0xe7,0xff,0xe9,
+	0xbf,0xd2,0x23,0x46,0xd8,0xad,0xc1,0xff,0x6a,0xe7,0x81,0x6b,0xe7,0xc9,0x8d,0xb2,
+	0xff,0x23,0x46,0xa1,0x68,0xe7,0xe1,0x6b,0xe7,0xff,0xb8,0xab,0xf1,0x68,0xe7,0xd1,
+	0x6a,0xe7,0xff,0xc8,0x7b,0xc9,0x24,0xc1,0x69,0xe7,0xa9,0xff,0x7b,0x89,0xa9,0xf9,
+	0xf9,0xe9,0xb9,0xd9,0xf7,0xe9,0xc9,0x99,0x23,0x00,0xb8,0xab,0xa1,0x65,0xff,0xe7,
+	0x81,0x65,0xe7,0xd8,0xab,0xd9,0x54,0xff,0xc2,0x29,0x11,0xc9,0x44,0xa9,0xab,0x82,
+	0xeb,0x69,0x11,0x6b,0x19,0xa4,0x6b,0x01,0x47,0x81,0x47,0xff,0xe7,0x21,0x5e,0xe7,
+	0x48,0x23,0x49,0xa8,0xfb,0x29,0x23,0xc3,0x04,0x61,0x00,0x41,0xb9,0xe6,0xb7,0x60,
+	0xea,0x03,0xc5,0x05,0x24,0x94,0x05,0x00,0x51,0xff,0x9a,0xe6,0x89,0x01,0x52,0x25,
+	0x61,0x1e,0xfd,0x0d,0xe5,0x02,0x08,0x41,0x1b,0xad,0x05,0x70,0xff,0xea,0x03,0xb1,
+	0x52,0xe7,0x65,0x52,0x02,0xff,0xf0,0xaa,0x11,0x60,0x97,0xc0,0xae,0xc9,0xf6,0x18,
+	0x00,0x09,0x61,0x77,0x05,0xc2,0x24,0x94,0xb0,0xff,0x3c,0x10,0xb7,0x0c,0xda,0xdc,
+	0xf3,0xd2,0xff,0x22,0x3c,0x0b,0xdd,0xd2,0x62,0x3c,0xdc,0xdd,0xed,0x46,0x03,0x15,
+	0x0c,0x01,0x46,0x27,0xe5,0x22,0xff,0xfa,0x1d,0xf0,0xe1,0x9b,0xe6,0xe2,0x1e,0xef,
+	0x65,0xe2,0x62,0x3c,0x9f,0x17,0x51,0x83,0xe6,0xff,0x0c,0x14,0x42,0x45,0x02,0x65,
+	0xc0,0xfc,0xbf,0x26,0x33,0x46,0x0e,0x43,0x3a,0x2b,0x00,0xc9,0xff,0x1b,0x0e,0x73,
+	0xe8,0x01,0x87,0x01,0xc9,0xff,0x1b,0x87,0x93,0x54,0xa2,0x42,0xf8,0xb1,0xff,0x7e,
+	0xe6,0xae,0x62,0xbc,0x1f,0xe7,0x03,0xff,0x8d,0x1b,0xc2,0x52,0x7a,0x92,0x0b,0x32,
+	0xff,0xf6,0x59,0x15,0xd2,0x0b,0x31,0x1e,0xc1,0x77,0x3b,0x00,0x27,0xfa,0x01,0xde,
+	0x71,0x0d,0x6e,0x01,0xff,0x81,0x1b,0xa5,0xfb,0x00,0x2c,0xaa,0x65,0xff,0x20,0xfd,
+	0x1d,0xf0,0xa2,0x22,0x21,0xb8,0xff,0xe2,0xc2,0x12,0x7f,0xd2,0x12,0x7e,0xe5,0xff,
+	0xf2,0xfe,0xe1,0x7e,0xe6,0x42,0x42,0xf9,0xff,0xe2,0x2e,0x2d,0xf2,0x05,0x08,0x8c,
+	0x3e,0xdf,0x8c,0x1f,0x42,0x65,0x12,0x22,0x00,0x52,0x7b,0xdc,0x59,0x00,0xbf,0x0d,
+	0x4e,0x83,0x15,0x75,0x00,0x81,0x1b,0x77,0x52,0x62,0x3a,0x1f,0x0b,0x9e,0x72,0x68,
+	0x0f,0x00,0xff,0x1d,0x1b,0x8e,0x62,0xa4,0x5e,0x80,0x01,0xff,0x8c,0x22,0x92,0x19,
+	0x65,0x82,0x62,0x3b,0xff,0x82,0x42,0xf8,0x82,0x42,0xf9,0x82,0x52,0xff,0x7d,0x82,
+	0x52,0x7e,0x92,0x62,0x3c,0x82,0xff,0x44,0x89,0x82,0x44,0x88,0x82,0x44,0x8a,0xbf,
+	0x82,0x44,0x8b,0x8e,0x84,0xd3,0xea,0x00,0x91,0xef,0x1b,0x32,0x44,0x8c,0xd7,0x14,
+	0x81,0x51,0xe6,0xf7,0x1e,0xc1,0x3a,0x9a,0x0a,0x8e,0x58,0x1b,0x01,0xf5,0x27,0xf6,
+	0x02,0x8e,0xa7,0x10,0x25,0xf1,0x00,0xa1,0x7f,0x45,0xe6,0x0c,0x09,0x92,0x6a,0x12,
+	0x7f,0x0c,0xff,0x51,0x42,0xe6,0x30,0x60,0x14,0x20,0x66,0xff,0xa0,0x42,0x66,0x36,
+	0x52,0x05,0x02,0x82,0xdf,0xd2,0x01,0xce,0x05,0x03,0x3a,0x00,0x59,0x1b,0xff,0x82,
+	0x08,0x01,0x66,0x18,0x01,0x0c,0x13,0xf7,0x30,0x20,0x74,0x9b,0x0a,0x81,0x00,0xc2,
+	0x02,0xff,0x9b,0x49,0x41,0xde,0x13,0x05,0x50,0x00,0xff,0x01,0x58,0x22,0x41,0x77,
+	0xe6,0x92,0x04,0xff,0x00,0xc9,0x31,0x31,0x44,0xe6,0x7e,0xc9,0xfd,0x06,0x82,0x00,
+	0x55,0x1b,0x62,0x45,0xc5,0x06,0xdf,0x33,0x00,0xce,0x73,0x63,0xc1,0x00,0x49,0x1b,
+	0xf7,0x5e,0x27,0x94,0x07,0x00,0xc1,0x1b,0xa8,0x41,0xff,0x66,0x1a,0x1c,0x20,0x64,
+	0xa0,0xa2,0x26,0xff,0x36,0x8c,0xba,0x81,0x23,0xe6,0x88,0xd8,0xfe,0xd6,0x07,0x09,
+	0x92,0x66,0x36,0x1b,0x44,0x40,0xff,0x40,0x74,0x66,0x44,0xe2,0x66,0x27,0x1c,0xf7,
+	0x81,0x20,0xe6,0x6f,0x00,0xdc,0x38,0x0c,0x4a,0xf3,0xbe,0x04,0x75,0x0f,0xba,0x15,
+	0x25,0x07,0xfa,0x91,0xff,0x2e,0xe6,0xa1,0x18,0xe6,0x92,0x09,0x44,0xff,0xa2,0x0a,
+	0x04,0x8c,0x99,0x66,0x1a,0x07,0xff,0xad,0x02,0xa5,0xdc,0xff,0x06,0x08,0x00,0xff,
+	0xa1,0x13,0xe6,0x81,0x12,0xe6,0xa8,0x4a,0xff,0x82,0x08,0x07,0x0e,0x2a,0xcb,0x03,
+	0x07,0xff,0x00,0xc5,0x1b,0xb7,0x1a,0x24,0x0e,0x4a,0xf7,0x1c,0x01,0x87,0x0a,0x00,
+	0xc7,0x1a,0x19,0x9c,0xff,0x43,0xd2,0x05,0xc6,0xe2,0x05,0xc7,0x6e,0xfb,0x0d,0x0f,
+	0xd3,0x08,0x8c,0x4e,0xf2,0x45,0xc6,0xff,0xf2,0x45,0xc7,0x1d,0xf0,0x66,0x18,0xe2,
+	0xff,0x92,0x05,0xc6,0x56,0xc9,0xfd,0xa2,0x05,0xff,0xc7,0x56,0x6a,0xfd,0xad,0x02,
+	0x65,0xd7,0xff,0xff,0x86,0xf3,0xff,0xc2,0x04,0x07,0xb2,0xff,0x05,0xc4,0xad,0x06,
+	0xc7,0xbb,0x01,0x0c,0xff,0x0a,0xa2,0x45,0xc5,0xc2,0x25,0x24,0xa2,0xff,0x25,0x23,
+	0x16,0x6c,0x04,0x26,0x2a,0x02,0xff,0x66,0x4a,0x40,0x6e,0x85,0x6a,0x04,0x67,0xff,
+	0x00,0x99,0x1b,0xa5,0x01,0xfd,0xd2,0x04,0xbf,0x00,0x8c,0xcd,0x6e,0x85,0x8e,0x57,
+	0x00,0x95,0xef,0x1b,0xe2,0x55,0x5b,0xed,0x03,0xe5,0xcf,0xfe,0xfe,0x2c,0x00,0xf2,
+	0x15,0x44,0xa0,0xff,0xc0,0x8e,0xff,0xa7,0x6f,0xfe,0xe1,0x02,0x1c,0x22,0xf0,0xff,
+	0xf0,0x74,0x00,0xff,0x11,0x80,0xff,0x20,0xf7,0xf2,0x63,0x6b,0x4c,0x00,0xb1,0x11,
+	0xe6,0x8c,0xff,0x9c,0x0c,0xd8,0x87,0x9a,0x05,0x62,0x45,0xff,0xc7,0xc2,0x4b,0x0c,
+	0x98,0xd5,0x07,0x69,0xff,0x22,0xc1,0xde,0xe5,0xc2,0x2c,0x52,0xdc,0xff,0x9c,0x0b,
+	0xda,0x56,0x4d,0x21,0x2c,0x4a,0xff,0xe5,0xfb,0xfc,0xe1,0x0e,0xe6,0xee,0x73,0xff,
+	0xba,0x00,0x27,0x00,0x8d,0x1b,0xe5,0x78,0xfd,0xfd,0x54,0x04,0xca,0xfd,0x16,0xaf,
+	0x0f,0x82,0xff,0xca,0xfc,0x16,0x48,0x0f,0x78,0x31,0x70,0xff,0x73,0x34,0x82,0x05,
+	0xc5,0x9c,0xc8,0x92,0xff,0x05,0xc9,0x66,0x19,0x17,0xa1,0xe6,0xe5,0xff,0xa2,0x0a,
+	0x44,0xcc,0xea,0xb2,0x04,0x00,0xdf,0xcc,0x9b,0x2e,0xa2,0x3b,0xf0,0x01,0xa5,0x1b,
+	0xff,0x25,0xd2,0xff,0xc2,0x05,0xb8,0x66,0x1c,0xff,0x72,0xb2,0x25,0x23,0xd2,0xcb,
+	0xf7,0x16,0xff,0x7d,0x1d,0xb9,0x61,0xd2,0x15,0x5b,0xe2,0xff,0x04,0x03,0xe9,0x21,
+	0xde,0x71,0x1f,0x1f,0xfd,0xe7,0x0c,0x02,0xf7,0x1e,0x17,0xc2,0x05,0xc0,0xff,0xb2,
+	0xa3,0xe8,0xc0,0xad,0xc1,0xe5,0x0f,0xff,0x02,0xe8,0x21,0xb8,0x61,0xd8,0x11,0xa7,
+	0xdf,0xae,0x02,0x86,0x6a,0x00,0xaa,0x00,0x1b,0xfd,0xff,0xf2,0x55,0x5b,0x8c,0xac,
+	0x82,0xcb,0xfa,0xff,0x16,0xf8,0x1a,0x92,0xcb,0xf8,0x16,0x99,0xef,0x1a,0x9e,0x00,
+	0x03,0x93,0x09,0x99,0x51,0x26,0x7f,0x7b,0x04,0x99,0x51,0x66,0x8b,0x1c,0x6e,0x04,
+	0xfd,0x67,0x6e,0x04,0xcb,0xff,0x2c,0x9a,0x65,0xf0,0xbf,0xfc,0x98,0x51,0xc6,0x01,
+	0x00,0x26,0x14,0xa2,0xff,0x05,0xc6,0xcc,0x6a,0xcc,0x49,0xb2,0x05,0xff,0xc7,0x16,
+	0x0b,0xdf,0xc1,0xbd,0xe5,0xc2,0xff,0x0c,0x44,0x56,0x7c,0xde,0xd2,0x05,0xc8,0xdf,
+	0x8c,0xfd,0xfe,0x45,0x4e,0x22,0x00,0x85,0x1b,0xff,0xe2,0x45,0xc8,0xf2,0x55,0x5a,
+	0xe2,0x65,0xff,0x24,0x82,0x04,0x00,0x56,0x88,0x08,0x92,0xff,0x05,0xc4,0xa2,0x04,
+	0x07,0x3e,0x30,0xeb,0xff,0x20,0x21,0x00,0x48,0x22,0xb2,0x45,0xc4,0xff,0xa0,0x99,
+	0xc0,0x90,0x36,0xb3,0xc6,0x1d,0xfd,0x00,0xf4,0x08,0xc2,0xc7,0xfe,0x56,0x4c,0xf0,
+	0xef,0x6e,0x85,0x9a,0x05,0x84,0x05,0x65,0xe9,0xfc,0xff,0xb2,0x25,0x25,0xb2,0x55,
+	0x5d,0xb0,0xc0,0xff,0xf5,0xc2,0x55,0x5e,0xbe,0xb0,0xea,0x0a,0xff,0x27,0x01,0x49,
+	0x1b,0xa5,0xeb,0xfc,0xbe,0xff,0x35,0xea,0x0b,0x27,0x01,0x89,0x1b,0xe5,0xff,0xea,
+	0xfc,0xb2,0x15,0x5e,0xc2,0x15,0x5d,0xff,0xf1,0x44,0xe6,0xe1,0x88,0xe5,0xb0,0xcc,
+	0xef,0xc0,0xc2,0x55,0x5f,0x60,0x00,0x82,0x25,0x24,0xff,0x92,0xde,0x01,0xba,0xaa,
+	0xa2,0x55,0x5e,0xff,0xd2,0x1e,0x6c,0x82,0x49,0x0c,0x82,0x5e,0xff,0x6d,0xfe,0x73,
+	0xbd,0xa0,0x21,0x00,0x8c,0x7f,0x22,0xd2,0x5e,0x6c,0x06,0xa8,0xff,0x36,0x02,0xff,
+	0x30,0x30,0x74,0xd0,0x36,0x93,0x0b,0xe3,0xff,0x56,0x4e,0xd3,0xf1,0x76,0xe5,0xf2,
+	0x2f,0xff,0x52,0x41,0x7b,0xe5,0x56,0x2f,0x04,0xae,0xfb,0x00,0x0b,0xec,0x02,0xa1,
+	0x1b,0x1e,0xc1,0x38,0xfe,0x68,0x09,0x8e,0x71,0x09,0x80,0x00,0x02,0x80,0xff,0x22,
+	0x6e,0x79,0x2d,0x00,0x47,0x01,0x81,0x6f,0x1b,0xe5,0xba,0x00,0x7c,0x17,0xee,0x54,
+	0x2a,0x00,0xfa,0x7c,0x03,0xee,0x7c,0x13,0x65,0xb9,0x00,0x0c,0x6a,0xff,0xe5,0x5b,
+	0xfd,0xf2,0x04,0x32,0xb6,0x5f,0xff,0x02,0x06,0x37,0xff,0x81,0x63,0xe5,0x82,0x7f,
+	0x28,0x42,0x0b,0x88,0x56,0x18,0xcd,0x33,0x14,0xaf,0x9e,0x54,0x1b,0x00,0xb0,0x07,
+	0x9e,0xb0,0x17,0xb6,0xff,0x00,0xc6,0x2c,0xff,0xc2,0xca,0xfb,0x56,0xff,0xac,0xdf,
+	0x2c,0x5a,0x25,0xda,0xfc,0xd1,0xd7,0x84,0xe5,0xde,0x1a,0x02,0xa7,0x1a,0x02,0x65,
+	0x57,0xaf,0xfd,0x46,0x78,0xff,0x82,0x05,0x87,0x39,0x00,0xe5,0x7f,0xb2,0xff,0x0c,
+	0x09,0x8e,0xe9,0xf3,0x46,0x00,0xff,0x45,0x1b,0x6e,0x85,0x8a,0x00,0x07,0x02,0xff,
+	0x99,0x1b,0xa0,0xac,0x20,0xa2,0x65,0x24,0xff,0xa0,0xa0,0xf4,0x65,0x5d,0xfc,0xc1,
+	0x59,0xff,0xe5,0xb1,0x03,0xe6,0xa0,0x30,0x74,0xbe,0xaf,0x7c,0xba,0x04,0x87,0x3f,
+	0x04,0xd5,0x40,0x01,0x23,0x77,0x2e,0xef,0xf9,0xa5,0x00,0x45,0x1b,0x00,0xe3,0x03,
+	0x7f,0x41,0x00,0x1c,0xaa,0xe5,0xd3,0xfc,0xef,0x0b,0xff,0x41,0x00,0x41,0x8a,0xe5,
+	0x48,0x04,0x0c,0xff,0x06,0x69,0x02,0x8c,0x84,0x52,0x14,0x7a,0x7f,0x8c,0x35,0x59,
+	0x02,0x62,0x54,0x7a,0x1b,0x10,0xdf,0x30,0x41,0x21,0x8e,0x01,0xe6,0x0d,0x80,0x00,
+	0xff,0xf3,0xa6,0x14,0x1d,0x26,0x14,0x04,0x3d,0xff,0xf0,0x76,0xa4,0x15,0xc4,0x02,
+	0x08,0x8e,0x7f,0xb0,0x73,0x06,0x02,0x05,0x84,0x30,0x07,0x10,0xbf,0x38,0x94,0x22,
+	0x09,0x1d,0xf0,0x33,0x00,0x2c,0xbf,0x08,0x4e,0x88,0x5a,0x03,0xe7,0xab,0x00,0x4e,
+	0xbb,0xaa,0x56,0xed,0x08,0x8e,0xba,0x59,0x21,0x09,0x8e,0xff,0x99,0x17,0x1f,0xe7,
+	0x1e,0xc5,0x1b,0x8e,0xdf,0xb8,0x59,0x06,0x22,0x07,0x39,0x00,0x77,0x16,0xff,0x06,
+	0x22,0x04,0xc4,0x30,0x8e,0xb2,0x27,0xff,0x07,0x02,0x06,0x80,0x30,0x3e,0x51,0x20,
+	0xff,0x03,0x05,0x02,0xac,0x1a,0xa6,0x15,0x2d,0xfb,0x26,0x15,0x67,0x04,0xa5,0x25,
+	0xc4,0x02,0x38,0xfe,0x5f,0x04,0x80,0x05,0x84,0x20,0x8e,0xb0,0x76,0xe7,0x07,0x22,
+	0x03,0x6f,0x04,0x07,0x08,0x38,0x3e,0x81,0xff,0x30,0x07,0x02,0x02,0x5c,0x3a,0x94,
+	0x22,0xfd,0x39,0x77,0x08,0x31,0x06,0xe5,0x21,0xc7,0xe5,0xff,0x81,0xc5,0xe5,0x82,
+	0x63,0x10,0x22,0x63,0xcd,0x13,0x13,0x08,0x0c,0x02,0xc8,0x00,0x07,0x00,0x21,0x03,
+	0xff,0xe5,0x88,0x82,0xb1,0xc1,0xe5,0xae,0x04,0xfd,0x0c,0xcc,0x08,0xe0,0x08,0x00,
+	0x1c,0x0a,0xa0,0xef,0xe3,0x13,0x88,0x92,0x09,0x00,0xe1,0x0f,0xe5,0xff,0xa1,0x1c,
+	0xe5,0x98,0x6e,0x7e,0x89,0x0c,0xfe,0xf3,0x01,0x55,0x1b,0xc0,0x20,0x00,0xb2,0x2a,
+	0xff,0x93,0x91,0xb6,0xe5,0xd1,0x36,0xe5,0x07,0xff,0xeb,0x73,0xc2,0x69,0xa8,0x81,
+	0xb4,0xe5,0xce,0x14,0x00,0xf2,0x2d,0x88,0xe1,0x03,0x08,0x04,0x6d,0x88,0x7f,0x98,
+	0x4e,0x9c,0x09,0x90,0xf0,0xe4,0x2a,0x04,0xef,0x2d,0x88,0xf0,0xbb,0x15,0x04,0xb2,
+	0x6d,0x88,0xdf,0xd1,0x23,0xe5,0x91,0x08,0x2a,0x04,0xc2,0x6a,0xef,0x91,0xf2,0xa1,
+	0x00,0x1d,0x30,0x82,0x0e,0x14,0xf6,0x3c,0x04,0x29,0x81,0x45,0x10,0x69,0x81,0x0c,
+	0x9d,0xbe,0x07,0x00,0xd2,0x69,0x80,0x0c,0x0b,0x21,0x04,0x6a,0xef,0x8f,0x82,0xa0,
+	0x76,0x08,0x00,0x82,0x69,0x83,0xee,0xb7,0x14,0xae,0x10,0x0b,0x1f,0x02,0xa1,0x1b,
+	0xa5,0xff,0x9d,0xf9,0x21,0xce,0xe4,0x81,0x94,0xe5,0xff,0x91,0x93,0xe5,0x99,0x3a,
+	0x89,0x0a,0x22,0xbf,0x22,0x49,0xa9,0x52,0x2d,0x0a,0xe3,0x08,0x81,0xfd,0x06,0x71,
+	0x04,0x82,0x28,0x84,0x67,0x68,0x02,0xdf,0xe5,0x27,0xfd,0x91,0xe8,0x95,0x04,0x81,
+	0xc7,0x3f,0xe4,0x88,0xd8,0x92,0x29,0x84,0xde,0x00,0xca,0x05,0xfe,0x4b,0x04,0x51,
+	0x87,0xe5,0x41,0x85,0xe5,0x3e,0xfb,0xfa,0x46,0x32,0x02,0x1d,0x1b,0x88,0x05,0xad,
+	0xf9,0x02,0x1c,0x00,0x2a,0x00,0xa2,0x23,0x81,0x60,0xaa,0xee,0x90,0x04,0xa2,0x63,
+	0x81,0x05,0x00,0x92,0x24,0x58,0xbf,0x90,0x90,0x44,0x56,0xd9,0xfd,0x37,0x0c,0x01,
+	0xff,0x01,0x7d,0x03,0x61,0xaf,0xe4,0x32,0x02,0xff,0x00,0xa1,0x78,0xe5,0x6e,0x46,
+	0x9c,0x0a,0xff,0x87,0x00,0x89,0x1b,0x30,0x4c,0xd1,0xaa,0xcf,0xa4,0x6e,0x46,0xbb,
+	0x4b,0x01,0xbb,0x02,0xfb,0x01,0xff,0x98,0xb2,0x49,0x91,0x3e,0x71,0x85,0x01,0xdd,
+	0xe7,0x0e,0x00,0x7e,0xf9,0x4e,0xe4,0x01,0x55,0x1b,0xff,0x0b,0x89,0xbe,0xd8,0x4a,
+	0x3e,0x41,0x02,0xff,0x54,0x22,0x16,0x3a,0x4d,0xb2,0xc9,0xfe,0xff,0x16,0x7b,0x4d,
+	0xc2,0xc9,0xfc,0x16,0x1c,0xff,0x4d,0x0c,0x04,0x0c,0x0a,0xae,0x71,0xcd,0xf6,0x3b,
+	0x08,0x5e,0x6a,0x8f,0x01,0x01,0x59,0x1b,0xa2,0xff,0x26,0x15,0x38,0x81,0xa0,0xa3,
+	0x90,0xa2,0xff,0x0a,0x00,0x3e,0x33,0xff,0x5e,0x01,0x02,0xff,0xac,0x22,0x56,0x7f,
+	0x4b,0x88,0x46,0x88,0xef,0x48,0xa2,0x02,0x30,0xa6,0x00,0xa9,0xf1,0x4e,0xfb,0x8a,
+	0x7e,0x56,0x00,0xc1,0x1b,0x86,0x36,0x01,0xff,0xb2,0x26,0x15,0x3a,0xbb,0xa2,0x4b,
+	0x00,0xff,0xe0,0xaa,0x11,0x00,0x1a,0x40,0x00,0xd5,0xef,0xa1,0xe0,0xdd,0x30,0xb8,
+	0x00,0xc1,0xc5,0xe4,0xbf,0xb2,0x2c,0x89,0xd0,0xbb,0x10,0x4b,0x05,0x6c,0xf7,0x89,
+	0x98,0xc2,0x1c,0x04,0x99,0xa1,0x92,0x61,0xff,0x10,0x06,0x01,0x00,0xd2,0x61,0x10,
+	0xc9,0xbf,0xf1,0x49,0xb1,0xde,0x64,0x0d,0x6f,0x30,0x01,0xb7,0x3e,0x33,0xf8,0x6f,
+	0x0c,0x58,0x45,0x6f,0x0c,0x34,0xfe,0x6f,0x04,0xe1,0xb6,0x8a,0x02,0xc6,0x1b,0x01,
+	0xff,0xc2,0x26,0x15,0xbd,0x0a,0x3a,0xcc,0xb2,0xff,0x4c,0x01,0xe0,0xba,0x11,0x00,
+	0x1b,0x40,0xb7,0x8e,0xf5,0x1e,0xc1,0x0a,0xe0,0xff,0x71,0x04,0xd1,0x7f,0xa8,0xe4,
+	0xc2,0x2d,0x89,0xf0,0xcc,0x71,0x04,0xff,0xc2,0x6d,0x89,0xa8,0xd2,0x92,0x21,0x10,
+	0x7e,0x24,0x00,0x00,0xaa,0xa1,0xa0,0x99,0x20,0x77,0x00,0xff,0x46,0x00,0x00,0xd9,
+	0xe1,0xd8,0x62,0xf8,0xff,0x92,0xa8,0x42,0xb8,0xb2,0xc8,0x52,0x98,0xff,0xc1,0x88,
+	0xb1,0x38,0x82,0x70,0x99,0x01,0xff,0x90,0x88,0x01,0x70,0x33,0x11,0x50,0xcc,0xff,
+	0x11,0xc0,0xbb,0x01,0x20,0xaa,0x11,0x90,0xff,0xff,0x11,0xc0,0xdd,0x11,0xf0,0xdd,
+	0x20,0xff,0xb0,0xaa,0x20,0x30,0xcc,0x20,0x90,0x88,0xff,0x20,0x32,0x02,0x50,0x98,
+	0x72,0xb2,0x02,0xff,0x39,0xe0,0x43,0x01,0xf0,0x99,0x11,0xe0,0xff,0x5b,0x30,0x90,
+	0x9b,0x20,0xb1,0x51,0xe4,0xbf,0xd0,0x99,0x20,0xc0,0x99,0x20,0x5b,0x00,0xc2,0xfb,
+	0x02,0x51,0x25,0x00,0x92,0x02,0x38,0xf0,0xac,0xff,0x01,0xa0,0x44,0x20,0x80,0x44,
+	0x20,0x82,0xff,0x02,0x52,0x9c,0x09,0xd2,0x07,0x09,0xa2,0xff,0x07,0x08,0x50,0xdd,
+	0x01,0x40,0xaa,0x01,0xf7,0xd0,0xaa,0x20,0x19,0x00,0x50,0x54,0x10,0xd1,0xff,0x0b,
+	0xe5,0x80,0x45,0x93,0x58,0x32,0x16,0x7f,0xd9,0x08,0xcc,0x13,0x16,0x8c,0x08,0xab,
+	0x00,0xff,0x0c,0x08,0x89,0x01,0x9c,0x03,0xa8,0x17,0x7f,0xc8,0x0a,0xa8,0x2a,0xc0,
+	0xaa,0xc0,0x11,0x00,0xff,0xa9,0x01,0x86,0x0f,0x00,0x00,0xbc,0xac,0xff,0xc8,0xcb,
+	0xac,0x8c,0x0c,0x09,0xce,0x47,0xf7,0x0e,0x00,0x27,0x9d,0x01,0x76,0xae,0x16,0xb0,
+	0xff,0xf9,0xb0,0xa8,0xcf,0xc0,0x89,0xb0,0xda,0xff,0xaa,0xa9,0x08,0xf8,0xdf,0x1b,
+	0x99,0x90,0x3f,0x90,0x74,0xda,0xff,0xf9,0x18,0xa0,0x00,0x7d,0x00,0xff,0xc8,0x07,
+	0xe8,0x0c,0xc8,0x2c,0xe0,0xcc,0xde,0x41,0x04,0xc9,0x01,0xc1,0xf2,0x78,0x06,0xf8,
+	0x01,0xb7,0xf0,0xf2,0x41,0x07,0x00,0xf9,0x01,0x04,0x00,0xe8,0xf7,0x01,0x0b,0xee,
+	0x06,0x00,0xe9,0x01,0x16,0xd3,0xed,0x2f,0x07,0x00,0xa8,0x01,0x79,0x00,0xd1,0xc0,
+	0xaa,0xff,0x20,0xa9,0xa1,0xc6,0x02,0x00,0x0c,0x0e,0xf7,0xee,0x71,0xdc,0x05,0x0a,
+	0xc9,0xa1,0xa8,0x81,0xff,0x69,0x61,0xe0,0xea,0x11,0x60,0xaa,0xa0,0xdf,0xa9,0x51,
+	0x16,0x39,0x1d,0xa3,0x04,0x0f,0xf9,0xf5,0x11,0x46,0x04,0x21,0x04,0x04,0x31,0x69,
+	0x61,0xc2,0xff,0x17,0x05,0x92,0x61,0x13,0x79,0x71,0xf6,0xff,0x3c,0x02,0x06,0x9f,
+	0x00,0x88,0xcb,0x69,0xff,0x61,0x16,0x68,0x2c,0x68,0x6b,0x62,0x61,0xff,0x14,0xfd,
+	0x06,0x9e,0x2c,0x1b,0x1e,0xc7,0xfc,0x72,0x02,0x20,0x08,0xc0,0xe1,0x41,0xda,0xa6,
+	0x88,0xff,0x17,0x61,0xcf,0xe4,0x82,0x61,0x12,0xb0,0xff,0xaa,0x10,0xce,0x8c,0x3b,
+	0x01,0x07,0x01,0xfb,0xa5,0x1b,0x5c,0x01,0xbe,0x47,0x0e,0xde,0xe1,0xbf,0x02,0x80,
+	0x22,0xae,0x71,0x1c,0x05,0x02,0x81,0xff,0x1b,0x6e,0x6f,0x2a,0x1e,0xe1,0x03,0xac,
+	0xff,0x22,0x76,0x98,0xe9,0xdd,0x0f,0xc7,0x3e,0xd7,0x04,0x78,0x0b,0xb1,0x01,0x78,
+	0xff,0x07,0x79,0x11,0xff,0xc7,0x3e,0x07,0x92,0x21,0x12,0x98,0x09,0xf4,0x3b,0x02,
+	0x07,0x04,0x19,0x14,0x00,0x99,0x21,0xcc,0x63,0xff,0x92,0x02,0x51,0x16,0x89,0x04,
+	0x9c,0x33,0xf6,0x0e,0x00,0x88,0x31,0x04,0x00,0x98,0x21,0x90,0x88,0xfd,0xa0,0x07,
+	0x00,0x89,0x21,0xc6,0x04,0x00,0x9c,0xe5,0x09,0x16,0x18,0x11,0x16,0x10,0xc3,0x04,
+	0x88,0x31,0xe7,0x3d,0x98,0x19,0x04,0x0c,0x09,0x99,0x31,0xf7,0x00,0x11,0x08,0xd3,
+	0x1b,0x88,0x1d,0x04,0x2a,0x04,0x88,0x22,0x04,0x89,0x0d,0xdc,0x4b,0x08,0x04,0x00,
+	0x9e,0x7d,0x19,0xcb,0x00,0x81,0x1b,0xf7,0xce,0xaa,0x78,0xa3,0x00,0x61,0x1b,0x9e,
+	0x96,0x7f,0x68,0x01,0x07,0x00,0xad,0x1b,0x80,0xfb,0x01,0xfe,0x82,0x00,0x2d,0xc6,
+	0x03,0x00,0x98,0x71,0x72,0xff,0x21,0x11,0x92,0x09,0x0c,0x90,0x78,0x83,0xfa,0xaa,
+	0x04,0x2d,0x04,0x00,0x49,0x3d,0xc7,0x1e,0x02,0xbf,0xc7,0x9a,0x0f,0x92,0x02,0x39,
+	0x52,0x04,0x3d,0xf4,0x1d,0x02,0x55,0x04,0x3d,0x04,0x00,0x5e,0x7d,0x4f,0xe4,0xff,
+	0x81,0x00,0x80,0x22,0x6e,0x46,0x4c,0x80,0xff,0x21,0x01,0x60,0x22,0x78,0x71,0xb1,
+	0xbf,0xff,0xe3,0x62,0x21,0x14,0x92,0x21,0x13,0xa8,0xff,0xbb,0xd1,0x84,0xe4,0x38,
+	0x51,0xcc,0x4a,0xff,0xc2,0x2b,0x44,0x16,0x1c,0x06,0xa1,0x84,0xbf,0xe4,0x6e,0xb6,
+	0x3c,0x02,0x47,0x2c,0x01,0x25,0x7f,0x59,0xf9,0xd1,0xb5,0xe3,0xd8,0xbd,0x3f,0x00,
+	0xff,0xf1,0x7e,0xe4,0x98,0x17,0xb8,0x32,0xd9,0xff,0x4f,0xc8,0x09,0xd0,0xbb,0xc0,
+	0xc0,0xbb,0x6e,0xd6,0x04,0xb9,0x1f,0xa8,0x10,0x05,0xa9,0x16,0xd7,0x08,0xff,0xd1,
+	0x73,0xe4,0x99,0x66,0xde,0xe6,0x28,0xf7,0x1e,0xc7,0x1f,0xa7,0x00,0xee,0x10,0xfe,
+	0x6f,0x6d,0x38,0x71,0x09,0x80,0xee,0x84,0x04,0xe9,0x2f,0x29,0x02,0xff,0xc6,0x00,
+	0x00,0x3d,0x0a,0x68,0x6a,0xe1,0xff,0xdc,0xe3,0xa1,0x6b,0xe4,0xc8,0xa2,0xf8,0xff,
+	0xc1,0xb8,0xb1,0xc0,0xcc,0x01,0x50,0xff,0xff,0x11,0x60,0xbb,0x11,0xf0,0xbb,0x20,
+	0xc0,0xff,0xbb,0x20,0x9c,0x09,0x92,0x02,0x3c,0x82,0x7f,0x02,0x3b,0x10,0x99,0x01,
+	0x20,0x88,0x21,0x03,0xff,0x20,0x80,0xbb,0x20,0x98,0x91,0xf8,0x12,0xfb,0xaa,0x99,
+	0x43,0x00,0xf2,0x69,0x80,0xc8,0x22,0x76,0x64,0x07,0x69,0x82,0x05,0x00,0x42,0x69,
+	0x86,0x05,0x00,0xf7,0x52,0x69,0x87,0xea,0x04,0xe1,0xa8,0xf1,0xb2,0xff,0x69,0x90,
+	0x90,0xaa,0x11,0x50,0x88,0x11,0xdd,0xa0,0xf5,0x08,0x82,0x69,0x91,0x87,0x06,0xd1,
+	0xf2,0xfb,0x69,0x92,0x07,0x00,0xc8,0xa1,0xc2,0x69,0x94,0xbf,0xa2,0x02,0x38,0xde,
+	0xb6,0x2c,0x9f,0x08,0xc0,0x5f,0xbb,0x10,0xde,0x0a,0x0c,0x52,0x01,0x55,0x0a,0x00,
+	0xee,0x2e,0x04,0xb2,0x69,0x84,0x05,0x00,0xa2,0x21,0x10,0xef,0x92,0x2e,0x89,0xa0,
+	0x64,0x09,0x88,0x61,0x88,0xff,0x48,0x88,0x58,0x92,0x6e,0x89,0xad,0x02,0xff,0xe0,
+	0x08,0x00,0xb2,0x22,0x15,0xc2,0x22,0xbf,0x16,0xc9,0xa3,0xbe,0x73,0xe2,0xac,0x0a,
+	0x1d,0xff,0xf0,0x68,0x51,0x68,0x66,0x06,0x61,0xff,0xdf,0x0c,0x04,0x3e,0xb6,0xfa,
+	0xe8,0x00,0x45,0x1b,0xb7,0x2e,0xbc,0xf4,0x07,0x08,0xee,0xfc,0x07,0x0c,0xae,0xfb,
+	0x71,0xf8,0x2a,0x08,0x82,0x61,0x10,0x46,0xe2,0xff,0xfe,0xa9,0xe1,0x46,0xfe,0xfe,
+	0xe2,0x02,0xb7,0x51,0xcc,0x5e,0xd3,0x02,0xd1,0x46,0x00,0x0e,0x01,0xff,0xc0,0x88,
+	0x20,0x89,0xd1,0x0c,0x0a,0xa9,0xff,0xa1,0x46,0x40,0xff,0x62,0x26,0x16,0x6a,0xff,
+	0x6e,0x68,0x06,0x06,0x4c,0xff,0x0c,0x22,0xff,0x1d,0xf0,0x00,0x36,0x41,0x00,0xc1,
+	0x53,0xff,0xe3,0xc2,0x2c,0x4a,0xd1,0x19,0xe4,0x00,0xdf,0x12,0x40,0xce,0x5c,0x1b,
+	0xae,0x00,0x61,0x1b,0x7f,0x8e,0xbb,0x1c,0x92,0x01,0x00,0xc4,0x07,0x05,0xff,0x82,
+	0x2d,0x68,0xee,0x19,0x4a,0x0a,0x87,0xff,0x00,0x1d,0x1b,0x20,0xaa,0xd1,0x87,0x8b,
+	0xff,0x02,0x86,0x27,0x00,0xee,0xaa,0x2e,0x00,0xf3,0x07,0x03,0xe0,0x00,0x2e,0x01,
+	0x2a,0x90,0xe0,0xff,0xbe,0xc9,0x04,0xf2,0x6a,0x90,0x92,0x1c,0x6f,0x04,0xc2,0xff,
+	0x2a,0x90,0x9e,0x2c,0x79,0x3e,0xe1,0x02,0xff,0x60,0x22,0x56,0xe9,0xfe,0xa1,0x79,
+	0xe3,0xfe,0x13,0x00,0xfe,0x4d,0x88,0x1f,0xe7,0x1e,0x8d,0xff,0x1b,0x80,0x8b,0x30,
+	0x80,0xcb,0x11,0xf0,0x6f,0xf8,0x10,0xf0,0xfc,0x33,0x08,0x6d,0x68,0x15,0x05,0xeb,
+	0x6d,0x50,0x05,0x08,0x56,0x05,0x00,0x92,0x2d,0x46,0xdf,0x80,0x99,0x10,0x90,0x9c,
+	0x1d,0x04,0x92,0x6d,0xfd,0x46,0x23,0x04,0x2d,0x4c,0x80,0xff,0x10,0xf0,0xdd,0xcc,
+	0x11,0x04,0xc2,0x6d,0x4c,0x17,0x04,0x2a,0x81,0xdd,0xe0,0x3c,0x09,0x92,0x6a,0x81,
+	0xa0,0x08,0x58,0x1c,0xff,0xff,0x87,0x0f,0x09,0x81,0xea,0xe3,0x88,0xb7,0x08,0x0c,
+	0x0a,0x46,0x01,0x0c,0x02,0xd9,0x00,0x00,0xbe,0xdb,0x04,0x31,0xe5,0xe3,0x88,0x63,
+	0x5a,0x09,0x2d,0xff,0x0a,0xbe,0x04,0x0a,0x02,0x07,0x00,0xa1,0xff,0x1b,0xa5,0x2f,
+	0xf9,0x91,0x5c,0xe3,0xc1,0xff,0xe6,0xe3,0xb8,0x42,0x4d,0x0a,0xa2,0x62,0xff,0x16,
+	0xe1,0xe3,0xe3,0xa1,0xe4,0xe3,0xd8,0xff,0x1b,0xe9,0x0b,0xd9,0x03,0xc9,0x7b,0xa9,
+	0xff,0x1b,0x92,0x09,0x00,0xec,0x59,0x51,0x25,0xff,0xe3,0x0c,0x03,0xa2,0x15,0xa6,
+	0xa0,0xaa,0xbf,0xa0,0x2e,0xaa,0xfb,0x00,0x47,0x15,0x03,0xe5,0xff,0x27,0xf9,0x40,
+	0x83,0xa0,0xae,0x78,0x03,0xfb,0x60,0x20,0xe2,0x02,0x30,0x30,0x74,0x66,0x43,0xfd,
+	0xdd,0x67,0x18,0x02,0xe3,0x32,0x23,0x48,0x81,0xff,0xc9,0xe3,0x21,0xd3,0xe3,0x48,
+	0x43,0x49,0xf7,0x68,0x29,0x43,0x5b,0x05,0x61,0x00,0x71,0xfc,0xff,0xe2,0x21,0x16,
+	0xe3,0x62,0x27,0x49,0x31,0xff,0xfd,0xe2,0x51,0x00,0xe3,0x6e,0x46,0x44,0xba,0x5e,
+	0x01,0x81,0x37,0x05,0xb2,0x22,0x90,0xdc,0x06,0x01,0xfc,0x0f,0x06,0x0a,0x08,0xb2,
+	0x05,0x30,0xa9,0x01,0xa2,0xcf,0x27,0x5b,0xaa,0x9b,0x80,0x00,0xb6,0x09,0x97,0x58,
+	0xff,0x34,0x82,0x23,0x1a,0x66,0x18,0x15,0x0c,0xff,0x09,0x92,0x63,0x1a,0x25,0x50,
+	0xf9,0x4e,0xff,0x77,0xda,0x09,0x07,0x00,0x8d,0x1b,0xe5,0xfb,0x3e,0xfc,0x2d,0x00,
+	0xa2,0x03,0x09,0xe1,0xb8,0xff,0xe3,0xf2,0x27,0x5b,0x66,0x1a,0x46,0xad,0xff,0x06,
+	0xa5,0x0f,0x00,0x0c,0x0a,0xe5,0xa8,0x7f,0xfe,0xc6,0x1e,0x00,0xc2,0x0a,0x03,0x3f,
+	0x00,0xff,0xb8,0x01,0xc7,0x5b,0x70,0x6e,0xa6,0x3b,0xfb,0x01,0x27,0x1e,0x03,0xe5,
+	0x0d,0x00,0xd1,0xf1,0xff,0xe2,0xd2,0x0d,0x44,0x92,0x03,0x05,0x16,0x7f,0xed,0x06,
+	0x0c,0x3a,0xbe,0x0e,0x0c,0x36,0x02,0xdf,0xa1,0x1b,0xde,0x00,0x0e,0x07,0x08,0x25,
+	0x30,0xff,0xf9,0x46,0x10,0x00,0xba,0xff,0xf2,0x0f,0xff,0x00,0xe2,0x0e,0x4e,0x00,
+	0x1f,0x40,0x00,0xef,0xa4,0xa1,0xec,0xde,0x5d,0x05,0x22,0x8e,0x7c,0xbf,0xfc,0xc0,
+	0xca,0x30,0x87,0x0a,0xc0,0x0a,0x22,0xd9,0x8e,0xd4,0x02,0x08,0x04,0x62,0x8e,0x80,
+	0x05,0x22,0x8f,0xfe,0xc6,0x0e,0x92,0x62,0x8f,0x86,0x00,0x00,0x65,0xeb,0xea,0xfc,
+	0x0b,0x00,0x98,0xd3,0x04,0x81,0xc2,0xe2,0xdf,0x88,0xd8,0x92,0x62,0x93,0x79,0x01,
+	0x1d,0xf0,0xff,0x16,0x79,0xfe,0x65,0xe2,0xfc,0x0c,0x2a,0xff,0x65,0xb1,0xfc,0x42,
+	0x45,0x08,0x4e,0x83,0xe7,0x7a,0x01,0x27,0x04,0x01,0x82,0x38,0x28,0xf9,0x86,0xfb,
+	0xef,0xff,0x4f,0x0d,0x41,0xb5,0xe2,0x42,0x04,0xff,0x32,0x0b,0x44,0xf6,0x44,0x1f,
+	0x58,0x42,0xff,0x91,0xab,0xe2,0x26,0x05,0x17,0x92,0x29,0xaf,0x57,0x90,0x93,0xa0,
+	0x5f,0x04,0x09,0x04,0x00,0x5e,0xfb,0x79,0x08,0x50,0x02,0x81,0x1b,0x89,0x42,0x1d,
+	0xfd,0xf0,0x2f,0x00,0x21,0xa2,0xe2,0x61,0xbc,0xe2,0xff,0x82,0x22,0x5b,0x3a,0x88,
+	0x82,0x08,0x00,0xf7,0x8e,0xb8,0x57,0x1b,0x03,0x85,0x1b,0x8e,0x77,0x7d,0x1a,0x24,
+	0x00,0xc5,0x1b,0xa0,0xa7,0x30,0xa3,0x04,0xef,0x26,0x8c,0xa0,0x99,0xbb,0x04,0x92,
+	0x66,0x8c,0x6e,0xd8,0x04,0x26,0x93,0x70,0xc3,0x0f,0x66,0x93,0xe2,0x07,0xef,0x26,
+	0x8d,0x70,0x55,0x0e,0x04,0x52,0x66,0x8d,0xdf,0x42,0x22,0x57,0x40,0x43,0x6a,0x04,
+	0x62,0x22,0xff,0x59,0x52,0x22,0x6e,0x72,0x22,0x6e,0x3a,0xff,0x66,0x70,0x55,0x90,
+	0x60,0x55,0xa0,0x52,0xff,0x05,0x00,0x22,0x22,0x5a,0x4e,0x44,0x06,0xfb,0x1e,0xc7,
+	0x7c,0x00,0x60,0x55,0x10,0x5a,0x22,0x3b,0x28,0x02,0x28,0x00,0x2e,0x74,0x02,0xb0,
+	0x13,0xbf,0x0c,0xff,0x51,0x7e,0xe2,0xa2,0x25,0x49,0x28,0x04,0xff,0xa8,0x4a,0xee,
+	0xe3,0x0b,0x7e,0xe0,0x02,0xff,0x54,0x22,0x16,0x3b,0x15,0x0e,0x23,0xac,0xff,0x7e,
+	0xa0,0x02,0xc4,0x22,0x16,0x0c,0x15,0xff,0x66,0x43,0x1b,0x82,0x25,0x31,0x2e,0xa2,
+	0xdc,0x9d,0x0d,0x24,0x01,0x86,0x02,0x00,0x0d,0x00,0x00,0x47,0xfa,0x0d,0x04,0x0c,
+	0xc0,0x0a,0xc1,0x74,0xe2,0x92,0x25,0xff,0x5b,0xb2,0x0c,0x32,0x2a,0x99,0x9e,0x59,
+	0xff,0x0b,0x7e,0xe1,0x02,0x80,0x22,0xf6,0x4b,0xff,0xe5,0xb8,0x4a,0x66,0x0b,0x11,
+	0xd2,0x25,0xb7,0x57,0xd0,0xd2,0x9f,0x04,0xd8,0x0d,0x04,0x08,0xd9,0xef,0x4a,0x3e,
+	0x65,0x2f,0x91,0x00,0x1d,0x1b,0x8e,0xff,0xb9,0x5e,0x1f,0xe7,0x1f,0x85,0x1b,0x9e,
+	0xf3,0x79,0x2a,0x68,0x02,0x0f,0x00,0xaa,0x1d,0x02,0x47,0x7b,0x00,0xc5,0x70,0x06,
+	0x82,0x29,0x81,0xa0,0xef,0x0c,0xfb,0x69,0x81,0x55,0x00,0x26,0x1b,0x75,0x26,0x4b,
+	0xbf,0x72,0x26,0x2b,0x02,0x66,0x3b,0x7d,0x0a,0x29,0xf7,0x80,0xa0,0xbb,0xe1,0x09,
+	0x69,0x80,0x82,0x25,0xb7,0x57,0x80,0x82,0x5e,0x04,0x88,0x08,0x04,0x00,0xd9,0xfd,
+	0x08,0x2d,0x00,0xb2,0xcb,0xfd,0x56,0x8b,0xf6,0xff,0x82,0x23,0x3c,0x4b,0x88,0xf0,
+	0x88,0x10,0xff,0xc6,0xff,0xff,0x82,0xc8,0xfc,0x56,0x98,0xf7,0xff,0xe0,0xda,0x58,
+	0x05,0xc2,0x29,0x80,0xd0,0xfd,0xcc,0x58,0x05,0xc2,0x69,0x80,0x86,0xd0,0xff,0xff,
+	0xbd,0x02,0xe5,0xe6,0xff,0x91,0x12,0xe3,0xff,0x92,0x09,0x4e,0xc2,0x25,0x31,0x56,
+	0x69,0xfd,0xf2,0xe6,0x18,0x0c,0x00,0xc6,0xc8,0xff,0xe0,0xcb,0x8a,0x30,0x6f,0x0c,
+	0x80,0x48,0x0e,0x6f,0x50,0xfc,0x56,0x77,0x8b,0xef,0xc2,0x6f,0x00,0xcc,0xf0,0xcc,
+	0x6f,0x04,0xbf,0xc2,0xcc,0xfc,0x56,0x9c,0xff,0xa8,0x30,0x46,0x7d,0xb5,0x6c,0x00,
+	0x25,0xe0,0xff,0x46,0xb3,0x07,0x00,0xbf,0xa5,0xdc,0xff,0x46,0xb1,0xff,0x8b,0x07,
+	0x23,0xff,0xe2,0xa1,0x5c,0xe2,0xd1,0x38,0xe2,0xe1,0xdb,0x39,0xe2,0x27,0x00,0xe2,
+	0x6d,0xde,0x05,0xe2,0x6d,0xf7,0x8d,0x0c,0x0c,0xa2,0x04,0x6d,0x8c,0xb2,0xa2,0xde,
+	0x5e,0x07,0x92,0x2a,0x89,0xb0,0xba,0x0a,0x88,0x83,0x7f,0x92,0x6a,0x89,0xbe,0xe7,
+	0x2a,0x03,0x2f,0x05,0xfe,0x89,0x01,0xa1,0x2f,0xe2,0xa0,0xe3,0x13,0x88,0xbe,0xb9,
+	0x06,0x7c,0xf9,0x9e,0x72,0x42,0xd7,0x29,0xae,0xef,0x14,0x0b,0x00,0x47,0xab,0x02,
+	0x65,0xeb,0xf8,0xff,0x21,0x05,0xe2,0x81,0xdb,0xe2,0x91,0xda,0xff,0xe2,0x99,0x3a,
+	0x89,0x0a,0x22,0x22,0x49,0xef,0xa9,0x42,0x2d,0x0a,0x8b,0x0a,0x61,0xff,0xe1,0xff,
+	0x91,0x2c,0xe2,0x52,0x26,0x49,0x81,0x14,0xff,0xe2,0x71,0xd4,0xe2,0x50,0x52,0xa0,
+	0x28,0xff,0x05,0xdc,0x74,0x52,0xc7,0x10,0x5a,0x33,0xff,0x32,0x03,0x00,0x2c,0x86,
+	0x67,0x93,0x2f,0xbf,0x0c,0x32,0x2e,0x89,0xd2,0x01,0x58,0x0c,0x66,0xff,0x14,0x2e,
+	0x41,0xcb,0xe2,0x40,0xa3,0xb0,0xff,0xa2,0x1a,0x00,0xc1,0xca,0xe2,0xb2,0x26,0xff,
+	0x64,0xac,0x0a,0xd8,0x52,0xb9,0x0c,0x42,0xff,0x66,0x64,0x80,0x4d,0xb0,0x22,0x24,
+	0x4e,0x7f,0xc6,0x01,0x00,0x48,0x52,0x80,0x44,0x0a,0x04,0xbf,0x22,0x47,0x00,0x32,
+	0x64,0x4e,0x1d,0x06,0xbe,0xdb,0xfc,0xf2,0x2c,0x02,0x45,0x1b,0x6f,0x00,0x81,0xbb,
+	0xff,0xe2,0x61,0xe2,0xe1,0x52,0x08,0x00,0x41,0xff,0xf8,0xe1,0x3e,0x46,0x97,0x1f,
+	0xe7,0x00,0xff,0x89,0x1b,0x77,0x15,0x0f,0x30,0x32,0xa0,0xff,0x38,0x03,0x38,0x53,
+	0x72,0x48,0x00,0x40,0xff,0x33,0xb0,0x52,0x63,0x4e,0x41,0xb3,0xe2,0xdf,0x28,0x04,
+	0x9e,0x02,0x08,0xcf,0x00,0x55,0x1b,0xdf,0x22,0x66,0x64,0x89,0x04,0xd4,0x04,0x36,
+	0x61,0xff,0x00,0xa1,0xd3,0xe1,0x91,0xd5,0xe1,0x82,0xff,0x2a,0x6d,0xb2,0x09,0x0c,
+	0xc2,0x29,0x40,0xff,0xcc,0x38,0x0b,0xbb,0x16,0xcb,0x0a,0x0b,0xff,0xcc,0x16,0x7c,
+	0x0a,0x52,0x2a,0x49,0xfe,0xfb,0x04,0x0a,0x4b,0x03,0x59,0x1b,0x61,0xa4,0xe2,0xff,
+	0x0e,0x0c,0x04,0x00,0xc7,0x00,0x41,0x1b,0xdf,0x6e,0xa3,0x24,0x01,0xc7,0x2c,0x01,
+	0x50,0x54,0xff,0xa0,0x58,0x05,0x66,0x13,0x43,0x66,0x22,0xff,0x40,0xcd,0x01,0x88,
+	0x35,0xae,0x71,0x0b,0xfb,0x04,0x47,0xd2,0x00,0x5e,0xa5,0x3d,0x00,0x07,0x7e,0xd5,
+	0x0e,0x88,0x35,0x5e,0xa5,0x3b,0x05,0x0c,0x04,0x67,0xce,0x00,0x0d,0xe4,0x0b,0x14,
+	0x14,0x04,0x27,0x14,0x2c,0xf7,0x66,0x32,0x3a,0xda,0x07,0x06,0x90,0x90,0x54,0xdf,
+	0xec,0xf9,0xb1,0xed,0xe1,0x0c,0x00,0xbe,0x4b,0xff,0x6d,0x9c,0x80,0x02,0x90,0x22,
+	0xce,0x00,0xff,0x1a,0x00,0x07,0x04,0xa1,0x1b,0xd0,0xac,0x8f,0x83,0xb7,0x0a,0x14,
+	0x52,0x0c,0x3d,0x30,0x77,0x09,0xa8,0xbf,0x52,0x5d,0x02,0x6e,0xa0,0x12,0x13,0x00,
+	0x1d,0xbf,0x1b,0x1e,0x73,0x07,0x5c,0x21,0x75,0x03,0x66,0xff,0x13,0x02,0x86,0x21,
+	0x00,0x71,0x9d,0xe1,0xbf,0x91,0xb1,0xe1,0x5e,0x23,0x78,0x7e,0x03,0xc0,0xff,0x22,
+	0xc6,0x21,0x00,0x16,0x28,0x0b,0x92,0xff,0xc3,0xfc,0x16,0x79,0x0d,0x2c,0xaa,0xa7,
+	0x7f,0x93,0x45,0xde,0xd2,0x1b,0x0c,0x87,0x34,0x00,0xcf,0xbe,0xfb,0x39,0x02,0xab,
+	0x04,0x23,0x07,0x2d,0x81,0xdd,0x90,0x2c,0x0f,0x6d,0x81,0x46,0xfa,0x01,0x00,0xf2,
+	0x7f,0xcf,0xfc,0x56,0x9f,0xff,0x6c,0xfe,0x42,0x06,0xc7,0x2d,0x81,0xe0,0xee,0x0e,
+	0x1b,0x10,0xac,0x06,0x9b,0xff,0xff,0x1d,0xf0,0x82,0x26,0x43,0xb8,0x04,0xce,0x7f,
+	0x44,0x1a,0xa4,0x00,0x00,0x80,0x22,0xd3,0x04,0xff,0x17,0xea,0x98,0x04,0x66,0x29,
+	0xe5,0xa2,0x5f,0x05,0x12,0x65,0xed,0xf8,0x1f,0x04,0x42,0x1f,0x28,0xff,0x1d,0xf0,
+	0x4d,0x09,0xad,0x03,0xb2,0x05,0xff,0x11,0xc2,0x05,0x10,0x65,0xe7,0xff,0xbd,0xff,
+	0x03,0x82,0x26,0x44,0xd2,0x14,0x7b,0xae,0xfb,0x45,0x5c,0x21,0x14,0xa8,0x55,0x7e,
+	0xaa,0x49,0x7e,0x27,0x02,0xad,0x1b,0x99,0xca,0x1d,0xf0,0x20,0x08,0xff,0xdd,0x09,
+	0xde,0x3d,0xbc,0xa4,0x00,0x01,0xf9,0x8c,0x1f,0x04,0x3d,0x14,0xa5,0xe3,0xff,0xf8,
+	0x55,0xf7,0x7e,0xff,0x4e,0xfb,0x00,0xad,0x1b,0xe9,0xcf,0x5e,0x6a,0x04,0x45,0x4e,
+	0xc4,0x3b,0x26,0x00,0xa4,0x26,0x04,0xfc,0x98,0x06,0xbf,0x0e,0xc1,0x58,0xe1,0xb8,
+	0x52,0xc2,0xff,0x2c,0x4a,0xc0,0xbb,0xa0,0xbe,0x5b,0x1a,0xff,0x44,0x00,0x00,0x60,
+	0x22,0xbe,0x4b,0xec,0xfe,0x49,0x02,0x71,0x1b,0xa5,0xc0,0xf8,0xe1,0x8f,0xfb,0xe1,
+	0x6c,0x63,0x07,0xd2,0x2e,0x81,0xf0,0xdd,0xb6,0xe1,0x04,0xde,0x7e,0x4e,0x05,0x91,
+	0x1b,0x5f,0x09,0x31,0x3f,0x49,0xe1,0x88,0x33,0xae,0x1c,0x00,0x0f,0x55,0x00,0xff,
+	0x29,0x5a,0xb1,0x22,0xe2,0xc1,0x21,0xe2,0xff,0xc9,0x3a,0xb9,0x0a,0x92,0x23,0x49,
+	0x90,0x3f,0x92,0xa0,0x2d,0x0a,0xa9,0x09,0x69,0x00,0x2b,0x00,0xff,0x58,0x03,0x8d,
+	0x02,0x26,0x15,0x74,0x38,0xbf,0x42,0x78,0x52,0x5e,0x73,0xd9,0x92,0x02,0xc1,0xff,
+	0x1b,0x21,0x18,0xe2,0x20,0x27,0x90,0xc6,0x7f,0x0e,0x00,0x5e,0x83,0xa6,0x01,0x87,
+	0x10,0x04,0xff,0x15,0xe2,0xc6,0xfa,0xff,0x67,0x93,0x05,0xff,0x21,0x14,0xe2,0x86,
+	0xf8,0xff,0x66,0x87,0xff,0x08,0x21,0x12,0xe2,0x20,0x23,0x90,0x06,0xff,0x06,0x00,
+	0x61,0x11,0xe2,0x30,0x53,0xf0,0xff,0x21,0x11,0xe2,0x5a,0x57,0x60,0x55,0x90,0xff,
+	0x2e,0x23,0x36,0xfc,0xe0,0x03,0xac,0x22,0xff,0x60,0x25,0x93,0x62,0x02,0x00,0xc1,
+	0x0c,0xff,0xe2,0x97,0x16,0x12,0xd8,0x28,0xa8,0x08,0xff,0xb2,0xcc,0xf8,0xd0,0xbc,
+	0x93,0xb0,0xaa,0xef,0xa0,0xa8,0x0a,0xa9,0xcc,0x02,0xf1,0x4f,0xe1,0x9f,0x0c,0x7e,
+	0xe2,0x4f,0x0d,0x1e,0x07,0x83,0x04,0x81,0xbf,0x03,0xe2,0x88,0x08,0xad,0x02,0xa9,
+	0x00,0xdc,0xff,0xfa,0x98,0x22,0xb1,0x1c,0xe1,0xdc,0x89,0xff,0xb2,0x0b,0xea,0xd1,
+	0x56,0xe1,0xe1,0x39,0x57,0xe1,0x8c,0xdb,0xc8,0x09,0x8f,0xc8,0x15,0x8f,0xbb,0x13,
+	0x7f,0xad,0x02,0x21,0xf5,0xe1,0x88,0x12,0x33,0x00,0xff,0xb8,0x4a,0x91,0xf5,0xe1,
+	0xd1,0xf3,0xe1,0xff,0xd9,0x5b,0xc8,0x0b,0xc9,0x02,0x2d,0x0a,0xfb,0x99,0x0b,0x43,
+	0x15,0x31,0x07,0xe1,0x32,0x23,0xff,0x48,0x81,0xeb,0xe1,0x21,0xee,0xe1,0x42,0x7f,
+	0x23,0x1e,0x49,0x18,0x22,0x63,0x1e,0x1b,0x14,0xff,0x81,0xea,0xe1,0x91,0xea,0xe1,
+	0x87,0x92,0xbf,0x03,0x0c,0x82,0x1d,0xf0,0x97,0x06,0x00,0x92,0x9f,0x1d,0xf0,0x81,
+	0xe7,0xe1,0x87,0x10,0x87,0x15,0x61,0xfe,0xb8,0x01,0x31,0xf8,0xe0,0xce,0x53,0xa8,
+	0x02,0xff,0x67,0x00,0x9d,0x1b,0x2e,0xb8,0x79,0x02,0xff,0xc7,0x01,0x61,0x1b,0x2e,
+	0xd9,0xfb,0x5a,0xff,0x20,0x02,0x60,0x22,0x61,0xdc,0xe1,0x41,0xef,0xdc,0xe1,0xb9,
+	0x01,0x08,0x01,0xb2,0x04,0x00,0xff,0x61,0xdb,0xe1,0x41,0xc6,0xe1,0xcc,0x7b,0xff,
+	0x61,0xd8,0xe1,0x41,0xc3,0xe1,0xc6,0xff,0xff,0xff,0xb2,0xc2,0xf0,0xb9,0x01,0x71,
+	0xe6,0xbf,0xe0,0x5e,0x1c,0x0d,0x02,0x47,0xcb,0x03,0xd7,0xff,0x92,0x0d,0x8e,0xbb,
+	0x52,0x01,0x27,0x01,0xff,0x85,0x1b,0x00,0x22,0xa1,0x86,0x02,0x00,0xfa,0x0d,0x04,
+	0x07,0x0d,0x0c,0x66,0x2a,0x33,0xa2,0x27,0xff,0x49,0xa8,0x7a,0x88,0x3a,0x0c,0x1b,
+	0x1e,0xf3,0xc1,0x3d,0xe8,0x01,0x97,0x0b,0xb2,0x03,0x09,0x56,0xbf,0x6b,0x05,0xad,
+	0x06,0xbd,0x05,0x74,0x07,0x04,0xfb,0x20,0x99,0xea,0x06,0x99,0x04,0x82,0x27,0x40,
+	0xfe,0x1c,0x00,0x06,0x0f,0x00,0x30,0xab,0xa0,0xa2,0xff,0x2a,0x1c,0x66,0x1a,0x1f,
+	0x5e,0xb5,0x3a,0xff,0x1f,0xe7,0x1f,0xa5,0x1b,0xa0,0xa2,0x30,0x3e,0x29,0x08,0xa0,
+	0x99,0x10,0xad,0x06,0x2b,0x20,0x5c,0x14,0xf9,0x2b,0x5c,0x20,0x7f,0x15,0x91,0xae,
+	0xe1,0x31,0xbd,0xff,0xe0,0x81,0xa7,0xe1,0x21,0xad,0xe1,0x48,0x7f,0x13,0x49,0x08,
+	0x29,0x13,0x99,0x43,0x27,0x15,0xff,0xbe,0x04,0x0a,0x04,0x47,0x02,0xa1,0x1b,0xff,
+	0xe5,0x96,0xf8,0x2d,0x0a,0x41,0xa7,0xe1,0xff,0x51,0xa5,0xe1,0x31,0xa6,0xe1,0x39,
+	0xca,0xff,0x59,0x0a,0x51,0xc6,0xe0,0x49,0x3a,0xae,0xef,0x3a,0x34,0x42,0x01,0xbb,
+	0x02,0xae,0x35,0xab,0xfe,0x6d,0x02,0x85,0x1b,0x65,0x94,0xf8,0xae,0x73,0xff,0x63,
+	0x60,0x80,0x00,0x88,0x22,0x47,0x93,0xff,0xe9,0x91,0xbf,0xe0,0x92,0x09,0x44,0x8e,
+	0xff,0x18,0x4a,0x0a,0xc7,0x08,0xa1,0x1b,0x9e,0xfb,0xa8,0x7b,0x79,0x00,0xad,0x1b,
+	0x25,0x92,0xf8,0xff,0xb1,0xa0,0xe0,0xa2,0x62,0x10,0xa2,0x2b,0xe7,0x49,0x29,0x2a,
+	0x68,0x04,0x67,0x01,0x41,0xe1,0xe0,0xff,0x31,0xa2,0xe0,0xd1,0xe0,0xe0,0xfe,0x90,
+	0xfd,0x19,0xc9,0x02,0x1d,0x1b,0x99,0xd2,0xd2,0x2d,0xff,0x66,0xe2,0x0f,0x02,0xe2,
+	0x41,0x02,0xd2,0xff,0x43,0x31,0xf2,0x1f,0x00,0xf2,0x51,0x00,0xff,0xb1,0xaa,0xe0,
+	0xc1,0xd9,0xe0,0xd1,0xd1,0xff,0xe0,0x8e,0x42,0xca,0x1e,0xe7,0x1e,0x81,0x7d,0x1b,
+	0xe0,0x00,0xf2,0x24,0x84,0xc0,0xff,0x15,0x05,0xdf,0xf2,0x64,0x84,0x2c,0x0e,0x2c,
+	0x0a,0x83,0xe0,0x7d,0xcc,0x10,0x04,0xc2,0x6d,0x83,0x0c,0x84,0x18,0x04,0xf7,0x2d,
+	0x82,0x40,0x21,0x0c,0x6d,0x82,0x7c,0x7e,0xaa,0x21,0x08,0x81,0x4e,0x16,0x81,0x22,
+	0x05,0x78,0x04,0x00,0x48,0xf7,0x18,0xa0,0x44,0x12,0x04,0x49,0x18,0xf1,0x70,0xfd,
+	0xe1,0x07,0x00,0xf9,0x98,0x48,0xfb,0xd2,0x2b,0xff,0x12,0xe2,0x2b,0x11,0xc2,0x2b,
+	0x10,0xf2,0xff,0x2b,0x13,0x50,0xee,0x11,0x60,0xcc,0x11,0xff,0xb0,0xff,0x11,0xa0,
+	0xdd,0x11,0x1a,0x44,0xbf,0x42,0x04,0x00,0xf0,0xdd,0x20,0x66,0x00,0xd0,0xff,0xcc,
+	0x20,0x40,0x40,0x44,0xce,0x44,0x39,0x7f,0x10,0x07,0x03,0xa5,0x1b,0x90,0x44,0x66,
+	0x04,0xff,0x49,0x08,0xf2,0x0b,0x50,0xe2,0x0b,0x52,0xdf,0x80,0xff,0x11,0xf0,0xee,
+	0x10,0x04,0xe9,0x38,0xff,0xd2,0x0b,0x51,0xc2,0x0b,0x53,0x80,0xdd,0x7b,0x11,0xd0,
+	0x99,0x08,0xc9,0x28,0xb8,0xeb,0x06,0x00,0x2f,0xb9,0xc8,0x0c,0x19,0x7a,0x04,0xd8,
+	0x7a,0x00,0x3a,0x0c,0xff,0xad,0x02,0x4e,0x78,0xdb,0x56,0x80,0x00,0xff,0x80,0x22,
+	0x65,0x05,0x00,0xb2,0xd2,0x01,0xff,0x2e,0xa2,0x3b,0x6e,0x01,0x03,0xa4,0x22,0xfb,
+	0x65,0x04,0x1a,0x00,0xc2,0x22,0x46,0xbe,0x00,0xf7,0x0d,0x01,0x07,0xd4,0x03,0x25,
+	0x0e,0x00,0x81,0xff,0x50,0xe0,0x82,0x28,0x28,0xa2,0x03,0x0c,0xbe,0xc8,0x01,0xa1,
+	0x8b,0xe0,0x3c,0x0b,0x3e,0x00,0x92,0xf7,0x2a,0x89,0xb0,0x21,0x0a,0x92,0x6a,0x89,
+	0xa1,0xff,0x0d,0xe1,0xa0,0xe3,0x13,0x81,0x4a,0xe0,0xf3,0x88,0x98,0xea,0x15,0x67,
+	0x05,0x61,0x42,0xe0,0x51,0xff,0x45,0xe0,0x62,0x26,0x49,0x88,0xe5,0x68,0xfd,0xb6,
+	0x18,0x00,0xcd,0x01,0x88,0x36,0xae,0x4a,0xf7,0x3b,0x00,0x07,0x12,0x02,0x6e,0xa6,
+	0x3d,0x00,0xdd,0xc7,0x1a,0x0e,0xbe,0x02,0x0c,0x68,0x08,0xee,0x52,0x7d,0x19,0x8e,
+	0x00,0x60,0x22,0x9e,0x03,0x7a,0x95,0x01,0xff,0x89,0x1b,0xb9,0x83,0xa9,0x93,0xd8,
+	0xc2,0xff,0x91,0x29,0xe1,0xbe,0x73,0xbe,0x01,0x47,0xff,0x00,0x81,0x1b,0xee,0x73,
+	0xcd,0xaa,0x81,0xfe,0xaf,0x00,0xd9,0x13,0x92,0x63,0x16,0xd2,0x01,0xff,0x08,0xb9,
+	0x63,0xa9,0x43,0xa9,0x53,0x22,0xff,0x63,0x15,0xc2,0x43,0x39,0xde,0x83,0x09,0xfb,
+	0x02,0x27,0x23,0x00,0x92,0x43,0x3a,0x88,0xf5,0xef,0xb9,0x73,0xad,0x04,0x58,0x00,
+	0x1d,0xf0,0x9e,0xff,0x1a,0x1e,0xce,0x01,0x02,0x1c,0x22,0xee,0xfb,0x03,0xf8,0x32,
+	0x02,0x99,0x1b,0xa9,0x83,0xf8,0xff,0xc2,0xb9,0x93,0xc9,0xb3,0x8e,0x73,0xdf,0x7d,
+	0xea,0x49,0x04,0xf9,0x23,0x86,0xec,0xff,0xab,0x0c,0xaf,0x17,0xe0,0x81,0x1a,0xab,
+	0x08,0xe8,0xab,0x08,0x91,0xff,0xde,0xe0,0x7d,0x0a,0xdc,0x63,0x9a,0x84,0xff,0xa2,
+	0x02,0x5c,0x5e,0x72,0xab,0x56,0x80,0xff,0x01,0x80,0x22,0xb9,0x01,0xa2,0x41,0x08,
+	0xff,0x82,0x62,0x19,0x06,0x0d,0x00,0x66,0x13,0xff,0x7c,0x88,0xc2,0xbe,0xfd,0xfa,
+	0x00,0x27,0xfc,0xb8,0x00,0x04,0x01,0xf8,0xd8,0xb0,0xff,0x10,0xa0,0xfe,0xf9,0x09,
+	0x9a,0xc4,0xe2,0xd2,0x01,0xf9,0xd8,0xdf,0xd2,0x02,0xb8,0x5e,0x72,0x7d,0x00,0x03,
+	0x84,0xff,0x22,0xe9,0x01,0xd2,0x41,0x08,0xc2,0x62,0x3f,0x2f,0x88,0x36,0x6e,0xa6,
+	0x3b,0x10,0x0b,0x18,0x07,0xb0,0xfd,0x10,0x14,0x08,0x99,0x03,0x14,0x3c,0x00,0x27,
+	0x14,0x2c,0x81,0xbf,0xf2,0xdf,0x88,0xf8,0xad,0x07,0xd8,0x08,0x1d,0xfd,0xf0,0xb3,
+	0x00,0x1e,0x02,0xc4,0x6a,0x80,0x00,0xff,0x68,0x22,0x98,0xd3,0x26,0x59,0x42,0x16,
+	0xff,0xb9,0x04,0x26,0x49,0x65,0x26,0x39,0x62,0xff,0x66,0x29,0x36,0xa1,0xe4,0xdf,
+	0xa2,0x2a,0xff,0x46,0xa8,0xea,0x65,0xf0,0xf8,0x06,0x0a,0xbf,0x00,0x0c,0x0b,0xae,
+	0xca,0x3d,0x74,0x09,0xee,0xf7,0x00,0x0a,0x01,0xb0,0x04,0xa5,0x72,0xf8,0xc2,0xff,
+	0x24,0x3b,0x0c,0x0b,0xb9,0x0c,0xad,0x03,0xfe,0xe6,0x15,0xa5,0xef,0xff,0x47,0x62,
+	0x06,0x3c,0xef,0xba,0x65,0x7a,0xfb,0x5e,0x04,0xc2,0x23,0x46,0xff,0xa8,0x0c,0xe1,
+	0xcd,0xe0,0xd1,0xcb,0xe0,0xbf,0x16,0x8a,0xfd,0xa0,0xc0,0xf5,0xc5,0x02,0xd7,0xff,
+	0x9c,0xb3,0xa5,0xf4,0xf8,0x86,0xf0,0xff,0xff,0x81,0xe1,0xdf,0x51,0xe2,0xdf,0x72,
+	0x28,0xff,0x77,0xad,0x03,0x5e,0x35,0xa7,0xe0,0x20,0xff,0x00,0x84,0x22,0x72,0x68,
+	0x77,0xc2,0x04,0x7f,0xf4,0x50,0x52,0x41,0x5e,0xd5,0x37,0xcd,0x08,0xff,0x70,0xcc,
+	0x30,0xc0,0xc0,0x74,0x30,0xcc,0xef,0xa0,0xce,0x4c,0x6b,0xce,0x09,0xa5,0xe9,0xff,
+	0xff,0xbc,0x35,0xa2,0x04,0xf4,0x2e,0x65,0xf5,0xfe,0x0f,0x00,0xad,0x1b,0x30,0xca,
+	0xa0,0xc2,0x2c,0xff,0x46,0xca,0xc5,0xc8,0x0c,0x9c,0x4c,0xae,0xfb,0x03,0x0b,0x13,
+	0x00,0xa1,0x1b,0xde,0x00,0x0e,0xee,0x07,0x08,0xa5,0x68,0xf8,0x29,0x00,0x4b,0x55,
+	0x67,0xdf,0x95,0xd8,0x86,0x00,0x00,0x0a,0x00,0x70,0xda,0xff,0x30,0xd2,0x44,0xf4,
+	0xc6,0xd6,0xff,0x00,0xff,0x36,0x41,0x00,0x17,0x62,0x12,0x98,0xd3,0xff,0x8c,0xd9,
+	0x26,0x29,0x0b,0x41,0xac,0xdf,0xff,0x26,0x59,0x11,0x26,0x49,0x38,0x26,0x39,0xdd,
+	0x35,0xbd,0x04,0xca,0xa5,0x6e,0xbd,0x08,0xa2,0x23,0xff,0x14,0x16,0xca,0x05,0xce,
+	0x43,0x3d,0x1f,0xff,0xe7,0x0f,0x81,0x1b,0xa0,0xdd,0x63,0xd0,0xff,0x9a,0xc0,0xad,
+	0x03,0x92,0x63,0x14,0xc0,0xef,0x8d,0xa0,0x8e,0x73,0x6e,0x05,0x81,0x1b,0xa5,0xff,
+	0xe0,0xff,0x46,0xf2,0xff,0x82,0x23,0x15,0xf7,0xa2,0xc3,0x44,0x53,0x01,0xa2,0x23,
+	0x11,0x16,0xff,0xaa,0xfb,0x92,0x24,0x38,0xb1,0xa9,0xdf,0xff,0x1b,0x99,0x92,0x6b,
+	0x78,0x82,0x23,0x16,0xf7,0xb2,0x23,0x10,0x19,0x00,0xd2,0x23,0x11,0xad,0x7f,0x03,
+	0xc2,0x23,0x10,0xde,0xd2,0xdb,0xd9,0x08,0xff,0x25,0xdd,0xff,0x06,0xe4,0xff,0xad,
+	0x03,0xf7,0xce,0x43,0x65,0xd8,0x08,0x52,0x63,0x13,0x59,0xef,0xd3,0x5e,0xb5,0x3d,
+	0x1c,0x08,0x65,0xdb,0xff,0xbf,0x52,0x44,0x0b,0x06,0xdc,0xff,0x9f,0x01,0x71,0xef,
+	0x86,0xdf,0x88,0xe7,0x40,0x00,0xae,0x5a,0x39,0xfb,0x7e,0x40,0x59,0x03,0xee,0xa9,
+	0x0a,0x7c,0xc0,0xbf,0x02,0x54,0x22,0x6e,0xca,0x06,0x38,0x00,0x55,0xff,0x1b,0x26,
+	0x53,0x41,0x0e,0x83,0xbb,0x7e,0xff,0x20,0x03,0xc0,0x22,0x8e,0xcb,0x0c,0x7c,0xfd,
+	0x80,0x1a,0x00,0x8c,0x0c,0x0c,0x26,0x88,0xf7,0xfb,0xad,0x05,0x35,0x00,0x2d,0x06,
+	0x1d,0xf0,0x92,0xff,0x22,0x13,0xa2,0x22,0x14,0x56,0x59,0x06,0xff,0x56,0x2a,0x06,
+	0xc8,0x04,0xd8,0x14,0xde,0xef,0x72,0x3b,0x01,0x47,0xbb,0x00,0xb9,0xd2,0xc0,0xff,
+	0xc2,0x41,0xc2,0x62,0x14,0xc6,0x12,0x00,0xff,0xe8,0x04,0x91,0x67,0xe0,0xe9,0xd2,
+	0x5e,0xff,0x3e,0x93,0x4a,0x80,0x00,0xc8,0x22,0x91,0xff,0x61,0xe0,0xf1,0x61,0xe0,
+	0xf2,0x62,0x15,0xff,0x92,0x62,0x16,0x98,0x04,0x8c,0x49,0x69,0xff,0x73,0x69,0x63,
+	0x98,0x04,0xc2,0x23,0x3b,0xff,0x16,0x19,0x0e,0x21,0x75,0xdf,0xad,0x0c,0xf7,0xce,
+	0x32,0xab,0x7c,0x00,0x85,0x1b,0xa5,0x41,0x7f,0xf8,0xc2,0x12,0x2a,0xae,0x43,0xcb,
+	0x19,0x02,0xff,0x85,0x1b,0xe5,0x40,0xf8,0x62,0x43,0xf4,0xf7,0x8e,0xf2,0xf6,0x0d,
+	0x00,0x45,0x1b,0x81,0x52,0xff,0xe0,0x82,0x62,0x15,0x86,0xee,0xff,0xad,0xff,0x02,
+	0xd8,0x14,0xd9,0xf2,0xc8,0x24,0xce,0x7b,0x72,0xee,0xe9,0x02,0x81,0x1b,0xe9,0xd2,
+	0x04,0x01,0xbe,0x4a,0x0a,0xe5,0xcc,0xff,0x86,0xf3,0x1f,0x00,0xc2,0x7f,0x22,0x46,
+	0xbd,0x06,0xbe,0x72,0xdd,0x43,0x02,0xff,0x81,0x1b,0x65,0xcb,0xff,0x46,0xee,0xff,
+	0xbf,0xa1,0x44,0xdf,0xc2,0x2a,0x57,0x09,0x03,0xc8,0xb7,0x7c,0x0c,0xfb,0x06,0x00,
+	0xb9,0x0c,0x8c,0x02,0x88,0xff,0x47,0xa8,0xea,0xcd,0x06,0xbd,0x01,0xae,0xeb,0x4a,
+	0x4d,0x7e,0x00,0x81,0xcf,0x06,0x5e,0x1a,0x43,0xfe,0xb2,0x00,0xc4,0x22,0xad,0x02,
+	0xce,0x52,0x1b,0x9e,0x3f,0x00,0x61,0x1b,0xee,0x41,0x8b,0x06,0xe8,0x03,0x72,0xff,
+	0x5c,0x84,0x81,0x00,0x88,0x22,0x65,0xc6,0xff,0xff,0x46,0xda,0xff,0x98,0xd2,0x26,
+	0x49,0xff,0x05,0xf2,0xc9,0xfd,0x56,0xef,0xf5,0x81,0xdf,0xf5,0xdf,0x92,0x03,0x8c,
+	0x53,0x00,0x82,0x28,0xff,0x68,0x97,0x58,0x02,0x06,0xd3,0xff,0x2e,0xfb,0xb2,0x3a,
+	0x27,0x0b,0xa5,0xde,0xff,0x86,0xcf,0xf6,0x8f,0x00,0x69,0x0c,0xd0,0x1a,0xc2,0xff,
+	0x06,0xcb,0xfe,0x2f,0x0a,0x80,0xf2,0xd7,0xee,0x13,0x02,0x06,0xff,0x02,0x06,0x54,
+	0x30,0x8e,0xb0,0x70,0x4b,0xef,0x00,0x03,0x84,0x20,0x07,0x00,0x42,0xf1,0xa3,0xaf,
+	0x84,0x20,0x24,0x21,0x65,0x01,0x00,0x00,0x04,0x2e,0xff,0x1f,0x00,0x81,0x20,0x90,
+	0xa0,0x37,0x8e,0xbf,0xb0,0x72,0x06,0x02,0x05,0x84,0x29,0x04,0x0b,0xbb,0x20,0x05,
+	0x29,0x08,0x44,0xf1,0xa5,0x29,0x00,0x41,0xfc,0x29,0x0c,0xd7,0x01,0x5e,0x12,0x4a,
+	0x01,0xe7,0x00,0xbf,0xc5,0x1b,0x9e,0x10,0x02,0x04,0x69,0x04,0x3e,0xff,0x29,0x78,
+	0x06,0x07,0x01,0xad,0x1b,0x80,0x7f,0x82,0x20,0x40,0x28,0x93,0x0e,0x08,0x64,0x07,
+	0xff,0x41,0x1b,0x00,0x00,0x3c,0x42,0xc1,0x01,0x7d,0xe0,0xac,0x00,0xb8,0x0c,0xb0,
+	0xba,0x20,0x08,0x09,0xff,0xae,0xec,0xfb,0x12,0x07,0x03,0x19,0x1b,0xdf,0xa5,0x53,
+	0x00,0xae,0xeb,0x0a,0x0c,0xe5,0x52,0xff,0x00,0x24,0x01,0x26,0xc1,0xd2,0xdf,0xae,
+	0xfb,0xe5,0xfd,0x41,0x02,0x19,0x1b,0xd4,0x11,0x26,0xff,0x7e,0xbc,0x00,0x07,0x02,
+	0x03,0x84,0x3a,0xe7,0x6e,0xbc,0x0b,0x23,0x00,0xab,0x01,0x50,0x00,0xae,0xcd,0xdf,
+	0x2e,0x0c,0x25,0x50,0xfd,0x03,0xd3,0x00,0x48,0x92,0xff,0x58,0xe2,0xc4,0x22,0x38,
+	0x7e,0x84,0x28,0xfe,0xec,0x00,0xc9,0x1b,0x7e,0x82,0x08,0x06,0x22,0xff,0x04,0xc8,
+	0x30,0x04,0x45,0x44,0x04,0x14,0xff,0x44,0x2e,0xa0,0x40,0x0b,0x1e,0x04,0x90,0xff,
+	0x20,0xc4,0x12,0x18,0x6e,0x42,0xf0,0x20,0xff,0x0b,0x00,0x80,0x20,0x04,0x76,0x44,
+	0x8e,0xff,0x74,0xf0,0x21,0x13,0x02,0x80,0x20,0x4e,0xbb,0x42,0xa3,0x82,0x09,0x7e,
+	0xe2,0x09,0xa4,0x05,0x22,0xff,0xce,0x25,0x03,0x06,0x02,0x02,0x54,0x38,0xff,0x90,
+	0x90,0x34,0x20,0x76,0xa0,0x5a,0xa6,0xff,0xa0,0xa0,0x34,0x20,0xaa,0xa0,0x7e,0x47,
+	0xff,0x0a,0x50,0x01,0x01,0x80,0x22,0x44,0x0a,0xef,0x09,0x9e,0x72,0xf7,0x3c,0x01,
+	0x80,0x38,0x44,0x3f,0x04,0x09,0x89,0xf4,0x1d,0xf0,0x06,0x10,0x0b,0x05,0xff,0x41,
+	0x00,0xc4,0x32,0x68,0xc4,0x22,0x18,0xff,0x48,0x92,0x5e,0x42,0xe0,0x4b,0x10,0x22,
+	0x9f,0x80,0x20,0x7e,0x82,0x48,0xc5,0x00,0x90,0x00,0x84,0xff,0x50,0x4f,0x0c,0x02,
+	0xc8,0x20,0x6e,0x42,0xff,0xf8,0x07,0x42,0x04,0x80,0x30,0x7e,0x82,0xff,0x30,0x0b,
+	0x08,0x0a,0xc8,0x20,0x04,0x35,0xff,0x44,0x2e,0x96,0x40,0x20,0x01,0x26,0xac,0xb7,
+	0x20,0x04,0x24,0x92,0x08,0x1f,0x08,0x92,0x24,0x07,0xfe,0x92,0x08,0x7e,0xe2,0x20,
+	0x60,0x2d,0x02,0xcc,0xbb,0x2a,0x2e,0x9a,0x10,0x70,0x70,0x34,0x97,0x14,0x9e,0xdd,
+	0x49,0x97,0x18,0x7e,0x72,0xf9,0x97,0x1c,0xcc,0x0b,0xff,0x1d,0xf0,0xd8,0x82,0xc1,
+	0xa6,0xdf,0xc9,0xfd,0x0d,0x9b,0x14,0x31,0xa5,0xdf,0x51,0xa3,0xdf,0xff,0xb1,0x37,
+	0xdf,0xa8,0xb2,0x88,0x72,0x48,0xff,0x82,0x98,0x0a,0xb0,0x99,0x20,0x99,0x0a,0xcf,
+	0x59,0x08,0x39,0x04,0x21,0x00,0x1f,0x00,0x38,0xc2,0xff,0x48,0xa2,0x0c,0x15,0x98,
+	0x92,0x0c,0x08,0x5b,0x8c,0xa3,0x76,0x00,0x89,0x04,0x04,0x00,0x59,0xd9,0x00,0xfb,
+	0x59,0xf9,0x1f,0x04,0x21,0x05,0xdd,0x07,0x0c,0xff,0x1a,0x0c,0x09,0x26,0x14,0x04,
+	0x26,0x24,0xff,0x01,0x0c,0x19,0xcc,0x69,0x82,0x21,0xa4,0xff,0xe6,0xb8,0x01,0x0c,
+	0x0a,0x8c,0x4a,0x0c,0xfd,0x32,0x63,0x04,0xa8,0x66,0xd2,0x61,0x91,0x65,0xdf,0x3f,
+	0x00,0x91,0x2e,0xdf,0x39,0x00,0xa2,0x69,0xd5,0x93,0x05,0x08,0x94,0x05,0x08,0x95,
+	0x05,0x00,0xb1,0x86,0xff,0xdf,0xa2,0x69,0x96,0x1c,0x0c,0xad,0x01,0xff,0x25,0x59,
+	0x00,0x1c,0xfe,0xc4,0x36,0x28,0x7f,0x7e,0x86,0x10,0x45,0xe5,0xa5,0xc8,0x54,0x02,
+	0xfb,0x7e,0x07,0x64,0x06,0xde,0x51,0x2e,0x07,0x02,0xff,0x04,0x60,0x38,0x7e,0x86,
+	0x00,0x4b,0x2a,0xff,0x04,0xcc,0x20,0xde,0xa0,0x10,0x2b,0x2e,0xff,0x04,0xac,0x20,
+	0xa4,0x61,0x06,0x0c,0x1b,0xff,0xd4,0x52,0xe2,0x25,0xd4,0xff,0x82,0xd1,0xff,0x02,
+	0x84,0x62,0x62,0xf4,0x61,0x06,0xa9,0xff,0x41,0x0c,0x1b,0xad,0x0f,0x25,0xd3,0xff,
+	0xff,0xa9,0x51,0xb1,0x71,0xdf,0xf2,0xd1,0x02,0xff,0x00,0x84,0x07,0x0c,0x1e,0xf4,
+	0x4b,0x04,0xff,0x0b,0xd4,0xe2,0x61,0x8c,0xc2,0xc1,0x20,0xff,0xd2,0x61,0x88,0xc2,
+	0x61,0x8d,0x0c,0x07,0xff,0xb2,0x61,0x8b,0x72,0x61,0x8a,0x72,0xa0,0xff,0x80,0xc2,
+	0x21,0x8d,0xa2,0x21,0x8c,0xb2,0xff,0xd1,0x02,0xd2,0xd1,0x02,0xd0,0x3a,0x56,0xff,
+	0xb0,0x3b,0x66,0xa0,0xa2,0x21,0x84,0x0c,0xff,0x69,0x84,0x1c,0x59,0xe0,0xba,0x11,
+	0xb2,0xff,0x61,0x89,0x60,0xaa,0xa0,0xb1,0x5f,0xdf,0xff,0xb9,0x4c,0x0c,0x0b,0xa8,
+	0x0a,0x65,0xcd,0xff,0xff,0xc2,0x21,0x8a,0xd2,0x21,0x8c,0xe2,0xff,0x21,0x8d,0x82,
+	0x21,0x8b,0x92,0x21,0x88,0xff,0xa9,0x5e,0x89,0xbe,0x00,0x09,0x40,0x4b,0xff,0x88,
+	0x1b,0xdd,0x82,0x61,0x8b,0xd2,0x61,0xff,0x8c,0xc0,0xf0,0xb1,0xa2,0x21,0x89,0x1b,
+	0xff,0xcc,0xc2,0x61,0x8a,0xb2,0xc1,0x10,0xf9,0xff,0xce,0xba,0xaa,0xa8,0x0a,0xa9,
+	0x6e,0x7a,0xff,0xee,0xe2,0x61,0x8d,0x66,0x4c,0x91,0xe1,0xff,0x4d,0xdf,0xd1,0x4e,
+	0xdf,0x0c,0x2f,0x7d,0xff,0x01,0x92,0xc1,0x60,0x66,0x14,0x3c,0x4b,0xff,0x81,0xa2,
+	0xc1,0x20,0x82,0x61,0x8e,0x76,0xff,0xaf,0x29,0x79,0x7a,0xd9,0x9a,0xe9,0xaa,0xff,
+	0xc2,0x21,0x8e,0x0c,0x0b,0xb9,0xea,0xb9,0xff,0xfa,0xf2,0xa0,0x80,0xc9,0x8a,0xcd,
+	0x09,0xfb,0x0c,0x0b,0xdb,0x00,0x80,0x3b,0x76,0x1b,0xbb,0xff,0x94,0x2c,0x79,0x66,
+	0x8b,0xf1,0xfa,0xaa,0xff,0xfa,0x99,0x91,0x37,0xdf,0x99,0x11,0x06,0xbf,0x21,0x00,
+	0x0c,0x0c,0xbd,0x01,0x3e,0x00,0x0c,0xdf,0x48,0x76,0xa8,0x54,0xb9,0x3d,0x00,0x92,
+	0x61,0xff,0x8f,0x81,0x37,0xdf,0x89,0xaa,0x0c,0x08,0xff,0x89,0xea,0x89,0xfa,0xf0,
+	0x8c,0x20,0x70,0xff,0x88,0xa0,0x89,0x8a,0x0c,0x08,0x82,0x61,0xff,0x90,0x82,0x21,
+	0x90,0x32,0x61,0x9a,0x22,0xff,0x61,0x99,0x32,0xd1,0x02,0x22,0x21,0x8f,0xff,0x30,
+	0x3b,0x06,0x32,0x21,0x9a,0x1b,0x88,0xf7,0x94,0x22,0x09,0x1c,0x00,0x22,0x61,0x8f,
+	0x22,0xff,0x21,0x99,0x66,0x88,0xd9,0x1b,0xcc,0x92,0xff,0xd9,0x01,0x4b,0xbb,0xa2,
+	0xda,0x01,0xa2,0xff,0xca,0x80,0x92,0xc9,0x80,0xe2,0x61,0x31,0xff,0xe2,0x61,0x71,
+	0x92,0x21,0xa4,0xa1,0x23,0x7f,0xdf,0xa2,0x61,0x72,0xa6,0x19,0x08,0x6e,0x00,0xbf,
+	0x92,0x6a,0x6e,0x06,0x02,0x00,0x4a,0x01,0x90,0xff,0xb0,0x60,0xb2,0x6c,0x4e,0xb8,
+	0x76,0xc8,0xff,0x86,0xad,0x04,0xe5,0xc0,0xff,0xe2,0x21,0xff,0x91,0xd2,0xa0,0x01,
+	0xd2,0x6e,0x00,0x25,0xff,0x16,0x00,0x61,0x31,0xde,0x42,0x61,0x98,0xff,0x56,0x12,
+	0x04,0x0c,0x28,0x80,0x44,0x10,0xff,0x0c,0x18,0x80,0x44,0x20,0x22,0xa0,0x76,0xff,
+	0x86,0x04,0x00,0xa0,0xb4,0x10,0x70,0x8b,0xfb,0xa0,0x88,0x47,0x04,0x90,0xbb,0x11,
+	0xba,0xaa,0xf7,0xe0,0x08,0x00,0x03,0x02,0xa0,0x40,0x0e,0x22,0xff,0x66,0x83,0x90,
+	0xea,0x03,0x9a,0x95,0x90,0xff,0xf1,0x13,0x00,0x20,0x00,0x66,0xca,0xd5,0xff,0xa8,
+	0x03,0x16,0x3a,0xfe,0x46,0x10,0x00,0x1c,0x41,0x1c,0x32,0x06,0xa0,0x76,0xa2,0x28,
+	0x08,0x31,0x00,0x2b,0x14,0x77,0x26,0xca,0x13,0x55,0x2c,0xb0,0xaa,0x80,0x56,0x00,
+	0xff,0xad,0x03,0xe0,0x02,0x00,0x98,0x03,0x16,0xcf,0x79,0xfc,0x0c,0x02,0xeb,0x0a,
+	0x00,0x04,0x36,0x61,0xff,0x00,0xe5,0x10,0x00,0x5e,0xf0,0xea,0x00,0xff,0x07,0x01,
+	0x19,0x1b,0x7e,0x00,0x06,0x01,0xff,0x07,0x00,0xa1,0x1b,0x90,0x40,0x0e,0x26,0xff,
+	0xc9,0xf9,0x07,0x69,0xf6,0x72,0x65,0x90,0xfb,0x1b,0xaa,0x66,0x00,0x62,0x65,0x9f,
+	0xa6,0x2a,0xff,0xe8,0xa5,0x10,0x00,0x69,0x04,0x65,0x09,0xff,0x00,0x41,0xfd,0xdd,
+	0x82,0x22,0x19,0x79,0xff,0x01,0x12,0x62,0x15,0xee,0x48,0x07,0x0e,0xff,0x67,0x00,
+	0x55,0x1b,0xc6,0x01,0x00,0x82,0xcf,0x22,0x1b,0xad,0x02,0x67,0x00,0x3c,0x08,0x1e,
+	0x07,0x7f,0x69,0xee,0xa8,0x01,0xa2,0x65,0x90,0x3c,0x0c,0x96,0x05,0x00,0x72,0x64,
+	0xcf,0x08,0x93,0xa3,0x0c,0x3f,0x00,0xa2,0x7b,0x22,0x1a,0x2d,0x00,0x98,0xb2,0x16,
+	0xc9,0x90,0x08,0xfa,0x3e,0x28,0x21,0x3e,0x70,0xc6,0xf5,0xff,0xb8,0xb2,0xbf,0x16,
+	0x2b,0xfd,0xc6,0xf0,0xff,0xc7,0x10,0x41,0x3f,0x00,0x9e,0xd8,0xd8,0x0e,0x67,0xc4,
+	0x00,0x2c,0x00,0xff,0x82,0x69,0x83,0x31,0xd5,0xdd,0x0c,0x02,0x8e,0x0a,0x00,0x22,
+	0x63,0x8f,0xec,0x04,0x1f,0x00,0x0c,0x00,0x48,0xff,0x02,0x9c,0x44,0x62,0xa0,0x00,
+	0x76,0x80,0xbf,0x0b,0x1b,0x66,0x67,0x13,0x0a,0x11,0x00,0x88,0x7f,0x02,0x8c,0x28,
+	0x46,0xfb,0xff,0x00,0x10,0x15,0xee,0x27,0x00,0x81,0xa2,0xde,0x2a,0x04,0x08,0x0c,
+	0x29,0xfd,0x90,0x62,0x09,0x49,0x08,0x31,0xdc,0xdd,0x0c,0x75,0x12,0x4b,0x08,0x87,
+	0x27,0x20,0x91,0x98,0xde,0x15,0x08,0xef,0x88,0x09,0x20,0x88,0x27,0x04,0xa1,0x83,
+	0xde,0xff,0x8e,0x79,0x0b,0x12,0x07,0x02,0x81,0x1b,0xbf,0x25,0xf9,0xff,0x91,0xcf,
+	0xdd,0x13,0x04,0x7e,0xff,0xde,0x2e,0x79,0x2b,0x12,0x07,0x03,0x91,0xcf,0x1b,0xe5,
+	0xf7,0xff,0x3c,0x00,0x37,0x00,0x51,0x96,0xff,0xde,0x58,0x05,0x32,0x15,0x5f,0x0c,
+	0x04,0xff,0x2e,0xc1,0x02,0xb0,0x00,0x00,0x80,0x22,0xff,0x76,0x93,0x0e,0x14,0x22,
+	0x08,0x8e,0xb0,0xff,0x70,0x02,0x81,0x81,0x84,0x22,0xcc,0x58,0xff,0x1b,0x44,0x22,
+	0x15,0x4b,0x1d,0xf0,0x50,0xff,0x24,0x90,0x22,0x12,0x4a,0x1d,0xf0,0x36,0xff,0x21,
+	0x00,0x30,0x72,0x30,0x20,0x61,0x60,0xff,0x30,0x31,0x60,0xb6,0x23,0x42,0x60,0x51,
+	0xff,0x41,0x37,0x35,0x46,0x40,0xf3,0x40,0x50,0xdf,0xf6,0x40,0x5e,0x44,0x52,0xb8,
+	0x01,0xa5,0x1b,0xff,0x00,0x14,0x40,0x00,0x33,0xa1,0x66,0x14,0xfd,0x04,0x1b,0x01,
+	0x3d,0xf0,0x76,0x94,0x10,0x37,0xff,0x36,0x07,0x3e,0x66,0x52,0x40,0x20,0x01,0xff,
+	0xa4,0x22,0xf0,0x22,0x11,0x30,0x31,0x41,0xff,0x37,0x36,0x01,0x1b,0x22,0x20,0x50,
+	0x60,0xff,0x70,0x25,0xa3,0x1d,0xf0,0x9c,0x73,0x60,0xff,0x20,0x60,0x70,0x26,0xb3,
+	0x1d,0xf0,0x37,0xff,0x36,0x14,0x2e,0x01,0x04,0x1f,0xe7,0x1e,0xdf,0xa1,0x1b,0x70,
+	0x24,0xa3,0xdd,0x0c,0x44,0x49,0xf3,0x56,0x30,0x91,0x05,0x77,0x00,0x20,0x72,0x20,
+	0x20,0xbd,0x21,0x77,0x0c,0x34,0x50,0xf2,0x40,0x74,0x00,0x47,0xdf,0xb5,0x1c,0x50,
+	0x44,0xc0,0x6f,0x34,0x08,0x37,0x9f,0x32,0x02,0x30,0x22,0xc0,0x67,0x04,0x08,0x08,
+	0xd6,0xdf,0x27,0x00,0x20,0x20,0x60,0x4e,0x00,0xcc,0x53,0xfc,0x50,0x20,0x37,0x05,
+	0x21,0x00,0xb6,0x23,0x3b,0x20,0x53,0x62,0x20,0xbc,0x00,0x4d,0x08,0x35,0xc2,0x34,
+	0x02,0x52,0x00,0xfe,0xc0,0x4c,0x02,0x22,0xc2,0x01,0x1d,0xf0,0x8c,0xfe,0xb5,0x00,
+	0x00,0x00,0x37,0x36,0x0c,0x0c,0x12,0xf0,0x8c,0x11,0x5e,0x20,0x00,0x0c,0x97,0x1c,
+	0x0f,0x6e,0x53,0x03,0x7b,0x60,0x20,0x62,0x01,0x6e,0x85,0x05,0xa0,0x07,0x04,0xfe,
+	0x25,0x04,0xb6,0x74,0xdd,0x6e,0x53,0x04,0x9e,0xdb,0xe0,0x02,0x16,0x1c,0x1e,0x05,
+	0x26,0x00,0x01,0x64,0xff,0x22,0xb6,0x64,0xc2,0x7e,0x53,0x14,0x9e,0xe9,0xc0,0x1a,
+	0x04,0x39,0x00,0x40,0x1a,0x00,0x62,0x45,0x00,0x6f,0x7e,0x85,0x15,0xa0,0x0a,0x04,
+	0x86,0x02,0xbf,0x04,0xff,0x5d,0x02,0x07,0xe2,0xbb,0x17,0xe2,0xd3,0xff,0x40,0x74,
+	0x41,0x20,0x83,0x01,0x56,0xb8,0xf7,0x07,0x66,0x17,0xb3,0x08,0x97,0x1b,0x78,0x13,
+	0xff,0x68,0x03,0x69,0x05,0x68,0x23,0x79,0x15,0xef,0x7e,0x43,0x33,0x64,0xd9,0x05,
+	0x69,0x25,0x7e,0xf7,0x75,0x35,0xa4,0x09,0x04,0x37,0x64,0x13,0x78,0xdf,0x13,0x6e,
+	0x43,0x03,0x62,0x16,0x08,0x05,0x7e,0xf7,0x75,0x15,0xa2,0x09,0x04,0x27,0xe4,0x08,
+	0x17,0xdf,0xe4,0x1c,0x07,0xe4,0x2e,0x98,0x00,0x68,0x03,0xdf,0x6e,0x75,0x03,0x60,
+	0x80,0x8e,0x04,0x24,0x95,0xff,0xa0,0x80,0x00,0x60,0x22,0x07,0xe4,0x16,0xef,0x1d,
+	0xf0,0x6e,0x33,0x88,0x0c,0x6e,0x65,0x05,0x76,0x85,0x08,0x07,0xe4,0x05,0x01,0x62,
+	0x03,0x00,0x98,0x00,0xff,0x1d,0xf0,0x16,0xa4,0xff,0x00,0x23,0x40,0xff,0x80,0xbe,
+	0x15,0xb0,0x33,0xc0,0x62,0x23,0xfd,0x00,0x8a,0x14,0x26,0x78,0x13,0x88,0x23,0x60,
+	0xff,0x67,0x81,0x70,0x78,0x81,0x69,0x05,0x98,0xff,0x33,0x79,0x15,0x68,0x43,0x80,
+	0x89,0x81,0x7f,0x89,0x25,0x9e,0x96,0x43,0x64,0x00,0x52,0x01,0x39,0x9e,0x95,0x18,
+	0xb4,0x00,0x8e,0x43,0x23,0x95,0x08,0x2f,0x00,0x9b,0x69,0x05,0x31,0x00,0x6d,0x08,
+	0x9d,0x18,0xb4,0x08,0x67,0x77,0x43,0x60,0x80,0x33,0x00,0x6e,0x75,0x05,0x94,0x00,
+	0xff,0x80,0x22,0x6d,0x07,0xba,0x33,0x17,0xe4,0xff,0x04,0x07,0xe4,0x1c,0x1d,0xf0,
+	0x72,0x03,0x61,0x01,0x27,0x41,0xa1,0x28,0x95,0x19,0x97,0x25,0x07,0x3e,0x8f,0x25,
+	0xfb,0x84,0xe5,0x0e,0x14,0x1e,0x05,0x34,0x9e,0xe0,0x7d,0x03,0x87,0x01,0x84,0xd2,
+	0x3e,0x65,0x04,0x87,0x09,0xdb,0x2e,0x00,0xf6,0x04,0x40,0x22,0x3b,0x0a,0x30,0x30,
+	0xff,0x74,0x80,0x73,0x11,0x70,0x33,0x20,0x00,0x3c,0x05,0x08,0x8a,0x05,0xc0,0x17,
+	0xe2,0xd0,0x8a,0x01,0xf9,0x14,0xff,0x0d,0x39,0x05,0x39,0x15,0x39,0x25,0x3e,0xde,
+	0xe0,0x18,0x09,0x39,0x05,0x3e,0xce,0x18,0x07,0x3e,0x72,0xc4,0x10,0x17,0x0a,0x00,
+	0x4f,0x15,0x64,0x02,0x32,0xa8,0x08,0xff,0x40,0x9c,0x71,0x02,0x06,0x04,0x01,0x00,
+	0xff,0x2c,0x51,0x00,0x20,0x74,0x92,0x60,0x20,0xff,0xb4,0x98,0x60,0x20,0x84,0x97,
+	0x60,0x20,0x7d,0x68,0x03,0x00,0xec,0x96,0x60,0x20,0xc0,0x03,0x00,0x7d,0x54,0x03,
+	0x00,0xb4,0x95,0x60,0x20,0xc4,0x1f,0x00,0xf9,0x24,0x17,0x00,0xcf,0x03,0xce,0x02,
+	0x04,0x1c,0x07,0xff,0x01,0x59,0x1b,0x6e,0x03,0x04,0x00,0x27,0xff,0x00,0x41,0x1b,
+	0x62,0x22,0x11,0x81,0xed,0xff,0xff,0x91,0xf5,0xff,0x42,0x42,0x10,0xa1,0xff,0xf3,
+	0xff,0xb1,0xf1,0xff,0xc1,0xef,0xff,0xff,0xd1,0xee,0xff,0xe1,0xec,0xff,0xf1,0xea,
+	0xff,0xff,0x31,0xe8,0xff,0x51,0xe7,0xff,0x59,0xff,0x02,0x39,0xf2,0xf9,0x52,0xe9,
+	0x62,0xd9,0xff,0x72,0xc9,0x82,0xb9,0x92,0xa9,0xa2,0x9e,0xff,0x72,0xb4,0x00,0x07,
+	0x00,0x81,0x1b,0x49,0xff,0x12,0x49,0x22,0x89,0x32,0x8e,0x72,0x07,0xff,0x01,0x07,
+	0x01,0x81,0x1b,0x70,0x66,0x20,0xff,0x81,0xe5,0xff,0x89,0xc2,0x62,0x62,0x11,0xff,
+	0x71,0xe4,0xff,0x79,0xd2,0x61,0xe3,0xff,0xef,0x69,0xe2,0x2d,0x04,0x33,0x05,0xa4,
+	0x5f,0x00,0xfe,0x7b,0x04,0x51,0xfe,0xff,0xee,0x45,0x74,0x00,0xfd,0xa7,0x3a,0x04,
+	0x05,0x9c,0x63,0xd8,0x03,0xd9,0xff,0x15,0xc8,0x13,0xc9,0x25,0xb8,0x23,0xb9,0xff,
+	0x35,0xa8,0x33,0xa9,0x45,0x98,0x43,0x99,0xff,0x55,0x88,0x53,0x89,0x65,0x20,0xe2,
+	0x93,0xe7,0xee,0x75,0x72,0x61,0x08,0x3c,0x04,0x1b,0xb7,0x00,0xd5,0x3c,0xe3,0x00,
+	0x54,0x03,0x00,0x5c,0x03,0x00,0x65,0x59,0xf7,0x00,0x20,0x58,0x07,0x00,0x36,0xa1,
+	0x00,0x2e,0xef,0x71,0x9f,0x1f,0xe7,0x25,0x00,0xf9,0x11,0xf9,0xff,0x01,0x71,0xe7,
+	0xff,0xad,0x04,0x3e,0x23,0xfd,0x34,0x9d,0x0b,0xe0,0xea,0x03,0xc0,0x20,0x00,0xfb,
+	0xe9,0x21,0x04,0x00,0x92,0x07,0x24,0x82,0x07,0xff,0x25,0xd8,0x91,0xb8,0x21,0xb9,
+	0x81,0x49,0xff,0x3d,0x49,0x2d,0x49,0x1d,0x9e,0x38,0x4c,0xff,0x01,0xc7,0x01,0xad,
+	0x1b,0xc9,0x07,0x16,0xdf,0x08,0x06,0xde,0x5a,0x06,0x68,0x00,0x55,0x1b,0xff,0xa6,
+	0x13,0x50,0x5d,0x02,0x4d,0x0a,0xb8,0x7f,0x04,0xa2,0x07,0x25,0xd2,0x17,0x14,0x35,
+	0x00,0xff,0xe8,0x47,0xe0,0xdd,0x11,0xa7,0xb9,0x0d,0xef,0xce,0x42,0x0a,0x1c,0x8a,
+	0x04,0xe0,0x0e,0x00,0xdf,0xc6,0x06,0x00,0xce,0x45,0x0d,0x18,0x82,0x07,0x7f,0x24,
+	0xf2,0x07,0x25,0x8e,0xff,0x5e,0xfd,0x00,0xff,0xa5,0x1b,0xf0,0x3e,0xa3,0x4e,0x44,
+	0x46,0xfe,0x70,0x00,0x60,0x22,0x3e,0xd6,0x75,0xa0,0x80,0xf7,0x01,0x74,0x22,0x44,
+	0x00,0x0c,0x04,0x3e,0x19,0xfd,0x76,0x92,0x00,0xc5,0x1b,0x5d,0x02,0xa8,0x05,0xbf,
+	0x65,0x92,0x00,0xae,0x71,0x36,0x23,0x00,0x80,0xf7,0x22,0x8e,0x1a,0xd9,0x01,0x01,
+	0x54,0x22,0x98,0xff,0x87,0x1b,0x99,0x99,0x87,0xf6,0x29,0x02,0x7f,0x86,0x2f,0x00,
+	0x49,0x31,0x06,0x01,0x78,0x06,0xff,0x49,0x87,0xa2,0x07,0x24,0xa7,0x26,0xce,0xff,
+	0xb8,0x91,0xb2,0x1b,0x00,0xdc,0xeb,0x88,0xef,0x67,0xbe,0xbf,0xfa,0xb3,0x01,0x1d,
+	0x1b,0xe0,0xdf,0x08,0x00,0xae,0xbd,0xfb,0x4e,0x00,0x1d,0x1b,0xf7,0xce,0x00,0x0d,
+	0xb7,0x00,0xa1,0x1b,0xa5,0x50,0x7f,0x00,0x4b,0xa1,0x1e,0xb1,0x3c,0x24,0x27,0x07,
+	0xff,0xe5,0x8f,0x00,0xa9,0x31,0xee,0xea,0x09,0xff,0x09,0x27,0x11,0x55,0x1b,0x90,
+	0x9a,0xc0,0x7f,0x90,0xa4,0x83,0xa9,0x31,0x46,0x19,0x53,0x04,0xbf,0xa9,0x51,0x2e,
+	0xa2,0x3b,0x24,0x18,0x07,0xf0,0xef,0x20,0x00,0x25,0x86,0x27,0x00,0x96,0x5a,0x04,
+	0xff,0xf8,0x51,0xa1,0xaa,0xff,0x8e,0x4f,0xff,0xff,0xe0,0xa1,0x01,0x7c,0x22,0x40,
+	0xef,0x10,0xf7,0x8e,0x83,0x4b,0x5c,0x00,0x81,0x1b,0xfe,0x80,0xff,0x2e,0xc0,0x81,
+	0x00,0x48,0x22,0x8e,0xef,0x7d,0x7c,0x0f,0x00,0xad,0x1b,0xee,0x77,0xdd,0x8d,0x09,
+	0xe7,0xe5,0x49,0x00,0x45,0x00,0xee,0x08,0xde,0x41,0x5c,0xfb,0x01,0x47,0x12,0x00,
+	0xa5,0x48,0x00,0x88,0xe7,0xff,0xa8,0x31,0x1b,0x88,0x89,0xe7,0xd6,0x5a,0xf7,0x02,
+	0xae,0x98,0x9d,0x30,0x46,0x00,0xbe,0x01,0xff,0x0a,0x22,0x80,0x00,0xa0,0x22,0xce,
+	0x05,0x77,0x0d,0x00,0x47,0x12,0x04,0x45,0x00,0xb0,0x9d,0x09,0xfd,0xb9,0x9d,0x05,
+	0xa8,0x81,0x98,0x21,0xc8,0x11,0xff,0xa0,0x99,0xc0,0x99,0x61,0xa6,0x2c,0x32,0xff,
+	0xe8,0x01,0xa2,0xc1,0x1c,0x0e,0xfc,0xeb,0xff,0x01,0x07,0x00,0xad,0x1b,0xfe,0xee,
+	0x3d,0x3b,0x00,0x27,0x69,0x00,0xee,0x61,0xec,0x38,0x00,0x7c,0x00,0xed,0x41,0x4b,
+	0x04,0x26,0x00,0x4b,0x20,0xe5,0x40,0x00,0xff,0x0c,0x02,0x1d,0xf0,0x98,0xb7,0x88,
+	0x01,0xdf,0xa8,0x41,0xbe,0x01,0x0c,0x91,0x00,0xa1,0x1b,0xdf,0x9e,0x88,0x4d,0x00,
+	0x47,0xb4,0x00,0x8e,0x77,0xf7,0xba,0x52,0x81,0x69,0x01,0x65,0x3e,0x00,0xa8,0x7f,
+	0x31,0x21,0x72,0xff,0xde,0x41,0x9f,0x47,0x08,0xff,0x1e,0x1a,0x74,0x1e,0xc7,0x1e,
+	0xc1,0x1b,0xff,0x46,0xd1,0xff,0xc8,0xc7,0xe2,0x1d,0x00,0x7f,0xf9,0x1d,0x9e,0x41,
+	0x33,0x5a,0x60,0xbb,0x03,0xff,0xee,0x7d,0x3a,0x00,0x07,0x02,0x81,0x1b,0xdf,0x9e,
+	0x7d,0x2c,0x80,0x21,0x39,0x00,0xce,0x77,0xf7,0xcb,0x3e,0xe1,0x17,0x00,0x0e,0xcb,
+	0xe8,0x3e,0x7f,0xc1,0x02,0x54,0x22,0x56,0x38,0xf1,0x46,0x29,0xfb,0xa5,0x6d,0x46,
+	0x05,0xea,0xef,0xd8,0x51,0xa1,0xbf,0x5c,0xff,0xbe,0x4d,0xfd,0xa0,0x46,0x05,0xd0,
+	0xdf,0xe0,0x14,0x4e,0x9d,0x6c,0xfd,0x00,0xad,0x1b,0xbf,0xbe,0x83,0x49,0x20,0x81,
+	0x01,0x57,0x00,0x9d,0xb5,0x7b,0x46,0x09,0x9e,0x46,0x11,0x65,0x35,0x46,0x39,0x25,
+	0xff,0x34,0x00,0x46,0xad,0xff,0x00,0x00,0xe0,0x57,0x00,0x00,0x01,0x03,0x00,0x02,
+	0x03,0x00,0x9c,0xe3,0x02,0xd5,0x64,0x03,0x00,0x80,0x03,0x00,0xdc,0x3f,0x0f,0x81,
+	0xf8,0xff,0xff,0x91,0xf8,0xff,0x41,0x2c,0xff,0x87,0xff,0x12,0x25,0x97,0x12,0x4e,
+	0xa1,0xf6,0xff,0xdf,0xa7,0x12,0x16,0xae,0xf6,0x73,0x2d,0x65,0x2f,0x7f,0x00,0x0c,
+	0x22,0x1d,0xf0,0x39,0xc4,0x1a,0x05,0x3f,0xa1,0xef,0xff,0x3e,0x74,0x0b,0x75,0x08,
+	0x1f,0x18,0xef,0x2d,0x00,0x4e,0xa4,0x7d,0x0c,0xce,0x01,0x0d,0xfb,0x00,0x27,0x12,
+	0x04,0x2c,0x00,0xc6,0xf3,0xff,0xeb,0xa1,0xe5,0x2b,0x00,0xeb,0x2b,0x28,0xa5,0x2a,
+	0x00,0xaf,0xae,0xe1,0xfb,0x01,0x5e,0x08,0x02,0x2b,0x0c,0xa5,0x6f,0x29,0x00,0xc6,
+	0xe8,0xa9,0x00,0x00,0x03,0xa3,0x00,0xb5,0x04,0x03,0x00,0xc0,0x9f,0x00,0x50,0x59,
+	0x9f,0x0c,0xd0,0xbf,0xff,0x91,0xd0,0xff,0xa1,0x04,0x9f,0x00,0x41,0xff,0x97,0x12,
+	0x43,0xb1,0xce,0xff,0xc1,0xf6,0xff,0xff,0x98,0xca,0xb7,0x12,0x3d,0xc7,0x12,0xff,
+	0x3d,0xd1,0xf5,0xff,0x98,0xba,0xd7,0x12,0xf7,0x1e,0xae,0xf4,0xaf,0x30,0x24,0x00,
+	0x0c,0x0e,0x27,0xee,0x63,0x02,0x5d,0x00,0xef,0x07,0x9e,0x09,0x00,0xf9,0x0f,0xff,
+	0x98,0x0a,0x06,0xfc,0xff,0x98,0xea,0xc6,0xff,0xfa,0xff,0x06,0xfa,0xff,0x91,0xe7,
+	0xff,0xaf,0x98,0x09,0x06,0xf8,0x78,0x00,0x60,0x6b,0x0c,0x0c,0xff,0x46,0x62,0x55,
+	0x00,0x26,0x12,0x03,0x0c,0xff,0x12,0x1d,0xf0,0x81,0xe8,0xfe,0x91,0xfa,0x7f,0xff,
+	0x99,0x03,0x88,0xd8,0x8e,0x64,0x3d,0x0c,0xff,0x22,0x55,0x00,0x1d,0xf0,0x00,0x00,
+	0xe4,0xfd,0x51,0x2b,0x08,0xa1,0xf3,0xfe,0x0c,0x0c,0xce,0xef,0x64,0x0b,0x5a,0x61,
+	0xcd,0x01,0xb2,0x0b,0x14,0xff,0x1b,0xbb,0xa5,0x4d,0x00,0xd6,0x2a,0x01,0xdb,0xae,
+	0xf8,0x8a,0x2c,0xe5,0x1b,0x4f,0x0a,0x00,0x00,0xfd,0xf8,0x37,0x0c,0x82,0x02,0x01,
+	0x92,0xa2,0x00,0xff,0x5e,0x18,0x62,0x01,0x27,0x01,0xc1,0x1b,0xfb,0x3e,0xe9,0x5b,
+	0x00,0x01,0x61,0x1b,0xa1,0xdf,0xf7,0xff,0xa9,0x04,0x60,0x08,0x1d,0xf0,0xae,0xf5,
+	0x7d,0xfc,0x41,0x08,0xde,0x00,0x0b,0x00,0xa7,0x41,0x00,0xfb,0xbe,0x65,0x6c,0x0d,
+	0x25,0x17,0x00,0x0c,0x32,0xfb,0x1d,0xf0,0x43,0x00,0x3e,0xc1,0xe2,0x00,0xc7,0xf6,
+	0x21,0x00,0x29,0x03,0x58,0x00,0x30,0x52,0x00,0x20,0xf5,0xa8,0xcb,0x01,0x3c,0x07,
+	0x00,0x36,0xa1,0x00,0x41,0xff,0xba,0xfe,0xa1,0xfb,0xff,0xf2,0x12,0x02,0xdf,0xfe,
+	0x64,0x4e,0x01,0xa7,0x78,0x03,0xe9,0x04,0x7f,0x82,0x02,0x03,0xd2,0x02,0x00,0xc2,
+	0x78,0x00,0xff,0x02,0x02,0x92,0x44,0x26,0xce,0x84,0x5b,0xbe,0x4f,0x00,0x85,0x1b,
+	0xde,0x84,0x4c,0x07,0x08,0x8e,0x5b,0x84,0x7d,0x07,0x08,0x25,0x11,0x0c,0x07,0x40,
+	0x58,0x17,0x56,0x98,0x05,0xe5,0x0f,0x12,0x08,0x60,0x12,0x0c,0x01,0xcf,0x08,0x59,
+	0x0e,0x68,0x1a,0x12,0x14,0xa5,0x0d,0x25,0x08,0x20,0x25,0x20,0xeb,0x65,0x0c,0x12,
+	0x08,0x40,0x12,0x20,0x25,0x0b,0x00,0xff,0x51,0xa2,0xfe,0x82,0x02,0x02,0xa1,0x89,
+	0x7f,0xff,0xb2,0x12,0x02,0x9e,0x52,0x0c,0xd5,0x08,0xff,0xc9,0xf4,0x80,0xbb,0x11,
+	0xb0,0x99,0x20,0xff,0x99,0x0a,0x66,0x48,0x66,0x88,0x34,0xa2,0x7f,0xa0,0xe0,0x1e,
+	0xb1,0x3d,0x04,0xc7,0x5e,0x00,0xff,0xe0,0x08,0x00,0x59,0x91,0xad,0x01,0x92,0xff,
+	0x12,0x02,0xb1,0x5a,0xfe,0xce,0xc7,0xfd,0xfd,0x01,0xf2,0x04,0xd9,0x11,0xc9,0x61,
+	0xb9,0xa1,0xff,0xe0,0x99,0x11,0x99,0x01,0xe5,0x80,0x00,0xef,0xa9,0xb1,0x6e,0x3a,
+	0x40,0x05,0x55,0x1b,0xae,0xb5,0xc0,0x01,0x32,0x04,0x80,0x04,0x2a,0x80,0xd9,0x23,
+	0x25,0xf3,0x03,0x00,0xd8,0x05,0x66,0x02,0x59,0x03,0xc6,0xfc,0xb7,0xff,0x59,0x03,
+	0x4b,0x0d,0x6e,0xe2,0x38,0x08,0x29,0xff,0x63,0x29,0x53,0x29,0x33,0x29,0x43,0x29,
+	0xb7,0x13,0x29,0x23,0x24,0x08,0x40,0x31,0x4f,0x01,0x61,0xff,0x00,0x61,0x66,0xfe,
+	0x91,0xfd,0xff,0xd8,0xff,0x56,0x82,0x09,0x02,0x82,0x41,0x02,0x92,0xff,0x19,0x00,
+	0x92,0x51,0x00,0x42,0x41,0x00,0xff,0x16,0x2d,0x04,0x16,0x32,0x05,0xdc,0xb3,0x7f,
+	0xdc,0x94,0xa2,0x02,0x00,0x9e,0x3a,0xcb,0x04,0xff,0x55,0x1b,0x1b,0xcc,0xc0,0xc0,
+	0xf4,0xca,0xff,0xb2,0xb2,0x0b,0x00,0x56,0x2b,0xff,0x86,0xff,0x09,0x00,0xbd,0x02,
+	0x5e,0xc0,0xea,0x1c,0xff,0x07,0x01,0x49,0x1b,0xe0,0x0d,0x00,0x88,0x85,0x56,0xdb,
+	0x08,0x3c,0xf7,0x01,0xdb,0x08,0x15,0x06,0x8f,0x04,0x0c,0xcf,0x0c,0x2e,0xb2,0x3a,
+	0x24,0x00,0x14,0x00,0x0d,0x00,0xd7,0xc6,0xf5,0xff,0x68,0x07,0xf0,0x9b,0x0f,0x4d,
+	0x02,0xff,0x9c,0x73,0x26,0x13,0x53,0x0e,0x63,0xd9,0xff,0x7e,0x20,0x03,0xc8,0x22,
+	0x8e,0x55,0x82,0xff,0x0a,0x47,0x10,0xa1,0x1b,0x90,0x28,0x83,0xff,0x86,0x01,0x00,
+	0xad,0x03,0x65,0x05,0x00,0xff,0x2d,0x0a,0xac,0xe4,0xac,0xc6,0x96,0x82,0xbf,0x02,
+	0x8c,0x33,0x22,0xa8,0x54,0xb5,0x02,0xf1,0xff,0xff,0x82,0x28,0x2e,0x4a,0xc2,0x88,
+	0x38,0xef,0xbd,0x06,0x5e,0xd5,0x56,0x10,0x08,0x00,0x2e,0xfb,0x44,0x89,0x15,0x09,
+	0xa0,0x29,0x93,0x1d,0xf0,0xdf,0x22,0xa8,0x30,0x1d,0xf0,0x3d,0x00,0x01,0x00,0xff,
+	0xce,0xf0,0xf2,0x5e,0x81,0x03,0x44,0x22,0xff,0xad,0x03,0xa5,0x00,0x00,0xbe,0xf3,
+	0xf2,0xf3,0x5c,0x01,0x0c,0x00,0x77,0x00,0x9c,0x62,0x26,0x12,0xff,0x18,0x0e,0x62,
+	0x94,0x5e,0x20,0x03,0xc0,0x3b,0x22,0x3e,0x75,0x10,0x40,0x23,0x83,0xac,0x00,0x9c,
+	0x00,0xbf,0x0c,0x72,0x1d,0xf0,0x1c,0xe2,0x23,0x09,0x94,0xdf,0x60,0x00,0x20,0x00,
+	0x61,0xab,0x08,0x8c,0xd2,0xff,0x8c,0xb3,0x8c,0x96,0x71,0xfb,0xff,0xcc,0xdf,0x94,
+	0x0c,0x02,0x29,0x67,0x66,0x10,0xa8,0x67,0xff,0x5e,0xba,0x68,0x0e,0xa7,0x04,0x65,
+	0x1b,0xff,0xa7,0x28,0x1e,0xa8,0x77,0xf8,0x13,0xd8,0xff,0x02,0xb8,0x97,0xc8,0x73,
+	0xfe,0xdd,0x2e,0xff,0x00,0x27,0x01,0xad,0x1b,0x25,0x76,0x00,0xf3,0xd6,0xba,0xc4,
+	0x00,0x4c,0x08,0x22,0xa8,0x46,0x1d,0xff,0xf0,0xb8,0x97,0x88,0x57,0xe8,0x73,0xd2,
+	0xff,0x23,0x13,0x88,0x28,0xb0,0xbe,0xa0,0xee,0xdb,0xdd,0x5a,0xc2,0x08,0x2e,0xdd,
+	0x12,0x03,0x00,0xad,0xfe,0xca,0x04,0xcc,0x3a,0x22,0xa8,0x33,0x1d,0xf0,0xff,0xc1,
+	0xb7,0xff,0x41,0xe1,0xff,0xc2,0x2c,0xff,0x2f,0xad,0x03,0xb8,0x97,0x40,0xcc,0xa0,
+	0xdf,0xe5,0x1f,0x01,0xd6,0x6a,0x49,0x14,0xd8,0x67,0xff,0xf8,0x93,0xe8,0x02,0x1b,
+	0xdd,0xd9,0x67,0x7f,0xfa,0xee,0xe9,0x02,0x5e,0xbd,0x62,0x3c,0x00,0xfd,0x61,0xfd,
+	0x03,0xcd,0x06,0xbd,0x05,0xad,0x04,0xdf,0xd8,0xa3,0x65,0x8e,0x08,0x29,0x0c,0x5d,
+	0x0c,0xef,0x00,0x00,0x8c,0x12,0x31,0x00,0x20,0x00,0x00,0xfe,0xeb,0x01,0x9c,0x22,
+	0x9c,0x03,0x51,0xa1,0xff,0x77,0x3e,0x14,0x0a,0xce,0x09,0xa2,0x65,0x34,0x26,0x04,
+	0xff,0xfe,0xf8,0xfa,0x06,0x07,0x11,0x45,0x1b,0xff,0x81,0xf4,0xff,0xa2,0x25,0x34,
+	0x41,0xf4,0xef,0xff,0x8e,0xda,0xa6,0x1d,0x03,0x61,0x1b,0xa0,0xff,0x44,0xc0,0xc6,
+	0x03,0x00,0xae,0x6a,0x38,0xfe,0x0d,0x0b,0xae,0x68,0x24,0x05,0xe7,0x0d,0xa5,0xff,
+	0x1b,0xa2,0x25,0x30,0xb2,0x25,0x32,0xcd,0xef,0x04,0xde,0x42,0x0e,0x25,0x00,0x81,
+	0x1b,0xe5,0xff,0x67,0x00,0x6e,0xba,0xf9,0x1f,0xe7,0x0e,0xdf,0x59,0x1b,0x47,0x29,
+	0x2d,0x1a,0x00,0x82,0x25,0xff,0x2e,0xd1,0xe4,0xff,0xe0,0xe4,0x11,0x88,0xdd,0x28,
+	0xdf,0x14,0xbe,0xb4,0x4c,0xdf,0x18,0x9a,0x8e,0xcf,0xf8,0xfa,0x08,0x47,0x6f,0x00,
+	0x96,0x00,0xdd,0x03,0xff,0xa2,0x25,0x32,0xbd,0x06,0xcd,0x01,0x25,0xff,0xb6,0x00,
+	0x1e,0x7a,0xfd,0xde,0xc0,0x02,0xef,0x58,0x22,0x9e,0x45,0x2b,0x00,0x01,0x85,0x1b,
+	0xf7,0xbe,0x42,0x0a,0x57,0x03,0x81,0x1b,0xd0,0xac,0xff,0x93,0x92,0xd9,0x06,0x4a,
+	0xbb,0xbe,0x72,0xff,0x09,0x2a,0xe1,0x00,0x80,0x22,0x92,0x65,0xef,0x34,0x86,0xd1,
+	0xff,0xcf,0x00,0x41,0x00,0x31,0xff,0x6e,0xff,0xc2,0xa4,0x00,0xae,0x43,0x0d,0x7a,
+	0x30,0x0c,0x43,0x74,0x05,0x85,0x1b,0xe5,0x5e,0x27,0x01,0xff,0x96,0xea,0x00,0xa2,
+	0x23,0x32,0xbd,0x03,0xff,0x65,0x00,0x01,0x88,0x13,0xa0,0xa8,0xb3,0xf6,0x0f,0x0d,
+	0x60,0x5b,0xcb,0x09,0xb1,0xfe,0xff,0xcd,0x7f,0x03,0xad,0x02,0xb8,0x0b,0xa5,0x8c,
+	0x52,0x0d,0xfe,0x13,0x00,0xbc,0x02,0xee,0x23,0x08,0x04,0xc7,0xfe,0x16,0x01,0x37,
+	0x28,0x26,0x41,0x58,0xff,0x82,0xff,0x24,0x2e,0xcd,0x02,0xb1,0xf4,0xff,0x88,0x7f,
+	0x38,0xdd,0x03,0xbe,0x4b,0x0a,0x1c,0x8a,0x04,0xf6,0xbe,0x00,0xee,0x0a,0x8f,0x07,
+	0x59,0x1b,0x22,0xa8,0x9d,0x44,0x02,0x12,0x32,0x64,0x35,0x94,0x09,0x43,0x00,0xac,
+	0xff,0xb2,0x41,0x49,0xff,0x88,0x03,0xd2,0x24,0x6f,0x36,0xd7,0x28,0x21,0x40,0x00,
+	0xc1,0xe4,0x3e,0x00,0xef,0xbd,0x02,0xce,0x4c,0x3e,0x60,0x92,0x24,0x36,0xf9,0x99,
+	0xa9,0x03,0x3f,0x0c,0xe2,0xac,0xc3,0xa1,0x39,0xfe,0x41,0x04,0x2a,0x36,0xd7,0xa8,
+	0x04,0x22,0xa8,0xff,0x5b,0x1d,0xf0,0xd9,0x03,0xa6,0x1d,0x14,0x1f,0x82,0x2a,0x2e,
+	0xc1,0xd1,0x4b,0x34,0x60,0x07,0x42,0x08,0xfe,0x3b,0x08,0xa1,0x2b,0xff,0xa2,0x2a,
+	0x30,0xbd,0x57,0x02,0x65,0x66,0x25,0x12,0x50,0xbb,0x02,0xdc,0x03,0x00,0xff,0x14,
+	0x9d,0x60,0x20,0xf0,0x6a,0x00,0x20,0x35,0xf2,0x03,0x00,0xb0,0x03,0x00,0x48,0x52,
+	0x0d,0x02,0x17,0x02,0xfd,0x50,0xff,0x0f,0xb1,0xf7,0xff,0xf1,0xba,0xff,0xff,0x39,
+	0x01,0x2e,0x72,0x35,0x62,0x81,0x03,0xff,0xa4,0x22,0xee,0x45,0xbc,0x01,0x67,0x01,
+	0xdf,0x81,0x1b,0x2e,0xf0,0xf6,0x4d,0x01,0x1d,0x1b,0xdf,0xee,0x77,0x08,0x01,0xa7,
+	0x70,0x00,0x8e,0xce,0xff,0x23,0x7e,0x81,0x03,0x64,0x22,0x91,0xec,0xff,0xff,0xc9,
+	0x11,0xe0,0x8e,0x90,0x9a,0x88,0xff,0xa0,0x08,0x00,0xc6,0x1c,0x00,0x06,0x95,0xff,
+	0x00,0x46,0x8c,0x00,0x86,0x86,0x00,0x06,0xff,0x7c,0x00,0x46,0x66,0x00,0x46,0x55,
+	0x00,0xff,0xc6,0x46,0x00,0x46,0x35,0x00,0x06,0x2a,0xbf,0x00,0x06,0x1d,0x00,0x62,
+	0x65,0x2f,0x02,0x12,0xfb,0x25,0x43,0xfc,0x02,0x3a,0xd6,0x62,0x01,0xbe,0xff,0x45,
+	0xba,0x09,0x27,0x11,0x81,0x1b,0xa7,0xdf,0x12,0x0b,0xa6,0x2b,0x30,0x1c,0x10,0x41,
+	0x00,0xff,0xe8,0x01,0xb2,0x25,0x1b,0xb9,0x0e,0xc8,0xff,0x07,0xd1,0xfa,0xfe,0xd9,
+	0x04,0xb7,0x1c,0xff,0x12,0x66,0x2b,0x0f,0x82,0x25,0x10,0x88,0x8f,0x58,0xbe,0x45,
+	0xaa,0x3f,0x02,0xed,0x08,0xd2,0x04,0xce,0xab,0xfb,0xf6,0x3d,0x01,0x45,0x35,0x04,
+	0xbe,0x25,0x06,0x07,0xdf,0x81,0x1b,0x6e,0xe6,0x3d,0x12,0x00,0xa5,0x1b,0xbb,0xa5,
+	0x3f,0x69,0x03,0x1e,0x86,0x7d,0x88,0x01,0x00,0xff,0xa1,0xc4,0xff,0xdd,0x0b,0xbe,
+	0x4d,0x4e,0xfe,0x72,0x02,0x81,0x1b,0xe2,0x65,0x18,0xc8,0x5d,0xff,0xed,0x0f,0xd8,
+	0x6d,0xe8,0x0e,0xe5,0xb8,0xfd,0xff,0x18,0x02,0xaa,0x00,0xf2,0x25,0x23,0xfe,0xdb,
+	0x75,0x82,0xd4,0x02,0x81,0x1b,0x82,0x00,0x46,0xd9,0xff,0xff,0x21,0xb9,0xff,0xe5,
+	0xdb,0x01,0xcd,0xff,0x02,0xad,0x02,0xb2,0x25,0x1f,0xd2,0x25,0xff,0x20,0x65,0x13,
+	0x01,0x2d,0x0a,0xe6,0x1a,0xff,0x02,0x86,0xd2,0xff,0x0c,0xa2,0x22,0x65,0xef,0x1b,
+	0x4e,0xf2,0xf2,0x77,0x08,0x00,0x00,0xbd,0xff,0x02,0xf1,0xab,0xff,0xad,0x03,0xe1,
+	0xad,0xff,0xff,0xc8,0x2f,0xd8,0x1f,0xf8,0x3f,0x65,0xfb,0xbe,0xff,0x29,0x08,0x06,
+	0xc8,0xff,0xbe,0x45,0x7d,0xfa,0x24,0x00,0x81,0x1b,0xde,0x45,0x0c,0x78,0x00,0xba,
+	0x86,0x02,0x0e,0x44,0x00,0x96,0xba,0xf0,0xe2,0x04,0x33,0xff,0x00,0x0c,0x99,0x92,
+	0x65,0x1b,0x86,0xbe,0xfe,0xb7,0x02,0x25,0xd5,0x01,0xc1,0x9c,0xff,0x0c,0x6f,0x2b,
+	0xce,0xac,0x3d,0x57,0x0b,0x65,0x0c,0x6c,0x0c,0xff,0x46,0xb7,0xff,0x21,0x98,0xff,
+	0xa2,0x02,0xff,0x41,0xa0,0x86,0x04,0xa0,0xa3,0x24,0xa2,0xff,0x65,0x21,0x16,0x98,
+	0x17,0xce,0xe8,0xf2,0xfb,0x0a,0x27,0x2b,0x0b,0xbd,0x02,0xad,0x03,0xd1,0xff,0x8c,
+	0xff,0xcd,0x06,0xe1,0x8d,0xff,0xde,0xfb,0x4d,0x1f,0x1a,0x0b,0xa5,0xb6,0xff,0x38,
+	0x11,0xbe,0x7f,0x0c,0xa8,0xff,0xae,0x00,0x0b,0x8f,0x03,0xa1,0xef,0x1b,0xce,0x00,
+	0x0d,0x1c,0x00,0xa1,0x1b,0xe5,0x7d,0x06,0x7f,0x08,0xe8,0x9d,0x03,0x86,0xe0,0x76,
+	0x00,0x6f,0x00,0x3e,0xa3,0x3c,0x29,0x09,0x65,0xbf,0xb2,0x0c,0xff,0x46,0x9b,0xff,
+	0xae,0x7d,0xfb,0x00,0x47,0xfe,0xe3,0x01,0x65,0xad,0x00,0x21,0x74,0xff,0xae,0xf5,
+	0x74,0x0d,0x10,0xac,0x6c,0x00,0xa2,0x25,0x1d,0xe5,0xbd,0x9c,0x40,0x04,0xaa,0xe4,
+	0x21,0x6d,0xad,0x00,0x2e,0xfb,0xa2,0x3c,0xad,0x08,0xe5,0x97,0x01,0xdd,0x0a,0xfd,
+	0xa6,0x70,0x00,0x49,0x00,0x06,0x44,0x00,0xad,0xb7,0x03,0x25,0x8a,0xbd,0x0c,0xc6,
+	0x87,0x16,0x01,0xbe,0xd3,0x64,0xfc,0x24,0x00,0x41,0x00,0xb9,0x62,0x00,0x0e,0xfc,
+	0x77,0xf9,0x01,0x47,0x34,0x09,0x00,0x65,0xc5,0x0f,0x00,0xff,0x56,0xda,0xdf,0xa1,
+	0x82,0xfe,0x65,0xc4,0xb7,0x00,0x06,0xa2,0x8e,0x04,0x25,0xc4,0x86,0x0c,0x86,0xff,
+	0x79,0xff,0xa1,0x7c,0xfe,0xe5,0xc2,0x00,0x3d,0xa5,0x49,0x04,0xde,0xe7,0xf9,0x00,
+	0x34,0x0c,0xe3,0x41,0xfb,0x65,0x21,0xda,0x02,0xd6,0x9a,0x03,0x06,0x14,0xfe,0xe5,
+	0x05,0xb1,0x0d,0xff,0xa2,0x25,0x14,0xc1,0xdb,0x4d,0xff,0xc6,0x03,0x5c,0x00,0x4b,
+	0x0c,0x66,0xff,0x77,0xae,0x75,0x8d,0xd8,0x09,0xde,0x75,0xbc,0x8d,0x09,0x3f,0xc2,
+	0x65,0x17,0x8e,0xd4,0xf2,0xc9,0x02,0x88,0x08,0x7f,0xc2,0x25,0x17,0xcc,0x6c,0x1e,
+	0x01,0x83,0x03,0xff,0x00,0x41,0x1b,0xa1,0xfc,0xfe,0xb1,0x3a,0xdf,0xff,0xa8,0x0a,
+	0x65,0x42,0x3d,0x04,0x12,0x02,0x7f,0x06,0x57,0xff,0xee,0xdd,0xf2,0x01,0x2a,0x10,
+	0xff,0xc1,0x38,0xff,0xe0,0xba,0x11,0xca,0xbb,0xff,0xb8,0x0b,0xb2,0x65,0x20,0xa5,
+	0x9c,0xff,0xff,0xc2,0x02,0x40,0xa2,0x65,0x22,0xca,0xba,0xff,0xae,0x2a,0xfc,0x80,
+	0x21,0x01,0x1c,0x22,0xff,0xce,0x75,0x3b,0x7e,0xe1,0x02,0x84,0x22,0xaf,0xb2,0x65,
+	0x1f,0xc2,0x31,0x02,0x86,0x16,0x01,0xe6,0xff,0x1a,0x35,0xde,0x2d,0x3e,0x0b,0x07,
+	0x11,0x7f,0xa5,0x1b,0xd0,0x2e,0x83,0x46,0x43,0xe6,0x04,0xaf,0xbd,0x02,0xe1,0x21,
+	0x94,0x00,0xec,0x8c,0x08,0x3e,0xdb,0xa3,0x3f,0x44,0x09,0x25,0x9b,0x88,0x06,0x0a,
+	0xcf,0xdf,0x6e,0xe1,0xf3,0x00,0x67,0x6e,0x00,0xb1,0x15,0xff,0xff,0xe1,0x17,0xff,
+	0xf2,0x25,0x20,0xa2,0xdb,0x65,0x1e,0xa6,0x15,0xe5,0x98,0x23,0x00,0xce,0xd8,0x97,
+	0xf9,0x00,0x87,0x20,0x00,0xb0,0xc7,0x03,0xe3,0x03,0x31,0xff,0x0b,0xff,0x0c,0x08,
+	0x82,0x63,0x18,0xcc,0xfd,0x32,0xf7,0x0b,0x98,0x62,0x92,0x63,0x16,0x65,0x7f,0xb0,
+	0x01,0xe5,0x5a,0x00,0xd6,0x5a,0xf5,0x13,0xff,0xa1,0x85,0xfe,0xa5,0xb4,0x01,0xa2,
+	0x63,0xbf,0x1a,0xcc,0x6a,0x22,0xa8,0x32,0x11,0x04,0x00,0xff,0xa8,0x02,0xb8,0x12,
+	0xc1,0xef,0xff,0xe5,0xef,0x2c,0x00,0xd6,0x6a,0x25,0x10,0x00,0xa8,0x82,0xff,0xe5,
+	0xc7,0x01,0xa8,0x72,0xe5,0x90,0x00,0xff,0xa1,0x1d,0xfe,0xb8,0x62,0xe5,0xb7,0x00,
+	0xfb,0xd6,0x4a,0x1b,0x0c,0xa2,0x23,0x18,0xb2,0x23,0x6f,0x1a,0xe5,0x74,0x01,0x2c,
+	0x1c,0xa5,0x7e,0x39,0x20,0xfa,0xf2,0x01,0xa5,0x1b,0x20,0x65,0x51,0x00,0xa8,0xa2,
+	0x7f,0xb8,0x92,0xb2,0x63,0x20,0xae,0x73,0x24,0x07,0x83,0x81,0x1b,0x16,0x04,0xab,
+	0x00,0x1d,0x08,0x00,0x14,0x0f,0x00,0x48,0xff,0x92,0x37,0x24,0x1a,0xa8,0x52,0x58,
+	0x22,0xff,0x3a,0xaa,0xbd,0x05,0x65,0xd8,0xfe,0xa9,0xff,0x52,0xa8,0x62,0x30,0xb4,
+	0xc0,0xb9,0x92,0xff,0x3a,0xaa,0xa7,0x25,0x08,0xa9,0x62,0x0c,0x9d,0x02,0x31,0x08,
+	0x22,0xa8,0x3d,0x07,0x00,0x2f,0x00,0x7e,0xff,0x02,0x0a,0x06,0x07,0x11,0x59,0x1b,
+	0x46,0xff,0x04,0x00,0xad,0x02,0xb8,0x92,0xe5,0xfb,0xff,0xff,0x96,0x7a,0x00,0x0c,
+	0x0a,0xa9,0x92,0x2f,0xa9,0xa2,0xa9,0x82,0x7c,0x04,0xa8,0x13,0x01,0x5b,0x08,0xfd,
+	0x81,0x93,0x00,0xcd,0x06,0x3d,0x04,0x4d,0x05,0xfe,0x17,0x11,0xb8,0xa2,0xa9,0x61,
+	0xb7,0x25,0x41,0xff,0xc9,0x31,0x78,0x82,0x68,0x32,0xb0,0x85,0xff,0xc0,0x8a,0x77,
+	0xbd,0x06,0x7a,0xa3,0xa9,0xff,0x41,0xa5,0xc9,0xfe,0x5d,0x0a,0xbd,0x06,0xff,0xa8,
+	0x41,0xa5,0xd0,0xfe,0xb8,0x92,0x1b,0xff,0x95,0xa0,0x59,0x93,0x57,0xab,0x05,0xb0,
+	0xff,0x55,0xc0,0x46,0x00,0x00,0x0c,0x05,0x96,0xff,0xf7,0x00,0xc8,0x22,0x57,0x2c,
+	0x02,0xb7,0xff,0xac,0x0e,0x9e,0x07,0x02,0x08,0x07,0x11,0xff,0x55,0x1b,0x22,0xa8,
+	0x3f,0x1d,0xf0,0x1d,0xff,0xf0,0xa6,0x15,0x25,0x98,0x72,0x66,0x15,0xfd,0x02,0x6f,
+	0x00,0x76,0xa5,0x1a,0x1e,0x19,0x7b,0xff,0x60,0x21,0x00,0xc0,0x22,0xc6,0x2c,0x00,
+	0xff,0xbe,0x72,0x99,0x3e,0xe1,0x02,0x80,0x22,0xdf,0x9e,0x72,0x75,0xbe,0xe0,0x07,
+	0x00,0x77,0xa6,0xff,0x0e,0xad,0x07,0xbd,0x06,0x25,0xc3,0xfe,0xef,0x9d,0x0a,0x06,
+	0x01,0x9c,0x04,0x0c,0x09,0x58,0xdf,0x61,0x99,0x51,0x16,0x05,0x15,0x00,0xad,0x07,
+	0xff,0x25,0xc9,0xfe,0xa9,0x11,0xa6,0x13,0x64,0xf7,0x6e,0x41,0x5b,0x80,0x02,0x81,
+	0x1b,0xb9,0x21,0xff,0xb8,0x22,0xe8,0x11,0xa8,0x52,0xc8,0x21,0xff,0xd8,0x32,0x6a,
+	0xaa,0xc0,0xc3,0xc0,0xe0,0xff,0xdd,0xc0,0xd0,0xcc,0x43,0xc9,0x01,0xa5,0xff,0xc6,
+	0xfe,0xb8,0x21,0xc8,0x11,0xe8,0x12,0xff,0xd8,0x02,0x81,0xc6,0xff,0xa0,0xee,0x82,
+	0xff,0xea,0xdd,0x88,0x08,0xd0,0xcc,0xa0,0xd8,0xff,0x01,0x88,0x38,0x50,0xbb,0xa0,
+	0x2e,0xdd,0xff,0xfa,0x1c,0x07,0x00,0xad,0x1b,0xe0,0x08,0xef,0x00,0x6e,0x6a,0x08,
+	0x4a,0x00,0x55,0x1b,0x98,0xff,0x01,0xf8,0x21,0x89,0x11,0x9a,0xff,0xf9,0xff,0x21,
+	0x3e,0xdf,0x96,0xc0,0x20,0x00,0x74,0xff,0x22,0xa8,0x31,0x16,0x0a,0x04,0x26,0x1a,
+	0xff,0x1d,0xe6,0x14,0x11,0x78,0x82,0x3a,0x77,0xfb,0x46,0x05,0x8a,0x11,0x22,0xa8,
+	0x43,0x1d,0xf0,0xbf,0x78,0x41,0x4a,0x83,0x89,0xa2,0xf6,0x00,0x49,0xf7,0xa2,0x68,
+	0x32,0xb2,0x04,0x65,0xbf,0xfe,0xa9,0xfd,0x82,0xa3,0x04,0x65,0xb7,0xfe,0xbd,0x0a,
+	0xad,0x97,0x02,0xe5,0xe4,0xa1,0x0a,0xf0,0x95,0x11,0x37,0x08,0x44,0xfc,0xd2,0x1d,
+	0x9f,0x01,0x16,0x62,0x06,0x16,0x33,0x06,0xff,0x88,0x62,0xa6,0x18,0x54,0xcd,0x03,
+	0x81,0xff,0x9d,0xff,0xb8,0x02,0xf8,0x12,0x88,0x08,0xff,0xe8,0x42,0xdd,0x0f,0x88,
+	0x38,0xf0,0xee,0x7f,0x82,0xee,0xbb,0x2a,0x1c,0x07,0x01,0xa3,0x08,0xff,0xbc,0x2a,
+	0x38,0x22,0xa8,0x42,0x3e,0xb3,0xff,0x3a,0x40,0x21,0x01,0xa4,0x22,0xf0,0x20,0xf7,
+	0x00,0xa5,0xb8,0x72,0x02,0xcd,0x0a,0xa8,0x72,0xf7,0xce,0x72,0x4b,0x43,0x03,0x80,
+	0x22,0xb9,0x62,0xf7,0x3e,0xba,0x3d,0x1d,0x00,0x60,0x22,0xde,0x72,0x7d,0x72,0x1a,
+	0x09,0x1d,0xf0,0x22,0xa8,0x3b,0x04,0x04,0xf5,0x3e,0x04,0x04,0x30,0x79,0x08,0x10,
+	0x00,0x00,0xc0,0xdf,0x6d,0x00,0x20,0xf0,0x6d,0xf7,0x11,0x41,0x00,0xff,0x9e,0xfb,
+	0xf8,0x1c,0x87,0x07,0x1d,0x1b,0xff,0x37,0x28,0x02,0x27,0xa9,0x07,0x4e,0x0d,0xff,
+	0x09,0x07,0x67,0x10,0x41,0x1b,0x81,0x79,0xff,0xff,0x88,0x08,0x51,0xf5,0xff,0x88,
+	0x28,0xf7,0xce,0x00,0x0a,0x28,0x01,0xa1,0x1b,0x5e,0xb5,0xe7,0x3d,0x04,0xc7,0x53,
+	0x03,0x8c,0x00,0x39,0x25,0x39,0xbf,0x65,0x29,0x15,0xbe,0xef,0xf9,0xab,0x02,0x1d,
+	0xff,0x1b,0x99,0x75,0x99,0x55,0x99,0x45,0x99,0xff,0x95,0x99,0xa5,0x99,0x85,0xbe,
+	0x75,0x0a,0xff,0x40,0x60,0x00,0x80,0x22,0x20,0xa2,0xb3,0xff,0xa0,0xa2,0x21,0xa9,
+	0x35,0x59,0x04,0x2d,0xfd,0x09,0x77,0x04,0x70,0x5b,0x00,0x20,0x70,0x31,0xfe,0x7f,
+	0x03,0x61,0x00,0xbc,0x32,0xbc,0x13,0x3e,0xfb,0xc4,0xfc,0xa1,0x00,0xc5,0x1b,0x41,
+	0xfa,0xff,0x7f,0x20,0xa2,0x20,0x4e,0xb4,0x38,0x00,0x59,0x04,0xff,0x76,0xa8,0x11,
+	0x92,0x0b,0x00,0xd2,0x0a,0xbf,0x14,0x1b,0xaa,0xde,0x09,0x6b,0x1f,0x02,0x80,0xff,
+	0x22,0x1b,0xcc,0xa6,0xac,0x09,0x22,0xa8,0xfd,0x61,0xc0,0x10,0xfd,0x02,0xad,0x03,
+	0xbe,0xee,0xff,0xfc,0x44,0x80,0x01,0x1c,0x22,0xde,0x00,0xf7,0x09,0x02,0x47,0x97,
+	0x00,0x9e,0x71,0x08,0x02,0xee,0xed,0x04,0x8e,0x71,0x1e,0xf5,0x08,0xa5,0x08,0x04,
+	0x7f,0x0e,0x4a,0x92,0x0b,0xe7,0x10,0xc1,0x45,0x0b,0xff,0x00,0x4b,0x23,0xa2,0x04,
+	0x0c,0xae,0x4a,0xff,0x1b,0x00,0x07,0x02,0x61,0x1b,0x25,0xa5,0xff,0xfe,0xb2,0x03,
+	0x00,0x1b,0x44,0xbe,0x0a,0xf7,0xe3,0x60,0x20,0x5f,0x00,0x27,0x93,0xe1,0x0c,0xe5,
+	0x12,0x33,0x13,0x60,0x33,0x07,0x9f,0x00,0xd2,0xbc,0xb3,0xff,0xa6,0xc4,0x39,0xad,
+	0x03,0xfd,0x02,0x7e,0xef,0xd3,0xf9,0x02,0x47,0xe1,0x00,0x9e,0x71,0x06,0xfb,0x44,
+	0x80,0x2d,0x00,0x6e,0xc6,0x38,0x02,0x07,0xee,0xa8,0x00,0x8e,0x71,0x1d,0x6a,0x08,
+	0x7e,0xb7,0x3e,0xfe,0x01,0x01,0xa5,0x1b,0x65,0x01,0x04,0x26,0x4a,0xcf,0x0c,0x22,
+	0xa8,0x5f,0x49,0x10,0xa9,0x00,0x3e,0x43,0x77,0x35,0x60,0x80,0xa9,0x01,0xa2,0x04,
+	0x00,0x7b,0x14,0xfe,0xb4,0x01,0x65,0x9d,0xfe,0xae,0x84,0x04,0x80,0xfe,0x79,0x04,
+	0x57,0x94,0xe3,0x2e,0x42,0x35,0x42,0xda,0x23,0x0c,0x14,0x23,0x20,0x25,0x9b,0x23,
+	0x00,0x44,0x80,0xeb,0x20,0x01,0x23,0x08,0xfd,0x95,0x03,0xbd,0x07,0xad,0xdf,0x02,
+	0xee,0x00,0x0d,0x00,0xed,0x04,0xde,0x71,0xfd,0x0d,0xe5,0x0c,0xf5,0x03,0xf2,0xca,
+	0xec,0x2e,0xf7,0x5e,0x8e,0x04,0x9b,0x05,0xf0,0x2e,0x83,0x1d,0x7f,0xf0,0xf0,0x09,
+	0x01,0x20,0x7c,0x5b,0x63,0x0d,0xbf,0x42,0x2e,0x33,0x08,0x05,0xa7,0xd3,0x02,0x47,
+	0xff,0xa8,0x2a,0x61,0xfa,0xff,0xa8,0x06,0x71,0xff,0x05,0xff,0x51,0x9f,0xff,0xec,
+	0x3a,0x88,0xff,0x07,0x88,0x38,0xae,0xe0,0x0c,0x44,0x00,0xb7,0x00,0xa0,0x22,0xd1,
+	0x01,0x00,0x67,0xd1,0x0d,0xcc,0xf9,0x8a,0x9a,0x0a,0xba,0x08,0xa8,0x06,0x0c,0x89,
+	0xae,0xdb,0xe9,0x74,0x54,0x01,0x61,0x1b,0x80,0x03,0x21,0xeb,0xff,0xff,0x0c,0x44,
+	0xfd,0x02,0x49,0x01,0xad,0xff,0x03,0xb1,0x8f,0xff,0xcd,0x05,0xde,0x00,0xfd,0x0e,
+	0x81,0x00,0xa1,0x1b,0xa5,0xed,0x03,0xae,0xef,0x2a,0x3b,0x84,0x00,0xc0,0x00,0xb7,
+	0x1a,0x07,0xf7,0x22,0xa8,0x5e,0xfc,0x08,0xc8,0x06,0xe8,0x07,0xef,0xee,0x4e,0x3c,
+	0x80,0xbc,0x05,0xc9,0x06,0xf6,0xff,0x9c,0x18,0xbd,0x05,0xcd,0x03,0xde,0x10,0x7e,
+	0x42,0x0e,0xe0,0x0e,0x00,0x5e,0x9a,0xf2,0x6b,0x0b,0xff,0x1d,0xf0,0xcd,0x05,0x3a,
+	0xba,0xae,0xe0,0x77,0x0d,0x00,0xc7,0x18,0x0c,0xce,0x7a,0xff,0x18,0x08,0x6f,0xfe,
+	0x76,0x02,0x42,0x6b,0x05,0x1d,0xf0,0x9b,0x02,0xb7,0x8e,0xcb,0xf3,0x62,0x0a,0x39,
+	0x08,0x5c,0x00,0x90,0x6f,0x2e,0x00,0x00,0xf8,0xe3,0x00,0x00,0x40,0xb7,0x0a,0xff,
+	0xa1,0xfc,0xff,0x65,0x5a,0x01,0x21,0xfb,0xff,0xff,0xa9,0x02,0xa1,0xfb,0xff,0xa5,
+	0x59,0xff,0x01,0x88,0x02,0xa9,0x22,0x8c,0xa8,0x8e,0xd3,0x0a,0x02,0x60,0x10,0x89,
+	0x05,0x32,0x6e,0x13,0x20,0x0a,0xdb,0x01,0x20,0x33,0x00,0xcc,0x34,0xe1,0x08,0xa6,
+	0x42,0xaf,0x04,0x22,0xa8,0x4a,0x07,0x00,0x23,0x07,0x00,0x4b,0xff,0x1d,0xf0,0x61,
+	0xf8,0xff,0x20,0x22,0x90,0xff,0x30,0x53,0x90,0x60,0x55,0xa0,0x50,0x22,0x3f,0xb0,
+	0x28,0x22,0x2e,0x74,0x02,0x41,0x13,0x32,0x07,0xfc,0x3b,0x00,0xb3,0x1b,0xe1,0x00,
+	0xac,0x52,0xac,0x34,0xff,0xac,0x15,0xad,0x02,0x2e,0xb2,0x3c,0x01,0xfd,0xa7,0xfc,
+	0x05,0xb6,0x06,0xc1,0xf7,0xff,0x16,0xff,0xd3,0x1b,0x26,0x13,0x11,0x26,0x23,0x0e,
+	0xe7,0x22,0xa8,0x49,0x73,0x10,0x6a,0x08,0xd8,0x2c,0x2e,0xf7,0xa2,0x3d,0xa0,0xb3,
+	0x07,0xd9,0x2c,0xae,0x9a,0xef,0x36,0x00,0x07,0x09,0xe7,0x02,0xa6,0x0d,0x20,0xff,
+	0x21,0x06,0x8e,0xb0,0x70,0x00,0xa0,0x01,0x7f,0x86,0x20,0x94,0x01,0x03,0xee,0x43,
+	0x52,0x01,0xff,0x04,0x55,0x1b,0x98,0x0c,0x8e,0x1a,0x10,0xff,0x07,0x02,0x03,0xc4,
+	0x3a,0xbd,0x09,0x8e,0xcd,0x29,0x09,0x0c,0x8e,0x89,0x07,0x0c,0x19,0x02,0x76,0xae,
+	0xef,0x1f,0x6e,0x9a,0x20,0x0d,0x00,0xc8,0x3a,0x6e,0xfd,0xab,0x15,0x04,0xc8,0x3a,
+	0x8e,0xb0,0x71,0x02,0xdf,0x80,0x05,0x84,0x20,0x6e,0x25,0x08,0xcc,0x3a,0xfb,0x8e,
+	0x09,0x1f,0x00,0x02,0xc4,0x3a,0x26,0x23,0xf7,0x09,0x0c,0x02,0x87,0x10,0x00,0xee,
+	0x1f,0x0a,0xbd,0x28,0xef,0x05,0xfe,0x4c,0x01,0x02,0x7a,0x02,0x30,0xff,0xbe,0x41,
+	0x80,0x05,0x25,0x03,0x63,0x1a,0xff,0x6e,0x7b,0x1d,0x07,0x22,0x06,0x80,0x30,0xff,
+	0xfe,0x7b,0x0e,0x07,0x22,0x04,0x80,0x30,0xff,0x8e,0x1f,0x10,0x42,0xe5,0xa7,0xc4,
+	0x20,0xff,0x8e,0x8f,0x10,0xe1,0x00,0x05,0xc4,0x30,0xff,0xfe,0x9f,0x30,0x63,0x19,
+	0x03,0xa5,0x20,0xff,0xae,0x86,0x08,0x00,0x07,0x05,0xb1,0x1b,0xff,0xfe,0xaf,0x30,
+	0x4b,0x0c,0x03,0xa4,0x20,0xbf,0x76,0xa8,0x17,0x6e,0x9a,0x30,0x7f,0x10,0x73,0x7f,
+	0x06,0x08,0x03,0x84,0x1a,0x6e,0x89,0x0f,0x04,0x7f,0xcc,0x3a,0xc2,0xc1,0x18,0xc8,
+	0x1c,0x84,0x14,0xff,0xc0,0xc0,0x04,0x56,0xbc,0x0b,0x3e,0xc2,0xfd,0x0b,0xc3,0x01,
+	0x81,0x1b,0xae,0x9f,0xfb,0x07,0xbf,0x22,0x07,0x1c,0x30,0x4e,0xc3,0x6d,0x00,0x05,
+	0xff,0x80,0x30,0x44,0x60,0xc2,0x50,0xa4,0x16,0xff,0x8e,0xb0,0x7e,0x07,0x42,0x05,
+	0x84,0x30,0xff,0x1e,0x8a,0x6c,0x46,0x01,0x01,0xb0,0x22,0xff,0x88,0x0a,0xd8,0x1a,
+	0xf0,0x98,0xa0,0x8e,0xff,0xdd,0x50,0x04,0x05,0x03,0xa7,0x1a,0x8e,0xfb,0x09,0x1d,
+	0x3c,0x01,0xc4,0x22,0xde,0x81,0x2a,0xdf,0x42,0x81,0x00,0xac,0x22,0x05,0x01,0x3d,
+	0xf0,0xbf,0x76,0xa8,0x0f,0x6e,0x89,0x60,0x7f,0x10,0x70,0xff,0x6c,0x04,0x6d,0x84,
+	0x18,0x07,0xed,0x48,0xff,0xd2,0xc1,0x40,0xde,0x80,0x09,0x2c,0x00,0xee,0x44,0x00,
+	0x94,0xd0,0x42,0x18,0x00,0x09,0x02,0x0d,0xff,0x84,0x20,0x14,0x0c,0xc2,0xc7,0x9a,
+	0xa9,0xfe,0x6b,0x05,0x59,0x01,0x84,0x2a,0x8c,0x68,0x04,0xff,0x06,0x44,0x44,0x00,
+	0xc2,0xb9,0x05,0xce,0xf7,0xac,0x3b,0x60,0x95,0x05,0x26,0x4b,0x02,0x86,0xff,0xdd,
+	0xff,0x06,0xb4,0xff,0xa8,0x0c,0x5e,0xff,0xeb,0xfd,0x01,0x07,0x01,0x45,0x1b,0x94,
+	0xf7,0x20,0x42,0xbe,0x4c,0x03,0x08,0x01,0x44,0x20,0xfb,0xa4,0x30,0x48,0x04,0x6b,
+	0x0a,0x03,0x84,0x20,0xbf,0x94,0x30,0xc2,0x86,0xcc,0xff,0x4e,0x05,0x68,0xff,0x42,
+	0x00,0x00,0xd8,0x59,0x00,0x00,0x04,0xfa,0x07,0x00,0xcc,0x03,0x00,0x67,0xd8,0xa5,
+	0x3f,0xa5,0x9f,0xe2,0xec,0xc3,0x88,0x45,0x1c,0x00,0x67,0x06,0x81,0xfd,0x00,0x50,
+	0x02,0x71,0xfa,0xff,0xa1,0xf8,0xff,0xff,0xb1,0xf7,0xff,0xc1,0xf4,0xff,0xd1,0x60,
+	0xff,0xff,0xd9,0x01,0xc9,0x11,0xb9,0x21,0xa9,0xff,0x31,0x79,0x41,0x71,0xf5,0xff,
+	0x38,0x31,0xff,0x48,0x21,0x58,0x11,0x28,0x01,0x59,0x22,0xff,0xad,0x04,0x25,0xc2,
+	0x07,0xd8,0x41,0xcd,0xff,0x07,0xe5,0x44,0x07,0x25,0x62,0x07,0xa9,0xdf,0x02,0xad,
+	0x03,0x25,0xc1,0x10,0x0c,0x43,0x07,0xff,0x25,0x61,0x07,0x42,0xd4,0x0c,0x52,0xd5,
+	0xbf,0x0c,0xa9,0x12,0x3e,0x53,0xc2,0x15,0x03,0x60,0xff,0x22,0x3e,0x43,0x85,0xae,
+	0x00,0x03,0x74,0xff,0x22,0x6e,0x05,0x24,0x8e,0x00,0x02,0x98,0xff,0x22,0xf1,0xe3,
+	0xff,0x62,0xd6,0x01,0x88,0xff,0x01,0xe8,0x11,0xa8,0x21,0xc8,0x31,0xe2,0xff,0xde,
+	0x01,0xa2,0xda,0x01,0xce,0x5c,0x18,0xfe,0xb6,0x03,0x60,0x22,0x8e,0x71,0x0c,0x92,
+	0x01,0x7f,0x02,0x80,0x22,0xce,0x71,0x3a,0x52,0x07,0x04,0xef,0xae,0x71,0x2e,0xd2,
+	0x07,0x04,0xe9,0x11,0xfe,0xff,0xae,0x76,0xd2,0x00,0x02,0x60,0x22,0x06,0xff,0xdd,
+	0xff,0xd1,0xd3,0xff,0xf1,0x2b,0xff,0xff,0xe1,0x47,0xff,0xd8,0x0d,0xf8,0x0f,0xf9,
+	0x77,0x1e,0xde,0x7e,0xf8,0x1e,0x50,0x52,0x00,0x33,0x07,0xff,0x41,0xf7,0xfd,0xd8,
+	0x04,0xd8,0x4d,0xac,0xff,0x1d,0x9c,0xf2,0x9c,0xd3,0xbd,0x02,0x3e,0x7f,0xc0,0xea,
+	0x1c,0x07,0x01,0x49,0x1b,0xb9,0x03,0xff,0x88,0x04,0x88,0x48,0xb1,0xf6,0xff,0xce,
+	0x8d,0x02,0xdd,0x13,0x08,0x00,0x71,0x0a,0x33,0x00,0x79,0x16,0x00,0xef,0x00,0x70,
+	0x47,0x40,0x33,0x03,0x1c,0xf8,0x0e,0xfb,0xd0,0x09,0x58,0x00,0xbd,0x1b,0x1e,0x90,
+	0x19,0xff,0x06,0x02,0x06,0xac,0x30,0x9e,0x71,0x08,0xbb,0x06,0x02,0x73,0x02,0x14,
+	0x01,0xc2,0xd3,0x01,0xa5,0xff,0x31,0x01,0xbd,0x02,0x5d,0x0a,0x2e,0xa2,0x73,0x3c,
+	0x00,0x52,0x07,0x11,0x00,0xe5,0x80,0x06,0x05,0x00,0xff,0x25,0x30,0x01,0x9d,0x02,
+	0x5e,0xca,0x5b,0xbb,0x22,0x00,0xaa,0x01,0x2e,0x7b,0x0a,0x25,0x03,0x81,0xff,0x1b,
+	0xa9,0x1b,0xc9,0x33,0xa9,0x51,0x22,0x7f,0x61,0x04,0x76,0xaa,0x0f,0x20,0x30,0x41,
+	0x02,0xff,0x71,0x02,0xa0,0x03,0x86,0x20,0x8b,0x22,0xff,0x94,0x21,0x03,0xa2,0xc1,
+	0x10,0x1e,0xc1,0xf7,0x3b,0x20,0x80,0x2e,0x00,0x25,0x9b,0x07,0x14,0xfd,0x51,0xbe,
+	0x05,0x44,0xeb,0xa5,0x84,0x20,0x4e,0xff,0xdd,0xf0,0x0b,0x34,0x05,0x1c,0x20,0xa8,
+	0xbf,0x01,0x14,0x46,0xc2,0x3e,0x84,0xe5,0x00,0x01,0xff,0xb1,0x1b,0x65,0xaa,0x07,
+	0xdd,0x04,0xcd,0xff,0x02,0x25,0x2d,0x07,0x65,0x4a,0x07,0xc8,0xff,0x41,0x10,0x39,
+	0x06,0xa9,0x13,0xae,0x5c,0xff,0x5b,0x07,0x47,0x00,0x61,0x1b,0xbe,0x71,0xff,0x8a,
+	0x54,0x81,0x00,0x80,0x22,0xa2,0x61,0xff,0x07,0x8e,0x0a,0x1d,0x02,0xa7,0x01,0xc5,
+	0xbf,0x1b,0x76,0xad,0x0f,0x6e,0x8a,0xf7,0x0e,0x1e,0xff,0x53,0x10,0x66,0x04,0x66,
+	0xac,0x18,0xa4,0xfd,0x80,0x61,0x04,0x69,0x20,0x21,0x84,0x20,0xcd,0xef,0x01,0x1e,
+	0x87,0x6b,0x79,0x00,0xb0,0x22,0x1e,0xf7,0xa7,0x6a,0x26,0x07,0x04,0xe5,0x92,0x07,
+	0xa8,0xfe,0x90,0x05,0xa2,0xca,0x55,0xa5,0xa2,0x07,0xcd,0xdf,0x02,0xdd,0x04,0xa5,
+	0x26,0xd7,0x05,0xc8,0x41,0xff,0xa0,0xba,0x20,0xa2,0xdc,0x06,0xbe,0x73,0xfb,0x2a,
+	0x4a,0x90,0x05,0x8e,0x0a,0x1b,0x01,0x47,0xbe,0x5f,0x04,0xab,0x18,0x6e,0x8a,0x50,
+	0x5f,0x08,0x10,0xff,0x39,0x66,0x8e,0xb0,0x76,0x6a,0x64,0x6b,0xff,0x84,0x18,0x14,
+	0x55,0x04,0x14,0x69,0x04,0xbf,0xd2,0xc1,0x34,0xd4,0x30,0x52,0x6b,0x00,0x50,0xff,
+	0xe7,0xb3,0x84,0x20,0xae,0x12,0x00,0xa1,0xff,0x80,0x05,0xbc,0x30,0x1e,0x90,0x70,
+	0x31,0xef,0x8d,0x50,0xa9,0x20,0x83,0x04,0x68,0x4f,0x84,0xee,0x07,0x04,0x0b,0x84,
+	0x51,0xf5,0x02,0xfe,0xc2,0x1e,0xff,0xef,0x60,0x6b,0x62,0x4f,0xb0,0x20,0x14,0xff,
+	0x00,0xf2,0x14,0xf1,0xe2,0x34,0xf5,0xc2,0xff,0x65,0x1b,0x01,0x50,0xea,0xc0,0xe9,
+	0x43,0xfa,0x9b,0x09,0x80,0xa7,0x06,0x41,0x00,0xcc,0x32,0x22,0xff,0xa8,0x30,0x1d,
+	0xf0,0x81,0xfc,0xff,0x88,0xbf,0x08,0x88,0x28,0x2e,0xb2,0x3a,0xda,0x01,0xa5,0xdf,
+	0x1b,0xde,0x60,0x0c,0x00,0xd0,0x11,0x0c,0x02,0x7f,0x1d,0xf0,0xcd,0xcc,0xcc,0x3e,
+	0x00,0xd7,0x0d,0xff,0x16,0xb2,0x08,0x16,0x83,0x08,0x2e,0xa2,0xfb,0x3b,0x72,0x90,
+	0x05,0x65,0xe2,0xff,0xc8,0x03,0xff,0x34,0x07,0x62,0xd1,0xf7,0xff,0xd4,0x11,0xff,
+	0x26,0xce,0xc1,0xd0,0x00,0x45,0x01,0xa4,0xdf,0x2a,0xce,0x73,0x0e,0x08,0x42,0x06,
+	0xe0,0xec,0xff,0x20,0x8c,0x08,0xe9,0x03,0xc2,0x23,0x11,0xff,0xd2,0x23,0x14,0x30,
+	0xcc,0xa0,0xd9,0xac,0x7f,0xa2,0x23,0x11,0x0c,0x7b,0xce,0xe0,0x7b,0x0d,0x9f,0x2e,
+	0x73,0x1a,0x40,0x21,0x5f,0x01,0xeb,0x05,0x88,0xef,0x07,0xce,0x43,0x0b,0x77,0x0a,
+	0xae,0x73,0x1d,0x6a,0x83,0x03,0x81,0x1d,0x00,0x2a,0x0f,0x08,0x8e,0x1c,0x8f,0x06,
+	0xff,0x55,0x1b,0x0c,0x7e,0x76,0xae,0x0e,0xa7,0xff,0x5c,0x03,0x1b,0xbb,0xb9,0x23,
+	0x1e,0x4b,0xbd,0xba,0x39,0x00,0xc0,0x22,0x1d,0xf0,0xbc,0x08,0xd9,0xcf,0x13,0xc6,
+	0xfc,0xff,0x9f,0x10,0xcf,0x14,0xc8,0xff,0xff,0xad,0x02,0x39,0x08,0xe5,0xf1,0xff,
+	0x2d,0xef,0x0a,0x1d,0xf0,0x84,0xeb,0x00,0x00,0x00,0xee,0xfd,0x5e,0x87,0x02,0x42,
+	0x61,0x10,0x16,0x92,0x1e,0xff,0x16,0x63,0x1e,0x16,0x34,0x1e,0xad,0x03,0xdf,0xbd,
+	0x03,0xc2,0x22,0x14,0x65,0x06,0x5a,0x06,0xff,0xd2,0x22,0x13,0x9d,0x03,0xad,0x03,
+	0x3e,0xf7,0x71,0x0b,0xa0,0x94,0x04,0xd0,0xbd,0xb3,0xb0,0xff,0xb1,0x21,0xb9,0x11,
+	0xa6,0x1b,0x13,0x26,0xff,0x1b,0x02,0x76,0xab,0x0d,0xa0,0x21,0x06,0xfe,0x5b,0x01,
+	0x00,0xa0,0x01,0x86,0x20,0x94,0x01,0xff,0x03,0xb1,0xeb,0xff,0xa8,0x52,0x82,0x21,
+	0xbf,0x10,0xb8,0x0b,0xbe,0x71,0x29,0xc5,0x08,0xa0,0xff,0x9a,0xb3,0x90,0x91,0x21,
+	0x9e,0x71,0x37,0xfe,0xb5,0x08,0x79,0x08,0xf8,0x32,0xe6,0x1f,0x02,0xff,0xc6,0x5d,
+	0x00,0x41,0xe1,0xff,0x2e,0x62,0xf7,0x35,0x03,0xe7,0x55,0x01,0xc8,0x52,0x9e,0xde,
+	0xff,0xf0,0xa1,0x40,0x05,0x1c,0x30,0x4e,0x44,0xff,0x01,0x03,0x40,0x00,0x80,0x30,
+	0x1e,0x1c,0xf7,0x78,0x26,0x80,0xc8,0x00,0x46,0x28,0x00,0x94,0xfb,0x01,0x26,0x5f,
+	0x00,0x48,0xe5,0xa1,0x84,0x20,0xff,0xf8,0xc6,0xee,0x42,0x30,0x29,0x41,0x09,0xff,
+	0x81,0x20,0xbd,0x04,0x8e,0x80,0x00,0x0b,0xff,0x44,0x29,0xb0,0x20,0x2e,0xab,0x5d,
+	0x26,0x7f,0x00,0x00,0x90,0x22,0x1e,0x88,0x4a,0x3c,0x09,0xff,0x70,0xa5,0x16,0x90,
+	0xa7,0x16,0x2e,0x57,0xff,0x2a,0x07,0x82,0x07,0xbc,0x30,0x8e,0xc7,0xff,0x05,0x07,
+	0x82,0x05,0x80,0x30,0xfe,0xc8,0xdf,0x00,0x6b,0xaa,0x56,0x80,0x05,0x02,0x75,0x06,
+	0xff,0x82,0x05,0x84,0x30,0xee,0xc7,0x00,0x49,0x9b,0xbc,0x50,0x0f,0x08,0x07,0x62,
+	0x0f,0x00,0x61,0x00,0x2b,0xfb,0xb8,0x37,0x25,0x0e,0xa2,0x35,0x84,0x20,0x04,0xff,
+	0x9d,0x44,0x04,0x4c,0x54,0x1e,0x87,0x35,0xff,0x06,0x62,0x03,0xb0,0x30,0x1e,0xa6,
+	0x31,0xff,0x0d,0x10,0x01,0xb0,0x20,0xd4,0x50,0xd2,0xbf,0x14,0x49,0xd2,0x2e,0x88,
+	0xfa,0xd8,0x00,0xac,0xff,0x22,0x34,0x38,0x53,0xb4,0x31,0x13,0xc7,0xdf,0x2a,0x8c,
+	0x8e,0x24,0x10,0x99,0x02,0xc4,0x3a,0xbf,0x98,0x31,0xae,0x41,0x2b,0x80,0xf3,0x04,
+	0xc0,0xcd,0xbc,0x24,0x05,0x8e,0x8a,0x17,0x0c,0xfe,0x00,0x40,0xbb,0x77,0xa0,0x8e,
+	0x1b,0x0d,0x0c,0x3e,0x19,0x7c,0xa8,0x00,0xdf,0xc5,0x1b,0x6e,0x9b,0xd0,0xcf,0x0a,
+	0x6e,0xa4,0xfd,0xe0,0x07,0x08,0x8e,0xb0,0x7f,0x1c,0x80,0x1b,0xdf,0x84,0x20,0x6e,
+	0x8a,0xf0,0x0f,0x00,0xcc,0x3a,0xff,0xd8,0x31,0x14,0xe5,0x04,0x14,0xd6,0x04,0xf7,
+	0xde,0xd1,0x2c,0x53,0x00,0xac,0x22,0xd7,0x2c,0xff,0xcc,0x8e,0x0a,0x20,0x07,0x02,
+	0x02,0xc4,0xff,0x3a,0xe8,0x31,0x07,0xee,0x43,0x8b,0xa1,0xff,0xbe,0x41,0x8c,0x2e,
+	0x80,0x01,0x64,0x22,0xef,0x25,0x5e,0x07,0x92,0x71,0x01,0xb2,0xa8,0x09,0xff,0x00,
+	0x1b,0x40,0x00,0xaa,0xa1,0xa9,0x09,0xff,0x88,0xf1,0xa0,0x88,0x20,0x89,0x09,0xf8,
+	0xff,0x32,0x4e,0x87,0xf7,0xe0,0x20,0x01,0x1c,0xff,0x22,0xfe,0xb7,0x76,0xc0,0x80,
+	0x00,0x60,0x8f,0x22,0x86,0xa4,0xff,0xb7,0x06,0x12,0x02,0x0d,0x0a,0xb4,0xef,0x00,
+	0x42,0x44,0xf0,0x3a,0x07,0x69,0xe2,0x1f,0xff,0x84,0x20,0xa4,0xf0,0xd2,0xc6,0xe9,
+	0xff,0xfe,0x2b,0x1e,0x38,0x72,0x22,0x22,0x13,0x41,0xb6,0xff,0xd5,0x37,0xa2,0x04,
+	0x22,0xa8,0x47,0x1d,0xff,0xf0,0x27,0x24,0x14,0xa6,0x12,0x11,0x81,0x6f,0xe6,0xfd,
+	0x91,0x72,0x14,0x03,0x8e,0x79,0x7f,0x06,0xcb,0x81,0x1b,0x6b,0x06,0x48,0x52,0x00,
+	0x37,0x00,0xde,0x12,0xff,0x03,0x5e,0xe0,0x02,0x54,0x22,0x37,0x02,0xef,0x22,0x2e,
+	0x12,0x04,0x9d,0x0a,0x20,0x21,0x21,0xff,0x9e,0xf2,0xf4,0x80,0x20,0x01,0x58,0x22,
+	0xff,0x46,0x00,0x00,0x0c,0x04,0x8e,0xb4,0x52,0xbe,0xc5,0x02,0x85,0x1b,0x00,0x22,
+	0xa1,0x33,0x0c,0x8c,0xff,0x53,0x0c,0x3a,0xa5,0xe9,0x00,0xaa,0x22,0x76,0x62,0x03,
+	0x00,0xc7,0x0c,0x02,0x65,0x31,0x01,0x9a,0x06,0xbe,0x1b,0x04,0x0c,0x3a,0xe5,0xe7,
+	0x00,0x0c,0x04,0x88,0xfa,0x93,0x07,0x61,0x0f,0x04,0xe6,0x00,0x7d,0x0a,0x61,0xff,
+	0xfc,0xff,0x16,0xe2,0x08,0x16,0xb4,0x08,0xff,0xa8,0x26,0xa6,0x1a,0x6c,0x5e,0xb5,
+	0x33,0xfb,0x00,0x87,0x37,0x00,0xa0,0x33,0x43,0x30,0x8a,0xff,0xc0,0xad,0x03,0x89,
+	0x26,0xa5,0xfa,0xff,0xef,0x7a,0x83,0xae,0x71,0x36,0x0f,0x5e,0x38,0x2a,0xfe,0x56,
+	0x08,0xa5,0x68,0x01,0xa9,0x36,0xc8,0x06,0xff,0xd8,0x16,0xbd,0x03,0x2a,0xcc,0x4a,
+	0xdd,0xff,0x25,0x80,0x01,0xa8,0x36,0xe5,0x73,0x01,0xff,0x70,0x23,0xc0,0x9c,0xa5,
+	0xb8,0x16,0xcd,0xff,0x02,0x4e,0xbb,0x2a,0x01,0x27,0x01,0xad,0xff,0x1b,0xa5,0xef,
+	0x00,0xcc,0x9a,0x1e,0x07,0xbf,0x02,0x08,0xe7,0x10,0x41,0x1b,0x27,0x01,0xc8,0xff,
+	0x16,0xe8,0x01,0xd8,0x06,0x2a,0xcc,0xc9,0xff,0x16,0xea,0xdd,0xd9,0x06,0x0c,0x02,
+	0xf8,0x7f,0x26,0x7c,0xf9,0x9e,0x0f,0x08,0x01,0xdc,0x04,0xff,0x96,0x12,0x00,0x1d,
+	0xf0,0x99,0x26,0x20,0x7f,0x28,0x83,0x1d,0xf0,0x3e,0x76,0x22,0x6f,0x08,0xcf,0x29,
+	0x06,0x29,0x16,0x60,0x09,0xbf,0x04,0x8a,0x27,0xff,0xaa,0x2b,0xbd,0x03,0xa5,0xf1,
+	0xff,0x7b,0xff,0x42,0x20,0x42,0xb3,0x40,0x43,0x21,0x40,0xdf,0x4a,0x82,0x2e,0xa2,
+	0x3b,0xaf,0x08,0x25,0xee,0xef,0xfd,0xa6,0x1a,0x06,0x1d,0x00,0xef,0xff,0x4a,0xf7,
+	0x4a,0x2d,0x04,0x33,0x08,0xbd,0x03,0xad,0x02,0xdb,0xa5,0xee,0x9a,0x0b,0x00,0x98,
+	0xf3,0x00,0x90,0x31,0xff,0x00,0x20,0x36,0xa1,0x00,0xac,0xa2,0xac,0xff,0x83,0x81,
+	0x5c,0xfc,0x88,0x08,0x51,0xfb,0xff,0xff,0x88,0x28,0xde,0x86,0xda,0x1c,0x07,0xbf,
+	0x01,0x1d,0x1b,0xbe,0x45,0xac,0x71,0x08,0xe0,0xff,0x08,0x00,0x56,0xea,0x04,0x6e,
+	0x0a,0x0a,0xf3,0x07,0x27,0xb2,0x08,0xbb,0x09,0x39,0x09,0x40,0x22,0xff,0x21,0x29,
+	0x19,0x3e,0x93,0x3a,0x28,0x80,0xff,0x01,0xa4,0x22,0x76,0xa2,0x0a,0x90,0x21,0x7d,
+	0x16,0xe8,0x01,0x02,0x06,0x03,0x86,0x1a,0x07,0x00,0xfb,0x42,0xe9,0x4f,0x03,0xa4,
+	0x20,0xc2,0x76,0xa2,0xf7,0x12,0x30,0x30,0x60,0x03,0x72,0x04,0x08,0x03,0x7f,0x84,
+	0x1a,0x3e,0x02,0x13,0x62,0x00,0x6b,0x02,0xff,0x1d,0xf0,0xa8,0xa5,0xb1,0xe1,0xff,
+	0xde,0xff,0x01,0x0c,0x0b,0xc7,0x02,0xa1,0x1b,0xe5,0xff,0x2b,0x00,0xb8,0xa5,0xbe,
+	0xab,0x3c,0x01,0xfd,0xa7,0x9f,0x05,0x6b,0x06,0x0c,0x0a,0xd6,0x6a,0xfc,0x97,0x09,
+	0xb2,0x00,0xa8,0x85,0xce,0x02,0xeb,0x1a,0x7f,0x27,0x0b,0x1d,0x1b,0xee,0x91,0x5d,
+	0xd8,0x02,0xff,0x19,0x1b,0x25,0x1e,0x00,0x9d,0x03,0xa8,0xff,0x85,0xa6,0x14,0x1e,
+	0x26,0x14,0x02,0x76,0xff,0xa4,0x18,0x24,0x81,0x82,0xa0,0x21,0x36,0xff,0x8e,0xb0,
+	0x73,0x06,0x00,0x23,0x84,0x1a,0xff,0x94,0x30,0x04,0x1e,0x23,0x19,0x22,0x01,0xfe,
+	0x65,0x00,0xad,0x03,0xbd,0x03,0x4e,0xc4,0x3e,0xff,0x0b,0xc7,0x03,0xa5,0x1b,0xde,
+	0x45,0xa9,0xfb,0x00,0x47,0xcc,0x00,0x9e,0x71,0x08,0x01,0xa7,0xee,0x07,0x00,0x8e,
+	0x71,0x1f,0xdc,0x08,0x65,0x46,0x03,0xdf,0xae,0x2a,0x39,0x26,0x00,0xc3,0x00,0x9e,
+	0x2a,0xff,0xf1,0x02,0x00,0x01,0x54,0x30,0xc6,0xd7,0xfd,0xff,0x77,0x00,0x00,0x54,
+	0x52,0x00,0x20,0xa4,0xf8,0x23,0x01,0x0b,0x04,0x1b,0x02,0x31,0xb4,0xff,0x0e,0xd0,
+	0xfd,0x0a,0x33,0x00,0xbd,0x1b,0xae,0xc0,0x09,0x03,0xbd,0xe7,0x43,0x04,0xb0,0x79,
+	0x06,0x02,0xdc,0x03,0x34,0xfb,0x11,0x42,0xf1,0x00,0x00,0x43,0x01,0x84,0x2a,0xff,
+	0x4e,0x28,0x02,0x0b,0xc7,0x10,0x55,0x1b,0xff,0xb8,0x63,0xae,0x43,0x5c,0x1a,0x27,
+	0x0a,0x7f,0x81,0x1b,0xde,0x43,0x2e,0x00,0x27,0x2c,0x00,0xfb,0xa5,0x01,0x76,0x01,
+	0xd6,0x9a,0x00,0x06,0x01,0xfe,0x50,0x04,0x1d,0xf0,0x1d,0xf0,0xcd,0x01,0xae,0xfb,
+	0x43,0x6b,0x23,0x08,0xee,0x01,0x0d,0x20,0x80,0xdf,0x00,0xa0,0x22,0x25,0x23,0xf5,
+	0x00,0x96,0x3a,0xff,0xfe,0xd8,0x11,0xc8,0x23,0xda,0xcc,0xc2,0x7f,0xdc,0x0d,0xae,
+	0xdf,0xfc,0x84,0xe1,0x5e,0x03,0xf7,0xce,0x73,0x3b,0xbd,0x08,0xa5,0x7e,0xff,0xbe,
+	0xfb,0x04,0x0a,0x2b,0x0c,0x7e,0xff,0xae,0xd8,0xfb,0xfb,0x00,0x47,0xa8,0x01,0x65,
+	0x7d,0xff,0x0c,0x12,0xde,0x2c,0x09,0x3d,0x0a,0xd7,0x35,0xaf,0x14,0x88,0xff,0xff,
+	0xd8,0x03,0x3e,0x6d,0x62,0x06,0x07,0x10,0x7d,0xc1,0x43,0x03,0xb8,0x63,0xee,0x00,
+	0x0c,0x6c,0x00,0xff,0xa1,0x1b,0xae,0x43,0x58,0x15,0x27,0x06,0xff,0x81,0x1b,0x80,
+	0xdd,0x82,0x65,0xf8,0xfe,0xd6,0x6f,0x00,0x0a,0xfe,0x89,0x20,0x00,0x89,0x0c,0x65,
+	0x1a,0xfe,0x89,0x04,0x6a,0xfc,0x14,0x00,0x42,0xa1,0xeb,0x77,0xff,0xa4,0x11,0xc1,
+	0x01,0x70,0x20,0x45,0xe0,0x00,0xff,0x34,0x21,0x42,0x3e,0x49,0x00,0x60,0x81,0xff,
+	0x02,0x54,0x2a,0x16,0xbb,0x03,0x34,0x01,0xff,0xc2,0xa8,0x53,0x88,0x03,0xee,0x41,
+	0x1d,0xfe,0x4c,0x09,0xde,0xbd,0x39,0x15,0x27,0x07,0xa5,0xff,0x1b,0x90,0x88,0x82,
+	0x8e,0xee,0x2f,0x03,0xff,0x67,0x1b,0xad,0x1b,0xfa,0xee,0xee,0xdd,0x7d,0x7c,0x5a,
+	0x00,0xad,0x1b,0xde,0x73,0x2e,0xd4,0x02,0xef,0x81,0x1b,0xe5,0xf0,0x74,0x04,0xba,
+	0xf6,0xa8,0xff,0x03,0x1b,0xaa,0xa9,0x03,0x3e,0x6a,0xc2,0xd0,0x15,0x00,0xa1,0x04,
+	0xb7,0x04,0xc1,0x03,0x02,0x09,0x04,0x36,0x81,0xff,0x00,0x8e,0x1f,0x00,0xa1,0x40,
+	0x04,0xa0,0xef,0x30,0x0e,0xd2,0x0a,0x20,0x00,0xbd,0x1b,0x0e,0xdf,0xc2,0x09,0x1f,
+	0xe7,0x1f,0x6f,0x03,0x9a,0x20,0xff,0x01,0x05,0x03,0xa7,0x1a,0x3e,0xc0,0x09,0xff,
+	0x06,0x02,0x07,0x80,0x30,0x6e,0xc3,0x08,0xff,0x06,0x02,0x04,0x80,0x30,0x8e,0xb0,
+	0x78,0xfb,0x07,0x22,0x8c,0x01,0x4e,0xc1,0x00,0x47,0xe5,0xe7,0xa6,0x80,0x20,0x0f,
+	0x04,0x9c,0x05,0x0e,0xa2,0x50,0xef,0x69,0x1b,0x06,0x91,0x0f,0x00,0x70,0x4b,0x00,
+	0xff,0x21,0x84,0x20,0x7e,0x41,0x40,0x6b,0x0e,0xbf,0x06,0x60,0x20,0x7e,0x86,0x04,
+	0x4d,0x02,0xb1,0xff,0x1b,0x9e,0x32,0x00,0x4b,0x0c,0x02,0x54,0xff,0x20,0x3d,0xf0,
+	0x76,0xa3,0x2f,0x60,0xa2,0x6f,0x16,0x40,0xa6,0x06,0x3a,0x00,0x06,0x62,0x3a,0x00,
+	0x6e,0x32,0x04,0x48,0x0d,0x84,0x3a,0x08,0xf9,0xab,0x07,0x08,0xfb,0x4a,0xe1,0x07,
+	0x00,0x1b,0x44,0x2e,0x05,0x12,0xf9,0x42,0xc7,0x0e,0x6b,0x09,0x3e,0x14,0x51,0x02,
+	0x20,0xff,0x01,0xc4,0x30,0xe0,0x55,0x11,0x3e,0x44,0xfd,0x46,0x0a,0x01,0xad,0x1b,
+	0x64,0x01,0x26,0x7e,0xff,0x43,0x00,0x05,0x05,0x02,0x83,0x1a,0x2e,0xff,0xa0,0x07,
+	0x07,0x02,0x07,0xb0,0x30,0x5e,0xff,0x33,0x21,0x63,0x02,0x09,0xac,0x22,0x24,0x6f,
+	0x20,0xc2,0x4e,0xe3,0x3f,0x04,0x7c,0x22,0xed,0x04,0xfe,0x3f,0x00,0x00,0x81,0x07,
+	0xa6,0x14,0x24,0x26,0xdf,0x14,0x0b,0xf0,0x20,0x00,0x02,0x0c,0x76,0xa4,0xdf,0x15,
+	0x5e,0x43,0x00,0x02,0x3e,0x04,0x50,0xa0,0xff,0x06,0x3e,0x43,0x41,0x62,0x02,0x08,
+	0x60,0xef,0x22,0x24,0x01,0x03,0x1f,0x0d,0x33,0x33,0x33,0xfd,0x3d,0xe7,0x09,0x41,
+	0x00,0x9c,0x02,0x8c,0xe4,0xf7,0xce,0x05,0x08,0x62,0x01,0x55,0x1b,0x37,0xa8,0xbf,
+	0x09,0x22,0xa8,0x37,0x1d,0xf0,0xa1,0x0b,0xad,0xff,0x02,0xbd,0x03,0xe5,0x29,0x00,
+	0xd6,0x3a,0xfe,0x49,0x0b,0x71,0x04,0xff,0xad,0x02,0xcd,0x03,0x7f,0xb8,0xc7,0x25,
+	0x1d,0x00,0xd6,0x4a,0x5c,0x0f,0xf7,0xa8,0xc7,0xbd,0x12,0x00,0xdd,0x04,0xed,0x05,
+	0xff,0x25,0x08,0x00,0xae,0x56,0x09,0x40,0x80,0xff,0x00,0x54,0x22,0x44,0x20,0x42,
+	0xde,0xe8,0xf7,0xfb,0x01,0x07,0x57,0x02,0xd4,0x31,0x26,0xce,0xff,0x43,0xe0,0x4b,
+	0x0c,0x03,0x7c,0x20,0x76,0x7f,0xac,0x3c,0x94,0x41,0x42,0x94,0x00,0xe8,0x06,0x7b,
+	0xc0,0x51,0x07,0x02,0xac,0xfe,0x24,0x50,0x0c,0x04,0xbb,0xe0,0x55,0x0c,0x00,0x2e,
+	0x2f,0x0c,0xa3,0x01,0x55,0x3f,0x1b,0xee,0x0c,0x09,0x20,0x81,0x43,0x00,0x0d,0x07,
+	0xfd,0x49,0x17,0x00,0xdc,0x28,0x2e,0x42,0x4b,0x60,0xef,0x21,0x00,0x60,0x22,0x6f,
+	0x04,0xde,0xfe,0xfc,0xfe,0x71,0x01,0x45,0x1b,0x44,0x00,0xc2,0xb9,0x05,0x3b,0xc6,
+	0xfa,0x64,0x07,0x10,0x37,0x00,0x5f,0x0b,0xcb,0x08,0xff,0xc1,0x00,0xac,0xd2,0xac,
+	0xb3,0xac,0x95,0xff,0xac,0x76,0x81,0x39,0xfb,0x88,0x08,0x71,0xff,0xd8,0xfe,0x88,
+	0x28,0xde,0xb2,0xba,0x1c,0xee,0x8a,0x04,0xbe,0x47,0xac,0x61,0x0a,0xe0,0x08,0x00,
+	0xff,0xec,0x5a,0xce,0x09,0x0a,0x07,0x27,0x10,0xef,0x41,0x1b,0x00,0x00,0xe8,0x08,
+	0x39,0xc1,0x49,0x7f,0xd1,0xbd,0x05,0x6e,0xc6,0x3a,0x2c,0xc5,0x07,0xf7,0x65,0xf3,
+	0x06,0x23,0x0d,0x00,0xa8,0xa7,0xb1,0xff,0xe8,0xff,0xde,0x01,0x0c,0x05,0xe7,0x04,
+	0xdf,0xa1,0x1b,0xa5,0xe5,0xff,0x43,0x00,0x24,0x00,0xdf,0x00,0x80,0x22,0xbe,0x7c,
+	0xc6,0x03,0x04,0x81,0xdf,0x1b,0xae,0x7c,0x11,0x02,0x0f,0x00,0x30,0xbe,0xef,0x9b,
+	0x3e,0x26,0x80,0x39,0x00,0x76,0xaa,0x0a,0xf7,0x90,0x21,0x16,0xbb,0x00,0x02,0x06,
+	0x03,0x86,0xff,0x1a,0xbe,0x9b,0x30,0x42,0xe9,0xa1,0xa4,0xff,0x20,0x14,0x06,0xc2,
+	0xee,0x82,0x0d,0x00,0xff,0x07,0x05,0xb1,0x1b,0x76,0xad,0x12,0x90,0xfd,0x30,0x09,
+	0x03,0x72,0x04,0x08,0x03,0x84,0x1a,0xdf,0x9e,0x02,0x19,0x22,0x01,0x03,0x02,0xbe,
+	0xab,0xed,0x3c,0x1d,0x00,0xa5,0x1b,0xb5,0x01,0xe5,0x1f,0x06,0x77,0x9e,0x47,0xa8,
+	0x5c,0x08,0x8e,0x71,0x9a,0xb0,0x08,0xf7,0x9e,0x71,0x8f,0x0f,0x08,0x76,0xaf,0x15,
+	0x90,0xff,0x30,0x46,0xce,0xa8,0x41,0xe2,0x27,0x28,0x7f,0x90,0x20,0x94,0x30,0x04,
+	0x1e,0x53,0x3e,0x0c,0xfc,0x9f,0x11,0xad,0x01,0x02,0x4e,0xc4,0x3e,0x05,0xe7,0xee,
+	0x49,0x00,0xde,0x47,0xaf,0x3b,0x08,0xfe,0x71,0x09,0xeb,0x01,0xa7,0x43,0x08,0x1f,
+	0x39,0x0b,0xa5,0xfb,0x02,0xff,0x2d,0x0a,0xd6,0xea,0xf0,0x86,0xc7,0xff,0xde,0x33,
+	0x11,0xd0,0x3f,0x00,0x20,0x2b,0x03,0xac,0x82,0xff,0xac,0x63,0x81,0xec,0xfa,0x88,
+	0x08,0x51,0xad,0x8b,0x33,0x05,0x16,0xca,0x33,0x0d,0x45,0x33,0x19,0x3e,0xff,0x6a,
+	0x09,0x07,0x27,0x11,0x59,0x1b,0x86,0xfd,0x1e,0x32,0x0d,0xa8,0x85,0x9d,0x03,0xa6,
+	0x14,0xff,0x1e,0x26,0x14,0x02,0x76,0xa4,0x18,0x24,0x6f,0x21,0x82,0xa0,0x21,0xf4,
+	0x02,0x70,0x00,0xd6,0x04,0xdf,0x94,0x00,0x04,0x1e,0x20,0x9a,0x0c,0xad,0x03,0xbb,
+	0xbd,0x03,0x93,0x00,0x13,0x07,0x03,0x93,0x00,0x45,0xec,0x93,0x38,0x0f,0x08,0x65,
+	0xf2,0x93,0x00,0xa0,0x2a,0xb3,0xee,0x71,0x0d,0xa5,0xb1,0xdb,0x71,0x05,0x13,0x07,
+	0x02,0x7f,0xa1,0x1b,0x65,0xce,0xff,0xb8,0xa5,0x1c,0x01,0xff,0x01,0xa7,0x01,0xa5,
+	0x1b,0x25,0x0e,0x06,0x7f,0x0c,0x09,0xd6,0x69,0xf8,0x2d,0x09,0xe8,0x17,0xb7,0x00,
+	0x20,0x46,0xbb,0x08,0xcc,0x32,0x91,0x08,0x81,0x6d,0xbc,0xbe,0x00,0x41,0x5b,0xbe,
+	0x04,0x05,0x9a,0xbe,0x0c,0xbd,0x44,0xbe,0x18,0xcc,0xaa,0x2e,0x05,0xf2,0x15,0x00,
+	0xff,0x00,0xb1,0xf1,0xff,0xae,0x44,0xac,0x15,0xff,0x47,0x02,0x81,0x1b,0x25,0xcc,
+	0xff,0xb8,0xfd,0xa4,0x63,0x14,0x65,0xb5,0x05,0x0c,0x0a,0xd6,0xfb,0xba,0x08,0xdb,
+	0x0a,0x00,0x00,0x8e,0x02,0x10,0xff,0x07,0x02,0x03,0xc4,0x3a,0x29,0x01,0x39,0xff,
+	0x11,0x30,0x91,0x21,0xa6,0x19,0x15,0x26,0x7f,0x19,0x02,0x76,0xa9,0x0f,0x6e,0x82,
+	0x17,0x04,0xfb,0xc8,0x3a,0xe8,0x15,0xa8,0x01,0xe8,0x11,0x98,0xdf,0x11,0xbd,0x0a,
+	0x8e,0x1a,0x2f,0x0c,0x8e,0x8a,0xfe,0x07,0x0c,0x90,0xc1,0x21,0x07,0xe9,0x60,0x3e,
+	0xff,0x1c,0x90,0x42,0xe9,0xa0,0xc4,0x20,0xd8,0xef,0x11,0xde,0xd1,0x2c,0xd9,0x0b,
+	0x6e,0x9b,0x20,0xfc,0x3f,0x10,0x07,0x0e,0x6e,0x8a,0x2c,0x80,0x21,0x01,0x7f,0xcc,
+	0x22,0xd7,0x2c,0xe4,0x8e,0x0a,0x1a,0x00,0xbf,0x02,0xc4,0x3a,0x0e,0x2e,0x32,0xe9,
+	0x02,0x65,0xdf,0x1b,0x1d,0xf0,0xd8,0xa4,0xd8,0x05,0xcd,0x03,0xf7,0xfe,0x00,0x0e,
+	0xb0,0x00,0xa1,0x1b,0x25,0xf5,0xff,0x02,0x4e,0x6a,0xf1,0x02,0x00,0x01,0x54,0xfd,
+	0x30,0xa6,0x10,0x24,0x20,0x42,0x9e,0xf8,0xf0,0x7f,0x00,0x09,0x03,0x44,0x20,0xb4,
+	0x30,0x51,0x07,0xff,0x6b,0x0a,0x03,0x84,0x20,0xa4,0x30,0xc2,0xf3,0xc6,0xef,0xe5,
+	0x0d,0xe3,0x03,0x41,0x15,0xfe,0x98,0xff,0x44,0x3d,0x02,0x9c,0x39,0x0e,0x19,0x8a,
+	0xff,0x3e,0xc1,0x02,0xc4,0x22,0x8e,0x5c,0x82,0xff,0x07,0x87,0x10,0xa1,0x1b,0xa0,
+	0x28,0x83,0xff,0x1d,0xf0,0x25,0xa1,0xff,0x2d,0x0a,0x3e,0xfb,0x1a,0xcb,0x23,0x02,
+	0xc1,0x1b,0xbe,0x74,0x42,0xde,0x35,0x09,0x1d,0xf0,0xa5,0x94,0x16,0x08,0x5c,0x00,
+	0xff,0x27,0x01,0xdd,0x1b,0xd8,0x34,0xd9,0x03,0xf3,0xc9,0x44,0x7b,0x19,0x53,0x00,
+	0x31,0x00,0xfe,0x2e,0xff,0x00,0x04,0x03,0xe7,0x00,0xa1,0x1b,0x29,0xef,0x43,0x2e,
+	0x73,0x01,0x0a,0x0b,0x2e,0x73,0x32,0xf7,0x06,0x02,0x06,0x07,0x04,0x24,0x06,0x02,
+	0x04,0x9f,0x80,0x30,0x34,0x01,0xc2,0x33,0x08,0x2f,0x00,0xe5,0xdf,0xfb,0x02,0xd6,
+	0x6a,0x00,0xb4,0x10,0xa1,0x7e,0xfd,0xfb,0xee,0x02,0x25,0x3a,0x00,0x91,0xee,0xfd,
+	0xff,0x81,0x7a,0xfb,0xa9,0xa9,0x9c,0x5a,0x29,0xff,0x59,0x39,0x69,0x21,0x1f,0xfc,
+	0x88,0x08,0x7f,0x89,0xc9,0x28,0x02,0x2e,0x79,0x82,0x85,0x10,0x87,0x22,0xa8,0x32,
+	0x31,0x00,0x3f,0x00,0x47,0x14,0xef,0x11,0xbd,0xff,0x04,0xad,0x03,0xe5,0x73,0xff,
+	0x28,0xa2,0xff,0xd0,0x4a,0x11,0xad,0x04,0xbd,0x02,0xe5,0xff,0x5b,0xfd,0x3d,0x0a,
+	0xbd,0x02,0xad,0x04,0xff,0xe5,0x62,0xfd,0x1b,0x23,0xa0,0x23,0x83,0xf6,0x2f,0x08,
+	0xb8,0x0b,0xae,0x08,0x42,0x00,0x80,0x32,0xbf,0x62,0x36,0xe1,0x00,0xcc,0x33,0xbd,
+	0x0e,0x03,0xff,0xc1,0xfa,0xff,0xde,0xfd,0xb9,0x0d,0x47,0xee,0x26,0x02,0x0e,0x4a,
+	0xbb,0xf8,0x08,0x27,0x9a,0x03,0xfe,0xf7,0x07,0xae,0xf3,0xf0,0x81,0xe0,0x01,0x1c,
+	0x7f,0x30,0xde,0x73,0x20,0x81,0x00,0x14,0xdc,0x03,0xef,0x73,0x30,0x81,0xc0,0xc9,
+	0x00,0x9e,0x73,0x2e,0xff,0x04,0x07,0x01,0x81,0x1b,0xce,0x73,0x48,0xfb,0x00,0x47,
+	0x99,0x00,0x8e,0x73,0x0f,0x04,0x27,0x76,0xcf,0x06,0x73,0x1c,0x07,0x08,0xee,0x73,
+	0x59,0x63,0x0b,0xff,0x9e,0x62,0x0b,0x04,0x07,0x00,0x55,0x1b,0xdf,0xbe,0x10,0x09,
+	0x01,0x27,0x1b,0x01,0x0e,0x12,0xff,0x3a,0x1c,0x87,0x07,0xc9,0x1b,0x82,0xc2,0xff,
+	0xfe,0x1e,0x08,0x2c,0x5e,0xa0,0x02,0x54,0xff,0x22,0x16,0x7c,0x1e,0x22,0xa8,0x50,
+	0x1d,0xff,0xf0,0x10,0x38,0x16,0x20,0xa1,0x16,0xa0,0xfd,0xa2,0x3a,0x03,0x74,0x06,
+	0x22,0x05,0x84,0x30,0xfe,0xbc,0x01,0x45,0xed,0xa5,0x84,0x20,0x04,0x31,0xff,0x44,
+	0x04,0x50,0x44,0x3e,0xa3,0x34,0x06,0xff,0x02,0x03,0xa4,0x30,0x1e,0xe5,0x61,0x01,
+	0xff,0x1a,0x01,0xb0,0x20,0xd2,0x63,0x14,0x65,0xfb,0x50,0xff,0x40,0x11,0x99,0x33,
+	0xb9,0x53,0xa9,0xff,0x43,0xf1,0xc9,0xff,0x4e,0xc9,0xf1,0x02,0xfd,0x80,0xaf,0x00,
+	0x1e,0x88,0x10,0x11,0x25,0x02,0xff,0xaf,0x1a,0x44,0x71,0x36,0xf4,0x91,0x36,0xff,
+	0xae,0xc8,0x00,0x41,0xe7,0xb9,0x80,0x20,0xfb,0xae,0xc8,0xa1,0x05,0x81,0x1b,0xbe,
+	0xca,0x04,0xb3,0x06,0x82,0xc5,0x04,0x07,0x00,0xa2,0x05,0x9f,0x05,0x04,0xfd,0x07,
+	0x0f,0x04,0x5e,0x41,0x80,0x5e,0xe5,0xb4,0xff,0x64,0x20,0x1e,0xa0,0x60,0x58,0x07,
+	0x61,0xff,0xb1,0x20,0x8e,0x41,0x40,0x78,0xf1,0x5e,0xff,0x61,0x20,0xee,0x41,0x00,
+	0x2b,0x0a,0x01,0xff,0x60,0x20,0xde,0x41,0xc0,0x4b,0xfc,0x7f,0xff,0x60,0x20,0xfe,
+	0x41,0x40,0x6b,0xe4,0x13,0xfe,0x0f,0x00,0x87,0x10,0x4b,0xf8,0x71,0xb0,0x20,0xff,
+	0xee,0x87,0x10,0x5d,0xef,0xbf,0xb0,0x20,0xff,0xae,0x41,0xc0,0x6b,0xc4,0x7e,0x64,
+	0x20,0xff,0xae,0x89,0x10,0x2b,0xe2,0x1d,0xb0,0x20,0xff,0x1e,0x80,0x10,0x5a,0xe7,
+	0xbb,0xb0,0x20,0xff,0x8e,0x84,0x10,0xc0,0x53,0x7d,0xb0,0x2a,0xff,0x9e,0xb7,0xe0,
+	0x18,0x0d,0x7b,0x81,0x20,0xff,0x5e,0x82,0x14,0x07,0x62,0x01,0xb0,0x30,0xff,0x1e,
+	0xc1,0x00,0x4b,0xc0,0x1b,0xb0,0x20,0xdf,0x6e,0xc7,0x04,0x07,0x62,0x87,0x00,0x1e,
+	0x8f,0xef,0x70,0x4b,0xca,0x77,0x37,0x00,0xee,0x11,0xae,0xff,0xa1,0x8f,0xb0,0x22,
+	0xfe,0x8b,0x10,0xa0,0xff,0x50,0x7b,0xb0,0x2a,0x1e,0xcd,0x72,0x83,0xff,0x49,0x1b,
+	0xb1,0x11,0x8e,0x80,0x64,0x07,0xff,0x42,0x00,0xc0,0x30,0x4e,0xc5,0x04,0x07,0xfd,
+	0x42,0x2f,0x00,0xee,0xdd,0x61,0xea,0xa1,0x8a,0x7f,0xac,0x22,0x1e,0xca,0x31,0x09,
+	0x14,0x13,0x01,0xff,0x8a,0x8d,0x50,0xff,0x10,0xfa,0xaa,0xa0,0xfb,0x5f,0x31,0x07,
+	0x00,0xf0,0xaa,0xc0,0x8e,0xef,0xdf,0x3a,0x07,0x22,0x06,0xac,0x27,0x00,0x64,0x07,
+	0xff,0x22,0x04,0xac,0x30,0xde,0x88,0x50,0x4b,0xff,0xa4,0x67,0xa4,0x20,0x80,0x59,
+	0x82,0x8e,0xff,0x73,0xb0,0x55,0xe5,0xb6,0x80,0x20,0x59,0xff,0xa3,0xae,0x73,0x70,
+	0x18,0xdb,0x54,0x81,0xff,0x20,0xae,0xfc,0x2e,0x28,0x00,0x01,0xac,0xff,0x22,0xfe,
+	0xfc,0x20,0x2b,0xa2,0x75,0xac,0xff,0x20,0xfe,0x73,0x8f,0xf8,0xa1,0x00,0x80,0xff,
+	0x22,0xfe,0x73,0x90,0x2b,0xb6,0x56,0x80,0xff,0x20,0xe4,0x60,0xd2,0x14,0x59,0xd2,
+	0x34,0xff,0x56,0xd2,0xa6,0x19,0x20,0x3e,0xb3,0x3a,0xfe,0x91,0x03,0xa5,0x1b,0xc8,
+	0x43,0x98,0x23,0xa0,0xff,0xcc,0x82,0xca,0x99,0x99,0xcb,0x88,0x33,0xff,0x1b,0xaa,
+	0x8e,0xda,0xdb,0x60,0x81,0x00,0xff,0x7c,0x22,0xa8,0x73,0x25,0x3a,0xff,0xa2,0xff,
+	0x63,0x13,0x3e,0x1a,0x72,0x08,0x87,0x10,0xdf,0xc1,0x1b,0x46,0x88,0xff,0xa6,0x09,
+	0xd9,0x23,0xbe,0xa8,0x0d,0xa9,0x13,0x5e,0xe1,0xfc,0x07,0x02,0x45,0xfd,0x1b,0x0f,
+	0x04,0xae,0x73,0x4d,0x0a,0x47,0x02,0xff,0x81,0x1b,0xd9,0x13,0x3e,0xeb,0xfc,0x0a,
+	0xef,0x47,0x03,0x45,0x1b,0xd7,0x1e,0x81,0x8a,0xf9,0xff,0x88,0x08,0x88,0x28,0x2e,
+	0xb2,0x3a,0x1c,0xbe,0x6f,0x04,0xce,0x00,0x0d,0x0a,0x47,0x46,0x02,0xe0,0xdf,0x08,
+	0x00,0xee,0x0a,0x09,0x79,0x02,0x55,0x1b,0xd7,0x9e,0x72,0x02,0x1b,0x1b,0x33,0x65,
+	0x00,0xd0,0x0a,0xfb,0x01,0x20,0x3f,0x00,0x3e,0xfe,0xf2,0x00,0x87,0xe6,0xcf,0x02,
+	0x29,0x03,0xa5,0x13,0x13,0x00,0x30,0x32,0x82,0xef,0xad,0x03,0xa5,0x03,0x75,0x03,
+	0x9c,0x8a,0x81,0xed,0x74,0x58,0x08,0x3e,0xd3,0x58,0x0c,0x2e,0xb2,0x3c,0xf8,0xd0,
+	0x08,0x58,0x00,0x5f,0x23,0xff,0xd7,0x00,0x00,0xe0,0xde,0x4f,0x00,0xe4,0x08,0x01,
+	0x20,0x43,0x10,0x71,0xe8,0xff,0xff,0x78,0x07,0x7a,0x62,0x4b,0x66,0x6e,0xef,0x56,
+	0x33,0x01,0x67,0x31,0x00,0x67,0x03,0x06,0xff,0x7c,0x85,0x50,0x56,0x10,0x8b,0x55,
+	0x0e,0xfb,0x22,0x04,0x89,0x00,0x55,0x1b,0x81,0xf2,0xff,0xff,0x91,0xf2,0xff,0xa1,
+	0xf3,0xff,0x57,0x38,0xff,0x0f,0x9a,0x47,0x52,0x6a,0x7b,0x92,0xd9,0xff,0xfe,0x9a,
+	0x97,0x22,0x69,0x7f,0xc6,0xff,0xe7,0xff,0x2d,0x04,0x8e,0x10,0x4b,0x04,0x9c,0x42,
+	0x81,0xfd,0x52,0x85,0x00,0xdd,0x04,0x88,0x28,0xcd,0x03,0xa8,0xe2,0x14,0x81,0x0c,
+	0x23,0x1c,0x63,0x25,0x00,0x49,0x25,0x0c,0x38,0xf8,0x25,0x34,0x1f,0x04,0xd2,0x00,
+	0x52,0xd2,0xff,0x52,0x25,0x7f,0x3f,0x25,0xf6,0xff,0x4d,0x0a,0x9c,0xf4,0x03,0xff,
+	0x50,0xc3,0x63,0x65,0xfc,0xff,0x86,0x01,0x1f,0x00,0xad,0x03,0xe5,0xf4,0x13,0x00,
+	0x73,0x0c,0x2b,0x00,0xff,0x37,0x12,0x3d,0x37,0xb2,0x11,0xad,0x02,0xbf,0xbd,0x03,
+	0xcd,0x04,0x65,0xfa,0x3b,0x17,0x00,0xff,0x00,0x2e,0xc3,0x39,0x9e,0xe0,0x02,0x64,
+	0xff,0x22,0x3a,0xb9,0x2a,0x99,0x16,0x54,0x01,0xff,0x26,0x14,0x02,0x76,0x94,0x0f,
+	0xae,0x5b,0xff,0x09,0x3e,0xe1,0x02,0x80,0x22,0xae,0x89,0x7b,0x1b,0x7e,0x07,0x04,
+	0x1d,0xf0,0x0c,0x02,0x47,0x10,0xff,0x0c,0x06,0x2a,0x46,0x42,0x04,0x00,0x3a,0xff,
+	0x96,0x00,0x74,0x23,0x9c,0x84,0x92,0x09,0xff,0x00,0x00,0x89,0x23,0x9c,0x09,0x77,
+	0x28,0xff,0x0a,0x8e,0xd7,0xf6,0xc0,0x20,0x00,0x60,0xbf,0x22,0x46,0xf7,0xff,0x0c,
+	0x12,0x30,0x0c,0x7c,0xed,0xf2,0x34,0x00,0xe0,0xe2,0x93,0x09,0xa1,0xfe,0xff,0xef,
+	0xa8,0x0a,0xbe,0x0a,0xaf,0x05,0x55,0x1b,0xe0,0xcd,0x0a,0x87,0x01,0x1d,0xf0,0x82,
+	0x08,0x1b,0x00,0x31,0xf7,0xb9,0xff,0xaa,0x0d,0x7b,0x15,0x80,0x5b,0x00,0x33,0x04,
+	0x31,0xdf,0xfe,0xff,0x5e,0x43,0x84,0x9b,0x01,0x65,0x1b,0xff,0xad,0x02,0xb8,0x03,
+	0x25,0xf8,0xff,0x3e,0xff,0x1a,0x03,0x62,0x00,0x00,0x54,0x22,0x5e,0x7f,0x03,0xd4,
+	0x80,0x20,0x00,0x9c,0x22,0x96,0x0c,0xf9,0x00,0xe5,0x04,0x0f,0x05,0x02,0x26,0x12,
+	0x0e,0x26,0xff,0x22,0x13,0x26,0x32,0x10,0x26,0x42,0x11,0xbf,0x26,0x52,0x12,0x26,
+	0x62,0x03,0x21,0x04,0x0c,0xd1,0x42,0x03,0x00,0x93,0x04,0xc8,0x04,0x32,0x3b,0x11,
+	0xb2,0x26,0xff,0x12,0x19,0x26,0x22,0x1a,0x26,0x32,0x22,0xff,0x26,0x42,0x2a,0x26,
+	0x52,0x32,0x66,0x62,0x7f,0x0a,0xad,0x03,0xbd,0x04,0x25,0x24,0x9a,0x08,0x4c,0x36,
+	0x04,0x0e,0x04,0xe5,0x0f,0x0e,0x08,0x19,0x08,0x12,0x0a,0x18,0x5b,0xa5,0x16,0x0a,
+	0x08,0xbd,0x04,0x52,0x02,0x1b,0x0a,0x08,0xfe,0xbb,0x08,0xad,0x02,0x25,0x0a,0x00,
+	0xbd,0x03,0xff,0x5d,0x0a,0xcd,0x04,0x20,0xa2,0x20,0xa5,0xff,0xf9,0xff,0xd0,0x95,
+	0x11,0x4e,0xb3,0x29,0xff,0x3e,0x01,0x03,0xac,0x22,0x16,0x85,0x01,0xff,0x26,0x15,
+	0x02,0x76,0x95,0x12,0x00,0x09,0xef,0x40,0xae,0xc3,0xe9,0x13,0x00,0xa4,0x22,0xce,
+	0x4f,0x8b,0x0b,0x60,0x21,0x65,0x03,0x07,0x15,0xcc,0xcf,0x08,0xf7,0x66,0x12,0x03,
+	0xac,0x04,0xcd,0x04,0xbd,0x03,0xff,0xad,0x02,0x65,0xf5,0xff,0x50,0x9a,0xc0,0xfb,
+	0x8e,0x01,0x37,0x05,0xa1,0x1b,0x90,0x28,0x83,0x7c,0x2b,0x14,0x1a,0x00,0x03,0x00,
+	0x1e,0x2a,0x0d,0x4f,0x09,0xff,0x40,0x93,0x80,0x16,0x3a,0x01,0x26,0x1a,0xff,0x02,
+	0x76,0x9a,0x0d,0x82,0x09,0x00,0x80,0xff,0xdd,0x11,0xde,0xd8,0x39,0x20,0x21,0x01,
+	0x7f,0xa4,0x22,0x46,0x00,0x00,0x0c,0x0d,0x4a,0x0c,0x73,0xe5,0xf9,0xf5,0x09,0x27,
+	0xb1,0xbe,0x13,0x05,0x62,0x08,0xff,0x16,0x03,0x01,0x26,0x13,0x02,0x76,0x93,0xff,
+	0x0a,0x42,0x02,0x00,0x4e,0x55,0x22,0x40,0xf7,0x20,0x01,0xac,0x5c,0x08,0x05,0x50,
+	0x20,0x60,0x7f,0x20,0x20,0x74,0x1d,0xf0,0xe0,0x4e,0xb3,0x09,0xff,0xbc,0xb3,0x71,
+	0xfd,0xff,0x8e,0x00,0x06,0xff,0x1f,0xe7,0x1e,0xa1,0x1b,0x7e,0x57,0x79,0xfb,0x00,
+	0x87,0x9f,0x03,0x8a,0xa2,0xa2,0x0a,0x00,0xef,0x6e,0x6a,0x98,0x00,0x92,0x04,0x76,
+	0xa9,0x0e,0x7f,0x60,0x91,0x41,0x60,0x60,0x04,0x60,0x00,0x00,0xff,0x67,0x10,0x90,
+	0x66,0x30,0x8e,0x03,0xd9,0xf6,0xaf,0x03,0x99,0x1b,0x4f,0x00,0x7c,0xf6,0x7c,0xf2,
+	0xf7,0x20,0x26,0x30,0x51,0x08,0x00,0x00,0x05,0x80,0xfc,0xeb,0x08,0x3b,0x02,0x65,
+	0xea,0x03,0xbc,0x53,0x0c,0xef,0x0c,0xbe,0xff,0xf8,0x50,0x00,0xa1,0x1b,0xca,0xbd,
+	0x92,0x79,0x02,0xbe,0xb9,0x9c,0x80,0x50,0x08,0xa8,0xff,0x0e,0xb0,0xd1,0x41,0xb0,
+	0xb0,0x04,0xb0,0xff,0xb0,0x60,0xb0,0xba,0x10,0xd0,0xbb,0x30,0xb7,0xce,0x03,0xd8,
+	0x50,0x08,0x06,0x01,0xe2,0x06,0x7c,0xd5,0xfb,0x53,0x00,0x2b,0x53,0x00,0xf4,0x53,
+	0x04,0xcb,0x6d,0xdf,0x5d,0x00,0xff,0xff,0xff,0x57,0x08,0xfd,0xff,0xbb,0xe5,0xe6,
+	0x57,0xe4,0x81,0xee,0xff,0x5a,0x08,0x80,0x7b,0x22,0x10,0x97,0x09,0xb7,0x1d,0xc1,
+	0x04,0xaf,0x0c,0xf3,0x25,0xe4,0xaf,0xf8,0x51,0x04,0xe3,0x01,0x20,0xf0,0xee,0x3f,
+	0x0f,0x6e,0xfd,0xf5,0x08,0x03,0x1d,0x1b,0x2e,0xf7,0x00,0x17,0x01,0x0a,0x06,0x76,
+	0xa2,0x1e,0x3d,0xef,0x05,0x7e,0x05,0x04,0x9c,0x09,0x06,0x06,0x00,0xff,0x0c,0x04,
+	0x4e,0x80,0x05,0xa0,0x20,0x00,0xdf,0x48,0x22,0x8e,0x86,0x06,0x88,0x03,0x80,0x22,
+	0xff,0x91,0xf1,0xff,0x79,0x09,0x1d,0xf0,0x07,0xff,0x63,0x01,0x1b,0x44,0x30,0x31,
+	0x21,0x56,0x5f,0x43,0xff,0x86,0xf6,0xff,0x63,0x1f,0xc0,0x63,0x03,0xfb,0xc8,0x5c,
+	0x67,0x0f,0xfd,0xff,0x5e,0xfd,0xf4,0xec,0x5e,0x08,0x67,0x07,0xa5,0xc1,0x67,0x73,
+	0x0c,0xb3,0x37,0xff,0x12,0x71,0x0e,0xa2,0xe4,0x01,0xc7,0x00,0xff,0xcd,0x1b,0x4e,
+	0xa2,0x68,0x00,0xe7,0x00,0xff,0x6d,0x1b,0x8e,0xa2,0xe9,0x01,0xe7,0x01,0xff,0x69,
+	0x1b,0x97,0x12,0x56,0x0e,0xb2,0x3a,0xff,0x03,0x07,0x01,0xc9,0x1b,0xae,0xa2,0xbb,
+	0xff,0x02,0x27,0x00,0x69,0x1b,0xbe,0xa2,0x3c,0x7d,0x03,0x07,0x04,0xce,0xa2,0xbd,
+	0x02,0x47,0xcc,0x03,0xef,0xde,0xa2,0x3e,0x03,0x07,0x04,0xee,0xa2,0xbf,0xff,0x02,
+	0x67,0x00,0x65,0x1b,0xfe,0xa2,0x33,0xfd,0x03,0x07,0x04,0x3e,0xa2,0xb4,0x02,0x87,
+	0x01,0xed,0x61,0x52,0x00,0x38,0x03,0x07,0x04,0x8e,0xa2,0xb9,0x4f,0x02,0xa7,0x00,
+	0x61,0x52,0x00,0x9e,0x0e,0x12,0x67,0x13,0xd7,0x0c,0xf3,0x37,0x64,0x04,0x34,0x64,
+	0x08,0x4e,0xa2,0xdd,0xb8,0x64,0x08,0x8e,0xa2,0x39,0x64,0x08,0x9e,0xa2,0xdd,0xba,
+	0x64,0x08,0xae,0xa2,0x3b,0x64,0x08,0xbe,0xa2,0xdd,0xbc,0x64,0x08,0xce,0xa2,0x3d,
+	0x64,0x08,0xde,0xa2,0xdd,0xbe,0x64,0x08,0xee,0xa2,0x3f,0x64,0x08,0xfe,0xa2,0xe5,
+	0xb3,0x64,0x08,0x37,0x64,0x20,0x63,0x04,0x13,0x2e,0x00,0xff,0x04,0x58,0xa0,0x02,
+	0xa0,0x22,0x40,0x23,0xfd,0x83,0x77,0x10,0x26,0x42,0x09,0x26,0x52,0x06,0xfa,0x2c,
+	0x17,0x12,0x0b,0x09,0x26,0x22,0x06,0x26,0x32,0xde,0x9e,0x20,0x00,0x36,0xc2,0x60,
+	0x53,0x05,0xae,0xfe,0xf7,0xf8,0x02,0xc7,0x50,0x01,0x87,0xb2,0x5b,0x20,0xff,0x92,
+	0x90,0xaa,0x99,0xa0,0x09,0x00,0x06,0xff,0x14,0x00,0x86,0x76,0x00,0x86,0x74,0x00,
+	0xff,0x86,0x72,0x00,0x86,0x6d,0x00,0x86,0x68,0xff,0x00,0x86,0x63,0x00,0x86,0x5e,
+	0x00,0xc6,0xff,0x5a,0x00,0xc6,0x54,0x00,0xc6,0x4e,0x00,0xff,0x46,0x4c,0x00,0xc6,
+	0x49,0x00,0x46,0x47,0xff,0x00,0x46,0x43,0x00,0x46,0x3e,0x00,0x46,0xff,0x39,0x00,
+	0x46,0x34,0x00,0x46,0x2f,0x00,0xff,0x46,0x2a,0x00,0x46,0x25,0x00,0x46,0x20,0xff,
+	0x00,0x46,0x1b,0x00,0x46,0x16,0x00,0x46,0xff,0x11,0x00,0x46,0x0c,0x00,0x46,0x07,
+	0x00,0xf9,0xc6,0x7f,0x03,0x78,0x00,0x3e,0xa3,0x3b,0x04,0x07,0xff,0x01,0xa5,0x1b,
+	0xce,0xff,0x0d,0x1b,0xe7,0xee,0x1a,0x02,0x25,0x1e,0x00,0xe8,0x07,0xad,0x03,0xbe,
+	0x6f,0x09,0x0c,0x01,0x67,0x10,0x00,0x65,0x1a,0x10,0x1c,0xad,0x00,0x10,0x04,0x25,
+	0x19,0x21,0x20,0x47,0x10,0x04,0x18,0x54,0x21,0x20,0x10,0x08,0x17,0x21,0x20,0x27,
+	0x10,0x04,0x16,0x21,0x20,0xd6,0x10,0x04,0xe5,0x14,0x10,0x14,0x07,0x65,0x0c,0xe5,
+	0x13,0xcc,0x10,0x1c,0x65,0x08,0xe5,0x12,0x21,0x20,0x54,0x04,0xe5,0x11,0xcc,0x21,
+	0x20,0x10,0x04,0xa5,0x10,0x21,0x20,0x54,0x04,0xa5,0x0f,0xf4,0x21,0x20,0x10,0x08,
+	0x0e,0x10,0x08,0x3e,0x23,0x38,0x01,0xff,0xa7,0x01,0xad,0x1b,0x80,0x22,0x90,0x1d,
+	0xbf,0xf0,0x30,0x23,0x90,0x3b,0x22,0x6f,0x01,0x22,0xf7,0x20,0x23,0x90,0x06,0x18,
+	0x30,0x20,0x24,0x30,0x7f,0x83,0x41,0x8e,0x83,0x29,0x01,0x07,0x27,0x00,0xef,0x20,
+	0x29,0x93,0x8a,0x22,0x00,0x30,0x20,0x14,0xfb,0x30,0x82,0x14,0x3c,0x04,0x30,0x81,
+	0x41,0x8a,0xb9,0x83,0x0b,0x04,0x68,0x00,0x0c,0x0c,0x02,0xa1,0x07,0xa5,0xbd,0x04,
+	0x79,0x14,0x08,0x0c,0x00,0xc7,0x34,0x05,0x03,0x36,0x10,0x14,0x04,0x0c,0xc3,0x0b,
+	0x65,0x02,0x10,0x1c,0x56,0x0d,0xdd,0x01,0x10,0x08,0x30,0x23,0xa0,0x93,0x08,0x1d,
+	0xf0,0xfb,0x2d,0x03,0x3b,0x0e,0xac,0xd3,0x37,0x34,0x2b,0xff,0xbd,0x03,0xd0,0x22,
+	0x11,0xad,0x02,0xe5,0xbf,0xaf,0xfc,0x5d,0x0a,0xbd,0x03,0x08,0x00,0x06,0xff,0x06,
+	0x0c,0x19,0xa0,0xa9,0x93,0x5a,0x8a,0xff,0x80,0x84,0x82,0x80,0x20,0x24,0x80,0x83,
+	0xf1,0x41,0x90,0x10,0xc5,0x0d,0x37,0x00,0x30,0x22,0xb0,0x4a,0xff,0xa2,0x4e,0xb4,
+	0x3a,0x5e,0xc1,0x03,0xa4,0xff,0x22,0x25,0xac,0xfc,0xaa,0x82,0x0b,0x88,0x2e,0x29,
+	0x00,0x8e,0x83,0xd9,0xbf,0x00,0xa5,0xbf,0x14,0x63,0x06,0xf7,0x41,0x00,0xcc,0x93,
+	0x0b,0xbd,0x05,0xad,0x02,0xff,0xa5,0xec,0x05,0x0c,0x14,0xb0,0xb4,0x93,0xff,0xba,
+	0x4a,0xad,0x02,0xbd,0x04,0xe5,0xeb,0xff,0x05,0x0c,0x18,0xb0,0xb8,0x93,0xba,0x2a,
+	0xff,0x2a,0x23,0x20,0x24,0x82,0x1d,0xf0,0xab,0xff,0xaa,0xaa,0x3e,0xab,0xaa,0x2a,
+	0x3f,0x00,0xbf,0x00,0x40,0x3f,0xb7,0x6d,0x5b,0x07,0x00,0x00,0xff,0x3f,0xcd,0xcc,
+	0x4c,0x3f,0x55,0x55,0x55,0xfe,0x0b,0x00,0x60,0x3f,0x1e,0xc5,0x60,0x20,0xe0,0xf7,
+	0xdf,0x5f,0x3f,0x23,0x00,0x3e,0x39,0x8e,0x63,0xef,0x3f,0x25,0x49,0x12,0x1f,0x04,
+	0x3e,0x00,0x00,0xfb,0x80,0x3f,0x67,0x00,0xc1,0xf0,0xff,0x61,0xf0,0xff,0xff,0xb1,
+	0xf0,0xff,0xa1,0xf1,0xff,0x51,0xff,0xf1,0xff,0x71,0xf1,0xff,0x91,0xf1,0xff,0xf7,
+	0x8e,0xf2,0xf3,0xdc,0x0a,0x3e,0xc2,0x6d,0x00,0xfd,0x07,0xfb,0x03,0xe1,0xef,0xff,
+	0x20,0x42,0x90,0x7f,0x21,0xee,0xff,0xea,0x44,0xa0,0x04,0xe7,0x06,0xff,0xc6,0x2e,
+	0x00,0x06,0x2d,0x00,0x06,0x2b,0xff,0x00,0x06,0x29,0x00,0x46,0x27,0x00,0x86,0x7f,
+	0x25,0x00,0xc6,0x23,0x00,0x06,0x22,0xc3,0x0a,0xff,0x1e,0x00,0x86,0x1c,0x00,0xc6,
+	0x1a,0x00,0xff,0x06,0x19,0x00,0x06,0x17,0x00,0x46,0x15,0xff,0x00,0x86,0x13,0x00,
+	0xc6,0x11,0x00,0x06,0xff,0x10,0x00,0x46,0x0e,0x00,0x86,0x0c,0x00,0xdf,0xc6,0x0a,
+	0x00,0x06,0x09,0xde,0x06,0x86,0x05,0xbf,0x00,0xc6,0x03,0x00,0x06,0x02,0xe7,0x06,
+	0x2d,0x97,0x0d,0x1d,0xf0,0x60,0x01,0x08,0x03,0x00,0x72,0x01,0x2d,0x55,0x09,0x03,
+	0x00,0x07,0x03,0x00,0x0b,0x03,0x00,0x06,0x17,0x5c,0x57,0x21,0xcb,0xff,0x08,0x00,
+	0x0c,0x03,0x00,0x05,0x03,0x0c,0x97,0x21,0xc7,0xff,0x21,0x10,0x06,0x14,0x10,0x07,
+	0x10,0x21,0x73,0xc2,0xff,0x04,0x10,0x2e,0x04,0x21,0xc1,0xff,0x67,0x15,0xff,0x16,
+	0x12,0x08,0x5e,0x12,0x78,0x01,0xa7,0xff,0x00,0xc1,0x1b,0x86,0x1e,0x00,0x87,0x92,
+	0xff,0x02,0x06,0x23,0x00,0x5e,0xa2,0x79,0x01,0xf9,0xc7,0x10,0x00,0xcd,0x00,0x9e,
+	0xa2,0xea,0x00,0xe7,0x7f,0x01,0x6d,0x1b,0xae,0xa2,0x6b,0x01,0x07,0x04,0xff,0xb7,
+	0x12,0x62,0x0e,0xb2,0xfc,0x03,0x07,0xff,0x01,0xc9,0x1b,0xce,0xa2,0x7d,0x02,0x27,
+	0xff,0x01,0x69,0x1b,0xde,0xa2,0xfe,0x03,0x27,0xff,0x00,0x69,0x1b,0xee,0xa2,0x7f,
+	0x02,0x47,0xfe,0x07,0x00,0xfe,0xa2,0xf8,0x03,0x47,0x01,0x65,0xbf,0x1b,0x8e,0xa2,
+	0x79,0x02,0x67,0x07,0x00,0x9e,0xbf,0xa2,0xfa,0x03,0x67,0x00,0x65,0x42,0x00,0x7b,
+	0xfe,0x89,0x02,0x65,0x1b,0xbe,0xa2,0xfc,0x03,0x87,0xeb,0x01,0x61,0x3f,0x08,0xa7,
+	0x07,0x00,0xd7,0x12,0x0f,0x9e,0xea,0x05,0x0c,0x0a,0x25,0xc7,0x6f,0x0a,0x97,0x00,
+	0xad,0x37,0x02,0x65,0x62,0x0b,0x1c,0xe5,0x1d,0x0b,0x14,0xaf,0x00,0xdf,0x88,0x02,
+	0x37,0x18,0x0d,0x13,0x00,0x00,0x00,0x7f,0xbd,0x04,0xad,0x03,0xe5,0xf3,0xff,0x1a,
+	0x04,0xfe,0x17,0x00,0xb8,0x02,0x16,0xbb,0x07,0x5e,0x1b,0xfe,0xc9,0x10,0x21,0x00,
+	0x87,0x1b,0x79,0x0e,0xab,0xff,0x69,0x01,0xc7,0x01,0xcd,0x1b,0x9e,0xab,0xbc,0xc3,
+	0x00,0xc5,0x01,0xae,0xab,0x6c,0x01,0x07,0x04,0xc7,0xdf,0x1b,0x54,0x0e,0xbb,0x1d,
+	0xc3,0x08,0xde,0xab,0xdb,0x9e,0x02,0xbb,0x08,0xab,0x1f,0xc3,0x08,0xfe,0xab,0xdb,
+	0x98,0x02,0xbb,0x08,0xab,0x19,0xc3,0x08,0x9e,0xab,0xdb,0x9a,0x02,0xbb,0x08,0xab,
+	0x1c,0xc3,0x08,0xce,0xab,0xbb,0x9d,0x02,0xbb,0x04,0xde,0xab,0x1e,0xc3,0x08,0xee,
+	0xff,0xab,0x9f,0x02,0xa7,0x00,0x61,0x1b,0xf7,0x7b,0x1b,0x01,0x39,0x03,0x02,0x25,
+	0x64,0x00,0xb3,0x10,0x3b,0x25,0x1a,0x09,0x14,0xe5,0xbc,0x00,0xbb,0x14,0x07,0x14,
+	0x7f,0xdd,0x05,0xcd,0x04,0x82,0x22,0x22,0x35,0x07,0xa7,0xe0,0x08,0x00,0x53,0x0f,
+	0x13,0x0c,0x23,0x13,0x20,0x61,0xff,0x00,0xf2,0x22,0x24,0xbd,0x03,0xdd,0x05,0xff,
+	0x8c,0x8f,0xad,0x02,0xcd,0x04,0xe0,0x0f,0xfe,0x15,0x04,0x29,0x01,0x39,0x11,0xa8,
+	0x02,0x59,0xff,0x21,0xe5,0xa7,0xff,0x5d,0x0a,0xe5,0x44,0xef,0xff,0xde,0x80,0xf9,
+	0xa1,0x02,0xa1,0x1b,0x3e,0xef,0x00,0x0b,0x00,0x27,0x07,0x00,0x2e,0x04,0x07,0xbd,
+	0x02,0x0f,0x04,0xae,0xca,0x36,0x04,0x53,0x07,0xfe,0xfb,0x40,0x0a,0xdc,0x0b,0x76,
+	0x95,0x7d,0x9a,0x8c,0xff,0x32,0x48,0x00,0x52,0x04,0x00,0xd0,0x55,0xff,0x10,0x52,
+	0x48,0x00,0xe2,0x04,0x01,0xe0,0xff,0xe1,0x41,0xf0,0xee,0x10,0xe0,0x55,0x20,0xbe,
+	0x0e,0x08,0x02,0xe0,0xe2,0x41,0x60,0x0e,0x1c,0x03,0xef,0xe0,0xe3,0x41,0x70,0x0e,
+	0x1c,0x04,0xe0,0xe4,0xfb,0x41,0xa0,0x0e,0x1c,0x05,0xe0,0xe5,0x41,0x20,0xbe,0x0e,
+	0x1c,0x06,0xe0,0xe6,0x41,0xb0,0x0e,0x1c,0x07,0xff,0xe0,0xe7,0x04,0xee,0x55,0x39,
+	0x20,0x21,0x7f,0x01,0xa4,0x22,0x5e,0x88,0x04,0x82,0x6a,0x03,0xff,0x22,0xa8,0x01,
+	0xb8,0x11,0xd8,0x21,0x65,0xfd,0xf1,0x78,0x0a,0x04,0xc9,0x60,0x20,0x64,0xca,0xe7,
+	0x60,0x20,0xb8,0x03,0x00,0xfb,0x00,0x2e,0x32,0x3a,0xdb,0x12,0x47,0xac,0x00,0xe5,
+	0x37,0xcd,0x01,0x39,0x0a,0xff,0xad,0x03,0x65,0xc6,0xff,0x91,0xf9,0xff,0xff,0xa9,
+	0x12,0xb1,0xf6,0xff,0xa1,0xf6,0xff,0xff,0xa2,0x62,0x23,0xa8,0x02,0xb2,0x62,0x22,
+	0xf7,0x9e,0x72,0x48,0xdd,0x01,0x85,0x1b,0x87,0x1a,0xef,0x18,0x0e,0xaa,0xcc,0xa1,
+	0x02,0xc5,0x1b,0xce,0xfb,0xaa,0xcd,0xda,0x01,0x65,0x1b,0xd7,0x1a,0x14,0xfc,0x43,
+	0x06,0x79,0x09,0x2c,0x00,0x0c,0x0e,0xe9,0x22,0xef,0xe9,0x42,0xe9,0x52,0x92,0x05,
+	0xa5,0x39,0x00,0xf7,0x46,0xfb,0xff,0x07,0x00,0x2f,0x00,0x46,0xf9,0x7e,0x07,0x00,
+	0xe5,0x33,0x00,0x46,0xf7,0xff,0x87,0x0d,0xbf,0xa8,0x52,0x8c,0x3a,0x88,0xf2,0x6e,
+	0x01,0xa8,0xdf,0x42,0x8c,0x1a,0x65,0x2e,0x1d,0x00,0x25,0x2e,0xf6,0x9f,0x08,0x96,
+	0x69,0x1f,0x00,0x61,0x00,0x39,0x11,0xff,0x68,0x11,0x49,0x01,0xc1,0xfc,0xff,0x5e,
+	0xff,0xb6,0x03,0x01,0x67,0x00,0x55,0x1b,0xee,0xfb,0x42,0x7b,0x6d,0x01,0x81,0x1b,
+	0xae,0x00,0x09,0xee,0x75,0x09,0x9e,0x71,0x2d,0x0f,0x08,0x68,0x21,0x42,0xff,0x21,
+	0x00,0x6e,0x44,0x2f,0x00,0x07,0x01,0xdf,0xad,0x1b,0x4e,0x54,0x06,0x72,0x01,0x81,
+	0x1b,0xff,0x76,0xa6,0x28,0xf0,0x6d,0x11,0xf0,0x83,0xff,0xc0,0x00,0x08,0x40,0x40,
+	0xd0,0xb1,0xde,0xfd,0xd0,0x33,0x04,0x49,0x1b,0x6e,0xdd,0x3f,0xe0,0xee,0x18,0x05,
+	0x7e,0x0e,0x08,0x0f,0x00,0x55,0x1b,0xc6,0xff,0x03,0x00,0x3d,0xf0,0xf8,0x21,0x98,
+	0x11,0xff,0x1b,0xff,0xf9,0x21,0xf7,0x99,0xb3,0xc6,0xff,0x14,0x00,0x78,0x62,0xf0,
+	0xeb,0x11,0x9a,0xff,0x77,0x78,0x07,0xa0,0x63,0x41,0x6a,0x65,0xff,0xd0,0x77,0x10,
+	0x70,0xb0,0xf5,0xb0,0x77,0xaf,0x30,0x70,0xb8,0x41,0x05,0x04,0xb4,0x05,0x08,0x70,
+	0xff,0x34,0x00,0x07,0x40,0xc0,0xb0,0xb1,0xb0,0xff,0xb0,0x04,0xe0,0xbb,0x20,0xb2,
+	0x46,0x00,0xff,0xe8,0x72,0x8e,0x48,0x1a,0x40,0x21,0x00,0xff,0x60,0x22,0xee,0xe8,
+	0xd9,0x20,0x81,0x01,0xff,0x74,0x22,0x46,0xe9,0xff,0x0c,0x0b,0xae,0xfb,0x00,0x0d,
+	0xaa,0x08,0x48,0x82,0x0b,0x44,0x16,0xdf,0xb4,0x06,0xee,0x42,0x76,0xb1,0x08,0x69,
+	0x21,0xff,0xf0,0xdd,0x11,0x16,0x2e,0x05,0x9e,0x00,0xee,0x85,0x04,0xa1,0x1b,0xf8,
+	0x72,0x08,0xff,0xf8,0x0f,0xff,0xa0,0x73,0x41,0x7a,0x75,0xd0,0xff,0x10,0xff,0xf0,
+	0x60,0xf5,0x60,0xff,0x30,0xf0,0x68,0xf5,0x41,0x05,0x04,0x64,0x05,0x08,0xf0,0x34,
+	0x00,0x0f,0xf2,0x72,0x20,0x47,0x72,0x40,0x65,0x04,0x68,0x21,0x1b,0x66,0xff,0x69,
+	0x21,0x47,0x36,0x9d,0xa7,0x03,0x15,0xbf,0xa0,0x93,0x41,0x3e,0xbb,0xfa,0x22,0x00,
+	0xac,0xff,0x22,0xa0,0x80,0x24,0x9a,0x95,0xb2,0x49,0x6f,0x00,0x56,0x98,0xfe,0x07,
+	0x0f,0x61,0x00,0xec,0x06,0xff,0x65,0x0c,0x00,0xad,0x04,0xd8,0x32,0xc8,0xff,0x42,
+	0xed,0x01,0xbd,0x0d,0xd0,0xdd,0x11,0xff,0xe5,0xa9,0x00,0xe8,0x32,0x0c,0x0a,0x1e,
+	0xff,0xee,0xfd,0x1f,0xe7,0x00,0xad,0x1b,0x0e,0xfb,0x2e,0x0c,0x25,0x09,0x98,0x42,
+	0xaa,0x99,0xb2,0xff,0x09,0x00,0x8d,0x0c,0xb0,0x8d,0x93,0x82,0xbf,0x49,0x00,0xf8,
+	0x32,0x1e,0xff,0x56,0x0c,0xf7,0x2f,0x3a,0xe3,0xbd,0x05,0xb8,0x01,0x04,0x47,0x13,
+	0x53,0x04,0xff,0x25,0x07,0x00,0x88,0x32,0xd0,0x88,0x11,0xf7,0x0e,0x28,0x0a,0x3c,
+	0x08,0xc8,0x42,0xb2,0x04,0xff,0x00,0xaa,0xcc,0xb2,0x4c,0x00,0x98,0x32,0xfb,0x1e,
+	0x99,0x37,0x0c,0x9e,0xea,0x84,0x80,0x20,0x37,0x00,0x7c,0x22,0x3c,0x04,0x65,0x00,
+	0x3c,0x00,0x3b,0x00,0x9f,0x88,0xc2,0xae,0x42,0x5b,0x1e,0x09,0x13,0x02,0xd8,0xff,
+	0x82,0xc8,0x22,0xa8,0x52,0x88,0xd2,0xd0,0xff,0xcc,0xb0,0xbe,0x42,0x4c,0x9e,0xe1,
+	0x02,0xfb,0x80,0x22,0x15,0x00,0xbd,0x03,0xc8,0x22,0x88,0xbf,0xe2,0xa8,0x52,0x1e,
+	0xcc,0xfd,0x28,0x00,0xad,0xfd,0x1b,0xbf,0x1b,0x88,0x22,0x37,0x18,0x2d,0xbd,0xff,
+	0x03,0x39,0x22,0xa8,0x02,0x25,0x6e,0xff,0xff,0xb8,0x52,0xa9,0x32,0x8c,0x5b,0x88,
+	0xf2,0xfb,0xad,0x0b,0x5d,0x06,0x22,0x88,0xb2,0xd0,0xaa,0xfd,0x11,0x09,0x00,0xb8,
+	0x32,0xa9,0x52,0xa8,0x42,0xff,0xd0,0xbb,0x11,0x25,0x12,0xff,0xa9,0x42,0xff,0x1d,
+	0xf0,0xd0,0x5c,0x00,0x20,0xac,0xe9,0x57,0x60,0x20,0xd4,0x03,0x00,0xe8,0x03,0x00,
+	0xf8,0x03,0x00,0xfb,0xc8,0xe9,0x13,0x0b,0x81,0xfd,0xff,0x91,0xfb,0xff,0xff,0xa1,
+	0xf9,0xff,0xb1,0xf8,0xff,0xc1,0xff,0xf6,0xff,0x31,0xfa,0xff,0x39,0xf2,0x89,0xff,
+	0xe2,0x99,0xd2,0xa9,0xc2,0xb9,0xb2,0xce,0xfb,0x72,0x6d,0x8e,0x02,0x81,0x1b,0xde,
+	0x72,0x8e,0x5e,0xf4,0x03,0x81,0x1b,0xe9,0x72,0x83,0x00,0xd8,0x4b,0x00,0x5f,0x0c,
+	0xea,0x60,0x20,0x34,0x03,0x00,0x48,0x03,0x00,0xad,0x58,0x03,0x00,0x28,0xea,0x4b,
+	0x88,0x87,0x4b,0x34,0xe0,0xaa,0x4b,0x00,0x6c,0x3b,0x00,0x94,0x03,0x00,0xa8,0x03,
+	0x00,0xb8,0xaa,0x03,0x00,0x88,0x4b,0xa8,0x01,0x4b,0x18,0xf0,0x4b,0x00,0xcc,0xfa,
+	0x3b,0x00,0xf4,0x03,0x00,0x08,0xeb,0x60,0x20,0x18,0xaa,0x03,0x00,0xe8,0x4b,0x8c,
+	0xe7,0x97,0x10,0x67,0x4b,0x14,0x98,0xdf,0xcd,0x60,0x20,0x84,0xcf,0x03,0x00,0xd0,
+	0x60,0xf7,0x20,0xea,0xcc,0x43,0x08,0x2e,0x32,0x3a,0x12,0xff,0x47,0x01,0xa5,0x1b,
+	0x25,0xf4,0xfe,0x2d,0xff,0x0a,0x39,0x0a,0xad,0x03,0xa5,0x82,0xff,0xff,0x98,0x02,
+	0xa9,0x12,0xb1,0xf6,0xff,0xc1,0xff,0xf4,0xff,0xc2,0x62,0x22,0xb2,0x62,0x23,0xff,
+	0xa1,0xf4,0xff,0xae,0x72,0x49,0x3c,0x21,0xff,0x02,0x84,0x22,0xf6,0xa9,0x30,0xe1,
+	0xf1,0xff,0xff,0x90,0xd9,0x90,0xea,0xdd,0xa0,0x0d,0xfe,0x85,0x02,0x06,0x09,0x00,
+	0x46,0x0a,0x00,0x46,0xff,0x1f,0x00,0x86,0x1c,0x00,0xc6,0x19,0x00,0xff,0x06,0x17,
+	0x00,0x46,0x14,0x00,0x86,0x11,0xff,0x00,0xc6,0x0e,0x00,0x06,0x0c,0x00,0x46,0xff,
+	0x09,0x00,0x86,0x06,0x00,0x0c,0x02,0x1d,0xff,0xf0,0xad,0x02,0xe5,0x47,0x00,0x06,
+	0x01,0xfd,0x00,0x5c,0x02,0x49,0x00,0x0c,0x0f,0xf9,0x22,0xef,0xf9,0x42,0xf9,0x52,
+	0x16,0x08,0x59,0x00,0x46,0xff,0xfb,0xff,0xad,0x02,0xa5,0x57,0x00,0x46,0x7d,0xf9,
+	0x07,0x00,0x65,0x55,0x00,0x46,0xf7,0x07,0x00,0xdf,0x25,0x53,0x00,0x46,0xf5,0x07,
+	0x00,0xe5,0x50,0xf7,0x00,0x46,0xf3,0x1f,0x04,0x4e,0x00,0x46,0xf1,0xde,0x1f,0x04,
+	0x4c,0x00,0x46,0xef,0x1f,0x04,0x4a,0x00,0x7b,0x46,0xed,0x1f,0x04,0x47,0x00,0x46,
+	0xeb,0x1f,0x04,0xf3,0x45,0x00,0xaf,0x03,0x17,0x07,0x41,0x00,0xa8,0x52,0xef,0x8c,
+	0x3a,0x88,0xf2,0x39,0x06,0x42,0x8c,0x1a,0xd7,0xe5,0xe4,0xfe,0x1d,0x00,0xe4,0x34,
+	0x0b,0x36,0xa1,0xff,0x00,0x49,0x11,0x39,0x21,0x88,0x21,0x59,0xff,0x01,0x31,0xd7,
+	0xfe,0x16,0xd8,0x0f,0x68,0xdf,0x72,0x78,0x92,0x5e,0x00,0xe5,0x06,0xa1,0x1b,0xfb,
+	0x4e,0x00,0x2a,0x07,0xa1,0x1b,0xce,0x71,0x4b,0xfe,0xc3,0x0a,0xf8,0x41,0xe8,0x11,
+	0xf0,0xcb,0x11,0xff,0xfe,0xee,0x2f,0x00,0x87,0x01,0xad,0x1b,0xdf,0xf9,0x61,0xee,
+	0x5e,0x0d,0x18,0x08,0xee,0x71,0xfd,0x5e,0x3e,0x0a,0xd0,0xee,0xc0,0xb8,0x51,0xd9,
+	0xdf,0x71,0x00,0x0e,0x40,0xb0,0xd4,0x0b,0xc0,0xbb,0xef,0x20,0xbe,0x71,0x8f,0x22,
+	0x08,0x5e,0x66,0x0e,0xfe,0x39,0x0f,0x01,0xd9,0x71,0x98,0xa2,0xe0,0x87,0xff,0x82,
+	0x8a,0x8a,0x90,0x88,0xa0,0x88,0x08,0xff,0x40,0x93,0x41,0x9a,0x9c,0xee,0x38,0x0e,
+	0xff,0xc0,0x21,0x00,0x54,0x22,0x78,0x62,0xfa,0xff,0x77,0x78,0x07,0xf0,0x65,0x11,
+	0xb0,0x77,0xff,0x10,0x70,0x80,0xf5,0x80,0x77,0x30,0x70,0xeb,0x88,0x41,0x05,0x04,
+	0x84,0x05,0x08,0x70,0x34,0x00,0xff,0x07,0x40,0x30,0x50,0xb1,0x50,0x50,0x04,0xff,
+	0x60,0x55,0x20,0x52,0x49,0x00,0x68,0x72,0xf7,0x7e,0x42,0x94,0x74,0x03,0x80,0x22,
+	0x6e,0xee,0xff,0x9f,0xe0,0x81,0x00,0x74,0x22,0xb9,0x81,0xff,0x7e,0xb7,0x3a,0x40,
+	0x21,0x01,0xa4,0x22,0xff,0x25,0x63,0x05,0x88,0x61,0xb8,0x81,0xd8,0xff,0x71,0x0c,
+	0x7e,0x3e,0xcb,0xf8,0x1e,0xe1,0xff,0x02,0xac,0x22,0x8e,0x71,0x6d,0xa0,0x21,0xfc,
+	0x2c,0x00,0xa6,0x00,0x56,0x58,0xf5,0xc8,0x41,0x98,0xff,0x21,0x1b,0xcc,0xc9,0x41,
+	0xc0,0x99,0xc0,0x5f,0x56,0x39,0xf2,0x86,0x04,0x29,0x01,0x00,0xf9,0x1c,0xfd,0x0b,
+	0x07,0x08,0xd8,0x82,0x0b,0xdd,0xd9,0x31,0xd7,0x16,0x3d,0x0a,0x69,0x04,0x9e,0xc8,
+	0x08,0xe9,0x41,0xff,0xf0,0xbb,0x11,0xb9,0x81,0x16,0x06,0x07,0xdb,0xfe,0x00,0xd2,
+	0x04,0xa1,0x1b,0xce,0x28,0xc3,0x41,0x6f,0x98,0x01,0x0e,0x48,0xce,0x30,0xca,0x99,
+	0xd0,0xc0,0x7d,0x7f,0xd0,0x08,0x88,0x82,0xbe,0x71,0x88,0xbd,0x00,0xef,0x80,0x22,
+	0x89,0x31,0xda,0x14,0x65,0x55,0x05,0xff,0x98,0x41,0xc8,0x31,0xbe,0x41,0x89,0x20,
+	0xfe,0xce,0x04,0x99,0x41,0xc7,0xb9,0x02,0xc6,0xd9,0xff,0xff,0x0c,0x7d,0x47,0x0d,
+	0x17,0xf8,0x01,0xbf,0x40,0x83,0x41,0x3e,0x55,0xf4,0x44,0x00,0xac,0xff,0x22,0x40,
+	0xe0,0x24,0x8a,0xff,0x52,0x4f,0xf7,0x00,0x56,0x7e,0xec,0x05,0x36,0x61,0x00,0xbd,
+	0xdf,0x03,0x6d,0x05,0x49,0x11,0x33,0x02,0x1b,0x00,0xff,0x69,0x31,0x98,0x82,0x88,
+	0x22,0x58,0x11,0xff,0x78,0x72,0x90,0x88,0xb0,0x5e,0x55,0x08,0xfe,0x63,0x08,0x80,
+	0x87,0x82,0x89,0x01,0x16,0x98,0xef,0x09,0x3e,0x42,0x94,0xec,0x08,0xae,0x00,0x0f,
+	0xee,0xe2,0x08,0xfe,0x71,0x26,0x0f,0x08,0x9e,0x67,0x0c,0xde,0xe8,0x01,0x55,0x1b,
+	0xbe,0x7f,0x17,0x0c,0xde,0x00,0xf7,0x0e,0x1f,0xe7,0x07,0x00,0xf0,0x83,0x82,0x98,
+	0xf7,0xa2,0x38,0x42,0x04,0x11,0x4a,0x9f,0x9a,0x33,0xef,0x5e,0x38,0x0f,0xe0,0x03,
+	0x05,0x60,0x9c,0xc0,0xff,0x00,0x09,0x40,0x9d,0x0d,0x50,0x80,0xb1,0xff,0x80,0x80,
+	0x04,0x80,0x9e,0x93,0x9e,0x83,0xfb,0x06,0xc0,0xe0,0x04,0x66,0x86,0x17,0x68,0x21,
+	0xff,0x58,0x11,0x1b,0x66,0x69,0x21,0x6a,0x55,0xbf,0x52,0x05,0x00,0x0e,0x07,0x06,
+	0x52,0x00,0x41,0xff,0x1b,0xb2,0x43,0x00,0x78,0x72,0x38,0x92,0xdf,0x77,0x3f,0xaa,
+	0x3e,0xb3,0xee,0x10,0x46,0x05,0xff,0x88,0x01,0x7a,0x44,0x87,0xb4,0x02,0x46,0xff,
+	0xdf,0xff,0x88,0xc2,0x68,0x31,0xae,0x42,0xf9,0x5b,0x8d,0x08,0xcf,0x02,0xd8,0x82,
+	0xc8,0x22,0xa8,0xff,0x52,0x88,0xd2,0xd0,0xcc,0xb0,0xbe,0x42,0xf3,0x4c,0x9e,0xc3,
+	0x04,0x15,0x00,0xbd,0x06,0xc8,0x22,0x7f,0x88,0xe2,0xa8,0x52,0x1e,0xcc,0xfd,0x28,
+	0x00,0x31,0xad,0x28,0x04,0xff,0x14,0xf9,0x02,0x0b,0x00,0xf9,0x04,0xf7,0x0c,0xfb,
+	0x71,0x18,0xf7,0x20,0x18,0x06,0x38,0x92,0xae,0xeb,0x00,0x06,0x01,0x0e,0x54,0x9b,
+	0x01,0x01,0xa5,0x1b,0xdf,0xae,0x37,0x0c,0x0f,0xe7,0xf1,0x00,0x0c,0x0d,0xff,0x98,
+	0x42,0xf8,0xa2,0xd0,0xe3,0x82,0xea,0xff,0xea,0xf0,0xee,0xa0,0xe8,0x0e,0x4a,0xbd,
+	0xff,0xba,0x99,0xae,0x0e,0x0d,0xa0,0x21,0x01,0xff,0x58,0x22,0xc2,0x49,0x00,0x06,
+	0x03,0x00,0x7f,0x6a,0xf5,0xf2,0x0f,0x00,0xfe,0x89,0xdd,0x0c,0xd6,0xc2,0x08,0x3d,
+	0xcb,0xc2,0x18,0x3a,0xc2,0x0c,0x34,0xaf,0xaf,0x88,0xc2,0x58,0x11,0xbf,0x7c,0x05,
+	0xbf,0x48,0x41,0xff,0x00,0x88,0x22,0x37,0x18,0x3e,0xbd,0x03,0xff,0x39,0x22,0xa8,
+	0x02,0xe5,0x0c,0xff,0xb8,0xff,0x52,0x88,0x82,0x98,0x22,0x38,0x72,0xa9,0xbf,0x32,
+	0x80,0x89,0xb0,0x1e,0xa9,0xe4,0x0e,0x80,0xff,0x33,0x82,0x8c,0xab,0x88,0xf2,0xad,
+	0x0b,0x7e,0xed,0x07,0x22,0xd0,0xaa,0x11,0x88,0xb2,0x09,0x00,0xff,0xa9,0x52,0xbd,
+	0x03,0xa8,0x42,0xe5,0xaf,0xf7,0xfe,0xa9,0x42,0xf6,0x07,0x00,0x30,0x5d,0x00,0xf9,
+	0x20,0x4f,0x00,0x09,0x02,0x9e,0xff,0x8e,0xfd,0xf9,0xff,0x00,0x27,0x01,0x1d,0x1b,
+	0x99,0x92,0x89,0xb5,0xa2,0x1c,0x04,0x40,0x1b,0x14,0xa5,0x9c,0x1b,0x04,0x01,0x5a,
+	0x1b,0x24,0x60,0x1b,0x14,0xe5,0x9a,0x37,0x08,0x47,0x1b,0x20,0x4d,0x80,0x1b,0x14,
+	0x25,0x99,0x37,0x08,0x1b,0x24,0xb0,0x6f,0x18,0x55,0x97,0x37,0x08,0x67,0x1b,0x20,
+	0xe0,0x6f,0x18,0x95,0x37,0x08,0x56,0x1b,0x24,0x20,0x5e,0x1b,0x14,0x98,0xa7,0x38,
+	0x30,0x1b,0x14,0x6b,0xe5,0x96,0xa7,0x38,0x50,0x1b,0x14,0x25,0x95,0xa7,0x38,0xad,
+	0x70,0x1b,0x14,0x65,0x93,0xa7,0x38,0xa0,0x6f,0x18,0x91,0xea,0xa7,0x38,0xd0,0x6f,
+	0x18,0x8f,0xa7,0x38,0x30,0xd3,0x60,0xf3,0x20,0x40,0x03,0x00,0x1f,0x00,0xa2,0xa0,
+	0x94,0xf0,0xff,0x20,0x00,0x25,0x90,0xfe,0xae,0x2a,0x3a,0xfd,0x01,0x42,0x06,0xa9,
+	0x02,0xa5,0x1e,0xff,0xa9,0x7f,0x12,0x91,0xf8,0xff,0x9e,0x72,0x38,0xcf,0x01,0xff,
+	0x85,0x1b,0x82,0x62,0x24,0xa1,0xf3,0xff,0x27,0xa2,0x62,0x22,0x8b,0x09,0x6f,0x0c,
+	0x8b,0xa2,0x07,0x0b,0x04,0xfe,0x13,0x18,0x05,0xbd,0x04,0xcd,0x03,0x65,0x97,0xf4,
+	0x17,0x14,0x0f,0x10,0x96,0x0f,0x14,0xd0,0x73,0x11,0x7e,0xff,0xc4,0x2e,0x00,0x87,
+	0x01,0x69,0x1b,0x5e,0xff,0xee,0xad,0x1f,0xe7,0x1e,0x69,0x1b,0x40,0xff,0xb3,0x41,
+	0xd0,0xab,0x11,0x2a,0x2b,0x92,0xff,0x02,0x00,0xa0,0xa4,0xc0,0x5a,0xfa,0xfe,0xef,
+	0xce,0xfc,0x1f,0xe7,0x1f,0x00,0x00,0x0a,0x40,0xff,0x40,0x4b,0xf0,0x40,0xe5,0xc0,
+	0xc0,0x70,0xff,0xb1,0xd0,0xf7,0x30,0xfe,0xf9,0x6e,0xde,0xbd,0x01,0x2a,0x02,0x00,
+	0x0e,0x40,0x60,0x96,0x03,0x77,0xff,0x10,0x70,0xff,0x20,0xfe,0x82,0x0e,0x7e,0xfd,
+	0xe0,0x7d,0x02,0xe7,0x3b,0x01,0x1d,0xf0,0x50,0x7f,0x84,0xc0,0x3e,0x52,0x18,0x04,
+	0x01,0xc8,0x02,0xf7,0x00,0x08,0x40,0x34,0x00,0x00,0x18,0x40,0x00,0xff,0x96,0xa1,
+	0x00,0x77,0xa1,0xd0,0x87,0x30,0xef,0x80,0x33,0x10,0x90,0x32,0x00,0x33,0x20,0x32,
+	0xfd,0x42,0x2a,0x04,0x4e,0xc0,0xf0,0x3e,0xc0,0x00,0xff,0x04,0x40,0xc0,0xb0,0xb1,
+	0x00,0x13,0x40,0xff,0x00,0x36,0xa1,0x00,0xbb,0xa1,0xd0,0xab,0xff,0x30,0xa0,0xa9,
+	0x10,0x30,0xbb,0x10,0xb0,0x4f,0xaa,0x20,0xa2,0x42,0xbb,0x12,0xaf,0x08,0xcd,0xaf,
+	0x00,0xff,0x65,0x1b,0x57,0x3d,0x34,0x40,0xa3,0x41,0xff,0xd0,0x9a,0x11,0x2a,0xba,
+	0x22,0x0b,0x00,0xff,0x90,0x94,0xc0,0x5a,0xc9,0xc7,0xbd,0x47,0xff,0x4e,0x4a,0x8d,
+	0x7e,0xe0,0x03,0xa4,0x22,0xf7,0xde,0xaa,0x8c,0xb5,0x00,0x61,0x1b,0x32,0x0b,0xff,
+	0x01,0x50,0x74,0xc0,0x72,0xc7,0x10,0x00,0x7f,0x07,0x40,0x30,0x30,0xb1,0xc6,0x00,
+	0x48,0x00,0xff,0x0c,0x03,0x40,0x75,0xc0,0x00,0x09,0x40,0xdf,0xce,0x82,0xe7,0xfe,
+	0x00,0x2b,0x00,0x00,0x17,0xff,0x40,0x80,0x22,0x10,0x20,0x20,0x74,0x00,0x7f,0x22,
+	0xa1,0x20,0x23,0x20,0x22,0x46,0x23,0x00,0xf7,0xc0,0x7d,0xc0,0x31,0x00,0x20,0x70,
+	0xb1,0x8e,0xdb,0xb5,0x52,0x80,0x01,0x85,0x1b,0x1b,0x00,0x0b,0x22,0xbf,0x70,0x22,
+	0x10,0x86,0xf7,0xff,0x87,0x00,0x3e,0xdb,0xa3,0x3b,0x84,0x00,0xa5,0x1b,0xa4,0x05,
+	0xec,0x04,0xff,0x8d,0x0b,0x1e,0x18,0x6b,0x01,0x07,0x00,0xff,0xc1,0x1b,0x0c,0x0b,
+	0xaa,0x9b,0x9e,0xe5,0xff,0x9e,0x01,0x67,0x00,0x6d,0x1b,0x5e,0x43,0x7d,0x0b,0xa8,
+	0x01,0x55,0x1b,0xde,0x00,0x0a,0x07,0x00,0xff,0xa1,0x1b,0x76,0x93,0x30,0xba,0xf2,
+	0xfe,0xef,0x5f,0x09,0x60,0x21,0x12,0x01,0xbd,0x09,0x90,0xff,0xc0,0x24,0xf0,0xf0,
+	0x04,0xf0,0xaa,0x20,0xff,0xdc,0x0c,0xda,0x84,0xae,0x88,0x0d,0xa0,0xf6,0x16,0x04,
+	0x0e,0x0a,0x2b,0x04,0x41,0x1b,0xf0,0xaa,0xff,0x11,0xa0,0xa0,0x74,0x3d,0xf0,0xbd,
+	0x03,0xff,0x46,0x02,0x00,0x0c,0x0b,0xae,0x00,0x0d,0xfe,0x42,0x08,0xb7,0x0e,0x0c,
+	0xa0,0xb1,0x41,0xda,0xb7,0xc4,0xbe,0x8c,0x2e,0x0c,0xd9,0x06,0xc7,0x1d,0x77,0xdf,
+	0x35,0x54,0xde,0x43,0x08,0x71,0x08,0x0c,0x05,0xff,0x76,0x93,0x40,0x8a,0x72,0x72,
+	0x07,0x00,0xff,0x5a,0xa4,0x70,0x90,0x04,0x70,0xb1,0x04,0xff,0x70,0xc2,0x04,0x70,
+	0xd3,0x04,0x70,0xe4,0xff,0x04,0x70,0xf5,0x04,0x70,0x36,0x04,0x32,0xff,0x4a,0x01,
+	0xf2,0x4a,0x02,0xe2,0x4a,0x03,0xff,0xd2,0x4a,0x04,0xc2,0x4a,0x05,0xb2,0x4a,0xff,
+	0x06,0x92,0x4a,0x07,0x7e,0x77,0xd5,0xa2,0xff,0x00,0x01,0xa4,0x22,0x7e,0x8a,0x08,
+	0x00,0x7e,0x5c,0x04,0x46,0x00,0x00,0x0c,0x05,0x59,0x61,0x00,0xff,0x36,0x81,0x00,
+	0xbd,0x06,0x29,0x11,0x59,0xff,0x31,0x40,0xa3,0x82,0x5d,0x06,0xa9,0x71,0xfe,0xf4,
+	0x00,0xe5,0xdc,0x04,0x9d,0x0b,0x1e,0x19,0xfe,0xf4,0x18,0xbb,0xb7,0xb7,0x02,0x06,
+	0x3b,0x00,0xdf,0xa8,0x71,0x5e,0x71,0x42,0x82,0x00,0x81,0x1b,0xb7,0xbe,0x71,0x06,
+	0x07,0x08,0x3e,0x9a,0x04,0x0d,0x4e,0xdc,0x05,0x00,0xc1,0x04,0xbe,0x71,0x2c,0x17,
+	0x08,0xce,0x71,0xbb,0x5d,0xbe,0x2a,0x06,0xde,0x71,0x65,0x0f,0x08,0xcc,0xff,0xf7,
+	0x88,0x21,0x58,0x11,0x8e,0x55,0x28,0xff,0x00,0x21,0x01,0xac,0x22,0x89,0x21,0x52,
+	0xff,0x05,0x00,0x70,0x93,0xc0,0x3e,0x84,0xf9,0xfb,0x3e,0xe1,0x64,0x06,0x09,0x40,
+	0x50,0x40,0xb1,0xff,0x40,0x40,0x04,0x80,0x44,0x20,0x88,0x61,0xff,0xb8,0x51,0xa8,
+	0x31,0x67,0x98,0x11,0xba,0xef,0xaa,0x4e,0x8a,0x0b,0x4c,0x09,0xbe,0x71,0x54,0xde,
+	0x6c,0x0c,0xb3,0x3a,0xe0,0x20,0xc1,0x00,0xa5,0xe7,0xff,0x04,0x7d,0x0a,0xbe,0x41,
+	0x4a,0xc0,0x20,0xfe,0x1c,0x00,0xe5,0xe6,0x04,0xb8,0x71,0xae,0x6a,0xfb,0x32,0x40,
+	0x19,0x04,0x27,0x9b,0x95,0xc6,0x04,0x3e,0x1a,0x03,0x0c,0x06,0x5e,0x71,0x4c,0x88,
+	0x10,0x3b,0x0c,0xff,0xe8,0x51,0xd8,0x01,0x58,0x41,0xb2,0x21,0xff,0x10,0xe7,0x1d,
+	0x21,0x88,0x51,0x98,0x31,0xff,0x57,0xb6,0x0e,0x60,0xf5,0xc0,0x16,0x8f,0xff,0x00,
+	0x26,0x1f,0x02,0x76,0x9f,0x02,0xf0,0xbf,0x44,0x11,0x8a,0x99,0x4e,0x89,0x19,0x0d,
+	0x89,0x9f,0x51,0xa8,0x51,0xa9,0x0b,0x63,0x0b,0x00,0x04,0x65,0xff,0x78,0x70,0x61,
+	0x6e,0x64,0x20,0x33,0x32,0xff,0x2d,0x62,0x79,0x74,0x65,0x20,0x6b,0x00,0xfe,0x7b,
+	0x0f,0xa1,0xfb,0xff,0xb1,0xf9,0xff,0x81,0xff,0xfb,0xff,0x91,0xfa,0xff,0x99,0x22,
+	0x89,0xff,0x32,0xb9,0x02,0xae,0x72,0x1c,0x00,0x47,0xfa,0xa7,0x0c,0x44,0x69,0x05,
+	0x65,0x91,0xfb,0xa2,0xc2,0xff,0x14,0xce,0x04,0x0b,0x60,0x80,0x00,0xa0,0xd7,0x22,
+	0xa5,0x90,0x0d,0x00,0x18,0x0d,0x00,0x62,0x00,0xca,0x0d,0x04,0x8f,0x0d,0x00,0x1c,
+	0x0d,0x04,0x1b,0x04,0xe5,0x8e,0x6a,0x0d,0x00,0x20,0x0d,0x00,0x64,0x1b,0x04,0xe5,
+	0x8d,0x0d,0x00,0xa9,0x24,0x0d,0x04,0x1b,0x04,0x25,0x0d,0x04,0x28,0x0d,0x00,0x66,
+	0xbe,0x1b,0x04,0x25,0x8c,0xfb,0xb2,0xc3,0x37,0x00,0x0a,0xfd,0x4a,0x1b,0x04,0x65,
+	0x8b,0xfb,0x5e,0x72,0xca,0xfb,0x4c,0x80,0xb4,0x00,0x4e,0xb4,0x3c,0x00,0x47,0x56,
+	0xb2,0x02,0x25,0x8a,0x2e,0x00,0x38,0x2e,0x00,0x80,0x3c,0x08,0xd5,0x89,0x0d,0x00,
+	0x3c,0x0d,0x00,0x82,0x3c,0x04,0x65,0x88,0xfd,0xfb,0xd5,0x00,0x6b,0xd9,0x60,0x20,
+	0x36,0x21,0xff,0x01,0x39,0x01,0x78,0x02,0x68,0x12,0x58,0xff,0x22,0x48,0xf2,0xf8,
+	0x42,0xe8,0x52,0xd8,0xff,0x62,0xc8,0x72,0xb8,0x82,0xa8,0x92,0x98,0xff,0xa2,0x88,
+	0xb2,0x89,0xc1,0x99,0xb1,0xa9,0xff,0xa1,0xb9,0x91,0xc9,0x81,0xd9,0x71,0xe9,0xff,
+	0x61,0xf9,0x51,0x42,0x61,0x10,0x59,0x31,0xff,0x52,0x61,0x13,0x69,0x21,0x62,0x61,
+	0x12,0xff,0x79,0x11,0x72,0x61,0x11,0x38,0x32,0x39,0xff,0x41,0x78,0xc2,0x68,0xd2,
+	0x58,0xe2,0x59,0xff,0xf1,0x69,0xe1,0x79,0xd1,0x4e,0x24,0x34,0xfb,0x00,0xa7,0x7c,
+	0x00,0x16,0x44,0x1a,0x96,0x14,0xff,0x1a,0x76,0xa4,0x17,0x40,0x01,0x03,0x40,0xdf,
+	0x00,0x13,0x41,0xe5,0xff,0x4c,0x02,0x40,0x01,0xfb,0x13,0x00,0x05,0x00,0x02,0x03,
+	0x42,0xc4,0x01,0xff,0xca,0x33,0x42,0x21,0x11,0x22,0x61,0x14,0xff,0x10,0x40,0x40,
+	0xfa,0x44,0x70,0x74,0x30,0xff,0x70,0x77,0x81,0x7a,0x2b,0x10,0x44,0x40,0xff,0x20,
+	0xbf,0x30,0xb0,0xbb,0x81,0x10,0x48,0xff,0x40,0xb2,0x61,0x15,0xba,0x44,0x40,0xf7,
+	0xff,0x30,0xb2,0x21,0x12,0xf0,0xff,0x81,0xf2,0xfb,0x61,0x17,0x29,0x04,0xf2,0x72,
+	0x21,0x17,0x22,0xff,0x21,0x13,0xf2,0x61,0x16,0xea,0xbb,0x60,0xff,0x6b,0x30,0xf2,
+	0x21,0x14,0x60,0x66,0x81,0xfe,0x35,0x00,0xda,0x22,0x6a,0xaa,0xf0,0xf3,0x30,0xff,
+	0xa0,0xee,0x30,0x50,0x52,0x30,0xe0,0xee,0xbe,0x3f,0x04,0xea,0xbb,0xb0,0x66,0x30,
+	0x1d,0x00,0x6a,0x9d,0xaa,0x38,0x00,0x50,0x55,0x81,0x1b,0x00,0x28,0x00,0x5a,0xff,
+	0x99,0x90,0xdd,0x30,0xd0,0xdd,0x81,0xda,0x1d,0x22,0x22,0x00,0x20,0x55,0x30,0x18,
+	0x00,0x1e,0x00,0x15,0x08,0xf6,0x65,0x00,0xfa,0x88,0x22,0x00,0x80,0xcc,0x30,0xc0,
+	0xbd,0xcc,0x41,0x04,0xca,0x33,0x30,0xff,0x15,0x10,0x49,0x71,0x40,0x54,0x00,0x18,
+	0x00,0x2b,0x00,0xea,0x44,0x40,0x15,0x0c,0xed,0x99,0x2b,0x00,0x90,0xee,0x6d,0x14,
+	0x44,0x42,0x61,0xdd,0x11,0x18,0x0c,0xf2,0x61,0x14,0x1b,0x00,0x49,0x40,0xdc,0x65,
+	0x00,0x1e,0x00,0xf2,0x21,0x15,0x21,0x00,0xda,0xbb,0x86,0x39,0x00,0xb0,0x77,0xe5,
+	0x08,0x63,0x08,0x84,0x08,0x37,0x00,0xda,0xef,0xbb,0xb2,0x61,0x12,0x18,0x0c,0xb2,
+	0x21,0x16,0x66,0x35,0x00,0x7a,0x88,0x1b,0x00,0x7f,0x00,0xca,0x22,0x20,0x00,0xab,
+	0xb0,0xff,0x71,0x04,0x20,0xc7,0x0c,0xbb,0x37,0x00,0xb0,0xde,0x9b,0x18,0x22,0x22,
+	0x61,0x13,0x18,0x0c,0x22,0x21,0xcd,0x14,0x1b,0x00,0x49,0x40,0x7a,0x00,0x1e,0x0c,
+	0xfa,0x33,0xb2,0x34,0x00,0x30,0xdb,0x0c,0xf1,0x00,0xaa,0xa0,0xaf,0x0c,0x33,0xf4,
+	0x36,0x00,0x15,0x10,0x49,0x15,0x18,0x48,0x41,0x3a,0x44,0xff,0x38,0x01,0x49,0x33,
+	0x48,0x51,0xfa,0x44,0xff,0x49,0x43,0x48,0x61,0xea,0x44,0x49,0x53,0xff,0x48,0x71,
+	0xda,0x44,0x49,0x63,0x48,0x81,0xff,0xca,0x44,0x49,0x73,0x48,0x91,0xba,0x44,0xff,
+	0x49,0x83,0x48,0xa1,0xaa,0x44,0x49,0x93,0xff,0x48,0xb1,0x9a,0x44,0x49,0xa3,0x48,
+	0xc1,0xff,0x8a,0x44,0x49,0xb3,0x48,0xd1,0x7a,0x44,0xff,0x49,0xc3,0x48,0xe1,0x6a,
+	0x44,0x49,0xd3,0xff,0x48,0xf1,0x5a,0x44,0x49,0xe3,0x42,0x21,0xff,0x10,0x2a,0x24,
+	0x29,0xf3,0x42,0x21,0x13,0xff,0x28,0x31,0x4a,0x22,0x29,0x23,0x42,0x21,0xd7,0x12,
+	0x28,0x21,0x08,0x00,0x13,0xe7,0x01,0x28,0x11,0xfa,0x08,0x00,0x03,0x47,0x0b,0x36,
+	0x61,0x00,0x59,0x21,0xff,0x98,0x21,0x5d,0x02,0x90,0x92,0x41,0x16,0xff,0x79,0x04,
+	0x7d,0x04,0x6d,0x05,0x30,0x29,0xff,0xa0,0xe0,0xb9,0x11,0xb9,0x11,0xad,0x01,0xfb,
+	0x3e,0xb3,0xba,0x0e,0x65,0x5e,0xfb,0xe8,0x01,0xff,0xd8,0x07,0xad,0x06,0xbd,0x01,
+	0xe0,0xdd,0xef,0x30,0xde,0x71,0x0c,0x4d,0x0b,0x25,0x5d,0xfb,0xf7,0x6e,0x46,0x43,
+	0x42,0x03,0x60,0x22,0x2e,0x03,0xff,0x17,0xe0,0x80,0x01,0x98,0x22,0x46,0x03,0xfc,
+	0x9a,0x13,0x43,0x04,0xf9,0x11,0xf9,0x11,0xa8,0x11,0xff,0x98,0x21,0x5a,0x5a,0x4a,
+	0x4a,0x90,0x90,0xff,0x14,0x26,0x19,0x2a,0x26,0x29,0x34,0x66,0xff,0x39,0x2f,0xc2,
+	0x02,0x01,0xe8,0x04,0xb2,0xff,0x02,0x02,0xd2,0x02,0x00,0xe0,0xf0,0xf5,0xf7,0xf0,
+	0xbb,0x30,0x53,0x00,0xd2,0x45,0x00,0xb2,0xff,0x45,0x02,0xe0,0xf8,0x41,0xf0,0xcc,
+	0x30,0xff,0xc2,0x45,0x01,0x1d,0xf0,0x98,0x04,0x82,0xff,0x02,0x00,0x90,0x88,0x30,
+	0x82,0x45,0x00,0xff,0x1d,0xf0,0xc8,0x04,0xa2,0x02,0x01,0xb2,0xff,0x02,0x00,0xc0,
+	0xd8,0x41,0xd0,0xaa,0x30,0x7f,0xc0,0xbb,0x30,0xb2,0x45,0x00,0xa2,0x25,0x04,0xfe,
+	0xbf,0x04,0x01,0xdd,0x07,0xcd,0x06,0xbd,0x05,0xff,0xad,0x01,0x65,0xc0,0xff,0x42,
+	0x61,0x23,0xff,0x40,0x86,0x41,0x82,0x61,0x21,0x16,0xc8,0xff,0x08,0x0c,0x09,0x9e,
+	0x71,0x24,0x70,0x00,0x7f,0x00,0x84,0x22,0x1e,0xa1,0x3b,0x30,0xf6,0x07,0xff,0x25,
+	0xca,0xff,0xa8,0xc1,0x5d,0x02,0x3e,0xef,0x73,0x3a,0x40,0x21,0x0e,0x00,0xae,0x71,
+	0xc6,0xfb,0x30,0x00,0xa0,0x03,0x7e,0xb7,0x3a,0x3e,0xe0,0xf6,0x0f,0x04,0x4a,0x1c,
+	0xd7,0x00,0x61,0x1b,0xa5,0x4f,0xff,0xfb,0xe2,0x21,0x20,0xd8,0x06,0x5e,0xa5,0xee,
+	0xfd,0x0c,0xee,0xdd,0x9b,0x1f,0x08,0xde,0x71,0x0b,0xfb,0x60,0x21,0x4e,0x00,0xa5,
+	0x4d,0xfb,0x5e,0x45,0xfb,0x47,0xe0,0xf7,0x04,0x4e,0x07,0x16,0xc0,0x80,0xff,0x00,
+	0x98,0x22,0x82,0x21,0x22,0xf2,0x21,0xbf,0x21,0x8e,0x48,0x12,0x50,0x00,0x15,0x00,
+	0x8e,0x7b,0x71,0x23,0x77,0x08,0x8e,0xaf,0x74,0x90,0x0f,0x04,0xff,0x06,0xdf,0xff,
+	0x42,0x21,0x23,0x40,0x40,0xf7,0x54,0x9c,0x84,0x8a,0x14,0xa5,0xc1,0xff,0xdd,0xbf,
+	0x04,0xbd,0x03,0x2e,0xa2,0x3c,0x0e,0x0c,0xe7,0xdd,0xff,0xcc,0x00,0xff,0xff,0xff,
+	0x3f,0x15,0x00,0x36,0xff,0x21,0x02,0x22,0x61,0x35,0x32,0x61,0x2d,0xff,0x91,0xd0,
+	0xca,0x42,0x61,0x28,0x5d,0x02,0xff,0x68,0x25,0xb8,0x35,0xf8,0x55,0xc8,0x65,0xff,
+	0xe8,0x75,0xd8,0x85,0x42,0x05,0x4c,0xa8,0xbf,0x95,0x7e,0x45,0x48,0x00,0x07,0x86,
+	0x01,0x40,0xff,0x98,0x93,0x42,0x21,0x28,0x38,0x15,0x28,0xff,0x02,0xf6,0xb4,0x02,
+	0xc6,0xf8,0x00,0x51,0xff,0xee,0xff,0x79,0xe1,0xb2,0x61,0x26,0x62,0xff,0x61,0x2b,
+	0x32,0x61,0x2e,0x70,0x87,0xa0,0xff,0x99,0xd1,0x82,0x61,0x2f,0xb0,0x8b,0xa0,0xdf,
+	0x82,0x61,0x2c,0x60,0x86,0x05,0x00,0x27,0x30,0xff,0x83,0xa0,0x89,0xf1,0x82,0x21,
+	0x2d,0x42,0xff,0x08,0x03,0x92,0x08,0x04,0x32,0x08,0x00,0xff,0xb2,0x08,0x07,0x62,
+	0x08,0x02,0x72,0x08,0xff,0x01,0x80,0xbb,0x11,0x00,0x66,0x11,0x80,0xff,0x77,0x11,
+	0x70,0x33,0x20,0x80,0x99,0x11,0xff,0x80,0x74,0x01,0x90,0x44,0x20,0x70,0x66,0xff,
+	0x20,0x60,0x33,0x20,0x72,0x08,0x06,0x62,0xff,0x08,0x05,0x50,0x33,0x10,0x3a,0x3f,
+	0x80,0x5f,0x97,0x01,0xb0,0x77,0x20,0x28,0x00,0x90,0x19,0x00,0xff,0x44,0x20,0x92,
+	0x08,0x08,0x62,0x08,0x09,0xff,0x40,0x42,0x41,0x50,0x44,0x10,0x4a,0x4c,0xff,0x00,
+	0x99,0x11,0xc2,0x08,0x0a,0x80,0xb6,0xff,0x01,0xb0,0x99,0x20,0x90,0x77,0x20,0xb2,
+	0xff,0x08,0x0c,0x92,0x08,0x0b,0x70,0x74,0x41,0xff,0x80,0xcc,0x11,0xc0,0x66,0x20,
+	0x50,0x77,0xff,0x10,0x7a,0x7e,0x80,0xcb,0x01,0xe2,0x08,0xf5,0x0d,0x28,0x00,0xc0,
+	0x22,0x00,0x66,0x20,0xc2,0x08,0xff,0x0e,0x98,0xd1,0x60,0x66,0x41,0x80,0xee,0xff,
+	0x11,0x6a,0x6d,0xd2,0x08,0x0f,0xe0,0xbb,0xff,0x20,0x00,0xcc,0x11,0x80,0xdd,0x01,
+	0xd0,0xff,0xcc,0x20,0xc0,0xbb,0x20,0xb0,0xb8,0x41,0xfe,0x4a,0x00,0xb8,0xf1,0x9a,
+	0xaa,0xa2,0x61,0x30,0xff,0xe5,0x85,0x04,0xa9,0xc1,0xb2,0x61,0x10,0xff,0xad,0x03,
+	0xbd,0x02,0x25,0x85,0x04,0xa2,0xff,0x61,0x12,0xb2,0x61,0x11,0xad,0x04,0xb2,0xff,
+	0x21,0x2f,0x25,0x84,0x04,0xc2,0x21,0x11,0xff,0x92,0x21,0x12,0xba,0xcc,0xaa,0x89,
+	0x89,0xff,0xb1,0xc9,0x31,0x9e,0xc8,0x6c,0x80,0x21,0xfe,0x7d,0x01,0xc9,0x31,0xad,
+	0x07,0xb2,0x21,0x2c,0xfb,0x25,0x82,0x2d,0x00,0x14,0xb2,0x61,0x13,0xad,0xff,0x06,
+	0xb2,0x21,0x27,0x65,0x81,0x04,0xe8,0xff,0xb1,0xc2,0x21,0x13,0x82,0x21,0x14,0xf8,
+	0xfd,0xc1,0x31,0x00,0xd8,0x87,0xbd,0x01,0x1b,0xcc,0xff,0x88,0x31,0x92,0x21,0x10,
+	0xda,0xde,0xca,0xfb,0xc8,0xe7,0x0d,0x04,0xca,0xc9,0xda,0xdf,0xf7,0xfe,0x08,0x04,
+	0xd2,0x61,0x29,0xc2,0x61,0x15,0xad,0xdf,0x04,0xbd,0x02,0xe5,0x7d,0x44,0x00,0x17,
+	0xb2,0xff,0x61,0x16,0xad,0x03,0xb2,0x21,0x2e,0xe5,0xfd,0x7c,0x72,0x00,0x16,0xba,
+	0xcc,0xb2,0x21,0x17,0xff,0xc9,0x21,0xaa,0xab,0xa9,0xa1,0xbe,0xca,0xba,0x72,0x10,
+	0x21,0x72,0x04,0x2f,0xe5,0x7a,0x2d,0x00,0x19,0x77,0xb2,0x61,0x18,0x72,0x04,0x2c,
+	0x25,0x7a,0x2d,0x00,0x3f,0x18,0xf2,0x21,0x19,0xe8,0xa1,0x70,0x00,0x59,0x0c,0xff,
+	0xf8,0x21,0xca,0xcf,0xc2,0x61,0x33,0xda,0xcf,0xfe,0xee,0xcf,0x7c,0x39,0x08,0x0c,
+	0x00,0xa2,0x21,0xfd,0x30,0xa0,0x00,0xf2,0x61,0x36,0x25,0x77,0x04,0xff,0xe2,0x21,
+	0x36,0x82,0x21,0x29,0xd2,0x21,0xff,0x15,0xf2,0x21,0x33,0x10,0x4a,0x40,0x80,0xdf,
+	0xdd,0x81,0xda,0xda,0xa7,0x38,0x00,0xbb,0xba,0xf7,0xcf,0xda,0xde,0xa4,0x08,0xd2,
+	0x61,0x2a,0xc2,0xaf,0x61,0x1a,0xad,0x07,0x0e,0x01,0x74,0x6d,0x00,0x1c,0x77,0xb2,
+	0x61,0x1b,0x6d,0x04,0x2f,0x25,0x73,0x6d,0x00,0xfd,0x1b,0x9b,0x04,0x1c,0xc9,0x11,
+	0xaa,0x9b,0x99,0xe7,0x91,0xbe,0xc9,0x9b,0x10,0x2e,0x09,0x2e,0x25,0x71,0xde,0x2d,
+	0x00,0x1e,0xb2,0x61,0x1d,0xc9,0x04,0x2b,0x65,0xfd,0x70,0x2d,0x00,0x1d,0xf2,0x21,
+	0x1e,0xe8,0x91,0xaa,0x9b,0x1c,0x11,0x9b,0x04,0x32,0x9b,0x24,0x32,0x9b,0x08,0x2c,
+	0xdf,0xf2,0x61,0x37,0x65,0x6d,0x9b,0x00,0x37,0x82,0xff,0x21,0x2a,0xd2,0x21,0x1a,
+	0xf2,0x21,0x32,0xfe,0x9b,0x4c,0xc2,0x61,0x1f,0xd2,0x61,0x20,0xad,0xff,0x06,0xbd,
+	0x02,0x50,0x9d,0x10,0x99,0x71,0xbb,0x25,0x6a,0x72,0x00,0x22,0xb2,0x61,0x1c,0x09,
+	0x2e,0xfb,0x25,0x69,0x72,0x00,0x21,0xd2,0x21,0x22,0xba,0xff,0xcc,0xc9,0x01,0xaa,
+	0xbd,0xb9,0x81,0xde,0x75,0xcb,0xa0,0x10,0x01,0xa0,0x04,0x2b,0x25,0x67,0x2d,0x00,
+	0xef,0x24,0xb2,0x61,0x23,0xa0,0x04,0x26,0x65,0x66,0x7e,0x2d,0x00,0x23,0xf2,0x21,
+	0x24,0xe8,0x81,0xa0,0x1c,0xd5,0x01,0xa0,0x04,0x31,0xa0,0x24,0x31,0xa0,0x08,0x2f,
+	0xf2,0xef,0x61,0x38,0x25,0x63,0xa0,0x00,0x38,0x82,0x21,0x7f,0x20,0xd2,0x21,0x1f,
+	0xf2,0x21,0x31,0xa0,0x4c,0x3f,0xc9,0x51,0xad,0x06,0xd9,0x41,0x8c,0x00,0x9f,0x04,
+	0x77,0x61,0x25,0x60,0x71,0x00,0x25,0x6d,0x0b,0x9e,0x04,0xff,0x2b,0x25,0x5f,0x04,
+	0xba,0x66,0xb2,0x21,0xff,0x25,0xaa,0xeb,0xb7,0xbe,0x01,0x1b,0x66,0xfe,0x92,0x04,
+	0x26,0xe2,0x61,0x34,0xe5,0x5d,0x04,0xff,0x7d,0x0a,0x4d,0x0b,0xad,0x03,0xb8,0xe1,
+	0xff,0x25,0x5d,0x04,0xf2,0x21,0x34,0xba,0xd4,0xf7,0xaa,0xe7,0x77,0x21,0x00,0xdd,
+	0xda,0x66,0xea,0xf7,0x7f,0xf7,0xb7,0x2a,0x00,0x38,0x41,0x48,0x51,0xfc,0x86,0x00,
+	0x90,0x01,0x5b,0x04,0xd8,0x61,0xe8,0x71,0xfe,0x7a,0x00,0x30,0xc4,0x81,0xca,0xca,
+	0xa7,0xbc,0xf2,0x7a,0x04,0xa6,0x0e,0x00,0xd2,0x01,0x92,0x21,0x2d,0xca,0xff,0xc7,
+	0x50,0x88,0x10,0x7e,0xcc,0x69,0x24,0xfd,0x01,0xba,0x00,0x1b,0xaa,0xc0,0xfa,0x81,
+	0xf0,0xef,0xff,0xa0,0x8a,0xff,0x53,0x01,0x50,0xac,0x10,0xf7,0xf0,0xca,0x55,0x1d,
+	0x00,0x8a,0xcc,0x82,0x21,0xff,0x28,0x92,0x61,0x2d,0x5e,0xff,0x68,0x1c,0xff,0x01,
+	0x02,0xac,0x22,0x82,0x61,0x28,0xb6,0xef,0xb8,0x02,0x86,0x10,0x24,0x00,0x35,0xf9,
+	0x58,0xff,0xc9,0x68,0xe9,0x78,0xd9,0x88,0xa9,0x98,0xd7,0x1d,0xf0,0x00,0x00,0x18,
+	0xfc,0x04,0x04,0x36,0x61,0xff,0x00,0x98,0xe2,0x4e,0x00,0x0b,0x01,0x07,0xff,0x00,
+	0xa1,0x1b,0x7e,0x39,0x0a,0x20,0x21,0xff,0x00,0x54,0x22,0x2a,0x89,0xb2,0x48,0x3c,
+	0xff,0x2e,0xba,0xac,0x02,0x07,0x01,0xc1,0x1b,0xff,0xaa,0x92,0xa0,0xcc,0xc0,0x16,
+	0xdc,0x00,0xff,0x26,0x1c,0x02,0x76,0x9c,0x07,0x4e,0x89,0xff,0xc9,0x20,0x21,0x01,
+	0x84,0x22,0xad,0x02,0xbf,0xb2,0x42,0x4c,0xbe,0x42,0xcc,0x22,0x00,0x65,0xff,0x1b,
+	0xe5,0xb7,0xff,0x58,0x92,0x78,0x82,0xff,0x88,0x72,0xa8,0x62,0x39,0x01,0xf1,0xd9,
+	0xff,0xfe,0x38,0x52,0xa0,0x9a,0x55,0xf0,0xaa,0xff,0x10,0x9a,0x88,0xf0,0xe8,0x10,
+	0x80,0x9a,0xff,0x55,0x9a,0x77,0xf0,0xd7,0x10,0x70,0x6a,0xff,0x55,0x6a,0x55,0x50,
+	0x6a,0x55,0x60,0x66,0xff,0xa0,0x6a,0x33,0xf0,0xc3,0x10,0x30,0xba,0xff,0x55,0xba,
+	0xaa,0xfe,0xf5,0x6c,0x80,0xa1,0x6f,0x00,0xac,0x22,0xc0,0x0c,0x00,0xba,0xb0,0x21,
+	0x00,0xdb,0xee,0xe0,0x04,0x00,0xdd,0xd0,0x04,0x00,0xff,0x61,0xff,0xd7,0xff,0x6a,
+	0xff,0xf0,0x6f,0x05,0x0b,0xff,0x66,0x60,0xbb,0x10,0x60,0xff,0x10,0x60,0xff,0xdd,
+	0x10,0x60,0xee,0x10,0x6e,0xcc,0x69,0xff,0x1f,0xe7,0x1e,0xad,0x1b,0x90,0x66,0x30,
+	0xff,0xa0,0xa6,0x10,0x50,0x56,0x10,0x80,0x86,0xff,0x10,0x30,0x36,0x10,0x30,0xcc,
+	0x20,0x80,0xff,0xee,0x20,0x31,0xba,0xfe,0x88,0xb2,0x70,0xfd,0x66,0x0d,0x00,0x10,
+	0x30,0xee,0x10,0x30,0x55,0xfb,0x10,0x30,0x39,0x00,0xdd,0x20,0x30,0xdd,0x10,0xff,
+	0xb0,0xaa,0x20,0x50,0xff,0x20,0x80,0xff,0xff,0x11,0xc0,0xbe,0x01,0xe0,0xec,0x41,
+	0x60,0xbb,0x3a,0x01,0x31,0x00,0xa0,0xa6,0x41,0x17,0x00,0x20,0xff,0x3d,0x11,0x30,
+	0xee,0x20,0xd0,0xd2,0xd5,0xff,0xf0,0xdd,0x20,0xf8,0xa2,0xaa,0x58,0x38,0xfe,0x2b,
+	0x02,0xfe,0xcc,0x6b,0x00,0x07,0x00,0x61,0xff,0x1b,0x0c,0x1b,0xba,0xa5,0x8e,0xc5,
+	0x6f,0xfe,0x0b,0x0c,0x1f,0xbd,0x0f,0x98,0xc2,0x57,0xba,0xff,0x01,0x1b,0xbf,0xea,
+	0x59,0xba,0xf5,0x9e,0xfb,0xc5,0x6e,0x16,0x0c,0x1e,0xbd,0x0e,0xf0,0x90,0xff,0xf5,
+	0xf0,0x88,0x75,0x57,0xbf,0x01,0x1b,0xff,0xbe,0xe8,0xd2,0xf2,0x43,0x08,0xa2,0x43,
+	0xff,0x04,0xc2,0x43,0x00,0x82,0x43,0x0b,0x92,0xff,0x43,0x0a,0xf0,0x88,0x41,0xa0,
+	0x98,0x75,0xff,0xda,0xee,0x92,0x43,0x07,0x82,0x43,0x09,0xff,0xa0,0x98,0x41,0xa0,
+	0x80,0xf5,0xba,0xee,0xff,0xe2,0x43,0x0c,0x82,0x43,0x06,0x92,0x43,0xff,0x05,0xc0,
+	0x88,0x75,0xc0,0x90,0xf5,0x92,0xff,0x43,0x02,0x82,0x43,0x03,0xe0,0x98,0x75,0xff,
+	0xc0,0x88,0x41,0x82,0x43,0x01,0x92,0x43,0xff,0x0f,0xe0,0x80,0xf5,0x82,0x43,0x0e,
+	0xe0,0xff,0xe8,0x41,0xe2,0x43,0x0d,0x49,0x52,0x49,0xff,0x62,0x49,0x72,0x49,0x82,
+	0x49,0x92,0x49,0xff,0x02,0x49,0x12,0x49,0x22,0x49,0x32,0x49,0xff,0x42,0x49,0xa2,
+	0x49,0xb2,0x49,0xc2,0x49,0xed,0xd2,0xd1,0x01,0x36,0x41,0xc3,0x01,0x8e,0x59,0x0b,
+	0xff,0x02,0x07,0x00,0x55,0x1b,0x90,0xbb,0xc0,0xff,0xb0,0xb4,0x63,0xb0,0x44,0xc0,
+	0xac,0xbb,0xff,0x3e,0xcb,0x29,0x00,0x07,0x01,0xad,0x1b,0xff,0x16,0xcb,0x01,0x26,
+	0x1b,0x02,0x76,0x9b,0xff,0x16,0xe8,0xe2,0xd2,0x03,0x00,0x9a,0xee,0xff,0xee,0xe2,
+	0x23,0x60,0x20,0x01,0xac,0x22,0xfb,0xde,0x8e,0xcb,0x0d,0x98,0xe2,0x46,0x00,0x00,
+	0xff,0x3a,0xcb,0x3d,0x0c,0xba,0xf9,0xf9,0xe2,0xff,0xb6,0xbf,0x5a,0xad,0x02,0xce,
+	0x10,0x0b,0xff,0x4e,0x80,0x00,0xa0,0x22,0x65,0x9a,0xff,0xff,0x0c,0x08,0x89,0xe2,
+	0xb6,0xb4,0x16,0xad,0xff,0x02,0x3e,0xb3,0x35,0x1e,0x07,0x1f,0xa5,0xff,0x1b,0x50,
+	0x54,0x10,0xcd,0x05,0xe5,0x98,0xff,0xff,0x3a,0x35,0x50,0x44,0xc0,0xce,0x24,0xfd,
+	0x09,0x04,0x01,0x55,0x1b,0x16,0xc4,0x01,0x26,0xff,0x14,0x02,0x76,0x94,0x16,0xa8,
+	0xe2,0x82,0x6e,0x62,0x00,0xaa,0xae,0xa2,0x62,0x0c,0x8e,0x8a,0x62,0x0c,0xff,0xb8,
+	0xe2,0x4a,0xbb,0xb9,0xe2,0x1d,0xf0,0xee,0x7f,0x0e,0xe4,0x01,0x20,0xb3,0x00,0x30,
+	0xb0,0x34,0xdf,0x8c,0xfb,0x2e,0xa2,0x3c,0x42,0x02,0xa5,0x1b,0xff,0xb0,0xcc,0xc0,
+	0xb1,0xfa,0xff,0x65,0xf3,0xfd,0xff,0xcf,0x04,0x61,0x00,0xad,0x02,0x42,0x41,0xff,
+	0x00,0x52,0x41,0x04,0x00,0x48,0x40,0x50,0xbf,0xc8,0x75,0x50,0xd0,0xf5,0x50,0x08,
+	0x01,0x41,0xff,0x05,0xd2,0x41,0x06,0xc2,0x41,0x07,0x40,0xff,0xb5,0x81,0xb2,0x41,
+	0x01,0x10,0x40,0x40,0xff,0xbd,0x01,0x40,0x95,0x81,0x92,0x41,0x02,0xff,0x10,0x48,
+	0x40,0x40,0x85,0x81,0x8e,0x81,0xff,0x3c,0x00,0x87,0x00,0x81,0x1b,0x25,0xef,0xfe,
+	0x44,0x00,0xc0,0x4c,0x00,0x20,0x03,0xff,0xff,0xf7,0x03,0xff,0xc0,0x03,0x00,0x3f,
+	0xf0,0x03,0x36,0xff,0xa1,0x02,0xb1,0xfb,0xff,0x1e,0xa1,0x3c,0xfd,0x04,0x6d,0x04,
+	0x25,0xd4,0xfa,0xcd,0x06,0xbd,0xbf,0x05,0xde,0x00,0x0a,0x28,0x00,0xe6,0x04,0x3f,
+	0xff,0xff,0xae,0x41,0x0b,0x38,0x00,0x00,0x64,0xff,0x22,0xa5,0x4a,0xff,0xad,0x01,
+	0xce,0x20,0xfe,0x0c,0x04,0xa0,0x22,0xa5,0xd1,0xfa,0x82,0x01,0xff,0x09,0xb2,0x01,
+	0x06,0xd2,0x01,0x03,0xe2,0xff,0x01,0x04,0xc2,0x01,0x07,0xf2,0x01,0x00,0xff,0x92,
+	0x01,0x0a,0x5e,0x51,0x1a,0x3e,0xe0,0xbf,0x00,0x80,0x22,0xae,0x4a,0x16,0xfd,0x00,
+	0x65,0xff,0x1b,0x69,0x5a,0x69,0x6a,0x69,0x7a,0x69,0xff,0x8a,0x69,0x9a,0x69,0xea,
+	0x62,0x4a,0x4c,0xbf,0x80,0x55,0x11,0x80,0x99,0x11,0x6e,0x02,0x52,0xff,0x01,0x02,
+	0x80,0xcc,0x11,0x80,0xee,0x11,0xfd,0x00,0x11,0x00,0x6d,0x01,0x60,0x55,0x20,0xe0,
+	0xdf,0xdd,0x20,0x62,0x01,0x0d,0x1a,0x00,0xe2,0x01,0xff,0x05,0x51,0x0f,0xfe,0x80,
+	0x66,0x11,0x00,0xfd,0xee,0x29,0x00,0x10,0xf9,0x0a,0x52,0x01,0x0c,0xff,0x80,0xfb,
+	0x01,0xc0,0xbb,0x20,0xf0,0xee,0xef,0x20,0xc2,0x01,0x08,0x28,0x00,0xf2,0x01,0x11,
+	0xbf,0xe1,0xcf,0xff,0xd0,0xd2,0x41,0xb5,0x02,0x00,0xff,0xcc,0x11,0xe0,0xdd,0x10,
+	0xd9,0x1a,0xe2,0xff,0x01,0x10,0x80,0xd8,0x01,0x90,0x88,0x20,0xff,0xd0,0xcc,0x20,
+	0x92,0x01,0x0b,0xd2,0x01,0xfd,0x15,0x31,0x0c,0xc1,0xc6,0xff,0xb0,0xb4,0x41,0xff,
+	0xf2,0x01,0x12,0x80,0xdd,0x11,0x00,0x99,0xfb,0x11,0x00,0xe7,0x02,0xbb,0x10,0xb9,
+	0x2a,0xc2,0xff,0x01,0x14,0x80,0xb5,0x01,0xb0,0x99,0x20,0x7e,0x7a,0x00,0xb2,0x01,
+	0x19,0x62,0x01,0x0e,0x37,0x00,0xfe,0x3d,0x00,0xd2,0x01,0x16,0x91,0xba,0xff,0x80,
+	0xff,0x86,0x41,0x00,0x66,0x11,0x80,0xbb,0x11,0xff,0x90,0x88,0x10,0x89,0x3a,0x92,
+	0x01,0x18,0xbf,0x82,0x01,0x0f,0x00,0xdd,0x11,0x2e,0x00,0x80,0xef,0x88,0x01,0x80,
+	0x66,0x34,0x04,0x61,0x3f,0xc8,0xff,0xb2,0x01,0x1a,0x50,0x58,0x41,0x60,0x55,0xff,
+	0x10,0x59,0x4a,0x52,0x01,0x13,0x82,0x01,0x7f,0x1d,0x00,0xbb,0x11,0x80,0x55,0x01,
+	0xc3,0x00,0xfe,0x77,0x00,0xe9,0xaa,0xe2,0x01,0x17,0x80,0x88,0x7f,0x11,0x62,0x01,
+	0x1c,0x80,0xee,0x01,0xb4,0x00,0xbe,0x5f,0x00,0xc9,0xba,0xc2,0x01,0x1b,0x3e,0x00,
+	0x82,0xcf,0x01,0x1e,0x80,0xcc,0xd1,0x04,0x50,0x00,0x99,0xca,0xff,0x92,0x01,0x1f,
+	0x52,0x21,0x54,0x00,0x88,0xf8,0x1a,0x01,0xbf,0x04,0x1f,0x00,0x69,0xda,0x9c,0x57,
+	0x9c,0xf7,0x35,0xbd,0x07,0x4d,0x02,0xd3,0xff,0xa2,0xc1,0xff,0x7f,0x5e,0xb5,0x3a,
+	0x48,0x21,0x01,0xa4,0xff,0x22,0x65,0xde,0xff,0x3e,0xb3,0x3a,0x3e,0x6d,0xe0,0x0a,
+	0x00,0x4e,0xc4,0x12,0x0c,0xe5,0xd1,0x20,0x04,0xfb,0x4e,0xb4,0x0d,0x0c,0x25,0xdc,
+	0xff,0x5e,0xc5,0xee,0x20,0x0c,0xae,0x4a,0x1d,0x81,0x09,0xe5,0xdc,0xff,0x6c,0x2b,
+	0x00,0x12,0x28,0xa5,0xdb,0x33,0x04,0x2e,0xb2,0x54,0x10,0xf3,0xb1,0xff,0x7b,0x0e,
+	0x00,0x00,0x36,0x81,0x00,0xbd,0xff,0x07,0x72,0x21,0x10,0xed,0x05,0x7a,0x52,0xdf,
+	0xee,0x71,0x48,0xa4,0x00,0xca,0x01,0x87,0xbb,0xff,0x08,0x7a,0x8b,0x87,0xb2,0x03,
+	0x7c,0xf2,0xff,0x1d,0xf0,0xad,0x02,0xcd,0x07,0xdd,0x03,0xef,0x4e,0xe4,0x3f,0x01,
+	0x2b,0x06,0xa5,0x5c,0xff,0xff,0xed,0x04,0xdd,0x03,0xbd,0x02,0xad,0x05,0xff,0x69,
+	0x01,0xf8,0x41,0xcd,0x07,0x65,0xdb,0xaf,0xff,0x22,0xc7,0x10,0xa7,0x06,0xa1,0xa7,
+	0x02,0x29,0xff,0x81,0xbd,0x03,0x22,0x21,0x14,0x32,0x01,0xff,0x54,0xb9,0x91,0x2a,
+	0x87,0x30,0x22,0xc0,0xff,0x87,0xba,0x28,0xa9,0x81,0xaa,0x82,0x87,0xfb,0xb7,0x21,
+	0x4b,0x04,0x0c,0x09,0x0b,0xa9,0xf7,0xff,0x7a,0xf4,0xed,0x04,0xbd,0x07,0xa8,0x81,
+	0x6f,0xd8,0x91,0x2e,0xc2,0x54,0x0c,0x65,0x57,0x8e,0x08,0xf9,0xfd,0x52,0x00,0x00,
+	0x01,0x02,0xd8,0x91,0x4e,0xe4,0xf7,0x3a,0x24,0x00,0xa7,0x04,0xd5,0xff,0x9e,0xc3,
+	0xff,0xfc,0x24,0x00,0x00,0x54,0x22,0x7e,0xb2,0xfe,0xbe,0x13,0xb3,0x01,0x26,0x13,
+	0x02,0x76,0x93,0xff,0x15,0xd2,0x0c,0x00,0xe2,0x0b,0x00,0xee,0xf7,0xdd,0x9b,0x60,
+	0xd1,0x04,0xde,0x99,0x3c,0x80,0x2e,0x07,0x04,0x06,0xe7,0xff,0xd3,0x00,0x10,0x53,
+	0x07,0xd7,0x00,0xff,0x02,0x2d,0x03,0x16,0x9b,0x0e,0x16,0x63,0xdf,0x0e,0x3e,0xe5,
+	0x03,0x01,0x99,0x07,0xc1,0xff,0xff,0xee,0xa2,0x21,0x11,0xb9,0x71,0xa9,0x41,0xbf,
+	0x00,0x1a,0x40,0x8e,0x33,0x1e,0x1b,0x01,0xc5,0xef,0x1b,0x9e,0x07,0x0d,0x5a,0x00,
+	0x59,0x1b,0xed,0xff,0x04,0x86,0x00,0x00,0x40,0xd3,0xc0,0x71,0xff,0xf0,0xff,0xd9,
+	0x61,0x37,0xae,0x24,0x8d,0xdf,0x0c,0x88,0x08,0xb8,0x17,0x10,0x00,0x88,0x28,0xff,
+	0x1e,0xdd,0xfa,0x1c,0x07,0x00,0xad,0x1b,0xf7,0xbe,0xbe,0x5c,0x32,0x00,0xad,0x1b,
+	0xe0,0x08,0xff,0x00,0xb8,0x71,0xd8,0x61,0x16,0x9a,0x0e,0xff,0x81,0xeb,0xee,0x98,
+	0x17,0x88,0x08,0xcd,0xff,0x0b,0x90,0xbd,0xb0,0x88,0x38,0xd0,0xd4,0xaf,0x11,0xde,
+	0x71,0x5a,0x2a,0x00,0x81,0x22,0x04,0x16,0xff,0xaa,0x0c,0xb8,0x17,0xc8,0x41,0xad,
+	0x0b,0xff,0xf0,0x20,0x00,0x65,0x15,0x03,0x39,0x11,0xef,0xbe,0x47,0x19,0x22,0x5f,
+	0x05,0x59,0x09,0x39,0xff,0x19,0xb9,0x01,0x9d,0x0b,0xa6,0x13,0x1b,0xfe,0xcc,0x04,
+	0xa3,0x15,0x50,0x21,0x16,0x90,0x30,0xff,0x06,0x8e,0xb0,0x70,0x00,0xa0,0x03,0x84,
+	0xff,0x20,0x9e,0x00,0x19,0x22,0x01,0x00,0xac,0xff,0x22,0xad,0x0b,0xc8,0x41,0xe5,
+	0xc2,0x02,0xff,0x1b,0xc6,0x60,0xc6,0xb3,0xc0,0xc1,0x21,0xff,0x0e,0x06,0xcd,0xc0,
+	0x20,0x00,0x60,0x22,0xef,0x2b,0xc6,0xd0,0xcd,0x0f,0x04,0xca,0xe4,0x9e,0xff,0x41,
+	0x0e,0xde,0xe1,0x03,0x80,0x22,0xe7,0xff,0xa3,0x40,0x22,0xa8,0x4f,0x1d,0xf0,0x22,
+	0xff,0xa8,0x30,0x1d,0xf0,0xb8,0x17,0xd0,0xa9,0xff,0x11,0x90,0xd1,0x21,0x00,0x0d,
+	0x40,0x4e,0xff,0xf2,0xe9,0x9e,0xe1,0x03,0xa4,0x22,0xb0,0xff,0x99,0xb0,0xa6,0x1f,
+	0x19,0x26,0x1f,0x02,0xff,0x76,0xaf,0x13,0x94,0x40,0x42,0x24,0x40,0xff,0xc2,0x94,
+	0x31,0x42,0x24,0x31,0xc2,0xae,0xff,0x99,0x22,0x42,0x00,0x01,0xac,0x22,0x0c,0xff,
+	0x02,0x1d,0xf0,0xe6,0x29,0xc5,0x81,0xb8,0xff,0xee,0xbd,0x02,0x88,0x08,0xe8,0x17,
+	0xd8,0xff,0x51,0x88,0x38,0xe0,0xcc,0xb0,0xae,0xe0,0xbf,0x0c,0x9e,0x01,0x02,0xa0,
+	0x22,0xca,0x00,0x56,0xdf,0xaa,0xfd,0x22,0xa8,0x44,0xa5,0x05,0x01,0x08,0xfe,0x33,
+	0x0a,0x8c,0xd2,0x8c,0xb3,0x8c,0x95,0xa1,0xff,0xa3,0xc7,0x47,0xaa,0x09,0x22,0xa8,
+	0x37,0xfe,0x7b,0x10,0xee,0x07,0x08,0x1f,0xe7,0x0f,0x59,0xbf,0x1b,0xcd,0x04,0x0e,
+	0x0c,0x0b,0x29,0x01,0x41,0xe7,0x1b,0x4e,0xba,0x31,0x01,0xe3,0x01,0x71,0x9b,0xff,
+	0xff,0xb9,0x41,0x91,0xa0,0xee,0xc7,0x28,0x25,0xdf,0xe0,0xe4,0x11,0x8d,0x09,0x5a,
+	0x01,0x07,0xd1,0x7f,0xe7,0xec,0x88,0x28,0xbe,0xbc,0x4a,0x5a,0x09,0xf3,0xee,0xdd,
+	0x28,0x0c,0x5a,0x05,0x41,0x16,0x9a,0x0b,0xef,0x81,0x95,0xee,0xcd,0x8c,0x00,0x98,
+	0x07,0xe0,0xff,0x24,0x11,0x88,0x38,0xdd,0x02,0x9e,0xbb,0xfc,0x27,0x0c,0x57,0x05,
+	0xba,0x09,0xa8,0x17,0xbe,0x47,0xe7,0x0c,0x01,0xa7,0x67,0x01,0x5b,0x01,0x25,0xad,
+	0x02,0xff,0xbe,0x47,0x1a,0x00,0x07,0x08,0x81,0x1b,0xf7,0xae,0x71,0x1c,0x61,0x09,
+	0xa9,0x1c,0x59,0x0c,0xd6,0x61,0x05,0x76,0xaa,0x5b,0x51,0xae,0x3e,0x10,0xa5,0x98,
+	0xff,0x02,0xce,0xcb,0xfa,0xc0,0x20,0x01,0x1c,0xbf,0x22,0x60,0xa6,0xb3,0xa0,0xa1,
+	0x65,0x01,0xcb,0xee,0x65,0x0d,0xa6,0xb0,0xab,0x0f,0x04,0xaa,0xd4,0xd7,0xf3,0xac,
+	0x07,0x5d,0x09,0x58,0x02,0x81,0x6f,0xee,0xdd,0xfe,0x94,0x00,0xc8,0x07,0xbd,0x03,
+	0x88,0x38,0xc0,0xeb,0xca,0xa0,0x21,0x05,0x81,0x21,0x0d,0x6e,0x0a,0x02,0xe6,0xf0,
+	0x00,0x55,0x1b,0x09,0x05,0x28,0x05,0x36,0x41,0x00,0xff,0x21,0x90,0xef,0x41,0x37,
+	0xf0,0x31,0x5c,0xff,0xff,0x28,0x02,0x48,0x04,0x49,0x13,0x2e,0xf5,0x73,0x21,0x04,
+	0x81,0x21,0x00,0x36,0x61,0x00,0x26,0xfb,0x82,0x03,0x75,0x05,0x1c,0xca,0xe5,0x3c,
+	0xfd,0xff,0x40,0xb0,0x74,0x50,0xc0,0x74,0xdd,0x06,0xff,0xa9,0x01,0x79,0x5a,0x7a,
+	0x86,0x6e,0x7a,0xf7,0x39,0x1f,0xe7,0x26,0x00,0x80,0x89,0xc0,0x70,0xff,0x99,0xc0,
+	0x89,0x1a,0x99,0x2a,0x30,0xa0,0xff,0xf4,0x25,0x2b,0x01,0x28,0x01,0xa9,0x02,0xff,
+	0xa8,0x22,0x25,0x3a,0xfd,0xa9,0x42,0xad,0x3f,0x06,0xa5,0x39,0xfd,0xa9,0x62,0x92,
+	0x08,0x67,0x00,0xff,0xa8,0x02,0x25,0x3a,0x01,0xa8,0x42,0xe5,0xff,0x36,0xfd,0xa8,
+	0x62,0xa5,0x36,0xfd,0xad,0xef,0x02,0x25,0x36,0xfd,0x1b,0x14,0xbd,0x03,0xa8,0xff,
+	0x02,0xc8,0x12,0xd8,0x42,0xa5,0xd2,0x00,0xff,0xd8,0x42,0xb8,0x12,0xad,0x04,0xc8,
+	0x32,0xef,0xda,0xbb,0xa5,0x3c,0x1f,0x18,0x0c,0x09,0xa6,0xff,0x15,0x1d,0x26,0x15,
+	0x02,0x76,0xa5,0x17,0xff,0xb8,0x52,0xa8,0x62,0x88,0x04,0xaa,0xa9,0xdf,0xbe,0x88,
+	0x54,0x80,0x80,0x4b,0x03,0x8e,0x8a,0xf7,0x09,0x20,0x21,0x4b,0x01,0xed,0x05,0xfd,
+	0x03,0x7e,0x46,0x08,0x22,0xd8,0x62,0xa5,0xa1,0x00,0xdb,0x0c,0xdf,0x2e,0x62,0x3a,
+	0x02,0xc7,0xae,0x01,0x25,0x31,0xff,0xfd,0x2d,0x0a,0x6e,0xa3,0xd8,0x01,0x67,0xfe,
+	0x0c,0x00,0x67,0x08,0x0a,0x0e,0x09,0x06,0x40,0xf7,0x21,0x00,0x40,0x84,0x01,0x00,
+	0x6d,0x0a,0x39,0xff,0x12,0x49,0x22,0xad,0x06,0xe5,0x2e,0xfd,0xff,0xcd,0x05,0xbd,
+	0x04,0xa9,0x32,0x69,0x42,0xef,0xad,0x03,0x65,0x5f,0xc6,0x00,0x98,0x32,0x99,0xf3,
+	0x52,0x99,0xbe,0x00,0xbb,0x04,0x32,0x65,0x2b,0xfd,0xff,0xa8,0x02,0x65,0x63,0x01,
+	0xad,0x02,0xe5,0xfb,0x2a,0xfd,0x13,0x08,0xbd,0x03,0xc8,0x42,0x58,0xff,0x22,0xa8,
+	0x32,0xd8,0x62,0x50,0x54,0xc0,0xff,0xca,0xaa,0xd0,0xaa,0xc0,0x1e,0xaa,0xf5,0xfb,
+	0xa0,0x20,0xb5,0x01,0x57,0xba,0x07,0xa0,0xe5,0xff,0xc0,0x5d,0x0a,0xe0,0x44,0xc0,
+	0xc8,0x12,0xff,0xa8,0x02,0x40,0xcc,0x82,0xa5,0xcc,0x01,0xbe,0x26,0x00,0xe3,0x41,
+	0xea,0xdd,0xd9,0x0f,0x19,0xb8,0xff,0x52,0x98,0x62,0xad,0x03,0xb0,0x99,0xc0,0xff,
+	0xd0,0x99,0x11,0x40,0x99,0x63,0x9e,0xc3,0xde,0x9d,0x0c,0x9e,0x18,0x74,0x80,0xcf,
+	0x04,0x46,0x00,0xff,0x00,0x4d,0x0c,0xcd,0x04,0x65,0x2c,0xfd,0xff,0xa8,0x52,0x4a,
+	0xaa,0xa9,0x52,0x1d,0xf0,0xef,0x10,0x5d,0x00,0x20,0xd3,0x04,0xa2,0x3b,0x00,0xdd,
+	0x27,0x28,0x00,0xde,0xfc,0xfc,0x30,0x00,0x1d,0x1b,0x1f,0xa5,0xf1,0xff,0x2d,0x0a,
+	0x54,0x04,0x1b,0x00,0x54,0x01,0xfb,0xf5,0xff,0x0b,0x10,0x38,0x32,0x39,0x52,0x3e,
+	0xf3,0x72,0x62,0xcc,0x11,0x73,0x0c,0xcd,0x04,0xbd,0x03,0xa6,0x23,0x00,0xf4,0xff,
+	0xd5,0x05,0x0f,0x1c,0xf7,0x0f,0x08,0x14,0xaa,0x5f,0x3c,0x87,0x5f,0x04,0xeb,0x5f,
+	0x28,0xef,0x5f,0x80,0xee,0xaa,0x5f,0x30,0xf1,0x0f,0x08,0x18,0x5f,0x18,0x01,0x5f,
+	0x28,0xe5,0xaa,0x5f,0x28,0xe9,0x5f,0x80,0xe8,0x5f,0x30,0xeb,0x0f,0x08,0x20,0xaa,
+	0xbf,0x1c,0x67,0x5f,0x10,0xe7,0x5f,0x04,0xdf,0x5f,0x28,0xe3,0xea,0x5f,0x80,0xe2,
+	0x5f,0x30,0xe5,0x0f,0x14,0x9c,0x64,0x9c,0xff,0x45,0x4a,0x63,0x5a,0x83,0x82,0x08,
+	0x00,0xff,0x62,0x06,0x00,0x8a,0x66,0x60,0x60,0xf4,0x8f,0x6a,0x22,0x22,0x02,0x6d,
+	0x02,0x20,0x04,0x43,0x0c,0x9c,0xf7,0xc4,0x9c,0xa5,0x23,0x1c,0x80,0x66,0xc0,0x62,
+	0xf7,0xd6,0x01,0x0b,0x29,0x34,0x36,0x81,0x00,0x39,0xff,0x11,0x29,0x01,0x49,0x21,
+	0x22,0x21,0x10,0xff,0x59,0x31,0xad,0x07,0x2e,0xc2,0x3b,0x00,0xfd,0x07,0xb4,0x00,
+	0xf0,0x20,0x00,0x25,0x0b,0xfd,0xf7,0x5e,0x32,0x04,0xa5,0x0b,0x6e,0x32,0x42,0x01,
+	0xff,0x07,0x00,0xad,0x1b,0xe8,0x06,0xa8,0x01,0xff,0xb8,0x11,0xc8,0x21,0xd8,0x31,
+	0x25,0xcd,0xff,0x00,0xa2,0x47,0x00,0x20,0x20,0x74,0xae,0xf7,0x24,0x26,0xc0,0xfe,
+	0x06,0x3e,0x06,0x17,0xe0,0xbf,0x20,0x00,0x9c,0x22,0x06,0x01,0x7d,0x00,0x00,0xfb,
+	0x0c,0x12,0x5b,0x0c,0xc8,0x22,0x39,0x01,0xa2,0x5f,0x22,0x12,0xce,0x4c,0x1b,0x47,
+	0x00,0x61,0x55,0x04,0xff,0xa5,0x05,0xfd,0xf2,0x22,0x12,0x0c,0x1e,0xbf,0xe2,0x4f,
+	0x00,0xce,0x42,0x2d,0xf4,0x08,0xd2,0xff,0x62,0x13,0xa2,0x22,0x1c,0xbe,0x42,0x2c,
+	0xdf,0x80,0x21,0x01,0x80,0x22,0x23,0x0c,0xb8,0x01,0xff,0x98,0x22,0x82,0x22,0x13,
+	0x89,0x21,0x82,0xef,0x62,0x1d,0xad,0x08,0x9c,0x02,0x97,0x38,0x02,0xbf,0x86,0x45,
+	0x00,0x3e,0x01,0x0c,0x32,0x00,0xa1,0xef,0x1b,0xce,0x71,0x16,0x90,0x00,0x81,0x1b,
+	0x88,0xff,0x21,0x48,0xe2,0x69,0x51,0xd8,0x11,0x8a,0x7f,0x44,0x42,0x04,0x00,0xce,
+	0x3d,0x05,0x14,0x00,0xff,0x55,0x1b,0x7d,0x08,0x6e,0x48,0xf8,0xa0,0xff,0x21,0x01,
+	0x7c,0x22,0x80,0x77,0xc0,0xa8,0xff,0x42,0xd8,0xe2,0xc2,0x22,0x12,0xb8,0x52,0xff,
+	0x6a,0xdd,0x5a,0xcc,0xc2,0x0c,0x00,0xd2,0xff,0x0d,0x00,0xe5,0xeb,0xff,0xa0,0x44,
+	0x30,0xff,0x4e,0x40,0xe6,0xde,0xe0,0x02,0x48,0x22,0xdf,0x7e,0x06,0xb5,0xa0,0x20,
+	0x6d,0x00,0x68,0x51,0xff,0x16,0xe4,0x09,0x52,0x22,0x1d,0x98,0x11,0xff,0x88,0x21,
+	0xad,0x05,0xf0,0x99,0x11,0x97,0xff,0x38,0x41,0x8e,0xa5,0x0a,0x7e,0xe0,0x02,0xff,
+	0x58,0x22,0x3a,0x75,0xa9,0x31,0xa8,0x42,0x7f,0xc2,0x22,0x1c,0xb8,0x52,0xdd,0x04,
+	0x46,0x08,0xff,0xa5,0xe7,0xff,0xdd,0x06,0xcd,0x0a,0xb8,0xff,0x52,0xa8,0x42,0x65,
+	0xe9,0xff,0xe2,0x22,0xff,0x1c,0xd8,0x31,0x7a,0xee,0xae,0x8e,0x07,0xff,0xfe,0xe0,
+	0x02,0x80,0x22,0xde,0x07,0x15,0xff,0xbe,0xe0,0x03,0x98,0x22,0x46,0x1b,0x00,0xff,
+	0x96,0xf5,0x03,0xdd,0x04,0xa8,0x42,0xb8,0xfd,0x52,0x3c,0x00,0x72,0x22,0x12,0x3a,
+	0x85,0x89,0xf7,0x41,0x8a,0x77,0x41,0x08,0x72,0x07,0x00,0x65,0xff,0xe3,0xff,0xb8,
+	0x52,0xcd,0x0a,0xdd,0x06,0xff,0xa8,0x42,0xe5,0xe4,0xff,0xf8,0x41,0xe2,0xff,0x22,
+	0x12,0xa0,0xd7,0x30,0xfa,0xee,0xde,0xf7,0x8e,0x05,0xbe,0x47,0x04,0x66,0x05,0xc2,
+	0xa2,0xfb,0x22,0x1d,0x06,0x01,0x3a,0x9a,0x90,0x88,0x73,0xff,0x82,0x62,0x13,0x1b,
+	0x33,0xa8,0x21,0xc8,0xff,0x01,0xb8,0x22,0x1b,0xaa,0xa9,0x21,0xc0,0xff,0xbb,0xc0,
+	0xb7,0xba,0x02,0xc6,0xbe,0xff,0xf7,0xa2,0x22,0x13,0x57,0x06,0x0b,0xd3,0xd9,0x31,
+	0xbf,0xe8,0x31,0x4e,0x64,0x39,0x01,0xbf,0x05,0x90,0xff,0xf3,0x53,0xad,0x0e,0x96,
+	0xbe,0x01,0xa6,0xff,0x1f,0x18,0x26,0x1f,0x02,0x76,0xaf,0x12,0xbf,0xb2,0x22,0x1c,
+	0xae,0xbb,0x28,0xdb,0x01,0xad,0xbf,0x1b,0x8e,0x8b,0x0a,0x5e,0xe1,0x5e,0x00,0x8e,
+	0xe3,0x41,0x2a,0x7f,0x09,0xbd,0x00,0x92,0x01,0xea,0xea,0xfa,0xff,0xfa,0xc2,0x0f,
+	0x00,0xe2,0x0e,0x00,0xc0,0xfb,0xee,0x30,0x9d,0x01,0xd2,0x22,0x1c,0xda,0xda,0xff,
+	0xc2,0x4d,0x00,0xb2,0x22,0x1d,0x3e,0xbb,0xff,0x2a,0x40,0x21,0x01,0xac,0x22,0xa7,
+	0xbb,0xff,0xd3,0x38,0x11,0x92,0x22,0x13,0xb2,0x62,0xff,0x13,0x30,0x88,0xc0,0x9e,
+	0x72,0xd3,0x00,0xbe,0xb0,0x05,0x39,0x11,0x6e,0xf7,0xf3,0x74,0x00,0x45,0xfd,0x1b,
+	0x77,0x06,0x81,0x00,0x29,0x01,0x59,0x31,0xff,0x69,0x41,0x7a,0xa4,0xcd,0x06,0x39,
+	0x11,0xfb,0x4e,0x34,0x4e,0x0e,0x65,0xe6,0xfc,0x5e,0x41,0xed,0x02,0x0a,0x00,0x81,
+	0x1b,0x41,0x0a,0x31,0xd8,0x41,0xff,0x50,0xe2,0xa0,0xe8,0x0e,0xa5,0xad,0x00,0xff,
+	0xcc,0x8a,0x3a,0xf7,0x2e,0x8f,0x03,0x60,0xff,0x20,0x00,0x80,0x22,0x1b,0x22,0x20,
+	0x20,0x7f,0xf4,0x66,0xf2,0xdb,0x6e,0x94,0x28,0x50,0x00,0xdf,0xad,0x1b,0x9e,0x93,
+	0x52,0x3e,0x08,0x90,0x28,0xf5,0x83,0x4f,0x06,0xa1,0x37,0x03,0xbd,0x03,0xdd,0x05,
+	0xff,0xfd,0x07,0xe2,0x21,0x14,0xc2,0x21,0x15,0xff,0xc9,0x11,0xe9,0x01,0xcd,0x04,
+	0xed,0x06,0xf7,0x65,0x87,0x00,0x4b,0x0b,0x81,0x00,0xa2,0x22,0xff,0x1e,0xd8,0x22,
+	0xc2,0x22,0x1f,0xee,0x42,0xbd,0xeb,0xda,0x08,0xee,0x71,0x4d,0xbe,0xea,0x04,0xde,
+	0xef,0x71,0x5c,0x80,0x21,0x60,0x00,0xe5,0xdd,0xfc,0xff,0xa2,0x22,0x1f,0x82,0x22,
+	0x1e,0x89,0x01,0xfb,0xa9,0x11,0x96,0x05,0xce,0x42,0x2f,0x24,0x00,0xfe,0xc4,0x00,
+	0xe8,0x0f,0xd2,0x22,0x13,0xf8,0x1f,0x9f,0xe5,0xf9,0xff,0xa8,0x42,0x09,0x00,0xaf,
+	0x05,0x12,0xf7,0xee,0x42,0x0f,0x3c,0x00,0x84,0x22,0xf2,0x62,0xf7,0x21,0xa5,0x93,
+	0x5a,0x00,0x13,0x0c,0x03,0x0e,0xef,0x9a,0x06,0x1f,0xe7,0x62,0x02,0x42,0x22,0x18,
+	0xfd,0x3a,0x72,0x06,0x16,0x84,0x07,0xc8,0x52,0xa2,0xef,0x02,0x0c,0xca,0xc4,0xd1,
+	0x01,0xae,0x4a,0xfb,0xff,0x1f,0xe7,0x01,0x7d,0x1b,0xc0,0xaa,0x82,0xf7,0xa5,0x00,
+	0xfa,0x42,0x04,0x1e,0xd2,0x22,0x1f,0xff,0x8d,0x0a,0xe2,0x22,0x1b,0xa8,0x42,0x6a,
+	0xbf,0xf8,0x80,0x8f,0xa3,0xe0,0xe4,0xf3,0x00,0x8a,0xdd,0x4a,0x38,0x00,0x25,0x99,
+	0x00,0x20,0x04,0x20,0xe2,0xff,0x22,0x18,0xf2,0x22,0x1b,0x5d,0x0a,0x3a,0xfd,0xee,
+	0x78,0x01,0xd2,0x22,0x21,0xa8,0x42,0xf0,0x7d,0xee,0x23,0x00,0x65,0x97,0x00,0xcd,
+	0x05,0x6c,0x02,0xbd,0x0a,0x5e,0x02,0xc3,0xff,0xcd,0x04,0x0a,0x10,0xc0,0xff,0xff,
+	0xf2,0x22,0x19,0x3a,0xff,0xa2,0x4f,0xfe,0x8d,0x04,0x1b,0x33,0xa7,0xb3,0x02,0xc6,
+	0xdc,0xfd,0xff,0xef,0x0f,0xc1,0x00,0x59,0x11,0x69,0x01,0xff,0x79,0x21,0x29,0x81,
+	0x39,0x91,0x16,0x07,0xef,0x06,0x4e,0x74,0x3d,0x39,0x09,0xde,0x71,0x36,0xfe,0xb0,
+	0x00,0x81,0x1b,0xe8,0x31,0xd8,0x11,0xea,0xfd,0xdd,0xfc,0x02,0xbc,0x9d,0xa8,0x81,
+	0xbe,0x41,0xfd,0x9c,0x3d,0x0b,0xa5,0xbd,0xff,0xae,0x4a,0x35,0xfe,0x27,0x08,0x50,
+	0xa0,0x74,0xaa,0xa3,0xa2,0x0a,0xff,0x00,0xb2,0xa0,0xff,0xa0,0xa7,0xd1,0xa5,0xff,
+	0xf4,0xf9,0x6a,0xca,0xa0,0xac,0xa3,0x2a,0xff,0xba,0xb2,0x0b,0x00,0x47,0x1b,0x17,
+	0x1b,0xff,0x55,0x50,0x50,0xf4,0x66,0xf5,0xd9,0x98,0xff,0x31,0x88,0x21,0x1b,0x99,
+	0x99,0x31,0x97,0xfb,0x98,0xae,0x75,0x08,0xc8,0x31,0xb8,0x01,0x3a,0xfd,0xa5,0x36,
+	0x00,0xca,0xbb,0xa2,0x4b,0x00,0x86,0xfb,0xf7,0xff,0xa3,0x05,0x29,0x41,0x39,0x51,
+	0x9d,0xef,0x04,0xce,0x47,0x04,0x81,0x01,0x55,0x1b,0x99,0xd7,0x01,0x4a,0xc5,0x1b,
+	0x01,0x2a,0xf2,0x06,0xa8,0x01,0xf9,0x3a,0x06,0x04,0x63,0x00,0xc0,0xaa,0xd1,0x65,
+	0xee,0xff,0xf9,0xb8,0x51,0xc2,0xda,0x01,0xae,0xda,0xff,0x3c,0x9e,0xe1,0x03,0xa4,
+	0x22,0xa0,0xdc,0xff,0xa3,0xa8,0x41,0x2a,0xdd,0xde,0x5d,0x0c,0xfe,0x9b,0x08,0xe5,
+	0xb3,0xff,0x4a,0xd6,0xae,0x8d,0xbb,0x04,0x80,0x17,0x06,0x47,0x97,0xb9,0xff,0x0d,
+	0xdd,0x7f,0x05,0xbd,0x03,0xfd,0x07,0xad,0x02,0xf5,0x05,0xff,0x42,0x21,0x14,0x49,
+	0x01,0xe5,0x92,0x00,0xf3,0x3d,0x0b,0xfe,0x06,0x03,0x05,0x41,0x00,0xae,0x42,0xfd,
+	0x2b,0x3d,0x08,0xb2,0x42,0x98,0xf0,0x20,0x00,0xff,0xe5,0xb5,0xfc,0x88,0x22,0xa9,
+	0xe2,0x3e,0xdb,0xa8,0xfb,0x14,0x00,0xad,0x1b,0x11,0x04,0xb4,0xfc,0xbf,0x98,0x02,
+	0xae,0x72,0xfa,0x3e,0x14,0x06,0xe5,0xff,0x61,0x00,0xa2,0x62,0x10,0xb2,0x62,0x11,
+	0xd7,0xa8,0x22,0x65,0x0a,0x04,0x12,0xd7,0x02,0xa8,0x22,0xfb,0xa5,0x60,0x0a,0x00,
+	0x14,0xb2,0x62,0x15,0xa8,0xf7,0x22,0xe5,0x5f,0x0a,0x00,0x16,0xa8,0x22,0xb2,0xef,
+	0x62,0x17,0x3e,0xaa,0x43,0x0c,0xa5,0xb0,0xfc,0x57,0xa2,0x62,0x18,0x30,0x00,0xb4,
+	0x07,0x00,0x19,0x22,0x00,0xfd,0xb3,0x07,0x00,0x1a,0xa8,0x22,0x25,0x5d,0x00,0xfb,
+	0xcd,0x0a,0x29,0x04,0x1d,0xce,0x72,0xca,0x5e,0xbf,0xe1,0x03,0x80,0x22,0x25,0x5c,
+	0x11,0x10,0x1f,0xb7,0xce,0x72,0xea,0x11,0x08,0xe5,0x5a,0x4e,0x00,0x20,0xfe,0x12,
+	0x04,0x21,0xe0,0xaa,0x11,0x65,0xb0,0xfc,0xdf,0xb8,0x22,0xae,0x72,0x94,0xa7,0x0a,
+	0x7e,0x3b,0xfd,0x03,0x2d,0x09,0xa8,0x02,0xe5,0xae,0xfc,0xf8,0xff,0x92,0xd8,0x02,
+	0x4a,0xff,0xa9,0x0f,0xa8,0xff,0x42,0xe8,0x92,0xc8,0x82,0xb8,0x52,0x4a,0xdd,0xee,
+	0x36,0x09,0xee,0x4e,0x0d,0xcb,0x0a,0xa5,0x7f,0xff,0x00,0x88,0x22,0x1b,0x33,0x8e,
+	0xe3,0x14,0xff,0x80,0x80,0x01,0x78,0x22,0xa2,0xa4,0x00,0xbf,0xa5,0xab,0xfc,0xae,
+	0x72,0xb3,0x5d,0x0f,0x22,0xf7,0xe5,0xaa,0xfc,0x51,0x02,0x30,0xc0,0x74,0xd8,0xbf,
+	0x22,0xf0,0xf3,0xa0,0xa9,0x0f,0x7d,0x0a,0xb8,0xef,0x52,0xe0,0xe3,0xa0,0x40,0x14,
+	0x65,0x7b,0x00,0xff,0x1b,0x33,0x30,0x30,0xf4,0x66,0xf3,0xd0,0x52,0xee,0x00,0x51,
+	0x94,0x00,0x92,0x00,0x23,0x39,0x00,0x50,0x0a,0x00,0xef,0x24,0xb2,0x62,0x25,0x6b,
+	0x05,0x61,0x00,0xa8,0xff,0x02,0x62,0x22,0x02,0x47,0xba,0x02,0x06,0xff,0x36,0x00,
+	0x82,0x02,0x98,0x40,0x7a,0xc0,0xff,0x60,0x64,0xc0,0xcc,0x48,0x20,0xa2,0x20,0xff,
+	0x65,0xe9,0xff,0x4a,0xa3,0xae,0x4a,0x09,0xfe,0xb1,0x00,0x71,0x1b,0x76,0x94,0x15,
+	0xc2,0x22,0x7f,0x10,0xb2,0x0a,0x7f,0x9e,0xcc,0x2a,0xe5,0x00,0xbf,0xac,0x22,0xbe,
+	0x8c,0x09,0x20,0x6a,0x07,0x4e,0xfb,0x94,0x3a,0x59,0x0a,0x76,0x97,0x0c,0xd2,0x22,
+	0xdf,0x10,0x9a,0xdd,0xae,0x8d,0x17,0x0c,0xf8,0xe2,0xdf,0xe8,0x92,0xd2,0x22,0x11,
+	0x34,0x00,0xb8,0x52,0xff,0xa8,0x42,0x82,0x22,0x02,0x82,0x61,0x00,0xff,0xa5,0x97,
+	0xff,0xac,0x3a,0x16,0xd6,0x01,0xff,0x26,0x16,0x02,0x76,0x96,0x17,0x92,0x22,0xff,
+	0x10,0x4a,0x99,0x92,0xd9,0xff,0x9e,0x59,0xff,0xf4,0x9e,0xe0,0x03,0x9c,0x22,0x9e,
+	0x85,0xfb,0x05,0xa0,0x05,0x06,0x2d,0x06,0x1d,0xf0,0x2e,0xfb,0xa2,0x3b,0x55,0x08,
+	0x25,0x9a,0xff,0xae,0x72,0xdc,0x60,0x04,0xeb,0x01,0x22,0x12,0xd8,0x4a,0x03,0x14,
+	0xaa,0xdd,0xbb,0xac,0x02,0xaa,0xcc,0xda,0x06,0x04,0xb2,0x4c,0xfb,0x00,0xe2,0x21,
+	0x03,0xaa,0xa7,0xbe,0xe0,0xe2,0xff,0x62,0x15,0xf2,0x22,0x18,0xd2,0x22,0x14,0x7e,
+	0x6e,0x04,0xc2,0x22,0x1b,0xce,0x71,0x0c,0x72,0x09,0xff,0x65,0xb5,0xff,0xcc,0x2a,
+	0x7c,0xf2,0x1d,0xff,0xf0,0xf2,0x22,0x13,0xe2,0x22,0x1a,0xd2,0xff,0x22,0x18,0xc2,
+	0x02,0x0d,0xb8,0x52,0xae,0xfb,0x42,0x48,0x1e,0x08,0x89,0x01,0xe5,0xca,0xff,0xff,
+	0xad,0x02,0xa5,0xba,0xff,0x92,0x22,0x13,0xf7,0xae,0x29,0x0a,0x9e,0x09,0xd2,0x22,
+	0x1a,0xf2,0xbf,0x22,0x10,0xe2,0x22,0x19,0xaa,0x4a,0x07,0xaa,0xfe,0xb3,0x07,0xfa,
+	0xdd,0xc2,0x0d,0x00,0xe0,0xcc,0xdf,0x30,0xc2,0x4d,0x00,0xb2,0x71,0x04,0xb7,0x3a,
+	0xf5,0xd9,0xc8,0x18,0xe2,0xc8,0x00,0xee,0xe2,0xde,0xff,0xeb,0xee,0x5e,0xc8,0x0c,
+	0xee,0xc8,0x10,0xc6,0xcc,0xff,0xff,0x36,0xe1,0x00,0x32,0x61,0x10,0xcc,0xd6,0xff,
+	0xad,0x02,0xbd,0x03,0xcd,0x04,0xdd,0x07,0xf7,0xe5,0xe8,0xff,0xc5,0x06,0xa8,0x02,
+	0xc8,0x22,0xfe,0x72,0x01,0xc6,0x70,0x00,0x67,0xbc,0x02,0x46,0xdf,0x6f,0x00,0xc0,
+	0x34,0xc0,0x7b,0x05,0xca,0xc0,0xff,0xc2,0x61,0x11,0xcc,0x68,0xad,0x02,0xe5,0xff,
+	0xd1,0xff,0xc2,0x21,0x11,0xa2,0x21,0x10,0xab,0x4a,0xaa,0x80,0x21,0xd2,0x80,0x0d,
+	0xdd,0x80,0x11,0x8d,0xbe,0x80,0x2d,0x3d,0xf0,0x76,0x9c,0x0c,0x8a,0x00,0x9a,0xb7,
+	0xee,0xae,0x8e,0x19,0x0c,0x0c,0x09,0x13,0x00,0x96,0xff,0x21,0xa2,0x05,0x00,0xf8,
+	0x02,0x82,0x22,0xff,0x1a,0xca,0xaa,0xae,0xff,0x55,0xa0,0x20,0x7f,0x01,0xa4,0x22,
+	0x9e,0x88,0x2f,0xfe,0x42,0x04,0xc3,0xfe,0x88,0x28,0x0c,0x38,0x06,0x15,0x01,0xf6,
+	0x00,0xe2,0x22,0xff,0x18,0xfd,0x06,0x25,0xc2,0xff,0xf2,0x22,0xf2,0xd5,0x00,0x16,
+	0x2c,0x01,0x18,0x00,0xd2,0x01,0xae,0x42,0xf7,0x4c,0x82,0x01,0x51,0x02,0xc9,0x01,
+	0xcd,0x06,0x17,0x25,0xc6,0xff,0xda,0x1d,0x88,0x33,0x07,0x3b,0x03,0xe2,0x09,0xfa,
+	0xdf,0x01,0x79,0xdf,0x05,0xd3,0x01,0x26,0x13,0x02,0xbb,0x76,0x93,0xdf,0x3d,0x87,
+	0x07,0xe0,0xdf,0x09,0x03,0xff,0x1d,0xf0,0x88,0x22,0x98,0xf2,0xa8,0xe2,0xff,0xb2,
+	0x22,0x17,0xc2,0x22,0x16,0xc9,0x41,0xff,0xb9,0x51,0xa9,0x61,0x9e,0x71,0x88,0x1e,
+	0xfe,0xb5,0x06,0x89,0x91,0x8e,0x71,0x7f,0x28,0x00,0xfe,0x27,0x00,0xe8,0x1f,0xf8,
+	0x0f,0xf9,0x01,0xe9,0x7f,0x11,0xa8,0x42,0xbe,0x42,0x5d,0x24,0x11,0x04,0xef,0xce,
+	0x4d,0x0f,0x26,0x19,0x08,0x0f,0xd8,0x1d,0xfb,0xf8,0x1f,0xe7,0x03,0x65,0x26,0x00,
+	0xa8,0x22,0xfe,0x07,0x00,0x25,0x7a,0xfc,0x5d,0x0a,0xb8,0xe2,0xfd,0xc8,0x0b,0x04,
+	0x65,0x80,0xfc,0xd8,0x22,0xad,0xff,0x06,0xd7,0xb6,0x1b,0x0c,0x0b,0x88,0xe2,0xff,
+	0xf8,0xf2,0xba,0x88,0xaa,0xff,0xf2,0x0f,0xff,0x00,0xf2,0x48,0x00,0xe8,0x22,0x1b,
+	0xaa,0xff,0xee,0xea,0xab,0x60,0x21,0x00,0x7c,0x22,0xee,0x90,0x01,0x06,0x65,0x74,
+	0x5c,0x1a,0x92,0x22,0x12,0xf7,0xc8,0x52,0xb2,0x5c,0x02,0x99,0x92,0x09,0x00,0x37,
+	0xaa,0xbb,0xca,0x06,0x04,0x92,0x4b,0x5c,0x5a,0x08,0x05,0xff,0xe5,0x8f,0xff,0xcc,
+	0xaa,0xad,0x05,0xe5,0xfb,0x70,0xfc,0x5d,0x06,0x00,0x00,0x00,0xa2,0x22,0xf7,0x13,
+	0x6a,0xaa,0x80,0x00,0xe5,0x1a,0x00,0xa9,0xff,0xa1,0xb9,0xd1,0xb9,0xb1,0xae,0x71,
+	0xcd,0xfd,0x2a,0xae,0x04,0xb8,0x0d,0xd8,0x1d,0xb9,0x01,0x23,0xd9,0x11,0x66,0x09,
+	0x55,0x05,0x5b,0x01,0x12,0x8e,0x02,0xb8,0x04,0xfb,0x1a,0x00,0x7a,0x11,0x18,0xe8,
+	0xc1,0x98,0xd1,0xf7,0x82,0x22,0x12,0x45,0x00,0xa9,0xf1,0x89,0xe1,0xff,0xa8,0x42,
+	0x92,0x62,0x13,0xe2,0x62,0x12,0xfb,0xfd,0x09,0xb4,0x02,0x69,0x01,0x65,0xa0,0xff,
+	0xef,0xa8,0xe2,0xbd,0x05,0xe0,0x08,0x25,0x72,0xfc,0xf6,0xb0,0x02,0x8f,0xff,0x87,
+	0x02,0xac,0x6b,0x0c,0x0a,0x1e,0x1f,0x00,0x82,0x22,0x10,0xf2,0xac,0x02,0xa7,0x06,
+	0xeb,0x08,0xff,0x8a,0xee,0xd2,0x0e,0x00,0xf0,0xdd,0x30,0xef,0xd2,0x4e,0x00,0xc2,
+	0xc1,0x04,0xc7,0x3a,0xd9,0xff,0xf8,0xf1,0x88,0xe1,0x82,0x62,0x12,0xf2,0xfb,0x62,
+	0x13,0x9f,0x79,0xb2,0xc1,0x28,0xa8,0x0b,0xdf,0xb8,0x1b,0xe5,0x0f,0x00,0xdd,0x00,
+	0x62,0xfc,0xff,0x46,0x93,0xff,0x00,0x00,0x36,0x61,0x00,0xdf,0xa8,0x12,0x47,0xba,
+	0x03,0xea,0x04,0x40,0x6a,0xff,0xc0,0x9d,0x06,0x76,0x94,0x19,0xb8,0xb2,0xff,0xa8,
+	0xa2,0x82,0x03,0x00,0x90,0xbb,0xc0,0xff,0xbe,0xaa,0x23,0x60,0x20,0x01,0xac,0x22,
+	0xf3,0x8e,0x8a,0x4f,0x0e,0x19,0x04,0xcd,0x06,0x60,0xbb,0xeb,0xc0,0xba,0xbe,0x02,
+	0x1b,0xbe,0x02,0x61,0x1b,0xa5,0xdf,0x64,0xfc,0xd8,0x12,0xc8,0x17,0x00,0xd0,0xcc,
+	0xe7,0xc0,0xce,0x4c,0x13,0x0c,0xcb,0x04,0x63,0xfc,0xe8,0x7f,0xc2,0x88,0xd2,0x89,
+	0x11,0xe9,0x01,0x1d,0x05,0xff,0xc8,0xa2,0xd8,0xb2,0xe8,0x62,0xf8,0x72,0xfe,0x19,
+	0x04,0x11,0x00,0xcd,0x06,0x9d,0x05,0x76,0xeb,0x94,0x18,0x4d,0x04,0xc0,0x4b,0x08,
+	0x5a,0x0c,0x80,0xf6,0x5e,0x04,0xae,0x89,0x66,0x0c,0xc8,0x22,0x5a,0xb4,0xfb,0x0e,
+	0x2c,0xb2,0x0f,0xd8,0xc2,0xa0,0xcc,0xc0,0xff,0xca,0xcd,0xc2,0xdc,0xff,0xc2,0x0c,
+	0xff,0xef,0xc2,0x4b,0x00,0xc8,0xeb,0x01,0xce,0xea,0x8b,0xf6,0xeb,0x09,0x28,0x02,
+	0x9f,0x09,0x36,0x41,0x00,0x5a,0xff,0x34,0x30,0x20,0x74,0x30,0x30,0xf4,0xb6,0xff,
+	0xf3,0x06,0x1b,0x22,0x20,0x20,0x74,0x1d,0x79,0xf0,0x19,0x00,0x17,0x00,0x2e,0x32,
+	0x3a,0x40,0x18,0x07,0xe7,0xa5,0x55,0xfc,0x9e,0x07,0x2b,0x08,0xad,0x02,0x25,0xfb,
+	0x53,0xfc,0x0b,0x08,0x61,0x00,0xdd,0x04,0x59,0x7f,0x01,0x48,0xd1,0x58,0xc1,0xde,
+	0x71,0xb9,0x04,0xbf,0x81,0x1b,0x5e,0xa5,0x3c,0x80,0x2f,0x04,0x65,0xff,0x57,0xfc,
+	0xd8,0x01,0xa2,0x21,0x01,0xde,0xbb,0x4d,0x1c,0xd1,0x08,0xce,0xe4,0x79,0x07,0x00,
+	0x69,0xff,0x1b,0xc0,0xf4,0xc0,0xf0,0xf7,0x63,0xce,0xef,0xea,0x2f,0xe0,0x21,0x16,
+	0x01,0x76,0x9f,0x31,0xff,0xf2,0x0e,0x00,0x9a,0xb6,0xb2,0x0b,0x00,0xff,0xac,0xdf,
+	0xac,0xbb,0xba,0x83,0x82,0x08,0xf7,0x00,0xfa,0xb3,0x0d,0x00,0x8a,0xbb,0xb0,0xb0,
+	0xf7,0xf4,0xba,0xb2,0x09,0x00,0xca,0x89,0x8a,0x85,0xbf,0xf2,0x08,0x00,0xb0,0xff,
+	0x30,0x93,0x17,0x1b,0xff,0xcc,0xc7,0x9d,0xaf,0x1d,0xf0,0xee,0xf3,0xed,0xfb,0xa0,
+	0x02,0x45,0x1b,0xbf,0x0c,0x88,0x91,0xbd,0xff,0x04,0x57,0xb8,0x02,0x06,0x23,0x00,
+	0x48,0xef,0x81,0x4e,0xa4,0x3c,0xcc,0x0b,0x65,0x51,0xfc,0x7f,0x7a,0xd6,0xd2,0x0d,
+	0x00,0xda,0xd3,0x04,0x00,0xff,0x16,0x25,0x07,0x1b,0xe7,0x77,0x35,0x6d,0xfb,0x4a,
+	0x95,0xc0,0x02,0x16,0x09,0x06,0x9a,0xa3,0xff,0xa2,0x0a,0x00,0xd0,0xaa,0xc0,0xa2,
+	0xda,0xff,0x01,0x0b,0xaa,0xa0,0x90,0x74,0xa0,0xa0,0xef,0xf4,0x4e,0xfa,0xdf,0x60,
+	0x00,0xc0,0x22,0xf0,0xef,0xf0,0x74,0x06,0x01,0x56,0x00,0x00,0xfd,0x09,0xbf,0x70,
+	0xa5,0xc0,0x4e,0xaa,0x29,0x67,0x00,0xad,0xff,0x1b,0x16,0xce,0x02,0x26,0x1e,0x02,
+	0x76,0xdb,0x9e,0x26,0xae,0x08,0xce,0x1b,0x8c,0x04,0x54,0x22,0xfe,0xb2,0x08,0xc2,
+	0x0a,0x00,0xfa,0x88,0x80,0x80,0xf7,0xf4,0x8a,0x82,0x0c,0x00,0x80,0xcc,0x30,0xc2,
+	0xff,0x4a,0x00,0x1b,0xaa,0x0b,0x55,0x56,0xe5,0xf7,0xf8,0x1d,0xf0,0x9b,0x00,0x6e,
+	0xa6,0x32,0xe0,0xae,0x8f,0x04,0x2e,0xc2,0x3b,0x49,0x00,0xa5,0xdd,0x05,0x65,0xdf,
+	0x45,0xfc,0x9e,0x01,0x0c,0x11,0x01,0xa1,0x1b,0xff,0x16,0x42,0x02,0x26,0x12,0x04,
+	0x3d,0xf0,0xff,0x76,0x92,0x1c,0xa2,0x04,0x01,0x8d,0x0c,0xff,0x9e,0xb0,0x04,0x80,
+	0x20,0x00,0x48,0x22,0xdf,0xbe,0x8a,0x29,0x20,0x21,0x35,0x00,0x8e,0x86,0xf3,0x06,
+	0xc0,0x7c,0x06,0x8f,0x05,0xa1,0x00,0x39,0x51,0xdf,0x29,0x01,0x2e,0x92,0x37,0xdf,
+	0x08,0x9e,0x71,0xdd,0x45,0x73,0x09,0x9e,0x06,0x02,0x57,0x00,0x59,0x1b,0xff,0x22,
+	0x04,0x00,0x1d,0xf0,0xc2,0x03,0x01,0x7f,0x3a,0x66,0x62,0x06,0x00,0x5a,0x94,0xe7,
+	0x00,0xbf,0x88,0x01,0x9c,0x39,0x3a,0xa9,0xe8,0x00,0xca,0xed,0xaa,0xdf,0x00,0xaa,
+	0x88,0x9e,0x00,0x20,0x28,0x30,0xfe,0xde,0x01,0xdd,0x06,0xa8,0x41,0xb8,0x51,0x65,
+	0xdf,0xe0,0xff,0xae,0xca,0x35,0x4b,0x08,0x57,0x97,0xfd,0xcd,0xab,0x08,0x72,0x06,
+	0x00,0x8e,0x45,0x19,0xee,0xb2,0x09,0x9e,0x07,0x05,0x56,0x1c,0x16,0x88,0x02,0xff,
+	0x26,0x18,0x02,0x76,0x98,0x22,0x5a,0x84,0x9e,0x44,0x00,0x5a,0xb6,0x9c,0x68,0xa5,
+	0x05,0x43,0x05,0xba,0xfa,0x5a,0x08,0xa2,0x09,0x00,0x90,0x9a,0x30,0x90,0x90,0xdf,
+	0x74,0x1b,0x55,0x2d,0x09,0x3b,0x0e,0x32,0x06,0xff,0x00,0x8d,0x02,0x2e,0x00,0x09,
+	0xa0,0x20,0xdf,0x00,0xa0,0x22,0xde,0x03,0x4d,0x18,0xec,0xb2,0xfd,0x0c,0x77,0x02,
+	0x16,0x39,0x02,0x26,0x19,0x02,0xff,0x76,0x99,0x1d,0x5a,0x74,0x72,0x07,0x00,0xff,
+	0x5a,0x36,0x9c,0x17,0x32,0x03,0x00,0x7a,0x6d,0x33,0x83,0x02,0x3a,0x38,0x09,0x00,
+	0x20,0x23,0xa7,0x04,0xff,0x1b,0x55,0x1d,0xf0,0x2a,0x28,0x22,0x02,0xed,0x00,0xa7,
+	0x0e,0x81,0x00,0xde,0x00,0x9d,0x03,0xad,0xbf,0x02,0xa9,0x01,0x9e,0x71,0x17,0x57,
+	0x00,0x80,0xef,0x22,0x3e,0x24,0x25,0x9e,0x09,0x2e,0x52,0x03,0xfe,0x0c,0x09,0x5a,
+	0xa6,0xcc,0x44,0x32,0x4a,0x00,0xdf,0x46,0x03,0x00,0xdd,0x02,0x87,0x01,0xa8,0x01,
+	0xff,0xb8,0x11,0x25,0xd2,0xff,0xcd,0x0a,0x1b,0xef,0x55,0x57,0x97,0xe2,0x97,0x04,
+	0x01,0x01,0x7d,0xff,0x04,0x49,0xc1,0x32,0x61,0x11,0x69,0xd1,0xff,0x22,0x61,0x10,
+	0xfe,0x41,0x09,0x26,0x00,0xdb,0x00,0x84,0x4b,0x01,0x48,0x01,0x3e,0x04,0x89,0x51,
+	0xff,0xe8,0x0f,0xd8,0x2f,0xc8,0x3f,0xc9,0xb1,0x7f,0xd9,0xa1,0xee,0x71,0x82,0x28,
+	0x00,0xb4,0x07,0xff,0x02,0xf8,0x1f,0xf9,0x91,0x89,0x12,0x82,0xff,0x4b,0x01,0xa2,
+	0x05,0x00,0xa2,0x4b,0x00,0xff,0x82,0x49,0x01,0xb6,0x24,0x54,0x5e,0x64,0xdd,0x23,
+	0x79,0x08,0x5e,0x02,0x07,0xe1,0x08,0xa2,0x21,0xff,0x10,0xb2,0x21,0x11,0x42,0x07,
+	0x00,0x2e,0xfb,0xf3,0x58,0x53,0x00,0xac,0x22,0x4e,0x88,0x03,0xfd,0x60,0xa2,0x04,
+	0x30,0x30,0x04,0x20,0x43,0xb0,0xff,0x59,0x14,0xc8,0x04,0x59,0x11,0xce,0x71,0xdb,
+	0x0d,0x24,0x53,0x04,0xc8,0x0d,0x67,0x00,0x1d,0xf8,0xff,0x1f,0xe5,0xcb,0xff,0x1b,
+	0x77,0x6e,0x07,0xfd,0x25,0x41,0x00,0x98,0x22,0xc6,0x00,0x00,0x4d,0xff,0x02,0x79,
+	0xc1,0x78,0xc1,0x28,0xd1,0xb8,0xef,0x04,0x2e,0xa2,0x3c,0x35,0x0a,0xe5,0x24,0xfc,
+	0x9b,0x3d,0x07,0x9b,0x01,0xe1,0x00,0xae,0x00,0xb6,0x00,0xad,0x7f,0x04,0xa5,0xc6,
+	0xff,0xae,0x71,0xd3,0xae,0x08,0x7f,0x39,0x51,0x3e,0xb3,0x3a,0x00,0x27,0x54,0x02,
+	0xff,0x25,0x17,0xfc,0x6d,0x0a,0xae,0x71,0x47,0x7e,0x3b,0x02,0x80,0x22,0x7e,0xa7,
+	0x3b,0x01,0x69,0x06,0xdf,0xe5,0x15,0xfc,0xa9,0x81,0x0c,0x14,0x25,0x15,0xff,0xfc,
+	0x49,0xc1,0x79,0xe1,0xae,0x71,0xa9,0xae,0xd5,0x0c,0x09,0x39,0x19,0xce,0x00,0x32,
+	0xd4,0x00,0x4b,0xf7,0x00,0x32,0x46,0xd1,0x00,0x55,0x5e,0x24,0x27,0x3c,0x0c,0x02,
+	0xb8,0x00,0x00,0x05,0x00,0x27,0x9a,0x02,0xd1,0x0c,0xf7,0x8e,0x57,0x03,0x30,0x08,
+	0x30,0xf4,0xb0,0x8e,0xfd,0x86,0x9b,0x06,0x80,0x22,0x40,0x40,0x04,0x30,0xbf,0x34,
+	0xb0,0x59,0x13,0xc8,0x03,0xd1,0x3c,0xa5,0xd5,0xbe,0xd1,0x00,0x2e,0xd1,0x10,0x86,
+	0x47,0x03,0x3d,0x09,0xdf,0x79,0xe1,0x49,0xc1,0x48,0xd4,0x04,0x03,0xc8,0xff,0xe1,
+	0xad,0x02,0xe5,0x17,0xfc,0xad,0x06,0xff,0x25,0x0f,0xfc,0xa8,0x81,0xa5,0x0e,0xfc,
+	0x7f,0xa8,0xa1,0x65,0x0e,0xfc,0x3d,0x04,0xdf,0x00,0x7f,0x81,0x00,0x7d,0x03,0xbe,
+	0x9c,0x0a,0xd6,0x00,0xfd,0xa1,0x21,0x07,0x25,0x0a,0xfc,0xae,0x3a,0x3a,0xf7,0x00,
+	0x07,0x05,0x2f,0x0b,0xa5,0x0d,0xfc,0xae,0xf5,0x6a,0x0d,0x00,0x03,0xd3,0x00,0x0c,
+	0xfc,0xce,0x01,0xdd,0x0b,0x26,0x08,0xbe,0x86,0x09,0x00,0x0f,0x8a,0x08,0xdf,0x1f,
+	0xe7,0x02,0x81,0x1b,0x44,0x03,0xa8,0x20,0xff,0xf0,0xcc,0x11,0xc0,0xc0,0xf4,0xb6,
+	0xfc,0xff,0x02,0xc0,0xc2,0x30,0xba,0xd6,0xc2,0x4d,0xfd,0x00,0x0d,0x00,0xf6,0xfb,
+	0x04,0xca,0xea,0xb2,0xff,0x4e,0x00,0x1b,0xbb,0xb0,0xb0,0xf4,0x69,0xff,0x43,0x72,
+	0x43,0x0c,0x42,0x43,0x0d,0x59,0xbf,0x23,0xae,0x73,0x5c,0x1f,0xe7,0x3f,0x00,0xc9,
+	0xff,0x03,0xad,0x05,0x50,0xcc,0xc0,0xc9,0x13,0xff,0x25,0x07,0xfc,0xdd,0x0a,0xa9,
+	0x31,0x39,0xff,0x41,0xa9,0x83,0x62,0x03,0x0d,0x52,0x03,0xff,0x0c,0xc8,0x23,0x78,
+	0x43,0xe8,0x53,0xe9,0xff,0x11,0x79,0x01,0xc9,0x21,0xac,0xbc,0x4d,0xff,0x0a,0x60,
+	0x35,0x82,0xca,0x25,0x3e,0xa3,0xf7,0x3b,0x1f,0xe7,0x50,0x01,0x65,0x8f,0x02,0x6a,
+	0x77,0x33,0xaa,0x87,0x0f,0x03,0x8e,0x84,0x05,0x8c,0x0a,0xf7,0x2e,0x05,0x24,0x1f,
+	0x01,0x9c,0x22,0xc8,0x21,0xff,0xd8,0x31,0xb8,0x11,0xa8,0x01,0x38,0x41,0xfb,0xa5,
+	0xe4,0x7b,0x02,0xa8,0x03,0xb9,0x73,0xce,0xff,0x73,0x6a,0x5e,0xe1,0x02,0x80,0x22,
+	0xa5,0xdd,0xaa,0x10,0x08,0xbe,0x73,0xb2,0xba,0x08,0xce,0x73,0xfd,0xaa,0x16,0x08,
+	0x65,0xa9,0xff,0xa9,0xc3,0x22,0xbf,0x43,0x98,0xb9,0xd3,0x2d,0x03,0xeb,0x0e,0x41,
+	0xff,0x00,0x38,0x52,0xa8,0x42,0xa5,0xfc,0xfb,0xff,0xad,0x03,0x25,0xfc,0xfb,0xa8,
+	0x62,0xb8,0xff,0x72,0x65,0xa8,0xff,0xa8,0x82,0x65,0xfb,0xff,0xfb,0xa8,0xa2,0xb8,
+	0xb2,0xa5,0xa7,0xff,0xff,0xa8,0xc2,0xb8,0xd2,0x25,0xa7,0xff,0x82,0xff,0x02,0x98,
+	0x16,0xd8,0x0a,0xa8,0xe2,0xe5,0xff,0xf9,0xfb,0xa8,0xf2,0xa5,0xf9,0xfb,0xa2,0xff,
+	0x22,0x10,0xb2,0x22,0x11,0xa5,0xa5,0xff,0xff,0xa2,0x22,0x12,0xb2,0x22,0x13,0xe5,
+	0xa4,0xbe,0x08,0x00,0x14,0xb2,0x22,0x15,0x65,0x08,0x04,0x16,0xdf,0xb2,0x22,0x17,
+	0xe5,0xa3,0x08,0x00,0x18,0xe5,0x6d,0xf6,0x29,0x00,0x19,0xa5,0x05,0x04,0x1a,0x25,
+	0x05,0x04,0xbf,0x1c,0xb2,0x22,0x1d,0x25,0xa2,0x1a,0x00,0x1e,0xdf,0xb2,0x22,0x1f,
+	0xa5,0xa1,0x08,0x00,0x20,0xb2,0xff,0x22,0x21,0x25,0xa1,0xff,0x98,0x22,0x9c,0xef,
+	0xb9,0x3e,0x00,0x04,0xae,0x00,0xa1,0x1b,0xa8,0xff,0x92,0x3a,0xaa,0xa8,0x0a,0x25,
+	0xf3,0xfb,0xff,0xb8,0x22,0x1b,0x44,0xbe,0xe4,0xf3,0x60,0xff,0x80,0x00,0x7c,0x22,
+	0xa8,0x92,0x25,0xf2,0xff,0xfb,0x0c,0x03,0xa2,0x22,0x1b,0xa0,0xa3,0x7f,0xa0,0xa8,
+	0x0a,0x65,0xf1,0xfb,0x1b,0xc6,0x07,0xb7,0x66,0xf3,0xec,0x12,0x00,0x65,0xf0,0x5b,
+	0x00,0x22,0xdf,0xb2,0x22,0x23,0x65,0x9c,0x52,0x00,0x24,0xb2,0xff,0x22,0x25,0xe5,
+	0x9b,0xff,0xad,0x02,0x25,0xeb,0xef,0xfb,0xf3,0x01,0x41,0xd7,0x0f,0xe0,0x4c,0x00,
+	0xfd,0x20,0x0b,0x00,0x41,0xfe,0xff,0x20,0x68,0x74,0xbf,0x20,0x58,0x75,0x20,0x30,
+	0x75,0xfb,0x03,0x5a,0xff,0x54,0x2a,0x24,0x3a,0x34,0x32,0x03,0x00,0xfe,0xfe,0x03,
+	0x52,0x05,0x00,0x6a,0x44,0x42,0x04,0x7f,0x00,0x5a,0x33,0x4a,0x22,0x3a,0x22,0x34,
+	0x04,0xfb,0xe0,0x4d,0x33,0x08,0x20,0x98,0x74,0x20,0x50,0xff,0x75,0x61,0xfc,0xff,
+	0x20,0x40,0x74,0x20,0xff,0x88,0x75,0x8a,0x86,0x4a,0x46,0x5a,0x56,0xf8,0x2d,0x00,
+	0x2b,0x00,0x97,0x01,0x9a,0x66,0x62,0x06,0x00,0xff,0x8a,0x55,0x6a,0x44,0x5a,0x44,
+	0x40,0x30,0x7f,0x04,0x30,0x20,0x60,0x40,0x23,0xb3,0x3c,0x00,0xfe,0x37,0x00,0x71,
+	0xf0,0xff,0x30,0x52,0x10,0x50,0xff,0x98,0x74,0x50,0x88,0x75,0x50,0x60,0x75,0x7f,
+	0x6a,0x67,0x8a,0x87,0x50,0x50,0x74,0x32,0x00,0xf6,0x30,0x00,0x5a,0x57,0x40,0x00,
+	0x9a,0x77,0x72,0x07,0xff,0x00,0x8a,0x66,0x7a,0x55,0x6a,0x55,0x50,0x7f,0x40,0x04,
+	0x40,0x20,0x60,0x50,0x24,0x3a,0x04,0xfe,0x3b,0x04,0x30,0xa2,0x30,0x25,0xf5,0xff,
+	0x2d,0x7d,0x0a,0xa7,0x15,0x6d,0x02,0xae,0x24,0x02,0x1e,0x01,0xff,0x55,0x1b,0x71,
+	0xcd,0xff,0x16,0xd4,0x01,0xff,0x26,0x14,0x02,0x76,0x94,0x17,0x52,0x03,0xff,0x00,
+	0x42,0x06,0x00,0x50,0x44,0x30,0x4a,0xfd,0x47,0x8c,0x00,0x1b,0x33,0x4e,0x22,0x26,
+	0xc0,0x9e,0x5c,0x07,0x1d,0xf0,0x0c,0x02,0x83,0x0c,0x3f,0x14,0x4d,0xf7,0x02,0x3e,
+	0x08,0x3f,0x04,0xa1,0x1b,0x76,0xa3,0xff,0x0e,0xf0,0x32,0x11,0x40,0x20,0x04,0x40,
+	0x9f,0x41,0x41,0x30,0x22,0x20,0x04,0x01,0x23,0x14,0x31,0x7b,0x3e,0xf0,0xe1,0x04,
+	0x28,0x74,0x2a,0x23,0x0e,0x01,0x3b,0x4a,0x33,0x16,0x01,0x80,0x33,0x11,0x23,0x00,
+	0x93,0x10,0xff,0x41,0x36,0xf0,0x20,0x58,0x74,0x20,0x30,0x2f,0x74,0x20,0x20,0x75,
+	0x36,0x11,0x5a,0x30,0x05,0x2c,0x00,0xff,0x00,0x33,0x11,0x80,0x44,0x11,0x40,0x33,
+	0xe9,0x20,0x2d,0x08,0x33,0x05,0x60,0x2a,0x05,0x31,0x29,0xf0,0xfe,0x39,0x01,0x20,
+	0x48,0x74,0x4a,0x43,0x5a,0x53,0xbe,0x31,0x0d,0x8a,0x23,0x80,0x55,0x11,0x31,0x00,
+	0x6a,0xfe,0x5e,0x04,0x00,0x44,0x11,0x50,0x22,0x20,0x80,0xf3,0x33,0x01,0x39,0x14,
+	0x67,0x08,0x2c,0x08,0x47,0x38,0xef,0x02,0xf6,0x23,0x03,0xc3,0x04,0x39,0x12,0x49,
+	0xff,0x22,0x8e,0xb4,0x5a,0x00,0x47,0x01,0x85,0xef,0x1b,0x8e,0xaa,0x1b,0x92,0x03,
+	0xc5,0x1b,0x00,0xff,0xbb,0xa1,0xb9,0x32,0xa5,0xd2,0xfb,0xcd,0xff,0x05,0x3d,0x0a,
+	0xb8,0x22,0xa8,0x12,0xdd,0xff,0x03,0x65,0xa9,0x00,0x39,0x02,0xae,0x00,0xfd,0x0b,
+	0xe0,0x08,0x65,0xc3,0x00,0xae,0xca,0x3b,0xbb,0x00,0x07,0x3d,0x03,0xce,0x72,0x4a,
+	0x01,0x0b,0x65,0xdf,0xf8,0x00,0xae,0x72,0x5d,0x0a,0x08,0xd2,0x42,0xfd,0x18,0xef,
+	0x14,0x4c,0x4a,0x65,0xce,0xfb,0xdd,0xff,0x04,0xcd,0x03,0xbd,0x02,0x5d,0x0a,0x65,
+	0xfd,0xf8,0x6d,0x01,0xcc,0x3a,0xad,0x05,0xa5,0xcb,0xfd,0xfb,0x87,0x10,0xa8,0x02,
+	0xe5,0xca,0xfb,0xa8,0xff,0x42,0xe5,0xc1,0x00,0xa8,0x52,0x65,0xf9,0xff,0x00,0x82,
+	0x02,0x18,0x9c,0xd8,0xa8,0x82,0xff,0xb8,0x92,0xc8,0xa2,0xd8,0xb2,0xe8,0xc2,0xdf,
+	0xf8,0xd2,0xe5,0xb6,0x00,0x0d,0x03,0x82,0x00,0xfe,0x0d,0x03,0xe5,0x74,0x00,0xa8,
+	0x72,0x25,0xc8,0xb4,0x6f,0x0e,0x79,0x02,0xfc,0x7e,0x06,0xc7,0xfb,0x83,0x0d,0x6d,
+	0xf7,0x02,0x0e,0x34,0xbb,0x0d,0x16,0x64,0x02,0x26,0xff,0x14,0x04,0x3d,0xf0,0x76,
+	0x94,0x1e,0x60,0xff,0x50,0x04,0x42,0x03,0x00,0x60,0x61,0x41,0xf7,0x50,0x50,0x60,
+	0x15,0x02,0x50,0x44,0xc0,0x40,0xff,0x41,0x60,0x4a,0x22,0x2e,0x20,0xe3,0x60,0xd7,
+	0x20,0x01,0x48,0xc1,0x15,0x00,0xc3,0x1d,0x81,0x00,0xdf,0x39,0x01,0xae,0x71,0x19,
+	0xc4,0x08,0x99,0x21,0xbd,0xd8,0xff,0x03,0xfe,0x41,0x0d,0xbe,0xd7,0x07,0xd7,0xff,
+	0x3c,0x02,0xc6,0x26,0x00,0xf7,0x3c,0x02,0xff,0x46,0x25,0x00,0xcc,0x74,0xa8,0x52,
+	0xb8,0xff,0x12,0x25,0xef,0x00,0xa9,0x11,0x58,0x21,0xfe,0x98,0x00,0x7e,0x4a,0x45,
+	0xa0,0x20,0x00,0x80,0xff,0x22,0x59,0x41,0x00,0x15,0x40,0x79,0x31,0xf7,0x7e,0x4a,
+	0x53,0x42,0x01,0x81,0x1b,0x00,0x33,0xef,0xa1,0xee,0x53,0x06,0x93,0x08,0x0c,0x05,
+	0xa8,0xbf,0x02,0xb8,0x21,0xc8,0x12,0x5a,0x74,0x03,0x9c,0xff,0x94,0xd8,0xe2,0xb0,
+	0xbc,0x82,0xba,0xb4,0x7f,0xcc,0x7d,0x65,0xf4,0xff,0xc6,0x04,0x77,0x00,0xdf,0x00,
+	0xe5,0x42,0x02,0x86,0xe0,0x01,0x00,0x00,0xef,0xc8,0x11,0xc0,0xaa,0x94,0x02,0x01,
+	0xd8,0x31,0xff,0x7c,0xee,0xe0,0xe6,0x10,0xea,0xdd,0xd2,0x7f,0x1d,0x00,0xae,0xdd,
+	0x25,0xa0,0x80,0x70,0x02,0xef,0xde,0x67,0x06,0xc0,0x66,0x04,0x6e,0x03,0x17,0x7f,
+	0xe0,0x40,0x01,0x94,0x22,0x58,0x41,0x7b,0x00,0xff,0x25,0x68,0x00,0x59,0x21,0xc6,
+	0xd4,0xff,0xfd,0x00,0xc1,0x04,0x36,0x21,0x01,0x22,0x61,0x13,0xff,0x88,0x22,0x39,
+	0xd1,0x49,0xe1,0x8e,0x93,0xff,0x58,0x1e,0xe1,0x03,0xa4,0x22,0x89,0xf1,0xdf,0x8e,
+	0xb8,0x57,0x01,0x07,0xda,0x01,0x00,0xa7,0xbf,0xa1,0xae,0x71,0xc9,0x20,0x21,0x42,
+	0x00,0x97,0xff,0x38,0x02,0x06,0x8c,0x00,0xf0,0xda,0x11,0xff,0xa0,0xc1,0x41,0xd2,
+	0x61,0x12,0xe0,0xdc,0xff,0x11,0xd9,0xa1,0xf0,0xcc,0x11,0xc9,0xb1,0xff,0xc2,0x21,
+	0x13,0xe8,0xe1,0x48,0x7c,0xc8,0xff,0x1c,0x16,0x5e,0x21,0xd2,0x21,0x13,0xd8,0xff,
+	0xed,0x00,0x1c,0x40,0x00,0x97,0xa1,0xfc,0x7f,0x5d,0x16,0x69,0x06,0x4e,0x64,0x35,
+	0xf0,0x09,0xff,0xd8,0xf1,0xb8,0xe1,0xad,0x05,0xd0,0xdc,0xbf,0x82,0xda,0xbb,0x65,
+	0xe8,0xff,0x31,0x00,0xc8,0xef,0x1c,0xa2,0x56,0x00,0x28,0x00,0x8e,0xe7,0x15,0xfe,
+	0x07,0x01,0xc4,0x22,0xee,0xe5,0xb6,0xc0,0x40,0xff,0x01,0x78,0x22,0x86,0x0c,0x00,
+	0xac,0xf9,0xee,0x35,0x40,0x25,0x34,0x02,0x35,0x60,0xb2,0x21,0x13,0xff,0xa2,0xc1,
+	0x10,0xbe,0x4b,0x0c,0x02,0x87,0xff,0x00,0x65,0x1b,0xe5,0xe9,0xf8,0xa2,0x21,0xff,
+	0x13,0xf8,0xda,0xe8,0xca,0xd8,0xba,0xc8,0xff,0xaa,0xb8,0x9a,0xa8,0x8a,0x49,0x01,
+	0xe5,0xfb,0x96,0x00,0x13,0x00,0x52,0x2a,0x10,0xa8,0xfa,0xff,0x88,0x45,0x58,0x55,
+	0x82,0x61,0x11,0xe5,0xff,0x64,0x00,0xc2,0x21,0x12,0xb8,0xc1,0x52,0xff,0x61,0x1b,
+	0xb2,0x61,0x16,0xc7,0x3b,0x02,0xff,0x86,0x47,0x00,0xa2,0x61,0x15,0x38,0x91,0xff,
+	0xe8,0x41,0x88,0xa1,0x98,0xb1,0x92,0x61,0xef,0x19,0x8e,0x71,0x8f,0x86,0x00,0x81,
+	0x1b,0xf2,0xdf,0x61,0x17,0xee,0x71,0x0c,0x0a,0x08,0x3e,0x71,0xfd,0xa3,0x07,0x08,
+	0xd2,0x21,0x19,0x92,0x21,0x10,0xff,0x82,0x21,0x11,0x52,0x21,0x17,0xe2,0x21,0xff,
+	0x18,0x8a,0xf3,0x9a,0x55,0x9e,0xee,0x2a,0xfe,0x0d,0x03,0xad,0x1b,0x8e,0xdd,0x29,
+	0x80,0x81,0xee,0x7a,0x01,0x9e,0x71,0x4c,0x2a,0x08,0x76,0xaa,0x82,0xff,0x22,0x21,
+	0x1a,0xb8,0x0e,0xa8,0x05,0x42,0xff,0x1f,0x00,0x20,0xbb,0xa0,0x20,0xaa,0xa0,0xff,
+	0xa8,0x0a,0xb8,0x0b,0x22,0x1d,0x00,0xa0,0xff,0x90,0xf5,0xb0,0x80,0xf5,0xaa,0x64,
+	0x60,0xff,0x60,0xf4,0x8a,0x82,0xba,0x72,0x9a,0x44,0xff,0x22,0x21,0x1b,0x70,0x70,
+	0xf4,0xca,0x93,0xff,0x20,0x29,0x90,0x67,0x37,0x09,0x7d,0x06,0xfb,0x0e,0x06,0x0a,
+	0x06,0x41,0x1b,0x0c,0x16,0x72,0xff,0x52,0x00,0x72,0x21,0x15,0x2b,0xcc,0x4e,0xef,
+	0x40,0xed,0xa0,0x41,0x86,0x02,0x9e,0x77,0x2e,0x7d,0xc0,0x64,0x04,0x6e,0x87,0x0f,
+	0xe0,0x41,0x9c,0x01,0xf7,0x8e,0x60,0xe5,0xef,0x01,0x48,0x22,0x4e,0xe6,0xfd,0x79,
+	0x31,0x00,0x61,0x1b,0xc6,0x01,0x00,0x6e,0xfb,0x46,0x39,0xc2,0x01,0xa5,0x1b,0x42,
+	0x52,0x01,0xff,0x92,0x47,0x01,0xc2,0x21,0x14,0xa2,0x21,0xef,0x12,0xe2,0x21,0x17,
+	0xb9,0x08,0x16,0xbe,0x41,0xff,0x8e,0xc4,0x01,0x01,0x80,0x22,0xee,0x71,0x7b,0x7d,
+	0xa2,0x07,0x04,0xde,0x71,0x99,0x22,0x07,0x04,0xef,0x9e,0x71,0x6b,0x64,0x07,0x04,
+	0xbe,0x71,0x87,0xfe,0x3c,0x00,0x81,0x1b,0xae,0xc9,0x73,0x62,0x00,0xff,0x00,0x60,
+	0x22,0x06,0xc3,0xff,0x52,0x21,0xfd,0x1b,0x81,0x01,0xbd,0x05,0xa8,0xfc,0xc8,0x4c,
+	0xfb,0x65,0x69,0x4d,0x05,0xa2,0x2a,0x10,0x65,0x43,0xfd,0x00,0xf2,0x01,0xc8,0xd1,
+	0xb8,0xf1,0xd8,0x2d,0x7f,0xde,0xcc,0x5b,0x60,0x21,0x01,0xa4,0x3b,0x00,0xfb,0xfc,
+	0x80,0x30,0x06,0xc7,0xbb,0x02,0x46,0x78,0xf9,0xff,0x24,0x07,0x2b,0x00,0xbd,0x0c,
+	0xa8,0x5a,0x65,0xf3,0xbf,0x00,0xc3,0x09,0x1f,0x06,0xb7,0xa1,0x16,0x8b,0xf7,0xe4,
+	0x2d,0x0a,0xe9,0x15,0x50,0xa2,0x30,0xe5,0xd7,0xc8,0x01,0xe2,0x49,0x02,0x1e,0xe1,
+	0x05,0x1e,0x40,0xfb,0x8e,0xd7,0xe1,0x0d,0xde,0xe5,0x36,0xc0,0x40,0xdf,0x00,0x7c,
+	0x22,0x86,0x86,0xae,0x02,0x36,0xc1,0xff,0x00,0x98,0x22,0x39,0x41,0x88,0x41,0x3d,
+	0xdf,0x04,0x9e,0x48,0x59,0x3e,0xaa,0x06,0x8e,0xb9,0xfd,0x59,0xa8,0x0e,0x99,0xa1,
+	0x9e,0x71,0x34,0x80,0xfe,0xeb,0x06,0x87,0x34,0x02,0xc6,0x58,0x00,0xe0,0xff,0xc9,
+	0x11,0xf0,0xd9,0x11,0xd9,0xb1,0xce,0xff,0x71,0x1b,0x1e,0xe7,0x1e,0x81,0x1b,0xb0,
+	0xff,0xa9,0x10,0xa9,0x21,0xe2,0x22,0x10,0xa8,0xff,0xf2,0x58,0x4e,0xe8,0x5e,0xe9,
+	0x51,0xe5,0xff,0x44,0x00,0xa9,0xa1,0x78,0x72,0x59,0x01,0xdf,0xc8,0x12,0x9e,0x33,
+	0x1b,0x7c,0x03,0x55,0x1b,0xfb,0xf8,0xe2,0x99,0x04,0x9b,0xa1,0xfc,0x5f,0x4e,0xfb,
+	0x69,0x05,0x83,0x0b,0x6d,0x07,0xad,0x05,0x40,0x7e,0x77,0x03,0xb3,0x25,0xbd,0xff,
+	0xc8,0x12,0x99,0x00,0xb7,0x8e,0xbc,0x5b,0x6e,0x08,0x8e,0xdb,0x9e,0x14,0xd6,0xb6,
+	0x80,0x0a,0xc6,0x0c,0x89,0x07,0xde,0x29,0x36,0x30,0xa5,0xfb,0x08,0x02,0x36,0x68,
+	0x49,0xd1,0x58,0x02,0x39,0xff,0xc1,0xf8,0xb1,0xe8,0x31,0x98,0x41,0x88,0xff,0x22,
+	0x6d,0x0e,0x90,0x94,0xc0,0x9a,0x88,0xff,0x00,0x18,0x40,0x00,0xdb,0xa1,0xfe,0xee,
+	0xf9,0x78,0xb7,0x00,0xc9,0x01,0x1f,0x00,0xc8,0x21,0x38,0xff,0x01,0xf8,0x11,0xe0,
+	0x4d,0x11,0xf0,0xad,0xff,0x11,0x80,0x8d,0x10,0x89,0x91,0xa9,0x81,0xff,0x49,0x71,
+	0x5a,0xff,0xed,0x03,0x3a,0xcc,0xf7,0x3e,0x41,0x54,0x71,0x00,0x81,0x1b,0x82,0x1c,
+	0xff,0x00,0xb8,0x0f,0xa8,0x05,0x92,0x1e,0x00,0xff,0x70,0xbb,0x90,0x70,0xaa,0x90,
+	0xa2,0x1a,0xff,0x00,0xb2,0x1b,0x00,0xda,0x66,0x9a,0xaa,0xdf,0x8a,0xbb,0xb0,0xb0,
+	0xf4,0xd0,0x02,0x71,0xa0,0xff,0xa0,0xf4,0x4a,0x88,0x9a,0x55,0xb7,0xba,0xcf,0x0a,
+	0x0e,0x0f,0x0b,0x56,0x0a,0xb1,0x00,0xbe,0xab,0xfd,0x3b,0x24,0x0a,0xa2,0x53,0x00,
+	0xb2,0x48,0x00,0xff,0x88,0x91,0x9a,0xff,0x98,0x81,0x8a,0xcc,0xff,0x8a,0xee,0x88,
+	0xb1,0xda,0x44,0x9a,0x33,0xff,0x87,0x36,0xa6,0x48,0xd1,0x38,0xc1,0xb8,0xff,0x51,
+	0xa8,0xf2,0xc8,0x42,0xa5,0x42,0x00,0xff,0xa2,0x22,0x10,0x65,0x24,0x00,0x98,0x41,
+	0xff,0x1b,0x44,0x40,0x99,0xc0,0x56,0x09,0xeb,0xfc,0xdb,0x05,0xd8,0x01,0x52,0xa5,
+	0xa1,0x00,0xd8,0x12,0xef,0x6d,0x07,0x8e,0xbd,0xe5,0x0c,0x00,0xcb,0xa1,0xf7,0x3e,
+	0x2c,0xf5,0x09,0x09,0xa9,0x61,0xa8,0x61,0x7f,0x50,0xaa,0x30,0x25,0xab,0x01,0xd8,
+	0x07,0x09,0x76,0x21,0x10,0x8e,0xcb,0x07,0x0d,0xce,0xe5,0xf6,0x07,0x09,0xff,0x06,
+	0xbd,0xff,0x36,0x81,0x00,0x88,0x12,0xdf,0x0c,0x16,0x62,0x42,0x18,0xff,0x00,0x8e,
+	0xa6,0xff,0x1b,0x00,0x27,0x00,0xc5,0x1b,0xa5,0x69,0xff,0xfb,0xb8,0x12,0xc8,0x22,
+	0xa9,0x72,0xd8,0xff,0x02,0xad,0x01,0x25,0x4c,0x00,0xa2,0xc2,0xbf,0x20,0x1e,0xb1,
+	0x3c,0x02,0x87,0xb1,0x00,0x65,0xff,0xab,0xf8,0xcd,0x05,0xbd,0x04,0xe8,0x22,0xdf,
+	0xd8,0x32,0x3e,0xa3,0x3f,0x44,0x0a,0xf9,0xe2,0xcf,0xde,0xd1,0xde,0xde,0x15,0x06,
+	0x40,0x02,0x00,0xe6,0xff,0xa1,0xa5,0x1b,0x00,0xa9,0xf2,0xa8,0x32,0xbf,0xa5,0x10,
+	0x00,0xa2,0x62,0x10,0xab,0x04,0x36,0xff,0x41,0x00,0x82,0x02,0x18,0xec,0x88,0xd8,
+	0xff,0x12,0x78,0x22,0xa1,0xe5,0xbf,0x0e,0xcd,0x7d,0xeb,0xa4,0x00,0xad,0x1b,0xde,
+	0xcc,0x5d,0x3f,0x08,0xff,0xe5,0xa6,0x01,0x70,0xb7,0xa0,0xdd,0x0a,0xff,0xc0,0xc7,
+	0x11,0x70,0xcc,0xc0,0xad,0x02,0xff,0xe5,0xf6,0xff,0xad,0x03,0xb8,0x12,0xe5,0xbf,
+	0x98,0xf8,0xcd,0x04,0x3d,0x0a,0xf9,0x02,0x42,0xfb,0x25,0x59,0x03,0x05,0xe5,0x10,
+	0x00,0xa8,0xf2,0xff,0x25,0x20,0x00,0xad,0x02,0xbd,0x03,0xcd,0xef,0x06,0xe5,0x9f,
+	0xff,0x08,0x0c,0x65,0xab,0xff,0xff,0xcd,0x06,0xbd,0x03,0xad,0x02,0xa5,0xd5,0xff,
+	0xff,0xa8,0xf2,0xb8,0x42,0x65,0x38,0x00,0x7f,0xa8,0x42,0x65,0x81,0x00,0x2d,0x0a,
+	0x7b,0x10,0xfb,0xad,0x04,0x4c,0x00,0xeb,0x01,0xee,0x2a,0x08,0xdb,0x01,0x67,0x1b,
+	0x01,0x7c,0xf2,0x17,0x04,0x00,0x6d,0xff,0x0a,0xbd,0x03,0xa8,0x52,0xcd,0x06,0xa5,
+	0xef,0x8a,0x00,0xdd,0x05,0x40,0x00,0x04,0x2e,0xa2,0xdd,0x3e,0x8e,0x08,0x25,0xf5,
+	0xff,0x3a,0x0c,0x00,0x40,0xff,0xa3,0x41,0x4e,0x18,0x66,0x40,0x21,0x01,0xdf,0x98,
+	0x22,0x06,0xf4,0xff,0x4b,0x18,0x25,0xe7,0xf7,0x01,0xce,0x1a,0x4b,0x28,0xcd,0x0a,
+	0xed,0x03,0x3d,0xdd,0x15,0x01,0xad,0x02,0x65,0xf1,0x3c,0x08,0x39,0x08,0xff,0x8c,
+	0x40,0x21,0x00,0x9c,0x22,0x86,0xf8,0xfd,0xff,0x37,0x00,0x3d,0x02,0xae,0x01,0x0b,
+	0x02,0xff,0x87,0x00,0xa1,0x1b,0xe5,0x53,0xfb,0x2d,0xff,0x0a,0x39,0x3a,0x3e,0xb3,
+	0x3a,0x00,0x27,0x5e,0xfc,0x04,0x52,0xfb,0xa9,0x12,0x0c,0x14,0x25,0x0c,0x00,0xff,
+	0x22,0xa9,0x52,0x98,0x12,0x9e,0x72,0x48,0xf6,0x5f,0x0a,0x89,0x02,0xc3,0x10,0xa8,
+	0x12,0x25,0x53,0xe7,0xfb,0xa8,0x22,0x2d,0x00,0xe7,0x00,0x52,0xfb,0x1d,0xfd,0xf0,
+	0x13,0x00,0xc8,0x32,0xa8,0x12,0x3e,0xcc,0x5d,0xfb,0x4b,0x09,0xa5,0x57,0xfb,0x0e,
+	0x00,0x22,0x0e,0x18,0xff,0x56,0xfb,0xe8,0x22,0xf8,0x12,0xf9,0x42,0x97,0xee,0x72,
+	0x5d,0x48,0x08,0xd9,0x48,0x04,0x33,0x00,0x38,0xff,0x02,0x2e,0x43,0x43,0x60,0x20,
+	0x00,0xac,0xff,0x22,0x30,0x30,0x04,0x48,0x14,0x49,0x42,0xff,0x39,0x02,0x20,0x33,
+	0xa0,0x38,0x13,0x39,0xb5,0x52,0x1f,0x0c,0x7d,0xa7,0x04,0x04,0xc7,0xa7,0x00,0x65,
+	0xef,0x49,0xfb,0x79,0x0a,0xa9,0x00,0x12,0x69,0x42,0xff,0x3a,0xa7,0x59,0x32,0xa9,
+	0x22,0xe0,0xaa,0xff,0x11,0x65,0x4c,0xfb,0xb8,0x22,0xae,0x72,0xdd,0x56,0x52,0x08,
+	0x5e,0x2b,0x03,0x6b,0x0a,0x5e,0xa5,0xfe,0xcb,0x0e,0x65,0x46,0xfb,0xc8,0x52,0xb8,
+	0x22,0xdf,0x6a,0xcc,0xae,0x7c,0x03,0x61,0x00,0x80,0x22,0xff,0xbe,0xe3,0x36,0xc0,
+	0x80,0x00,0x7c,0x22,0xff,0xad,0x0b,0xe5,0x48,0xfb,0xa9,0x82,0x4e,0xfb,0x72,0x9d,
+	0x8a,0x0c,0x62,0xd9,0x72,0xd9,0xa2,0xfe,0xd7,0x10,0x88,0x22,0x0c,0x03,0x9e,0x18,
+	0x04,0xfe,0x48,0x08,0xa8,0x52,0x3a,0xaa,0xa8,0x0a,0xa5,0xfd,0x44,0x63,0x00,0x1b,
+	0x44,0xbe,0xe4,0xf3,0x60,0xfc,0x3c,0x04,0xe5,0x02,0x43,0xfb,0xa8,0x82,0x65,0x43,
+	0xce,0xf8,0x00,0xe5,0x42,0xfb,0x6e,0x09,0x37,0x00,0x0c,0x03,0xef,0x39,0x72,0x39,
+	0x62,0xd3,0x10,0x52,0x28,0x62,0xef,0x30,0x22,0xa0,0x28,0x2b,0x19,0x32,0xf0,0xb4,
+	0x7f,0x11,0x81,0x4b,0xbf,0x8e,0x1a,0x07,0x57,0x08,0xff,0x92,0x13,0x00,0xba,0x33,
+	0x87,0xb9,0x03,0xff,0x8d,0x09,0x2d,0x07,0x4a,0x77,0xa7,0x37,0xef,0xee,0xc6,0xff,
+	0xff,0x47,0x14,0x58,0x32,0x30,0xff,0x84,0x90,0x22,0x18,0x00,0x16,0x35,0x01,0xbf,
+	0x26,0x15,0x02,0x76,0x95,0x0d,0x2c,0x00,0x20,0x7f,0x99,0xc0,0x9e,0x63,0x03,0x60,
+	0x40,0xc2,0x00,0xfe,0x67,0x09,0xad,0x05,0x58,0x22,0xc8,0x42,0xbe,0xfb,0x42,0x6e,
+	0xbe,0x08,0xde,0x24,0x0f,0xbe,0xe0,0xff,0x02,0x54,0x22,0xd8,0x52,0x16,0x34,0x02,
+	0xff,0x26,0x14,0x02,0x76,0x94,0x1d,0xcc,0x3b,0xff,0xbd,0x0f,0x46,0x00,0x00,0x0b,
+	0xbb,0xd0,0xff,0x9b,0xa0,0x98,0x09,0x3a,0x99,0x92,0x09,0xff,0x00,0x8d,0x0e,0x90,
+	0x8c,0x93,0x30,0x38,0xff,0x20,0x30,0x31,0x41,0xf8,0x72,0x8e,0x4b,0xff,0xfd,0xbe,
+	0xe0,0x03,0x7c,0x22,0xb0,0xd8,0xff,0x93,0xf7,0xb4,0x46,0x40,0x9f,0xc0,0x4e,0xfd,
+	0x00,0x43,0x04,0xa0,0x22,0x76,0x99,0x35,0x88,0xbf,0x52,0x9d,0x0d,0xcc,0x3d,0xdd,
+	0x3f,0x08,0xdd,0xff,0x80,0x89,0xa0,0x88,0x08,0x58,0x82,0x3a,0xff,0x88,0x82,0x08,
+	0x00,0xbd,0x0e,0x4a,0x55,0xff,0x80,0xbc,0x93,0x30,0x3b,0x20,0x3e,0x31,0xfd,0xd8,
+	0x60,0x09,0xb0,0xb8,0x93,0xbe,0x85,0x04,0xf9,0x80,0x5a,0x05,0x2d,0x00,0x0c,0x04,
+	0xb8,0x82,0xcd,0xff,0x04,0xe5,0x3e,0x00,0x98,0x72,0x40,0x99,0xf7,0xc0,0x99,0x72,
+	0x0b,0x0d,0x98,0x92,0x88,0x62,0xff,0xb8,0x22,0xd8,0xa2,0xae,0x42,0x78,0x00,0xdd,
+	0x21,0x28,0x00,0x8e,0x72,0x6c,0xb5,0x08,0xbe,0x08,0xfb,0x6d,0xa0,0x0f,0x04,0xc9,
+	0x62,0xde,0x72,0xaa,0xfa,0x97,0x02,0x80,0xdc,0x03,0xd7,0x99,0x29,0xad,0x02,0xfb,
+	0xc9,0xa2,0x43,0x03,0x05,0xa5,0xec,0xff,0x5d,0xf6,0x0f,0x03,0xad,0x02,0x0a,0x00,
+	0xee,0xff,0xf8,0x72,0xff,0xe8,0x22,0xf7,0x9e,0x23,0xbd,0x05,0xad,0x7f,0x02,0xc8,
+	0x02,0xdd,0x04,0xe5,0xef,0x2e,0x01,0xe7,0xa7,0x9b,0x13,0xf7,0x03,0x21,0x00,0xe5,
+	0xe9,0xff,0xff,0xdd,0x04,0xbd,0x0a,0xc8,0x02,0xad,0x02,0xfb,0x25,0xee,0x47,0x19,
+	0xcd,0x04,0xbd,0x03,0x2e,0xbb,0xa2,0x3d,0xa7,0x08,0xa5,0xf7,0xff,0x37,0x09,0xdd,
+	0xee,0x2d,0x00,0xbe,0x00,0x0c,0x7f,0x00,0xa1,0x1b,0xa5,0xfd,0xeb,0x13,0x04,0x61,
+	0x00,0x29,0x21,0x49,0x01,0xf7,0x8e,0xb3,0x58,0x27,0x00,0x85,0x1b,0x00,0x88,0xff,
+	0xa1,0x89,0x11,0x16,0xc8,0x05,0x59,0x31,0xbf,0x40,0x42,0x90,0x2e,0x00,0x05,0x28,
+	0x08,0x88,0xdf,0x21,0x3e,0x41,0x07,0x01,0xb2,0x04,0x9e,0x28,0xf5,0x06,0xbe,0x09,
+	0xa2,0x91,0x01,0xaa,0x10,0x65,0x5e,0xff,0x01,0xa0,0xc0,0x04,0xbd,0x05,0xc0,0xb7,
+	0x7f,0x93,0x60,0x6b,0x20,0x3e,0x77,0xf3,0x9f,0x01,0x7f,0xac,0x22,0x47,0x93,0xe0,
+	0x06,0x01,0x81,0x00,0xff,0x00,0x0c,0x06,0xe8,0x31,0xd8,0x11,0x6e,0xef,0x7e,0x0e,
+	0xc0,0x81,0xdb,0x00,0xee,0x71,0x32,0xdd,0x40,0x26,0x05,0x27,0x9d,0xaf,0x13,0x0a,
+	0x81,0x00,0xbf,0x5e,0x71,0x67,0x9e,0xe0,0x02,0x0f,0x01,0xb7,0xf7,0x5a,0x00,0x47,
+	0x7b,0x04,0xaa,0xa1,0xf0,0x20,0xff,0x00,0x65,0x1f,0xfb,0x5d,0x0a,0xa9,0x01,0xbf,
+	0xf0,0x83,0x11,0x8e,0xb8,0x54,0x93,0x0c,0x44,0x6f,0xa1,0x4e,0xa4,0x3b,0x22,0x00,
+	0xa5,0x1b,0x1f,0x00,0x7f,0x25,0x19,0xfb,0x6d,0x0a,0xa9,0x11,0x11,0x24,0x7f,0x18,
+	0xfb,0x4d,0x0a,0x8e,0xb7,0x5b,0x2c,0x0c,0xdf,0x9b,0xa1,0x2e,0x49,0x0a,0xac,0x00,
+	0x55,0x1b,0xff,0xcd,0x05,0x58,0x61,0x76,0xa9,0x33,0xf8,0xff,0x15,0xe8,0x05,0x00,
+	0x13,0x40,0x00,0xff,0xff,0xa1,0xf0,0xee,0x20,0x40,0xde,0xa0,0x98,0xff,0x0d,0x6e,
+	0x19,0x05,0xa2,0x00,0x01,0x58,0xbf,0x22,0xa9,0x0d,0xee,0x76,0x1a,0x78,0x09,0x9e,
+	0xf3,0x4d,0x06,0x16,0x03,0x07,0x00,0x7c,0x0c,0x80,0x81,0xee,0xcb,0x11,0x1a,0x39,
+	0x31,0x36,0x04,0x8b,0xa1,0xae,0xef,0x71,0x48,0x1e,0xe1,0xa7,0x04,0x71,0x2b,0x00,
+	0xfd,0x47,0x04,0x01,0x25,0x11,0xfb,0xa9,0x51,0xad,0xf7,0x04,0x65,0x13,0xfe,0x02,
+	0x1e,0xb1,0x3c,0x02,0xed,0x87,0x68,0x07,0x53,0xf8,0x97,0x0e,0x02,0xe5,0x11,0xef,
+	0xfb,0xad,0x03,0xa5,0x04,0x00,0x07,0x65,0x11,0xdd,0xfb,0x13,0x08,0x4e,0x26,0x13,
+	0x36,0x03,0xc8,0x22,0x7f,0x00,0x05,0x40,0x6e,0x41,0x82,0xde,0xf2,0x04,0xff,0x16,
+	0xe2,0x02,0x26,0x12,0x04,0x3d,0xf0,0xff,0x76,0x92,0x26,0x98,0x03,0x90,0xa0,0x91,
+	0xff,0x90,0x94,0x10,0x60,0xaa,0x90,0xa2,0x1a,0xff,0x00,0x60,0x99,0x90,0x92,0x19,
+	0x00,0x00,0xff,0xaa,0x11,0xae,0x99,0x37,0xe0,0x80,0x01,0x1f,0xa4,0x22,0x9e,0x77,
+	0x03,0x3c,0x00,0xf5,0x06,0xd3,0x09,0x7f,0x4d,0x02,0xae,0x01,0x0b,0x02,0x47,0xbd,
+	0x05,0xff,0x08,0xfb,0x2d,0x0a,0x8c,0x54,0xcd,0x03,0xdf,0xbd,0x04,0x65,0x00,0x00,
+	0xf3,0x15,0x39,0x22,0xf7,0x4e,0x72,0x45,0x5d,0x0a,0x52,0x42,0x00,0x59,0xf7,0x12,
+	0x59,0x32,0x37,0x10,0xad,0x02,0x65,0x08,0xed,0xfb,0x0b,0x10,0x6e,0x14,0xd6,0x05,
+	0x55,0x1b,0xad,0xff,0x02,0xbd,0x03,0x25,0x01,0x00,0x3e,0x31,0x77,0xd5,0xa0,0x20,
+	0x69,0x00,0x57,0x94,0xed,0xaf,0x0e,0x7f,0x48,0x12,0x52,0x02,0x00,0x3e,0x80,0xd5,
+	0x06,0xff,0x48,0x22,0x49,0x12,0x80,0x35,0x20,0x32,0xff,0x42,0x00,0x66,0x84,0x1b,
+	0xa8,0x32,0x98,0xff,0x22,0xaa,0x99,0x32,0x49,0x00,0x88,0x32,0xdf,0x0c,0x03,0x3e,
+	0x72,0x18,0xcc,0x0a,0x89,0x32,0xfe,0x1c,0x00,0x1d,0xf0,0xf0,0x33,0x11,0x06,0xfd,
+	0xfd,0xff,0x83,0x0c,0x98,0x12,0x6e,0x52,0x07,0x00,0xfd,0x87,0x83,0x00,0x90,0x77,
+	0xc0,0x70,0x74,0x63,0xff,0x70,0x44,0xc0,0x7a,0x99,0x9c,0xc7,0x3a,0xff,0x87,0x16,
+	0x37,0x01,0x26,0x17,0x02,0x76,0xff,0x97,0x0d,0xa2,0x03,0x00,0x60,0x6a,0x20,0x5f,
+	0x3e,0x66,0xf3,0x60,0x20,0x30,0x02,0xc6,0x2c,0x06,0xff,0x3a,0x87,0x78,0x32,0x3d,
+	0x08,0x88,0x22,0xff,0x26,0x89,0x02,0xc6,0x24,0x00,0x40,0xf3,0xff,0x41,0x60,0xb1,
+	0x41,0x7e,0xc8,0x27,0xe0,0xff,0x20,0x01,0xac,0x22,0x7a,0x68,0xb2,0x4c,0xff,0x00,
+	0x76,0x9f,0x53,0xd2,0x03,0x07,0xc2,0xff,0x03,0x06,0x52,0x03,0x04,0xb2,0x03,0x05,
+	0xff,0x82,0x03,0x02,0x92,0x03,0x01,0xe2,0x03,0xff,0x00,0xa2,0x03,0x03,0xa0,0x99,
+	0x11,0x90,0xff,0xee,0x11,0xc0,0xaa,0x11,0xb0,0x88,0x11,0xff,0xe0,0xbb,0x11,0xd0,
+	0x55,0x11,0xf0,0xcc,0xff,0x11,0xc0,0xdd,0x20,0xb0,0x55,0x20,0xa0,0xff,0x88,0x20,
+	0x90,0xee,0x20,0x80,0xee,0x20,0xf7,0x5e,0xee,0x37,0x4b,0x00,0xa4,0x22,0xee,0xdd,
+	0xf7,0x33,0x62,0x00,0x07,0x00,0xde,0x86,0x06,0xc0,0xfe,0x8e,0x06,0xd0,0xaf,0x11,
+	0xa0,0x44,0xc0,0x8e,0x7d,0x24,0xd7,0x0e,0x16,0x54,0x01,0x26,0x14,0x97,0x05,0xd7,
+	0x94,0x0d,0x82,0xa3,0x00,0x68,0xa3,0x18,0x46,0x02,0xff,0x00,0x4d,0x09,0x62,0x42,
+	0x00,0x86,0x01,0xbc,0xd6,0x02,0x07,0x00,0x79,0x32,0x49,0x12,0x73,0x0d,0x61,0xff,
+	0x00,0xa8,0x22,0x98,0x12,0x7e,0x42,0x35,0xfe,0xcb,0x0a,0x5e,0x33,0x2b,0x00,0x87,
+	0x01,0xad,0xff,0x1b,0x7e,0x49,0x06,0x60,0x00,0x02,0x54,0xff,0x22,0x82,0x02,0x00,
+	0x90,0xbb,0xc0,0xb0,0xff,0xb4,0x63,0x16,0x8b,0x01,0x26,0x1b,0x02,0xff,0x76,0x9b,
+	0x12,0xc2,0x06,0x80,0x8e,0x8c,0xff,0x33,0x7e,0xe0,0x03,0xa4,0x22,0x3e,0x88,0xfd,
+	0xf6,0x0d,0x02,0xac,0x22,0xb0,0x44,0xc0,0xba,0xff,0x69,0x26,0x86,0x08,0x82,0x42,
+	0x00,0x69,0xfe,0x55,0x08,0x80,0xd1,0x41,0x7a,0xea,0xde,0x8e,0xfb,0x07,0xe0,0xa1,
+	0x04,0x40,0x93,0x41,0x99,0x01,0xfb,0x5e,0x69,0x4f,0x0c,0x99,0x01,0x7a,0x8a,0xd0,
+	0xff,0xf9,0x11,0xf0,0x33,0xc0,0x76,0x99,0x53,0xff,0x52,0x06,0x79,0xf2,0x06,0x7a,
+	0xa2,0x06,0xff,0x7b,0xe2,0x06,0x7c,0xb2,0x06,0x7f,0xc2,0xff,0x06,0x7e,0x92,0x06,
+	0x7d,0xd2,0x06,0x80,0xb9,0xb0,0xfd,0x00,0x12,0x01,0xdd,0x11,0xa0,0x0c,0x01,0xee,
+	0xff,0x11,0xe0,0xaa,0x11,0xf0,0xff,0x11,0xf0,0xff,0x55,0x20,0xe0,0xaa,0x20,0xd0,
+	0xbb,0x20,0x3f,0xc0,0x99,0x20,0xb0,0x99,0x20,0x5f,0x06,0x0f,0x05,0xdf,0x9e,0x55,
+	0x36,0xde,0x00,0x8b,0x00,0x5e,0x88,0xfd,0x08,0xcf,0x09,0xd8,0x01,0xd0,0xdd,0x11,
+	0xd0,0x5f,0x44,0xc0,0xee,0x14,0x08,0x11,0x0d,0x34,0x11,0x01,0xfd,0x02,0x0f,0x01,
+	0x92,0x03,0x00,0x80,0x89,0x20,0x0f,0x3e,0x88,0xf3,0x7e,0xb2,0x04,0x20,0x07,0xaf,
+	0x04,0x07,0x1d,0xbe,0x37,0x06,0x88,0x32,0x6e,0x52,0x09,0xf9,0x09,0x3e,0xfd,0x24,
+	0x63,0x0e,0x78,0x22,0x40,0x99,0xc0,0x00,0xdf,0x19,0x40,0x00,0x66,0xa1,0x35,0x01,
+	0x8a,0x77,0xff,0x62,0x47,0x00,0x38,0x32,0x5e,0x72,0x13,0xde,0x54,0x01,0x80,0x22,
+	0x39,0x32,0x1f,0x0b,0x28,0x32,0xfe,0x77,0x0e,0x20,0x30,0x04,0x20,0x71,0x21,0x20,
+	0xff,0x83,0x21,0x2e,0x55,0x2a,0x00,0x27,0x00,0xdf,0xad,0x1b,0xae,0x55,0x69,0x70,
+	0x03,0xad,0x1b,0xff,0x90,0x88,0x10,0x90,0x42,0x10,0x1e,0x44,0xf9,0xf9,0x5a,0x00,
+	0x0d,0x00,0x77,0x10,0x90,0x62,0x10,0xff,0xf0,0x66,0x11,0x60,0x44,0x20,0xa0,0x92,
+	0xff,0x10,0xb0,0x99,0x11,0x20,0xa7,0x04,0xa0,0xff,0x55,0x20,0x80,0x27,0x20,0x50,
+	0x22,0x20,0xff,0x40,0x22,0x20,0x90,0x33,0x11,0x90,0x33,0x7f,0x20,0x30,0x22,0x20,
+	0x20,0x20,0x74,0x9b,0x08,0xef,0x20,0xe4,0x01,0x20,0x5f,0x00,0x3e,0xfe,0xf2,0xff,
+	0x00,0x07,0x01,0x1d,0x1b,0x20,0xa0,0x74,0xff,0x25,0xf9,0xff,0x3a,0x82,0xae,0x88,
+	0x02,0xfd,0x40,0x86,0x04,0x20,0x20,0xf4,0x66,0xf2,0xe9,0xe6,0x29,0x00,0x20,0xe5,
+	0x27,0x08,0x63,0x1f,0x65,0xd2,0xfa,0xff,0x51,0xfb,0xff,0x82,0x05,0x00,0x2d,0x0a,
+	0xff,0xcc,0x68,0xe5,0xfb,0xff,0x0c,0x19,0x92,0x0f,0x45,0x00,0x8c,0x74,0x73,0x07,
+	0x50,0x03,0x75,0x0b,0x57,0x04,0xbb,0x72,0x49,0xf3,0x08,0x9e,0x72,0x35,0x79,0x0b,
+	0x49,0xd9,0x22,0x3b,0x02,0x1b,0x01,0x59,0x12,0x1f,0x0c,0xad,0x02,0xf7,0xa5,0xd0,
+	0xfa,0x7b,0x13,0x78,0x32,0x3e,0x83,0xad,0x3a,0x21,0x02,0xa5,0x1b,0x29,0x01,0x01,
+	0x2d,0x04,0x3e,0xfb,0xc7,0x55,0x95,0x00,0x65,0x1b,0xb8,0x12,0x70,0xff,0x83,0xc0,
+	0x00,0x17,0x40,0x00,0x59,0xa1,0xff,0x8e,0xb8,0x55,0xbe,0xe0,0x03,0x84,0x22,0xff,
+	0x50,0x56,0x10,0x68,0x42,0x8e,0x55,0x17,0xff,0x60,0x21,0x00,0xc4,0x22,0x79,0x12,
+	0x7a,0xbf,0x66,0x7d,0x0a,0x62,0x06,0x00,0x47,0x01,0xa9,0xff,0x32,0xc6,0xff,0xff,
+	0x80,0x47,0xc0,0x00,0xff,0x18,0x40,0x49,0x32,0x00,0x29,0xa1,0x8e,0xf7,0xb4,0x52,
+	0x5e,0x30,0x04,0x00,0x22,0xa1,0x00,0xfb,0x04,0x40,0xf6,0x00,0x41,0xc3,0xff,0x20,
+	0x26,0xff,0x10,0x20,0x20,0xb1,0x20,0x25,0x20,0x4a,0x7f,0x22,0x22,0x02,0x00,0x30,
+	0x4a,0xc0,0x19,0x08,0xfd,0xb1,0x87,0x10,0x1e,0xd6,0x06,0x42,0x00,0x00,0xff,0xbc,
+	0x22,0x8e,0xb3,0x59,0x1f,0xe7,0x1f,0x7f,0x85,0x1b,0x3e,0x99,0x55,0x01,0x07,0x95,
+	0x00,0xff,0x8e,0x55,0x11,0x02,0x40,0x00,0xc4,0x30,0xff,0x2e,0x75,0x50,0x09,0x25,
+	0x02,0xaf,0x1a,0xff,0x8e,0x45,0x11,0x01,0x20,0x06,0x62,0x30,0xff,0x8e,0x92,0x41,
+	0x01,0x20,0x00,0x95,0x30,0xff,0x4e,0x82,0x39,0x8c,0x65,0x85,0xb8,0x11,0xff,0x6e,
+	0xa7,0x40,0x08,0x45,0x22,0x91,0x1a,0xff,0x5e,0x51,0x21,0x02,0x80,0x0c,0xac,0x20,
+	0xff,0x8e,0xa2,0x43,0xfe,0x00,0x02,0xb4,0x22,0xff,0x7e,0x86,0x20,0x41,0xfb,0xa2,
+	0xc8,0x20,0xff,0x7e,0x93,0x40,0x40,0xe1,0xa3,0xc8,0x20,0xff,0x5e,0x45,0xf3,0x08,
+	0x80,0x05,0x7e,0x20,0xff,0x4e,0x81,0xe2,0x04,0x06,0x09,0xa6,0x20,0xfe,0x5a,0x03,
+	0xa5,0x37,0x8e,0xb0,0x75,0x65,0x20,0xff,0x01,0x85,0x09,0x7e,0x86,0x74,0xe5,0x20,
+	0xdf,0x81,0xc9,0x08,0x7e,0x93,0x44,0x04,0xcc,0x20,0x7f,0x8e,0xb0,0x73,0x04,0x80,
+	0x0f,0x86,0x07,0x00,0xff,0x72,0x0e,0x06,0x05,0x86,0x20,0x7e,0xf6,0x3d,0x50,0x4c,
+	0x00,0xcc,0x20,0x7e,0xf3,0x4c,0x00,0x54,0x00,0xff,0xc4,0x02,0x18,0x8e,0xb0,0x71,
+	0x42,0x04,0xff,0x03,0x86,0x20,0x80,0xc1,0x17,0x84,0x02,0xdd,0x19,0xcc,0x00,0xe0,
+	0x4d,0x00,0xb3,0x05,0x41,0xfe,0xff,0xff,0x0c,0x75,0x50,0xb9,0x16,0x40,0x43,0xef,
+	0xa0,0x4e,0x44,0xf8,0x5d,0x03,0x8c,0x22,0x3e,0xff,0x00,0x08,0x06,0x02,0x02,0xa0,
+	0x3a,0x8e,0xff,0xb0,0x70,0x64,0x0a,0x01,0x84,0x2a,0xf0,0x6f,0x20,0x00,0x3d,0xf0,
+	0x7f,0x00,0xa4,0x47,0x11,0x00,0xdd,0x06,0x11,0x04,0x3e,0xb2,0x20,0x07,0x00,0xb0,
+	0x2a,0xf7,0x3e,0x92,0x30,0x07,0x14,0x07,0x02,0x03,0xa0,0xff,0x3a,0x3e,0x12,0x20,
+	0xa4,0x26,0x01,0xa0,0xbf,0x2a,0x5e,0xb2,0x00,0x06,0x26,0x17,0x00,0x5e,0xcb,0x92,
+	0x10,0x07,0x0c,0x82,0x07,0x04,0x17,0x00,0x02,0x00,0xe6,0x51,0x00,0xa0,0x2a,0x5c,
+	0x0a,0xfb,0x0e,0x51,0xde,0xff,0xff,0x0c,0x76,0x60,0xb9,0x16,0x50,0x54,0xa0,0xaf,
+	0x5e,0x45,0xf8,0x9e,0x7f,0x04,0x4e,0x7f,0x1c,0x84,0xe5,0x0c,0x7f,0x20,0xa5,0x7f,
+	0x08,0x11,0x04,0x4e,0xb3,0x20,0x3e,0x07,0x00,0xb0,0x2a,0x4e,0x93,0x30,0x07,0x0c,
+	0x7f,0x10,0xdf,0x4e,0x12,0x20,0xc4,0x28,0x5f,0x00,0x6e,0xb3,0x77,0x00,0x06,0x28,
+	0x17,0x00,0x6e,0x93,0x10,0x07,0x0c,0x8c,0x7f,0x00,0x17,0x08,0x02,0x00,0x51,0x00,
+	0x7f,0x0c,0x7f,0x06,0x44,0xff,0x88,0x03,0x07,0x01,0xc5,0x1b,0x4e,0xd8,0xfd,0x0c,
+	0xc3,0x01,0x65,0x1b,0x00,0x60,0xe3,0xc0,0xff,0x00,0xf3,0x3e,0x02,0x65,0x9e,0xe0,
+	0x02,0xff,0x84,0x22,0xad,0x02,0xbd,0x05,0xe5,0xe0,0xfd,0xff,0x06,0x00,0x02,0xcd,
+	0x05,0x65,0x11,0x00,0xdf,0x60,0x00,0xf3,0x2d,0x0a,0xb9,0x14,0x00,0x0c,0xff,0x02,
+	0x1d,0xf0,0x40,0xb0,0x60,0x8e,0xb5,0xff,0x51,0x03,0x20,0x01,0x84,0x30,0x8e,0xec,
+	0xbe,0xee,0x05,0xc6,0x30,0xee,0xe1,0x21,0xee,0x01,0xad,0x7f,0x30,0xc0,0xe2,0x36,
+	0x6e,0xa7,0x4d,0x29,0x02,0xff,0x90,0x22,0xee,0xd3,0x61,0x02,0x40,0x03,0xff,0xb0,
+	0x30,0x0e,0xbe,0xfb,0x88,0x45,0x84,0xff,0xac,0x11,0x3e,0x9b,0x2a,0x62,0x00,0x01,
+	0xff,0xac,0x22,0x4e,0xac,0x51,0xe2,0x47,0x2c,0xff,0x90,0x20,0xee,0xc2,0x51,0x02,
+	0x80,0x08,0xff,0xb4,0x20,0x9e,0x49,0x8e,0xde,0xe1,0x03,0xdf,0x7c,0x22,0x7e,0x9a,
+	0x20,0xbc,0x0d,0x99,0x50,0xfe,0x09,0x0a,0x2e,0xbb,0x23,0x0a,0x80,0x05,0xae,0xff,
+	0x20,0xbe,0x4b,0x82,0x04,0x06,0x0b,0x7e,0xd7,0x20,0x76,0xae,0x07,0x02,0x77,0x07,
+	0x0e,0x9a,0x86,0x7f,0xe5,0x20,0x80,0xcd,0x08,0x7e,0x99,0x07,0x02,0xab,0x09,0xc8,
+	0x07,0x0e,0x11,0x07,0x0a,0x10,0x07,0x0a,0xfd,0x6d,0x70,0x4a,0x0c,0xfb,0x60,0x4a,
+	0x08,0xc4,0x03,0x07,0x1a,0x77,0x7c,0xff,0xf0,0x09,0x0a,0x46,0xc7,0xff,0x0b,0x09,
+	0xff,0xbd,0x03,0x00,0x50,0xe3,0x2e,0xa2,0x34,0xbe,0x81,0x01,0xa4,0x22,0x4e,0xc4,
+	0x38,0xd4,0x0a,0x80,0xff,0x00,0xf3,0xe5,0x50,0x00,0x3d,0x0a,0x8c,0xbf,0xba,0xbd,
+	0x04,0x2e,0xa2,0x3c,0x6e,0x03,0xa5,0xff,0x1b,0xa5,0xcf,0xff,0x2d,0x03,0x50,0x00,
+	0xfd,0xf3,0x43,0x09,0x81,0x00,0xe6,0x34,0x02,0x46,0xff,0x4e,0x00,0x1c,0x08,0x47,
+	0xa8,0x02,0x46,0xff,0x4c,0x00,0x30,0x92,0xc0,0x00,0xa0,0xe3,0xe7,0xae,0x71,0x65,
+	0xa1,0x0b,0x25,0x00,0x56,0xd9,0x4b,0xfe,0x40,0x01,0x04,0x65,0xd9,0xff,0x40,0xb0,
+	0x04,0xff,0x4e,0x1b,0x10,0xa1,0xa0,0x02,0x54,0x30,0xff,0xad,0x02,0x9d,0x02,0x00,
+	0x14,0x40,0x00,0xff,0xd5,0xa1,0xd4,0x29,0x18,0x7e,0x99,0x0d,0xff,0xa2,0xbf,0x14,
+	0xcc,0x20,0xde,0xd3,0x2c,0xff,0x00,0x47,0x00,0xad,0x1b,0x1e,0x2d,0x7b,0xff,0x1f,
+	0xc7,0x1e,0xc1,0x1b,0x46,0xeb,0x00,0xff,0xee,0x4d,0xf1,0x02,0x80,0x81,0x7c,0x30,
+	0xfc,0x00,0x02,0x02,0x00,0x76,0xae,0xca,0x7e,0x99,0xdc,0xff,0x62,0x00,0x00,0xcc,
+	0x28,0x7e,0x99,0xe7,0xff,0x62,0x00,0x80,0xce,0x28,0x8e,0xb0,0x79,0xef,0x7a,0x00,
+	0x9d,0x86,0x07,0x00,0x7d,0x7a,0x00,0x7b,0x1d,0x84,0x07,0x00,0x72,0x2e,0x04,0x13,
+	0x0f,0x04,0xdf,0x77,0x2e,0x04,0x93,0x84,0x27,0x00,0xf4,0x78,0xf7,0x00,0x9a,0xce,
+	0x07,0x00,0x0c,0x78,0x00,0x1a,0xf6,0x37,0x04,0xed,0x7e,0x37,0x04,0x7e,0x99,0x1f,
+	0x7e,0xdc,0x47,0x04,0x4f,0x02,0x7c,0x00,0x03,0x37,0x04,0x7e,0x7c,0x7b,0x00,0x83,
+	0x37,0x04,0x79,0x7e,0x00,0x81,0x07,0x04,0xef,0x75,0x3a,0x04,0x1d,0x07,0x04,0x7f,
+	0x7e,0x00,0xbd,0x01,0x1f,0x04,0x7d,0x3a,0x04,0x9d,0x4f,0x04,0x1e,0xef,0x78,0x00,
+	0x1e,0xcc,0x4f,0x0c,0x9e,0xce,0x28,0xff,0xce,0xca,0xeb,0x71,0x60,0x9b,0xb4,0x08,
+	0xff,0xbe,0xca,0xc7,0xf1,0x60,0x1b,0xb7,0x08,0xff,0xce,0xca,0xb6,0x28,0x04,0x93,
+	0xb4,0x28,0x7f,0xbe,0xca,0x74,0x28,0x04,0x13,0xb6,0x1f,0x00,0xdf,0x63,0x90,0x26,
+	0x8b,0xb6,0x1f,0x00,0x42,0x10,0xe7,0x26,0x0b,0xb5,0x1f,0x00,0xa7,0x06,0xb4,0x3a,
+	0x94,0xef,0x2a,0x29,0x46,0xb4,0x47,0x1e,0x0c,0x07,0x4e,0xff,0x71,0x7c,0x9e,0xc0,
+	0x02,0x80,0x22,0xc7,0xff,0x27,0x02,0x46,0x5a,0x00,0x49,0x71,0x79,0xef,0x41,0x70,
+	0xf4,0xc0,0x22,0x01,0x8e,0xb5,0x1f,0xff,0xfe,0xe1,0x02,0xc4,0x22,0xf0,0xf1,0x21,
+	0xff,0xfe,0x71,0x50,0xc1,0xa0,0x00,0x80,0x30,0xd7,0x04,0x64,0x74,0x3f,0x09,0x17,
+	0x3f,0x05,0x1e,0x1d,0xfd,0x7e,0x3c,0x01,0xc0,0x20,0x46,0x49,0x00,0xf0,0xff,0xfd,
+	0x11,0xd0,0xe0,0x60,0x3e,0x00,0x00,0xff,0x53,0xf9,0xb4,0xa0,0x20,0xbe,0x5d,0x56,
+	0xff,0xe0,0x40,0x01,0xa4,0x22,0x8e,0xb6,0x61,0xff,0x82,0x81,0x15,0x84,0x20,0xbe,
+	0x62,0xe5,0xfb,0xa0,0x20,0x0f,0x00,0x4e,0x46,0xe0,0x51,0xf9,0xff,0xb1,0x7c,0x20,
+	0xde,0xf9,0xf0,0x50,0xe1,0x7b,0xb1,0xb0,0x07,0x00,0x10,0x52,0xe1,0xb5,0x07,0x04,
+	0xff,0x03,0xf1,0xe0,0x03,0xb3,0x08,0xde,0xf9,0xff,0x1f,0x71,0xe0,0x83,0xb0,0x08,
+	0x8e,0xb0,0xff,0x74,0xf0,0x00,0x03,0x87,0x08,0x3e,0x43,0xff,0x10,0x70,0x00,0x82,
+	0x60,0x08,0x30,0x8d,0xff,0xc0,0xde,0xf9,0x15,0x73,0xe0,0x81,0xb0,0xfe,0x22,0x00,
+	0x0f,0xf3,0xe0,0x01,0xb3,0x08,0xfe,0xff,0xca,0x50,0x09,0xb4,0x55,0xb4,0x20,0xee,
+	0xff,0xca,0xf2,0x93,0x26,0x89,0xb6,0x08,0x3e,0xff,0x36,0x73,0x13,0x26,0x08,0xc9,
+	0x08,0x76,0x7f,0xa4,0x3f,0xde,0xf9,0xec,0x71,0x00,0x2a,0x08,0xf7,0xfd,0xf1,0x00,
+	0x2a,0x00,0xde,0xf9,0x14,0x70,0x7b,0xe0,0x9f,0x0f,0x04,0x0e,0xf0,0xe0,0x1f,0x3a,
+	0x04,0xff,0x2f,0x72,0xc0,0x89,0xb4,0x08,0xde,0xca,0xdf,0x3c,0xf2,0xc0,0x09,0xb7,
+	0x0f,0x00,0xf2,0x93,0xff,0xc6,0x9d,0xb6,0x08,0xee,0xca,0xc3,0x13,0xd7,0xc6,0x1d,
+	0xb5,0x27,0x00,0x74,0x37,0x08,0x5e,0xf9,0x79,0xc6,0x47,0x08,0x7f,0x01,0x71,0x60,
+	0x99,0x84,0x07,0x00,0xdf,0x77,0xf1,0x60,0x19,0x87,0x2f,0x00,0x2c,0x72,0xde,0x77,
+	0x05,0xde,0xca,0x36,0xf2,0x77,0x05,0xfe,0xca,0xef,0xc5,0x92,0x46,0x8f,0x3f,0x04,
+	0x64,0x12,0x46,0xeb,0x0f,0xb5,0x0f,0x00,0x51,0xf5,0x00,0xb4,0x20,0x5e,0xf3,0xca,
+	0x40,0xed,0x00,0xa2,0x00,0x08,0xf0,0x53,0xf9,0xff,0xb5,0x58,0x20,0x0c,0x15,0x2b,
+	0x77,0xc7,0xff,0xa7,0x02,0x46,0xae,0xff,0x88,0x41,0x78,0xff,0x51,0x80,0x77,0x90,
+	0x98,0x71,0x9e,0xd7,0xed,0x75,0xab,0x02,0x61,0x1b,0xbc,0x02,0x20,0x92,0x20,0xe7,
+	0x20,0xa2,0x20,0x58,0x0d,0x4d,0x01,0xde,0xe1,0xe0,0xff,0x81,0xa0,0x01,0xa4,0x30,
+	0xde,0xcd,0x3b,0xfe,0x0c,0x03,0xad,0x1b,0xce,0xbb,0x5e,0xa2,0xbf,0xff,0x15,0xa4,
+	0x20,0xde,0xc1,0x21,0xe2,0xa3,0x3f,0x14,0xac,0x20,0x76,0xac,0xff,0x4c,0x03,0x5d,
+	0x09,0x54,0x47,0x02,0x67,0x00,0x84,0x45,0x01,0x50,0x55,0x11,0x90,0xe7,0x01,0xff,
+	0xb0,0x3a,0xde,0xf9,0x67,0x71,0x40,0x93,0xff,0xb0,0x08,0xbe,0xf9,0xc5,0xf1,0x40,
+	0x13,0x6d,0xb3,0xbf,0x00,0x79,0x70,0xc7,0x0c,0x76,0xf0,0xc7,0x04,0xda,0x37,0x08,
+	0xb5,0x3f,0x08,0x50,0xe1,0x07,0x0c,0x49,0xb4,0x7d,0x55,0x07,0x04,0x73,0x11,0x46,
+	0x0d,0x85,0x1f,0x00,0xdf,0x75,0x91,0x46,0x8d,0x86,0x2f,0x04,0xf1,0x60,0x3d,0x13,
+	0x2f,0x04,0x77,0x71,0x60,0x93,0x3f,0x04,0x77,0x00,0xa5,0x17,0x6f,0x04,0xf0,0x77,
+	0x00,0x6f,0x04,0x00,0x77,0x10,0x40,0x9e,0x77,0x08,0xbe,0xf9,0x9d,0xf1,0xa2,0x05,
+	0x27,0x00,0xf0,0xbd,0x40,0x37,0x08,0x7f,0x71,0xe0,0x81,0x37,0x04,0x74,0xfb,0x70,
+	0x40,0x3f,0x08,0x70,0x41,0xf9,0xb7,0x84,0x7f,0x20,0xfe,0xca,0x70,0x40,0xe1,0xb7,
+	0xc2,0x05,0x7d,0x60,0x97,0x0a,0xfe,0xca,0x52,0x61,0xe0,0x97,0x01,0xdf,0xbe,0xca,
+	0x3f,0xe1,0xe0,0x97,0x09,0x2e,0x81,0x7b,0xc6,0x83,0x57,0x05,0xfd,0x01,0xc6,0x03,
+	0x57,0x05,0x7d,0xe0,0x27,0x08,0xbe,0xca,0xd0,0x09,0xbc,0xfa,0x01,0xf7,0xde,0x41,
+	0x62,0xe8,0x0b,0xd0,0x00,0xf3,0x1d,0x7f,0xf0,0x00,0x88,0x17,0x7e,0x99,0x54,0x9f,
+	0x13,0xbd,0x6f,0x9f,0x13,0x72,0x6a,0x00,0x8d,0x4f,0x0b,0x6a,0x7b,0x00,0x0d,0x47,
+	0x07,0x79,0x3e,0x04,0x05,0x57,0x0b,0xf7,0x3e,0x04,0x85,0x4f,0x07,0x7c,0x68,0x00,
+	0x8a,0xde,0x8f,0x07,0xb4,0x68,0x00,0x0a,0x37,0x04,0x65,0x6e,0x7b,0x00,0x96,0x0f,
+	0x04,0xd7,0x6e,0x00,0x16,0x9f,0x07,0xef,0x7b,0x6c,0x00,0x1b,0x37,0x04,0x76,0x6c,
+	0x00,0xbd,0x9b,0x37,0x04,0x72,0x6e,0x00,0x97,0xef,0x0b,0x2a,0xbb,0x04,0x0d,0xe7,
+	0x0b,0x6e,0x00,0x17,0x1f,0x04,0x75,0x77,0x2a,0x04,0x8d,0x27,0x08,0x68,0x00,0x0f,
+	0x07,0x04,0xdf,0x74,0x68,0x00,0x8f,0x86,0x7f,0x07,0x71,0xe0,0xbd,0x8b,0xcf,0x04,
+	0x4f,0xf1,0xe0,0x0b,0x9f,0x07,0x3e,0xf7,0x38,0x04,0x85,0x9f,0x07,0xfc,0x38,0x04,
+	0x05,0xde,0x9f,0x07,0xeb,0x91,0x86,0x9b,0x9f,0x07,0xc9,0x11,0xeb,0x86,0x1b,0x9f,
+	0x07,0xb0,0x9f,0x13,0x99,0x6e,0xca,0xff,0xf7,0x01,0x27,0x01,0x45,0x1b,0xbd,0x03,
+	0xff,0xad,0x02,0xcd,0x04,0x65,0x95,0xff,0x06,0xff,0xcf,0xfe,0x00,0x36,0x81,0x00,
+	0xe6,0x34,0xff,0x02,0x46,0x50,0x00,0x1c,0x08,0x47,0xa8,0xff,0x02,0x46,0x4e,0x00,
+	0x30,0x92,0xc0,0x00,0xdf,0xa0,0xe3,0xae,0x71,0x65,0x06,0x09,0x50,0x00,0xff,0xf3,
+	0x56,0xd9,0x4d,0xad,0x02,0xbd,0x04,0xff,0x65,0x8a,0xff,0x40,0xb0,0x04,0xce,0x1b,
+	0xbf,0x10,0xa1,0xa0,0x82,0x54,0x30,0xaf,0x0b,0x14,0x7e,0x56,0x06,0xd4,0x29,0x18,
+	0x7e,0x99,0x0d,0xb2,0x03,0xff,0xcc,0x20,0xde,0xd3,0x2c,0x00,0x47,0x00,0xff,0xad,
+	0x1b,0x1e,0x2d,0x7b,0x1f,0xc7,0x1e,0xff,0xc1,0x1b,0x46,0xf1,0x00,0x0e,0xd2,0x8e,
+	0xff,0xbe,0xe1,0x02,0xbc,0x22,0x0e,0xa4,0x62,0xff,0xa2,0x87,0x24,0x90,0x20,0xf0,
+	0x20,0x00,0xee,0x02,0x00,0x76,0xae,0xca,0x57,0x01,0x02,0x80,0x00,0x7b,0xcc,0x20,
+	0x57,0x01,0x02,0x80,0x80,0xce,0x27,0x06,0xef,0x0a,0x80,0x8d,0x86,0x07,0x00,0x75,
+	0x0a,0x80,0xc9,0x0d,0x2f,0x06,0x57,0x01,0x81,0x07,0x04,0x57,0x01,0x01,0x86,0xbe,
+	0x27,0x00,0x7c,0x08,0x80,0x8a,0xce,0x07,0x00,0xb4,0xf7,0x08,0x80,0x0a,0x37,0x04,
+	0x65,0x0e,0x80,0x96,0xbe,0x0f,0x04,0xd7,0x0e,0x80,0x16,0xcc,0x27,0x00,0x7b,0xf7,
+	0x0c,0x80,0x1b,0x2f,0x04,0x76,0x0c,0x80,0x9b,0x9e,0x47,0x04,0x72,0x0e,0x80,0x97,
+	0x07,0x04,0x57,0x01,0x8d,0x4e,0x17,0x04,0x77,0x0e,0x80,0x5f,0x02,0x57,0x09,0x0d,
+	0x4f,0x04,0xef,0x16,0x08,0x80,0x0e,0x47,0x04,0x04,0x08,0x80,0xf7,0x8e,0xce,0x20,
+	0x57,0x01,0x11,0xe6,0x0b,0xb4,0xcd,0x1a,0x57,0x01,0x11,0xe7,0x07,0x00,0x57,0x09,
+	0x05,0xb6,0xad,0x20,0x57,0x09,0x85,0xb4,0x1f,0x00,0xeb,0x4f,0x05,0x10,0x74,0x57,
+	0x01,0x5f,0x05,0x10,0x57,0x21,0x46,0xba,0x00,0x00,0x08,0xff,0x0c,0x02,0x1d,0xf0,
+	0x0c,0x07,0x4e,0x71,0xff,0x7c,0x9e,0xc0,0x02,0x80,0x22,0xc7,0x27,0xff,0x02,0x46,
+	0x5e,0x00,0x49,0x71,0x79,0x41,0xf7,0x70,0xf4,0xc0,0x2a,0x01,0x8e,0xb5,0x1f,0xfe,
+	0xff,0xe1,0x02,0xc4,0x22,0xf0,0xf1,0x21,0xfe,0xff,0x71,0x50,0xc1,0xa0,0x00,0x80,
+	0x30,0x04,0x73,0x64,0x74,0x47,0x09,0x9e,0x0b,0x1e,0x1d,0x7e,0x44,0x01,0xdf,0xc0,
+	0x20,0x46,0x4d,0x00,0xa9,0x03,0xd0,0xe0,0xff,0x60,0x3e,0x00,0x01,0x82,0x81,0x14,
+	0xa0,0xff,0x20,0xbe,0x5d,0x56,0xe0,0x40,0x01,0xa4,0xff,0x22,0x8e,0xb6,0x65,0xa0,
+	0x20,0x01,0x84,0xef,0x22,0xbe,0x62,0xe0,0x21,0x03,0xa4,0x20,0x4e,0x2b,0x46,0xe0,
+	0x21,0x03,0x7c,0x21,0x03,0x70,0x99,0x13,0xa1,0x0f,0xde,0x69,0x07,0x67,0x13,0x84,
+	0x1a,0xf1,0x00,0x11,0x66,0x7e,0x07,0x00,0xde,0xf9,0xc0,0x53,0xf9,0xb5,0x49,0x07,
+	0xe7,0xd0,0x52,0xe1,0x07,0x00,0x49,0x02,0x10,0xc7,0x1b,0xff,0x84,0x1a,0x3e,0x43,
+	0x1c,0x10,0xc6,0x1a,0xff,0x60,0x1a,0x30,0x8d,0xc0,0xde,0xf9,0x15,0xef,0x13,0x66,
+	0x19,0xb0,0x2a,0x00,0x07,0x13,0x67,0xbe,0x07,0x00,0xfe,0xca,0x50,0x09,0xb4,0x0c,
+	0x03,0xee,0xff,0xca,0x72,0x13,0x26,0x09,0xb5,0x10,0x3e,0xff,0x36,0x73,0x93,0x26,
+	0x88,0xca,0x10,0x76,0xff,0xa4,0x3f,0xde,0xf9,0xec,0x11,0x06,0x01,0xee,0x2a,0x04,
+	0xfd,0x11,0x07,0x07,0x08,0x14,0x10,0xe6,0xdd,0x1f,0x07,0x04,0x0e,0x10,0xe7,0x07,
+	0x00,0xfe,0xca,0xff,0x2f,0x12,0xc6,0x09,0xb4,0x1a,0xde,0xca,0xf7,0x3c,0x12,0xc7,
+	0x07,0x00,0xfe,0xca,0xf2,0x13,0xff,0xc6,0x1d,0xb5,0x10,0xee,0xca,0xc3,0x93,0x7f,
+	0xc6,0x9d,0xb6,0x10,0xde,0xf9,0x74,0x37,0x08,0xe7,0x5e,0xf9,0xc6,0x47,0x08,0x9f,
+	0x01,0x11,0x66,0x19,0xfa,0xad,0x0c,0x67,0x07,0x00,0xfe,0xca,0x2c,0x12,0x66,0xdd,
+	0x1b,0x3f,0x04,0x36,0x12,0x67,0x07,0x00,0xfe,0xca,0xef,0xc5,0x12,0x46,0x0f,0x3f,
+	0x04,0x64,0x92,0x46,0xff,0x8f,0xb6,0x10,0xfe,0xca,0x51,0x82,0x81,0x3f,0x15,0xb4,
+	0x20,0x5e,0xca,0x40,0x05,0x01,0xa2,0x00,0xfd,0xf8,0x05,0x05,0x58,0x20,0x0c,0x15,
+	0x2b,0x77,0xff,0xc7,0xa7,0x02,0x46,0xaa,0xff,0x88,0x41,0xff,0x78,0x51,0x80,0x77,
+	0x90,0x98,0x71,0x9e,0xfb,0xd7,0x75,0xc3,0x02,0x61,0x1b,0x46,0x4c,0x00,0x3f,0x20,
+	0x92,0x20,0x20,0xa2,0x20,0x68,0x0d,0x5d,0x01,0xff,0xde,0xe1,0xe0,0x81,0xa0,0x01,
+	0xa4,0x30,0xff,0xde,0xcd,0x3b,0x01,0x07,0x01,0xad,0x1b,0xff,0xce,0xbb,0x5e,0xa2,
+	0xbf,0x15,0xa4,0x20,0xff,0xde,0xc1,0x21,0xe2,0xa3,0x14,0xac,0x20,0x3f,0x76,0xac,
+	0xff,0x8e,0xb0,0x71,0x67,0x00,0x2f,0x06,0x15,0x70,0x67,0x00,0x84,0x3d,0x01,0x50,
+	0x67,0x00,0x45,0x05,0x65,0x0d,0xff,0xde,0xf9,0x67,0x11,0x46,0x13,0xb0,0x1a,0x9f,
+	0xbe,0xf9,0xc5,0x11,0x47,0x07,0x00,0xaf,0x02,0x10,0xa6,0xc7,0x0c,0x76,0x10,0xc7,
+	0x04,0x37,0x08,0xb5,0x3f,0x08,0x50,0xdd,0xe1,0x07,0x0c,0x49,0xb4,0x55,0x07,0x04,
+	0x73,0x91,0xef,0x46,0x8d,0x86,0x10,0x87,0x02,0x11,0x46,0x0d,0xc5,0x85,0x07,0x00,
+	0x76,0xad,0x29,0x77,0x08,0xa7,0x02,0xde,0xf9,0xa9,0xf0,0x77,0x00,0x6f,0x04,0x00,
+	0x77,0x10,0x40,0x77,0x08,0xbe,0xef,0xf9,0x9d,0x11,0xe7,0x37,0x09,0x71,0x10,0x47,
+	0xde,0x2f,0x08,0x7f,0x11,0xe6,0x01,0x07,0x04,0x74,0x10,0xfd,0x46,0x0f,0x08,0x70,
+	0x41,0xf9,0xb7,0x84,0x20,0xbf,0xfe,0xca,0x70,0x40,0xe1,0xb7,0xc2,0x05,0x60,0xbe,
+	0xa7,0x0a,0xfe,0xca,0x52,0x01,0xe6,0x8f,0x01,0xbe,0xef,0xca,0x3f,0x01,0xe7,0x97,
+	0x09,0x2e,0x01,0xc6,0xbd,0x03,0x57,0x05,0xfd,0x81,0xc6,0x83,0x57,0x05,0xe0,0xbe,
+	0x27,0x08,0xbe,0xca,0xd0,0x09,0xbc,0xfa,0x01,0xde,0xfb,0x41,0x62,0x3c,0x01,0x81,
+	0x1b,0xd0,0x00,0xf3,0x7f,0x1d,0xf0,0x00,0x89,0x17,0x1e,0xa2,0xc0,0x03,0x57,0x32,
+	0x90,0x20,0xb7,0x3f,0x72,0xb7,0x3f,0x85,0xb7,0x13,0x71,0x05,0xb7,0xff,0xb7,0x37,
+	0x27,0x00,0x08,0x80,0x0f,0x0f,0x04,0xdf,0x74,0x08,0x80,0x8f,0x86,0xb7,0xe7,0x5e,
+	0xc2,0xff,0xf7,0x01,0x27,0x01,0x45,0x1b,0xbd,0x03,0xff,0xad,0x02,0xcd,0x04,0x65,
+	0x44,0xff,0x06,0xff,0xc7,0xfe,0x00,0xf0,0x33,0x11,0x30,0x31,0xff,0x41,0x20,0xa3,
+	0x20,0x16,0x7a,0x09,0x9c,0x7f,0x83,0xa0,0xf3,0x40,0xae,0x4a,0x58,0x23,0x02,0xff,
+	0x7d,0x1b,0x00,0x1a,0x40,0xa0,0x88,0xc0,0xff,0x20,0x33,0x81,0x00,0x22,0xa1,0xc6,
+	0x39,0xf7,0x00,0xa0,0xf2,0x19,0x04,0x1d,0x07,0x1f,0x7d,0xf9,0x1b,0x16,0x00,0x1c,
+	0x00,0x96,0xba,0x00,0x8e,0x32,0xff,0x12,0x00,0x07,0x00,0xc5,0x1b,0x06,0x32,0xdf,
+	0x00,0x00,0x20,0x30,0x91,0x28,0x00,0x86,0x2f,0xff,0x00,0xf0,0x55,0x11,0x50,0x51,
+	0x41,0x40,0xff,0xa5,0x20,0x16,0x6a,0x04,0x9c,0x85,0xa0,0xf5,0xf5,0x36,0x00,0x59,
+	0x50,0x18,0x99,0xc0,0x40,0x55,0xff,0x81,0x00,0x44,0xa1,0x46,0x26,0x00,0xa0,0xe9,
+	0xf4,0x19,0x04,0x50,0x0c,0x99,0x50,0x08,0xaa,0x00,0x8e,0xfb,0x54,0x14,0x50,0x08,
+	0x86,0x1e,0x00,0x40,0x50,0x6d,0x91,0x27,0x04,0x1c,0x00,0x00,0x00,0x7e,0x3f,0x67,
+	0x04,0xff,0x49,0x1b,0x10,0x33,0x01,0xc6,0x6a,0x00,0xff,0xcc,0x34,0xf0,0x85,0x11,
+	0xbc,0x18,0x67,0xff,0xc5,0x0b,0x40,0x85,0x11,0x40,0x88,0x20,0xff,0x8c,0x28,0x3d,
+	0x05,0x2d,0x04,0x40,0x83,0xff,0x11,0x20,0x88,0x20,0xdc,0xa8,0x70,0x7f,0xfd,0x05,
+	0xd2,0x00,0x00,0x41,0x40,0x30,0x37,0x81,0xfb,0x86,0x5f,0x3c,0x00,0x56,0xf2,0xfd,
+	0xf0,0x83,0xff,0x11,0x56,0x98,0xfd,0x3d,0x05,0x41,0xb4,0xbf,0xb9,0x40,0x33,0x20,
+	0x06,0x5a,0x53,0x04,0x36,0xff,0x41,0x00,0x61,0xb1,0xb9,0x50,0x73,0x30,0xff,0x67,
+	0x43,0xad,0x67,0x45,0xd9,0x30,0x84,0xff,0xa5,0x50,0x94,0xa5,0x16,0xf8,0xee,0x16,
+	0xff,0xd9,0xf3,0x9a,0x88,0x20,0xc0,0xf5,0x60,0xff,0x55,0x20,0x60,0x33,0x20,0x40,
+	0xd0,0xf5,0xff,0xa1,0xa8,0xb9,0x79,0x11,0x40,0xbc,0xc1,0xff,0xa0,0x55,0x10,0xa0,
+	0x33,0x10,0xd0,0xa2,0xff,0xc1,0x50,0xf0,0xf5,0x30,0xe0,0xf5,0xba,0xef,0xaa,0xbe,
+	0xca,0x79,0x95,0x00,0x61,0x1b,0x92,0xff,0xc9,0x01,0x10,0x40,0x40,0xa0,0x69,0x81,
+	0xff,0x40,0xb2,0xc1,0x00,0xaa,0xa1,0xba,0xaa,0xff,0xb7,0xba,0x02,0x62,0xc6,0x01,
+	0x50,0xb2,0xdf,0xc1,0xba,0x66,0xbe,0xc6,0x23,0x18,0xd0,0xbc,0xff,0xc1,0xb0,0x66,
+	0x80,0xb7,0xb6,0x01,0x1b,0xe7,0x99,0x40,0xb3,0x1a,0x00,0x09,0x08,0x8c,0x3a,0x0c,
+	0xff,0x1b,0xb0,0x66,0x20,0x40,0xbe,0xc1,0xf0,0xff,0x72,0xc1,0x70,0xbb,0x80,0x7e,
+	0xcb,0x7a,0xbe,0x2f,0x08,0xa2,0xca,0x01,0x50,0x7c,0x10,0x04,0x77,0xfb,0xbb,0x02,
+	0x0b,0x00,0xd0,0x73,0xc1,0x7a,0xbb,0xfe,0x0a,0x0c,0xb0,0xaa,0x81,0x9a,0xaa,0x00,
+	0xbb,0xf9,0xa1,0x4b,0x08,0x10,0x04,0xf0,0x2c,0xc1,0xaa,0x22,0xfb,0xae,0xc2,0x67,
+	0x18,0x50,0xa3,0xc1,0xa0,0x22,0xaf,0x80,0xa7,0xb2,0x02,0x73,0x04,0xae,0x0b,0x1c,
+	0xf0,0xcf,0xb3,0xc1,0x50,0x7e,0x63,0x30,0x4c,0x14,0xba,0x22,0xff,0xb7,0xb2,0x01,
+	0x1b,0xaa,0xf0,0x3e,0xc1,0xff,0xae,0x33,0x24,0x01,0xa7,0x01,0xad,0x1b,0xff,0x30,
+	0x59,0x41,0x72,0x21,0x01,0x56,0x75,0xff,0x00,0x4e,0x44,0x18,0x1e,0xe1,0x02,0x60,
+	0xff,0x22,0x8e,0xb4,0x54,0x1f,0xe7,0x07,0x85,0x7f,0x1b,0x40,0x88,0xc0,0xf0,0x44,
+	0x11,0x16,0x02,0xff,0x60,0x22,0x81,0x00,0x66,0xa1,0x47,0xb8,0xff,0x31,0xd6,0xa6,
+	0x00,0x22,0xc2,0x01,0xac,0xff,0x02,0xf0,0x66,0x11,0x16,0xf6,0x00,0xc0,0xef,0x88,
+	0x01,0x8a,0x33,0x84,0x01,0x10,0x77,0x01,0xff,0x70,0x33,0x20,0x1d,0xf0,0x20,0x21,
+	0x41,0xbf,0xf0,0x22,0x11,0x86,0xf9,0xff,0x73,0x01,0xee,0xff,0xf0,0xf3,0x60,0x20,
+	0x01,0x44,0x22,0x96,0xff,0xc8,0x00,0x1b,0x84,0xc0,0x38,0x01,0xde,0xef,0xf5,0xf2,
+	0x00,0x07,0x90,0x02,0x80,0x80,0x60,0xff,0x9d,0x06,0x00,0x08,0x40,0xf6,0xc8,0x0c,
+	0xff,0x00,0x62,0xa1,0x20,0x23,0x81,0x30,0x30,0xff,0x91,0x06,0x05,0x00,0x00,0xf6,
+	0xd8,0x20,0xff,0x00,0xa2,0xa1,0x20,0x63,0x81,0x3e,0x23,0xf5,0xe3,0x28,0x00,0xa5,
+	0x28,0x02,0x20,0xee,0x89,0xf8,0xfe,0xbd,0x00,0x55,0x1b,0x0c,0x19,0x90,0x66,0x20,
+	0xd7,0x46,0xe0,0xff,0x1b,0x26,0xe3,0x64,0x00,0x36,0x21,0xff,0x00,0x61,0x3b,0xb9,
+	0x67,0x43,0x26,0x30,0xff,0x44,0xa5,0x60,0x53,0x95,0x50,0x44,0xc0,0xff,0xe6,0xc4,
+	0x26,0xa6,0x14,0x2f,0x60,0x73,0xff,0x20,0x10,0x45,0x40,0x20,0x57,0x81,0x00,0xff,
+	0x14,0x40,0x50,0x50,0x91,0x50,0x20,0x60,0xf7,0x70,0x25,0xb3,0xe9,0x03,0x40,0x43,
+	0x11,0x20,0xff,0x44,0x20,0x16,0x24,0x00,0x32,0xa0,0x00,0xff,0x50,0x46,0x11,0x0b,
+	0x54,0x30,0x45,0xb3,0x3f,0x2d,0x04,0x1d,0xf0,0x0c,0x02,0x1c,0x00,0x27,0x0e,0xf7,
+	0x7e,0x29,0x94,0x7d,0x00,0x15,0x1b,0x00,0x04,0xbf,0x40,0x2e,0x83,0xe9,0x00,0x87,
+	0x88,0x00,0x00,0xff,0x09,0x40,0x80,0x80,0x74,0x8a,0x87,0x82,0xff,0x08,0x00,0x20,
+	0x60,0x91,0x6e,0x60,0xe9,0xf9,0x02,0x83,0x04,0x15,0x00,0x20,0x50,0x91,0x6a,0x67,
+	0xff,0x62,0x06,0x00,0x5e,0x50,0xe9,0x02,0x87,0xfe,0x12,0x10,0x30,0x91,0x5a,0x57,
+	0x52,0x05,0x00,0xff,0x30,0x30,0x74,0x3a,0x37,0x32,0x03,0x00,0x3f,0x6a,0x28,0x5a,
+	0x22,0x3a,0x22,0x5d,0x0c,0xaf,0x04,0xff,0x01,0x39,0x11,0x29,0x01,0x59,0x31,0x49,
+	0xff,0x21,0x7d,0x04,0xad,0x02,0x6d,0x03,0x16,0xff,0xe5,0x10,0x57,0xb3,0x09,0x2e,
+	0x00,0x03,0xfe,0xd6,0x00,0xa1,0x1b,0x1d,0xf0,0xa9,0xa1,0x40,0xff,0xf5,0x40,0xdc,
+	0x14,0x37,0x35,0x05,0x77,0x7f,0xb2,0x02,0x86,0x6d,0x00,0x2e,0x01,0x19,0x14,0xff,
+	0x2c,0x02,0x40,0x22,0xc0,0x29,0xb1,0x00,0x7f,0x02,0x40,0x30,0x20,0x91,0xad,0x02,
+	0xd8,0x00,0xff,0x70,0x55,0x81,0x50,0x30,0xf5,0xbd,0x03,0xff,0x25,0xee,0xf6,0xbd,
+	0x03,0x98,0xb1,0xa9,0xfd,0xd1,0x13,0x00,0xa2,0x61,0x17,0x00,0x86,0xa1,0xfb,0x68,
+	0xa1,0x20,0x00,0x09,0x40,0x60,0x60,0x91,0xff,0x80,0x66,0x20,0xe5,0x43,0x00,0xb2,
+	0x21,0xfd,0x17,0xb4,0x02,0x60,0xca,0x81,0x2d,0x0c,0x50,0xff,0xa0,0xf4,0xa9,0xc1,
+	0xb0,0xaa,0x82,0xae,0xff,0xcc,0x8d,0x7e,0xe1,0x03,0x60,0x22,0xd9,0xff,0xd1,0xca,
+	0x25,0x57,0x32,0x0c,0xa7,0xb2,0xff,0x09,0x2e,0x25,0x2e,0x7e,0xc1,0x03,0xac,0xff,
+	0x22,0xe9,0xd1,0xbd,0x03,0xa0,0x22,0xc0,0xff,0xad,0x02,0xa5,0xe8,0xf6,0xa2,0x61,
+	0x19,0x5f,0xa2,0x61,0x18,0xbd,0x03,0x0c,0x00,0x3f,0x45,0x00,0xff,0x19,0xc2,0x21,
+	0x18,0x60,0xd0,0xf4,0x00,0xff,0xea,0x11,0xa8,0xc1,0xe0,0xdd,0x20,0x3d,0xff,0x0d,
+	0xc0,0xaa,0x82,0xa7,0xbd,0x14,0xda,0xdf,0x35,0x5e,0xe3,0xfb,0x9e,0x37,0x06,0xa7,
+	0xb3,0xdf,0x07,0x3e,0x35,0x2b,0x9e,0x46,0x04,0x28,0xd1,0xf7,0xa0,0x33,0xc0,0x91,
+	0x00,0x00,0x22,0x11,0x20,0xdf,0x2b,0x20,0x00,0xb7,0xa1,0x43,0x08,0xb7,0x33,0xff,
+	0x13,0xb0,0x83,0xc0,0x56,0x68,0x0d,0x98,0xfd,0xa1,0x1b,0x04,0x99,0xa1,0xa7,0x39,
+	0x02,0x06,0xff,0x32,0x00,0x3e,0x00,0x02,0x5e,0xe0,0x02,0xfd,0xa0,0x27,0x05,0x29,
+	0xa1,0x47,0x33,0x02,0x06,0xff,0x33,0x00,0x90,0xf4,0x40,0x8c,0xa9,0x00,0xdf,0x19,
+	0x40,0x00,0x44,0xa1,0x7f,0x02,0x00,0x22,0xff,0xa1,0xad,0x03,0x40,0x50,0xf5,0xbd,
+	0x05,0xff,0xf0,0x20,0x00,0x25,0xdf,0xf6,0x6d,0x0a,0x7f,0xa2,0x61,0x15,0xbd,0x05,
+	0xad,0x03,0x0e,0x00,0xbf,0xe5,0x35,0x00,0x40,0x70,0xf4,0xe0,0x00,0xb2,0xff,0x21,
+	0x15,0x20,0xaa,0x81,0x3d,0x0a,0xb0,0xff,0xc7,0x82,0xc7,0xba,0x14,0x4a,0x3a,0x4e,
+	0xd7,0xe3,0xf6,0x7e,0x95,0x04,0xc7,0x95,0x00,0x34,0x26,0xfe,0xdc,0x08,0xbd,0x05,
+	0x62,0x61,0x16,0xc0,0x33,0xad,0xc0,0x38,0x08,0xa5,0xda,0x47,0x08,0x14,0x47,0x10,
+	0x65,0xfd,0x31,0xe2,0x00,0x16,0xc2,0x21,0x14,0x00,0xaa,0xff,0x11,0x20,0xd0,0xf4,
+	0xa0,0xad,0x20,0x60,0xff,0xd7,0x82,0xd7,0xba,0x1e,0x4a,0xaa,0x4e,0xef,0xea,0x9c,
+	0xde,0xe0,0x2c,0x01,0xd7,0xba,0x11,0xff,0x0e,0x3b,0xc2,0xde,0xc0,0x02,0xac,0x22,
+	0xe7,0x3e,0x22,0x33,0xa4,0x0a,0xb1,0x00,0x2b,0x11,0x2e,0x8d,0x2c,0x0c,0x14,0x0c,
+	0x03,0xea,0x09,0xd0,0x1d,0xf7,0x0d,0x4e,0xf7,0xb4,0x3a,0x01,0x20,0x04,0x65,0xd3,
+	0xf6,0x70,0xff,0x7a,0x83,0x4d,0x07,0xb0,0xf7,0x40,0xdc,0x7f,0x7b,0x70,0x36,0xc0,
+	0x7e,0x50,0xf8,0x17,0x00,0xff,0x49,0x1b,0x89,0x91,0x70,0x70,0xf4,0x06,0xfd,0x2d,
+	0x2c,0x0c,0x00,0x28,0xa1,0x8e,0xbb,0x58,0xff,0x04,0x07,0x01,0x85,0x1b,0xb0,0x88,
+	0xc0,0xe7,0x00,0x47,0xa1,0xf7,0x00,0x2f,0x03,0x60,0x70,0x91,0xff,0xad,0x07,0x00,
+	0x1b,0x40,0x20,0x36,0x81,0xfb,0xbd,0x05,0x0f,0x01,0xa5,0xce,0xf6,0xa9,0x81,0xbb,
+	0xa9,0xe1,0xbc,0x00,0x07,0xe5,0x25,0x01,0x11,0xb8,0xff,0xe1,0x30,0xca,0x81,0x6d,
+	0x0c,0xb0,0xa7,0x7f,0x82,0xa7,0xbc,0x19,0x4e,0x6c,0x29,0xe2,0x01,0xff,0xac,0x22,
+	0x99,0x81,0x47,0x36,0x0c,0xa7,0x5f,0xb6,0x09,0x6e,0x64,0x2c,0x03,0x09,0xc9,0x3f,
+	0x00,0x7f,0xa0,0x66,0xc0,0xad,0x06,0xa5,0xca,0xe0,0x01,0xf7,0x10,0xa9,0xf1,0x42,
+	0x00,0x06,0xa5,0x21,0x00,0xff,0xb8,0x81,0xc2,0x21,0x10,0x00,0x8a,0x11,0xff,0x30,
+	0xf0,0xf4,0xd8,0xf1,0x80,0xff,0x20,0xff,0xad,0x0f,0xd0,0xe7,0x82,0xe7,0xbf,0x14,
+	0xbf,0x4a,0xaf,0x4e,0xea,0xfc,0xbe,0x48,0x05,0xe7,0xbf,0xba,0x07,0xae,0xa4,0x2c,
+	0xbe,0x44,0x04,0xe0,0xff,0x3a,0xc0,0x00,0x9b,0x11,0x90,0x9c,0x20,0xff,0x99,0x91,
+	0xad,0x03,0xbd,0x05,0xe5,0xc5,0xba,0x4a,0x09,0x12,0x4a,0x05,0xe5,0x1c,0x00,0x8c,
+	0x09,0x12,0xec,0x8c,0x7d,0x89,0x09,0x25,0xc2,0x86,0x00,0x11,0xa2,0x61,0xdd,0x13,
+	0x3c,0x04,0x25,0x19,0x00,0x7e,0x05,0xb0,0xf4,0xff,0xa0,0xab,0x20,0xb2,0x21,0x13,
+	0xc2,0x21,0xe3,0x11,0xb0,0x84,0x1d,0xb1,0x0a,0x84,0x05,0x36,0xc2,0x7e,0x7d,0xc1,
+	0x84,0x01,0x30,0x22,0x20,0x38,0x91,0x63,0x09,0xff,0x38,0x91,0x00,0x26,0x11,0x20,
+	0x2c,0x20,0xfc,0x70,0x11,0xc7,0x03,0xad,0x02,0xbd,0x03,0xe5,0xaf,0xff,0xf6,0x30,
+	0x3a,0x82,0x30,0x32,0xc0,0x2d,0xfd,0x0a,0xdf,0x1b,0x81,0x32,0xb8,0x82,0x28,0x7f,
+	0xff,0x21,0x31,0xb8,0x26,0x08,0x0c,0xa8,0x02,0xff,0xe0,0x0a,0x00,0x22,0xc2,0xfc,
+	0xa8,0x02,0xe7,0x66,0x0a,0xf4,0x21,0x04,0x1f,0x00,0x16,0x02,0x08,0xff,0x16,0xd4,
+	0x07,0x0c,0x0b,0xb2,0x44,0x00,0xbf,0xa6,0x13,0x68,0xbe,0xeb,0x38,0xd9,0x09,0xae,
+	0x77,0x00,0x0d,0x01,0xd0,0x05,0xce,0x07,0x07,0xd8,0x09,0xff,0x76,0xa5,0x3d,0xa6,
+	0x88,0x0b,0x1b,0xaa,0xdf,0x4a,0x6a,0xbe,0x86,0x08,0x11,0x00,0x81,0x1b,0xff,0x70,
+	0xf5,0xc0,0x9e,0x42,0x0f,0xfe,0xe1,0xff,0x02,0x80,0x22,0x00,0x0f,0x40,0x80,0xfc,
+	0xff,0xc0,0x90,0x90,0x91,0x0e,0x09,0x57,0xe0,0xff,0x20,0x01,0x60,0x22,0x4a,0x9a,
+	0x62,0x09,0xff,0x00,0x00,0x1f,0x40,0x00,0xfd,0xa1,0xf0,0xff,0x66,0x20,0x62,0x49,
+	0x00,0x1b,0x88,0x2e,0xff,0x42,0x4e,0xc0,0x21,0x00,0x60,0x22,0xee,0xfb,0x03,0x37,
+	0x60,0x00,0x95,0x1b,0x50,0x63,0x82,0xff,0x7b,0x26,0x60,0x26,0xb3,0x20,0x23,0x21,
+	0x7f,0x1d,0xf0,0x22,0xa8,0x30,0x1d,0xf0,0x8b,0x00,0xff,0x78,0x02,0x74,0x00,0x42,
+	0x3e,0x80,0x05,0xfe,0x21,0x00,0xb1,0x1b,0x59,0x04,0x98,0x12,0x8e,0xfc,0x15,0x02,
+	0x7e,0x04,0x97,0xa7,0x22,0x68,0x02,0x64,0xff,0x18,0x43,0x8e,0xb0,0x70,0x40,0x85,
+	0x01,0xff,0x84,0x2a,0x8c,0x8a,0x64,0x08,0x43,0x34,0xf7,0x00,0xc2,0x79,0x23,0x00,
+	0x1b,0x77,0xde,0xfe,0xbf,0xf8,0x00,0x81,0x01,0x44,0x22,0x43,0x08,0x6e,0x7b,0x34,
+	0x06,0x9f,0x00,0x55,0x1b,0x9e,0xff,0xa7,0x04,0xff,0xa1,0x1b,0x16,0x34,0x02,0x26,
+	0x14,0x02,0xff,0x76,0x94,0x1d,0x72,0x03,0x00,0x20,0xb0,0xff,0x04,0xad,0x08,0x20,
+	0x21,0x41,0xb0,0xa9,0xff,0x93,0xa0,0x77,0xc0,0x70,0x77,0x82,0x7a,0xff,0x66,0x6e,
+	0x60,0xe3,0x60,0x20,0x01,0x48,0xff,0x22,0x46,0x00,0x00,0x0c,0x06,0x60,0x23,0xfd,
+	0x41,0x43,0x00,0x21,0x00,0xb6,0x23,0x2d,0x50,0xff,0xf2,0x40,0x40,0xf3,0x40,0x47,
+	0xb5,0x1a,0xfb,0x50,0x44,0xd5,0x0b,0x33,0xa1,0x66,0x14,0x02,0xff,0x00,0x20,0x00,
+	0x76,0x94,0x08,0x37,0x32,0x7f,0x02,0x30,0x22,0xc0,0x30,0x31,0x41,0x08,0x0c,0xf6,
+	0x47,0x05,0xcc,0x53,0x6c,0x01,0x44,0x49,0x56,0x30,0x73,0x0c,0x02,0x78,0x09,0x43,
+	0x00,0x3e,0x50,0xf9,0xc6,0x00,0xff,0x49,0x1b,0x20,0x40,0xf5,0x50,0x62,0xc1,0xff,
+	0x30,0xb4,0xc1,0xb0,0x66,0x80,0xb7,0xb6,0xef,0x02,0x92,0xc9,0x01,0x2c,0x02,0x60,
+	0x99,0x81,0xff,0x30,0xb2,0xc1,0x00,0x66,0xa1,0xba,0x66,0xff,0xb7,0xb6,0x01,0x1b,
+	0x99,0x50,0x34,0xc1,0xef,0x9a,0x33,0x2d,0x06,0x3b,0x14,0xbc,0x92,0x1e,0xed,0x03,
+	0x77,0x05,0x41,0x1b,0x0f,0x0c,0x16,0x92,0x02,0xff,0x20,0x7f,0x05,0x20,0x21,0x60,
+	0x40,0xf2,0xfd,0x40,0x8c,0x04,0x52,0xa1,0x50,0x3b,0x41,0x3e,0xff,0x25,0xa5,0x03,
+	0xc7,0x08,0xad,0x1b,0x40,0xff,0x55,0xc0,0xc0,0x55,0x01,0x10,0x77,0x01,0x9f,0x5a,
+	0x33,0x70,0x33,0x20,0x92,0x0f,0x87,0x17,0xac,0x07,0xab,0x08,0xc7}; /** Size:77549 **/
+
@@ -0,0 +1,15 @@
+/** ia61x_route.py autogen header file, source voicewake_i2c.route **/
+
+const uint16_t VOICEWAKE_ROUTE[] = {
+	0x5052,0x0001,0x000a,0x943e,
+	0x8000,0x0000,0x0000,0x0a01,  /* SYNC */
+	0x8033,0x0000,0x0000,0x0005,  /* STOP_ROUTE */
+	0x8015,0x0c14,0x0c14,0x0001,  /* SET_DIGITAL_GAIN */
+	0x8030,0x0001,0x0001,0x0001,  /* SAMPLE_RATE */
+	0x8035,0x0010,0x0010,0x0001,  /* FRAME_SIZE */
+	0x8032,0x0006,0x0006,0x0001,  /* SELECT_ROUTE */
+	0x8017,0x5008,0x5008,0x0001,  /* SET_ALGO_PARAM_ID */
+	0x8018,0x0005,0x0005,0x0401,  /* SET_ALGO_PARAM */
+	0x8017,0x5003,0x5003,0x0001,  /* SET_ALGO_PARAM_ID */
+	0x8018,0x0000,0x0000,0x0401   /* SET_ALGO_PARAM */
+}; /** Steps:10 **/
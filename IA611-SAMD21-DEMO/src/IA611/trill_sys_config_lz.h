@@ -0,0 +1,46 @@
+/** ia61x_lz.py autogen header file, source trill_sys_config.h **/
+
+#define SCFG_LZ_RAW_SIZE 1488
+
+const uint8_t SCFG_lz[] = {
+	0xff,0x41,0x55,0x44,0x49,0x45,0x4e,0x43,0x45,0xff,0x00,0x02,0x00,0x00,0xcb,0xa4,
+	0xcf,0x62,0xeb,0x05,0x00,0x00,0x0c,0x17,0x03,0x00,0xf0,0x22,0x00,0xdf,0x20,0xe7,
+	0x80,0x06,0x20,0x0f,0x04,0x01,0x01,0xff,0x5d,0x46,0xe9,0xce,0x1e,0xd7,0x11,0xed,
+	0xff,0x87,0xb2,0xa4,0xbb,0x6d,0x8b,0xae,0x61,0xbf,0x00,0x00,0x8c,0x28,0x00,0x20,
+	0x2e,0x10,0x00,0xff,0x56,0x65,0x72,0x3a,0x45,0x58,0x50,0x5f,0xff,0x49,0x41,0x36,
+	0x31,0x30,0x5f,0x41,0x31,0xdf,0x31,0x30,0x2e,0x39,0x39,0x02,0x00,0x5f,0x42,0xfd,
+	0x39,0x00,0x04,0x5f,0x4b,0x4e,0x5f,0x56,0x51,0xf5,0x00,0x00,0x2c,0x74,0x03,0x00,
+	0xc8,0x20,0x00,0x20,0xff,0xf9,0x4d,0x45,0x4d,0xc0,0x0e,0x16,0x02,0xa9,0x03,0x0f,
+	0x00,0x03,0x04,0x01,0x03,0x00,0x05,0x07,0x10,0x02,0xfe,0x03,0x10,0xaf,0x01,0xfa,
+	0x01,0x41,0x00,0x8c,0x3f,0x00,0x06,0x00,0x0f,0x00,0x3e,0x25,0x00,0x1b,0x04,0xc7,
+	0x10,0x00,0x0c,0x1b,0x08,0x00,0x24,0x17,0x04,0x01,0x0d,0x57,0x01,0x00,0x40,0x07,
+	0x00,0x07,0x03,0x00,0x0b,0x17,0x10,0xd9,0x0f,0x1b,0x10,0x00,0x08,0x77,0x01,0x37,
+	0x08,0x80,0xbb,0xe6,0x5b,0x0c,0x00,0x7d,0x4b,0x04,0x0f,0x00,0x3e,0x00,0x00,0xfd,
+	0x09,0x07,0x00,0x0a,0x10,0x04,0x00,0xd3,0x75,0x5b,0xb5,0xd3,0x3f,0x04,0x54,0x26,
+	0xe3,0x00,0x02,0xe6,0x0c,0xf5,0x84,0x9c,0x00,0x78,0x07,0x00,0x04,0x00,0x04,0x04,
+	0x38,0x7a,0x00,0x50,0x08,0x19,0x04,0x40,0x9c,0x71,0x86,0x10,0x06,0x00,0xf9,0x08,
+	0x3f,0x00,0x15,0x00,0x59,0x00,0x41,0x00,0x81,0x92,0x01,0x00,0x19,0x3a,0x05,0x03,
+	0x08,0x01,0x03,0x14,0x01,0x10,0x90,0xa4,0x8e,0x18,0x9b,0x24,0x01,0x03,0x40,0xdb,
+	0x24,0x10,0x0f,0x20,0x0d,0xfc,0x13,0x10,0x07,0x14,0xe8,0x03,0x02,0x00,0x81,0x01,
+	0x8e,0x37,0x30,0x20,0x04,0x20,0x0f,0x0c,0x01,0x4c,0x85,0x04,0x54,0xed,0x23,0xc7,
+	0x1d,0x33,0x33,0x04,0x00,0x1e,0x01,0x02,0xab,0x00,0x58,0x03,0x00,0x52,0x03,0x00,
+	0x4c,0x03,0x00,0x49,0xfa,0x03,0x00,0x46,0x03,0x00,0x43,0x01,0x02,0x80,0x41,0x7d,
+	0x01,0x92,0x09,0x04,0x50,0x02,0x02,0x00,0xd8,0x0c,0x51,0x00,0x09,0x00,0x03,0x09,
+	0x67,0x04,0xc8,0x03,0x00,0x75,0x03,0x00,0xbd,0x4c,0x53,0x04,0xff,0x00,0xff,0x01,
+	0x50,0x12,0xda,0xb3,0x77,0x01,0x07,0x2c,0x6f,0x10,0xaa,0xff,0x0f,0x0c,0xdd,0xb0,
+	0x0f,0x10,0x07,0x54,0x27,0x14,0x37,0x14,0xda,0x77,0x07,0x10,0xee,0x2c,0x27,0x10,
+	0x0f,0x10,0xdd,0x55,0x07,0x10,0x22,0x47,0x30,0x0f,0x20,0x83,0x01,0x00,0x00,0xfc,
+	0x00,0xe4,0x7f,0xfc,0x00,0xec,0x92,0x11,0x06,0x49,0x00,0xbe,0x0d,0x00,0x18,0xff,
+	0x9b,0x60,0x17,0x14,0x64,0x03,0x00,0xff,0x50,0x25,0x00,0x20,0x33,0x80,0x00,0x00,
+	0x7b,0x30,0x80,0x06,0x03,0x80,0x02,0x10,0x0d,0x07,0x0c,0xfd,0x14,0x07,0x04,0x42,
+	0x80,0x05,0x00,0x35,0x80,0xff,0x10,0x00,0x32,0x80,0x06,0x00,0x15,0x80,0xdf,0x1e,
+	0x0c,0x30,0x80,0x01,0x0f,0x08,0x34,0x80,0x77,0x02,0x00,0x2a,0x03,0x00,0x32,0x80,
+	0x08,0x17,0x00,0xab,0x00,0x0c,0x03,0x00,0x0d,0x1b,0x2c,0x01,0x33,0x10,0x00,0x52,
+	0x33,0x30,0x00,0x17,0x20,0x67,0x14,0x03,0x77,0x10,0x03,0x6f,0x00,0x55,0x03,0x6f,
+	0x24,0x08,0x03,0x00,0x09,0x03,0x00,0x0a,0x03,0x00,0x55,0x0b,0x2f,0x1c,0x01,0x2f,
+	0x10,0x01,0x2f,0x00,0x01,0x2f,0x74,0x12,0xcf,0x50,0x01,0x2f,0x38,0xf4,0x0f,0x0a,
+	0x23,0x19,0x17,0x05,0x27,0x0d,0x95,0x07,0x13,0x18,0x78,0x13,0x00,0x05,0x6e,0x19,
+	0x00,0x0c,0x94,0xaa,0x13,0x00,0x06,0x13,0x30,0xac,0x13,0x00,0x03,0x09,0x08,0x0c,
+	0xaa,0x13,0x18,0xc4,0x13,0x00,0x04,0x13,0x30,0xf4,0x13,0x00,0x09,0xf6,0x13,0x30,
+	0x24,0x26,0xbf,0x0f,0xa0,0x3d,0x2f,0x7d}; /** Size:632 **/
+
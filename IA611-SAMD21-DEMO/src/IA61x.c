@@ -31,87 +31,421 @@
  ****************************************************************************/
 #include "IA61x.h"
 #include <asf.h>
+#include "IA61x_cmdq.h"
+#include "IA61x_param.h"
+#include "IA61x_trace.h"
 
 static IA61x_instance IA61x;
 
-/*****************************************************************************/
-#ifdef IA61x_SAMD21_VQ_UART
-# include "IA61x_samd21_VQ_uart.h"
+/* Send only cmd_batch entries waiting for the next transfer */
+typedef struct
+{
+    uint8_t frames[IA61x_BATCH_TX_WORDS * 4];
+    IA61x_cmd_entry *entry[IA61x_BATCH_TX_WORDS];
+    uint32_t count;
+} IA61x_batch_queue;
+
+/***************************************************************************
+ * @fn          IA61x_batch_flush
+ *
+ * @brief       Send the queued send only commands in one transfer. If the
+ *              transfer fails, the queued entries are marked failed. The
+ *              parameter shadow and the bus trace see them like queued
+ *              commands.
+ *
+ * @param       queue   Queued commands, emptied
+ * @param       stop    Set if a failed entry has IA61x_BATCH_STOP
+ *
+ * @retval      Number of entries failed by the transfer, optional ones not counted
+ *
+ ****************************************************************************/
+static int32_t IA61x_batch_flush(IA61x_batch_queue *queue, bool *stop)
+{
+    int32_t failed = 0;
+    uint32_t i;
 
+    if (queue->count && (IA61x.put(queue->frames, queue->count * 4) != STATUS_OK))
+    {
+        for (i = 0; i < queue->count; i++)
+        {
+            queue->entry[i]->status = CMD_FAILED;
+            if (!(queue->entry[i]->flags & IA61x_BATCH_OPTIONAL))
+                failed++;
+            if (queue->entry[i]->flags & IA61x_BATCH_STOP)
+                *stop = true;
+        }
+    }
+    for (i = 0; i < queue->count; i++)
+    {
+        IA61x_TRACE(IA61x_TRACE_CMD, queue->entry[i]->cmd, queue->entry[i]->data, 4, queue->entry[i]->status);
+        IA61x_param_observe(queue->entry[i]->cmd, queue->entry[i]->data, queue->entry[i]->status, queue->entry[i]->data);
+    }
+    queue->count = 0;
+
+    return (failed);
+}
 
 /***************************************************************************
- * @fn          IA61x_init
+ * @fn          IA61x_cmd_batch
  *
- * @brief       Initialize IA61x interface port and create IA61x instance handle
+ * @brief       Run a list of commands with no gaps beyond the response
+ *              polling of cmd(). Send only commands are queued and go out
+ *              in one transfer ahead of the next answered command. Each
+ *              entry gets its own status and response.
  *
- * @param       none
+ * @param       entries     Commands to run, status and response are filled in
+ * @param       count       Number of entries
  *
- * @retval      IA61x     Ia61x instance handle for applicaton
+ * @retval      Number of failed entries, IA61x_BATCH_OPTIONAL ones not counted
  *
  ****************************************************************************/
-IA61x_instance *IA61x_init(void)
+int32_t IA61x_cmd_batch(IA61x_cmd_entry *entries, uint32_t count)
 {
-    if (IA61x_samd21_vq_uart_init(&IA61x) == SUCCESS) return (&IA61x);
-    return (NULL);
+    IA61x_batch_queue queue;
+    IA61x_cmd_entry *entry;
+    int32_t failed = 0;
+    int32_t ret;
+    bool stop = false;
+    bool prev_ok = true;
+    uint32_t i;
+
+    queue.count = 0;
+    for (i = 0; i < count; i++)
+    {
+        entry = &entries[i];
+        entry->response = 0;
+
+        if (stop || ((entry->flags & IA61x_BATCH_CHAINED) && !prev_ok))
+        {
+            entry->status = CMD_SKIPPED;
+            prev_ok = false;
+            continue;
+        }
+
+        //Send only: queue the frame, command word first, MSB first
+        if ((entry->flags & IA61x_BATCH_NO_RESP) || ((entry->cmd & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK))
+        {
+            IA61x_cmdq_frame(&queue.frames[queue.count * 4], entry->cmd, entry->data);
+            queue.entry[queue.count++] = entry;
+            entry->response = entry->data;
+            entry->status = CMD_SUCCESS;
+            prev_ok = true;
+
+            if (queue.count == IA61x_BATCH_TX_WORDS)
+                failed += IA61x_batch_flush(&queue, &stop);
+            continue;
+        }
+
+        failed += IA61x_batch_flush(&queue, &stop);
+        if (stop)
+        {
+            entry->status = CMD_SKIPPED;
+            prev_ok = false;
+            continue;
+        }
+
+        ret = IA61x.cmd(entry->cmd, entry->data, entry->timeout ? entry->timeout : 1, &entry->response);
+        if ((ret == CMD_SUCCESS) && !(entry->flags & IA61x_BATCH_ANY_RESP) && (entry->response != entry->expect))
+            ret = CMD_FAILED;
+
+        entry->status = (ret == CMD_SUCCESS) ? CMD_SUCCESS : CMD_FAILED;
+        prev_ok = (ret == CMD_SUCCESS);
+        if (!prev_ok)
+        {
+            if (!(entry->flags & IA61x_BATCH_OPTIONAL))
+                failed++;
+            if (entry->flags & IA61x_BATCH_STOP)
+                stop = true;
+        }
+    }
+    failed += IA61x_batch_flush(&queue, &stop);
+
+    return (failed);
 }
 
 /***************************************************************************
- * @fn          IA61x_uninit
+ * @fn          IA61x_rdb_drain
  *
- * @brief       Un-initialize IA61x interface port 
+ * @brief       Read the data blocks an algorithm has queued, one rdb after
+ *              the other until IA61x reports an empty block, so blocks
+ *              queued behind the first one need no event of their own.
+ *              A block of a byte or less is empty, it ends the list and is
+ *              not counted. Blocks that do not fit into the list are left
+ *              for the next event.
  *
- * @param       none
+ * @param       algo_id     Algorithm ID
+ * @param       block_type  Block to read
+ * @param       blocks      Buffers for the blocks, size is filled in
+ * @param       count       Number of buffers
+ * @param       read        Number of blocks read with a payload, also set
+ *                          when a later rdb failed
  *
- * @retval      none
+ * @retval      CMD_SUCCESS All queued blocks read, or the list is full
+ * @retval      <0          The rdb after the first *read blocks failed
  *
  ****************************************************************************/
-void IA61x_uninit(void)
+int32_t IA61x_rdb_drain(uint8_t algo_id, uint8_t block_type, IA61x_rdb_block *blocks, uint32_t count, uint32_t *read)
 {
-    IA61x_samd21_vq_uart_uninit();
+    int32_t ret = CMD_SUCCESS;
+
+    for (*read = 0; *read < count; (*read)++)
+    {
+        ret = IA61x.rdb(algo_id, block_type, blocks[*read].data, &blocks[*read].size);
+        if (ret != CMD_SUCCESS)
+            break;
+
+        if (blocks[*read].size <= 1)
+            break;
+    }
+
+    return (ret);
 }
 
+#if defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE
+/* Driver operations behind the traced ones of the instance */
+static IA61x_instance IA61x_bus;
 
-#endif /* ifdef IA61x_SAMD21_VQ_UART */
+static int32_t IA61x_traced_get(uint8_t *data, uint32_t size)
+{
+    int32_t ret = IA61x_bus.get(data, size);
 
+    IA61x_TRACE(IA61x_TRACE_GET, 0, 0, size, ret);
+    return (ret);
+}
 
+static int32_t IA61x_traced_put(uint8_t *data, uint32_t size)
+{
+    int32_t ret = IA61x_bus.put(data, size);
 
-/*****************************************************************************/
-#ifdef IA61x_SAMD21_VQ_I2C
+    IA61x_TRACE(IA61x_TRACE_PUT, 0, 0, size, ret);
+    return (ret);
+}
 
-# include "IA61x_samd21_VQ_i2c.h"
+static int32_t IA61x_traced_rdb(uint8_t algo_id, uint8_t block_type, uint8_t *data, uint32_t *size)
+{
+    int32_t ret = IA61x_bus.rdb(algo_id, block_type, data, size);
 
+    IA61x_TRACE(IA61x_TRACE_RDB, ((uint16_t)algo_id << 8) | block_type, 0, ret ? 0 : *size, ret);
+    return (ret);
+}
 
-IA61x_instance *IA61x_init(void)
+static int32_t IA61x_traced_download_keyword(uint16_t *data, uint16_t size)
 {
-    if (IA61x_samd21_vq_i2c_init(&IA61x) == SUCCESS) return (&IA61x);
-    return (NULL);
+    int32_t ret = IA61x_bus.download_keyword(data, size);
+
+    IA61x_TRACE(IA61x_TRACE_WDB, WDB_CMD, size, size, ret);
+    return (ret);
 }
 
-void IA61x_uninit(void)
+/***************************************************************************
+ * @fn          IA61x_trace_attach
+ *
+ * @brief       Route the bulk operations of the instance through the bus
+ *              trace. Commands are traced by the command queue, so the
+ *              driver's own calls of cmd are recorded as well.
+ *
+ * @param       none
+ *
+ * @retval      none
+ *
+ ****************************************************************************/
+static void IA61x_trace_attach(void)
 {
-    IA61x_samd21_vq_i2c_uninit();
+    IA61x_bus = IA61x;
+
+    IA61x.get              = IA61x_traced_get;
+    IA61x.put              = IA61x_traced_put;
+    IA61x.rdb              = IA61x_traced_rdb;
+    IA61x.download_keyword = IA61x_traced_download_keyword;
 }
+#else
+#define IA61x_trace_attach()
+#endif
 
-#endif /*#ifdef IA61x_SAMD21_VQ_I2C*/
+/***************************************************************************
+ * @fn          IA61x_rearm
+ *
+ * @brief       Resume detection after an event. While the last VoiceWake
+ *              succeeded, the route was armed by a preset and the parameter
+ *              shadow saw no route stop or power cycle since, only that
+ *              preset is repeated: no SYNC, no route stop, no parameters.
+ *              A route selection resets the parameters VoiceWake sets after
+ *              it, so it always takes the full VoiceWake, like a failure.
+ *
+ * @param       none
+ *
+ * @retval      error   returns non zero value if any of the command fails
+ *
+ ****************************************************************************/
+int32_t IA61x_rearm(void)
+{
+    static bool voicewake_ok = false;
+    int32_t error;
+#if IA61x_REARM_FAST
+    uint16_t cmdWord, dataWord, response;
+
+    if (voicewake_ok && IA61x_param_armed(&cmdWord, &dataWord) &&
+        ((cmdWord | CMD_NO_RESP_MASK) == (SET_PRESET_CMD | CMD_NO_RESP_MASK)))
+    {
+        //Send only variants (UART preset) have no response, the others are answered like in VoiceWake
+        if ((cmdWord & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK)
+        {
+            if (IA61x.cmd(cmdWord, dataWord, 0, &response) == CMD_SUCCESS)
+                return (0);
+        }
+        else if ((IA61x.cmd(cmdWord, dataWord, 5, &response) == CMD_SUCCESS) && (response == dataWord))
+            return (0);
+    }
+#endif
+
+    error = IA61x.VoiceWake();
+    voicewake_ok = (error == 0);
 
+    return (error);
+}
 
 /*****************************************************************************/
+#ifdef IA61x_SAMD21_VQ_SPI
+# include "IA61x_samd21_VQ_spi.h"
+#endif
+#ifdef IA61x_SAMD21_VQ_UART
+# include "IA61x_samd21_VQ_uart.h"
+#endif
+#ifdef IA61x_SAMD21_VQ_I2C
+# include "IA61x_samd21_VQ_i2c.h"
+#endif
 
+#if defined(IA61x_SAMD21_VQ_AUTO) && !IA61x_FW_CONTAINER
+# error "IA61x_SAMD21_VQ_AUTO takes the UART and SPI images from one container, set IA61x_FW_CONTAINER"
+#endif
+
+/* Host interface driver */
+typedef struct
+{
+    uint8_t id;                                     //IA61x_HOST_xxx
+    const char *name;
+    int32_t (*init)(IA61x_instance *IA61x);         //Power cycle IA61x and sync with the boot loader
+    int32_t (*attach)(IA61x_instance *IA61x);       //Reuse running firmware without a power cycle, may be NULL
+    int32_t (*uninit)(void);
+} IA61x_host_driver;
+
+#if defined(IA61x_WARM_ATTACH) && IA61x_WARM_ATTACH
+# define IA61x_HOST_ATTACH(fn)  fn
+#else
+# define IA61x_HOST_ATTACH(fn)  NULL
+#endif
+
+/* Built in interfaces, fastest first. With IA61x_SAMD21_VQ_AUTO all of them are probed. */
+static const IA61x_host_driver IA61x_hosts[] =
+{
 #ifdef IA61x_SAMD21_VQ_SPI
+    { IA61x_HOST_SPI,  "SPI",  IA61x_samd21_vq_spi_init,  IA61x_HOST_ATTACH(IA61x_samd21_vq_spi_attach),  IA61x_samd21_vq_spi_uninit },
+#endif
+#ifdef IA61x_SAMD21_VQ_UART
+    { IA61x_HOST_UART, "UART", IA61x_samd21_vq_uart_init, IA61x_HOST_ATTACH(IA61x_samd21_vq_uart_attach), IA61x_samd21_vq_uart_uninit },
+#endif
+#ifdef IA61x_SAMD21_VQ_I2C
+    { IA61x_HOST_I2C,  "I2C",  IA61x_samd21_vq_i2c_init,  NULL,                                             IA61x_samd21_vq_i2c_uninit },
+#endif
+};
 
-# include "IA61x_samd21_VQ_spi.h"
+#define IA61x_HOSTS     (sizeof(IA61x_hosts) / sizeof(IA61x_hosts[0]))
+
+/* Interface bound by IA61x_init() */
+static const IA61x_host_driver *IA61x_bound = NULL;
 
+/***************************************************************************
+ * @fn          IA61x_init
+ *
+ * @brief       Initialize IA61x interface port and create IA61x instance handle.
+ *              Each built in interface is tried in order of bandwidth: its
+ *              driver power cycles IA61x, so the boot loader auto-detects the
+ *              interface, and syncs with it. The first one that answers is
+ *              used. Before any power cycle, every interface gets the chance
+ *              to reconnect to firmware left running by a host reset.
+ *
+ * @param       none
+ *
+ * @retval      IA61x     Ia61x instance handle for applicaton
+ * @retval      NULL      No interface answered
+ *
+ ****************************************************************************/
 IA61x_instance *IA61x_init(void)
 {
-    if (IA61x_samd21_vq_spi_init(&IA61x) == SUCCESS) return (&IA61x);
-    return (NULL);
+    const IA61x_host_driver *host;
+
+    IA61x_bound = NULL;
+
+#if defined(IA61x_SAMD21_VQ_AUTO) && IA61x_WARM_ATTACH
+    //A cold boot on one interface would power cycle firmware running on another
+    for (host = IA61x_hosts; (host < &IA61x_hosts[IA61x_HOSTS]) && !IA61x_bound; host++)
+    {
+        if (host->attach && (host->attach(&IA61x) == SUCCESS))
+            IA61x_bound = host;
+    }
+#endif
+
+    for (host = IA61x_hosts; (host < &IA61x_hosts[IA61x_HOSTS]) && !IA61x_bound; host++)
+    {
+        if (host->init(&IA61x) == SUCCESS)
+            IA61x_bound = host;
+    }
+
+    if (!IA61x_bound)
+        return (NULL);
+
+    IA61x.cmd_batch = IA61x_cmd_batch;
+    IA61x.rdb_drain = IA61x_rdb_drain;
+    IA61x.rearm     = IA61x_rearm;
+    IA61x_trace_attach();
+    return (&IA61x);
 }
 
+/***************************************************************************
+ * @fn          IA61x_uninit
+ *
+ * @brief       Un-initialize IA61x interface port 
+ *
+ * @param       none
+ *
+ * @retval      none
+ *
+ ****************************************************************************/
 void IA61x_uninit(void)
 {
-    IA61x_samd21_vq_spi_uninit();
+    if (IA61x_bound)
+        IA61x_bound->uninit();
+}
+
+/***************************************************************************
+ * @fn          IA61x_host
+ *
+ * @brief       Host interface in use
+ *
+ * @param       none
+ *
+ * @retval      IA61x_HOST_xxx, IA61x_HOST_NONE before IA61x_init() succeeded
+ *
+ ****************************************************************************/
+uint8_t IA61x_host(void)
+{
+    return (IA61x_bound ? IA61x_bound->id : IA61x_HOST_NONE);
+}
+
+/***************************************************************************
+ * @fn          IA61x_host_name
+ *
+ * @brief       Name of the host interface in use, for reports
+ *
+ * @param       none
+ *
+ * @retval      "SPI", "UART", "I2C" or "none"
+ *
+ ****************************************************************************/
+const char *IA61x_host_name(void)
+{
+    return (IA61x_bound ? IA61x_bound->name : "none");
 }
 
-#endif
 /*****************************************************************************/
 /*****************************************************************************/
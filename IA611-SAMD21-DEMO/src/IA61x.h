@@ -50,6 +50,7 @@
 #define CMD_SUCCESS                     (0)
 #define CMD_TIMEOUT                     (-1)
 #define CMD_FAILED                      (-2)
+#define CMD_SKIPPED                     (-3)    //cmd_batch entry not sent, see IA61x_BATCH_xxx
 #define FW_DOWNLOAD_SUCCESS             (2)
 #define NO_KWD_DETECTED                 (0)
 #define SUCCESS                         (0)
@@ -111,27 +112,70 @@
 #define WDB_SIZE_NO_HEADER              508     //Data block size without 4 byte Header
 #define WDB_SIZE                        512     //Data block size with 4 byte Header
 
+/* cmd_batch entry flags */
+#define IA61x_BATCH_NO_RESP             0x01    //Send only, no response is read (implied for 0x9xxx commands)
+#define IA61x_BATCH_ANY_RESP            0x02    //Any response is accepted, expect is not checked
+#define IA61x_BATCH_CHAINED             0x04    //Sent only if the previous entry succeeded, e.g. SET_ALGO_PARAM
+#define IA61x_BATCH_OPTIONAL            0x08    //A failure is recorded but not counted
+#define IA61x_BATCH_STOP                0x10    //Skip the rest of the batch if this entry fails
+
+#define IA61x_BATCH_TX_WORDS            8       //Send only commands coalesced into one transfer
+
+/* Host interface bound by IA61x_init(), IA61x_host() */
+#define IA61x_HOST_NONE                 0
+#define IA61x_HOST_SPI                  1
+#define IA61x_HOST_UART                 2
+#define IA61x_HOST_I2C                  3
+
 /*-------------------------------------------------------------------------------------------------*\
  |    T Y P E   D E F I N I T I O N S
 \*-------------------------------------------------------------------------------------------------*/
 
 
+typedef struct
+{
+    uint16_t cmd;               //Command word
+    uint16_t data;              //Data word
+    uint16_t expect;            //Expected response word
+    uint8_t  flags;             //IA61x_BATCH_xxx
+    uint8_t  timeout;           //Response read retries as for cmd(), 0 is taken as 1
+    uint16_t response;          //Out: response word, the data word for send only commands
+    int16_t  status;            //Out: CMD_SUCCESS, CMD_FAILED or CMD_SKIPPED
+} IA61x_cmd_entry;
+
+typedef struct
+{
+    uint8_t  *data;             //Buffer for one block, 32 bit aligned
+    uint32_t size;              //In: buffer size, Out: bytes read
+} IA61x_rdb_block;
+
 typedef struct
 {
     int32_t (*download_config)(void);
     int32_t (*download_program)(void);
+    int32_t (*download_start)(void);     //Optional, start download_program in the background
+    int32_t (*download_finish)(void);    //Complete download_start, same result as download_program
     int32_t (*download_keyword)(uint16_t *data, uint16_t size);
     int32_t (*VoiceWake)(void);
+    int32_t (*rearm)(void);             //VoiceWake, shortened when the route is still set up
     int32_t (*close)(void);
     int32_t (*wait_keyword)(uint32_t ms);
 	int32_t (*rdb)(uint8_t algo_id, uint8_t block_type, uint8_t *data, uint32_t *size);
+    uint32_t (*image_id)(void);         //Optional, identity of the embedded program image
 
     int32_t (*cmd)(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse);
+    int32_t (*cmd_batch)(IA61x_cmd_entry *entries, uint32_t count);
+    int32_t (*rdb_drain)(uint8_t algo_id, uint8_t block_type, IA61x_rdb_block *blocks, uint32_t count, uint32_t *read);
     int32_t (*get)(uint8_t *data, uint32_t size);
     int32_t (*put)(uint8_t *data, uint32_t size);
 } IA61x_instance;
 
 IA61x_instance *IA61x_init(void);
 void IA61x_uninit(void);
+uint8_t IA61x_host(void);
+const char *IA61x_host_name(void);
+int32_t IA61x_cmd_batch(IA61x_cmd_entry *entries, uint32_t count);
+int32_t IA61x_rdb_drain(uint8_t algo_id, uint8_t block_type, IA61x_rdb_block *blocks, uint32_t count, uint32_t *read);
+int32_t IA61x_rearm(void);
 
 #endif /* IA61x_H_ */
\ No newline at end of file
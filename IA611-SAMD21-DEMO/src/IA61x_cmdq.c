@@ -0,0 +1,412 @@
+/************************************************************************//**
+ * File: IA61x_cmdq.c
+ *
+ * Description: Interrupt driven IA61x command queue
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include "IA61x.h"
+#include "IA61x_cmdq.h"
+#include "IA61x_param.h"
+#include "IA61x_ready.h"
+#include "IA61x_samd21_timer.h"
+#include "IA61x_trace.h"
+
+/*
+ * Requests run one at a time in submission order. The TC4 alarm advances the head request:
+ * send the command, then probe for the response until it is answered or its deadline has
+ * passed. The thread that submitted is free in the meantime.
+ *
+ * The first probe is placed at the latency learned for the command word, later probes back
+ * off exponentially up to IA61x_READY_CMD_MAX_US. Most commands are answered in well under a
+ * millisecond, a few (route setup, SYNC after boot) take several.
+ */
+static const IA61x_cmdq_transport *cmdq_transport = NULL;
+static IA61x_cmdq_req *volatile cmdq_head = NULL;
+static IA61x_cmdq_req *cmdq_tail = NULL;
+static bool cmdq_sent = false;
+static uint32_t cmdq_probes = 0;     //Probes of the head request
+
+static void cmdq_step(void);
+
+/* Learned response latency per command word, replaced round robin */
+static struct
+{
+    uint16_t cmd;
+    uint16_t latency_us;
+} cmdq_latency[IA61x_CMDQ_LATENCY_SLOTS];
+static uint8_t cmdq_latency_used = 0;
+static uint8_t cmdq_latency_next = 0;
+
+/***************************************************************************
+ * @fn      cmdq_latency_slot()
+ *
+ * @brief   Find the latency slot of a command word
+ *
+ * @param   cmdWord     Command word
+ *
+ * @retval  slot index, -1 if the command word is not in the table
+ *
+ ****************************************************************************/
+static int32_t cmdq_latency_slot(uint16_t cmdWord)
+{
+    uint8_t i;
+
+    for (i = 0; i < cmdq_latency_used; i++)
+    {
+        if (cmdq_latency[i].cmd == cmdWord)
+            return (i);
+    }
+    return (-1);
+}
+
+/***************************************************************************
+ * @fn      cmdq_latency_learn()
+ *
+ * @brief   Update the latency of a command word after it was answered.
+ *          The sample is the time of the probe that saw the response, so
+ *          it overestimates. If the first probe was already answered the
+ *          estimate is lowered a quarter instead, so it settles just above
+ *          the real latency.
+ *
+ * @param   cmdWord     Command word
+ * @param   elapsed     Send to successful probe in us
+ * @param   first       Answered at the first probe
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void cmdq_latency_learn(uint16_t cmdWord, uint32_t elapsed, bool first)
+{
+    int32_t slot = cmdq_latency_slot(cmdWord);
+    uint32_t latency;
+
+    if (elapsed > UINT16_MAX)
+        elapsed = UINT16_MAX;
+
+    if (slot < 0)
+    {
+        if (cmdq_latency_used < IA61x_CMDQ_LATENCY_SLOTS)
+            slot = cmdq_latency_used++;
+        else
+        {
+            slot = cmdq_latency_next;
+            cmdq_latency_next = (cmdq_latency_next + 1) % IA61x_CMDQ_LATENCY_SLOTS;
+        }
+        cmdq_latency[slot].cmd = cmdWord;
+        cmdq_latency[slot].latency_us = (uint16_t)elapsed;
+        return;
+    }
+
+    latency = cmdq_latency[slot].latency_us;
+    if (first)
+        latency -= latency / 4;
+    else
+        latency += ((int32_t)elapsed - (int32_t)latency) / 4;
+
+    cmdq_latency[slot].latency_us = (uint16_t)((latency < IA61x_READY_CMD_MIN_US) ? IA61x_READY_CMD_MIN_US : latency);
+}
+
+/***************************************************************************
+ * @fn      cmdq_alarm()
+ *
+ * @brief   Schedule the next probe of the head request, never past its
+ *          deadline so the last probe is at the deadline
+ *
+ * @param   req     Head request
+ * @param   elapsed Time since the send in us
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void cmdq_alarm(IA61x_cmdq_req *req, uint32_t elapsed)
+{
+    uint32_t left = req->deadline_us - elapsed;
+
+    IA61x_timer_alarm((left < req->poll_us) ? left : req->poll_us, cmdq_step);
+}
+
+/***************************************************************************
+ * @fn      cmdq_complete()
+ *
+ * @brief   Remove the head request and hand it its result
+ *
+ * @param   req     Head request
+ * @param   result  CMD_SUCCESS, CMD_FAILED or CMD_TIMEOUT
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void cmdq_complete(IA61x_cmdq_req *req, int32_t result)
+{
+    system_interrupt_enter_critical_section();
+    cmdq_head = req->next;
+    if (!cmdq_head)
+        cmdq_tail = NULL;
+    system_interrupt_leave_critical_section();
+
+    cmdq_sent = false;
+    IA61x_TRACE(IA61x_TRACE_RESP, req->cmd, req->response, req->deadline_us ? 4 : 0, result);
+    IA61x_param_observe(req->cmd, req->data, result, req->response);
+    req->result = result;
+    if (req->callback)
+        req->callback(req);
+}
+
+/***************************************************************************
+ * @fn      cmdq_step()
+ *
+ * @brief   Alarm callback, interrupt context. Advance the head request and
+ *          start the ones behind it until one waits for a response.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void cmdq_step(void)
+{
+    IA61x_cmdq_req *req;
+    uint32_t elapsed;
+    int32_t ret;
+
+    while ((req = cmdq_head) != NULL)
+    {
+        if (!cmdq_sent)
+        {
+            cmdq_sent = true;
+            req->start_us = IA61x_timer_us();
+            ret = cmdq_transport->send(req->cmd, req->data);
+            IA61x_TRACE(IA61x_TRACE_CMD, req->cmd, req->data, 4, ret);
+            if (ret != CMD_SUCCESS)
+            {
+                cmdq_complete(req, CMD_FAILED);
+                continue;
+            }
+            if (!req->deadline_us)
+            {
+                cmdq_complete(req, CMD_SUCCESS);
+                continue;
+            }
+            req->poll_us = IA61x_cmdq_latency(req->cmd);
+            cmdq_probes = 0;
+            cmdq_alarm(req, 0);
+            return;
+        }
+
+        ret = cmdq_transport->probe(req->cmd, &req->response);
+        cmdq_probes++;
+        elapsed = IA61x_timer_elapsed_us(req->start_us);
+        if ((ret == CMD_TIMEOUT) && (elapsed < req->deadline_us))
+        {
+            //Not answered yet, back off and probe again
+            if (req->poll_us < IA61x_READY_CMD_MAX_US / 2)
+                req->poll_us *= 2;
+            else
+                req->poll_us = IA61x_READY_CMD_MAX_US;
+            cmdq_alarm(req, elapsed);
+            return;
+        }
+        if (ret == CMD_SUCCESS)
+            cmdq_latency_learn(req->cmd, elapsed, cmdq_probes == 1);
+        cmdq_complete(req, ret);
+    }
+}
+
+/***************************************************************************
+ * @fn      IA61x_cmdq_init()
+ *
+ * @brief   Bind the queue to the bus of the host interface
+ *
+ * @param   transport   Bus operations, must stay valid
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_cmdq_init(const IA61x_cmdq_transport *transport)
+{
+    IA61x_timer_init();
+
+    IA61x_cmdq_drain();
+    cmdq_transport = transport;
+}
+
+/***************************************************************************
+ * @fn      cmdq_req_done()
+ *
+ * @brief   IA61x_ready_sleep() probe, the request left IA61x_CMDQ_BUSY
+ *
+ * @param   ctx     Request
+ *
+ * @retval  true once the alarm completed the request
+ *
+ ****************************************************************************/
+static bool cmdq_req_done(void *ctx)
+{
+    return (((IA61x_cmdq_req *)ctx)->result != IA61x_CMDQ_BUSY);
+}
+
+/***************************************************************************
+ * @fn      cmdq_empty()
+ *
+ * @brief   IA61x_ready_sleep() probe, no command is queued or running
+ *
+ * @param   ctx     Unused
+ *
+ * @retval  true once the queue is empty
+ *
+ ****************************************************************************/
+static bool cmdq_empty(void *ctx)
+{
+    (void)ctx;
+    return (cmdq_head == NULL);
+}
+
+/***************************************************************************
+ * @fn      IA61x_cmdq_submit()
+ *
+ * @brief   Queue a command and return. The result is in req->result once
+ *          req->callback was called.
+ *
+ * @param   req     Request, cmd, data, deadline_us, callback and ctx set
+ *
+ * @retval  STATUS_OK               Request queued
+ * @retval  STATUS_ERR_NOT_INITIALIZED  No host interface bound
+ *
+ ****************************************************************************/
+enum status_code IA61x_cmdq_submit(IA61x_cmdq_req *req)
+{
+    bool start;
+
+    if (!cmdq_transport)
+        return (STATUS_ERR_NOT_INITIALIZED);
+
+    req->result = IA61x_CMDQ_BUSY;
+    req->response = 0;
+    req->next = NULL;
+
+    system_interrupt_enter_critical_section();
+    start = (cmdq_head == NULL);
+    if (start)
+        cmdq_head = req;
+    else
+        cmdq_tail->next = req;
+    cmdq_tail = req;
+    system_interrupt_leave_critical_section();
+
+    //An idle queue is started from the alarm interrupt, like every later step
+    if (start)
+        IA61x_timer_alarm(0, cmdq_step);
+
+    return (STATUS_OK);
+}
+
+/***************************************************************************
+ * @fn      IA61x_cmdq_run()
+ *
+ * @brief   Blocking command through the queue, the drivers' cmd() wrap it.
+ *          Not for interrupt context.
+ *
+ * @param   cmdWord     Command word to send to IA61x
+ * @param   dataWord    Data word to send to IA61x
+ * @param   deadline_us Response window, 0 if no response is expected
+ * @param   pResponse   Response word from IA61x
+ *
+ * @retval  CMD_SUCCESS Command execution successful
+ * @retval  CMD_FAILED  Command could not be sent or wrong response
+ * @retval  CMD_TIMEOUT No response within the deadline
+ *
+ ****************************************************************************/
+int32_t IA61x_cmdq_run(uint16_t cmdWord, uint16_t dataWord, uint32_t deadline_us, uint16_t *pResponse)
+{
+    IA61x_cmdq_req req = {
+        .cmd         = cmdWord,
+        .data        = dataWord,
+        .deadline_us = deadline_us,
+        .callback    = NULL,
+    };
+
+    if (IA61x_cmdq_submit(&req) != STATUS_OK)
+        return (CMD_FAILED);
+
+    //No deadline of its own, the queue owns the alarm and its interrupt wakes the core
+    IA61x_ready_sleep(cmdq_req_done, &req, 0);
+
+    *pResponse = req.response;
+    return (req.result);
+}
+
+/***************************************************************************
+ * @fn      IA61x_cmdq_idle()
+ *
+ * @brief   Check if no command is queued or running
+ *
+ * @param   none
+ *
+ * @retval  true if the bus is free for other transfers
+ *
+ ****************************************************************************/
+bool IA61x_cmdq_idle(void)
+{
+    return (cmdq_head == NULL);
+}
+
+/***************************************************************************
+ * @fn      IA61x_cmdq_latency()
+ *
+ * @brief   Learned response latency of a command word, the time of its
+ *          first probe
+ *
+ * @param   cmdWord     Command word
+ *
+ * @retval  latency in us, IA61x_READY_CMD_POLL_US if not learned yet
+ *
+ ****************************************************************************/
+uint32_t IA61x_cmdq_latency(uint16_t cmdWord)
+{
+    int32_t slot = cmdq_latency_slot(cmdWord);
+
+    return ((slot < 0) ? IA61x_READY_CMD_POLL_US : cmdq_latency[slot].latency_us);
+}
+
+/***************************************************************************
+ * @fn      IA61x_cmdq_drain()
+ *
+ * @brief   Wait until all queued commands completed. Bulk transfers (image
+ *          downloads, WDB, RDB) use the bus directly and call this first.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_cmdq_drain(void)
+{
+    IA61x_ready_sleep(cmdq_empty, NULL, 0);
+}
@@ -0,0 +1,99 @@
+/************************************************************************//**
+ * File: IA61x_cmdq.h
+ *
+ * Description: Interrupt driven IA61x command queue
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_CMDQ_H_
+#define IA61x_CMDQ_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_CMDQ_BUSY         (1)     //Request result while it is queued or running
+#define IA61x_CMDQ_LATENCY_SLOTS 8      //Command words whose response latency is learned
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/*
+ * Bus operations of the host interface. Both are short transfers and run in interrupt
+ * context at the lowest priority, so they may wait for SERCOM or DMAC interrupts.
+ */
+typedef struct
+{
+    int32_t (*send)(uint16_t cmdWord, uint16_t dataWord);       //Write the command, CMD_SUCCESS or CMD_FAILED
+    int32_t (*probe)(uint16_t cmdWord, uint16_t *pResponse);    //CMD_SUCCESS, CMD_TIMEOUT (not yet) or CMD_FAILED
+} IA61x_cmdq_transport;
+
+struct IA61x_cmdq_req;
+typedef void (*IA61x_cmdq_callback_t)(struct IA61x_cmdq_req *req);
+
+/* A request is owned by the caller and must stay valid until its callback ran or result left IA61x_CMDQ_BUSY */
+typedef struct IA61x_cmdq_req
+{
+    uint16_t cmd;                       //Command word
+    uint16_t data;                      //Data word
+    uint32_t deadline_us;               //Response window after the send, 0 if no response is read
+    IA61x_cmdq_callback_t callback;     //Completion, interrupt context, may be NULL
+    void *ctx;                          //For the callback
+
+    volatile int32_t result;            //Out: IA61x_CMDQ_BUSY, CMD_SUCCESS, CMD_FAILED or CMD_TIMEOUT
+    uint16_t response;                  //Out: response word
+
+    uint32_t start_us;                  //Private
+    uint32_t poll_us;                   //Private, next probe interval
+    struct IA61x_cmdq_req *next;        //Private
+} IA61x_cmdq_req;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+void IA61x_cmdq_init(const IA61x_cmdq_transport *transport);
+enum status_code IA61x_cmdq_submit(IA61x_cmdq_req *req);
+int32_t IA61x_cmdq_run(uint16_t cmdWord, uint16_t dataWord, uint32_t deadline_us, uint16_t *pResponse);
+bool IA61x_cmdq_idle(void);
+uint32_t IA61x_cmdq_latency(uint16_t cmdWord);
+void IA61x_cmdq_drain(void);
+
+/* Command and data word in wire order: command word first, MSB first */
+static inline void IA61x_cmdq_frame(uint8_t *frame, uint16_t cmdWord, uint16_t dataWord)
+{
+    frame[0] = (uint8_t)(cmdWord >> 8);
+    frame[1] = (uint8_t)cmdWord;
+    frame[2] = (uint8_t)(dataWord >> 8);
+    frame[3] = (uint8_t)dataWord;
+}
+
+#endif /* IA61x_CMDQ_H_ */
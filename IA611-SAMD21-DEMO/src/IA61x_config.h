@@ -35,19 +35,41 @@
 #define IA61x_SAMD21_VQ_UART
 //#define IA61x_SAMD21_VQ_I2C
 //#define IA61x_SAMD21_VQ_SPI
+//#define IA61x_SAMD21_VQ_AUTO     //Build all interfaces, use the fastest one that answers at start-up (IA61x_host())
 #define IA61x_KEYWORDS 4
+#define IA61x_BOOT_PROFILE 1     //Record and print a boot timeline (IA61x_profile.h)
+#define IA61x_REARM_FAST 1       //After an event only repeat the preset while it is known active
+#define IA61x_BUS_TRACE 1        //Record every bus transaction in a RAM ring (IA61x_trace.h)
+#define IA61x_IRQ_SLEEP 1        //Sleep the core (WFI) until HOST_IRQ or the wait deadline instead of polling for events
+#define IA61x_LATENCY_HIST 1     //Histograms of the time from HOST_IRQ to each event handling stage (IA61x_latency.h)
+#define IA61x_RDB_DRAIN 4        //Payload blocks read per event (rdb_drain), 0 reads a single block without the empty block check
+#define IA61x_PARAM_SELFTEST 0   //Test builds: check at start-up that route and preset commands clear the parameter shadow
 
 /*Define, interface specific defines here which are accessed at application level*/
 
+#ifdef IA61x_SAMD21_VQ_AUTO
+    //UART and SPI image options below must match, both images come from ia61x_images_auto.bin
+    #define IA61x_SAMD21_VQ_SPI
+    #define IA61x_SAMD21_VQ_UART
+    #define IA61x_SAMD21_VQ_I2C
+#endif
+
 #ifdef IA61x_SAMD21_VQ_UART
     #define WAIT_KWD_DELAY  250
-    #define IA61X_HOST_INTERFACE    "-- IA61x Host Interface: UART --\r\n"
+    #define IA61x_UART_MAX_BAUD     2048000 //Highest rate tried by the baud negotiation ladder
+    #define IA61x_FW_COMPRESSED     1   //Firmware and Sysconfig are LZ compressed (scripts/fwcompress)
+    #define IA61x_FW_CONTAINER      1   //Images come from ia61x_images_uart.bin (scripts/fwpack)
+    #define IA61x_FW_VERIFY         1   //Check the container section CRC32 before each download
+    #define IA61x_WARM_ATTACH       1   //Reuse IA61x firmware still running after a host reset
+    #define IA61x_FW_ASYNC          1   //Stream the Firmware while the host initializes (download_start)
+    #define IA61x_UART_RX_RING      1   //Receive into an interrupt driven ring, reads never spin on the SERCOM
 #endif
 
 
 #ifdef IA61x_SAMD21_VQ_I2C
     #define WAIT_KWD_DELAY  250
-    #define IA61X_HOST_INTERFACE    "-- IA61x Host Interface: I2C --\r\n"
+    #define IA61x_I2C_FAST_MODE_PLUS 1  //1 MHz SCL (Fast-mode Plus), 400 kHz otherwise
+    #define IA61x_I2C_USE_DMA       1   //Send packets to IA61x with the DMAC
 
 #endif
 
@@ -55,7 +77,15 @@
 #ifdef IA61x_SAMD21_VQ_SPI
 
     #define WAIT_KWD_DELAY  250
-    #define IA61X_HOST_INTERFACE    "-- IA61x Host Interface: SPI --\r\n"
+    #define IA61x_SPI_USE_DMA       1   //Stream Sysconfig and Firmware images to IA61x with the DMAC
+    #define IA61x_FW_COMPRESSED     1   //Firmware and Sysconfig are LZ compressed (scripts/fwcompress)
+    #define IA61x_FW_CONTAINER      1   //Images come from ia61x_images_spi.bin (scripts/fwpack)
+    #define IA61x_FW_VERIFY         1   //Check the container section CRC32 before each download
+    #define IA61x_WARM_ATTACH       1   //Reuse IA61x firmware still running after a host reset
+    #define IA61x_FW_ASYNC          1   //Stream the Firmware while the host initializes (download_start)
+    #define IA61x_SPI_BOOT_SCLK     1000000     //SCLK used with the boot loader and as last resort
+    #define IA61x_SPI_MAX_SCLK      12000000    //Highest SCLK tried by the post boot ramp, SAMD21 SERCOM SPI master rating
+    #define IA61x_SPI_FAIL_STEP_DOWN 3          //Consecutive command failures before SCLK steps down
 
 #endif
 
@@ -0,0 +1,180 @@
+/************************************************************************//**
+ * File: IA61x_event.c
+ *
+ * Description: HOST_IRQ event queue
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include "IA61x_event.h"
+#include "IA61x_samd21_timer.h"
+
+#define EVENT_MASK      (IA61x_EVENT_ENTRIES - 1)
+
+#if (IA61x_EVENT_ENTRIES & EVENT_MASK) != 0
+#error "IA61x_EVENT_ENTRIES must be a power of two"
+#endif
+
+static IA61x_event_ring events;
+
+/* Event handed to the host loop last */
+static IA61x_irq_event event_last;
+
+/***************************************************************************
+ * @fn      IA61x_event_reset()
+ *
+ * @brief   Drop queued events and restart the counters, e.g. when the
+ *          interrupt is registered for a new firmware. Not for interrupt
+ *          context.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_event_reset(void)
+{
+    IA61x_timer_init();
+
+    system_interrupt_enter_critical_section();
+    events.head = 0;
+    events.tail = 0;
+    events.seq = 0;
+    events.overruns = 0;
+    system_interrupt_leave_critical_section();
+}
+
+/***************************************************************************
+ * @fn      IA61x_event_push()
+ *
+ * @brief   Queue a HOST_IRQ edge with its arrival time. Producer side, call
+ *          from the EIC interrupt only.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_event_push(void)
+{
+    uint32_t now = IA61x_timer_us();
+    uint32_t head = events.head;
+    IA61x_irq_event *entry;
+
+    events.seq++;
+    if ((head - events.tail) >= IA61x_EVENT_ENTRIES)
+    {
+        events.overruns++;
+        return;
+    }
+
+    entry = &events.entry[head & EVENT_MASK];
+    entry->us = now;
+    entry->seq = events.seq;
+
+    //The entry is complete before the consumer can see it
+    __DMB();
+    events.head = head + 1;
+}
+
+/***************************************************************************
+ * @fn      IA61x_event_pop()
+ *
+ * @brief   Take the oldest queued event. Consumer side, host loop only.
+ *
+ * @param   event   Receives the event, may be NULL. IA61x_event_last()
+ *                  returns it as well.
+ *
+ * @retval  true    An event was taken
+ * @retval  false   Queue is empty
+ *
+ ****************************************************************************/
+bool IA61x_event_pop(IA61x_irq_event *event)
+{
+    uint32_t tail = events.tail;
+
+    if (tail == events.head)
+        return (false);
+
+    //Read the entry only after seeing the head that published it
+    __DMB();
+    event_last = events.entry[tail & EVENT_MASK];
+    __DMB();
+    events.tail = tail + 1;
+
+    if (event)
+        *event = event_last;
+    return (true);
+}
+
+/***************************************************************************
+ * @fn      IA61x_event_pending()
+ *
+ * @brief   Readiness probe, an event is queued
+ *
+ * @param   ctx     unused
+ *
+ * @retval  true    Queue is not empty
+ *
+ ****************************************************************************/
+bool IA61x_event_pending(void *ctx)
+{
+    (void)ctx;
+    return (events.tail != events.head);
+}
+
+/***************************************************************************
+ * @fn      IA61x_event_overruns()
+ *
+ * @brief   Edges dropped because the queue was full
+ *
+ * @param   none
+ *
+ * @retval  Count since IA61x_event_reset()
+ *
+ ****************************************************************************/
+uint32_t IA61x_event_overruns(void)
+{
+    return (events.overruns);
+}
+
+/***************************************************************************
+ * @fn      IA61x_event_last()
+ *
+ * @brief   Event taken last by IA61x_event_pop(), e.g. for the arrival time
+ *          of the event being handled
+ *
+ * @param   none
+ *
+ * @retval  Event, zero before the first one
+ *
+ ****************************************************************************/
+const IA61x_irq_event *IA61x_event_last(void)
+{
+    return (&event_last);
+}
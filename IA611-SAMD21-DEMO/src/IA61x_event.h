@@ -0,0 +1,79 @@
+/************************************************************************//**
+ * File: IA61x_event.h
+ *
+ * Description: HOST_IRQ event queue
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_EVENT_H_
+#define IA61x_EVENT_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_EVENT_ENTRIES         16          //Ring size, power of two
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* One HOST_IRQ edge */
+typedef struct
+{
+    uint32_t us;                //Arrival, IA61x_timer_us() in the EIC interrupt
+    uint32_t seq;               //Edges since IA61x_event_reset(), counting the ones lost to overruns
+} IA61x_irq_event;
+
+/*
+ * Single producer (EIC interrupt), single consumer (host loop) ring. Each side only writes
+ * its own index, so neither masks interrupts. A full ring drops the new edge and counts it.
+ */
+typedef struct
+{
+    volatile uint32_t head;     //Written by the producer
+    volatile uint32_t tail;     //Written by the consumer
+    volatile uint32_t seq;      //Written by the producer
+    volatile uint32_t overruns; //Written by the producer
+    IA61x_irq_event entry[IA61x_EVENT_ENTRIES];
+} IA61x_event_ring;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+void IA61x_event_reset(void);
+void IA61x_event_push(void);
+bool IA61x_event_pop(IA61x_irq_event *event);
+bool IA61x_event_pending(void *ctx);
+uint32_t IA61x_event_overruns(void);
+const IA61x_irq_event *IA61x_event_last(void);
+
+#endif /* IA61x_EVENT_H_ */
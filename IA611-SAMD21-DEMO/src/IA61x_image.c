@@ -0,0 +1,159 @@
+/************************************************************************//**
+ * File: IA61x_image.c
+ *
+ * Description: IA61x image container, section lookup by ID
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include "IA61x_config.h"
+#if defined(IA61x_FW_CONTAINER) && IA61x_FW_CONTAINER
+
+#include <asf.h>
+#include "IA61x_image.h"
+
+/* Start of the container, see IA61x_images.S */
+extern const uint8_t IA61x_images[];
+
+#define DSU_PAC_BIT     (1ul << (ID_DSU % 32))     //DSU is write protected in PAC1 after reset
+
+static bool table_checked = false;
+
+/***************************************************************************
+ * @fn      image_crc32()
+ *
+ * @brief   CRC32 of a word aligned flash range, computed by the DSU
+ *
+ * @param   data    Start address, 4 byte aligned
+ * @param   size    Number of bytes, rounded up to a multiple of 4
+ * @param   crc     Result, same value as zlib crc32()
+ *
+ * @retval  STATUS_OK           CRC computed
+ * @retval  STATUS_ERR_IO       DSU reported a bus error
+ *
+ ****************************************************************************/
+static enum status_code image_crc32(const void *data, uint32_t size, uint32_t *crc)
+{
+    enum status_code status;
+
+    PAC1->WPCLR.reg = DSU_PAC_BIT;
+
+    DSU->DATA.reg   = 0xFFFFFFFF;
+    DSU->ADDR.reg   = DSU_ADDR_ADDR((uint32_t)data >> 2);
+    DSU->LENGTH.reg = DSU_LENGTH_LENGTH((size + 3) >> 2);
+    DSU->STATUSA.reg = DSU_STATUSA_DONE | DSU_STATUSA_BERR;
+    DSU->CTRL.reg   = DSU_CTRL_CRC;
+
+    while (!(DSU->STATUSA.reg & DSU_STATUSA_DONE)) ;
+
+    status = (DSU->STATUSA.reg & DSU_STATUSA_BERR) ? STATUS_ERR_IO : STATUS_OK;
+    *crc = ~DSU->DATA.reg;
+
+    DSU->STATUSA.reg = DSU_STATUSA_DONE | DSU_STATUSA_BERR;
+    PAC1->WPSET.reg = DSU_PAC_BIT;
+
+    return (status);
+}
+
+/***************************************************************************
+ * @fn      IA61x_image_find()
+ *
+ * @brief   Look up a section of the linked image container. The header and
+ *          table are validated on the first call.
+ *
+ * @param   id          Section ID (IA61x_IMG_xxx)
+ * @param   section     Filled with the section location and attributes
+ *
+ * @retval  STATUS_OK               Section found
+ * @retval  STATUS_ERR_BAD_FORMAT   Container header or table is corrupt
+ * @retval  STATUS_ERR_NOT_FOUND    Container has no such section
+ *
+ ****************************************************************************/
+enum status_code IA61x_image_find(uint16_t id, IA61x_image_section *section)
+{
+    const IA61x_image_header *header = (const IA61x_image_header *)IA61x_images;
+    const IA61x_image_entry *entry = (const IA61x_image_entry *)(header + 1);
+    uint32_t crc;
+    uint16_t i;
+
+    if (!table_checked)
+    {
+        if ((header->magic != IA61x_IMG_MAGIC) || (header->version != IA61x_IMG_VERSION))
+            return (STATUS_ERR_BAD_FORMAT);
+
+        if ((image_crc32(entry, header->count * sizeof(IA61x_image_entry), &crc) != STATUS_OK) ||
+            (crc != header->table_crc))
+            return (STATUS_ERR_BAD_FORMAT);
+
+        table_checked = true;
+    }
+
+    for (i = 0; i < header->count; i++, entry++)
+    {
+        if (entry->id != id)
+            continue;
+
+        if ((entry->offset & 3) || (entry->offset + entry->size > header->total_size))
+            return (STATUS_ERR_BAD_FORMAT);
+
+        section->data     = IA61x_images + entry->offset;
+        section->size     = entry->size;
+        section->raw_size = entry->raw_size;
+        section->crc      = entry->crc;
+        section->id       = entry->id;
+        section->flags    = entry->flags;
+        return (STATUS_OK);
+    }
+
+    return (STATUS_ERR_NOT_FOUND);
+}
+
+/***************************************************************************
+ * @fn      IA61x_image_verify()
+ *
+ * @brief   Check the stored bytes of a section against its CRC32
+ *
+ * @param   section     Section returned by IA61x_image_find()
+ *
+ * @retval  STATUS_OK           Section is intact
+ * @retval  STATUS_ERR_BAD_DATA CRC mismatch
+ * @retval  STATUS_ERR_IO       DSU reported a bus error
+ *
+ ****************************************************************************/
+enum status_code IA61x_image_verify(const IA61x_image_section *section)
+{
+    enum status_code status;
+    uint32_t crc;
+
+    status = image_crc32(section->data, section->size, &crc);
+    if (status != STATUS_OK)
+        return (status);
+
+    return ((crc == section->crc) ? STATUS_OK : STATUS_ERR_BAD_DATA);
+}
+
+#endif /* IA61x_FW_CONTAINER */
@@ -0,0 +1,96 @@
+/************************************************************************//**
+ * File: IA61x_image.h
+ *
+ * Description: IA61x image container, section lookup by ID
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_IMAGE_H_
+#define IA61x_IMAGE_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Container produced by scripts/fwpack/ia61x_pack.py, linked by IA61x_images.S */
+#define IA61x_IMG_MAGIC             0x57463649  //"I6FW"
+#define IA61x_IMG_VERSION           1
+
+/* Section IDs, keep in sync with SECTION_IDS in ia61x_pack.py */
+#define IA61x_IMG_PROGRAM_UART      0x0101
+#define IA61x_IMG_PROGRAM_SPI       0x0102
+#define IA61x_IMG_PROGRAM_I2C       0x0103
+#define IA61x_IMG_SYSCONFIG         0x0200
+#define IA61x_IMG_KEYWORD(n)        (0x0300 + (n))
+
+/* Section flags */
+#define IA61x_IMG_FLAG_LZ           0x0001      //Stored LZ compressed, see IA61x_lz.h
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;             //Number of table entries
+    uint32_t total_size;        //Header, table and payload
+    uint32_t table_crc;         //CRC32 of the table
+} IA61x_image_header;
+
+typedef struct
+{
+    uint16_t id;
+    uint16_t flags;
+    uint32_t offset;            //From the start of the container, 4 byte aligned
+    uint32_t size;              //Stored bytes
+    uint32_t raw_size;          //Bytes sent to IA61x
+    uint32_t crc;               //CRC32 of the stored bytes, zero padded to 4
+} IA61x_image_entry;
+
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t size;
+    uint32_t raw_size;
+    uint32_t crc;
+    uint16_t id;
+    uint16_t flags;
+} IA61x_image_section;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+enum status_code IA61x_image_find(uint16_t id, IA61x_image_section *section);
+enum status_code IA61x_image_verify(const IA61x_image_section *section);
+
+#endif /* IA61x_IMAGE_H_ */
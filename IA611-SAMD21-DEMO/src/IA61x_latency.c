@@ -0,0 +1,282 @@
+/************************************************************************//**
+ * File: IA61x_latency.c
+ *
+ * Description: HOST_IRQ to payload latency histograms
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include "IA61x_config.h"
+#if defined(IA61x_LATENCY_HIST) && IA61x_LATENCY_HIST
+
+#include <asf.h>
+#include <stdio.h>
+#include <string.h>
+#include "IA61x.h"
+#include "IA61x_latency.h"
+#include "IA61x_samd21_timer.h"
+
+static IA61x_lat_hist lat_hist[IA61x_LAT_EVENTS][IA61x_LAT_STAGES];
+
+/* Event being timed */
+static bool lat_open = false;
+static uint32_t lat_irq_us;
+static uint32_t lat_us[IA61x_LAT_STAGES];
+static uint8_t lat_seen;        //Bit per stage marked
+
+static const char *const stage_name[IA61x_LAT_STAGES] =
+{
+    "event_id", "rdb_start", "rdb_end", "payload", "keyword", "rearm"
+};
+
+static const char *const event_name[IA61x_LAT_EVENTS] =
+{
+    "payload", "auth", "other"
+};
+
+/***************************************************************************
+ * @fn      lat_bucket()
+ *
+ * @brief   Histogram bucket of a latency
+ *
+ * @param   us      Latency
+ *
+ * @retval  Bucket index
+ *
+ ****************************************************************************/
+static uint32_t lat_bucket(uint32_t us)
+{
+    uint32_t msb;
+
+    if (us < 4)
+        return (us);
+
+    msb = 31 - __builtin_clz(us);
+    if (msb >= 22)
+        return (IA61x_LAT_BUCKETS - 1);
+
+    return (4 * (msb - 1) + ((us >> (msb - 2)) & 3));
+}
+
+/***************************************************************************
+ * @fn      lat_bucket_floor()
+ *
+ * @brief   Smallest latency that falls into a bucket
+ *
+ * @param   bucket  Bucket index
+ *
+ * @retval  Latency in us
+ *
+ ****************************************************************************/
+static uint32_t lat_bucket_floor(uint32_t bucket)
+{
+    if (bucket < 4)
+        return (bucket);
+
+    return ((4 + (bucket & 3)) << (bucket / 4 - 1));
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_begin()
+ *
+ * @brief   Start timing an event. An event still open is dropped, e.g.
+ *          one that turned out to be spurious.
+ *
+ * @param   irq_us  Timer value at the HOST_IRQ edge (IA61x_event_last)
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_lat_begin(uint32_t irq_us)
+{
+    lat_irq_us = irq_us;
+    lat_seen = 0;
+    lat_open = true;
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_mark()
+ *
+ * @brief   Record the time since HOST_IRQ for a stage. Only the first mark
+ *          of a stage counts, outside of an event nothing is recorded.
+ *
+ * @param   stage   Stage reached
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_lat_mark(IA61x_lat_stage stage)
+{
+    if (!lat_open || (stage >= IA61x_LAT_STAGES) || (lat_seen & (1u << stage)))
+        return;
+
+    lat_us[stage] = IA61x_timer_elapsed_us(lat_irq_us);
+    lat_seen |= (1u << stage);
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_end()
+ *
+ * @brief   Close the event and add its marked stages to the histograms of
+ *          the event class
+ *
+ * @param   event   Event class
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_lat_end(IA61x_lat_event event)
+{
+    IA61x_lat_hist *hist;
+    uint32_t stage, b;
+
+    if (!lat_open || (event >= IA61x_LAT_EVENTS))
+        return;
+    lat_open = false;
+
+    for (stage = 0; stage < IA61x_LAT_STAGES; stage++)
+    {
+        if (!(lat_seen & (1u << stage)))
+            continue;
+
+        hist = &lat_hist[event][stage];
+        b = lat_bucket(lat_us[stage]);
+        if (hist->bucket[b] != 0xFFFF)
+            hist->bucket[b]++;
+        if (lat_us[stage] > hist->max_us)
+            hist->max_us = lat_us[stage];
+        hist->count++;
+    }
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_percentile()
+ *
+ * @brief   Latency below which a share of the samples falls, rounded up to
+ *          the end of its bucket and capped at the largest sample
+ *
+ * @param   hist        Histogram
+ * @param   percent     Share, 1 to 100
+ *
+ * @retval  Latency in us, 0 without samples
+ *
+ ****************************************************************************/
+uint32_t IA61x_lat_percentile(const IA61x_lat_hist *hist, uint8_t percent)
+{
+    uint32_t total = 0, rank, seen = 0, b, ceil_us;
+
+    for (b = 0; b < IA61x_LAT_BUCKETS; b++)
+        total += hist->bucket[b];
+    if (!total)
+        return (0);
+
+    //Rank of the sample, counted from 1
+    rank = (total * percent + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+
+    for (b = 0; b < IA61x_LAT_BUCKETS - 1; b++)
+    {
+        seen += hist->bucket[b];
+        if (seen >= rank)
+            break;
+    }
+
+    ceil_us = (b < IA61x_LAT_BUCKETS - 1) ? (lat_bucket_floor(b + 1) - 1) : hist->max_us;
+    return ((ceil_us < hist->max_us) ? ceil_us : hist->max_us);
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_get()
+ *
+ * @brief   Histogram of one stage of an event class
+ *
+ * @param   event   Event class
+ * @param   stage   Stage
+ *
+ * @retval  Histogram, NULL if out of range
+ *
+ ****************************************************************************/
+const IA61x_lat_hist *IA61x_lat_get(IA61x_lat_event event, IA61x_lat_stage stage)
+{
+    if ((event >= IA61x_LAT_EVENTS) || (stage >= IA61x_LAT_STAGES))
+        return (NULL);
+
+    return (&lat_hist[event][stage]);
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_print()
+ *
+ * @brief   Print sample count, p50, p99 and maximum of each stage that has
+ *          samples, in us since HOST_IRQ, per event class. The histograms
+ *          cover the host interface bound since start-up.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_lat_print(void)
+{
+    const IA61x_lat_hist *hist;
+    uint32_t event, stage;
+
+    printf("Latency from HOST_IRQ, %s interface\r\n", IA61x_host_name());
+    printf("%-8s %-10s %8s %10s %10s %10s\r\n", "event", "stage", "count", "p50 us", "p99 us", "max us");
+
+    for (event = 0; event < IA61x_LAT_EVENTS; event++)
+    {
+        for (stage = 0; stage < IA61x_LAT_STAGES; stage++)
+        {
+            hist = &lat_hist[event][stage];
+            if (!hist->count)
+                continue;
+
+            printf("%-8s %-10s %8lu %10lu %10lu %10lu\r\n", event_name[event], stage_name[stage], hist->count,
+                   IA61x_lat_percentile(hist, 50), IA61x_lat_percentile(hist, 99), hist->max_us);
+        }
+    }
+}
+
+/***************************************************************************
+ * @fn      IA61x_lat_clear()
+ *
+ * @brief   Drop all samples
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_lat_clear(void)
+{
+    memset(lat_hist, 0, sizeof(lat_hist));
+    lat_open = false;
+}
+
+#endif /* IA61x_LATENCY_HIST */
@@ -0,0 +1,108 @@
+/************************************************************************//**
+ * File: IA61x_latency.h
+ *
+ * Description: HOST_IRQ to payload latency histograms
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_LATENCY_H_
+#define IA61x_LATENCY_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Log scale buckets, four per octave (14% to 25% wide). Values from 0 to 3 us have a bucket
+ * each, the last bucket takes everything from 2^22 us (4.2 s) on. */
+#define IA61x_LAT_BUCKETS           85
+
+/* Time an event from HOST_IRQ to each stage. Timestamps are taken from IA61x_timer_us(). */
+#if defined(IA61x_LATENCY_HIST) && IA61x_LATENCY_HIST
+#define IA61x_LATENCY_BEGIN(irq_us)     IA61x_lat_begin(irq_us)
+#define IA61x_LATENCY_MARK(stage)       IA61x_lat_mark(stage)
+#define IA61x_LATENCY_END(event)        IA61x_lat_end(event)
+#else
+#define IA61x_LATENCY_BEGIN(irq_us)     do {} while (0)
+#define IA61x_LATENCY_MARK(stage)       do {} while (0)
+#define IA61x_LATENCY_END(event)        do {} while (0)
+#endif
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Stages of an event, each measured from the HOST_IRQ edge. Keep in step with the names in
+ * IA61x_latency.c */
+typedef enum
+{
+    IA61x_LAT_EVENT_ID = 0,     //GET_EVENT_ID answered with an event
+    IA61x_LAT_RDB_START,        //First rdb of the event sent
+    IA61x_LAT_RDB_END,          //First rdb of the event read
+    IA61x_LAT_PAYLOAD,          //Payload printed
+    IA61x_LAT_KEYWORD,          //Keyword data downloaded on an auth event
+    IA61x_LAT_REARM,            //Detection resumed
+    IA61x_LAT_STAGES
+} IA61x_lat_stage;
+
+/* Event classes with a histogram set of their own */
+typedef enum
+{
+    IA61x_LAT_EV_PAYLOAD = 0,   //TRILL_KW_PAYLOAD_AVAILABLE
+    IA61x_LAT_EV_AUTH,          //TRILL_KW_HOST_AUTH_NEEDED
+    IA61x_LAT_EV_OTHER,
+    IA61x_LAT_EVENTS
+} IA61x_lat_event;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_us;
+    uint16_t bucket[IA61x_LAT_BUCKETS];     //Saturated at 0xFFFF
+} IA61x_lat_hist;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+#if defined(IA61x_LATENCY_HIST) && IA61x_LATENCY_HIST
+void IA61x_lat_begin(uint32_t irq_us);
+void IA61x_lat_mark(IA61x_lat_stage stage);
+void IA61x_lat_end(IA61x_lat_event event);
+uint32_t IA61x_lat_percentile(const IA61x_lat_hist *hist, uint8_t percent);
+const IA61x_lat_hist *IA61x_lat_get(IA61x_lat_event event, IA61x_lat_stage stage);
+void IA61x_lat_print(void);
+void IA61x_lat_clear(void);
+#else
+#define IA61x_lat_print()
+#define IA61x_lat_clear()
+#endif
+
+#endif /* IA61x_LATENCY_H_ */
@@ -0,0 +1,151 @@
+/************************************************************************//**
+ * File: IA61x_lz.c
+ *
+ * Description: Streaming decoder for LZ compressed IA61x download images
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include <string.h>
+#include "IA61x_lz.h"
+
+#define LZ_RING_MASK    (IA61x_LZ_WINDOW - 1)
+
+/***************************************************************************
+ * @fn      IA61x_lz_open()
+ *
+ * @brief   Prepare a decoder for a compressed image
+ *
+ * @param   s           Decoder state
+ * @param   src         Compressed stream, usually in flash
+ * @param   size        Compressed size in bytes
+ * @param   raw_size    Decoded size in bytes
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_lz_open(IA61x_lz_stream *s, const uint8_t *src, uint32_t size, uint32_t raw_size)
+{
+    s->src        = src;
+    s->src_end    = src + size;
+    s->remaining  = raw_size;
+    s->pos        = 0;
+    s->match_off  = 0;
+    s->match_len  = 0;
+    s->flags      = 0;
+    s->flag_bits  = 0;
+    s->corrupt    = false;
+    memset(s->ring, 0, sizeof(s->ring));
+}
+
+/***************************************************************************
+ * @fn      IA61x_lz_read_block()
+ *
+ * @brief   Decode the next block (up to IA61x_LZ_BLOCK bytes) into the free
+ *          half of the ring. The other half, returned by the previous call,
+ *          is only read, so it may still be on its way to the IA61x.
+ *
+ * @param   s       Decoder state
+ * @param   block   Set to the decoded bytes
+ *
+ * @retval  Number of bytes decoded, 0 at the end of the image or on a
+ *          corrupt stream (see IA61x_lz_complete)
+ *
+ ****************************************************************************/
+uint32_t IA61x_lz_read_block(IA61x_lz_stream *s, const uint8_t **block)
+{
+    uint8_t *ring = s->ring;
+    const uint8_t *src = s->src;
+    uint32_t start = s->pos;
+    uint32_t pos = start;
+    uint32_t end;
+
+    if (s->corrupt || (s->remaining == 0))
+        return (0);
+
+    end = start + ((s->remaining < IA61x_LZ_BLOCK) ? s->remaining : IA61x_LZ_BLOCK);
+
+    while (pos < end)
+    {
+        if (s->match_len)
+        {
+            uint32_t from = (pos - s->match_off) & LZ_RING_MASK;
+            uint32_t n = end - pos;
+
+            if (n > s->match_len)
+                n = s->match_len;
+            s->match_len -= n;
+
+            while (n--)
+            {
+                ring[pos++] = ring[from];
+                from = (from + 1) & LZ_RING_MASK;
+            }
+            continue;
+        }
+
+        if (s->flag_bits == 0)
+        {
+            if (src >= s->src_end)
+                break;
+            s->flags = *src++;
+            s->flag_bits = 8;
+        }
+
+        s->flag_bits--;
+        if (s->flags & 1)
+        {
+            if (src >= s->src_end)
+                break;
+            ring[pos++] = *src++;
+        }
+        else
+        {
+            uint16_t token;
+
+            if (src + 2 > s->src_end)
+                break;
+            token = src[0] | (src[1] << 8);
+            src += 2;
+
+            s->match_off = (token & ((1 << IA61x_LZ_OFFSET_BITS) - 1)) + 1;
+            s->match_len = (token >> IA61x_LZ_OFFSET_BITS) + IA61x_LZ_MIN_MATCH;
+        }
+        s->flags >>= 1;
+    }
+
+    if (pos < end)
+        s->corrupt = true;      //Compressed stream ended before the image
+
+    s->src = src;
+    s->remaining -= pos - start;
+    s->pos = pos & LZ_RING_MASK;
+
+    *block = &ring[start];
+    return (pos - start);
+}
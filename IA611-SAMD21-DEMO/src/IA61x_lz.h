@@ -0,0 +1,83 @@
+/************************************************************************//**
+ * File: IA61x_lz.h
+ *
+ * Description: Streaming decoder for LZ compressed IA61x download images
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_LZ_H_
+#define IA61x_LZ_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/*
+ * Stream format (written by scripts/fwcompress/ia61x_lz.py):
+ * a flag byte announces the next 8 items, LSB first. A set bit is a literal byte,
+ * a clear bit a 16 bit little endian match token: bits 0-9 offset - 1, bits 10-15 length - 3.
+ */
+#define IA61x_LZ_WINDOW         1024    //History window, also the download double buffer
+#define IA61x_LZ_BLOCK          (IA61x_LZ_WINDOW / 2)
+#define IA61x_LZ_OFFSET_BITS    10
+#define IA61x_LZ_MIN_MATCH      3
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+typedef struct
+{
+    const uint8_t *src;         //Next compressed byte
+    const uint8_t *src_end;
+    uint32_t remaining;         //Decoded bytes still to be produced
+    uint16_t pos;               //Ring index of the next block
+    uint16_t match_off;         //Match carried over a block boundary
+    uint8_t  match_len;
+    uint8_t  flags;
+    uint8_t  flag_bits;
+    bool     corrupt;
+    uint8_t  ring[IA61x_LZ_WINDOW];
+} IA61x_lz_stream;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+void IA61x_lz_open(IA61x_lz_stream *s, const uint8_t *src, uint32_t size, uint32_t raw_size);
+uint32_t IA61x_lz_read_block(IA61x_lz_stream *s, const uint8_t **block);
+
+/* True once the whole image was decoded from a well formed stream */
+static inline bool IA61x_lz_complete(const IA61x_lz_stream *s)
+{
+    return (!s->corrupt && (s->remaining == 0) && (s->match_len == 0));
+}
+
+#endif /* IA61x_LZ_H_ */
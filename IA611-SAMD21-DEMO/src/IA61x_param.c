@@ -0,0 +1,470 @@
+/************************************************************************//**
+ * File: IA61x_param.c
+ *
+ * Description: Host side shadow of IA61x algorithm parameters and digital gain
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include "IA61x.h"
+#include "IA61x_param.h"
+
+/*
+ * The shadow holds the values the host knows IA61x has: written and echoed, or read back.
+ * It is kept by IA61x_param_observe(), which sees every command the queue and cmd_batch
+ * complete, so raw IA61x->cmd() writes keep it coherent too. A preset, a route stop or
+ * selection reset the algorithm parameters behind the host's back and a power cycle reloads
+ * the firmware, all of them clear it.
+ *
+ * The observer also tracks whether a route is set up: a preset or route selection sets it
+ * up and is remembered, a route stop or power cycle tears it down.
+ */
+#define PARAM_NO_RESP_BIT           (CMD_NO_RESP_MASK & ~0x8000)    //Set on the send only variant of a command
+
+typedef struct
+{
+    uint8_t kind;               //IA61x_PARAM_xxx, 0 if the slot is free
+    uint16_t id;                //Parameter ID or end point ID
+    uint16_t value;
+} IA61x_param_shadow;
+
+static IA61x_param_shadow param_shadow[IA61x_PARAM_SLOTS];
+static uint8_t param_next = 0;
+
+static uint16_t param_selected;         //Parameter ID of the last SET_ALGO_PARAM_ID
+static bool param_selected_valid = false;
+
+static bool param_route_armed = false;  //A preset or route is set up
+static uint16_t param_arm_cmd;          //Command that set it up, with the send only bit as sent
+static uint16_t param_arm_data;
+
+/***************************************************************************
+ * @fn      param_find()
+ *
+ * @brief   Find the shadow slot of a value
+ *
+ * @param   kind    IA61x_PARAM_ALGO or IA61x_PARAM_GAIN
+ * @param   id      Parameter ID or end point ID
+ *
+ * @retval  Slot, NULL if the value is not known
+ *
+ ****************************************************************************/
+static IA61x_param_shadow *param_find(uint8_t kind, uint16_t id)
+{
+    uint32_t i;
+
+    for (i = 0; i < IA61x_PARAM_SLOTS; i++)
+    {
+        if ((param_shadow[i].kind == kind) && (param_shadow[i].id == id))
+            return (&param_shadow[i]);
+    }
+    return (NULL);
+}
+
+/***************************************************************************
+ * @fn      param_record()
+ *
+ * @brief   Record a value IA61x is known to have
+ *
+ * @param   kind    IA61x_PARAM_ALGO or IA61x_PARAM_GAIN
+ * @param   id      Parameter ID or end point ID
+ * @param   value   Value
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void param_record(uint8_t kind, uint16_t id, uint16_t value)
+{
+    IA61x_param_shadow *slot = param_find(kind, id);
+    uint32_t i;
+
+    for (i = 0; !slot && (i < IA61x_PARAM_SLOTS); i++)
+    {
+        if (param_shadow[i].kind == 0)
+            slot = &param_shadow[i];
+    }
+    if (!slot)
+    {
+        slot = &param_shadow[param_next];
+        param_next = (param_next + 1) % IA61x_PARAM_SLOTS;
+    }
+
+    slot->kind  = kind;
+    slot->id    = id;
+    slot->value = value;
+}
+
+/***************************************************************************
+ * @fn      param_forget()
+ *
+ * @brief   Drop a value whose write failed, IA61x state is unknown
+ *
+ * @param   kind    IA61x_PARAM_ALGO or IA61x_PARAM_GAIN
+ * @param   id      Parameter ID or end point ID
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void param_forget(uint8_t kind, uint16_t id)
+{
+    IA61x_param_shadow *slot = param_find(kind, id);
+
+    if (slot)
+        slot->kind = 0;
+}
+
+/***************************************************************************
+ * @fn      param_lookup()
+ *
+ * @brief   Read a shadowed value, the observer may run from the command
+ *          queue interrupt
+ *
+ * @param   kind    IA61x_PARAM_ALGO or IA61x_PARAM_GAIN
+ * @param   id      Parameter ID or end point ID
+ * @param   value   Value if known
+ *
+ * @retval  true if the value is known
+ *
+ ****************************************************************************/
+static bool param_lookup(uint8_t kind, uint16_t id, uint16_t *value)
+{
+    IA61x_param_shadow *slot;
+
+    system_interrupt_enter_critical_section();
+    slot = param_find(kind, id);
+    if (slot)
+        *value = slot->value;
+    system_interrupt_leave_critical_section();
+
+    return (slot != NULL);
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_observe()
+ *
+ * @brief   Update the shadow from a completed command. Called by the
+ *          command queue and cmd_batch, interrupt or thread context.
+ *
+ * @param   cmdWord     Command word sent
+ * @param   dataWord    Data word sent
+ * @param   result      CMD_SUCCESS if IA61x answered (or took a send only command)
+ * @param   response    Response word, not checked for send only commands
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_param_observe(uint16_t cmdWord, uint16_t dataWord, int32_t result, uint16_t response)
+{
+    bool no_resp = ((cmdWord & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK);
+    bool ok = (result == CMD_SUCCESS) && (no_resp || (response == dataWord));
+
+    switch (cmdWord & ~PARAM_NO_RESP_BIT)
+    {
+        case SET_PRESET_CMD:
+        case SELECT_ROUTE_CMD:
+            IA61x_param_invalidate();
+            param_route_armed = ok;
+            param_arm_cmd = cmdWord;
+            param_arm_data = dataWord;
+            break;
+
+        case STOP_ROUTE_CMD:
+            IA61x_param_invalidate(); //Also tears the route down
+            break;
+
+        case SET_ALGO_PARAM_ID:
+            param_selected = dataWord;
+            param_selected_valid = ok;
+            break;
+
+        case SET_ALGO_PARAM:
+            if (!param_selected_valid)
+                break;
+            if (ok)
+                param_record(IA61x_PARAM_ALGO, param_selected, dataWord);
+            else
+                param_forget(IA61x_PARAM_ALGO, param_selected);
+            break;
+
+        case GET_ALGO_PARAM:
+            if ((result == CMD_SUCCESS) && !no_resp)
+                param_record(IA61x_PARAM_ALGO, dataWord, response);
+            break;
+
+        case SET_DIGITAL_GAIN_CMD:
+            if (ok)
+                param_record(IA61x_PARAM_GAIN, dataWord >> 8, dataWord & 0xFF);
+            else
+                param_forget(IA61x_PARAM_GAIN, dataWord >> 8);
+            break;
+
+        case GET_DIGITAL_GAIN:
+            if ((result == CMD_SUCCESS) && !no_resp)
+                param_record(IA61x_PARAM_GAIN, dataWord >> 8, response & 0xFF);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_invalidate()
+ *
+ * @brief   Forget all shadowed values and the route state. Called when
+ *          IA61x is power cycled, a preset or route command clears the
+ *          values through the observer.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_param_invalidate(void)
+{
+    uint32_t i;
+
+    system_interrupt_enter_critical_section();
+    for (i = 0; i < IA61x_PARAM_SLOTS; i++)
+        param_shadow[i].kind = 0;
+    param_selected_valid = false;
+    param_route_armed = false;
+    system_interrupt_leave_critical_section();
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_armed()
+ *
+ * @brief   Check if a preset or route was set up and not stopped since
+ *
+ * @param   cmdWord     SET_PRESET_CMD or SELECT_ROUTE_CMD as it was sent
+ * @param   dataWord    Preset or route
+ *
+ * @retval  true if the route is known to be set up
+ *
+ ****************************************************************************/
+bool IA61x_param_armed(uint16_t *cmdWord, uint16_t *dataWord)
+{
+    bool armed;
+
+    system_interrupt_enter_critical_section();
+    armed = param_route_armed;
+    *cmdWord = param_arm_cmd;
+    *dataWord = param_arm_data;
+    system_interrupt_leave_critical_section();
+
+    return (armed);
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_has()
+ *
+ * @brief   Check if IA61x is known to have a value, so writing it again
+ *          can be left out
+ *
+ * @param   kind    IA61x_PARAM_ALGO or IA61x_PARAM_GAIN
+ * @param   id      Parameter ID or end point ID
+ * @param   value   Value, the gain in db for IA61x_PARAM_GAIN
+ *
+ * @retval  true if the shadow holds this value
+ *
+ ****************************************************************************/
+bool IA61x_param_has(uint8_t kind, uint16_t id, uint16_t value)
+{
+    uint16_t current;
+
+    return (param_lookup(kind, id, &current) && (current == value));
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_set()
+ *
+ * @brief   Set an algorithm parameter. Nothing is sent if IA61x is known
+ *          to have the value already.
+ *
+ * @param   param_id    Parameter ID, e.g. OEM_SENSITIVITY_PARAM
+ * @param   value       Value
+ *
+ * @retval  CMD_SUCCESS Parameter has the value
+ * @retval  CMD_FAILED  Command failed or was not echoed
+ *
+ ****************************************************************************/
+int32_t IA61x_param_set(uint16_t param_id, uint16_t value)
+{
+    IA61x_cmd_entry set[] = {
+        { SET_ALGO_PARAM_ID,    param_id,   param_id,   0,                      1 },
+        { SET_ALGO_PARAM,       value,      value,      IA61x_BATCH_CHAINED,    1 },
+    };
+    if (IA61x_param_has(IA61x_PARAM_ALGO, param_id, value))
+        return (CMD_SUCCESS);
+
+    return (IA61x_cmd_batch(set, 2) ? CMD_FAILED : CMD_SUCCESS);
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_get()
+ *
+ * @brief   Get an algorithm parameter, from the shadow if it is known
+ *
+ * @param   param_id    Parameter ID, e.g. OEM_SENSITIVITY_PARAM
+ * @param   value       Value
+ *
+ * @retval  CMD_SUCCESS Value is valid
+ * @retval  CMD_FAILED  Command failed
+ *
+ ****************************************************************************/
+int32_t IA61x_param_get(uint16_t param_id, uint16_t *value)
+{
+    IA61x_cmd_entry get = { GET_ALGO_PARAM, param_id, 0, IA61x_BATCH_ANY_RESP, 1 };
+
+    if (param_lookup(IA61x_PARAM_ALGO, param_id, value))
+        return (CMD_SUCCESS);
+
+    if (IA61x_cmd_batch(&get, 1))
+        return (CMD_FAILED);
+
+    *value = get.response;
+    return (CMD_SUCCESS);
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_set_gain()
+ *
+ * @brief   Set the digital gain of an end point. Nothing is sent if IA61x
+ *          is known to have the gain already.
+ *
+ * @param   gain    End point ID in the high byte, gain in db in the low
+ *                  byte, e.g. DIGITAL_GAIN_20
+ *
+ * @retval  CMD_SUCCESS End point has the gain
+ * @retval  CMD_FAILED  Command failed or was not echoed
+ *
+ ****************************************************************************/
+int32_t IA61x_param_set_gain(uint16_t gain)
+{
+    IA61x_cmd_entry set = { SET_DIGITAL_GAIN_CMD, gain, gain, 0, 1 };
+    if (IA61x_param_has(IA61x_PARAM_GAIN, gain >> 8, gain & 0xFF))
+        return (CMD_SUCCESS);
+
+    return (IA61x_cmd_batch(&set, 1) ? CMD_FAILED : CMD_SUCCESS);
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_get_gain()
+ *
+ * @brief   Get the digital gain of an end point, from the shadow if it is
+ *          known
+ *
+ * @param   end_point   End point ID in the high byte, e.g. END_POINT_ID
+ * @param   gain_db     Gain in db
+ *
+ * @retval  CMD_SUCCESS Gain is valid
+ * @retval  CMD_FAILED  Command failed
+ *
+ ****************************************************************************/
+int32_t IA61x_param_get_gain(uint16_t end_point, uint16_t *gain_db)
+{
+    IA61x_cmd_entry get = { GET_DIGITAL_GAIN, end_point, 0, IA61x_BATCH_ANY_RESP, 1 };
+
+    if (param_lookup(IA61x_PARAM_GAIN, end_point >> 8, gain_db))
+        return (CMD_SUCCESS);
+
+    if (IA61x_cmd_batch(&get, 1))
+        return (CMD_FAILED);
+
+    *gain_db = get.response & 0xFF;
+    return (CMD_SUCCESS);
+}
+
+#if defined(IA61x_PARAM_SELFTEST) && IA61x_PARAM_SELFTEST
+/***************************************************************************
+ * @fn      param_selftest_record()
+ *
+ * @brief   Feed the observer an answered sensitivity and gain write
+ *
+ * @param   value   Value of both
+ *
+ * @retval  true if the shadow took both values
+ *
+ ****************************************************************************/
+static bool param_selftest_record(uint16_t value)
+{
+    uint16_t gain = (0x01 << 8) | value;
+
+    IA61x_param_observe(SET_ALGO_PARAM_ID, OEM_SENSITIVITY_PARAM, CMD_SUCCESS, OEM_SENSITIVITY_PARAM);
+    IA61x_param_observe(SET_ALGO_PARAM, value, CMD_SUCCESS, value);
+    IA61x_param_observe(SET_DIGITAL_GAIN_CMD, gain, CMD_SUCCESS, gain);
+
+    return (IA61x_param_has(IA61x_PARAM_ALGO, OEM_SENSITIVITY_PARAM, value) &&
+            IA61x_param_has(IA61x_PARAM_GAIN, 0x01, value));
+}
+
+/***************************************************************************
+ * @fn      IA61x_param_selftest()
+ *
+ * @brief   Check with synthetic commands that a route stop, a route
+ *          selection and a preset each clear the shadow. Run before
+ *          IA61x_init(), the shadow is left empty.
+ *
+ * @param   none
+ *
+ * @retval  true if all checks passed
+ *
+ ****************************************************************************/
+bool IA61x_param_selftest(void)
+{
+    const uint16_t reset_cmd[][2] = {
+        { STOP_ROUTE_CMD,   0x0000 },
+        { SELECT_ROUTE_CMD, 0x0006 },
+        { SET_PRESET_CMD | CMD_NO_RESP_MASK, PRESET_VALUE(2) },
+    };
+    uint16_t cmdWord, dataWord;
+    bool pass = true;
+    uint32_t i;
+
+    IA61x_param_invalidate();
+    for (i = 0; i < sizeof(reset_cmd) / sizeof(reset_cmd[0]); i++)
+    {
+        if (!param_selftest_record(3 + i))
+            pass = false;
+
+        IA61x_param_observe(reset_cmd[i][0], reset_cmd[i][1], CMD_SUCCESS, reset_cmd[i][1]);
+        if (IA61x_param_has(IA61x_PARAM_ALGO, OEM_SENSITIVITY_PARAM, 3 + i) ||
+            IA61x_param_has(IA61x_PARAM_GAIN, 0x01, 3 + i))
+            pass = false;
+    }
+
+    //A stop after the selection leaves no route set up
+    IA61x_param_observe(STOP_ROUTE_CMD, 0x0000, CMD_SUCCESS, 0x0000);
+    if (IA61x_param_armed(&cmdWord, &dataWord))
+        pass = false;
+
+    IA61x_param_invalidate();
+    return (pass);
+}
+#endif /* IA61x_PARAM_SELFTEST */
@@ -0,0 +1,66 @@
+/************************************************************************//**
+ * File: IA61x_param.h
+ *
+ * Description: Host side shadow of IA61x algorithm parameters and digital gain
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_PARAM_H_
+#define IA61x_PARAM_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_PARAM_SLOTS           8       //Values shadowed, replaced round robin
+
+/* Shadow kinds */
+#define IA61x_PARAM_ALGO            1       //Algorithm parameter, keyed by parameter ID
+#define IA61x_PARAM_GAIN            2       //Digital gain, keyed by end point ID
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+int32_t IA61x_param_set(uint16_t param_id, uint16_t value);
+int32_t IA61x_param_get(uint16_t param_id, uint16_t *value);
+int32_t IA61x_param_set_gain(uint16_t gain);
+int32_t IA61x_param_get_gain(uint16_t end_point, uint16_t *gain_db);
+
+void IA61x_param_observe(uint16_t cmdWord, uint16_t dataWord, int32_t result, uint16_t response);
+void IA61x_param_invalidate(void);
+bool IA61x_param_armed(uint16_t *cmdWord, uint16_t *dataWord);
+bool IA61x_param_has(uint8_t kind, uint16_t id, uint16_t value);
+#if defined(IA61x_PARAM_SELFTEST) && IA61x_PARAM_SELFTEST
+bool IA61x_param_selftest(void);
+#endif
+
+#endif /* IA61x_PARAM_H_ */
@@ -0,0 +1,252 @@
+/************************************************************************//**
+ * File: IA61x_profile.c
+ *
+ * Description: Boot timeline profiler
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include "IA61x_config.h"
+#if defined(IA61x_BOOT_PROFILE) && IA61x_BOOT_PROFILE
+
+#include <asf.h>
+#include <stdio.h>
+#include <string.h>
+#include "IA61x_profile.h"
+#include "IA61x_samd21_timer.h"
+
+IA61x_NOINIT static IA61x_prof_record prof;
+
+static uint16_t chunk_base;     //Chunk count at the last IA61x_PROF_DL_START
+static uint32_t chunk_dropped;  //Dropped chunk count at the last IA61x_PROF_DL_START
+
+static const char *const stage_name[IA61x_PROF_STAGES] =
+{
+    "start", "delay_init", "console_init", "nvm_init", "sdk_init", "IA61x_init",
+    "download_config", "download_program", "VoiceWake", "config_outClk",
+    "version_algo", "version_fw", "ready",
+    " ldo_on", " ldo_settled", " sync", " rate", " dl_start", " dl_end", " fw_ready", " warm"
+};
+
+/***************************************************************************
+ * @fn      IA61x_prof_start()
+ *
+ * @brief   Start a new boot profile. Call right after system_init, the
+ *          microsecond timer needs the final GCLK0 setup. If the previous
+ *          boot was profiled but never reached IA61x_PROF_READY, its last
+ *          stage is kept in prev_stage.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_prof_start(void)
+{
+    uint16_t prev_stage = IA61x_PROF_STAGES;
+    uint32_t boots = 0;
+
+    if ((prof.magic == IA61x_PROF_MAGIC) && (prof.events <= IA61x_PROF_EVENTS))
+    {
+        boots = prof.boots;
+        if (!prof.complete && prof.events)
+            prev_stage = prof.event[prof.events - 1].stage;
+    }
+
+    memset(&prof, 0, sizeof(prof));
+    prof.magic = IA61x_PROF_MAGIC;
+    prof.boots = boots + 1;
+    prof.prev_stage = prev_stage;
+    chunk_base = 0;
+    chunk_dropped = 0;
+
+    IA61x_timer_init();
+    IA61x_prof_mark(IA61x_PROF_START, 0);
+}
+
+/***************************************************************************
+ * @fn      IA61x_prof_mark()
+ *
+ * @brief   Record a stage boundary. For IA61x_PROF_DL_END the chunk count
+ *          of the download is filled in.
+ *
+ * @param   stage   Stage that just ended
+ * @param   arg     Stage specific value
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_prof_mark(IA61x_prof_stage stage, uint16_t arg)
+{
+    uint32_t now = IA61x_timer_us();
+
+    prof.last_us = now;
+
+    if (stage == IA61x_PROF_DL_START)
+    {
+        chunk_base = prof.chunks;
+        chunk_dropped = prof.dropped;
+    }
+    else if (stage == IA61x_PROF_DL_END)
+    {
+        arg = (prof.chunks - chunk_base) + (prof.dropped - chunk_dropped);
+    }
+    else if (stage == IA61x_PROF_READY)
+    {
+        prof.complete = true;
+    }
+
+    if (prof.events >= IA61x_PROF_EVENTS)
+    {
+        prof.dropped++;
+        return;
+    }
+
+    prof.event[prof.events].us = now;
+    prof.event[prof.events].stage = stage;
+    prof.event[prof.events].arg = arg;
+    prof.events++;
+}
+
+/***************************************************************************
+ * @fn      IA61x_prof_chunk()
+ *
+ * @brief   Record a download chunk. Its duration runs from the previous
+ *          event or chunk, so the first chunk starts at IA61x_PROF_DL_START.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_prof_chunk(void)
+{
+    uint32_t now = IA61x_timer_us();
+    uint32_t us = now - prof.last_us;
+
+    prof.last_us = now;
+
+    if (prof.chunks >= IA61x_PROF_CHUNKS)
+    {
+        prof.dropped++;
+        return;
+    }
+
+    prof.chunk_us[prof.chunks++] = (us > 0xFFFF) ? 0xFFFF : us;
+}
+
+/***************************************************************************
+ * @fn      IA61x_prof_get()
+ *
+ * @brief   Access the profile of the current boot
+ *
+ * @param   none
+ *
+ * @retval  Profile record
+ *
+ ****************************************************************************/
+const IA61x_prof_record *IA61x_prof_get(void)
+{
+    return (&prof);
+}
+
+/***************************************************************************
+ * @fn      print_chunks()
+ *
+ * @brief   Print min / average / max of a range of chunk durations
+ *
+ * @param   first   Index of the first chunk
+ * @param   count   Number of chunks
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void print_chunks(uint32_t first, uint32_t count)
+{
+    uint32_t i, us, min = 0xFFFF, max = 0, sum = 0;
+
+    if (first + count > prof.chunks)
+        count = (first < prof.chunks) ? prof.chunks - first : 0;
+    if (!count)
+        return;
+
+    for (i = first; i < first + count; i++)
+    {
+        us = prof.chunk_us[i];
+        sum += us;
+        if (us < min) min = us;
+        if (us > max) max = us;
+    }
+
+    printf("%20s chunk us min %lu avg %lu max %lu\r\n", "", min, sum / count, max);
+}
+
+/***************************************************************************
+ * @fn      IA61x_prof_print()
+ *
+ * @brief   Print the boot profile as a table: stage, argument, time since
+ *          IA61x_prof_start and time since the previous stage boundary.
+ *          Driver internal stages are indented.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_prof_print(void)
+{
+    const IA61x_prof_event *ev;
+    uint32_t i, base, prev, chunk = 0;
+
+    if (!prof.events)
+        return;
+
+    printf("Boot profile #%lu", prof.boots);
+    if (prof.prev_stage < IA61x_PROF_STAGES)
+        printf(", previous boot stopped after %s", stage_name[prof.prev_stage]);
+    printf("\r\n%-20s %6s %10s %10s\r\n", "stage", "arg", "at us", "delta us");
+
+    base = prev = prof.event[0].us;
+    for (i = 0; i < prof.events; i++)
+    {
+        ev = &prof.event[i];
+        printf("%-20s %6u %10lu %10lu\r\n", (ev->stage < IA61x_PROF_STAGES) ? stage_name[ev->stage] : "?",
+               ev->arg, ev->us - base, ev->us - prev);
+        prev = ev->us;
+
+        if (ev->stage == IA61x_PROF_DL_END)
+        {
+            print_chunks(chunk, ev->arg);
+            chunk += ev->arg;
+        }
+    }
+
+    if (prof.dropped)
+        printf("%lu events or chunks dropped\r\n", prof.dropped);
+}
+
+#endif /* IA61x_BOOT_PROFILE */
@@ -0,0 +1,128 @@
+/************************************************************************//**
+ * File: IA61x_profile.h
+ *
+ * Description: Boot timeline profiler
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_PROFILE_H_
+#define IA61x_PROFILE_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+#include "IA61x_noinit.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_PROF_MAGIC            0x50524F46  //"PROF"
+#define IA61x_PROF_EVENTS           48          //Stage boundaries kept per boot
+#define IA61x_PROF_CHUNKS           256         //Download chunk durations kept per boot
+
+/* Record the end of a stage. Timestamps are taken from IA61x_timer_us(). */
+#if defined(IA61x_BOOT_PROFILE) && IA61x_BOOT_PROFILE
+#define IA61x_PROFILE_MARK(stage, arg)  IA61x_prof_mark((stage), (arg))
+#define IA61x_PROFILE_CHUNK()           IA61x_prof_chunk()
+#else
+#define IA61x_PROFILE_MARK(stage, arg)  do {} while (0)
+#define IA61x_PROFILE_CHUNK()           do {} while (0)
+#endif
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Stage boundaries. Keep in step with the names in IA61x_profile.c */
+typedef enum
+{
+    IA61x_PROF_START = 0,       //Profiler started, right after system_init
+    IA61x_PROF_DELAY_INIT,
+    IA61x_PROF_CONSOLE_INIT,    //LED and EDBG UART
+    IA61x_PROF_NVM_INIT,
+    IA61x_PROF_SDK_INIT,        //License lookup, trill_host_init and provisioning
+    IA61x_PROF_IA61x_INIT,
+    IA61x_PROF_CONFIG,          //SysConfig download
+    IA61x_PROF_PROGRAM,         //Firmware download and IRQ setup
+    IA61x_PROF_VOICEWAKE,
+    IA61x_PROF_OUTCLK,
+    IA61x_PROF_VERSION_ALGO,
+    IA61x_PROF_VERSION_FW,
+    IA61x_PROF_READY,           //Host waits for keywords
+
+    /* Driver internals */
+    IA61x_PROF_LDO_ON,          //LDO enable driven high
+    IA61x_PROF_LDO_SETTLED,     //LDO settle delay done
+    IA61x_PROF_SYNC,            //Boot loader answered the sync byte, arg = sync byte
+    IA61x_PROF_RATE,            //Link rate switched, arg = UART baud / 100 or SPI clock / 1000
+    IA61x_PROF_DL_START,        //Image download acknowledged, arg = image size in KB
+    IA61x_PROF_DL_END,          //Image sent, arg = chunk count (filled in by the profiler)
+    IA61x_PROF_FW_READY,        //Firmware start up delay done
+    IA61x_PROF_WARM,            //Running firmware reused
+
+    IA61x_PROF_STAGES
+} IA61x_prof_stage;
+
+typedef struct
+{
+    uint32_t us;                //Timer value at the stage boundary
+    uint16_t stage;             //IA61x_prof_stage
+    uint16_t arg;               //Stage specific value
+} IA61x_prof_event;
+
+/* Boot profile, kept in .noinit so it can be read after a reset or by the debugger */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t boots;             //Profiled boots since power on
+    uint16_t complete;          //IA61x_PROF_READY was reached
+    uint16_t prev_stage;        //Last stage of the previous boot if it did not complete, else IA61x_PROF_STAGES
+    uint16_t events;
+    uint16_t chunks;
+    uint32_t dropped;           //Events and chunks that did not fit
+    uint32_t last_us;           //Timestamp of the latest event or chunk
+    IA61x_prof_event event[IA61x_PROF_EVENTS];
+    uint16_t chunk_us[IA61x_PROF_CHUNKS];   //Duration of each download chunk, saturated at 0xFFFF
+} IA61x_prof_record;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+#if defined(IA61x_BOOT_PROFILE) && IA61x_BOOT_PROFILE
+void IA61x_prof_start(void);
+void IA61x_prof_mark(IA61x_prof_stage stage, uint16_t arg);
+void IA61x_prof_chunk(void);
+void IA61x_prof_print(void);
+const IA61x_prof_record *IA61x_prof_get(void);
+#else
+#define IA61x_prof_start()
+#define IA61x_prof_print()
+#endif
+
+#endif /* IA61x_PROFILE_H_ */
@@ -0,0 +1,697 @@
+/************************************************************************//**
+ * File: IA61x_proto.c
+ *
+ * Description: IA61x protocol core shared by the host interfaces
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include <string.h>
+#include "IA61x.h"
+#include "IA61x_proto.h"
+#include "IA61x_cmdq.h"
+#include "IA61x_ready.h"
+#include "IA61x_event.h"
+#include "IA61x_latency.h"
+#include "IA61x_profile.h"
+#if defined(IA61x_FW_COMPRESSED) && IA61x_FW_COMPRESSED
+#include "IA61x_lz.h"
+#endif
+
+/* Only SPI without the DMAC sends compressed images through put, decoding in the foreground */
+#if defined(IA61x_FW_COMPRESSED) && IA61x_FW_COMPRESSED && defined(IA61x_SAMD21_VQ_SPI) && !IA61x_SPI_USE_DMA
+#define PROTO_LZ_PUT    1
+#else
+#define PROTO_LZ_PUT    0
+#endif
+
+static const IA61x_bus *proto_bus = NULL;
+static volatile bool proto_dma_done = false;
+static volatile enum status_code proto_dma_status = STATUS_OK;
+#if PROTO_LZ_PUT
+static IA61x_lz_stream proto_lz;
+#endif
+
+/* Keyword model download sequence, goes into bits 4-7 of the WDB block header */
+static uint8_t DownloadNumber = 0;
+#if IA611_VOICE_ID
+static uint8_t Ref_model = 0;
+#endif
+
+/***************************************************************************
+ * @fn      IA61x_proto_bind()
+ *
+ * @brief   Run the protocol core on the bus of the host interface
+ *
+ * @param   bus     Byte transport, must stay valid
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_proto_bind(const IA61x_bus *bus)
+{
+    proto_bus = bus;
+    IA61x_event_reset();
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_cmd()
+ *
+ * @brief   Send Command word and Data word to IA61x and receive response. If no response is expected
+ *          from IA61x then timeout should be 0. Runs through the command queue and waits for it.
+ *
+ * @param   cmdWord     Command word to send to IA61x
+ * @param   dataWord    Data word to send to IA61x
+ * @param   timeout     Response read retry count. Set to 0 if no response expected
+ * @param   pResponse   Response word from IA61x
+ *
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Command execution successful
+ *
+ *******************************************************************************************************/
+int32_t IA61x_proto_cmd(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse)
+{
+    int32_t cmdResult = CMD_SUCCESS;
+    uint16_t response;
+
+    //Commands with the no response bit pattern are not answered
+    if ((cmdWord & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK)
+        timeout = 0;
+
+    //if timeout is 0 then no need to read the response else poll for it, IA61x_READY_CMD_US per retry
+    if (IA61x_cmdq_run(cmdWord, dataWord, timeout * IA61x_READY_CMD_US, &response) != CMD_SUCCESS)
+        cmdResult = CMD_FAILED;
+    else if ((cmdWord & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK)
+        *pResponse = dataWord;
+    else if (timeout)
+        *pResponse = response;
+
+    if (proto_bus && proto_bus->cmd_done)
+        proto_bus->cmd_done(cmdResult, (timeout != 0));
+
+    return (cmdResult);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_fw_ready()
+ *
+ * @brief   Readiness probe, the downloaded firmware answers the SYNC command
+ *
+ * @param   ctx     Receives the SYNC response word
+ *
+ * @retval  true    Firmware is running
+ *
+ *******************************************************************************************************/
+bool IA61x_proto_fw_ready(void *ctx)
+{
+    return (IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, (uint16_t *)ctx) == CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_irq()
+ *
+ * @brief   External interrupt callback, IA61x raised HOST_IRQ for a keyword, command or timeout event.
+ *          Each edge is queued with its arrival time, so edges during a long event handling are not merged.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+void IA61x_proto_irq(void)
+{
+    IA61x_event_push();
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_reg_irq()
+ *
+ * @brief   Setup rising edge interrupt on the IA61x for keyword/command detection event. Configure the
+ *          host external interrupt and register IA61x_proto_irq() on it.
+ *
+ * @param   channel     EIC channel of HOST_IRQ
+ * @param   pin         HOST_IRQ pin
+ * @param   pin_mux     EIC function of the pin
+ *
+ * @retval  ERROR   In case of Set Event Response Command fails
+ * @retval  SUCCESS In case of no error
+ *
+ *******************************************************************************************************/
+uint32_t IA61x_proto_reg_irq(uint8_t channel, uint32_t pin, uint32_t pin_mux)
+{
+    uint16_t    pResponse = 0;
+    /* Structure for external interrupt channel configuration */
+    struct extint_chan_conf eic_conf;
+
+    //set the type of interrupt (Rising Edge) generated on the HOST_IRQ line after an event detected by IA61x
+    if (!IA61x_proto_cmd(SET_EVENT_RESP_CMD, IA61x_INT_RISE_EDGE, 1, &pResponse))
+    {
+        if (pResponse != (uint16_t)IA61x_INT_RISE_EDGE)
+            return (ERROR);
+    }
+
+    /* Configure the external interrupt channel */
+    extint_chan_get_config_defaults(&eic_conf);
+    eic_conf.gpio_pin           = pin;
+    eic_conf.gpio_pin_mux       = pin_mux;
+    eic_conf.gpio_pin_pull      = EXTINT_PULL_UP;
+    eic_conf.detection_criteria = EXTINT_DETECT_RISING;
+    eic_conf.filter_input_signal= true;
+    extint_chan_set_config(channel, &eic_conf);
+
+    /* Register and enable the callback function for External interrupt from IA61x*/
+    IA61x_event_reset();
+    extint_register_callback(IA61x_proto_irq, channel, EXTINT_CALLBACK_TYPE_DETECT);
+    extint_chan_enable_callback(channel, EXTINT_CALLBACK_TYPE_DETECT);
+
+    return (SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_wait_keyword()
+ *
+ * @brief   Wait for Keyword, command or timeout to be detected and ask IA61x which event it was
+ *
+ * @param   delay   Time in ms to wait for an event, 0 waits until one occurs
+ *
+ * @retval  response            Keyword ID for the detected keyword or command word
+ * @retval  NO_KWD_DETECTED     0 if no keyword is detected by IA61x
+ *
+ *******************************************************************************************************/
+int32_t IA61x_proto_wait_keyword(uint32_t delay)
+{
+    uint16_t response = 0;
+
+    //Check if IA61x event detection interrupt is generated!!
+    //This is the indication that there is either Key word, command or timeout event*/
+    //Sleep until then, or return to the host loop after delay, e.g. to serve the console
+    if (IA61x_ready_sleep(IA61x_event_pending, NULL, delay * 1000) != CMD_SUCCESS)
+        return (NO_KWD_DETECTED);
+
+    //Events are handled in arrival order, IA61x_event_last() has the arrival time
+    IA61x_event_pop(NULL);
+    IA61x_LATENCY_BEGIN(IA61x_event_last()->us);
+
+    if (proto_bus->flush)
+        proto_bus->flush();
+
+    //Send Get Event Command to IA61x to check which event has happened!
+    if (!IA61x_proto_cmd(GET_EVENT_ID_CMD, EMPTY_DATA, 2, &response))
+    {
+        if (response & 0x00FF)
+        {
+            IA61x_LATENCY_MARK(IA61x_LAT_EVENT_ID);
+            return (0x00FF & response); // Mask off other
+        }
+    }
+
+    //if no keyword is detected then it could be an invalid interrupt
+    if (proto_bus->spurious)
+        proto_bus->spurious();
+
+    return (NO_KWD_DETECTED);
+}
+
+/*******************************************************************************************************
+ * @fn      swap_ui32()
+ *
+ * @brief   Reverse the byte order of a 32 bit word
+ *
+ *******************************************************************************************************/
+static inline uint32_t swap_ui32(uint32_t v)
+{
+    union {
+        uint32_t w;
+        uint8_t b[4];
+    } data;
+
+    data.w = v;
+    return ((uint32_t)data.b[0] << 24) | ((uint32_t)data.b[1] << 16) | ((uint32_t)data.b[2] << 8) | data.b[3];
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_rdb()
+ *
+ * @brief   Read a data block of an algorithm. Data beyond the buffer is read and dropped, so IA61x is
+ *          left with nothing pending.
+ *
+ * @param   algo_id     Algorithm ID
+ * @param   block_type  Block to read
+ * @param   data        Buffer, 32 bit aligned
+ * @param   size        In: buffer size, Out: bytes read, 0 if IA61x had nothing
+ *
+ * @retval  CMD_SUCCESS Block read
+ * @retval  other       Command or bus error
+ *
+ *******************************************************************************************************/
+int32_t IA61x_proto_rdb(uint8_t algo_id, uint8_t block_type, uint8_t *data, uint32_t *size)
+{
+    uint16_t param = ((uint16_t)algo_id << 8) | block_type;
+    uint16_t response;
+    uint32_t wdata, pending, i;
+    uint32_t *p = (uint32_t *)data;
+    int32_t ret;
+
+    IA61x_LATENCY_MARK(IA61x_LAT_RDB_START);
+    ret = IA61x_proto_cmd(RDB_CMD, param, 1, &response);
+    if (ret != CMD_SUCCESS)
+        return (ret);
+
+    if (response == 0)
+    {
+        *size = 0;
+        return (CMD_SUCCESS);
+    }
+
+    if (response > *size)
+    {
+        ret = proto_bus->get(data, *size);
+        if (ret == STATUS_OK)
+        {
+            // RDB data size is multiple of 4 bytes.
+            for (pending = response - *size; pending >= 4; pending -= 4)
+                proto_bus->get((uint8_t *)&wdata, 4);
+        }
+    }
+    else
+    {
+        ret = proto_bus->get(data, response);
+        *size = response;
+    }
+
+    if (proto_bus->caps & IA61x_BUS_RDB_SWAP32)
+    {
+        for (i = 0; i < (*size / 4); i++)
+            p[i] = swap_ui32(p[i]);
+    }
+
+    IA61x_LATENCY_MARK(IA61x_LAT_RDB_END);
+    return (ret);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_proto_download_keyword()
+ *
+ * @brief   Download Keyword models to IA61x. On a byte stream the model goes out as it is, otherwise
+ *          in blocks of WDB_SIZE bytes, each with the model header word and the keyword sequence.
+ *
+ * @param   data    Data buffer to send to IA61x, starts with the 4 byte model header
+ * @param   size    Data buffer length
+ *
+ * @retval  i       Status byte of the WDB response
+ * @retval  other   Bus error
+ *
+ *******************************************************************************************************/
+int32_t IA61x_proto_download_keyword(uint16_t *data, uint16_t size)
+{
+    uint16_t Response = 0;
+    uint16_t block[WDB_SIZE / 2];
+    uint16_t SEQ;
+    uint32_t blocks, count, len, offset;
+    uint8_t inbuf2[4] = { 0 };
+    int32_t ret;
+
+    //Send Write Data Block command.
+    //Do not check WDB response validity here.
+    IA61x_proto_cmd(WDB_CMD, size, 1, &Response);
+
+    if (proto_bus->caps & IA61x_BUS_STREAM)
+    {
+        ret = proto_bus->put((uint8_t *)data, size);
+        if (ret != STATUS_OK)
+            return (ret);
+    }
+    else
+    {
+#if IA611_VOICE_ID       //No need to add the keyword ID to the Voice ID reference model file.
+        if ((DownloadNumber == 1) && (Ref_model == 0))
+            SEQ = data[1];
+        else
+#endif
+        SEQ = data[1] + (DownloadNumber << 4); /**Set the Keyword sequence number in header bit 4 -7**/
+
+        /* ----------------Send the model, WDB_SIZE_NO_HEADER bytes behind each block header ---------*/
+        blocks = (size - 4 + WDB_SIZE_NO_HEADER - 1) / WDB_SIZE_NO_HEADER;
+        for (count = 0, offset = 4; offset < size; count++, offset += len)
+        {
+            delay_us(100);
+
+            len = size - offset;
+            if (len > WDB_SIZE_NO_HEADER)
+                len = WDB_SIZE_NO_HEADER;
+
+            //Block Header including updated block sequence number, pad the last block with 0x0000
+            block[0] = data[0];
+            block[1] = SEQ;
+            memcpy(&block[2], (const uint8_t *)data + offset, len);
+            memset((uint8_t *)&block[2] + len, 0, WDB_SIZE_NO_HEADER - len);
+
+            //Send the whole block to IA61x in one go
+            ret = proto_bus->put((uint8_t *)block, WDB_SIZE);
+            if (ret != STATUS_OK)
+                return (ret);
+
+            //Updated the Sequence header, the last block is marked with 0xFF
+            SEQ |= ((count + 2 == blocks) ? 0xFF : (count + 1)) << 8;
+        }
+
+        delay_ms(5); //Wait for sometime for firmware to respond.
+    }
+
+    //Without the acknowledge IA61x may not have the keyword, its sequence number is not used up
+    ret = proto_bus->get(inbuf2, 4);
+    if (ret != STATUS_OK)
+        return (ret);
+
+#if IA611_VOICE_ID
+    if ((DownloadNumber == 1) && (Ref_model == 0))
+        Ref_model = 1;
+    else
+#endif
+    DownloadNumber++; /**Increment OEM keyword download sequence number for next keyword**/
+
+    return (inbuf2[3]);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_download_ack()
+ *
+ * @brief   Send the Boot command to IA61x and check for the Boot ACK
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Boot loader is ready for the image
+ * @retval  CMD_TIMEOUT No response from IA61x
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_download_ack(void)
+{
+    uint8_t Load01[] = { 0x00, 0x00, 0x00, 0x01 };
+    uint8_t cRetVal[4] = { 0 };
+    uint32_t len = (proto_bus->caps & IA61x_BUS_BOOT_WORD) ? 4 : 1;
+
+    if (proto_bus->put(&Load01[4 - len], len) != STATUS_OK)
+        return (CMD_FAILED);
+    if (proto_bus->get(cRetVal, len) != STATUS_OK)
+        return (CMD_TIMEOUT);
+    if (cRetVal[len - 1] != 0x01)
+        return (CMD_FAILED);
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      proto_status_byte()
+ *
+ * @brief   IA61x_ready_wait() probe, one get() of the download status byte
+ *
+ * @param   ctx     Status byte
+ *
+ * @retval  true once the byte was received
+ *
+ *******************************************************************************************************/
+static bool proto_status_byte(void *ctx)
+{
+    return (proto_bus->get((uint8_t *)ctx, 1) == STATUS_OK);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_download_status()
+ *
+ * @brief   Read the status byte a byte stream boot loader sends once the whole image is received
+ *
+ * @param   none
+ *
+ * @retval  CMD_SUCCESS No status byte received, or the bus has none
+ * @retval  i           UART Status code from IA61x. 0x02 indicates successful Firmware download.
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_download_status(void)
+{
+    uint8_t cRetVal;
+
+    if (!(proto_bus->caps & IA61x_BUS_STREAM))
+        return (CMD_SUCCESS);
+
+    delay_us(100);
+
+    //get() only bridges the gap between two bytes, the boot loader answers once it checked the image
+    if (IA61x_ready_wait(proto_status_byte, &cRetVal, 0, IA61x_READY_DL_STATUS_US) == CMD_SUCCESS)
+        return (cRetVal);
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      proto_dma_callback()
+ *
+ * @brief   DMAC completion of an uncompressed image, interrupt context
+ *
+ * @param   status  DMAC transfer status
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void proto_dma_callback(enum status_code status)
+{
+    proto_dma_status = status;
+    proto_dma_done = true;
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_download_bin()
+ *
+ * @brief   Function to download sys config or Firmware binary to IA61x. With a DMAC write the whole
+ *          image goes out in one transfer, otherwise in pieces of at most 64 KB.
+ *
+ * @param   pData       Data buffer to send to IA61x
+ * @param   size        Size of data buffer
+ *
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Command execution successful
+ * @retval  CMD_TIMEOUT No response from IA61x
+ * @retval  i           UART Status code from IA61x. 0x02 indicates successful Firmware download.
+ *
+ *******************************************************************************************************/
+int32_t IA61x_download_bin(const uint8_t *pData, uint32_t size)
+{
+    uint32_t iCount;
+    int32_t iRetVal;
+
+    iRetVal = IA61x_download_ack();
+    if (iRetVal != CMD_SUCCESS) return (iRetVal);
+    IA61x_PROFILE_MARK(IA61x_PROF_DL_START, size >> 10);
+
+    if (proto_bus->put_dma)
+    {
+        //Stream the whole image with chained DMAC descriptors
+        proto_dma_done = false;
+        if (proto_bus->put_dma(pData, size, proto_dma_callback) != STATUS_OK)
+            return (CMD_FAILED);
+
+        while (!proto_dma_done){} //Wait until DMA transfer is complete
+
+        if (proto_dma_status != STATUS_OK)
+            return (CMD_FAILED);
+        IA61x_PROFILE_CHUNK();
+    }
+    else
+    {
+        for (iCount = 0; iCount < size; iCount += 0xFFFF)
+        {
+            proto_bus->put((uint8_t *)&pData[iCount], (size - iCount >= 0xFFFF) ? 0xFFFF : size - iCount);
+            IA61x_PROFILE_CHUNK();
+        }
+    }
+    IA61x_PROFILE_MARK(IA61x_PROF_DL_END, 0);
+
+    return (IA61x_download_status());
+}
+
+#if defined(IA61x_FW_COMPRESSED) && IA61x_FW_COMPRESSED
+/*******************************************************************************************************
+ * @fn      IA61x_download_begin()
+ *
+ * @brief   Start a sys config or Firmware download and return while the image streams to IA61x.
+ *          Compressed images are decoded block by block from the DMA completion interrupt. Needs a
+ *          bus with a DMAC write.
+ *
+ * @param   pData       Image as stored
+ * @param   size        Size of the stored image
+ * @param   raw_size    Size of the image sent to IA61x
+ * @param   compressed  Image is LZ compressed
+ *
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Image is streaming, finish with IA61x_download_end()
+ * @retval  CMD_TIMEOUT No response from IA61x
+ *
+ *******************************************************************************************************/
+int32_t IA61x_download_begin(const uint8_t *pData, uint32_t size, uint32_t raw_size, bool compressed)
+{
+    int32_t iRetVal;
+
+    if (!proto_bus->put_dma)
+        return (CMD_FAILED);
+
+    iRetVal = IA61x_download_ack();
+    if (iRetVal != CMD_SUCCESS) return (iRetVal);
+    IA61x_PROFILE_MARK(IA61x_PROF_DL_START, raw_size >> 10);
+
+    if (IA61x_stream_start(proto_bus->put_dma, pData, size, raw_size, compressed) != STATUS_OK)
+        return (CMD_FAILED);
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_download_end()
+ *
+ * @brief   Wait for the image started by IA61x_download_begin() and read the boot loader status
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Transfer failed or compressed image is corrupt
+ * @retval  CMD_SUCCESS Command execution successful
+ * @retval  i           UART Status code from IA61x. 0x02 indicates successful Firmware download.
+ *
+ *******************************************************************************************************/
+int32_t IA61x_download_end(void)
+{
+    if (IA61x_stream_wait() != STATUS_OK)
+        return (CMD_FAILED);
+    IA61x_PROFILE_MARK(IA61x_PROF_DL_END, 0);
+
+    return (IA61x_download_status());
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_download_lz()
+ *
+ * @brief   Download an LZ compressed sys config or Firmware binary to IA61x. With a DMAC write each
+ *          decoded block is sent while the next one is decoded, so the bus never waits for the decoder.
+ *
+ * @param   pData       Compressed image
+ * @param   size        Size of the compressed image
+ * @param   raw_size    Size of the image sent to IA61x
+ *
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Command execution successful
+ * @retval  i           UART Status code from IA61x. 0x02 indicates successful Firmware download.
+ *
+ *******************************************************************************************************/
+int32_t IA61x_download_lz(const uint8_t *pData, uint32_t size, uint32_t raw_size)
+{
+    int32_t iRetVal;
+#if PROTO_LZ_PUT
+    const uint8_t *block;
+    uint32_t len;
+
+    if (!proto_bus->put_dma)
+    {
+        iRetVal = IA61x_download_ack();
+        if (iRetVal != CMD_SUCCESS) return (iRetVal);
+        IA61x_PROFILE_MARK(IA61x_PROF_DL_START, raw_size >> 10);
+
+        IA61x_lz_open(&proto_lz, pData, size, raw_size);
+        while ((len = IA61x_lz_read_block(&proto_lz, &block)) != 0)
+        {
+            proto_bus->put((uint8_t *)block, len);
+            IA61x_PROFILE_CHUNK();
+        }
+        IA61x_PROFILE_MARK(IA61x_PROF_DL_END, 0);
+
+        if (!IA61x_lz_complete(&proto_lz))
+            return (CMD_FAILED);
+        return (IA61x_download_status());
+    }
+#endif
+
+    iRetVal = IA61x_download_begin(pData, size, raw_size, true);
+    if (iRetVal != CMD_SUCCESS) return (iRetVal);
+
+    return (IA61x_download_end());
+}
+#endif /* IA61x_FW_COMPRESSED */
+
+#if defined(IA61x_FW_CONTAINER) && IA61x_FW_CONTAINER
+/*******************************************************************************************************
+ * @fn      IA61x_section_lookup()
+ *
+ * @brief   Find an image in the linked container and check it
+ *
+ * @param   id          Section ID (IA61x_IMG_xxx)
+ * @param   section     Receives the section
+ *
+ * @retval  CMD_FAILED  Section missing or corrupt
+ * @retval  CMD_SUCCESS Section can be downloaded
+ *
+ *******************************************************************************************************/
+int32_t IA61x_section_lookup(uint16_t id, IA61x_image_section *section)
+{
+    if (IA61x_image_find(id, section) != STATUS_OK)
+        return (CMD_FAILED);
+
+#if IA61x_FW_VERIFY
+    if (IA61x_image_verify(section) != STATUS_OK)
+        return (CMD_FAILED);
+#endif
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_download_section()
+ *
+ * @brief   Look up an image in the linked container and download it to IA61x
+ *
+ * @param   id          Section ID (IA61x_IMG_xxx)
+ *
+ * @retval  CMD_FAILED  Section missing, corrupt or download failed
+ * @retval  other       Result of the download, see IA61x_download_bin()
+ *
+ *******************************************************************************************************/
+int32_t IA61x_download_section(uint16_t id)
+{
+    IA61x_image_section section;
+
+    if (IA61x_section_lookup(id, &section) != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    if (section.flags & IA61x_IMG_FLAG_LZ)
+    {
+#if IA61x_FW_COMPRESSED
+        return (IA61x_download_lz(section.data, section.size, section.raw_size));
+#else
+        return (CMD_FAILED);    //LZ decoder not built in
+#endif
+    }
+
+    return (IA61x_download_bin(section.data, section.raw_size));
+}
+#endif /* IA61x_FW_CONTAINER */
@@ -0,0 +1,97 @@
+/************************************************************************//**
+ * File: IA61x_proto.h
+ *
+ * Description: IA61x protocol core shared by the host interfaces
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_PROTO_H_
+#define IA61x_PROTO_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+#include "IA61x_stream.h"
+#if defined(IA61x_FW_CONTAINER) && IA61x_FW_CONTAINER
+#include "IA61x_image.h"
+#endif
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Bus capabilities, IA61x_bus.caps */
+#define IA61x_BUS_STREAM        0x01    //Byte stream, IA61x sends without being clocked (UART): the boot loader
+                                        //reports a status byte after an image, WDB data goes out unframed
+#define IA61x_BUS_BOOT_WORD     0x02    //Boot command and ACK are 4 byte words (SPI), single bytes otherwise
+#define IA61x_BUS_RDB_SWAP32    0x04    //RDB data arrives as big endian 32 bit words (SPI)
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/*
+ * Byte transport of a host interface. The protocol core frames commands, downloads images,
+ * reads and writes data blocks and waits for events on top of it. Commands themselves go
+ * through the command queue, with the transport the driver gave IA61x_cmdq_init().
+ */
+typedef struct
+{
+    int32_t (*get)(uint8_t *data, uint32_t size);       //Blocking read, STATUS_OK when all data arrived
+    int32_t (*put)(uint8_t *data, uint32_t size);       //Blocking write, STATUS_OK when all data is sent
+    IA61x_stream_put_t put_dma;                         //DMAC write for images, NULL if they go out with put
+    void (*flush)(void);                                //Drop stale received bytes before an event query, may be NULL
+    void (*spurious)(void);                             //HOST_IRQ came without an event, may be NULL
+    void (*cmd_done)(int32_t result, bool answered);    //Outcome of every command, e.g. for link health, may be NULL
+    uint32_t caps;                                      //IA61x_BUS_xxx
+} IA61x_bus;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+void IA61x_proto_bind(const IA61x_bus *bus);
+int32_t IA61x_proto_cmd(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse);
+bool IA61x_proto_fw_ready(void *ctx);
+uint32_t IA61x_proto_reg_irq(uint8_t channel, uint32_t pin, uint32_t pin_mux);
+void IA61x_proto_irq(void);
+int32_t IA61x_proto_wait_keyword(uint32_t delay);
+int32_t IA61x_proto_rdb(uint8_t algo_id, uint8_t block_type, uint8_t *data, uint32_t *size);
+int32_t IA61x_proto_download_keyword(uint16_t *data, uint16_t size);
+
+int32_t IA61x_download_bin(const uint8_t *pData, uint32_t size);
+#if defined(IA61x_FW_COMPRESSED) && IA61x_FW_COMPRESSED
+int32_t IA61x_download_begin(const uint8_t *pData, uint32_t size, uint32_t raw_size, bool compressed);
+int32_t IA61x_download_end(void);
+int32_t IA61x_download_lz(const uint8_t *pData, uint32_t size, uint32_t raw_size);
+#endif
+#if defined(IA61x_FW_CONTAINER) && IA61x_FW_CONTAINER
+int32_t IA61x_section_lookup(uint16_t id, IA61x_image_section *section);
+int32_t IA61x_download_section(uint16_t id);
+#endif
+
+#endif /* IA61x_PROTO_H_ */
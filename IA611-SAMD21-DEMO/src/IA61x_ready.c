@@ -0,0 +1,159 @@
+/************************************************************************//**
+ * File: IA61x_ready.c
+ *
+ * Description: Readiness polling with deadlines for the IA61x drivers
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include "IA61x.h"
+#include "IA61x_ready.h"
+#include "IA61x_cmdq.h"
+#include "IA61x_samd21_timer.h"
+
+/***************************************************************************
+ * @fn      IA61x_ready_wait()
+ *
+ * @brief   Poll a readiness probe until it passes or the deadline expires.
+ *          The probe runs at least once after the deadline, so the wait is
+ *          never shorter than the fixed delay it replaces when IA61x is
+ *          slow.
+ *
+ * @param   probe       Readiness check
+ * @param   ctx         Passed to the probe
+ * @param   poll_us     Sleep between two probes
+ * @param   deadline_us Upper bound of the wait
+ *
+ * @retval  CMD_SUCCESS Probe passed
+ * @retval  CMD_TIMEOUT Deadline expired
+ *
+ ****************************************************************************/
+int32_t IA61x_ready_wait(IA61x_ready_probe_t probe, void *ctx, uint32_t poll_us, uint32_t deadline_us)
+{
+    uint32_t start;
+    bool expired;
+
+    IA61x_timer_init();
+    start = IA61x_timer_us();
+
+    while (1)
+    {
+        expired = (IA61x_timer_elapsed_us(start) >= deadline_us);
+
+        if (probe(ctx))
+            return (CMD_SUCCESS);
+
+        if (expired)
+            return (CMD_TIMEOUT);
+
+        if (poll_us)
+            delay_us(poll_us);
+    }
+}
+
+/***************************************************************************
+ * @fn      ready_wake()
+ *
+ * @brief   Deadline alarm of IA61x_ready_sleep(), the interrupt itself
+ *          wakes the core
+ *
+ ****************************************************************************/
+static void ready_wake(void)
+{
+}
+
+/***************************************************************************
+ * @fn      IA61x_ready_sleep()
+ *
+ * @brief   Wait for a condition set from interrupt context, e.g. a queued
+ *          HOST_IRQ event. With IA61x_IRQ_SLEEP the core sleeps between
+ *          interrupts: the one that sets the condition or the deadline
+ *          alarm wakes it, so the wait ends within microseconds of the
+ *          event. The probe also runs with interrupts masked, so it must be
+ *          short and must not wait on interrupts.
+ *
+ * @param   probe       Condition check
+ * @param   ctx         Passed to the probe
+ * @param   deadline_us Upper bound of the wait, 0 waits until the probe passes
+ *
+ * @retval  CMD_SUCCESS Probe passed
+ * @retval  CMD_TIMEOUT Deadline expired
+ *
+ ****************************************************************************/
+int32_t IA61x_ready_sleep(IA61x_ready_probe_t probe, void *ctx, uint32_t deadline_us)
+{
+    uint32_t start, elapsed;
+
+    IA61x_timer_init();
+    start = IA61x_timer_us();
+#if IA61x_IRQ_SLEEP
+    system_set_sleepmode(IA61x_READY_SLEEP_MODE);
+#endif
+
+    while (!probe(ctx))
+    {
+        elapsed = IA61x_timer_elapsed_us(start);
+        if (deadline_us && (elapsed >= deadline_us))
+            return (CMD_TIMEOUT);
+
+#if IA61x_IRQ_SLEEP
+        //Interrupts stay pending while masked, one between the check and WFI still wakes the core
+        system_interrupt_enter_critical_section();
+        //The alarm is shared: a running command queue owns it and wakes the core by itself
+        if (deadline_us && IA61x_cmdq_idle())
+            IA61x_timer_alarm(deadline_us - elapsed, ready_wake);
+        if (!probe(ctx))
+            system_sleep();
+        system_interrupt_leave_critical_section();
+#endif
+    }
+
+    return (CMD_SUCCESS);
+}
+/***************************************************************************
+ * @fn      IA61x_ready_response()
+ *
+ * @brief   Check a 4 byte response read from IA61x. The firmware echoes the
+ *          command word once the response is ready.
+ *
+ * @param   data        Response bytes, command word first
+ * @param   cmdWord     Command word that was sent
+ * @param   pResponse   Response word if ready, else the word read
+ *
+ * @retval  true        Response is ready
+ *
+ ****************************************************************************/
+bool IA61x_ready_response(const uint8_t *data, uint16_t cmdWord, uint16_t *pResponse)
+{
+    *pResponse = (data[0] << 8) | data[1];
+    if (*pResponse != cmdWord)
+        return (false);
+
+    *pResponse = (data[2] << 8) | data[3];
+    return (true);
+}
@@ -0,0 +1,77 @@
+/************************************************************************//**
+ * File: IA61x_ready.h
+ *
+ * Description: Readiness polling with deadlines for the IA61x drivers
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_READY_H_
+#define IA61x_READY_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Upper bounds, these are the fixed delays the drivers used to wait */
+#define IA61x_READY_LDO_US          20000   //LDO enable until the boot loader answers the sync byte
+#define IA61x_READY_BOOT_US         10000   //Boot loader settle after the first sync
+#define IA61x_READY_FW_US           35000   //Firmware start up after the download
+#define IA61x_READY_CMD_US          5000    //Command response, per retry of the cmd() timeout count
+#define IA61x_READY_DL_STATUS_US    100000  //Boot loader status byte after the last image byte
+
+/* Poll intervals */
+#define IA61x_READY_SYNC_POLL_US    200     //Boot loader sync echo
+#define IA61x_READY_FW_POLL_US      1000    //Firmware SYNC command
+#define IA61x_READY_CMD_POLL_US     200     //Command response read, first probe of a command not seen yet
+#define IA61x_READY_CMD_MIN_US      50      //Command response read, shortest probe interval
+#define IA61x_READY_CMD_MAX_US      1600    //Command response read, longest probe interval of the back off
+
+#define IA61x_READY_ECHO_US         1000    //UART echo or response window of a single probe
+
+/* IA61x_ready_sleep(), the TC4 alarm and the EIC must keep running. IDLE_0 only stops the CPU clock. */
+#define IA61x_READY_SLEEP_MODE      SYSTEM_SLEEPMODE_IDLE_0
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Returns true once IA61x is ready. Called repeatedly, so it must be safe to repeat. */
+typedef bool (*IA61x_ready_probe_t)(void *ctx);
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+int32_t IA61x_ready_wait(IA61x_ready_probe_t probe, void *ctx, uint32_t poll_us, uint32_t deadline_us);
+int32_t IA61x_ready_sleep(IA61x_ready_probe_t probe, void *ctx, uint32_t deadline_us);
+bool IA61x_ready_response(const uint8_t *data, uint16_t cmdWord, uint16_t *pResponse);
+
+#endif /* IA61x_READY_H_ */
@@ -0,0 +1,161 @@
+/************************************************************************//**
+ * File: IA61x_route.c
+ *
+ * Description: Precompiled IA61x route programs
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include "IA61x.h"
+#include "IA61x_param.h"
+#include "IA61x_route.h"
+
+/*
+ * A route program is the command sequence of a VoiceWake or preset, compiled on the host into
+ * a table of 16 bit words. It is checked once per run and sent as one cmd_batch, so a route is
+ * data: a new one needs a .route file and a rebuild of its header, no driver code.
+ */
+#define ROUTE_FLAGS(w)              ((uint8_t)((w) >> 8))
+#define ROUTE_TIMEOUT(w)            ((uint8_t)(w))
+#define ROUTE_NO_RESP_BIT           (CMD_NO_RESP_MASK & ~0x8000)    //Set on the send only variant of a command
+
+/* IA61x runs with default algorithm parameters after these, the shadow is stale */
+#define ROUTE_RESETS(cmd)           ((((cmd) & ~ROUTE_NO_RESP_BIT) == STOP_ROUTE_CMD) || \
+                                     (((cmd) & ~ROUTE_NO_RESP_BIT) == SELECT_ROUTE_CMD) || \
+                                     (((cmd) & ~ROUTE_NO_RESP_BIT) == SET_PRESET_CMD))
+
+/***************************************************************************
+ * @fn      IA61x_route_check()
+ *
+ * @brief   Validate a route program table
+ *
+ * @param   program     Table from ia61x_route.py
+ * @param   words       Size of the table in 16 bit words
+ *
+ * @retval  STATUS_OK               Table can be run
+ * @retval  STATUS_ERR_BAD_FORMAT   Wrong magic or version, a step is malformed or
+ *                                  shadowed after a route stop, selection or preset
+ * @retval  STATUS_ERR_BAD_DATA     Size or check does not match
+ *
+ ****************************************************************************/
+enum status_code IA61x_route_check(const uint16_t *program, uint32_t words)
+{
+    uint16_t sum = 0;
+    uint32_t count;
+    uint32_t i;
+    bool reset = false;
+
+    if ((words < IA61x_ROUTE_HEADER_WORDS) || (program[0] != IA61x_ROUTE_MAGIC) || (program[1] != IA61x_ROUTE_VERSION))
+        return (STATUS_ERR_BAD_FORMAT);
+
+    count = program[2];
+    if ((count == 0) || (count > IA61x_ROUTE_MAX_STEPS) ||
+        (words != IA61x_ROUTE_HEADER_WORDS + count * IA61x_ROUTE_STEP_WORDS))
+        return (STATUS_ERR_BAD_DATA);
+
+    for (i = IA61x_ROUTE_HEADER_WORDS; i < words; i++)
+        sum += program[i];
+    sum = ~sum;
+    if (sum != program[3])
+        return (STATUS_ERR_BAD_DATA);
+
+    //A parameter value only lands on the ID selected right before it
+    for (i = 0; i < count; i++)
+    {
+        const uint16_t *step = &program[IA61x_ROUTE_HEADER_WORDS + i * IA61x_ROUTE_STEP_WORDS];
+
+        if (!(step[0] & 0x8000) || (ROUTE_TIMEOUT(step[3]) == 0))
+            return (STATUS_ERR_BAD_FORMAT);
+        if ((step[0] == SET_ALGO_PARAM) &&
+            ((i == 0) || (step[-IA61x_ROUTE_STEP_WORDS] != SET_ALGO_PARAM_ID) || !(ROUTE_FLAGS(step[3]) & IA61x_BATCH_CHAINED)))
+            return (STATUS_ERR_BAD_FORMAT);
+
+        //The shadow predates the reset, a skip would leave the default in place
+        if (reset && (ROUTE_FLAGS(step[3]) & IA61x_ROUTE_SHADOW))
+            return (STATUS_ERR_BAD_FORMAT);
+        if (ROUTE_RESETS(step[0]))
+            reset = true;
+    }
+
+    return (STATUS_OK);
+}
+
+/***************************************************************************
+ * @fn      IA61x_route_run()
+ *
+ * @brief   Run a route program. Steps flagged IA61x_ROUTE_SHADOW are left
+ *          out when IA61x already has their value, the rest goes out in one
+ *          cmd_batch, each step checked against its expected response. The
+ *          check keeps the flag off steps after a route stop, selection or
+ *          preset, so the skips can be decided before anything is sent.
+ *
+ * @param   program     Table from ia61x_route.py
+ * @param   words       Size of the table in 16 bit words
+ *
+ * @retval  0           All steps succeeded or were not needed
+ * @retval  CMD_FAILED  Table is not valid, nothing was sent
+ * @retval  n > 0       Number of failed steps
+ *
+ ****************************************************************************/
+int32_t IA61x_route_run(const uint16_t *program, uint32_t words)
+{
+    IA61x_cmd_entry entries[IA61x_ROUTE_MAX_STEPS];
+    const uint16_t *step;
+    uint32_t count = 0;
+    uint32_t i;
+
+    if (IA61x_route_check(program, words) != STATUS_OK)
+        return (CMD_FAILED);
+
+    for (i = 0; i < program[2]; i++)
+    {
+        step = &program[IA61x_ROUTE_HEADER_WORDS + i * IA61x_ROUTE_STEP_WORDS];
+
+        if (ROUTE_FLAGS(step[3]) & IA61x_ROUTE_SHADOW)
+        {
+            //SET_ALGO_PARAM_ID is judged together with the SET_ALGO_PARAM after it
+            if ((step[0] == SET_ALGO_PARAM_ID) && (i + 1 < program[2]) && (step[IA61x_ROUTE_STEP_WORDS] == SET_ALGO_PARAM) &&
+                IA61x_param_has(IA61x_PARAM_ALGO, step[1], step[IA61x_ROUTE_STEP_WORDS + 1]))
+            {
+                i++;
+                continue;
+            }
+            if ((step[0] == SET_DIGITAL_GAIN_CMD) && IA61x_param_has(IA61x_PARAM_GAIN, step[1] >> 8, step[1] & 0xFF))
+                continue;
+        }
+
+        entries[count].cmd     = step[0];
+        entries[count].data    = step[1];
+        entries[count].expect  = step[2];
+        entries[count].flags   = ROUTE_FLAGS(step[3]) & ~IA61x_ROUTE_SHADOW;
+        entries[count].timeout = ROUTE_TIMEOUT(step[3]);
+        count++;
+    }
+
+    return (count ? IA61x_cmd_batch(entries, count) : 0);
+}
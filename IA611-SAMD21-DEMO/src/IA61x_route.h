@@ -0,0 +1,59 @@
+/************************************************************************//**
+ * File: IA61x_route.h
+ *
+ * Description: Precompiled IA61x route programs
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_ROUTE_H_
+#define IA61x_ROUTE_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Route program tables produced by scripts/routeprog/ia61x_route.py, keep in sync */
+#define IA61x_ROUTE_MAGIC           0x5052  //"RP"
+#define IA61x_ROUTE_VERSION         1
+#define IA61x_ROUTE_HEADER_WORDS    4       //Magic, version, step count, check
+#define IA61x_ROUTE_STEP_WORDS      4       //Command, data, expected response, flags << 8 | timeout
+#define IA61x_ROUTE_MAX_STEPS       24
+
+/* Step flags on top of the IA61x_BATCH_xxx ones */
+#define IA61x_ROUTE_SHADOW          0x80    //Opt-in, left out if the parameter shadow has the value
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+enum status_code IA61x_route_check(const uint16_t *program, uint32_t words);
+int32_t IA61x_route_run(const uint16_t *program, uint32_t words);
+
+#endif /* IA61x_ROUTE_H_ */
@@ -36,13 +36,26 @@
 # include <asf.h>
 # include <string.h>
 # include "IA61x_samd21_VQ_i2c.h"
+# include "IA61x_ready.h"
+# include "IA61x_profile.h"
+# include "IA61x_cmdq.h"
+# include "IA61x_proto.h"
+# include "IA61x_param.h"
+# include "IA61x_route.h"
+# include "IA61x_samd21_timer.h"
+# if IA61x_I2C_USE_DMA
+#  include "IA61x_samd21_dma.h"
+# endif
 
 #if IA611_VOICE_ID
     #include "SysConfig6secTO_vid.h"    /*Sysconfig with 1 Voice ID + 3 OEM commands*/
+    #include "route_voicewake_i2c_vid.h"    /*VoiceWake route program with Voice ID sensitivity*/
 #elif IA611_UTK
     #include "SysConfig6secTO_utk.h"    /*Sysconfig with 1 UTK + 3 OEM commands*/
+    #include "route_voicewake_i2c_utk.h"    /*VoiceWake route program with UTK sensitivity*/
 #else
     # include "SysConfig6secTO.h"       /*4 Command Sys Config with 6 Sec TIMEOUT*/
+    # include "route_voicewake_i2c.h"   /*VoiceWake route program*/
 #endif
 
 # include "IA611_FW_Bin_I2C.h"         /* Firmware Binary for I2C interface */
@@ -50,23 +63,25 @@
 // private
 /*********************************************************************************/
 struct i2c_master_module i2c_master_instance;
-volatile uint8_t interrupt_flag = 0;
+#if IA61x_I2C_USE_DMA
+static volatile uint8_t dma_complete_i2c_master = 0;
+static volatile enum status_code dma_status_i2c_master = STATUS_OK;
+#endif
 
 /***************************************************************************
- * @fn      IA61x_i2c_get()
+ * @fn      IA61x_i2c_read()
  *
- * @brief   Read data from UART port
+ * @brief   Read data from I2C port, a single attempt
  *
  * @param   pData    Buffer to receive data
  * @param   size    Size of data to be received
  *
- * @retval  none
+ * @retval  STATUS_OK   Data received
+ * @retval  other       IA61x did not acknowledge or bus error
  *
  ****************************************************************************/
-static int32_t IA61x_i2c_get(uint8_t *pData, uint32_t size)
+static enum status_code IA61x_i2c_read(uint8_t *pData, uint32_t size)
 {
-    uint16_t timeout = 0;
-    uint32_t retVal = STATUS_OK;
     struct i2c_master_packet packet = {
         .address     = SLAVE_ADDRESS,
         .data_length = size,
@@ -76,34 +91,150 @@ static int32_t IA61x_i2c_get(uint8_t *pData, uint32_t size)
         .hs_master_code  = 0x0,
     };
 
-    while (i2c_master_read_packet_wait(&i2c_master_instance, &packet) != STATUS_OK) 
+    return (i2c_master_read_packet_wait(&i2c_master_instance, &packet));
+}
+
+/***************************************************************************
+ * @fn      IA61x_i2c_get()
+ *
+ * @brief   Read data from I2C port. A read IA61x does not acknowledge is
+ *          repeated for at most I2C_RETRY_US.
+ *
+ * @param   pData    Buffer to receive data
+ * @param   size    Size of data to be received
+ *
+ * @retval  STATUS_OK           Data received
+ * @retval  STATUS_ERR_TIMEOUT  IA61x did not answer
+ *
+ ****************************************************************************/
+static int32_t IA61x_i2c_get(uint8_t *pData, uint32_t size)
+{
+    uint32_t start = IA61x_timer_us();
+
+    while (IA61x_i2c_read(pData, size) != STATUS_OK) 
     {
-        /* Increment timeout counter and check if timed out. */
-        if (timeout++ == I2C_TIMEOUT) 
-        {
-            retVal = STATUS_ERR_TIMEOUT;
-            break;
-        }
+        /* Check if the retry time is used up. */
+        if (IA61x_timer_elapsed_us(start) >= I2C_RETRY_US) 
+            return (STATUS_ERR_TIMEOUT);
     }
     
-    return retVal;
+    return (STATUS_OK);
+}
+
+#if IA61x_I2C_USE_DMA
+/***************************************************************************
+ * @fn      dma_callback_i2c_master()
+ *
+ * @brief   DMAC completion callback for I2C transmit, interrupt context
+ *
+ * @param   status  DMAC transfer status
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void dma_callback_i2c_master(enum status_code status)
+{
+    dma_status_i2c_master = status;
+    dma_complete_i2c_master = true;
+}
+
+/***************************************************************************
+ * @fn      IA61x_i2c_write_dma()
+ *
+ * @brief   Send one packet with the DMAC. The SERCOM addresses IA61x and
+ *          sends STOP by itself after ADDR.LEN bytes. IA61x may stretch
+ *          SCL, the packet is abandoned after I2C_PACKET_US.
+ *
+ * @param   pData   Send data Buffer
+ * @param   size    Size of data to be sent, at most I2C_DMA_PACKET
+ *
+ * @retval  STATUS_OK                   Packet sent and acknowledged
+ * @retval  STATUS_ERR_BAD_ADDRESS      IA61x did not acknowledge
+ * @retval  STATUS_ERR_PACKET_COLLISION Bus error or arbitration lost
+ * @retval  STATUS_ERR_TIMEOUT          SCL held low or packet took too long
+ *
+ ****************************************************************************/
+static enum status_code IA61x_i2c_write_dma(const uint8_t *pData, uint8_t size)
+{
+    SercomI2cm *const i2c_module = &(i2c_master_instance.hw->I2CM);
+    enum status_code status;
+    uint32_t start;
+    uint16_t bus;
+
+    dma_complete_i2c_master = false;
+    status = IA61x_dma_write(IA61x_DMA_CH_I2C_TX, CONF_I2C_MASTER_DMAC_ID_TX, &i2c_module->DATA.reg,
+                             pData, size, dma_callback_i2c_master);
+    if (status != STATUS_OK)
+        return (status);
+
+    while (i2c_master_is_syncing(&i2c_master_instance)) {}
+    i2c_master_dma_set_transfer(&i2c_master_instance, SLAVE_ADDRESS, size, I2C_TRANSFER_WRITE);
+
+    start = IA61x_timer_us();
+    status = STATUS_BUSY;
+    while (status == STATUS_BUSY)
+    {
+        bus = i2c_module->STATUS.reg;
+
+        if (bus & SERCOM_I2CM_STATUS_LOWTOUT)
+            status = STATUS_ERR_TIMEOUT;
+        else if (bus & (SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST))
+            status = STATUS_ERR_PACKET_COLLISION;
+        else if ((i2c_module->INTFLAG.reg & SERCOM_I2CM_INTFLAG_MB) && (bus & SERCOM_I2CM_STATUS_RXNACK))
+            status = STATUS_ERR_BAD_ADDRESS;
+        else if (dma_complete_i2c_master && (i2c_module->INTFLAG.reg & SERCOM_I2CM_INTFLAG_MB))
+            status = dma_status_i2c_master;     //Last byte is out and acknowledged
+        else if (IA61x_timer_elapsed_us(start) >= I2C_PACKET_US)
+            status = STATUS_ERR_TIMEOUT;
+    }
+
+    if (status != STATUS_OK)
+        IA61x_dma_abort(IA61x_DMA_CH_I2C_TX);
+
+    //Release the bus unless the SERCOM already sent STOP
+    if ((i2c_module->STATUS.reg & SERCOM_I2CM_STATUS_BUSSTATE_Msk) == SERCOM_I2CM_STATUS_BUSSTATE(2))
+        i2c_master_send_stop(&i2c_master_instance);
+
+    return (status);
 }
+#endif /* IA61x_I2C_USE_DMA */
 
 /***************************************************************************
  * @fn      IA61x_i2c_put()
  *
- * @brief   Write data to I2C port
+ * @brief   Write data to I2C port. A packet IA61x does not take is sent
+ *          again for at most I2C_RETRY_US.
  *
  * @param   pData    Send dat Buffer
  * @param   size    Size of data to be sent
  *
- * @retval  none
+ * @retval  STATUS_OK           Data sent
+ * @retval  STATUS_ERR_TIMEOUT  IA61x did not take the data
  *
  ****************************************************************************/
 static int32_t IA61x_i2c_put(uint8_t *pData, uint32_t size)
 {
-    uint16_t timeout = 0;
-    uint32_t retVal = STATUS_OK;
+    uint32_t start;
+#if IA61x_I2C_USE_DMA
+    uint32_t len;
+
+    //Split into packets of at most I2C_DMA_PACKET bytes, each one gets its own retry time
+    while (size)
+    {
+        len = (size > I2C_DMA_PACKET) ? I2C_DMA_PACKET : size;
+
+        start = IA61x_timer_us();
+        while (IA61x_i2c_write_dma(pData, (uint8_t)len) != STATUS_OK)
+        {
+            /* Check if the retry time is used up. */
+            if (IA61x_timer_elapsed_us(start) >= I2C_RETRY_US)
+                return (STATUS_ERR_TIMEOUT);
+        }
+
+        pData += len;
+        size -= len;
+    }
+#else
     struct i2c_master_packet packet = {
         .address     = SLAVE_ADDRESS,
         .data_length = size,
@@ -113,116 +244,65 @@ static int32_t IA61x_i2c_put(uint8_t *pData, uint32_t size)
         .hs_master_code  = 0x0,
     };
 
+    start = IA61x_timer_us();
     while (i2c_master_write_packet_wait(&i2c_master_instance, &packet) != STATUS_OK) 
     {
-        /* Increment timeout counter and check if timed out. */
-        if (timeout++ == I2C_TIMEOUT) 
-        {
-            retVal = STATUS_ERR_TIMEOUT;
-            break;
-        }
+        /* Check if the retry time is used up. */
+        if (IA61x_timer_elapsed_us(start) >= I2C_RETRY_US) 
+            return (STATUS_ERR_TIMEOUT);
     }
+#endif
 
-    return retVal;
+    return (STATUS_OK);
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_i2c_cmd()
+ * @fn      i2c_cmdq_send()
  *
- * @brief   Send Command word and Data word to IA61x and receive response. If no response is expected 
- *          from IA61x then timeout should be 0.
+ * @brief   Command queue transport, write the command and data word
  *
  * @param   cmdWord     Command word to send to IA61x
  * @param   dataWord    Data word to send to IA61x
- * @param   timeout     Response read retry count. Set to 0 if no response expected
- * @param   pResponse   Response word from IA61x
  *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
+ * @retval  CMD_FAILED  Command could not be sent
+ * @retval  CMD_SUCCESS Command sent
  *
  *******************************************************************************************************/
-static int32_t IA61x_i2c_cmd(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse)
+static int32_t i2c_cmdq_send(uint16_t cmdWord, uint16_t dataWord)
 {
-    uint32_t data = 0;
-    int32_t cmdResult = CMD_SUCCESS;
-    union _tmp {
-        uint16_t word[2];
-        uint8_t byte[4];
-    } tmp;
-
-    tmp.word[0] = cmdWord;
-    tmp.word[1] = dataWord;
-
-    //Command Word first and then Data word
-    data = tmp.byte[1] | tmp.byte[0]<<8 | tmp.byte[3]<<16 | tmp.byte[2] << 24;
-    IA61x_i2c_put((uint8_t *)&data, 4);
-
-    
+    uint8_t frame[4];
 
-    //if timeout is 0 then no need to read the response else try reading the data multiple times
-    while(timeout--)
-    {
-        delay_ms(5);// Delay for Firmware to prepare the response.
-
-        //Read response 
-        IA61x_i2c_get(tmp.byte, 4);
-
-        *pResponse = (tmp.byte[0] << 8) | tmp.byte[1] ;
-        //return the second response word if the first response word matches command word
-        if(*pResponse == cmdWord)
-        {
-            *pResponse = (tmp.byte[2] << 8) | tmp.byte[3];
-            cmdResult = CMD_SUCCESS;
-            break;
-        }
-        else
-        {
-            cmdResult = CMD_FAILED;
-        }
-    }
+    IA61x_cmdq_frame(frame, cmdWord, dataWord);
 
-    return (cmdResult);
+    return ((IA61x_i2c_put(frame, 4) == STATUS_OK) ? CMD_SUCCESS : CMD_FAILED);
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_download_bin()
+ * @fn      i2c_cmdq_probe()
  *
- * @brief   Function to download sys config or Firmware binary to IA61x
+ * @brief   Command queue transport, read the response of the last command. Runs from the timer
+ *          alarm, so a read IA61x does not acknowledge is not repeated here: the command queue
+ *          probes again after its back off.
  *
- * @param   pData       Data buffer to send to IA61x
- * @param   size        Size of data buffer
+ * @param   cmdWord     Command word that was sent
+ * @param   pResponse   Response word from IA61x
  *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
- * @retval  i           UART Status code from IA61x. 0x02 indicates successful Firmware download.
+ * @retval  CMD_SUCCESS Response word is valid
+ * @retval  CMD_TIMEOUT Not answered yet
  *
  *******************************************************************************************************/
- static int32_t IA61x_download_bin(uint8_t *pData, uint32_t size)
+static int32_t i2c_cmdq_probe(uint16_t cmdWord, uint16_t *pResponse)
 {
-    const uint8_t Load01[] = { 0x1 };
-    uint8_t cRetVal = 0;
-    uint32_t iCount = 0;
-
-    //Send Boot command to IA61x and check for the Boot ACK
-    if(IA61x_i2c_put((uint8_t *)Load01, 1) == STATUS_OK)
-    {
-        if((IA61x_i2c_get(&cRetVal, 1) != STATUS_OK) || (cRetVal != 1))
-        {
-            return (CMD_FAILED);
-        }
-    }
-    else return (CMD_FAILED);
+    uint8_t data[4] = { 0 };
 
-    iCount = 0;
-    while (iCount < size) 
-    {
-        IA61x_i2c_put(&pData[iCount], ((size - iCount >= 0xFFFF) ? 0xFFFF : (size - iCount)));
-        iCount += 0xFFFF;
-    }
+    if (IA61x_i2c_read(data, 4) != STATUS_OK)
+        return (CMD_TIMEOUT);
 
-    return (CMD_SUCCESS);
+    return (IA61x_ready_response(data, cmdWord, pResponse) ? CMD_SUCCESS : CMD_TIMEOUT);
 }
 
+static const IA61x_cmdq_transport i2c_cmdq = { i2c_cmdq_send, i2c_cmdq_probe };
+
 /*******************************************************************************************************
  * @fn      my_i2c_init()
  *
@@ -243,8 +323,15 @@ static void my_i2c_init(void)
 
     /* Change buffer timeout to something longer. */
     config_i2c_master.buffer_timeout = 10000;
+#if IA61x_I2C_FAST_MODE_PLUS
+    config_i2c_master.generator_source = CONF_I2C_MASTER_GCLK_GENERATOR;
+    config_i2c_master.baud_rate = I2C_MASTER_BAUD_RATE_1000KHZ;
+    config_i2c_master.transfer_speed = I2C_MASTER_SPEED_FAST_MODE_PLUS;
+#else
     config_i2c_master.baud_rate = I2C_MASTER_BAUD_RATE_400KHZ; 
-    //config_i2c_master.transfer_speed = I2C_MASTER_SPEED_FAST_MODE_PLUS;
+#endif
+    /* A stuck SCL ends the transfer with an error instead of hanging the bus */
+    config_i2c_master.scl_low_timeout = true;
 
     /* Initialize and enable device with config. */
     i2c_master_init(&i2c_master_instance, CONF_I2C_MASTER_MODULE, &config_i2c_master);
@@ -263,10 +350,10 @@ static void my_i2c_init(void)
  * @retval  none
  *
  *******************************************************************************************************/
-/*static void my_i2c_uninit(void)
+static void my_i2c_uninit(void)
 {
     i2c_master_disable(&i2c_master_instance);
-}*/
+}
 
 /*******************************************************************************************************
  * @fn      IA61x_i2c_download_config()
@@ -283,68 +370,11 @@ static int32_t IA61x_i2c_download_config(void)
 {
     uint32_t iRetVal;
 
-    iRetVal = IA61x_download_bin((uint8_t *)SCFG, sizeof(SCFG));
+    iRetVal = IA61x_download_bin((const uint8_t *)SCFG, sizeof(SCFG));
 
     return (iRetVal);
 }
 
-/*******************************************************************************************************
- * @fn      I2C_Irq_callback
- *
- * @brief   Callback function invoked by the eternal interrupt when IA61x detects the keyword or command.
- *
- * @param   none
- *
- * @retval  none
- *
- *******************************************************************************************************/
-static void I2C_Irq_callback(void)
-{
-    interrupt_flag = true;
-    //extint_chan_clear_detected(I2C_EIC_CHANNEL); 
-}
-
-/*******************************************************************************************************
- * @fn      IA61x_samd21_vq_i2c_reg_IRQ
- *
- * @brief   Configure Host External interrupt and register the callback function. Setup rising edge interrupt
-            on the IA61x for keyword/cmmand detection event
- *
- * @param   none
- *
- * @retval  ERROR   In case of Set Event Response Command fails 
- * @retval  SUCCESS In case of no error
- *
- *******************************************************************************************************/
-static uint32_t IA61x_samd21_vq_i2c_reg_IRQ(void)
-{
-    uint16_t    pResponse = 0;
-    /* Structure for external interrupt channel configuration */
-    struct extint_chan_conf eic_conf;
-
-    //set the type of interrupt (Rising Edge) generated on the HOST_IRQ line after an event detected by IA61x
-    if(!IA61x_i2c_cmd(SET_EVENT_RESP_CMD,IA61x_INT_RISE_EDGE,1, &pResponse))
-    {
-        if(pResponse != (uint16_t)IA61x_INT_RISE_EDGE)
-        return (ERROR);
-    }
-
-
-    /* Configure the external interrupt channel */
-    extint_chan_get_config_defaults(&eic_conf);
-    eic_conf.gpio_pin           = I2C_EIC_PIN;
-    eic_conf.gpio_pin_mux       = I2C_EIC_PIN_MUX;
-    eic_conf.gpio_pin_pull      = EXTINT_PULL_UP;
-    eic_conf.detection_criteria = EXTINT_DETECT_RISING;
-    eic_conf.filter_input_signal= true;
-    extint_chan_set_config(I2C_EIC_CHANNEL, &eic_conf);
-    /* Register and enable the callback function */
-    extint_register_callback(I2C_Irq_callback, I2C_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
-    extint_chan_enable_callback(I2C_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
-
-    return (SUCCESS);
-}
-
 /*******************************************************************************************************
  * @fn      IA61x_i2c_download_firmware()
  *
@@ -359,18 +389,18 @@ static uint32_t IA61x_samd21_vq_i2c_reg_IRQ(void)
 static int32_t IA61x_i2c_download_firmware(void)
 {
     uint32_t iRetvalue;
-    uint16_t pResponse;
+    uint16_t pResponse = 0;
 
-    iRetvalue = IA61x_download_bin((uint8_t *)VQ_Bin, sizeof(VQ_Bin));
-    delay_ms(35); //wait for firmware to initialize. minimum 30 mS delay
+    iRetvalue = IA61x_download_bin((const uint8_t *)VQ_Bin, sizeof(VQ_Bin));
 
-    //if FW download is success then ping firmware and confirm that FW is up and running
+    //if FW download is success then ping firmware until it is up and running, at most IA61x_READY_FW_US
     if (iRetvalue == CMD_SUCCESS) 
     {
-        if(!IA61x_i2c_cmd(SYNC_CMD,EMPTY_DATA,1, &pResponse))
+        if(!IA61x_ready_wait(IA61x_proto_fw_ready, &pResponse, IA61x_READY_FW_POLL_US, IA61x_READY_FW_US))
         {
+            IA61x_PROFILE_MARK(IA61x_PROF_FW_READY, 0);
             //Firmware is up and running so now set the IRQ for Event detection on Host and IA61x.
-            if(!IA61x_samd21_vq_i2c_reg_IRQ())
+            if(!IA61x_proto_reg_irq(I2C_EIC_CHANNEL, I2C_EIC_PIN, I2C_EIC_PIN_MUX))
                 return(pResponse);
         }
     }
@@ -379,104 +409,11 @@ static int32_t IA61x_i2c_download_firmware(void)
 }
 
 
-/*******************************************************************************************************
- * @fn      IA61x_i2c_download_keyword()
- *
- * @brief   Download Keyword models to IA61x.
- *
- * @param   data    Data buffer to send to IA61x
- * @param   size    Data buffer length
- *
- * @retval  SUCCESS
- *
- *******************************************************************************************************/
-uint8_t DownloadNumber  = 0;
-#if IA611_VOICE_ID
-    uint8_t Ref_model = 0;
-#endif
-
-static int32_t IA61x_i2c_download_keyword(uint16_t *data, uint16_t size)
-{
-    uint16_t Response = 0;
-    uint16_t BlockCount = 0;
-    uint32_t dataindex = 0;
-    uint16_t blockindex = 0;
-    uint16_t SEQ = 0;
-    uint16_t spacket_g = 0;
-    uint8_t inbuf2[4];
-
-    /* --------------------------------------------- */
-    /* -- BEGIN Creating Header info for STX MODE -- */
-    /* --------------------------------------------- */
-    /* generate the length */
-    spacket_g = (uint16_t)((size / WDB_SIZE_NO_HEADER));
-    spacket_g = ((size % WDB_SIZE_NO_HEADER) > 0) ? (spacket_g + 1) : spacket_g;
-
-    //Send Write Data Block command
-    IA61x_i2c_cmd(WDB_CMD,size,1, &Response);
-
-    delay_us(100);
-
-#if IA611_VOICE_ID       //No need to add the keyword ID to the Voice ID reference model file.
-    if((DownloadNumber == 1) && (Ref_model == 0))
-        SEQ = data[1];
-    else
-#endif
-    SEQ = data[1] + (DownloadNumber<<4); /**Set the Keyword sequence number in header bit 4 -7**/
-
-    /* ----------------Send the OEM Model --------------------------------------------*/
-    for (dataindex = 2; dataindex < (size / 2); )
-    {
-        
-        delay_us(100);
-
-        //Send Block Header including updated block sequence number
-        IA61x_i2c_put((uint8_t *)&data[0], 2);
-        IA61x_i2c_put((uint8_t *)&SEQ, 2);
-
-        //Send 512 Bytes block to IA61x
-        for (blockindex = 2; blockindex < (WDB_SIZE/2); blockindex++)
-        {
-            if (dataindex < (size / 2))
-            {
-                IA61x_i2c_put((uint8_t *)&data[dataindex++], 2);
-            }
-            else //Send extra 0x0000 to Pad the data if it's not 512 byte aligned
-            {
-                dataindex++;
-                IA61x_i2c_put(EMPTY_DATA, 2);
-            }
-        }
-
-        //Increment block counter and updated the Sequence header
-        BlockCount++;
-        if ( BlockCount == spacket_g )//for last block set Sequence number to 0xFF
-        {
-            BlockCount = 0xFF;
-        }
-        SEQ = SEQ | (BlockCount << 8);
-
-    }
-
-    delay_ms(5); //Wait for sometime for firmware to respond.
-
-    IA61x_i2c_get(inbuf2, 4);
-
-#if IA611_VOICE_ID
-    if((DownloadNumber == 1) && (Ref_model == 0))
-        Ref_model = 1;
-    else
-#endif
-    DownloadNumber++; /**Increment OEM keyword download sequence number for next keyword**/
-
-    return (inbuf2[3]);
-}
-
-
 /*******************************************************************************************************
  * @fn      IA61x_i2c_VoiceWake()
  *
- * @brief   Stop the route. Configure algorithm parameters. Select Route 6 and put IA61x in Low Power mode
+ * @brief   Stop the route. Configure algorithm parameters. Select Route 6. Runs the VoiceWake route
+ *          program, parameters IA61x already has are not sent again.
  *
  * @param   none
  *
@@ -485,150 +422,8 @@ static int32_t IA61x_i2c_download_keyword(uint16_t *data, uint16_t size)
  *******************************************************************************************************/
 static int32_t IA61x_i2c_VoiceWake(void)
 {
-
-    uint32_t error = 0;
-    uint16_t pResponse;
-
-    //Send Sync command first to make sure that IA61x is awake. Ignore the response.
-    IA61x_i2c_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
-    delay_ms(1);
-
-    //Send Stop Rout command first
-    if(!IA61x_i2c_cmd(STOP_ROUTE_CMD,EMPTY_DATA,5, &pResponse))
-    {
-        if(pResponse != (uint16_t)EMPTY_DATA)
-            error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-    
-    //Set Digital gain to 20db
-    if(!IA61x_i2c_cmd(SET_DIGITAL_GAIN_CMD,DIGITAL_GAIN_20,1, &pResponse))
-    {
-        if(pResponse != (uint16_t)DIGITAL_GAIN_20)
-            error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-
-    //Set Sample Rate to 16K
-    if(!IA61x_i2c_cmd(SAMPLE_RATE_CMD,SAMPLE_RATE_16K,1, &pResponse))
-    {
-        if(pResponse != (uint16_t)SAMPLE_RATE_16K)
-        error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-
-    //Set Frame Size to 16 mS
-    if(!IA61x_i2c_cmd(FRAME_SIZE_CMD,FRAME_SIZE_16MS,1, &pResponse))
-    {
-        if(pResponse != (uint16_t)FRAME_SIZE_16MS)
-        error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-
-    //Select Route 6
-    if(!IA61x_i2c_cmd(SELECT_ROUTE_CMD,ROUTE_6,1, &pResponse))
-    {
-        if(pResponse != (uint16_t)ROUTE_6)
-        error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-
-    //Set Algorithm Parameter: Sensitivity to 5
-    if(!IA61x_i2c_cmd(SET_ALGO_PARAM_ID,OEM_SENSITIVITY_PARAM,1, &pResponse))
-    {
-        if(pResponse == (uint16_t)OEM_SENSITIVITY_PARAM)
-        {
-            if(!IA61x_i2c_cmd(SET_ALGO_PARAM,OEM_SENSITIVITY_5,1, &pResponse))
-            {
-                if(pResponse != (uint16_t)OEM_SENSITIVITY_5)
-                    error++;
-            }
-            else
-                error++;
-        }
-        else 
-            error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-
-#if IA611_UTK
-    //Set Algorithm Parameter: Sensitivity to 0 for UTK
-    if(!IA61x_i2c_cmd(SET_ALGO_PARAM_ID,UTK_SENSITIVITY_PARAM,1, &pResponse))
-    {
-        if(pResponse == (uint16_t)UTK_SENSITIVITY_PARAM)
-        {
-            if(!IA61x_i2c_cmd(SET_ALGO_PARAM,UTK_SENSITIVITY_0,1, &pResponse))
-            {
-                if(pResponse != (uint16_t)UTK_SENSITIVITY_0)
-                error++;
-            }
-            else
-                error++;
-        }
-        else
-            error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-#endif
-
-#if IA611_VOICE_ID
-    //Set Algorithm Parameter: Sensitivity to 2 for VID
-    if(!IA61x_i2c_cmd(SET_ALGO_PARAM_ID,VID_SENSITIVITY_PARAM,1, &pResponse))
-    {
-        if(pResponse == (uint16_t)VID_SENSITIVITY_PARAM)
-        {
-            if(!IA61x_i2c_cmd(SET_ALGO_PARAM,VID_SENSITIVITY_2,1, &pResponse))
-            {
-                if(pResponse != (uint16_t)VID_SENSITIVITY_2)
-                error++;
-            }
-            else
-            error++;
-        }
-        else
-        error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-#endif
-
-
-    //Set Algorithm Parameter: VS Processing Mode to Keyword detection
-    if(!IA61x_i2c_cmd(SET_ALGO_PARAM_ID,VS_PROCESSING_MODE_PARAM,1, &pResponse))
-    {
-        if(pResponse == (uint16_t)VS_PROCESSING_MODE_PARAM)
-        {
-            if(!IA61x_i2c_cmd(SET_ALGO_PARAM,VS_PROCESSING_MODE_KW,1, &pResponse))
-            {
-                if(pResponse != (uint16_t)VS_PROCESSING_MODE_KW)
-                error++;
-            }
-            else
-            error++;
-        }
-        else
-        error++;
-    }
-    else
-        error++;
-    delay_ms(1);
-
-    return (error);
+    //Compiled from scripts/routeprog/routes, each step is checked against its expected response
+    return (IA61x_route_run(VOICEWAKE_ROUTE, sizeof(VOICEWAKE_ROUTE) / sizeof(VOICEWAKE_ROUTE[0])));
 }
 
 /*Dummy function for future implementation*/
@@ -637,42 +432,38 @@ static int32_t IA61x_i2c_close(void)
     return (0);
 }
 
+/* Byte transport of the protocol core */
+static const IA61x_bus i2c_bus =
+{
+    .get        = IA61x_i2c_get,
+    .put        = IA61x_i2c_put,
+};
+
 /*******************************************************************************************************
- * @fn      IA61x_i2c_wait_keyword
+ * @fn      i2c_boot_sync()
  *
- * @brief   Wait for Keyword, command or timeout to be detected
+ * @brief   Readiness probe, send a sync byte to the boot loader and check the echo
  *
- * @param   delay   Delay value to wait for keyword detection
+ * @param   ctx     unused
  *
- * @retval  response[3]         Keyword ID for the detected keyword or command word
- * @retval  NO_KWD_DETECTED     0 if no keyword is detected by IA61x
+ * @retval  true    Boot loader echoed the sync byte
  *
  *******************************************************************************************************/
-static int32_t IA61x_i2c_wait_keyword(uint32_t delay)
+static bool i2c_boot_sync(void *ctx)
 {
-    uint16_t response = 0;
+    const uint8_t b7[] = { 0xb7 };
+    uint8_t cRetVal = 0;
 
-    //Check if IA61x event detection interrupt is generated!! 
-    //This is the indication that there is either Key word, command or timeout event*/
-    while(!interrupt_flag)
-    {
-        delay_ms(delay); //wait for sometime before checking for interrupt again. Here host can go in sleep mode until the interrupt occurs
-    }
+    (void)ctx;
+    if (IA61x_i2c_put((uint8_t *)b7, 1) != STATUS_OK)
+        return (false);
 
-    interrupt_flag = 0;
-    
+    if (IA61x_i2c_get(&cRetVal, 1) != STATUS_OK)
+        return (false);
 
-    //Send Get Event Command to IA61x to check which event has happened!
-    if(!IA61x_i2c_cmd(GET_EVENT_ID_CMD, EMPTY_DATA, 2, &response))
-    {
-        if(response)
-            return (0x00FF & response); // Mask off other 
-    }    
-    
-    return (NO_KWD_DETECTED);
+    return (cRetVal == 0xb7);
 }
 
-
 /*******************************************************************************************************
  * @fn      IA61x_samd21_vq_i2c_init
  *
@@ -682,7 +473,7 @@ static int32_t IA61x_i2c_wait_keyword(uint32_t delay)
  *
  *              |                                                   |
  *          Host|->>----------------Power OFF/ON---------------->>->| IA61x
- *              |                   Delay 20 mSec                   |
+ *              |      Sync repeated until echoed, max 20 mSec      |
  *              |->>----------Send Sync Byte - B7 -------------->>->|
  *              |-<<------------Ack Sync Byte - B7 -------------<<->|
  *
@@ -694,9 +485,15 @@ static int32_t IA61x_i2c_wait_keyword(uint32_t delay)
  *******************************************************************************************************/
 int32_t IA61x_samd21_vq_i2c_init(IA61x_instance *IA61x)
 {
-    const uint8_t b7[]              =       { 0xb7 };
-    uint8_t cRetVal;
     struct port_config pin_conf;
+    int32_t status = CMD_FAILED;
+
+    IA61x_timer_init(); /* Time base for the packet retries */
+    IA61x_cmdq_init(&i2c_cmdq);
+    IA61x_proto_bind(&i2c_bus);
+#if IA61x_I2C_USE_DMA
+    IA61x_dma_init();
+#endif
 
     IA61x_samd21_vq_i2c_uninit();
 
@@ -708,45 +505,45 @@ int32_t IA61x_samd21_vq_i2c_init(IA61x_instance *IA61x)
     port_pin_set_config(I2C_SLAVE_ADD2_PIN, &pin_conf);
     port_pin_set_output_level(I2C_SLAVE_ADD2_PIN, false);
 
-    /*Power cycle IA61x so Bootloader goes into Auto-detect state to detect the host controller interface*/
+    IA61x_param_invalidate(); //IA61x loses its firmware and parameters
+
+    /*Power cycle IA61x so Bootloader goes into Auto-detect state to detect the host controller interface.
+     *The I2C pins are set up while IA61x is off, so it only ever sees an idle bus.*/
     port_pin_set_output_level(IA61x_LDO_ENABLE, 0 ); /* Make sure it's low */
     delay_ms(1);
 
-    port_pin_set_output_level(IA61x_LDO_ENABLE, 1 );  /* Bring LDO Enable High */
-    delay_ms(20);
-
     my_i2c_init(); /* Configure the I2C to talk to the boot loader */
-    delay_ms(1);
-
-    /*Power cycle IA61x so Bootloader goes into Auto-detect state to detect the host controller interface*/
-    port_pin_set_output_level(IA61x_LDO_ENABLE, 0 ); /* Make sure it's low */
-    delay_ms(1);
 
     port_pin_set_output_level(IA61x_LDO_ENABLE, 1 );  /* Bring LDO Enable High */
-    delay_ms(20);
-
-    /*Send Sync Byte to IA61x*/
-    delay_ms(1);
-    IA61x_i2c_put((uint8_t *)b7, 1);
+    IA61x_PROFILE_MARK(IA61x_PROF_LDO_ON, 0);
 
-    delay_ms(1);
-    while (IA61x_i2c_get(&cRetVal, 1) != STATUS_OK) ;
+    /*Send Sync Byte to IA61x until the boot loader echoes it, the boot loader is settled once it echoes again*/
+    if (IA61x_ready_wait(i2c_boot_sync, NULL, IA61x_READY_SYNC_POLL_US, IA61x_READY_LDO_US) == CMD_SUCCESS)
+    {
+        IA61x_PROFILE_MARK(IA61x_PROF_LDO_SETTLED, 0);
+        IA61x_PROFILE_MARK(IA61x_PROF_SYNC, 0xb7);
+        status = IA61x_ready_wait(i2c_boot_sync, NULL, IA61x_READY_SYNC_POLL_US, IA61x_READY_BOOT_US);
+    }
 
-    if (cRetVal != 0xb7)
+    if (status != CMD_SUCCESS)
+    {
+        //Leave the pins to the next interface probed
+        my_i2c_uninit();
+        IA61x_samd21_vq_i2c_uninit();
         return (CMD_FAILED);
-
-    delay_ms(10);
+    }
 
     /*Initialize IA61x API Handle*/
     IA61x->download_config  = IA61x_i2c_download_config;
     IA61x->download_program = IA61x_i2c_download_firmware;
-    IA61x->download_keyword = IA61x_i2c_download_keyword;
+    IA61x->download_keyword = IA61x_proto_download_keyword;
     IA61x->VoiceWake        = IA61x_i2c_VoiceWake;
     IA61x->close            = IA61x_i2c_close;
-    IA61x->wait_keyword     = IA61x_i2c_wait_keyword;
-    IA61x->cmd              = IA61x_i2c_cmd;
+    IA61x->wait_keyword     = IA61x_proto_wait_keyword;
+    IA61x->cmd              = IA61x_proto_cmd;
     IA61x->get              = IA61x_i2c_get;
     IA61x->put              = IA61x_i2c_put;
+    IA61x->rdb              = IA61x_proto_rdb;
 
     return (SUCCESS);
 }
@@ -774,4 +571,4 @@ int32_t IA61x_samd21_vq_i2c_uninit(void)
     return (SUCCESS);
 }
 
-#endif /* ifdef IA61x_SAMD21_VQ_UART */
\ No newline at end of file
+#endif /* ifdef IA61x_SAMD21_VQ_I2C */
\ No newline at end of file
@@ -39,6 +39,8 @@ extern int32_t IA61x_samd21_vq_i2c_init(IA61x_instance *IA61x);
 extern int32_t IA61x_samd21_vq_i2c_uninit(void);
 
 #define CONF_I2C_MASTER_MODULE    SERCOM2
+#define CONF_I2C_MASTER_DMAC_ID_TX      SERCOM2_DMAC_ID_TX
+#define CONF_I2C_MASTER_GCLK_GENERATOR  GCLK_GENERATOR_1    //24.576 MHz, GCLK0 (8 MHz) cannot make 1 MHz SCL
 #define SLAVE_ADDRESS 0x3E //for IA61x ADD0 = 0  and ADD1 = 0 ==> slave Address is 0x3E
 
 #define I2C_SLAVE_ADD1_PIN  PIN_PA07
@@ -50,8 +52,14 @@ extern int32_t IA61x_samd21_vq_i2c_uninit(void);
 #define I2C_EIC_CHANNEL     4
 
 
-/* Number of times to try to send packet if failed. */
-#define I2C_TIMEOUT 1000
+/* Time to keep sending a packet IA61x does not take (NACK, lost bus), about 1000 tries at 400 kHz */
+#define I2C_RETRY_US    20000
+
+/* Bus time of one DMA packet, clock stretching by IA61x included */
+#define I2C_PACKET_US   5000
+
+/* Bytes per DMA packet, limited by the 8 bit ADDR.LEN of the SERCOM */
+#define I2C_DMA_PACKET  255
 
 
 #endif
\ No newline at end of file
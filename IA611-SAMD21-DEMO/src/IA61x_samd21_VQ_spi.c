@@ -36,19 +36,55 @@
 # include <asf.h>
 # include <string.h>
 # include "IA61x_samd21_VQ_spi.h"
-
-# include "trill_sys_config.h"       /*Trillbit SDK Sys config*/
-
-# include "IA611_FW_Bin_SPI.h"         /* Firmware Binary for SPI interface */
+# include "IA61x_profile.h"
+# include "IA61x_ready.h"
+# include "IA61x_cmdq.h"
+# include "IA61x_param.h"
+# if IA61x_SPI_USE_DMA
+#  include "IA61x_samd21_dma.h"
+# endif
+
+# include "IA61x_proto.h"
+
+# if IA61x_FW_ASYNC && !(IA61x_FW_COMPRESSED && IA61x_SPI_USE_DMA)
+#  error "IA61x_FW_ASYNC streams through the DMA download path of IA61x_FW_COMPRESSED and IA61x_SPI_USE_DMA"
+# endif
+
+# if IA61x_WARM_ATTACH
+#  include "IA61x_warm.h"
+# endif
+
+# if IA61x_FW_CONTAINER
+#  include "IA61x_image.h"            /* Firmware and Sys config from the image container */
+# elif IA61x_FW_COMPRESSED
+#  include "trill_sys_config_lz.h"    /*Trillbit SDK Sys config, LZ compressed*/
+#  include "IA611_FW_Bin_SPI_lz.h"    /* Firmware Binary for SPI interface, LZ compressed */
+# else
+#  include "trill_sys_config.h"       /*Trillbit SDK Sys config*/
+#  include "IA611_FW_Bin_SPI.h"         /* Firmware Binary for SPI interface */
+# endif
 /*********************************************************************************/
 // private
 /*********************************************************************************/
 struct spi_module spi_master_instance;
-volatile uint8_t interrupt_flag = 0;
 volatile uint8_t rcv_complete_spi_master = 0;
 volatile uint8_t tx_complete_spi_master = 0;
+#if IA61x_SPI_USE_DMA
+static volatile uint8_t dma_complete_spi_master = 0;
+static volatile enum status_code dma_status_spi_master = STATUS_OK;
+static IA61x_dma_callback_t dma_user_callback = NULL;
+#endif
+
+/* Post boot SCLK ramp, BAUD register values from fastest to slowest: SCLK = fref / (2 * (BAUD + 1)) */
+static const uint8_t spi_sclk_ladder[] = { 0, 1, 2, 3, 5 };
+#define SPI_SCLK_STEPS  (sizeof(spi_sclk_ladder) / sizeof(spi_sclk_ladder[0]))
 
-static int32_t IA61x_spi_cmd(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse);
+static uint8_t  spi_sclk_step = SPI_SCLK_STEPS;    /* SPI_SCLK_STEPS selects the boot loader SCLK */
+static uint32_t spi_sclk = 0;
+static uint8_t  spi_cmd_failures = 0;
+static bool     spi_sclk_ramping = false;
+
+static void IA61x_spi_sclk_step_down(void);
 
 /***************************************************************************
  * @fn      IA61x_spi_get()
@@ -100,166 +136,147 @@ static int32_t IA61x_spi_put(uint8_t *pData, uint32_t size)
     return retVal;
 }
 
-static inline uint32_t swap_ui32(uint32_t v)
+/*******************************************************************************************************
+ * @fn      spi_cmdq_send()
+ *
+ * @brief   Command queue transport, write the command and data word
+ *
+ * @param   cmdWord     Command word to send to IA61x
+ * @param   dataWord    Data word to send to IA61x
+ *
+ * @retval  CMD_FAILED  Command could not be sent
+ * @retval  CMD_SUCCESS Command sent
+ *
+ *******************************************************************************************************/
+static int32_t spi_cmdq_send(uint16_t cmdWord, uint16_t dataWord)
 {
-	union {
-		uint32_t w;
-		uint8_t b[4];
-	} data;
-	
-	data.w = v;
-	return (data.b[0] << 24) | (data.b[1] << 16) | (data.b[2] << 8) | data.b[3];
-}
+    uint8_t frame[4];
 
-/************************************************************************
-	@fn      IA61x_spi_rdb()
-	@brief	 Read block from the firmware
+    IA61x_cmdq_frame(frame, cmdWord, dataWord);
 
-************************************************************************/
-static int32_t IA61x_spi_rdb(uint8_t algo_id, uint8_t block_type, uint8_t *data, uint32_t *size)
-{
-	
-	uint16_t param = algo_id;
-	uint16_t response;
-	int32_t ret;
-	
-	param = (param << 8) | block_type;
-	
-	ret = IA61x_spi_cmd(RDB_CMD, param, 1, &response);
-	if (ret != CMD_SUCCESS)
-		return ret;
-	
-	if (response == 0)
-	{
-		*size = 0;
-		return 0;
-	}
-	
-	if (response > *size) 
-	{
-		ret = IA61x_spi_get(data, *size);
-		if (ret == 0)
-		{
-			uint32_t wdata;
-			uint32_t pending = response - *size;
-			while (pending > 0)
-			{
-				// RDB data size is multiple of 4 bytes.
-				IA61x_spi_get((uint8_t*)&wdata, 4);
-				pending -= 4;
-			}
-		}
-	}
-	else
-	{
-		ret = IA61x_spi_get(data, response);
-		*size = response;
-	}
-	
-	uint32_t* p = (uint32_t*) data;
-	for (uint32_t i = 0; i < (*size / 4); i++)
-	{
-		p[i] = swap_ui32(p[i]);
-	}
-	
-	return ret;
+    return ((IA61x_spi_put(frame, 4) == STATUS_OK) ? CMD_SUCCESS : CMD_FAILED);
 }
+
 /*******************************************************************************************************
- * @fn      IA61x_spi_cmd()
+ * @fn      spi_cmdq_probe()
  *
- * @brief   Send Command word and Data word to IA61x and receive response. If no response is expected 
- *          from IA61x then timeout should be 0.
+ * @brief   Command queue transport, read the response of the last command
  *
- * @param   cmdWord     Command word to send to IA61x
- * @param   dataWord    Data word to send to IA61x
- * @param   timeout     Response read retry count. Set to 0 if no response expected
+ * @param   cmdWord     Command word that was sent
  * @param   pResponse   Response word from IA61x
  *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
+ * @retval  CMD_SUCCESS Response word is valid
+ * @retval  CMD_TIMEOUT Not answered yet
  *
  *******************************************************************************************************/
-static int32_t IA61x_spi_cmd(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse)
+static int32_t spi_cmdq_probe(uint16_t cmdWord, uint16_t *pResponse)
 {
-    int32_t cmdResult = CMD_SUCCESS;
-    uint32_t data = 0;
-    union _tmp {
-        uint16_t word[2];
-        uint8_t byte[4];
-    } tmp;
+    uint8_t data[4] = { 0 };
 
-    tmp.word[0] = cmdWord;
-    tmp.word[1] = dataWord;
+    IA61x_spi_get(data, 4);
 
-    //Command Word first and then Data word
-    data = tmp.byte[1] | tmp.byte[0]<<8 | tmp.byte[3]<<16 | tmp.byte[2] << 24;
-    IA61x_spi_put((uint8_t *)&data, 4);
+    return (IA61x_ready_response(data, cmdWord, pResponse) ? CMD_SUCCESS : CMD_TIMEOUT);
+}
 
-    tmp.word[0] = 0x0000;
-    tmp.word[1] = 0x0000;
+static const IA61x_cmdq_transport spi_cmdq = { spi_cmdq_send, spi_cmdq_probe };
 
-    //if timeout is 0 then no need to read the response else try reading the data multiple times
-    while(timeout--)
+/*******************************************************************************************************
+ * @fn      spi_cmd_done()
+ *
+ * @brief   Command outcome hook of the protocol core. Repeated failures at a ramped SCLK are treated
+ *          as a marginal link and step SCLK down.
+ *
+ * @param   result      Command result
+ * @param   answered    Command expected a response
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void spi_cmd_done(int32_t result, bool answered)
+{
+    if ((result != CMD_SUCCESS) && !spi_sclk_ramping)
+    {
+        if (++spi_cmd_failures >= IA61x_SPI_FAIL_STEP_DOWN)
+            IA61x_spi_sclk_step_down();
+    }
+    else if (answered)
     {
-        delay_ms(5);// Delay for Firmware to prepare the response.
+        spi_cmd_failures = 0;
+    }
+}
 
-        //Read response 
-        IA61x_spi_get(tmp.byte, 4);
+#if IA61x_SPI_USE_DMA
+/*******************************************************************************************************
+ * @fn      dma_callback_spi_master
+ *
+ * @brief   DMAC completion callback for SPI transmit. Waits for the last character to leave the shift
+ *          register, releases SS and discards the characters clocked in during the transmit only
+ *          transfer so the next read starts with an empty receiver.
+ *
+ * @param   status  DMAC transfer status
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void dma_callback_spi_master(enum status_code status)
+{
+    SercomSpi *const spi = &spi_master_instance.hw->SPI;
 
-        *pResponse = (tmp.byte[0] << 8) | tmp.byte[1] ;
-        //return the second response word if the first response word matches command word
-        if(*pResponse == cmdWord)
-        {
-            *pResponse = (tmp.byte[2] << 8) | tmp.byte[3];
-            cmdResult = CMD_SUCCESS;
-            break;
-        }
-        else
-        {
-            cmdResult = CMD_FAILED;
-        }
+    if (status == STATUS_OK)
+    {
+        while (!(spi->INTFLAG.reg & SERCOM_SPI_INTFLAG_TXC)) ;
     }
+    port_pin_set_output_level(SPI_EXT_SS, 1 );
 
-    return (cmdResult);
+    while (spi->INTFLAG.reg & SERCOM_SPI_INTFLAG_RXC)
+    {
+        (void)spi->DATA.reg;
+    }
+    spi->STATUS.reg = SERCOM_SPI_STATUS_BUFOVF;
+
+    dma_status_spi_master = status;
+    dma_complete_spi_master = true;
+
+    if (dma_user_callback)
+        dma_user_callback(status);
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_download_bin()
+ * @fn      IA61x_spi_put_dma()
  *
- * @brief   Function to download sys config or Firmware binary to IA61x
+ * @brief   Start a DMA driven SPI write. SS stays asserted for the whole buffer, which may be larger
+ *          than 64 KB and may reside in flash. Returns immediately, completion is reported through
+ *          the callback (interrupt context) and dma_complete_spi_master.
  *
- * @param   pData       Data buffer to send to IA61x
- * @param   size        Size of data buffer
+ * @param   pData       Send data Buffer
+ * @param   size        Size of data to be sent
+ * @param   callback    Completion or error callback, may be NULL
  *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
+ * @retval  STATUS_OK   Transfer started
+ * @retval  other       DMAC could not start the transfer
  *
  *******************************************************************************************************/
- static int32_t IA61x_download_bin(uint8_t *pData, uint32_t size)
+static enum status_code IA61x_spi_put_dma(const uint8_t *pData, uint32_t size, IA61x_dma_callback_t callback)
 {
-    const uint8_t Load01[] = { 0x00, 0x00, 0x00, 0x01 };
-    uint8_t cRetVal[4];
-    uint32_t iCount = 0;
+    SercomSpi *const spi = &spi_master_instance.hw->SPI;
+    enum status_code status;
 
-    //Send Boot command to IA61x and check for the Boot ACK
-    if(IA61x_spi_put((uint8_t *)Load01, 4) == STATUS_OK)
-    {
-        if((IA61x_spi_get((uint8_t *)cRetVal, 4) != STATUS_OK) || (cRetVal[3] != 0x01))
-        {
-            return (CMD_FAILED);
-        }
-    }
-    else return (CMD_FAILED);
+    dma_complete_spi_master = false;
+    dma_user_callback = callback;
 
-    iCount = 0;
-    while (iCount < size) 
+    spi->INTFLAG.reg = SERCOM_SPI_INTFLAG_TXC;
+    port_pin_set_output_level(SPI_EXT_SS, 0 );
+
+    status = IA61x_dma_write(IA61x_DMA_CH_SPI_TX, CONF_MASTER_DMAC_ID_TX,
+                             &spi->DATA.reg, pData, size, dma_callback_spi_master);
+    if (status != STATUS_OK)
     {
-        IA61x_spi_put(&pData[iCount], ((size - iCount >= 0xFFFF) ? 0xFFFF : (size - iCount)));
-        iCount += 0xFFFF;
+        port_pin_set_output_level(SPI_EXT_SS, 1 );
     }
 
-    return (CMD_SUCCESS);
+    return status;
 }
+#endif /* IA61x_SPI_USE_DMA */
 
 /*******************************************************************************************************
  * @fn      rcv_callback_spi_master
@@ -293,6 +310,182 @@ static void tx_callback_spi_master( struct spi_module *const module)
 
 
 
+/*******************************************************************************************************
+ * @fn      my_spi_sclk_baud()
+ *
+ * @brief   Slowest BAUD register value whose SCLK does not exceed the requested rate
+ *
+ * @param   sclk    Requested SCLK in Hz
+ *
+ * @retval  BAUD register value
+ *
+ *******************************************************************************************************/
+static uint8_t my_spi_sclk_baud(uint32_t sclk)
+{
+    uint32_t fref = system_gclk_gen_get_hz(CONF_MASTER_GCLK_GENERATOR) / 2;
+    uint32_t div = (fref + sclk - 1) / sclk;
+
+    if (div == 0)
+        div = 1;
+    if (div > 256)
+        div = 256;
+
+    return (uint8_t)(div - 1);
+}
+
+/*******************************************************************************************************
+ * @fn      my_spi_set_sclk()
+ *
+ * @brief   Change the SPI clock. BAUD is enable protected, so the SERCOM is briefly disabled. Must not
+ *          be called while a transfer is in progress.
+ *
+ * @param   baud    BAUD register value
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void my_spi_set_sclk(uint8_t baud)
+{
+    SercomSpi *const spi = &spi_master_instance.hw->SPI;
+
+    spi_disable(&spi_master_instance);
+    spi->BAUD.reg = baud;
+    spi_enable(&spi_master_instance);
+
+    spi_sclk = system_gclk_gen_get_hz(CONF_MASTER_GCLK_GENERATOR) / (2 * ((uint32_t)baud + 1));
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_spi_read_build()
+ *
+ * @brief   Read the first characters of the firmware build string
+ *
+ * @param   pData   Buffer for the characters, zero padded if the string is shorter
+ * @param   size    Number of characters to read
+ *
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Command execution successful
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_spi_read_build(uint8_t *pData, uint32_t size)
+{
+    uint16_t response = 0;
+    uint32_t i;
+
+    memset(pData, 0, size);
+
+    for (i = 0; i < size; i++)
+    {
+        if (IA61x_proto_cmd((i == 0) ? BUILD_STRING_CMD1 : BUILD_STRING_CMD2, EMPTY_DATA, 1, &response) != CMD_SUCCESS)
+            return (CMD_FAILED);
+
+        pData[i] = (uint8_t)response;
+        if (pData[i] == 0)
+            break;
+    }
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_spi_selftest()
+ *
+ * @brief   Link integrity check at the current SCLK: Sync round-trips followed by a build string
+ *          read that must match the reference taken at the boot loader SCLK.
+ *
+ * @param   ref     Build string reference, IA61x_SPI_SELFTEST_CHARS long
+ *
+ * @retval  CMD_FAILED  Self-test failed
+ * @retval  CMD_SUCCESS Self-test passed
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_spi_selftest(const uint8_t *ref)
+{
+    uint8_t build[IA61x_SPI_SELFTEST_CHARS];
+    uint16_t response;
+    uint32_t i;
+
+    for (i = 0; i < IA61x_SPI_SELFTEST_SYNCS; i++)
+    {
+        if ((IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, &response) != CMD_SUCCESS) || (response != SYNC_RESP_NORM))
+            return (CMD_FAILED);
+    }
+
+    if (IA61x_spi_read_build(build, sizeof(build)) != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    if (memcmp(build, ref, sizeof(build)) != 0)
+        return (CMD_FAILED);
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_spi_ramp_sclk()
+ *
+ * @brief   Once the firmware is running, select the fastest ladder SCLK (up to IA61x_SPI_MAX_SCLK)
+ *          that passes the self-test. Stays at the boot loader SCLK if no step passes.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void IA61x_spi_ramp_sclk(void)
+{
+    uint8_t ref[IA61x_SPI_SELFTEST_CHARS];
+    uint32_t fref = system_gclk_gen_get_hz(CONF_MASTER_GCLK_GENERATOR) / 2;
+    uint8_t step;
+
+    spi_sclk_ramping = true;
+
+    if ((IA61x_spi_read_build(ref, sizeof(ref)) == CMD_SUCCESS) && (ref[0] != 0))
+    {
+        for (step = 0; step < SPI_SCLK_STEPS; step++)
+        {
+            if ((fref / ((uint32_t)spi_sclk_ladder[step] + 1)) > IA61x_SPI_MAX_SCLK)
+                continue;
+
+            my_spi_set_sclk(spi_sclk_ladder[step]);
+            if (IA61x_spi_selftest(ref) == CMD_SUCCESS)
+                break;
+        }
+
+        spi_sclk_step = step;
+        if (step == SPI_SCLK_STEPS)
+            my_spi_set_sclk(my_spi_sclk_baud(IA61x_SPI_BOOT_SCLK));
+    }
+
+    spi_cmd_failures = 0;
+    spi_sclk_ramping = false;
+    IA61x_PROFILE_MARK(IA61x_PROF_RATE, spi_sclk / 1000);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_spi_sclk_step_down()
+ *
+ * @brief   Move one ladder step slower, ending at the boot loader SCLK
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void IA61x_spi_sclk_step_down(void)
+{
+    spi_cmd_failures = 0;
+
+    if (spi_sclk_step >= SPI_SCLK_STEPS)
+        return;
+
+    spi_sclk_step++;
+    if (spi_sclk_step == SPI_SCLK_STEPS)
+        my_spi_set_sclk(my_spi_sclk_baud(IA61x_SPI_BOOT_SCLK));
+    else
+        my_spi_set_sclk(spi_sclk_ladder[spi_sclk_step]);
+    IA61x_PROFILE_MARK(IA61x_PROF_RATE, spi_sclk / 1000);
+}
+
 /*******************************************************************************************************
  * @fn      my_spi_init()
  *
@@ -327,10 +520,15 @@ static void my_spi_init(void)
     /** Mode 1. Leading edge: rising, setup. Trailing edge: falling, sample */
     config_spi_master.transfer_mode = SPI_TRANSFER_MODE_1;
     //config_spi_master.master_slave_select_enable = false;       /*Use external SS*/
-    config_spi_master.mode_specific.master.baudrate = 1000000;
+    config_spi_master.mode_specific.master.baudrate = IA61x_SPI_BOOT_SCLK;
+    config_spi_master.generator_source = CONF_MASTER_GCLK_GENERATOR;
 
     spi_init(&spi_master_instance, CONF_MASTER_SPI_MODULE, &config_spi_master);
-    spi_enable(&spi_master_instance);
+
+    //Boot loader always starts at the conservative clock, also when re-initialized after a ramp
+    spi_sclk_step = SPI_SCLK_STEPS;
+    spi_cmd_failures = 0;
+    my_spi_set_sclk(my_spi_sclk_baud(IA61x_SPI_BOOT_SCLK));
 
     //Register and enable SPI callback for the transmit or receive complete event
     spi_register_callback(&spi_master_instance, rcv_callback_spi_master, SPI_CALLBACK_BUFFER_RECEIVED);
@@ -338,6 +536,9 @@ static void my_spi_init(void)
     spi_register_callback(&spi_master_instance, tx_callback_spi_master, SPI_CALLBACK_BUFFER_TRANSMITTED);
     spi_enable_callback(&spi_master_instance, SPI_CALLBACK_BUFFER_TRANSMITTED);
 
+#if IA61x_SPI_USE_DMA
+    IA61x_dma_init();
+#endif
 }
 
 
@@ -351,262 +552,178 @@ static void my_spi_init(void)
  * @retval  none
  *
  *******************************************************************************************************/
-/*static void my_spi_uninit(void)
+static void my_spi_uninit(void)
 {
     spi_disable(&spi_master_instance);
-}*/
-
-/*******************************************************************************************************
- * @fn      IA61x_spi_download_config()
- *
- * @brief   Download Sysconfig file to IA61x
- *
- * @param   none
- *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
- *
- *******************************************************************************************************/
-static int32_t IA61x_spi_download_config(void)
-{
-    uint32_t iRetVal;
-
-    iRetVal = IA61x_download_bin((uint8_t *)SCFG, sizeof(SCFG));
-
-    return (iRetVal);
 }
 
+#if IA61x_WARM_ATTACH
 /*******************************************************************************************************
- * @fn      SPI_Irq_callback
+ * @fn      IA61x_spi_image_id()
  *
- * @brief   Callback function invoked by the eternal interrupt when IA61x detects the keyword or command.
+ * @brief   Identity of the embedded program image for warm attach and the version cache. The
+ *          container already holds a CRC32 of each section. Otherwise the first 64 bytes are hashed,
+ *          they hold the image header with its build time stamp and version string.
  *
  * @param   none
  *
- * @retval  none
+ * @retval  Image identity
  *
  *******************************************************************************************************/
-static void SPI_Irq_callback(void)
+static uint32_t IA61x_spi_image_id(void)
 {
-    interrupt_flag = true;
+#if IA61x_FW_CONTAINER
+    IA61x_image_section section;
+
+    if (IA61x_image_find(IA61x_IMG_PROGRAM_SPI, &section) != STATUS_OK)
+        return (0);
+    return (section.crc);
+#elif IA61x_FW_COMPRESSED
+    return (IA61x_warm_hash(VQ_Bin_lz, 64, IA61x_WARM_HASH_INIT) ^ sizeof(VQ_Bin_lz));
+#else
+    return (IA61x_warm_hash((const uint8_t *)VQ_Bin, 64, IA61x_WARM_HASH_INIT) ^ sizeof(VQ_Bin));
+#endif
 }
+#endif /* IA61x_WARM_ATTACH */
 
 /*******************************************************************************************************
- * @fn      IA61x_samd21_vq_spi_reg_IRQ
+ * @fn      IA61x_spi_download_config()
  *
- * @brief   Configure Host External interrupt and register the callback function. Setup rising edge interrupt
-            on the IA61x for keyword/command detection event
+ * @brief   Download Sysconfig file to IA61x
  *
  * @param   none
  *
- * @retval  ERROR   In case of Set Event Response Command fails 
- * @retval  SUCCESS In case of no error
+ * @retval  CMD_FAILED  Command Failed Error
+ * @retval  CMD_SUCCESS Command execution successful
  *
  *******************************************************************************************************/
-static uint32_t IA61x_samd21_vq_spi_reg_IRQ(void)
+static int32_t IA61x_spi_download_config(void)
 {
-    uint16_t    pResponse = 0;
-    /* Structure for external interrupt channel configuration */
-    struct extint_chan_conf eic_conf;
-
-    //set the type of interrupt (Rising Edge) generated on the HOST_IRQ line after an event detected by IA61x
-    if(!IA61x_spi_cmd(SET_EVENT_RESP_CMD,IA61x_INT_RISE_EDGE,1, &pResponse))
-    {
-        if(pResponse != (uint16_t)IA61x_INT_RISE_EDGE)
-        return (ERROR);
-    }
-
-
-    /* Configure the external interrupt channel */
-    extint_chan_get_config_defaults(&eic_conf);
-    eic_conf.gpio_pin           = SPI_EIC_PIN;
-    eic_conf.gpio_pin_mux       = SPI_EIC_PIN_MUX;
-    eic_conf.gpio_pin_pull      = EXTINT_PULL_UP;
-    eic_conf.detection_criteria = EXTINT_DETECT_RISING;
-    eic_conf.filter_input_signal= true;
-    extint_chan_set_config(SPI_EIC_CHANNEL, &eic_conf);
+    uint32_t iRetVal;
 
-    /* Register and enable the callback function for External interrupt from IA61x*/
-    extint_register_callback(SPI_Irq_callback, SPI_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
-    extint_chan_enable_callback(SPI_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
+#if IA61x_FW_CONTAINER
+    iRetVal = IA61x_download_section(IA61x_IMG_SYSCONFIG);
+#elif IA61x_FW_COMPRESSED
+    iRetVal = IA61x_download_lz(SCFG_lz, sizeof(SCFG_lz), SCFG_LZ_RAW_SIZE);
+#else
+    iRetVal = IA61x_download_bin((const uint8_t *)SCFG, sizeof(SCFG));
+#endif
 
-    return (SUCCESS);
+    return (iRetVal);
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_spi_download_firmware()
+ * @fn      IA61x_spi_firmware_up()
  *
- * @brief   Download IA61x Firmware binary to IA61x
+ * @brief   Wait for a downloaded Firmware to come up, raise SCLK and register the event interrupt
  *
- * @param   none
+ * @param   iRetvalue   Status of the Firmware download
  *
  * @retval  pResponse   response to Sync command
  * @retval  CMD_FAILED Command execution failed
  *
  *******************************************************************************************************/
-static int32_t IA61x_spi_download_firmware(void)
+static int32_t IA61x_spi_firmware_up(int32_t iRetvalue)
 {
-    uint32_t iRetvalue;
-    uint16_t pResponse;
+    uint16_t pResponse = 0;
     uint8_t dummyread[4];
 
-    iRetvalue = IA61x_download_bin((uint8_t *)VQ_Bin, sizeof(VQ_Bin));
-    delay_ms(35); //wait for firmware to initialize. minimum 30 mS delay
-
     IA61x_spi_get(dummyread,4);
 
-    //if FW download is success then ping firmware and confirm that FW is up and running
+    //if FW download is success then ping firmware until it is up and running, at most IA61x_READY_FW_US
     if (iRetvalue == CMD_SUCCESS) 
     {
-        if(!IA61x_spi_cmd(SYNC_CMD,EMPTY_DATA,1, &pResponse))
+        if(!IA61x_ready_wait(IA61x_proto_fw_ready, &pResponse, IA61x_READY_FW_POLL_US, IA61x_READY_FW_US))
         {
+            IA61x_PROFILE_MARK(IA61x_PROF_FW_READY, 0);
+
+            //Firmware is up and running, leave the boot loader clock behind
+            IA61x_spi_ramp_sclk();
+
             //Firmware is up and running so now set the IRQ for Event detection on Host and IA61x.
-            if(!IA61x_samd21_vq_spi_reg_IRQ())
+            if(!IA61x_proto_reg_irq(SPI_EIC_CHANNEL, SPI_EIC_PIN, SPI_EIC_PIN_MUX))
+            {
+#if IA61x_WARM_ATTACH
+                IA61x_warm_commit(IA61x_proto_cmd, IA61x_spi_image_id(), spi_sclk);
+#endif
                 return(pResponse);
+            }
 		}
     }
 
     return (CMD_FAILED);
 }
 
-
 /*******************************************************************************************************
- * @fn      IA61x_spi_download_keyword()
+ * @fn      IA61x_spi_download_firmware()
  *
- * @brief   Download Keyword models to IA61x.
+ * @brief   Download IA61x Firmware binary to IA61x
  *
- * @param   data    Data buffer to send to IA61x
- * @param   size    Data buffer length
+ * @param   none
  *
- * @retval  SUCCESS
+ * @retval  pResponse   response to Sync command
+ * @retval  CMD_FAILED Command execution failed
  *
  *******************************************************************************************************/
-uint8_t DownloadNumber  = 0;
-#if IA611_VOICE_ID
-    uint8_t Ref_model = 0;
-#endif
-
-static int32_t IA61x_spi_download_keyword(uint16_t *data, uint16_t size)
+static int32_t IA61x_spi_download_firmware(void)
 {
+    int32_t iRetvalue;
 
-    uint16_t BlockCount = 0;
-    uint32_t dataindex = 0;
-    uint16_t blockindex = 0;
-    uint16_t SEQ = 0;
-    uint16_t spacket_g = 0;
-    uint8_t inbuf2[4];
-    uint8_t *pData;
-    uint16_t dataremain = 0;
-    uint8_t zeropadding[WDB_SIZE_NO_HEADER];
-    uint32_t header = 0;
-
-    union _tmp {
-    uint16_t word[2];
-    uint8_t byte[4];
-    } tmp;
-
-    pData = (uint8_t *)data;
-
-    memset(zeropadding,0x00,WDB_SIZE_NO_HEADER);// zeropadding for the last chunk if it is not 512 bytes aligned.
-
-    /* --------------------------------------------- */
-    /* -- BEGIN Creating Header info for STX MODE -- */
-    /* --------------------------------------------- */
-    /* generate the length */
-    spacket_g = (uint16_t)(((size-4) / WDB_SIZE_NO_HEADER));
-    spacket_g = (((size-4) % WDB_SIZE_NO_HEADER) > 0) ? (spacket_g + 1) : spacket_g;
-
-    //Send Write Data Block command
-
-    tmp.word[0] = WDB_CMD;
-    tmp.word[1] = size;
-    //Command Word first and then Data word
-    header = tmp.byte[1] | tmp.byte[0]<<8 | tmp.byte[3]<<16 | tmp.byte[2] << 24;
-    IA61x_spi_put((uint8_t *)&header, 4);
-
-
-    delay_ms(5);
-
-#if IA611_VOICE_ID       //No need to add the keyword ID to the Voice ID reference model file.
-    if((DownloadNumber == 1) && (Ref_model == 0))
-        SEQ = data[1];
-    else
+#if IA61x_FW_CONTAINER
+    iRetvalue = IA61x_download_section(IA61x_IMG_PROGRAM_SPI);
+#elif IA61x_FW_COMPRESSED
+    iRetvalue = IA61x_download_lz(VQ_Bin_lz, sizeof(VQ_Bin_lz), VQ_Bin_LZ_RAW_SIZE);
+#else
+    iRetvalue = IA61x_download_bin((const uint8_t *)VQ_Bin, sizeof(VQ_Bin));
 #endif
-    SEQ = data[1] + (DownloadNumber<<4);/**Set the Keyword sequence number in header bit 4 -7**/
 
-    /* ----------------Send the OEM Model --------------------------------------------*/
-    for (dataindex = 4; dataindex < size ; )
-    {
-        
-        delay_us(100);
-
-        port_pin_set_output_level(SPI_EXT_SS, 0 ); //make SS line low. SS needs to be asserted for entire 512 byte chunk
-
-        spi_write_buffer_job(&spi_master_instance,(uint8_t *)&data[0], 2);
-        while (!tx_complete_spi_master){} //Wait until SPI transfer is complete
-        tx_complete_spi_master = false;
-        spi_write_buffer_job(&spi_master_instance,(uint8_t *)&SEQ, 2);
-        while (!tx_complete_spi_master){} //Wait until SPI transfer is complete
-        tx_complete_spi_master = false;
-
-        //Send 512 Bytes block to IA61x
-        for (blockindex = 4; blockindex < WDB_SIZE; )
-        {
-            if (dataindex < size )
-            {
-                dataremain = size - dataindex; 
-                if (WDB_SIZE_NO_HEADER <= dataremain)
-                {
-                    spi_write_buffer_job(&spi_master_instance,(uint8_t *)&pData[dataindex], WDB_SIZE_NO_HEADER);
-                    while (!tx_complete_spi_master){} //Wait until SPI transfer is complete
-                    tx_complete_spi_master = false;
-
-                    dataindex = dataindex + WDB_SIZE_NO_HEADER;
-                }
-                else //Send last chunk with zero padding. 
-                {
-                    spi_write_buffer_job(&spi_master_instance,(uint8_t *)&pData[dataindex], dataremain);
-                    while (!tx_complete_spi_master){} //Wait until SPI transfer is complete
-                    tx_complete_spi_master = false;
-                    spi_write_buffer_job(&spi_master_instance,zeropadding,(WDB_SIZE_NO_HEADER - dataremain));
-                    while (!tx_complete_spi_master){} //Wait until SPI transfer is complete
-                    tx_complete_spi_master = false;
-                    
-                    dataindex = dataindex + dataremain;
-                }
-            }
-            else //last block data is written then exit from loop
-            {
-                break;
-            }
-            blockindex = blockindex + WDB_SIZE_NO_HEADER;
-        }
-
-        //Increment block counter and updated the Sequence header
-        BlockCount++;
-        if ( BlockCount == (spacket_g-1) )//for last block set Sequence number to 0xFF
-        {
-            BlockCount = 0xFF;
-        }
-        SEQ = SEQ | (BlockCount << 8);
-
-        port_pin_set_output_level(SPI_EXT_SS, 1 ); // Reset the SS line to high once 512 byte chunk is sent to IA61x
-
-    }
+    return (IA61x_spi_firmware_up(iRetvalue));
+}
 
-    delay_ms(5); //Wait for sometime for firmware to respond.
+#if IA61x_FW_ASYNC
+/*******************************************************************************************************
+ * @fn      IA61x_spi_download_start()
+ *
+ * @brief   Start the Firmware download and return while the image streams to IA61x, so the host can
+ *          do other work. Complete it with IA61x_spi_download_finish().
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Download could not be started
+ * @retval  CMD_SUCCESS Firmware is streaming
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_spi_download_start(void)
+{
+#if IA61x_FW_CONTAINER
+    IA61x_image_section section;
 
-    IA61x_spi_get(inbuf2, 4);
+    if (IA61x_section_lookup(IA61x_IMG_PROGRAM_SPI, &section) != CMD_SUCCESS)
+        return (CMD_FAILED);
 
-#if IA611_VOICE_ID
-    if((DownloadNumber == 1) && (Ref_model == 0))
-        Ref_model = 1;
-    else
+    return (IA61x_download_begin(section.data, section.size, section.raw_size,
+                                 (section.flags & IA61x_IMG_FLAG_LZ) != 0));
+#else
+    return (IA61x_download_begin(VQ_Bin_lz, sizeof(VQ_Bin_lz), VQ_Bin_LZ_RAW_SIZE, true));
 #endif
-    DownloadNumber++; /**Increment OEM keyword download sequence number for next keyword**/
+}
 
-    return (inbuf2[3]);
+/*******************************************************************************************************
+ * @fn      IA61x_spi_download_finish()
+ *
+ * @brief   Wait for the Firmware started by IA61x_spi_download_start() and bring it up
+ *
+ * @param   none
+ *
+ * @retval  pResponse   response to Sync command
+ * @retval  CMD_FAILED Command execution failed
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_spi_download_finish(void)
+{
+    return (IA61x_spi_firmware_up(IA61x_download_end()));
 }
+#endif /* IA61x_FW_ASYNC */
 
 
 /*******************************************************************************************************
@@ -627,11 +744,11 @@ static int32_t IA61x_spi_VoiceWake(void)
     uint16_t pResponse;
 
     //Send Sync command first to make sure that IA61x is awake. Ignore the response.
-    IA61x_spi_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
+    IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
     delay_ms(1);
 
     //
-    if(!IA61x_spi_cmd(STOP_ROUTE_CMD,EMPTY_DATA,5, &pResponse))
+    if(!IA61x_proto_cmd(STOP_ROUTE_CMD,EMPTY_DATA,5, &pResponse))
     {
         if(pResponse != (uint16_t)EMPTY_DATA)
             error++;
@@ -641,7 +758,7 @@ static int32_t IA61x_spi_VoiceWake(void)
     delay_ms(1);
     
     //Set Digital gain to 20db
-    if(!IA61x_spi_cmd(SET_DIGITAL_GAIN_CMD,DIGITAL_GAIN_20,1, &pResponse))
+    if(!IA61x_proto_cmd(SET_DIGITAL_GAIN_CMD,DIGITAL_GAIN_20,1, &pResponse))
     {
         if(pResponse != (uint16_t)DIGITAL_GAIN_20)
             error++;
@@ -651,7 +768,7 @@ static int32_t IA61x_spi_VoiceWake(void)
     delay_ms(1);
 
     //Set Sample Rate to 16K
-    if(!IA61x_spi_cmd(SAMPLE_RATE_CMD,SAMPLE_RATE_16K,1, &pResponse))
+    if(!IA61x_proto_cmd(SAMPLE_RATE_CMD,SAMPLE_RATE_16K,1, &pResponse))
     {
         if(pResponse != (uint16_t)SAMPLE_RATE_16K)
         error++;
@@ -661,7 +778,7 @@ static int32_t IA61x_spi_VoiceWake(void)
     delay_ms(1);
 
     //Set Frame Size to 16 mS
-    if(!IA61x_spi_cmd(FRAME_SIZE_CMD,FRAME_SIZE_16MS,1, &pResponse))
+    if(!IA61x_proto_cmd(FRAME_SIZE_CMD,FRAME_SIZE_16MS,1, &pResponse))
     {
         if(pResponse != (uint16_t)FRAME_SIZE_16MS)
         error++;
@@ -671,7 +788,7 @@ static int32_t IA61x_spi_VoiceWake(void)
     delay_ms(1);
 
     //Select Route 6
-    if(!IA61x_spi_cmd(SELECT_ROUTE_CMD,ROUTE_6,1, &pResponse))
+    if(!IA61x_proto_cmd(SELECT_ROUTE_CMD,ROUTE_6,1, &pResponse))
     {
         if(pResponse != (uint16_t)ROUTE_6)
         error++;
@@ -681,11 +798,11 @@ static int32_t IA61x_spi_VoiceWake(void)
     delay_ms(1);
 
     //Set Algorithm Parameter: Sensitivity to 5
-    if(!IA61x_spi_cmd(SET_ALGO_PARAM_ID,OEM_SENSITIVITY_PARAM,1, &pResponse))
+    if(!IA61x_proto_cmd(SET_ALGO_PARAM_ID,OEM_SENSITIVITY_PARAM,1, &pResponse))
     {
         if(pResponse == (uint16_t)OEM_SENSITIVITY_PARAM)
         {
-            if(!IA61x_spi_cmd(SET_ALGO_PARAM,OEM_SENSITIVITY_5,1, &pResponse))
+            if(!IA61x_proto_cmd(SET_ALGO_PARAM,OEM_SENSITIVITY_5,1, &pResponse))
             {
                 if(pResponse != (uint16_t)OEM_SENSITIVITY_5)
                     error++;
@@ -702,11 +819,11 @@ static int32_t IA61x_spi_VoiceWake(void)
 
 #if IA611_UTK
     //Set Algorithm Parameter: Sensitivity to 0 for UTK
-    if(!IA61x_spi_cmd(SET_ALGO_PARAM_ID,UTK_SENSITIVITY_PARAM,1, &pResponse))
+    if(!IA61x_proto_cmd(SET_ALGO_PARAM_ID,UTK_SENSITIVITY_PARAM,1, &pResponse))
     {
         if(pResponse == (uint16_t)UTK_SENSITIVITY_PARAM)
         {
-            if(!IA61x_spi_cmd(SET_ALGO_PARAM,UTK_SENSITIVITY_0,1, &pResponse))
+            if(!IA61x_proto_cmd(SET_ALGO_PARAM,UTK_SENSITIVITY_0,1, &pResponse))
             {
                 if(pResponse != (uint16_t)UTK_SENSITIVITY_0)
                     error++;
@@ -724,11 +841,11 @@ static int32_t IA61x_spi_VoiceWake(void)
 
 #if IA611_VOICE_ID
     //Set Algorithm Parameter: Sensitivity to 2 for VID
-    if(!IA61x_spi_cmd(SET_ALGO_PARAM_ID,VID_SENSITIVITY_PARAM,1, &pResponse))
+    if(!IA61x_proto_cmd(SET_ALGO_PARAM_ID,VID_SENSITIVITY_PARAM,1, &pResponse))
     {
         if(pResponse == (uint16_t)VID_SENSITIVITY_PARAM)
         {
-            if(!IA61x_spi_cmd(SET_ALGO_PARAM,VID_SENSITIVITY_2,1, &pResponse))
+            if(!IA61x_proto_cmd(SET_ALGO_PARAM,VID_SENSITIVITY_2,1, &pResponse))
             {
                 if(pResponse != (uint16_t)VID_SENSITIVITY_2)
                     error++;
@@ -745,11 +862,11 @@ static int32_t IA61x_spi_VoiceWake(void)
 #endif
 
     //Set Algorithm Parameter: VS Processing Mode to Keyword detection
-    if(!IA61x_spi_cmd(SET_ALGO_PARAM_ID,VS_PROCESSING_MODE_PARAM,1, &pResponse))
+    if(!IA61x_proto_cmd(SET_ALGO_PARAM_ID,VS_PROCESSING_MODE_PARAM,1, &pResponse))
     {
         if(pResponse == (uint16_t)VS_PROCESSING_MODE_PARAM)
         {
-            if(!IA61x_spi_cmd(SET_ALGO_PARAM,VS_PROCESSING_MODE_KW,1, &pResponse))
+            if(!IA61x_proto_cmd(SET_ALGO_PARAM,VS_PROCESSING_MODE_KW,1, &pResponse))
             {
                 if(pResponse != (uint16_t)VS_PROCESSING_MODE_KW)
                 error++;
@@ -774,10 +891,9 @@ static int32_t IA61x_spi_VoiceWake(void)
 	uint16_t pResponse;
 
 	//Send Sync command first to make sure that IA61x is awake. Ignore the response.
-	IA61x_spi_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
-	delay_ms(1);
+	IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
 #if 0
-	if(!IA61x_spi_cmd(STOP_ROUTE_CMD,EMPTY_DATA,5, &pResponse))
+	if(!IA61x_proto_cmd(STOP_ROUTE_CMD,EMPTY_DATA,5, &pResponse))
 	{
 		if(pResponse != (uint16_t)EMPTY_DATA)
 			error++;
@@ -791,7 +907,7 @@ static int32_t IA61x_spi_VoiceWake(void)
 #endif
 	uint16_t preset = PRESET_VALUE(2);
 	
-	if(!IA61x_spi_cmd(SET_PRESET_CMD,preset,5, &pResponse))
+	if(!IA61x_proto_cmd(SET_PRESET_CMD,preset,5, &pResponse))
 	{
 		if(pResponse != preset)
 			error++;
@@ -800,8 +916,6 @@ static int32_t IA61x_spi_VoiceWake(void)
 	{
 		error++;
 	}
-		
-	delay_ms(1);
 	
 	return error;
 }
@@ -814,72 +928,126 @@ static int32_t IA61x_spi_close(void)
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_spi_wait_keyword
+ * @fn      spi_spurious()
  *
- * @brief   Wait for Keyword, command or timeout to be detected
+ * @brief   HOST_IRQ came without an event. Reset the route and wait for the wake keyword.
  *
- * @param   delay   Delay value to wait for keyword detection
+ * @param   none
  *
- * @retval  response[3]         Keyword ID for the detected keyword or command word
- * @retval  NO_KWD_DETECTED     0 if no keyword is detected by IA61x
+ * @retval  none
  *
  *******************************************************************************************************/
-static int32_t IA61x_spi_wait_keyword(uint32_t delay)
+static void spi_spurious(void)
 {
-    uint16_t response = 0;
-
-    //Check if IA61x event detection interrupt is generated!! 
-    //This is the indication that there is either Key word, command or timeout event*/
-    while(!interrupt_flag)
-    {
-        delay_ms(delay); //wait for sometime before checking for interrupt again. Here host can go in sleep mode until the interrupt occurs
-    }
-
-    interrupt_flag = 0;
-
-    //Send Get Event Command to IA61x to check which event has happened!
-    if(!IA61x_spi_cmd(GET_EVENT_ID_CMD, EMPTY_DATA, 1, &response))
-    {
-        if(response)
-            return (0x00FF & response); // Mask off other 
-    }    
-    
-    //if no keyword is detected then it could be the invalid interrupt.
-    //In this case need to reset the route and put the IA61x into low power mode
     IA61x_spi_VoiceWake(); //Reset the route and wait for wake keyword
     /************************************************************************/
     /* Trill SDK will always operate in active mode.                                                                     */
     /************************************************************************/
-	//IA61x_spi_cmd(LOW_POWER_MODE_CMD,LOW_POWER_MODE_RT6,0, &response); //Put IA61x in Low power mode
-
-    return (NO_KWD_DETECTED);
+	//IA61x_proto_cmd(LOW_POWER_MODE_CMD,LOW_POWER_MODE_RT6,0, &response); //Put IA61x in Low power mode
 }
 
+/* Byte transport of the protocol core */
+static const IA61x_bus spi_bus =
+{
+    .get        = IA61x_spi_get,
+    .put        = IA61x_spi_put,
+#if IA61x_SPI_USE_DMA
+    .put_dma    = IA61x_spi_put_dma,
+#endif
+    .spurious   = spi_spurious,
+    .cmd_done   = spi_cmd_done,
+    .caps       = IA61x_BUS_BOOT_WORD | IA61x_BUS_RDB_SWAP32,
+};
 
+#if IA61x_WARM_ATTACH
 /*******************************************************************************************************
- * @fn      IA61x_samd21_vq_spi_init
+ * @fn      IA61x_spi_warm_attach()
  *
- * @brief   This function Power cycles IA61x and once the Host interface is auto detected
- *          by IA61x, it configures the SPI interface and initialize IA61x instance so 
- *          Host program can access IA61x APIs.
+ * @brief   After a host reset, reconnect to an IA61x that still runs the firmware of this build.
+ *          The IA61x is not power cycled. The link starts at the boot loader SCLK and is ramped
+ *          once the firmware is confirmed.
  *
- *              |                                                   |
- *          Host|->>----------------Power OFF/ON---------------->>->| IA61x
- *              |                   Delay 20 mSec                   |
- *              |->>----------Send Sync Byte - B7B7B7B7--------->>->|
- *              |-<<------------Ack Sync Byte -B7B7B7B7---------<<-<|
+ * @param   none
  *
- * @param   IA61x   IA61x interface instance pointer to be initialized
+ * @retval  CMD_FAILED  No matching firmware is running, cold boot required
+ * @retval  CMD_SUCCESS Running firmware is reused
  *
- * @retval  CMD_FAILED      If any command fails
- * @retval  SUCCESS         If IA61x boot process is successful
+ *******************************************************************************************************/
+static int32_t IA61x_spi_warm_attach(void)
+{
+    struct port_config pin_conf;
+    uint32_t sclk;
+    uint16_t response;
+
+    if (!IA61x_warm_check(IA61x_spi_image_id(), &sclk))
+        return (CMD_FAILED);
+
+    //Keep IA61x powered, LDO enable was not driven while the host was in reset
+    port_get_config_defaults(&pin_conf);
+    pin_conf.direction = PORT_PIN_DIR_OUTPUT;
+    port_pin_set_config(IA61x_LDO_ENABLE, &pin_conf);
+    port_pin_set_output_level(IA61x_LDO_ENABLE, 1 );
+
+    my_spi_init();
+
+    if ((IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, &response) != CMD_SUCCESS) || (response != SYNC_RESP_NORM))
+        return (CMD_FAILED);
+
+    if (IA61x_proto_reg_irq(SPI_EIC_CHANNEL, SPI_EIC_PIN, SPI_EIC_PIN_MUX) != SUCCESS)
+        return (CMD_FAILED);
+
+    if (!IA61x_warm_confirm(IA61x_proto_cmd))
+        return (CMD_FAILED);
+    IA61x_PROFILE_MARK(IA61x_PROF_WARM, 0);
+
+    IA61x_spi_ramp_sclk();
+
+    return (CMD_SUCCESS);
+}
+#endif /* IA61x_WARM_ATTACH */
+
+/*******************************************************************************************************
+ * @fn      spi_boot_sync()
+ *
+ * @brief   Readiness probe, send sync bytes to the boot loader and check the echo. The echo is clocked
+ *          in with the next transfer, so a later probe picks up the echo of an earlier one.
+ *
+ * @param   ctx     Receives the first byte read
+ *
+ * @retval  true    Boot loader echoed the sync byte
  *
  *******************************************************************************************************/
-int32_t IA61x_samd21_vq_spi_init(IA61x_instance *IA61x)
+static bool spi_boot_sync(void *ctx)
 {
     const uint8_t b7[] = {0xb7, 0xb7, 0xb7, 0xb7};
     uint8_t cRetVal[4];
 
+    IA61x_spi_put((uint8_t *)b7, 4);
+    while (IA61x_spi_get(cRetVal, 4) != STATUS_OK) ;
+
+    *(uint8_t *)ctx = cRetVal[0];
+    return (cRetVal[0] == 0xb7);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_spi_cold_boot()
+ *
+ * @brief   Power cycle IA61x and synchronize with the boot loader
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Boot loader did not respond
+ * @retval  CMD_SUCCESS Boot loader is ready for the downloads
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_spi_cold_boot(void)
+{
+    uint8_t cRetVal = 0;
+
+#if IA61x_WARM_ATTACH
+    IA61x_warm_invalidate(); //IA61x loses its firmware
+#endif
+    IA61x_param_invalidate(); //and its parameters
     IA61x_samd21_vq_spi_uninit();
 
     /*Power cycle IA61x so Boot loader goes into Auto-detect state to detect the host controller interface*/
@@ -890,35 +1058,138 @@ int32_t IA61x_samd21_vq_spi_init(IA61x_instance *IA61x)
     delay_ms(1);
 
     port_pin_set_output_level(IA61x_LDO_ENABLE, 1 );  /* Bring LDO Enable High */
-    delay_ms(20);
+    IA61x_PROFILE_MARK(IA61x_PROF_LDO_ON, 0);
 
-    /*Send Sync Byte to IA61x*/
-    delay_ms(1);
-    IA61x_spi_put((uint8_t *)b7, 4);
-
-    delay_ms(1);
-    while (IA61x_spi_get(cRetVal, 4) != STATUS_OK) ;
+    /*Send Sync Bytes to IA61x until the boot loader echoes them*/
+    if (IA61x_ready_wait(spi_boot_sync, &cRetVal, IA61x_READY_SYNC_POLL_US, IA61x_READY_LDO_US) != CMD_SUCCESS)
+        return (CMD_FAILED);
+    IA61x_PROFILE_MARK(IA61x_PROF_LDO_SETTLED, 0);
+    IA61x_PROFILE_MARK(IA61x_PROF_SYNC, cRetVal);
 
-    if (*cRetVal != 0xb7)
+    /*Boot loader is settled once it echoes again*/
+    if (IA61x_ready_wait(spi_boot_sync, &cRetVal, IA61x_READY_SYNC_POLL_US, IA61x_READY_BOOT_US) != CMD_SUCCESS)
         return (CMD_FAILED);
 
-    delay_ms(10);
+    return (CMD_SUCCESS);
+}
 
-    /*Initialize IA61x API Handle*/
+/*******************************************************************************************************
+ * @fn      IA61x_spi_instance
+ *
+ * @brief   Initialize the IA61x API handle with the SPI operations
+ *
+ * @param   IA61x   IA61x interface instance pointer to be initialized
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void IA61x_spi_instance(IA61x_instance *IA61x)
+{
     IA61x->download_config  = IA61x_spi_download_config;
     IA61x->download_program = IA61x_spi_download_firmware;
-    IA61x->download_keyword = IA61x_spi_download_keyword;
+#if IA61x_FW_ASYNC
+    IA61x->download_start   = IA61x_spi_download_start;
+    IA61x->download_finish  = IA61x_spi_download_finish;
+#endif
+    IA61x->download_keyword = IA61x_proto_download_keyword;
     IA61x->VoiceWake        = IA61x_spi_VoiceWake;
     IA61x->close            = IA61x_spi_close;
-    IA61x->wait_keyword     = IA61x_spi_wait_keyword;
-    IA61x->cmd              = IA61x_spi_cmd;
+    IA61x->wait_keyword     = IA61x_proto_wait_keyword;
+    IA61x->cmd              = IA61x_proto_cmd;
     IA61x->get              = IA61x_spi_get;
     IA61x->put              = IA61x_spi_put;
-	IA61x->rdb				= IA61x_spi_rdb;
+    IA61x->rdb              = IA61x_proto_rdb;
+#if IA61x_WARM_ATTACH
+    IA61x->image_id         = IA61x_spi_image_id;
+#endif
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_spi_init
+ *
+ * @brief   This function Power cycles IA61x and once the Host interface is auto detected
+ *          by IA61x, it configures the SPI interface and initialize IA61x instance so 
+ *          Host program can access IA61x APIs.
+ *          With IA61x_WARM_ATTACH, an IA61x still running the firmware of this build after a host
+ *          reset is reused instead (see IA61x_spi_warm_attach).
+ *
+ *              |                                                   |
+ *          Host|->>----------------Power OFF/ON---------------->>->| IA61x
+ *              |      Sync repeated until echoed, max 20 mSec      |
+ *              |->>----------Send Sync Byte - B7B7B7B7--------->>->|
+ *              |-<<------------Ack Sync Byte -B7B7B7B7---------<<-<|
+ *
+ * @param   IA61x   IA61x interface instance pointer to be initialized
+ *
+ * @retval  CMD_FAILED      If any command fails
+ * @retval  SUCCESS         If IA61x boot process is successful
+ *
+ *******************************************************************************************************/
+int32_t IA61x_samd21_vq_spi_init(IA61x_instance *IA61x)
+{
+    IA61x_cmdq_init(&spi_cmdq);
+    IA61x_proto_bind(&spi_bus);
+
+#if IA61x_WARM_ATTACH
+    if (IA61x_spi_warm_attach() != CMD_SUCCESS)
+#endif
+    {
+        if (IA61x_spi_cold_boot() != CMD_SUCCESS)
+        {
+            //Leave the pins to the next interface probed
+            my_spi_uninit();
+            IA61x_samd21_vq_spi_uninit();
+            return (CMD_FAILED);
+        }
+    }
+
+    IA61x_spi_instance(IA61x);
 
     return (SUCCESS);
 }
 
+#if IA61x_WARM_ATTACH
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_spi_attach
+ *
+ * @brief   Reconnect to an IA61x still running the SPI firmware of this build, without a power cycle
+ *          (see IA61x_spi_warm_attach)
+ *
+ * @param   IA61x   IA61x interface instance pointer to be initialized
+ *
+ * @retval  CMD_FAILED      No matching firmware is running on SPI
+ * @retval  SUCCESS         Running firmware is reused
+ *
+ *******************************************************************************************************/
+int32_t IA61x_samd21_vq_spi_attach(IA61x_instance *IA61x)
+{
+    IA61x_cmdq_init(&spi_cmdq);
+    IA61x_proto_bind(&spi_bus);
+
+    if (IA61x_spi_warm_attach() != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    IA61x_spi_instance(IA61x);
+
+    return (SUCCESS);
+}
+#endif /* IA61x_WARM_ATTACH */
+
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_spi_sclk
+ *
+ * @brief   Current SPI clock
+ *
+ * @param   none
+ *
+ * @retval  SCLK in Hz
+ *
+ *******************************************************************************************************/
+uint32_t IA61x_samd21_vq_spi_sclk(void)
+{
+    return (spi_sclk);
+}
+
 /*******************************************************************************************************
  * @fn      IA61x_samd21_vq_spi_uninit
  *
@@ -942,4 +1213,4 @@ int32_t IA61x_samd21_vq_spi_uninit(void)
     return (SUCCESS);
 }
 
-#endif /* ifdef IA61x_SAMD21_VQ_UART */
\ No newline at end of file
+#endif /* ifdef IA61x_SAMD21_VQ_SPI */
\ No newline at end of file
@@ -37,6 +37,10 @@
 #include "IA61x.h"
 extern int32_t IA61x_samd21_vq_spi_init(IA61x_instance *IA61x);
 extern int32_t IA61x_samd21_vq_spi_uninit(void);
+#if IA61x_WARM_ATTACH
+extern int32_t IA61x_samd21_vq_spi_attach(IA61x_instance *IA61x);
+#endif
+extern uint32_t IA61x_samd21_vq_spi_sclk(void);
 
 #define SPI_EXT_INT_PIN     PIN_PB12
 #define SPI_EIC_PIN         PIN_PB12A_EIC_EXTINT12
@@ -48,6 +52,10 @@ extern int32_t IA61x_samd21_vq_spi_uninit(void);
 /* Number of times to try to send packet if failed. */
 #define VQ_SPI_TIMEOUT 1000
 
+/* SCLK self-test: Sync round-trips and build string characters compared per ramp step */
+#define IA61x_SPI_SELFTEST_SYNCS    4
+#define IA61x_SPI_SELFTEST_CHARS    8
+
 //[definition_master]
 #define CONF_MASTER_SPI_MODULE  EXT2_SPI_MODULE                 //SERCOM0
 #define CONF_MASTER_MUX_SETTING EXT2_SPI_SERCOM_MUX_SETTING     //DIPO= 0, DOPO=0x1
@@ -55,6 +63,8 @@ extern int32_t IA61x_samd21_vq_spi_uninit(void);
 #define CONF_MASTER_PINMUX_PAD1 EXT2_SPI_SERCOM_PINMUX_PAD1     //SS
 #define CONF_MASTER_PINMUX_PAD2 EXT2_SPI_SERCOM_PINMUX_PAD2     //MOSI
 #define CONF_MASTER_PINMUX_PAD3 EXT2_SPI_SERCOM_PINMUX_PAD3     //SCK
+#define CONF_MASTER_DMAC_ID_TX  EXT2_SPI_SERCOM_DMAC_ID_TX      //DMAC trigger on SERCOM1 DRE
+#define CONF_MASTER_GCLK_GENERATOR GCLK_GENERATOR_1             //DFLL/2 = 24.576 MHz, SCLK up to 12.288 MHz
 //[definition_master]
 
 
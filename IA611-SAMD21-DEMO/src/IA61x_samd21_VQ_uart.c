@@ -36,18 +36,221 @@
 # include <asf.h>
 # include <string.h>
 # include "IA61x_samd21_VQ_uart.h"
-
-# include "trill_sys_config.h"       /*Trillbit SDK Sys config*/
-
-# include "IA611_FW_Bin_UART.h"      /* Firmware Binary */
+# include "IA61x_profile.h"
+# include "IA61x_ready.h"
+# include "IA61x_samd21_timer.h"
+# include "IA61x_cmdq.h"
+# include "IA61x_proto.h"
+# include "IA61x_param.h"
+
+# if IA61x_FW_COMPRESSED
+#  include "IA61x_stream.h"
+#  include "IA61x_samd21_dma.h"
+# endif
+
+# if IA61x_FW_ASYNC && !IA61x_FW_COMPRESSED
+#  error "IA61x_FW_ASYNC streams through the DMA download path of IA61x_FW_COMPRESSED"
+# endif
+
+# if IA61x_WARM_ATTACH
+#  include "IA61x_warm.h"
+# endif
+
+# if IA61x_FW_CONTAINER
+#  include "IA61x_image.h"            /* Firmware and Sys config from the image container */
+# elif IA61x_FW_COMPRESSED
+#  include "trill_sys_config_lz.h"    /*Trillbit SDK Sys config, LZ compressed*/
+#  include "IA611_FW_Bin_UART_lz.h"   /* Firmware Binary, LZ compressed */
+# else
+#  include "trill_sys_config.h"       /*Trillbit SDK Sys config*/
+#  include "IA611_FW_Bin_UART.h"      /* Firmware Binary */
+# endif
 /*********************************************************************************/
 // private
 /*********************************************************************************/
 static struct usart_module usart_instance;
-volatile uint8_t interrupt_flag = 0;
 
-static uint32_t IA61x_samd21_vq_uart_reg_IRQ(void);
+/* Response bytes of the running command, collected by uart_cmdq_probe() */
+static uint8_t uart_rsp[4];
+static uint8_t uart_rsp_len = 0;
+
+/* One step of the baud negotiation ladder. GCLK0 is 8 MHz so the oversampling is lowered
+ * as the rate goes up: 16x up to 500 kBaud, 8x up to 1 MBaud and 3x above. */
+typedef struct
+{
+    uint32_t                baud;
+    uint16_t                rate_code;
+    enum usart_sample_rate  sample_rate;
+} uart_rate_step;
+
+static const uart_rate_step uart_rate_ladder[] =
+{
+    {  460800, IA61x_UART_RATE_460800,  USART_SAMPLE_RATE_16X_ARITHMETIC },
+    {  921600, IA61x_UART_RATE_921600,  USART_SAMPLE_RATE_8X_ARITHMETIC  },
+    { 1000000, IA61x_UART_RATE_1000000, USART_SAMPLE_RATE_8X_ARITHMETIC  },
+    { 1024000, IA61x_UART_RATE_1024000, USART_SAMPLE_RATE_3X_ARITHMETIC  },
+    { 1152000, IA61x_UART_RATE_1152000, USART_SAMPLE_RATE_3X_ARITHMETIC  },
+    { 2000000, IA61x_UART_RATE_2000000, USART_SAMPLE_RATE_3X_ARITHMETIC  },
+    { 2048000, IA61x_UART_RATE_2048000, USART_SAMPLE_RATE_3X_ARITHMETIC  },
+};
+
+static const uart_rate_step uart_boot_rate = { IA61x_UART_BOOT_BAUD, 0, USART_SAMPLE_RATE_16X_ARITHMETIC };
+
+/* Rate currently used on the link */
+static const uart_rate_step *uart_rate = &uart_boot_rate;
+
 static void recycle_uart(void);
+static enum status_code IA61x_uart_read_us(uint8_t *pData, uint32_t size, uint32_t timeout_us);
+
+#if IA61x_UART_RX_RING
+#define UART_RX_MASK    (IA61x_UART_RX_ENTRIES - 1)
+
+#if ((IA61x_UART_RX_ENTRIES & UART_RX_MASK) != 0) || (IA61x_UART_RX_ENTRIES > 128)
+#error "IA61x_UART_RX_ENTRIES must be a power of two up to 128"
+#endif
+
+/* Receive ring, filled by uart_rx_isr() and emptied by uart_rx_byte(). The free running
+ * 8 bit indices wrap on their own, head - tail is the fill level. */
+static uint8_t uart_rx_data[IA61x_UART_RX_ENTRIES];
+static volatile uint8_t uart_rx_head = 0;
+static volatile uint8_t uart_rx_tail = 0;
+static volatile uint32_t uart_rx_overruns = 0;  //Bytes lost, ring full or SERCOM buffer overflow
+
+/***************************************************************************
+ * @fn      uart_rx_isr()
+ *
+ * @brief   SERCOM interrupt, move received bytes into the ring. A byte that
+ *          does not fit is dropped and counted.
+ *
+ * @param   instance    SERCOM instance, unused
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void uart_rx_isr(uint8_t instance)
+{
+    SercomUsart *const hw = &usart_instance.hw->USART;
+    uint8_t head = uart_rx_head;
+
+    (void)instance;
+    while (hw->INTFLAG.reg & SERCOM_USART_INTFLAG_RXC)
+    {
+        if (hw->STATUS.reg & SERCOM_USART_STATUS_BUFOVF)
+        {
+            hw->STATUS.reg = SERCOM_USART_STATUS_BUFOVF;
+            uart_rx_overruns++;
+        }
+
+        //Reading DATA clears RXC
+        uint8_t data = (uint8_t)hw->DATA.reg;
+
+        if ((uint8_t)(head - uart_rx_tail) >= IA61x_UART_RX_ENTRIES)
+        {
+            uart_rx_overruns++;
+            continue;
+        }
+        uart_rx_data[head & UART_RX_MASK] = data;
+        head++;
+    }
+
+    //The bytes are stored before the consumer can see them
+    __DMB();
+    uart_rx_head = head;
+}
+
+/***************************************************************************
+ * @fn      uart_rx_start()
+ *
+ * @brief   Route the SERCOM receive interrupt to the ring, after usart_enable()
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void uart_rx_start(void)
+{
+    Sercom *const hw = usart_instance.hw;
+
+    uart_rx_tail = uart_rx_head;
+    _sercom_set_handler(_sercom_get_sercom_inst_index(hw), uart_rx_isr);
+    hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_RXC;
+    system_interrupt_enable(_sercom_get_interrupt_vector(hw));
+}
+
+/***************************************************************************
+ * @fn      uart_rx_stop()
+ *
+ * @brief   Stop filling the ring, before the SERCOM is disabled
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void uart_rx_stop(void)
+{
+    usart_instance.hw->USART.INTENCLR.reg = SERCOM_USART_INTFLAG_RXC;
+    uart_rx_tail = uart_rx_head;
+}
+#endif /* IA61x_UART_RX_RING */
+
+/***************************************************************************
+ * @fn      uart_rx_byte()
+ *
+ * @brief   Take one received byte without waiting
+ *
+ * @param   pData   Receives the byte
+ *
+ * @retval  true    A byte was taken
+ * @retval  false   Nothing received
+ *
+ ****************************************************************************/
+static bool uart_rx_byte(uint8_t *pData)
+{
+#if IA61x_UART_RX_RING
+    uint8_t tail = uart_rx_tail;
+
+    if (tail == uart_rx_head)
+        return (false);
+
+    //Read the byte only after seeing the head that published it
+    __DMB();
+    *pData = uart_rx_data[tail & UART_RX_MASK];
+    uart_rx_tail = tail + 1;
+    return (true);
+#else
+    uint16_t rx;
+
+    if (usart_read_wait(&usart_instance, &rx) != STATUS_OK)
+        return (false);
+
+    *pData = (uint8_t)rx;
+    return (true);
+#endif
+}
+
+/***************************************************************************
+ * @fn      uart_rx_discard()
+ *
+ * @brief   Drop everything received so far, without waiting for the line
+ *          to go quiet
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void uart_rx_discard(void)
+{
+#if IA61x_UART_RX_RING
+    uart_rx_tail = uart_rx_head;
+#else
+    uint8_t dummy;
+
+    while (uart_rx_byte(&dummy)) ;
+#endif
+}
 
 
 
@@ -59,13 +262,75 @@ static void recycle_uart(void);
  * @param   pData    Buffer to receive data
  * @param   size    Size of data to be received
  *
- * @retval  none
+ * @retval  STATUS_OK           All data received
+ * @retval  STATUS_ERR_TIMEOUT  No byte for IA61x_UART_GET_GAP_US
  *
  ****************************************************************************/
 static int32_t IA61x_uart_get(uint8_t *pData, uint32_t size)
 {
-    return usart_read_buffer_wait(&usart_instance, pData, size);
-    //return (0);
+    enum status_code status = STATUS_OK;
+
+    //The deadline restarts with each byte, so long blocks are not cut at low rates
+    while (size-- && (status == STATUS_OK))
+        status = IA61x_uart_read_us(pData++, 1, IA61x_UART_GET_GAP_US);
+
+    return (status);
+}
+
+/***************************************************************************
+ * @fn      IA61x_uart_read_us()
+ *
+ * @brief   Read data from UART port with a deadline in microseconds. The
+ *          blocking ASF read times out after a fixed loop count, which is
+ *          too coarse for readiness polling.
+ *
+ * @param   pData       Buffer to receive data
+ * @param   size        Size of data to be received
+ * @param   timeout_us  Time allowed for the whole buffer
+ *
+ * @retval  STATUS_OK           All data received
+ * @retval  STATUS_ERR_TIMEOUT  Deadline expired
+ *
+ ****************************************************************************/
+static enum status_code IA61x_uart_read_us(uint8_t *pData, uint32_t size, uint32_t timeout_us)
+{
+    uint32_t start;
+
+    IA61x_timer_init();
+    start = IA61x_timer_us();
+
+    while (size)
+    {
+        if (uart_rx_byte(pData))
+        {
+            pData++;
+            size--;
+        }
+        else if (IA61x_timer_elapsed_us(start) >= timeout_us)
+        {
+            return (STATUS_ERR_TIMEOUT);
+        }
+    }
+
+    return (STATUS_OK);
+}
+
+/***************************************************************************
+ * @fn      IA61x_uart_flush()
+ *
+ * @brief   Drop received data until the line is quiet for timeout_us
+ *
+ * @param   timeout_us  Quiet time
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void IA61x_uart_flush(uint32_t timeout_us)
+{
+    uint8_t dummy;
+
+    uart_rx_discard();
+    while (IA61x_uart_read_us(&dummy, 1, timeout_us) == STATUS_OK) ;
 }
 
 /***************************************************************************
@@ -86,129 +351,148 @@ static int32_t IA61x_uart_put(uint8_t *pData, uint32_t size)
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_uart_cmd()
+ * @fn      uart_cmdq_send()
  *
- * @brief   Send Command word and Data word to IA61x and receive response. If no response is expected 
- *          from IA61x then timeout should be 0.
+ * @brief   Command queue transport, write the command and data word
  *
  * @param   cmdWord     Command word to send to IA61x
  * @param   dataWord    Data word to send to IA61x
- * @param   timeout     Response read retry count. Set to 0 if no response expected
- * @param   pResponse   Response word from IA61x
  *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
+ * @retval  CMD_FAILED  Command could not be sent
+ * @retval  CMD_SUCCESS Command sent
  *
  *******************************************************************************************************/
-static int32_t IA61x_uart_cmd(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse)
+static int32_t uart_cmdq_send(uint16_t cmdWord, uint16_t dataWord)
 {
-    uint32_t data = 0;
-    union _tmp {
-        uint16_t word[2];
-        uint8_t byte[4];
-    } tmp;
-
-    tmp.word[0] = cmdWord;
-    tmp.word[1] = dataWord;
-
-    //Command Word first and then Data word
-    data = tmp.byte[1] | tmp.byte[0]<<8 | tmp.byte[3]<<16 | tmp.byte[2] << 24;
-    usart_write_buffer_wait(&usart_instance, (uint8_t *)&data, 4);
-	
-	if ((cmdWord & CMD_NO_RESP_MASK) == CMD_NO_RESP_MASK)
-	{
-		*pResponse = dataWord;
-		return CMD_SUCCESS;
-	}
-
-    //if timeout is 0 then no need to read the response else try reading the data multiple times
-    while(timeout--)
-    {
-        //Read response 
-        usart_read_buffer_wait(&usart_instance, tmp.byte, 4);
+    uint8_t frame[4];
 
-        *pResponse = (tmp.byte[0] << 8) | tmp.byte[1] ;
-        //return the second response word if the first response word matches command word
-        if(*pResponse == cmdWord)
-        {
-            *pResponse = (tmp.byte[2] << 8) | tmp.byte[3];
-        }
-        else
-        {
-            return (CMD_FAILED);
-        }
-    }
+    IA61x_cmdq_frame(frame, cmdWord, dataWord);
+    uart_rsp_len = 0;
 
-    return (CMD_SUCCESS);
+    return ((usart_write_buffer_wait(&usart_instance, frame, 4) == STATUS_OK) ? CMD_SUCCESS : CMD_FAILED);
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_download_bin()
+ * @fn      uart_cmdq_probe()
  *
- * @brief   Function to download sys config or Firmware binary to IA61x
+ * @brief   Command queue transport, collect the response bytes received so far without waiting
  *
- * @param   pData       Data buffer to send to IA61x
- * @param   size        Size of data buffer
+ * @param   cmdWord     Command word that was sent
+ * @param   pResponse   Response word from IA61x
  *
- * @retval  CMD_FAILED  Command Failed Error
- * @retval  CMD_SUCCESS Command execution successful
- * @retval  i           UART Status code from IA61x. 0x02 indicates successful Firmware download.
+ * @retval  CMD_SUCCESS Response word is valid
+ * @retval  CMD_TIMEOUT Response not complete yet
+ * @retval  CMD_FAILED  Response does not echo the command word
  *
  *******************************************************************************************************/
- static int32_t IA61x_download_bin(uint8_t *pData, uint32_t size)
+static int32_t uart_cmdq_probe(uint16_t cmdWord, uint16_t *pResponse)
 {
-    const uint8_t Load01[] = { 0x1 };
-    uint8_t cRetVal;
-    uint32_t iCount = 0;
+    while ((uart_rsp_len < 4) && uart_rx_byte(&uart_rsp[uart_rsp_len]))
+        uart_rsp_len++;
 
-    usart_write_buffer_wait(&usart_instance, Load01, 1);
-    if (usart_read_buffer_wait(&usart_instance, &cRetVal, 1) != STATUS_OK) return (-1);
-    if (cRetVal != 1) return (CMD_FAILED);
+    if (uart_rsp_len < 4)
+        return (CMD_TIMEOUT);
 
-    iCount = 0;
-    while (iCount < size) 
-    {
-        usart_write_buffer_wait(&usart_instance, &pData[iCount], (size - iCount >= 0xFFFF) ? 0xFFFF : size - iCount);
-        iCount += 0xFFFF;
-    }
+    //return the second response word if the first response word matches command word
+    return (IA61x_ready_response(uart_rsp, cmdWord, pResponse) ? CMD_SUCCESS : CMD_FAILED);
+}
 
-    delay_us(100);
+static const IA61x_cmdq_transport uart_cmdq = { uart_cmdq_send, uart_cmdq_probe };
 
-    if (usart_read_buffer_wait(&usart_instance, &cRetVal, 1) == STATUS_OK) 
-    {
-        iCount = cRetVal;
-        return (iCount);
-    }
+#if IA61x_FW_COMPRESSED
+/*******************************************************************************************************
+ * @fn      IA61x_uart_put_dma
+ *
+ * @brief   Start a DMA driven UART write (IA61x_stream_put_t)
+ *
+ * @param   pData       Send data Buffer
+ * @param   size        Size of data to be sent
+ * @param   callback    Completion or error callback, interrupt context
+ *
+ * @retval  STATUS_OK   Transfer started
+ * @retval  other       DMAC could not start the transfer
+ *
+ *******************************************************************************************************/
+static enum status_code IA61x_uart_put_dma(const uint8_t *pData, uint32_t size, IA61x_dma_callback_t callback)
+{
+    return (IA61x_dma_write(IA61x_DMA_CH_UART_TX, EXT3_UART_SERCOM_DMAC_ID_TX, &usart_instance.hw->USART.DATA.reg,
+                            pData, size, callback));
+}
 
-    return (CMD_SUCCESS);
+#endif /* IA61x_FW_COMPRESSED */
+
+/*******************************************************************************************************
+ * @fn      uart_flush_stale()
+ *
+ * @brief   Drop bytes IA61x sent before the event query, e.g. late answers
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void uart_flush_stale(void)
+{
+#if IA61x_UART_RX_RING
+    uart_rx_discard(); //The ring holds every byte received so far, the last answer is complete
+#else
+    IA61x_uart_flush(IA61x_READY_ECHO_US);
+#endif
 }
 
+/* Byte transport of the protocol core */
+static const IA61x_bus uart_bus =
+{
+    .get        = IA61x_uart_get,
+    .put        = IA61x_uart_put,
+#if IA61x_FW_COMPRESSED
+    .put_dma    = IA61x_uart_put_dma,
+#endif
+    .flush      = uart_flush_stale,
+    .caps       = IA61x_BUS_STREAM,
+};
+
 /*******************************************************************************************************
  * @fn      my_usart_init()
  *
  * @brief   Initialize SAMD21 USART port for IA61x interface
  *
- * @param   baud        UART Baudrate vlaue
+ * @param   rate        UART Baudrate and oversampling
  *
- * @retval  none
+ * @retval  STATUS_OK                           USART is running at the requested rate
+ * @retval  STATUS_ERR_BAUDRATE_UNAVAILABLE     Rate can not be generated from the SERCOM clock
  *
  *******************************************************************************************************/
-static void my_usart_init(uint32_t baud)
+static enum status_code my_usart_init(const uart_rate_step *rate)
 {
     struct usart_config config_usart;
+    enum status_code status;
 
     usart_get_config_defaults(&config_usart);
 
-    config_usart.baudrate       = baud;
+    config_usart.baudrate       = rate->baud;
+    config_usart.sample_rate    = rate->sample_rate;
     config_usart.mux_setting    = EXT3_UART_SERCOM_MUX_SETTING; /* EXT3_UART_MODULE */
     config_usart.pinmux_pad0    = EXT3_UART_SERCOM_PINMUX_PAD0;
     config_usart.pinmux_pad1    = EXT3_UART_SERCOM_PINMUX_PAD1;
     config_usart.pinmux_pad2    = EXT3_UART_SERCOM_PINMUX_PAD2;
     config_usart.pinmux_pad3    = EXT3_UART_SERCOM_PINMUX_PAD3;
 
-    while (usart_init(&usart_instance, EXT3_UART_MODULE, &config_usart) != STATUS_OK) ;
+    do
+    {
+        status = usart_init(&usart_instance, EXT3_UART_MODULE, &config_usart);
+    } while ((status != STATUS_OK) && (status != STATUS_ERR_BAUDRATE_UNAVAILABLE));
+
+    if (status != STATUS_OK)
+        return (status);
 
     usart_enable(&usart_instance);
+#if IA61x_UART_RX_RING
+    uart_rx_start();
+#endif
+    uart_rate = rate;
+
+    return (STATUS_OK);
 }
 
 
@@ -224,9 +508,41 @@ static void my_usart_init(uint32_t baud)
  *******************************************************************************************************/
 static void my_usart_uninit(void)
 {
+#if IA61x_UART_RX_RING
+    uart_rx_stop();
+#endif
     usart_disable(&usart_instance);
 }
 
+#if IA61x_WARM_ATTACH
+/*******************************************************************************************************
+ * @fn      IA61x_uart_image_id()
+ *
+ * @brief   Identity of the embedded program image for warm attach and the version cache. The
+ *          container already holds a CRC32 of each section. Otherwise the first 64 bytes are hashed,
+ *          they hold the image header with its build time stamp and version string.
+ *
+ * @param   none
+ *
+ * @retval  Image identity
+ *
+ *******************************************************************************************************/
+static uint32_t IA61x_uart_image_id(void)
+{
+#if IA61x_FW_CONTAINER
+    IA61x_image_section section;
+
+    if (IA61x_image_find(IA61x_IMG_PROGRAM_UART, &section) != STATUS_OK)
+        return (0);
+    return (section.crc);
+#elif IA61x_FW_COMPRESSED
+    return (IA61x_warm_hash(VQ_Bin_lz, 64, IA61x_WARM_HASH_INIT) ^ sizeof(VQ_Bin_lz));
+#else
+    return (IA61x_warm_hash((const uint8_t *)VQ_Bin, 64, IA61x_WARM_HASH_INIT) ^ sizeof(VQ_Bin));
+#endif
+}
+#endif /* IA61x_WARM_ATTACH */
+
 /*******************************************************************************************************
  * @fn      IA61x_uart_download_config()
  *
@@ -242,7 +558,13 @@ static int32_t IA61x_uart_download_config(void)
 {
     uint32_t iRetVal;
 
-    iRetVal = IA61x_download_bin((uint8_t *)SCFG, sizeof(SCFG));
+#if IA61x_FW_CONTAINER
+    iRetVal = IA61x_download_section(IA61x_IMG_SYSCONFIG);
+#elif IA61x_FW_COMPRESSED
+    iRetVal = IA61x_download_lz(SCFG_lz, sizeof(SCFG_lz), SCFG_LZ_RAW_SIZE);
+#else
+    iRetVal = IA61x_download_bin((const uint8_t *)SCFG, sizeof(SCFG));
+#endif
     if (iRetVal != 0)
         return (CMD_FAILED);
 
@@ -251,36 +573,61 @@ static int32_t IA61x_uart_download_config(void)
 
 
 /*******************************************************************************************************
- * @fn      IA61x_uart_download_firmware()
+ * @fn      uart_fw_ready()
  *
- * @brief   Download IA61x Firmware binary to IA61x
+ * @brief   Readiness probe, the downloaded firmware answers the SYNC command. Unanswered probes may
+ *          leave bytes behind, so the receiver is drained first.
  *
- * @param   none
+ * @param   ctx     Receives the SYNC response word
+ *
+ * @retval  true    Firmware is running
+ *
+ *******************************************************************************************************/
+static bool uart_fw_ready(void *ctx)
+{
+    const uint8_t sync[] = { (uint8_t)(SYNC_CMD >> 8), (uint8_t)SYNC_CMD, 0x00, 0x00 };
+    uint8_t data[4];
+
+    IA61x_uart_flush(0);
+    usart_write_buffer_wait(&usart_instance, sync, 4);
+
+    if (IA61x_uart_read_us(data, 4, IA61x_READY_ECHO_US) != STATUS_OK)
+        return (false);
+
+    return (IA61x_ready_response(data, SYNC_CMD, (uint16_t *)ctx));
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_uart_firmware_up()
+ *
+ * @brief   Wait for a downloaded Firmware to come up and register the event interrupt
+ *
+ * @param   iRetvalue   Status of the Firmware download
  *
  * @retval  pResponse   response to Sync command
  * @retval  CMD_FAILED Command execution failed
  *
  *******************************************************************************************************/
-static int32_t IA61x_uart_download_firmware(void)
+static int32_t IA61x_uart_firmware_up(int32_t iRetvalue)
 {
-    uint32_t iRetvalue;
     uint16_t pResponse;
 
-    iRetvalue = IA61x_download_bin((uint8_t *)VQ_Bin, sizeof(VQ_Bin));
-    delay_ms(35); //wait for firmware to initialize. minimum 30 mS delay
-
-    //if FW download is success then ping firmware and confirm that FW is up and running
+    //if FW download is success then ping firmware until it is up and running, at most IA61x_READY_FW_US
     if (iRetvalue == FW_DOWNLOAD_SUCCESS) 
     {
-        if(IA61x_uart_cmd(SYNC_CMD,EMPTY_DATA,1, &pResponse))
+        if (IA61x_ready_wait(uart_fw_ready, &pResponse, IA61x_READY_FW_POLL_US, IA61x_READY_FW_US))
         {
-            return(pResponse);
+            return(CMD_FAILED);
         }
+        IA61x_uart_flush(IA61x_READY_ECHO_US); //Late answers to earlier probes
+        IA61x_PROFILE_MARK(IA61x_PROF_FW_READY, 0);
 		
-		
-		iRetvalue = IA61x_samd21_vq_uart_reg_IRQ();
+		iRetvalue = IA61x_proto_reg_irq(IA61x_EIC_CHANNEL, IA61x_EIC_PIN, IA61x_EIC_PIN_MUX);
 		if (!iRetvalue)
 		{
+#if IA61x_WARM_ATTACH
+			IA61x_warm_commit(IA61x_proto_cmd, IA61x_uart_image_id(), uart_rate->baud);
+#endif
 			return(iRetvalue);	
 		}
 		
@@ -288,146 +635,78 @@ static int32_t IA61x_uart_download_firmware(void)
     return (CMD_FAILED);
 }
 
-
 /*******************************************************************************************************
- * @fn      IA61x_uart_download_keyword()
+ * @fn      IA61x_uart_download_firmware()
  *
- * @brief   Download Keyword models to IA61x.
+ * @brief   Download IA61x Firmware binary to IA61x
  *
- * @param   data    Data buffer to send to IA61x
- * @param   size    Data buffer length
+ * @param   none
  *
- * @retval  SUCCESS
+ * @retval  pResponse   response to Sync command
+ * @retval  CMD_FAILED Command execution failed
  *
  *******************************************************************************************************/
-uint8_t DownloadNumber  = 0;
-#if IA611_VOICE_ID
-    uint8_t Ref_model = 0;
-#endif
-
-static int32_t IA61x_uart_download_keyword(uint16_t *data, uint16_t size)
+static int32_t IA61x_uart_download_firmware(void)
 {
-    uint16_t Response = 0;
-    uint8_t inbuf2[4];
-	
-	//uint8_t zeropad[WDB_SIZE_NO_HEADER];
-	int ret;
-	
-	//memset(zeropad, 0, WDB_SIZE_NO_HEADER);
-
-    //Send Write Data Block command.
-	//Do not check WDB response validity here.
-    IA61x_uart_cmd(WDB_CMD, size,1, &Response);
-	
-	ret = usart_write_buffer_wait(&usart_instance, (uint8_t*) data, size);
-	if (ret != STATUS_OK)
-	{
-		return ret;
-	}
-
-#if 0 // padding not needed when size is less than 512 bytes. Algo WDB is always less than 256 bytes.
-	ret = usart_write_buffer_wait(&usart_instance, zeropad, WDB_SIZE - size);
-	if (ret != STATUS_OK)
-	{
-		return ret;
-	}
+    int32_t iRetvalue;
+
+#if IA61x_FW_CONTAINER
+    iRetvalue = IA61x_download_section(IA61x_IMG_PROGRAM_UART);
+#elif IA61x_FW_COMPRESSED
+    iRetvalue = IA61x_download_lz(VQ_Bin_lz, sizeof(VQ_Bin_lz), VQ_Bin_LZ_RAW_SIZE);
+#else
+    iRetvalue = IA61x_download_bin((const uint8_t *)VQ_Bin, sizeof(VQ_Bin));
 #endif
-	
-    ret = usart_read_buffer_wait(&usart_instance, inbuf2, 4);
-	if (ret != STATUS_OK)
-	{
-		return ret;
-	}
-	
-	return inbuf2[3];
-}
 
-static void IA61x_irq_callback(void)
-{
-	interrupt_flag = true;
+    return (IA61x_uart_firmware_up(iRetvalue));
 }
 
-static uint32_t IA61x_samd21_vq_uart_reg_IRQ(void)
+#if IA61x_FW_ASYNC
+/*******************************************************************************************************
+ * @fn      IA61x_uart_download_start()
+ *
+ * @brief   Start the Firmware download and return while the image streams to IA61x, so the host can
+ *          do other work. Complete it with IA61x_uart_download_finish().
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Download could not be started
+ * @retval  CMD_SUCCESS Firmware is streaming
+ * @retval  -1          No response from IA61x
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_uart_download_start(void)
 {
-	uint16_t    pResponse = 0;
-	/* Structure for external interrupt channel configuration */
-	struct extint_chan_conf eic_conf;
-
-	//set the type of interrupt (Rising Edge) generated on the HOST_IRQ line after an event detected by IA61x
-	if(!IA61x_uart_cmd(SET_EVENT_RESP_CMD,IA61x_INT_RISE_EDGE,1, &pResponse))
-	{
-		if(pResponse != (uint16_t)IA61x_INT_RISE_EDGE)
-		return (ERROR);
-	}
-
-
-	/* Configure the external interrupt channel */
-	extint_chan_get_config_defaults(&eic_conf);
-	eic_conf.gpio_pin           = IA61x_EIC_PIN;
-	eic_conf.gpio_pin_mux       = IA61x_EIC_PIN_MUX;
-	eic_conf.gpio_pin_pull      = EXTINT_PULL_UP;
-	eic_conf.detection_criteria = EXTINT_DETECT_RISING;
-	eic_conf.filter_input_signal= true;
-	extint_chan_set_config(IA61x_EIC_CHANNEL, &eic_conf);
+#if IA61x_FW_CONTAINER
+    IA61x_image_section section;
 
-	/* Register and enable the callback function for External interrupt from IA61x*/
-	extint_register_callback(IA61x_irq_callback, IA61x_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
-	extint_chan_enable_callback(IA61x_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
+    if (IA61x_section_lookup(IA61x_IMG_PROGRAM_UART, &section) != CMD_SUCCESS)
+        return (CMD_FAILED);
 
-	return (SUCCESS);
+    return (IA61x_download_begin(section.data, section.size, section.raw_size,
+                                 (section.flags & IA61x_IMG_FLAG_LZ) != 0));
+#else
+    return (IA61x_download_begin(VQ_Bin_lz, sizeof(VQ_Bin_lz), VQ_Bin_LZ_RAW_SIZE, true));
+#endif
 }
 
-
-static int32_t IA61x_uart_rdb(uint8_t algo_id, uint8_t block_type, uint8_t *data, uint32_t *size)
+/*******************************************************************************************************
+ * @fn      IA61x_uart_download_finish()
+ *
+ * @brief   Wait for the Firmware started by IA61x_uart_download_start() and bring it up
+ *
+ * @param   none
+ *
+ * @retval  pResponse   response to Sync command
+ * @retval  CMD_FAILED Command execution failed
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_uart_download_finish(void)
 {
-	uint16_t param = algo_id;
-	uint16_t response;
-	int32_t ret;
-	
-	param = (param << 8) | block_type;
-	
-	ret = IA61x_uart_cmd(RDB_CMD, param, 1, &response);
-	if (ret != CMD_SUCCESS)
-		return ret;
-	
-	//printf("RDB Len: %u\n", response);
-	if (response == 0)
-	{
-		*size = 0;
-		return 0;
-	}
-	
-	if (response > *size)
-	{
-		ret = IA61x_uart_get(data, *size);
-		if (ret == 0)
-		{
-			uint32_t wdata;
-			uint32_t pending = response - *size;
-			while (pending > 0)
-			{
-				// RDB data size is multiple of 4 bytes.
-				IA61x_uart_get((uint8_t*)&wdata, 4);
-				pending -= 4;
-			}
-		}
-	}
-	else
-	{
-		ret = IA61x_uart_get(data, response);
-		*size = response;
-	}
-	
-#if 0 //swap required only for SPI
-	uint32_t* p = (uint32_t*) data;
-	for (uint32_t i = 0; i < (*size / 4); i++)
-	{
-		p[i] = swap_ui32(p[i]);
-	}
-#endif
-
-	return ret;
+    return (IA61x_uart_firmware_up(IA61x_download_end()));
 }
+#endif /* IA61x_FW_ASYNC */
+
 
 /*******************************************************************************************************
  * @fn      IA61x_uart_VoiceWake()
@@ -459,18 +738,16 @@ static int32_t IA61x_uart_VoiceWake(void)
 	
 
 		//Send Sync command first to make sure that IA61x is awake. Ignore the response.
-		ret = IA61x_uart_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
+		ret = IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, &pResponse);
 		if (ret != 0)
 		{
 			error++;
 			continue;
 		}
-		
-		delay_ms(1);
 
 		uint16_t preset = PRESET_VALUE(2);
 		
-		if(!IA61x_uart_cmd(SET_PRESET_CMD | CMD_NO_RESP_MASK,preset,1, &pResponse))
+		if(!IA61x_proto_cmd(SET_PRESET_CMD | CMD_NO_RESP_MASK,preset,1, &pResponse))
 		{
 			if(pResponse != preset)
 			{
@@ -484,7 +761,7 @@ static int32_t IA61x_uart_VoiceWake(void)
 			continue;
 		}
 		
-		delay_ms(1);
+		delay_ms(1); //Preset has no response to poll, give IA61x time to apply it
 		break;
 	}
 	
@@ -498,96 +775,175 @@ static int32_t IA61x_uart_close(void)
 }
 
 /*******************************************************************************************************
- * @fn      IA61x_uart_wait_keyword
+ * @fn      IA61x_uart_sync_byte()
  *
- * @brief   Wait for Keyword, command or timeout to be detected
+ * @brief   Send the boot loader sync byte (0xB7) and check that it is echoed at the current rate
  *
- * @param   delay   Delay value to wait for keyword detection
+ * @param   none
  *
- * @retval  response[3]         Keyword ID for the detected keyword or command word
- * @retval  NO_KWD_DETECTED     0 if no keyword is detected by IA61x
+ * @retval  CMD_FAILED  No or wrong echo
+ * @retval  CMD_SUCCESS Boot loader answered at the current rate
  *
  *******************************************************************************************************/
-static int32_t IA61x_uart_wait_keyword(uint32_t delay)
+static int32_t IA61x_uart_sync_byte(void)
 {
-    const uint8_t GECmd[] =     { 0x80, 0x6d, 0x00, 0x00 };
-    uint8_t response[4];
-	
-	//Check if IA61x event detection interrupt is generated!!
-	//This is the indication that there is either Key word, command or timeout event*/
-	while(!interrupt_flag)
-	{
-		delay_ms(delay); //wait for sometime before checking for interrupt again. Here host can go in sleep mode until the interrupt occurs
-	}
+    const uint8_t b7[] = { 0xb7 };
+    uint8_t cRetVal = 0;
 
-	interrupt_flag = 0;
-	
-	response[3] = 0;
-    if (!delay)
-    {   /*Check if IA61x has send any data on the UART line. This is the indication that there is either Key word, command or timeout event*/
-        if (usart_read_buffer_wait(&usart_instance, response, 1) == STATUS_OK)
-        {
-            usart_read_buffer_wait(&usart_instance, &response[1], 3); // Just read additional 3 bytes to flush any remaining data from UART port
+    usart_write_buffer_wait(&usart_instance, b7, 1);
 
-            usart_write_buffer_wait(&usart_instance, GECmd, 4); //Send Get Event command to check what event has occur
-            if (usart_read_buffer_wait(&usart_instance, response, 4) != STATUS_OK) response[3] = 0;
-        }
-    }
-    else
+    //Anything received ahead of the echo is dropped
+    while (IA61x_uart_read_us(&cRetVal, 1, IA61x_READY_ECHO_US) == STATUS_OK)
     {
-        // flush until uart timeout.
-		while (usart_read_buffer_wait(&usart_instance, response, 4) != STATUS_ERR_TIMEOUT);
-		
-        usart_write_buffer_wait(&usart_instance, GECmd, 4);
-        if (usart_read_buffer_wait(&usart_instance, response, 4) != STATUS_OK) response[3] = 0;
+        if (cRetVal == 0xb7)
+            return (CMD_SUCCESS);
     }
 
-    if ((response[0] == GECmd[0]) && (response[1] == GECmd[1]))
-    {
-        if (response[3])
-        {
-            return (response[3]);
-        }
-    }
-	
-	return (NO_KWD_DETECTED);
+    return (CMD_FAILED);
+}
+
+/*******************************************************************************************************
+ * @fn      uart_boot_ready()
+ *
+ * @brief   Readiness probe, tell the boot loader the baud rate with 0x00 0x00 and check the sync echo
+ *
+ * @param   ctx     unused
+ *
+ * @retval  true    Boot loader answered
+ *
+ *******************************************************************************************************/
+static bool uart_boot_ready(void *ctx)
+{
+    const uint8_t quadzero[] = { 0x00, 0x00, 0x00, 0x00 };
+
+    (void)ctx;
+    usart_write_buffer_wait(&usart_instance, quadzero, 2);
+
+    return (IA61x_uart_sync_byte() == CMD_SUCCESS);
 }
 
+/*******************************************************************************************************
+ * @fn      uart_sync_ready()
+ *
+ * @brief   Readiness probe, the boot loader echoes a sync byte
+ *
+ * @param   ctx     unused
+ *
+ * @retval  true    Boot loader answered
+ *
+ *******************************************************************************************************/
+static bool uart_sync_ready(void *ctx)
+{
+    (void)ctx;
+    return (IA61x_uart_sync_byte() == CMD_SUCCESS);
+}
 
 /*******************************************************************************************************
- * @fn      IA61x_samd21_vq_uart_init
+ * @fn      IA61x_uart_set_rate()
  *
- * @brief   This function Power cycles IA61x and once the Host interface is auto detected
- *          by IA61x, it resets the UART baudrate to 460800 and initialize IA61x instance so 
- *          Host program can access IA61x APIs.
+ * @brief   Move the boot loader and the SAMD21 USART to a new rate and verify the link with the
+ *          Set Rate echo followed by a sync byte.
  *
- *              |                                                   |
- *          Host|->>----------------Power OFF/ON---------------->>->| IA61x
- *              |                   Delay 20 mSec                   |
- *              |->>---------Send Auto Baud - 00 00 ------------>>->|
- *              |->>----------Send Sync Byte - B7 -------------->>->|
- *              |-<<------------Ack Sync Byte - B7 -------------<<->|
- *              |->>---------Send Rate Request - 80 10 12 00---->>->|
+ *              |->>---------Send Rate Request - 80 19 xx 00---->>->|
  *              |     Reset the SAMD21 UART port with new Baud      |
- *              |-<<-------Ack Rate Request -   80 10 12 00-----<<->|
+ *              |->>-------------Send 00 00 00 00--------------->>->|
+ *              |-<<-------Ack Rate Request -   80 19 xx 00-----<<->|
  *              |->>-----------Send Sync Byte - B7 ------------->>->|
  *              |-<<-----------Ack Sync Byte - B7 --------------<<->|
  *
- * @param   IA61x   IA61x interface instance pointer to be initialized
+ * @param   rate        Ladder step to switch to
  *
- * @retval  CMD_FAILED      If any command fails
- * @retval  SUCCESS         If IA61x boot process is successful
+ * @retval  CMD_FAILED  Rate not usable
+ * @retval  CMD_SUCCESS Link verified at the new rate
  *
  *******************************************************************************************************/
-int32_t IA61x_samd21_vq_uart_init(IA61x_instance *IA61x)
+static int32_t IA61x_uart_set_rate(const uart_rate_step *rate)
+{
+    const uint8_t quadzero[] = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t SetRate[4] = { (uint8_t)(IA61x_UART_SET_RATE_CMD >> 8), (uint8_t)IA61x_UART_SET_RATE_CMD,
+                           (uint8_t)(rate->rate_code >> 8), (uint8_t)rate->rate_code };
+    uint8_t sRetVal[4] = { 0 };
+
+    usart_write_buffer_wait(&usart_instance, SetRate, 4);
+    delay_ms(1);
+
+    /*Reinitialize SAMD21 UART port for new Baudrate*/
+    my_usart_uninit();
+    if (my_usart_init(rate) != STATUS_OK)
+        return (CMD_FAILED);
+    delay_ms(1);
+
+    usart_write_buffer_wait(&usart_instance, quadzero, 4);
+    delay_ms(1);
+    IA61x_uart_read_us(sRetVal, 4, IA61x_READY_ECHO_US);
+
+    if (memcmp(sRetVal, SetRate, 4) != 0)
+        return (CMD_FAILED);
+
+    /*Send Sync Byte to IA61x to confirm new Baud rate*/
+    if (IA61x_uart_sync_byte() != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    IA61x_PROFILE_MARK(IA61x_PROF_RATE, rate->baud / 100);
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_uart_negotiate_rate()
+ *
+ * @brief   Climb the baud ladder one rate at a time, stopping at max_baud or at the first rate that
+ *          fails verification. On failure the link is moved back to the last good rate.
+ *
+ * @param   max_baud    Highest rate to try
+ *
+ * @retval  CMD_FAILED  Link could not be restored, uart_rate holds the last good rate
+ * @retval  CMD_SUCCESS Link is up, uart_rate holds the negotiated rate
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_uart_negotiate_rate(uint32_t max_baud)
 {
-    const uint8_t SetRate460800[]   =       { 0x80, 0x19, 0x12, 0x00 };
-    const uint8_t quadzero[]        =       { 0x00, 0x00, 0x00, 0x00 };
-    const uint8_t b7[]              =       { 0xb7 };
-    uint8_t sRetVal[4];
-    uint8_t cRetVal;
+    const uart_rate_step *good = uart_rate;
+    uint32_t i;
+
+    for (i = 0; i < (sizeof(uart_rate_ladder) / sizeof(uart_rate_ladder[0])); i++)
+    {
+        if (uart_rate_ladder[i].baud > max_baud)
+            break;
+
+        if (IA61x_uart_set_rate(&uart_rate_ladder[i]) != CMD_SUCCESS)
+        {
+            //Fall back to the last verified rate. IA61x may have ignored the request.
+            my_usart_uninit();
+            my_usart_init(good);
+            if (good == &uart_boot_rate)
+                return (IA61x_uart_sync_byte());
+
+            return (IA61x_uart_set_rate(good));
+        }
+
+        good = &uart_rate_ladder[i];
+    }
 
+    return (CMD_SUCCESS);
+}
 
+/*******************************************************************************************************
+ * @fn      IA61x_uart_boot_sync()
+ *
+ * @brief   Power cycle IA61x and sync with the boot loader at the auto-detect rate
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Boot loader did not answer
+ * @retval  CMD_SUCCESS Boot loader synced at IA61x_UART_BOOT_BAUD
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_uart_boot_sync(void)
+{
+#if IA61x_WARM_ATTACH
+    IA61x_warm_invalidate(); //IA61x loses its firmware
+#endif
+    IA61x_param_invalidate(); //and its parameters
     IA61x_samd21_vq_uart_uninit();
 
     my_usart_uninit();
@@ -595,66 +951,271 @@ int32_t IA61x_samd21_vq_uart_init(IA61x_instance *IA61x)
     /*Power cycle IA61x so Bootloader goes into Auto-detect state to detect the host controller interface*/
     port_pin_set_output_level(IA61x_LDO_ENABLE, 0 ); /* Make sure it's low */
     delay_ms(1);
+
+    my_usart_init(&uart_boot_rate); /* Configure the USART to talk to the boot loader */
+
     port_pin_set_output_level(IA61x_LDO_ENABLE, 1 );  /* Bring LDO Enable High */
-    delay_ms(20);
+    IA61x_PROFILE_MARK(IA61x_PROF_LDO_ON, 0);
 
-    my_usart_init(115200); /* Configure the USART to talk to the boot loader */
-    delay_ms(1);
+    /* Send 0x00 0x00 over the UART to tell IA61x the baud you are using, then the Sync Byte,
+     * until the boot loader is up and echoes it */
+    if (IA61x_ready_wait(uart_boot_ready, NULL, IA61x_READY_SYNC_POLL_US, IA61x_READY_LDO_US) != CMD_SUCCESS)
+        return (CMD_FAILED);
+    IA61x_PROFILE_MARK(IA61x_PROF_LDO_SETTLED, 0);
+    IA61x_PROFILE_MARK(IA61x_PROF_SYNC, 0xb7);
 
-    /* start by sending a 0x00 0x00 over the UART to tell IA61x the baud you are using */
-    usart_write_buffer_wait(&usart_instance, quadzero, 2);
+    return (CMD_SUCCESS);
+}
 
-    /*Send Sync Byte to IA61x*/
-    delay_ms(1);
-    usart_write_buffer_wait(&usart_instance, b7, 1);
-    delay_ms(1);
-    while (usart_read_buffer_wait(&usart_instance, &cRetVal, 1) == STATUS_OK) ;
+#if IA61x_WARM_ATTACH
+/*******************************************************************************************************
+ * @fn      IA61x_uart_warm_attach()
+ *
+ * @brief   After a host reset, reconnect to an IA61x that still runs the firmware of this build at
+ *          the rate recorded by the previous boot. The IA61x is not power cycled.
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  No matching firmware is running, cold boot required
+ * @retval  CMD_SUCCESS Running firmware is reused
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_uart_warm_attach(void)
+{
+    const uart_rate_step *rate = NULL;
+    struct port_config pin_conf;
+    uint32_t baud;
+    uint16_t response;
+    uint8_t i;
 
-    if (cRetVal != 0xb7)
+    if (!IA61x_warm_check(IA61x_uart_image_id(), &baud))
         return (CMD_FAILED);
-#if 1
-    /*Set UART Baud rate to 460800*/
-    usart_write_buffer_wait(&usart_instance, SetRate460800, 4);
-    delay_ms(1);
 
-    /*Reinitialize SAMD21 UART port for new Baudrate*/
+    for (i = 0; i < sizeof(uart_rate_ladder) / sizeof(uart_rate_ladder[0]); i++)
+    {
+        if (uart_rate_ladder[i].baud == baud)
+            rate = &uart_rate_ladder[i];
+    }
+    if (baud == uart_boot_rate.baud)
+        rate = &uart_boot_rate;
+    if (rate == NULL)
+        return (CMD_FAILED);
+
+    //Keep IA61x powered, LDO enable was not driven while the host was in reset
+    port_get_config_defaults(&pin_conf);
+    pin_conf.direction = PORT_PIN_DIR_OUTPUT;
+    port_pin_set_config(IA61x_LDO_ENABLE, &pin_conf);
+    port_pin_set_output_level(IA61x_LDO_ENABLE, 1 );
+
     my_usart_uninit();
-    my_usart_init(460800);
-    delay_ms(1);
+    if (my_usart_init(rate) != STATUS_OK)
+        return (CMD_FAILED);
 
-    usart_write_buffer_wait(&usart_instance, quadzero, 4);
-    delay_ms(1);
-    usart_read_buffer_wait(&usart_instance, sRetVal, 4);
+    //Drop whatever the firmware sent while the host was in reset
+    IA61x_uart_flush(IA61x_READY_ECHO_US);
 
-    if ((sRetVal[0] != SetRate460800[0]) |(sRetVal[1] != SetRate460800[1]) |
-            (sRetVal[2] != SetRate460800[2]) | (sRetVal[3] != SetRate460800[3]))
+    if ((IA61x_proto_cmd(SYNC_CMD, EMPTY_DATA, 1, &response) != CMD_SUCCESS) || (response != SYNC_RESP_NORM))
         return (CMD_FAILED);
-#endif //disable 460.8K baud
 
-    /*Send Sync Byte to IA61x to confirm new Baud rate*/
-    delay_ms(1);
-    usart_write_buffer_wait(&usart_instance, b7, 1);
-    delay_ms(1);
-    while (usart_read_buffer_wait(&usart_instance, &cRetVal, 1) == STATUS_OK) ;
-    if (cRetVal != 0xb7)
+    if (IA61x_proto_reg_irq(IA61x_EIC_CHANNEL, IA61x_EIC_PIN, IA61x_EIC_PIN_MUX) != SUCCESS)
+        return (CMD_FAILED);
+
+    if (!IA61x_warm_confirm(IA61x_proto_cmd))
+        return (CMD_FAILED);
+
+    IA61x_PROFILE_MARK(IA61x_PROF_WARM, baud / 100);
+    return (CMD_SUCCESS);
+}
+#endif /* IA61x_WARM_ATTACH */
+
+/*******************************************************************************************************
+ * @fn      IA61x_uart_cold_boot()
+ *
+ * @brief   Power cycle IA61x, synchronize with the boot loader and raise the baud rate
+ *
+ * @param   none
+ *
+ * @retval  CMD_FAILED  Boot loader did not respond
+ * @retval  CMD_SUCCESS Boot loader is ready for the downloads
+ *
+ *******************************************************************************************************/
+static int32_t IA61x_uart_cold_boot(void)
+{
+    uint32_t max_baud = IA61x_UART_MAX_BAUD;
+
+    if (IA61x_uart_boot_sync() != CMD_SUCCESS)
         return (CMD_FAILED);
 
-    delay_ms(10);
+    /* If the link is lost while climbing, IA61x is in an unknown state. Power cycle it
+     * and climb again, this time stopping at the last rate that was verified. */
+    if (IA61x_uart_negotiate_rate(max_baud) != CMD_SUCCESS)
+    {
+        max_baud = uart_rate->baud;
+
+        if (IA61x_uart_boot_sync() != CMD_SUCCESS)
+            return (CMD_FAILED);
+
+        if (IA61x_uart_negotiate_rate(max_baud) != CMD_SUCCESS)
+            return (CMD_FAILED);
+    }
+
+    //Boot loader is settled once it echoes again at the negotiated rate
+    if (IA61x_ready_wait(uart_sync_ready, NULL, IA61x_READY_SYNC_POLL_US, IA61x_READY_BOOT_US) != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    return (CMD_SUCCESS);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_uart_baud
+ *
+ * @brief   Report the negotiated IA61x UART rate
+ *
+ * @param   none
+ *
+ * @retval  Baud rate in use on the IA61x UART link
+ *
+ *******************************************************************************************************/
+uint32_t IA61x_samd21_vq_uart_baud(void)
+{
+    return (uart_rate->baud);
+}
+
+#if IA61x_UART_RX_RING
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_uart_rx_overruns
+ *
+ * @brief   Report the received bytes lost, ring full or SERCOM buffer overflow
+ *
+ * @param   none
+ *
+ * @retval  Count since start-up
+ *
+ *******************************************************************************************************/
+uint32_t IA61x_samd21_vq_uart_rx_overruns(void)
+{
+    return (uart_rx_overruns);
+}
+#endif /* IA61x_UART_RX_RING */
 
-    /*Initialize IA61x API Handle*/
+/*******************************************************************************************************
+ * @fn      IA61x_uart_instance
+ *
+ * @brief   Initialize the IA61x API handle with the UART operations
+ *
+ * @param   IA61x   IA61x interface instance pointer to be initialized
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+static void IA61x_uart_instance(IA61x_instance *IA61x)
+{
     IA61x->download_config  = IA61x_uart_download_config;
     IA61x->download_program = IA61x_uart_download_firmware;
-    IA61x->download_keyword = IA61x_uart_download_keyword;
+#if IA61x_FW_ASYNC
+    IA61x->download_start   = IA61x_uart_download_start;
+    IA61x->download_finish  = IA61x_uart_download_finish;
+#endif
+    IA61x->download_keyword = IA61x_proto_download_keyword;
     IA61x->VoiceWake        = IA61x_uart_VoiceWake;
     IA61x->close            = IA61x_uart_close;
-    IA61x->wait_keyword     = IA61x_uart_wait_keyword;
-    IA61x->cmd              = IA61x_uart_cmd;
+    IA61x->wait_keyword     = IA61x_proto_wait_keyword;
+    IA61x->cmd              = IA61x_proto_cmd;
     IA61x->get              = IA61x_uart_get;
     IA61x->put              = IA61x_uart_put;
-	IA61x->rdb				= IA61x_uart_rdb;
+    IA61x->rdb              = IA61x_proto_rdb;
+#if IA61x_WARM_ATTACH
+    IA61x->image_id         = IA61x_uart_image_id;
+#endif
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_uart_init
+ *
+ * @brief   This function Power cycles IA61x and once the Host interface is auto detected
+ *          by IA61x, it raises the UART baudrate step by step up to IA61x_UART_MAX_BAUD, keeping
+ *          the last rate that passed verification, and initialize IA61x instance so 
+ *          Host program can access IA61x APIs.
+ *          With IA61x_WARM_ATTACH, an IA61x still running the firmware of this build after a host
+ *          reset is reused instead (see IA61x_uart_warm_attach).
+ *
+ *              |                                                   |
+ *          Host|->>----------------Power OFF/ON---------------->>->| IA61x
+ *              |      Sync repeated until echoed, max 20 mSec      |
+ *              |->>---------Send Auto Baud - 00 00 ------------>>->|
+ *              |->>----------Send Sync Byte - B7 -------------->>->|
+ *              |-<<------------Ack Sync Byte - B7 -------------<<->|
+ *              |->>---------Send Rate Request - 80 19 xx 00---->>->|
+ *              |     Reset the SAMD21 UART port with new Baud      |
+ *              |-<<-------Ack Rate Request -   80 19 xx 00-----<<->|
+ *              |->>-----------Send Sync Byte - B7 ------------->>->|
+ *              |-<<-----------Ack Sync Byte - B7 --------------<<->|
+ *              |      ... repeated for each rate of the ladder     |
+ *
+ * @param   IA61x   IA61x interface instance pointer to be initialized
+ *
+ * @retval  CMD_FAILED      If any command fails
+ * @retval  SUCCESS         If IA61x boot process is successful
+ *
+ *******************************************************************************************************/
+int32_t IA61x_samd21_vq_uart_init(IA61x_instance *IA61x)
+{
+    IA61x_cmdq_init(&uart_cmdq);
+    IA61x_proto_bind(&uart_bus);
+
+#if IA61x_FW_COMPRESSED
+    IA61x_dma_init();
+#endif
+
+#if IA61x_WARM_ATTACH
+    if (IA61x_uart_warm_attach() != CMD_SUCCESS)
+#endif
+    {
+        if (IA61x_uart_cold_boot() != CMD_SUCCESS)
+        {
+            //Leave the port to the next interface probed
+            my_usart_uninit();
+            IA61x_samd21_vq_uart_uninit();
+            return (CMD_FAILED);
+        }
+    }
+
+    IA61x_uart_instance(IA61x);
+
+    return (SUCCESS);
+}
+
+#if IA61x_WARM_ATTACH
+/*******************************************************************************************************
+ * @fn      IA61x_samd21_vq_uart_attach
+ *
+ * @brief   Reconnect to an IA61x still running the UART firmware of this build, without a power cycle
+ *          (see IA61x_uart_warm_attach). Lets the interface probe try every bus before one of them
+ *          power cycles IA61x.
+ *
+ * @param   IA61x   IA61x interface instance pointer to be initialized
+ *
+ * @retval  CMD_FAILED      No matching firmware is running on the UART
+ * @retval  SUCCESS         Running firmware is reused
+ *
+ *******************************************************************************************************/
+int32_t IA61x_samd21_vq_uart_attach(IA61x_instance *IA61x)
+{
+    IA61x_cmdq_init(&uart_cmdq);
+    IA61x_proto_bind(&uart_bus);
+
+#if IA61x_FW_COMPRESSED
+    IA61x_dma_init();
+#endif
+
+    if (IA61x_uart_warm_attach() != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    IA61x_uart_instance(IA61x);
 
     return (SUCCESS);
 }
+#endif /* IA61x_WARM_ATTACH */
 
 /*******************************************************************************************************
  * @fn      IA61x_samd21_vq_uart_uninit
@@ -683,9 +1244,9 @@ static void recycle_uart(void)
 {
 	delay_ms(1000);
 	
-	usart_reset(&usart_instance);
 	my_usart_uninit();
-	my_usart_init(460800);
+	usart_reset(&usart_instance);
+	my_usart_init(uart_rate);
 	
 	delay_ms(1);
 }
@@ -37,10 +37,32 @@
 #include "IA61x.h"
 extern int32_t IA61x_samd21_vq_uart_init(IA61x_instance *IA61x);
 extern int32_t IA61x_samd21_vq_uart_uninit(void);
+#if IA61x_WARM_ATTACH
+extern int32_t IA61x_samd21_vq_uart_attach(IA61x_instance *IA61x);
+#endif
+extern uint32_t IA61x_samd21_vq_uart_baud(void);
+#if IA61x_UART_RX_RING
+extern uint32_t IA61x_samd21_vq_uart_rx_overruns(void);
+#endif
 
 #define IA61x_EXT_INT_PIN     PIN_PA16
 #define IA61x_EIC_PIN         PIN_PA16A_EIC_EXTINT0
 #define IA61x_EIC_PIN_MUX     PINMUX_PA16A_EIC_EXTINT0
 #define IA61x_EIC_CHANNEL     0
 
+#define IA61x_UART_BOOT_BAUD  115200  //Boot loader auto-detect rate
+#define IA61x_UART_SET_RATE_CMD  0x8019
+#define IA61x_UART_RX_ENTRIES 128     //Receive ring size (IA61x_UART_RX_RING), power of two up to 128
+#define IA61x_UART_GET_GAP_US 10000   //get(), longest gap between two received bytes
+
+/* Boot loader Set Rate (0x8019) data words. The upper byte is 0x10 plus the IA61x rate index,
+ * 460800 being index 2. Each entry is verified by echo and sync before it is kept. */
+#define IA61x_UART_RATE_460800   0x1200
+#define IA61x_UART_RATE_921600   0x1300
+#define IA61x_UART_RATE_1000000  0x1400
+#define IA61x_UART_RATE_1024000  0x1500
+#define IA61x_UART_RATE_1152000  0x1600
+#define IA61x_UART_RATE_2000000  0x1700
+#define IA61x_UART_RATE_2048000  0x1800
+
 #endif
\ No newline at end of file
@@ -0,0 +1,275 @@
+/************************************************************************//**
+ * File: IA61x_samd21_dma.c
+ *
+ * Description: SAMD21 DMAC transmit channels for IA61x host interfaces
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+#include <asf.h>
+#include <string.h>
+#include "IA61x_samd21_dma.h"
+#include "IA61x_samd21_timer.h"
+
+/*********************************************************************************/
+// private
+/*********************************************************************************/
+
+/* DMAC fetches the first descriptor of channel n from descriptor_section[n] and
+ * writes the active descriptor back to writeback_section[n]. Further blocks of a
+ * transfer are chained from chain_section. */
+COMPILER_ALIGNED(16) static DmacDescriptor descriptor_section[IA61x_DMA_CHANNELS];
+COMPILER_ALIGNED(16) static DmacDescriptor writeback_section[IA61x_DMA_CHANNELS];
+COMPILER_ALIGNED(16) static DmacDescriptor chain_section[IA61x_DMA_CHANNELS][IA61x_DMA_MAX_CHAIN - 1];
+
+typedef struct
+{
+    IA61x_dma_callback_t callback;
+    volatile bool busy;
+    uint32_t start_us;
+    IA61x_dma_stats stats;
+} dma_channel_state;
+
+static dma_channel_state channels[IA61x_DMA_CHANNELS];
+static bool dma_initialized = false;
+
+/*******************************************************************************************************
+ * @fn      IA61x_dma_init()
+ *
+ * @brief   Clock and enable the DMAC with all priority levels. Safe to call more than once.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+void IA61x_dma_init(void)
+{
+    if (dma_initialized)
+        return;
+
+    IA61x_timer_init(); /* Time base for the throughput report */
+
+    system_ahb_clock_set_mask(PM_AHBMASK_DMAC);
+    system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBB, PM_APBBMASK_DMAC);
+
+    DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+    DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+    while (DMAC->CTRL.reg & DMAC_CTRL_SWRST) ;
+
+    memset(descriptor_section, 0, sizeof(descriptor_section));
+    memset(writeback_section, 0, sizeof(writeback_section));
+    memset(channels, 0, sizeof(channels));
+
+    DMAC->BASEADDR.reg = (uint32_t)descriptor_section;
+    DMAC->WRBADDR.reg  = (uint32_t)writeback_section;
+    DMAC->CTRL.reg     = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+    system_interrupt_enable(SYSTEM_INTERRUPT_MODULE_DMA);
+
+    dma_initialized = true;
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_dma_write()
+ *
+ * @brief   Start a memory to peripheral transfer. The source may be in flash. Transfers larger than
+ *          one DMAC block are split over chained descriptors so the whole buffer goes out as a single
+ *          transfer without CPU involvement. The callback runs in interrupt context once the last
+ *          byte was handed to the peripheral or on a transfer error.
+ *
+ * @param   channel     DMAC channel (IA61x_DMA_CH_xxx)
+ * @param   trigger     Peripheral trigger source, e.g. SERCOM1_DMAC_ID_TX
+ * @param   dst         Peripheral data register
+ * @param   src         Source buffer
+ * @param   size        Number of bytes to send
+ * @param   callback    Completion callback, may be NULL
+ *
+ * @retval  STATUS_OK               Transfer started
+ * @retval  STATUS_BUSY             Channel has a transfer in progress
+ * @retval  STATUS_ERR_INVALID_ARG  Bad channel, empty or oversized buffer
+ *
+ *******************************************************************************************************/
+enum status_code IA61x_dma_write(uint8_t channel, uint8_t trigger, volatile void *dst,
+                                 const uint8_t *src, uint32_t size, IA61x_dma_callback_t callback)
+{
+    DmacDescriptor *desc;
+    dma_channel_state *state;
+    uint32_t count = 0;
+    uint32_t block;
+
+    if ((channel >= IA61x_DMA_CHANNELS) || (size == 0) ||
+            (size > (uint32_t)IA61x_DMA_MAX_BLOCK * IA61x_DMA_MAX_CHAIN))
+        return (STATUS_ERR_INVALID_ARG);
+
+    state = &channels[channel];
+    if (state->busy)
+        return (STATUS_BUSY);
+
+    state->stats.bytes = size;
+
+    /* Build the descriptor chain. SRCADDR holds the end address when the source increments. */
+    desc = &descriptor_section[channel];
+    while (size > 0)
+    {
+        block = (size > IA61x_DMA_MAX_BLOCK) ? IA61x_DMA_MAX_BLOCK : size;
+        size -= block;
+
+        desc->BTCTRL.reg   = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+                             (size ? DMAC_BTCTRL_BLOCKACT_NOACT : DMAC_BTCTRL_BLOCKACT_INT);
+        desc->BTCNT.reg    = (uint16_t)block;
+        desc->SRCADDR.reg  = (uint32_t)src + block;
+        desc->DSTADDR.reg  = (uint32_t)dst;
+        desc->DESCADDR.reg = size ? (uint32_t)&chain_section[channel][count] : 0;
+
+        src += block;
+        if (size)
+            desc = &chain_section[channel][count];
+        count++;
+    }
+
+    state->stats.descriptors = count;
+    state->callback = callback;
+    state->busy = true;
+
+    system_interrupt_enter_critical_section();
+    DMAC->CHID.reg = DMAC_CHID_ID(channel);
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+    while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) ;
+    DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(trigger) | DMAC_CHCTRLB_TRIGACT_BEAT;
+    DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+    state->start_us = IA61x_timer_us();
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    system_interrupt_leave_critical_section();
+
+    return (STATUS_OK);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_dma_busy()
+ *
+ * @brief   Check if a channel still has a transfer in progress
+ *
+ * @param   channel     DMAC channel
+ *
+ * @retval  true while the transfer is running
+ *
+ *******************************************************************************************************/
+bool IA61x_dma_busy(uint8_t channel)
+{
+    return ((channel < IA61x_DMA_CHANNELS) && channels[channel].busy);
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_dma_abort()
+ *
+ * @brief   Stop a running transfer. The callback is not invoked.
+ *
+ * @param   channel     DMAC channel
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+void IA61x_dma_abort(uint8_t channel)
+{
+    if (channel >= IA61x_DMA_CHANNELS)
+        return;
+
+    system_interrupt_enter_critical_section();
+    DMAC->CHID.reg = DMAC_CHID_ID(channel);
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+    DMAC->CHINTENCLR.reg = DMAC_CHINTENCLR_TCMPL | DMAC_CHINTENCLR_TERR;
+    DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR;
+    channels[channel].busy = false;
+    system_interrupt_leave_critical_section();
+}
+
+/*******************************************************************************************************
+ * @fn      IA61x_dma_get_stats()
+ *
+ * @brief   Copy the byte count and timing of a channel
+ *
+ * @param   channel     DMAC channel
+ * @param   stats       Destination for the statistics
+ *
+ * @retval  none
+ *
+ *******************************************************************************************************/
+void IA61x_dma_get_stats(uint8_t channel, IA61x_dma_stats *stats)
+{
+    if (channel >= IA61x_DMA_CHANNELS)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    system_interrupt_enter_critical_section();
+    *stats = channels[channel].stats;
+    system_interrupt_leave_critical_section();
+}
+
+/*******************************************************************************************************
+ * @fn      DMAC_Handler
+ *
+ * @brief   DMAC interrupt. Serves the pending channel with the highest priority, records the transfer
+ *          time and hands the result to the channel callback.
+ *
+ *******************************************************************************************************/
+void DMAC_Handler(void)
+{
+    uint8_t channel = DMAC->INTPEND.reg & DMAC_INTPEND_ID_Msk;
+    uint8_t flags;
+    dma_channel_state *state;
+    enum status_code status;
+
+    DMAC->CHID.reg = DMAC_CHID_ID(channel);
+    flags = DMAC->CHINTFLAG.reg & DMAC->CHINTENSET.reg;
+    DMAC->CHINTFLAG.reg = flags;
+
+    if ((channel >= IA61x_DMA_CHANNELS) || !flags)
+        return;
+
+    state = &channels[channel];
+    if (flags & DMAC_CHINTFLAG_TERR)
+    {
+        DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+        state->stats.errors++;
+        status = STATUS_ERR_IO;
+    }
+    else
+    {
+        status = STATUS_OK;
+    }
+
+    state->stats.elapsed_us   = IA61x_timer_elapsed_us(state->start_us);
+    state->stats.total_bytes += state->stats.bytes;
+    state->stats.total_us    += state->stats.elapsed_us;
+    state->busy = false;
+
+    if (state->callback)
+        state->callback(status);
+}
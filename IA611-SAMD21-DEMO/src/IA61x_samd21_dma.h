@@ -0,0 +1,85 @@
+/************************************************************************//**
+ * File: IA61x_samd21_dma.h
+ *
+ * Description: SAMD21 DMAC transmit channels for IA61x host interfaces
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_SAMD21_DMA_H_
+#define IA61x_SAMD21_DMA_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* DMAC channel assignment */
+#define IA61x_DMA_CH_SPI_TX         0
+#define IA61x_DMA_CH_UART_TX        1
+#define IA61x_DMA_CH_I2C_TX         2
+#define IA61x_DMA_CHANNELS          3
+
+#define IA61x_DMA_MAX_BLOCK         0xFFFF  //Max beats per DMAC descriptor (BTCNT is 16 bit)
+#define IA61x_DMA_MAX_CHAIN         4       //Descriptors per transfer. 4 x 64 KB covers the largest image
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Called from DMAC interrupt context when a transfer completes or fails */
+typedef void (*IA61x_dma_callback_t)(enum status_code status);
+
+typedef struct
+{
+    uint32_t bytes;             //Bytes moved by the last transfer
+    uint32_t descriptors;       //Descriptors chained for the last transfer
+    uint32_t elapsed_us;        //Start to completion interrupt of the last transfer
+    uint32_t total_bytes;       //Bytes moved since IA61x_dma_init
+    uint32_t total_us;          //Bus time since IA61x_dma_init
+    uint32_t errors;            //Transfers ended by a DMAC transfer error
+} IA61x_dma_stats;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+void IA61x_dma_init(void);
+enum status_code IA61x_dma_write(uint8_t channel, uint8_t trigger, volatile void *dst,
+                                 const uint8_t *src, uint32_t size, IA61x_dma_callback_t callback);
+bool IA61x_dma_busy(uint8_t channel);
+void IA61x_dma_abort(uint8_t channel);
+void IA61x_dma_get_stats(uint8_t channel, IA61x_dma_stats *stats);
+
+/* Throughput of the last transfer in bytes per millisecond (= KB/s) */
+static inline uint32_t IA61x_dma_kbps(const IA61x_dma_stats *stats)
+{
+    return (stats->elapsed_us ? (stats->bytes * 1000UL) / stats->elapsed_us : 0);
+}
+
+#endif /* IA61x_SAMD21_DMA_H_ */
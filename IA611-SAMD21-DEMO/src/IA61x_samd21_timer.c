@@ -0,0 +1,172 @@
+/************************************************************************//**
+ * File: IA61x_samd21_timer.c
+ *
+ * Description: Free running microsecond time base for IA61x host drivers
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+#include <asf.h>
+#include "IA61x_samd21_timer.h"
+
+static bool timer_running = false;
+static volatile IA61x_timer_callback_t alarm_callback = NULL;
+static volatile uint32_t alarm_at = 0;
+
+/***************************************************************************
+ * @fn      IA61x_timer_init()
+ *
+ * @brief   Start TC4/TC5 as a free running 32 bit up counter ticking every
+ *          microsecond. Safe to call more than once.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_timer_init(void)
+{
+    struct system_gclk_chan_config gclk_chan_conf;
+    TcCount32 *const hw = &IA61x_TIMER_MODULE->COUNT32;
+
+    if (timer_running)
+        return;
+
+    system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, IA61x_TIMER_APBC_MASK);
+
+    system_gclk_chan_get_config_defaults(&gclk_chan_conf);
+    gclk_chan_conf.source_generator = GCLK_GENERATOR_0;
+    system_gclk_chan_set_config(IA61x_TIMER_GCLK_ID, &gclk_chan_conf);
+    system_gclk_chan_enable(IA61x_TIMER_GCLK_ID);
+
+    hw->CTRLA.reg = TC_CTRLA_SWRST;
+    while (hw->CTRLA.reg & TC_CTRLA_SWRST) ;
+
+    hw->CTRLA.reg = TC_CTRLA_MODE_COUNT32 | IA61x_TIMER_PRESCALER;
+    while (hw->STATUS.reg & TC_STATUS_SYNCBUSY) ;
+
+    /* Keep COUNT continuously synchronized so it can be read without a read request. */
+    hw->READREQ.reg = TC_READREQ_RCONT | TC_READREQ_ADDR(TC_COUNT32_COUNT_OFFSET);
+    while (hw->STATUS.reg & TC_STATUS_SYNCBUSY) ;
+
+    hw->CTRLA.reg |= TC_CTRLA_ENABLE;
+    while (hw->STATUS.reg & TC_STATUS_SYNCBUSY) ;
+
+    system_interrupt_set_priority(IA61x_TIMER_IRQ, IA61x_TIMER_IRQ_PRIORITY);
+    system_interrupt_enable(IA61x_TIMER_IRQ);
+
+    timer_running = true;
+}
+
+/***************************************************************************
+ * @fn      IA61x_timer_us()
+ *
+ * @brief   Read the free running microsecond counter
+ *
+ * @param   none
+ *
+ * @retval  Counter value in microseconds, 0 if the timer was never started
+ *
+ ****************************************************************************/
+uint32_t IA61x_timer_us(void)
+{
+    if (!timer_running)
+        return (0);
+
+    return (IA61x_TIMER_MODULE->COUNT32.COUNT.reg);
+}
+
+/***************************************************************************
+ * @fn      IA61x_timer_alarm()
+ *
+ * @brief   Call back once after a delay, using compare channel 0 of the
+ *          free running counter. A new alarm replaces a pending one.
+ *
+ * @param   delay_us    Delay in microseconds, 0 calls back as soon as
+ *                      interrupts allow
+ * @param   callback    Called from the TC4 interrupt
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_timer_alarm(uint32_t delay_us, IA61x_timer_callback_t callback)
+{
+    TcCount32 *const hw = &IA61x_TIMER_MODULE->COUNT32;
+
+    IA61x_timer_init();
+
+    system_interrupt_enter_critical_section();
+    alarm_callback = callback;
+    alarm_at = IA61x_timer_us() + delay_us;
+
+    hw->CC[0].reg = alarm_at;
+    while (hw->STATUS.reg & TC_STATUS_SYNCBUSY) ;
+    hw->INTFLAG.reg = TC_INTFLAG_MC0;
+    hw->INTENSET.reg = TC_INTENSET_MC0;
+
+    /* The match may have gone by while CC0 was written */
+    if ((int32_t)(IA61x_timer_us() - alarm_at) >= 0)
+        system_interrupt_set_pending(IA61x_TIMER_IRQ);
+    system_interrupt_leave_critical_section();
+}
+
+/***************************************************************************
+ * @fn      IA61x_timer_alarm_cancel()
+ *
+ * @brief   Drop a pending alarm
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_timer_alarm_cancel(void)
+{
+    system_interrupt_enter_critical_section();
+    IA61x_TIMER_MODULE->COUNT32.INTENCLR.reg = TC_INTENCLR_MC0;
+    alarm_callback = NULL;
+    system_interrupt_leave_critical_section();
+}
+
+/***************************************************************************
+ * @fn      TC4_Handler
+ *
+ * @brief   Compare channel 0 interrupt, runs the alarm callback once it is due
+ *
+ ****************************************************************************/
+void TC4_Handler(void)
+{
+    TcCount32 *const hw = &IA61x_TIMER_MODULE->COUNT32;
+    IA61x_timer_callback_t callback = alarm_callback;
+
+    hw->INTFLAG.reg = TC_INTFLAG_MC0;
+    if (!callback || ((int32_t)(IA61x_timer_us() - alarm_at) < 0))
+        return;
+
+    hw->INTENCLR.reg = TC_INTENCLR_MC0;
+    alarm_callback = NULL;
+    callback();
+}
@@ -0,0 +1,76 @@
+/************************************************************************//**
+ * File: IA61x_samd21_timer.h
+ *
+ * Description: Free running microsecond time base for IA61x host drivers
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_SAMD21_TIMER_H_
+#define IA61x_SAMD21_TIMER_H_
+
+#include <asf.h>
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* TC4 is the master and TC5 the slave of the 32 bit counter pair. */
+#define IA61x_TIMER_MODULE          TC4
+#define IA61x_TIMER_GCLK_ID         TC4_GCLK_ID
+#define IA61x_TIMER_APBC_MASK       (PM_APBCMASK_TC4 | PM_APBCMASK_TC5)
+
+/* GCLK0 runs from OSC8M (see conf_clocks.h), DIV8 gives one tick per microsecond. */
+#define IA61x_TIMER_PRESCALER       TC_CTRLA_PRESCALER_DIV8
+
+/* The alarm runs at the lowest priority so SERCOM and DMAC interrupts can complete bus transfers under it */
+#define IA61x_TIMER_IRQ             SYSTEM_INTERRUPT_MODULE_TC4
+#define IA61x_TIMER_IRQ_PRIORITY    SYSTEM_INTERRUPT_PRIORITY_LEVEL_3
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Alarm callback, runs in interrupt context */
+typedef void (*IA61x_timer_callback_t)(void);
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+void IA61x_timer_init(void);
+uint32_t IA61x_timer_us(void);
+void IA61x_timer_alarm(uint32_t delay_us, IA61x_timer_callback_t callback);
+void IA61x_timer_alarm_cancel(void);
+
+/* Microseconds elapsed since a previous IA61x_timer_us() sample. Wrap safe. */
+static inline uint32_t IA61x_timer_elapsed_us(uint32_t start)
+{
+    return (IA61x_timer_us() - start);
+}
+
+#endif /* IA61x_SAMD21_TIMER_H_ */
@@ -0,0 +1,194 @@
+/************************************************************************//**
+ * File: IA61x_stream.c
+ *
+ * Description: Interrupt driven image streaming to IA61x
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include "IA61x_stream.h"
+#include "IA61x_lz.h"
+#include "IA61x_profile.h"
+
+/*
+ * One image streams at a time. A compressed image is sent block by block: each DMA completion
+ * interrupt starts the block decoded before and then decodes the following one into the half of
+ * the ring that was just sent. The thread that started the stream is free until IA61x_stream_wait.
+ */
+static IA61x_lz_stream stream_lz;
+static IA61x_stream_put_t stream_put = NULL;
+static bool stream_compressed = false;
+static const uint8_t *stream_next = NULL;
+static uint32_t stream_next_len = 0;
+
+static volatile bool stream_running = false;
+static volatile enum status_code stream_status = STATUS_OK;
+
+/***************************************************************************
+ * @fn      stream_done()
+ *
+ * @brief   End the stream with a result
+ *
+ * @param   status  Result reported by IA61x_stream_wait
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void stream_done(enum status_code status)
+{
+    stream_status = status;
+    stream_running = false;
+}
+
+/***************************************************************************
+ * @fn      stream_callback()
+ *
+ * @brief   DMA completion, interrupt context. Send the next decoded block
+ *          and decode the one after it while it is on the bus.
+ *
+ * @param   status  DMAC transfer status
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void stream_callback(enum status_code status)
+{
+    const uint8_t *block = stream_next;
+    uint32_t len = stream_next_len;
+
+    if (status != STATUS_OK)
+    {
+        stream_done(status);
+        return;
+    }
+    IA61x_PROFILE_CHUNK();
+
+    if (!len)
+    {
+        if (stream_compressed && !IA61x_lz_complete(&stream_lz))
+            stream_done(STATUS_ERR_BAD_DATA);
+        else
+            stream_done(STATUS_OK);
+        return;
+    }
+
+    status = stream_put(block, len, stream_callback);
+    if (status != STATUS_OK)
+    {
+        stream_done(status);
+        return;
+    }
+
+    stream_next_len = IA61x_lz_read_block(&stream_lz, &stream_next);
+}
+
+/***************************************************************************
+ * @fn      IA61x_stream_start()
+ *
+ * @brief   Start sending an image and return while it streams. The first
+ *          two blocks of a compressed image are decoded here, both halves
+ *          of the ring are then filled.
+ *
+ * @param   put         DMA write of the host interface
+ * @param   data        Image, usually in flash
+ * @param   size        Size of the image as stored
+ * @param   raw_size    Size of the image sent to IA61x
+ * @param   compressed  Image is LZ compressed
+ *
+ * @retval  STATUS_OK           Image is streaming
+ * @retval  STATUS_BUSY         A stream is still running
+ * @retval  other               Transfer could not be started
+ *
+ ****************************************************************************/
+enum status_code IA61x_stream_start(IA61x_stream_put_t put, const uint8_t *data, uint32_t size,
+                                    uint32_t raw_size, bool compressed)
+{
+    const uint8_t *block = data;
+    uint32_t len = raw_size;
+    enum status_code status;
+
+    if (stream_running)
+        return (STATUS_BUSY);
+
+    stream_put = put;
+    stream_compressed = compressed;
+    stream_next_len = 0;
+
+    if (compressed)
+    {
+        IA61x_lz_open(&stream_lz, data, size, raw_size);
+        len = IA61x_lz_read_block(&stream_lz, &block);
+        stream_next_len = IA61x_lz_read_block(&stream_lz, &stream_next);
+    }
+
+    if (!len)
+        return (STATUS_ERR_BAD_DATA);
+
+    stream_status = STATUS_OK;
+    stream_running = true;
+
+    status = put(block, len, stream_callback);
+    if (status != STATUS_OK)
+        stream_running = false;
+
+    return (status);
+}
+
+/***************************************************************************
+ * @fn      IA61x_stream_busy()
+ *
+ * @brief   Check if an image is still streaming
+ *
+ * @param   none
+ *
+ * @retval  true while the image is sent
+ *
+ ****************************************************************************/
+bool IA61x_stream_busy(void)
+{
+    return (stream_running);
+}
+
+/***************************************************************************
+ * @fn      IA61x_stream_wait()
+ *
+ * @brief   Wait for the running stream to end
+ *
+ * @param   none
+ *
+ * @retval  STATUS_OK           Whole image was sent
+ * @retval  STATUS_ERR_BAD_DATA Compressed image is corrupt
+ * @retval  other               DMA transfer error
+ *
+ ****************************************************************************/
+enum status_code IA61x_stream_wait(void)
+{
+    while (stream_running) {} //DMA completion interrupt ends the stream
+
+    return (stream_status);
+}
@@ -0,0 +1,228 @@
+/************************************************************************//**
+ * File: IA61x_trace.c
+ *
+ * Description: Bus transaction trace
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include "IA61x_config.h"
+#if defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE
+
+#include <asf.h>
+#include <stdio.h>
+#include <string.h>
+#include "IA61x_trace.h"
+#include "IA61x_samd21_timer.h"
+
+#define TRACE_MASK      (IA61x_TRACE_ENTRIES - 1)
+
+#if (IA61x_TRACE_ENTRIES & TRACE_MASK) != 0
+#error "IA61x_TRACE_ENTRIES must be a power of two"
+#endif
+
+IA61x_NOINIT static IA61x_trace_ring trace;
+
+/***************************************************************************
+ * @fn      IA61x_trace_start()
+ *
+ * @brief   Attach to the trace ring. A ring left by the previous boot is
+ *          kept and continued behind an IA61x_TRACE_BOOT entry, anything
+ *          else is cleared. Call right after system_init, the microsecond
+ *          timer needs the final GCLK0 setup.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_trace_start(void)
+{
+    if (trace.magic != IA61x_TRACE_MAGIC)
+        IA61x_trace_clear();
+
+    IA61x_timer_init();
+    IA61x_trace_record(IA61x_TRACE_BOOT, system_get_reset_cause(), 0, 0, 0);
+}
+
+/***************************************************************************
+ * @fn      IA61x_trace_clear()
+ *
+ * @brief   Drop all entries
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_trace_clear(void)
+{
+    system_interrupt_enter_critical_section();
+    memset(&trace, 0, sizeof(trace));
+    trace.magic = IA61x_TRACE_MAGIC;
+    system_interrupt_leave_critical_section();
+}
+
+/***************************************************************************
+ * @fn      IA61x_trace_record()
+ *
+ * @brief   Append an entry, overwriting the oldest one when the ring is
+ *          full. May be called from interrupt context.
+ *
+ * @param   op      IA61x_trace_op
+ * @param   word    Command word
+ * @param   data    Data or response word
+ * @param   length  Bytes moved
+ * @param   status  CMD_xxx or ASF status_code
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_trace_record(uint8_t op, uint16_t word, uint16_t data, uint32_t length, int32_t status)
+{
+    IA61x_trace_entry *entry;
+    uint32_t now = IA61x_timer_us();
+
+    system_interrupt_enter_critical_section();
+    entry = &trace.entry[trace.head++ & TRACE_MASK];
+    entry->us = now;
+    entry->word = word;
+    entry->data = data;
+    entry->length = (length > 0xFFFF) ? 0xFFFF : length;
+    entry->op = op;
+    entry->status = (int8_t)status;
+    system_interrupt_leave_critical_section();
+}
+
+/***************************************************************************
+ * @fn      op_name()
+ *
+ * @brief   Printable name of a transaction kind
+ *
+ * @param   op      IA61x_trace_op
+ *
+ * @retval  Name
+ *
+ ****************************************************************************/
+static const char *op_name(uint8_t op)
+{
+    switch (op)
+    {
+        case IA61x_TRACE_BOOT:  return ("boot");
+        case IA61x_TRACE_CMD:   return ("cmd");
+        case IA61x_TRACE_PUT:   return ("put");
+        case IA61x_TRACE_WDB:   return ("wdb");
+        case IA61x_TRACE_RESP:  return ("resp");
+        case IA61x_TRACE_GET:   return ("get");
+        case IA61x_TRACE_RDB:   return ("rdb");
+        default:                return ("?");
+    }
+}
+
+/***************************************************************************
+ * @fn      IA61x_trace_print()
+ *
+ * @brief   Print the ring oldest entry first: direction, kind, words,
+ *          length, status, timestamp and time since the previous entry.
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_trace_print(void)
+{
+    const IA61x_trace_entry *entry;
+    uint32_t head = trace.head;
+    uint32_t i, first, prev;
+
+    first = (head > IA61x_TRACE_ENTRIES) ? head - IA61x_TRACE_ENTRIES : 0;
+
+    printf("Bus trace, %lu transactions, last %lu\r\n", head, head - first);
+    printf("%8s %2s %-4s %6s %6s %6s %6s %10s %10s\r\n",
+           "#", "", "op", "word", "data", "len", "status", "at us", "delta us");
+
+    prev = (first < head) ? trace.entry[first & TRACE_MASK].us : 0;
+    for (i = first; i < head; i++)
+    {
+        entry = &trace.entry[i & TRACE_MASK];
+        if (entry->op == IA61x_TRACE_BOOT)
+            prev = entry->us;
+
+        printf("%8lu %2s %-4s 0x%04X 0x%04X %6u %6d %10lu %10lu\r\n",
+               i, (entry->op & IA61x_TRACE_RX) ? "rx" : "tx", op_name(entry->op),
+               entry->word, entry->data, entry->length, entry->status,
+               entry->us, entry->us - prev);
+        prev = entry->us;
+    }
+}
+
+/***************************************************************************
+ * @fn      IA61x_trace_export()
+ *
+ * @brief   Write the ring as binary: an IA61x_trace_header followed by the
+ *          entries oldest first
+ *
+ * @param   write   Sink, e.g. the console UART
+ *
+ * @retval  0       Export complete
+ * @retval  other   Returned by the sink
+ *
+ ****************************************************************************/
+int IA61x_trace_export(IA61x_trace_write_t write)
+{
+    IA61x_trace_header header;
+    uint32_t head = trace.head;
+    uint32_t first, index, count;
+    int ret;
+
+    first = (head > IA61x_TRACE_ENTRIES) ? head - IA61x_TRACE_ENTRIES : 0;
+
+    header.magic = IA61x_TRACE_MAGIC;
+    header.version = IA61x_TRACE_VERSION;
+    header.entry_size = sizeof(IA61x_trace_entry);
+    header.head = head;
+    header.count = head - first;
+
+    ret = write((const uint8_t *)&header, sizeof(header));
+
+    //The oldest entries run to the end of the array, the rest wraps to its start
+    while ((ret == 0) && (first < head))
+    {
+        index = first & TRACE_MASK;
+        count = IA61x_TRACE_ENTRIES - index;
+        if (count > head - first)
+            count = head - first;
+
+        ret = write((const uint8_t *)&trace.entry[index], count * sizeof(IA61x_trace_entry));
+        first += count;
+    }
+
+    return (ret);
+}
+
+#endif /* IA61x_BUS_TRACE */
@@ -0,0 +1,122 @@
+/************************************************************************//**
+ * File: IA61x_trace.h
+ *
+ * Description: Bus transaction trace
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_TRACE_H_
+#define IA61x_TRACE_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+#include "IA61x_noinit.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_TRACE_MAGIC           0x54524345  //"TRCE"
+#define IA61x_TRACE_VERSION         1           //Layout of the binary export
+#define IA61x_TRACE_ENTRIES         128         //Ring size, power of two
+#define IA61x_TRACE_RX              0x80        //Op flag, IA61x to host
+
+/*
+ * Record one transaction. Commands are recorded by the command queue, the bulk operations
+ * of the instance (get, put, rdb, download_keyword) by IA61x.c.
+ */
+#if defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE
+#define IA61x_TRACE(op, word, data, length, status) \
+        IA61x_trace_record((op), (word), (data), (length), (int32_t)(status))
+#else
+#define IA61x_TRACE(op, word, data, length, status) do {} while (0)
+#endif
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Transaction kinds, IA61x_TRACE_RX marks the ones that read from IA61x */
+typedef enum
+{
+    IA61x_TRACE_BOOT = 0x00,                        //Host (re)started, word = reset cause
+    IA61x_TRACE_CMD  = 0x01,                        //Command and data word sent
+    IA61x_TRACE_PUT  = 0x02,                        //Bulk write
+    IA61x_TRACE_WDB  = 0x03,                        //download_keyword, word = WDB command
+    IA61x_TRACE_RESP = IA61x_TRACE_RX | 0x01,       //Command completed, data = response word
+    IA61x_TRACE_GET  = IA61x_TRACE_RX | 0x02,       //Bulk read
+    IA61x_TRACE_RDB  = IA61x_TRACE_RX | 0x03,       //rdb, word = algo_id << 8 | block_type
+} IA61x_trace_op;
+
+typedef struct
+{
+    uint32_t us;                //IA61x_timer_us() when the transaction ended
+    uint16_t word;              //Command word, see IA61x_trace_op
+    uint16_t data;              //Data or response word
+    uint16_t length;            //Bytes moved, saturated at 0xFFFF
+    uint8_t  op;                //IA61x_trace_op
+    int8_t   status;            //CMD_xxx or ASF status_code
+} IA61x_trace_entry;
+
+/* Trace ring, kept in .noinit so the transactions before a reset can still be read */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t head;              //Entries recorded, the ring holds the last IA61x_TRACE_ENTRIES
+    IA61x_trace_entry entry[IA61x_TRACE_ENTRIES];
+} IA61x_trace_ring;
+
+/* Header of the binary export, followed by the entries oldest first, all little endian */
+typedef struct
+{
+    uint32_t magic;             //IA61x_TRACE_MAGIC
+    uint16_t version;           //IA61x_TRACE_VERSION
+    uint16_t entry_size;        //sizeof(IA61x_trace_entry)
+    uint32_t head;              //Entries recorded
+    uint32_t count;             //Entries that follow
+} IA61x_trace_header;
+
+/* Sink of the binary export, returns 0 on success */
+typedef int (*IA61x_trace_write_t)(const uint8_t *data, uint32_t size);
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+#if defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE
+void IA61x_trace_start(void);
+void IA61x_trace_record(uint8_t op, uint16_t word, uint16_t data, uint32_t length, int32_t status);
+void IA61x_trace_clear(void);
+void IA61x_trace_print(void);
+int IA61x_trace_export(IA61x_trace_write_t write);
+#else
+#define IA61x_trace_start()
+#define IA61x_trace_print()
+#endif
+
+#endif /* IA61x_TRACE_H_ */
@@ -0,0 +1,293 @@
+/************************************************************************//**
+ * File: IA61x_version.c
+ *
+ * Description: IA61x build string retrieval with RAM and NVM cache
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include <asf.h>
+#include <string.h>
+#include "IA61x.h"
+#include "IA61x_version.h"
+#include "nvm_util.h"
+
+/*
+ * The firmware hands out a build string one character per BUILD_STRING_CMD2 round trip, there
+ * is no bulk read. Each string is therefore read once per program image: the RAM cache serves
+ * the rest of the session, the NVM copy keyed by the image identity serves later boots.
+ */
+static IA61x_version_record version_cache;
+
+/***************************************************************************
+ * @fn      version_record_check()
+ *
+ * @brief   Check word of a record. An erased or half written NVM row must
+ *          not pass.
+ *
+ * @param   rec     Record
+ *
+ * @retval  Check word
+ *
+ ****************************************************************************/
+static uint32_t version_record_check(const IA61x_version_record *rec)
+{
+    const uint32_t *word = (const uint32_t *)rec->entry;
+    uint32_t check = ~(rec->magic ^ rec->image_id ^ rec->count);
+    uint32_t i;
+
+    for (i = 0; i < IA61x_VERSION_SLOTS * sizeof(IA61x_version_entry) / sizeof(uint32_t); i++)
+        check = (check << 1 | check >> 31) ^ word[i];
+
+    return (check);
+}
+
+/***************************************************************************
+ * @fn      version_find()
+ *
+ * @brief   Find the cached build string of an algorithm
+ *
+ * @param   algo_id     Algorithm, 0 for the firmware
+ *
+ * @retval  Entry, NULL if not cached
+ *
+ ****************************************************************************/
+static IA61x_version_entry *version_find(uint16_t algo_id)
+{
+    uint32_t i;
+
+    for (i = 0; i < version_cache.count; i++)
+    {
+        if (version_cache.entry[i].algo_id == algo_id)
+            return (&version_cache.entry[i]);
+    }
+    return (NULL);
+}
+
+/***************************************************************************
+ * @fn      version_store()
+ *
+ * @brief   Put a build string into the RAM cache. When all slots are used
+ *          the last one is replaced.
+ *
+ * @param   entry   Build string
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void version_store(const IA61x_version_entry *entry)
+{
+    IA61x_version_entry *slot = version_find(entry->algo_id);
+
+    if (!slot)
+    {
+        if (version_cache.count < IA61x_VERSION_SLOTS)
+            version_cache.count++;
+        slot = &version_cache.entry[version_cache.count - 1];
+    }
+    *slot = *entry;
+}
+
+/***************************************************************************
+ * @fn      version_bind()
+ *
+ * @brief   Tie the RAM cache to a program image. Strings read from other
+ *          images are dropped, strings already read live from this one
+ *          are kept, the NVM copy fills in the rest.
+ *
+ * @param   image_id    Identity of the program image, 0 if unknown
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void version_bind(uint32_t image_id)
+{
+    const IA61x_version_record *saved = (const IA61x_version_record *)nvm_util_get_version();
+    uint32_t i;
+
+    if (version_cache.image_id == image_id)
+        return;
+
+    if (version_cache.image_id != 0)
+        version_cache.count = 0;
+    version_cache.image_id = image_id;
+
+    if ((image_id == 0) || (saved->magic != IA61x_VERSION_MAGIC) || (saved->image_id != image_id) ||
+        (saved->count > IA61x_VERSION_SLOTS) || (saved->check != version_record_check(saved)))
+        return;
+
+    for (i = 0; i < saved->count; i++)
+    {
+        if (!version_find(saved->entry[i].algo_id))
+            version_store(&saved->entry[i]);
+    }
+}
+
+/***************************************************************************
+ * @fn      version_save()
+ *
+ * @brief   Write the RAM cache to the NVM version row
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void version_save(void)
+{
+    if (version_cache.image_id == 0)
+        return;
+
+    version_cache.magic = IA61x_VERSION_MAGIC;
+    version_cache.check = version_record_check(&version_cache);
+
+    if (nvm_util_write_version(&version_cache, sizeof(version_cache)) != 0)
+        printf("IA61x version cache not saved\r\n");
+}
+
+/***************************************************************************
+ * @fn      version_copy()
+ *
+ * @brief   Copy a cached build string out, truncated to the buffer
+ *
+ * @param   entry   Build string
+ * @param   text    Buffer, always terminated
+ * @param   size    Size of the buffer
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+static void version_copy(const IA61x_version_entry *entry, char *text, uint32_t size)
+{
+    uint32_t length = (entry->length < size - 1) ? entry->length : size - 1;
+
+    memcpy(text, entry->text, length);
+    text[length] = 0;
+}
+
+/***************************************************************************
+ * @fn      IA61x_version_fetch()
+ *
+ * @brief   Read a build string from the running firmware and refresh the
+ *          RAM cache with it. Reads at most IA61x_VERSION_MAX characters.
+ *
+ * @param   cmd         Command function of the host interface
+ * @param   algo_id     Algorithm, 0 for the firmware
+ * @param   text        Buffer, always terminated
+ * @param   size        Size of the buffer
+ *
+ * @retval  CMD_SUCCESS Build string read
+ * @retval  CMD_FAILED  Firmware did not answer or no buffer
+ *
+ ****************************************************************************/
+int32_t IA61x_version_fetch(IA61x_version_cmd_t cmd, uint16_t algo_id, char *text, uint32_t size)
+{
+    IA61x_version_entry entry;
+    uint16_t response;
+
+    if ((text == NULL) || (size == 0))
+        return (CMD_FAILED);
+
+    entry.algo_id = algo_id;
+    entry.length = 0;
+
+    //First character with BUILD_STRING_CMD1, then subsequent characters till response is 0
+    while (entry.length < IA61x_VERSION_MAX)
+    {
+        if (cmd(entry.length ? BUILD_STRING_CMD2 : BUILD_STRING_CMD1, entry.length ? EMPTY_DATA : algo_id,
+                1, &response) != CMD_SUCCESS)
+        {
+            text[0] = 0;
+            return (CMD_FAILED);
+        }
+
+        if ((uint8_t)response == 0)
+            break;
+        entry.text[entry.length++] = (char)response;
+    }
+
+    version_store(&entry);
+    version_copy(&entry, text, size);
+
+    return (CMD_SUCCESS);
+}
+
+/***************************************************************************
+ * @fn      IA61x_version_get()
+ *
+ * @brief   Build string of the firmware or of an algorithm. Served from the
+ *          RAM cache or the NVM copy of the same program image, read from
+ *          IA61x only when neither has it.
+ *
+ * @param   IA61x       IA61x Instance handle
+ * @param   algo_id     Algorithm, 0 for the firmware
+ * @param   text        Buffer, always terminated
+ * @param   size        Size of the buffer
+ *
+ * @retval  CMD_SUCCESS Build string copied
+ * @retval  CMD_FAILED  Firmware did not answer or no buffer
+ *
+ ****************************************************************************/
+int32_t IA61x_version_get(IA61x_instance *IA61x, uint16_t algo_id, char *text, uint32_t size)
+{
+    const IA61x_version_entry *entry;
+
+    if ((text == NULL) || (size == 0))
+        return (CMD_FAILED);
+
+    version_bind(IA61x->image_id ? IA61x->image_id() : 0);
+
+    entry = version_find(algo_id);
+    if (entry)
+    {
+        version_copy(entry, text, size);
+        return (CMD_SUCCESS);
+    }
+
+    if (IA61x_version_fetch(IA61x->cmd, algo_id, text, size) != CMD_SUCCESS)
+        return (CMD_FAILED);
+
+    version_save();
+    return (CMD_SUCCESS);
+}
+
+/***************************************************************************
+ * @fn      IA61x_version_invalidate()
+ *
+ * @brief   Forget the strings read live, called when the running firmware
+ *          turned out not to be the embedded image
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_version_invalidate(void)
+{
+    version_cache.count = 0;
+    version_cache.image_id = 0;
+}
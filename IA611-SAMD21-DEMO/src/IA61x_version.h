@@ -0,0 +1,79 @@
+/************************************************************************//**
+ * File: IA61x_version.h
+ *
+ * Description: IA61x build string retrieval with RAM and NVM cache
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_VERSION_H_
+#define IA61x_VERSION_H_
+
+#include <asf.h>
+#include "IA61x.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_VERSION_MAGIC         0x53524556  //"VERS"
+#define IA61x_VERSION_MAX           64          //Longest build string kept, without the terminator
+#define IA61x_VERSION_SLOTS         2           //Build strings cached: firmware and one algorithm
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Command function of the active host interface, same as IA61x_instance.cmd */
+typedef int32_t (*IA61x_version_cmd_t)(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse);
+
+typedef struct
+{
+    uint16_t algo_id;           //Data word of BUILD_STRING_CMD1, 0 for the firmware
+    uint16_t length;            //Characters in text
+    char text[IA61x_VERSION_MAX];   //Not terminated
+} IA61x_version_entry;
+
+/* Cache of the build strings, kept in RAM and in the NVM version row */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t image_id;          //Identity of the program image the strings belong to, 0 if unknown
+    uint32_t count;             //Valid entries
+    uint32_t check;
+    IA61x_version_entry entry[IA61x_VERSION_SLOTS];
+} IA61x_version_record;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+int32_t IA61x_version_get(IA61x_instance *IA61x, uint16_t algo_id, char *text, uint32_t size);
+int32_t IA61x_version_fetch(IA61x_version_cmd_t cmd, uint16_t algo_id, char *text, uint32_t size);
+void IA61x_version_invalidate(void);
+
+#endif /* IA61x_VERSION_H_ */
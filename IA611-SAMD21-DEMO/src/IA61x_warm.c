@@ -0,0 +1,221 @@
+/************************************************************************//**
+ * File: IA61x_warm.c
+ *
+ * Description: Warm attach to an IA61x that kept running across a host reset
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#include "IA61x_config.h"
+#if defined(IA61x_WARM_ATTACH) && IA61x_WARM_ATTACH
+
+#include <asf.h>
+#include <string.h>
+#include "IA61x.h"
+#include "IA61x_warm.h"
+#include "IA61x_version.h"
+
+#define FNV_PRIME           0x01000193
+
+IA61x_NOINIT static IA61x_warm_record warm_record;
+
+static bool warm_attached = false;
+
+/***************************************************************************
+ * @fn      warm_record_check()
+ *
+ * @brief   Check word of the record. RAM content after a power on reset is
+ *          random, so magic and check word must both match.
+ *
+ * @param   rec     Record
+ *
+ * @retval  Check word
+ *
+ ****************************************************************************/
+static uint32_t warm_record_check(const IA61x_warm_record *rec)
+{
+    return ~(rec->magic ^ rec->image_id ^ rec->build_hash ^ rec->link_rate);
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_hash()
+ *
+ * @brief   FNV-1a hash, used to identify images and build strings
+ *
+ * @param   data    Bytes to hash
+ * @param   size    Number of bytes
+ * @param   hash    IA61x_WARM_HASH_INIT to start, previous result to continue
+ *
+ * @retval  Hash value
+ *
+ ****************************************************************************/
+uint32_t IA61x_warm_hash(const uint8_t *data, uint32_t size, uint32_t hash)
+{
+    while (size--)
+    {
+        hash ^= *data++;
+        hash *= FNV_PRIME;
+    }
+
+    return (hash);
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_build_hash()
+ *
+ * @brief   Read the firmware build string and hash it. The string is kept
+ *          in the version cache, so printing it later costs no commands.
+ *
+ * @param   cmd     Command function of the host interface
+ * @param   hash    Hash of the build string
+ *
+ * @retval  CMD_SUCCESS     Build string read
+ * @retval  CMD_FAILED      Firmware did not answer
+ *
+ ****************************************************************************/
+int32_t IA61x_warm_build_hash(IA61x_warm_cmd_t cmd, uint32_t *hash)
+{
+    char text[IA61x_VERSION_MAX + 1];
+
+    if ((IA61x_version_fetch(cmd, EMPTY_DATA, text, sizeof(text)) != CMD_SUCCESS) || (text[0] == 0))
+        return (CMD_FAILED);
+
+    *hash = IA61x_warm_hash((const uint8_t *)text, strlen(text), IA61x_WARM_HASH_INIT);
+    return (CMD_SUCCESS);
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_check()
+ *
+ * @brief   Check whether the previous boot left a running IA61x with the
+ *          program image this host firmware embeds
+ *
+ * @param   image_id    Identity of the embedded program image
+ * @param   link_rate   Set to the link rate the running IA61x uses
+ *
+ * @retval  true    Worth probing the IA61x
+ * @retval  false   Cold boot required
+ *
+ ****************************************************************************/
+bool IA61x_warm_check(uint32_t image_id, uint32_t *link_rate)
+{
+    warm_attached = false;
+
+    if ((warm_record.magic != IA61x_WARM_MAGIC) || (warm_record.check != warm_record_check(&warm_record)))
+        return (false);
+
+    if (warm_record.image_id != image_id)
+        return (false);
+
+    *link_rate = warm_record.link_rate;
+    return (true);
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_confirm()
+ *
+ * @brief   Compare the build string of the live firmware with the record.
+ *          Call once the link answers Sync.
+ *
+ * @param   cmd     Command function of the host interface
+ *
+ * @retval  true    Running firmware is reused
+ * @retval  false   Cold boot required
+ *
+ ****************************************************************************/
+bool IA61x_warm_confirm(IA61x_warm_cmd_t cmd)
+{
+    uint32_t hash;
+
+    warm_attached = (IA61x_warm_build_hash(cmd, &hash) == CMD_SUCCESS) && (hash == warm_record.build_hash);
+    if (!warm_attached)
+        IA61x_version_invalidate();     //Not the embedded image, its strings are stale
+
+    return (warm_attached);
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_commit()
+ *
+ * @brief   Record a successful cold boot so the next host reset can attach
+ *
+ * @param   cmd         Command function of the host interface
+ * @param   image_id    Identity of the downloaded program image
+ * @param   link_rate   Link rate in use
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_warm_commit(IA61x_warm_cmd_t cmd, uint32_t image_id, uint32_t link_rate)
+{
+    uint32_t hash;
+
+    IA61x_warm_invalidate();
+
+    if (IA61x_warm_build_hash(cmd, &hash) != CMD_SUCCESS)
+        return;
+
+    warm_record.image_id   = image_id;
+    warm_record.build_hash = hash;
+    warm_record.link_rate  = link_rate;
+    warm_record.magic      = IA61x_WARM_MAGIC;
+    warm_record.check      = warm_record_check(&warm_record);
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_invalidate()
+ *
+ * @brief   Forget the record, called before IA61x is power cycled
+ *
+ * @param   none
+ *
+ * @retval  none
+ *
+ ****************************************************************************/
+void IA61x_warm_invalidate(void)
+{
+    warm_record.magic = 0;
+    warm_attached = false;
+}
+
+/***************************************************************************
+ * @fn      IA61x_warm_attached()
+ *
+ * @brief   True if IA61x_init attached to running firmware. Config, program
+ *          and route setup are then skipped.
+ *
+ * @param   none
+ *
+ * @retval  true if the running firmware was reused
+ *
+ ****************************************************************************/
+bool IA61x_warm_attached(void)
+{
+    return (warm_attached);
+}
+
+#endif /* IA61x_WARM_ATTACH */
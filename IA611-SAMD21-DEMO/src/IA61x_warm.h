@@ -0,0 +1,81 @@
+/************************************************************************//**
+ * File: IA61x_warm.h
+ *
+ * Description: Warm attach to an IA61x that kept running across a host reset
+ *
+ * Copyright 2018 Knowles Corporation. All rights reserved.
+ *
+ * All information, including software, contained herein is and remains
+ * the property of Knowles Corporation. The intellectual and technical
+ * concepts contained herein are proprietary to Knowles Corporation
+ * and may be covered by U.S. and foreign patents, patents in process,
+ * and/or are protected by trade secret and/or copyright law.
+ * This information may only be used in accordance with the applicable
+ * Knowles SDK License. Dissemination of this information or distribution
+ * of this material is strictly forbidden unless in accordance with the
+ * applicable Knowles SDK License.
+ *
+ *
+ * KNOWLES SOURCE CODE IS STRICTLY PROVIDED "AS IS" WITHOUT ANY WARRANTY
+ * WHATSOEVER, AND KNOWLES EXPRESSLY DISCLAIMS ALL WARRANTIES,
+ * EXPRESS, IMPLIED OR STATUTORY WITH REGARD THERETO, INCLUDING THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, TITLE OR NON-INFRINGEMENT OF THIRD PARTY RIGHTS. KNOWLES
+ * SHALL NOT BE LIABLE FOR ANY DAMAGES SUFFERED BY YOU AS A RESULT OF
+ * USING, MODIFYING OR DISTRIBUTING THIS SOFTWARE OR ITS DERIVATIVES.
+ * IN CERTAIN STATES, THE LAW MAY NOT ALLOW KNOWLES TO DISCLAIM OR EXCLUDE
+ * WARRANTIES OR DISCLAIM DAMAGES, SO THE ABOVE DISCLAIMERS MAY NOT APPLY.
+ * IN SUCH EVENT, KNOWLES' AGGREGATE LIABILITY SHALL NOT EXCEED
+ * FIFTY DOLLARS ($50.00).
+ *
+ ****************************************************************************/
+
+#ifndef IA61x_WARM_H_
+#define IA61x_WARM_H_
+
+#include <asf.h>
+#include "IA61x_config.h"
+#include "IA61x_noinit.h"
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    C O N S T A N T S   &   M A C R O S
+\*-------------------------------------------------------------------------------------------------*/
+
+#define IA61x_WARM_MAGIC            0x5741524D  //"WARM"
+#define IA61x_WARM_HASH_INIT        0x811C9DC5  //FNV-1a offset basis
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    T Y P E   D E F I N I T I O N S
+\*-------------------------------------------------------------------------------------------------*/
+
+/* Command function of the active host interface, same as IA61x_instance.cmd */
+typedef int32_t (*IA61x_warm_cmd_t)(uint16_t cmdWord, uint16_t dataWord, uint32_t timeout, uint16_t *pResponse);
+
+/* Written after a cold boot, kept in .noinit */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t image_id;          //Identity of the downloaded program image
+    uint32_t build_hash;        //Hash of the build string the firmware reported
+    uint32_t link_rate;         //UART baud rate or SPI clock in use
+    uint32_t check;
+} IA61x_warm_record;
+
+/*-------------------------------------------------------------------------------------------------*\
+ |    F U N C T I O N   P R O T O T Y P E S
+\*-------------------------------------------------------------------------------------------------*/
+
+#if defined(IA61x_WARM_ATTACH) && IA61x_WARM_ATTACH
+uint32_t IA61x_warm_hash(const uint8_t *data, uint32_t size, uint32_t hash);
+int32_t IA61x_warm_build_hash(IA61x_warm_cmd_t cmd, uint32_t *hash);
+
+bool IA61x_warm_check(uint32_t image_id, uint32_t *link_rate);
+bool IA61x_warm_confirm(IA61x_warm_cmd_t cmd);
+void IA61x_warm_commit(IA61x_warm_cmd_t cmd, uint32_t image_id, uint32_t link_rate);
+void IA61x_warm_invalidate(void);
+bool IA61x_warm_attached(void);
+#else
+#define IA61x_warm_attached()       (false)
+#endif
+
+#endif /* IA61x_WARM_H_ */
@@ -36,6 +36,20 @@
 #include <string.h>
 #include "IA61x.h"
 #include "nvm_util.h"
+#include "IA61x_samd21_dma.h"
+#include "IA61x_warm.h"
+#include "IA61x_profile.h"
+#include "IA61x_version.h"
+#include "IA61x_param.h"
+#include "IA61x_trace.h"
+#include "IA61x_event.h"
+#include "IA61x_latency.h"
+#ifdef IA61x_SAMD21_VQ_UART
+#include "IA61x_samd21_VQ_uart.h"
+#endif
+#ifdef IA61x_SAMD21_VQ_SPI
+#include "IA61x_samd21_VQ_spi.h"
+#endif
 
 #include "trill_host.h"
 #include "provision.h"
@@ -45,6 +59,12 @@
 #define KEYWORD1            "Hello VoiceQ:"
 
 #define MAX_RDB_BLOCK_SIZE (TRILL_BLOCK_HEADER_LEN + TRILL_HOST_MAX_PAYLOAD_SIZE + 4) // + padding
+#define RDB_SLOT_SIZE      ((MAX_RDB_BLOCK_SIZE + 3) & ~3) // rdb buffers are 32 bit aligned
+#if IA61x_RDB_DRAIN
+#define RDB_SLOTS          IA61x_RDB_DRAIN
+#else
+#define RDB_SLOTS          1
+#endif
 
 #define COMPILE_TIME_LICENSE "copy-paste license string here."
 
@@ -61,7 +81,7 @@
 	"-- Compiled: "__DATE__ " "__TIME__ " --"EOL
 
 
-static uint8_t payload_buffer[MAX_RDB_BLOCK_SIZE];
+static uint8_t payload_buffer[RDB_SLOTS * RDB_SLOT_SIZE] __attribute__((aligned(4)));
 /** UART module for debug. */
 static struct usart_module cdc_uart_module;
 
@@ -75,6 +95,43 @@ static int provision_host(void);
 #endif
 static int start_sdk(const char* license);
 
+#if (defined(IA61x_SAMD21_VQ_SPI) && IA61x_SPI_USE_DMA) || (defined(IA61x_SAMD21_VQ_UART) && IA61x_FW_COMPRESSED) || \
+    (defined(IA61x_SAMD21_VQ_I2C) && IA61x_I2C_USE_DMA)
+/* DMA channel of the images on the bound interface */
+#define DOWNLOAD_DMA_CHANNEL    ((IA61x_host() == IA61x_HOST_SPI) ? IA61x_DMA_CH_SPI_TX : \
+                                 (IA61x_host() == IA61x_HOST_I2C) ? IA61x_DMA_CH_I2C_TX : IA61x_DMA_CH_UART_TX)
+/***************************************************************************
+ * @fn          print_download_report
+ *
+ * @brief       Print byte count and throughput of the DMA transfers since
+ *              the previous report. Compressed images are sent as several
+ *              blocks, so the channel totals are used.
+ *
+ * @param       image   Name of the downloaded image
+ *
+ * @retval      none
+ *
+ ****************************************************************************/
+static void print_download_report(const char *image)
+{
+    static uint32_t reported_bytes = 0;
+    static uint32_t reported_us = 0;
+    IA61x_dma_stats stats;
+    uint32_t bytes, us;
+
+    IA61x_dma_get_stats(DOWNLOAD_DMA_CHANNEL, &stats);
+    bytes = stats.total_bytes - reported_bytes;
+    us = stats.total_us - reported_us;
+    reported_bytes = stats.total_bytes;
+    reported_us = stats.total_us;
+
+    printf("%s: %lu bytes, %lu us bus time (%lu KB/s)\r\n", image,
+           bytes, us, us ? (bytes * 1000UL) / us : 0);
+}
+#else
+#define print_download_report(image)
+#endif
+
 /**Initialize EDBG UART port**/
 void samd21_vcp_uart_init(void);
 
@@ -168,18 +225,19 @@ static void getAlgorithmParamInfo(IA61x_instance *IA61x)
 {
     uint16_t pResponse;
 
+    //Values the host set or read before come from the parameter shadow
 #if  IA611_VOICE_ID
-    IA61x->cmd(GET_ALGO_PARAM,VID_SENSITIVITY_PARAM,1, &pResponse);
+    IA61x_param_get(VID_SENSITIVITY_PARAM, &pResponse);
     printf("Voice ID Detection Sensitivity:  %2x\r\n", pResponse);
 #elif   IA611_UTK
-    IA61x->cmd(GET_ALGO_PARAM,UTK_SENSITIVITY_PARAM,1, &pResponse);
+    IA61x_param_get(UTK_SENSITIVITY_PARAM, &pResponse);
     printf("UTK Keyword Detection Sensitivity:  %2x\r\n", pResponse);
 #else
-    IA61x->cmd(GET_ALGO_PARAM,OEM_SENSITIVITY_PARAM,1, &pResponse);
+    IA61x_param_get(OEM_SENSITIVITY_PARAM, &pResponse);
     printf("OEM Keyword Detection Sensitivity:  %2x\r\n", pResponse);
 #endif
 
-    IA61x->cmd(GET_DIGITAL_GAIN,END_POINT_ID,1, &pResponse);
+    IA61x_param_get_gain(END_POINT_ID, &pResponse);
     printf("Digital Gain:  %d db\r\n", pResponse);
 
 
@@ -197,61 +255,142 @@ static void getAlgorithmParamInfo(IA61x_instance *IA61x)
  ****************************************************************************/
 void HW_Error( void )
 {
+    IA61x_trace_print();
     printf("HW Error: Reset the board to recover\r\n");
     while (1) ;
 }
 
+#if defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE
+/***************************************************************************
+ * @fn          trace_write
+ *
+ * @brief       Bus trace export sink, raw bytes to the EDBG UART console
+ *
+ * @param       data    Bytes to send
+ * @param       size    Number of bytes
+ *
+ * @retval      0 on success, -1 otherwise
+ *
+ ****************************************************************************/
+static int trace_write(const uint8_t *data, uint32_t size)
+{
+    uint16_t len;
+
+    while (size)
+    {
+        len = (size > 0xFFFF) ? 0xFFFF : (uint16_t)size;
+        if (usart_write_buffer_wait(&cdc_uart_module, data, len) != STATUS_OK)
+            return (-1);
+        data += len;
+        size -= len;
+    }
+
+    return (0);
+}
+#endif /* IA61x_BUS_TRACE */
+
+#if (defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE) || (defined(IA61x_LATENCY_HIST) && IA61x_LATENCY_HIST)
+/***************************************************************************
+ * @fn          console_poll
+ *
+ * @brief       Serve a bus trace or latency command typed on the EDBG UART
+ *              console, without waiting if none is pending:
+ *              t   print the trace
+ *              b   export the trace as binary (IA61x_trace_header)
+ *              c   clear the trace
+ *              l   print the latency percentiles
+ *              z   clear the latency histograms
+ *
+ * @param       none
+ *
+ * @retval      none
+ *
+ ****************************************************************************/
+static void console_poll(void)
+{
+    uint16_t key;
+
+    if (usart_read_wait(&cdc_uart_module, &key) != STATUS_OK)
+        return;
+
+    switch (key)
+    {
+#if defined(IA61x_BUS_TRACE) && IA61x_BUS_TRACE
+        case 't':
+            IA61x_trace_print();
+            break;
+        case 'b':
+            IA61x_trace_export(trace_write);
+            break;
+        case 'c':
+            IA61x_trace_clear();
+            printf("Bus trace cleared\r\n");
+            break;
+#endif
+#if defined(IA61x_LATENCY_HIST) && IA61x_LATENCY_HIST
+        case 'l':
+            IA61x_lat_print();
+            break;
+        case 'z':
+            IA61x_lat_clear();
+            printf("Latency histograms cleared\r\n");
+            break;
+#endif
+        default:
+            break;
+    }
+}
+#else
+#define console_poll()
+#endif
+
 /****************************************************************************************************
  * @fn      VersionStringCmd
- *          Helper routine for reading version string (0x8020/0x8021) from IA61x device
+ *          Helper routine for reading version string (0x8020/0x8021) from IA61x device. The strings
+ *          are cached per program image (IA61x_version.h), so IA61x is only asked once.
  *
  * @param   IA61x    : IA61x Instance handle
  * @param   pBuffer  : Buffer to store Version String
  * @param   bufferSz : Size of Buffer
  *
- * @return  Returns CMD_SUCCESS on success, CMD_FAILED/CMD_TIMEOUT on failed cases.
+ * @return  Returns CMD_SUCCESS on success, CMD_FAILED on failed cases.
  ***************************************************************************************************/
 static int32_t VersionStringCmd(IA61x_instance *IA61x, uint8_t *pBuffer, uint8_t bufferSz, uint16_t algo_id)
 {
     int32_t     result  = 0;
-    uint16_t    resp    = 0;
-    uint8_t     i       = 0;
 
     if((pBuffer == NULL) | (bufferSz <= 0))
         return (ERROR);
 
-    /* Clear buffer */
-    memset(pBuffer, 0, bufferSz);
-
-    /* Send the build string command to get first character */
-    result = IA61x->cmd(BUILD_STRING_CMD1,algo_id,1, &resp);
+    result = IA61x_version_get(IA61x, algo_id, (char *)pBuffer, bufferSz);
     if (result != CMD_SUCCESS)
-    {
         printf("Version CMD Failed!!\r\n");
-        return result;
-    }
-
-    pBuffer[i++] = (uint8_t)resp;
-    bufferSz--;
-
-    /* Get subsequent characters till response is 0 */
-    do
-    {
-        result = IA61x->cmd(BUILD_STRING_CMD2,EMPTY_DATA,1, &resp);
-        pBuffer[i++] = (uint8_t)resp;
-        bufferSz--;
-    } while ( (resp != 0) && (result == CMD_SUCCESS) && (bufferSz > 0) );
-
-    /* Ensure last character in buffer is null terminator (in case buffer was smaller than version string) */
-    if (bufferSz == 0)
-    {
-        i--;
-        pBuffer[i] = 0;
-    }
 
     return result;
 }
 
+/****************************************************************************************************
+ * @fn      print_payload
+ *          Print the payload of a data block read from the Trillbit IA61x Algorithm
+ *
+ * @param   block    : Data block
+ * @param   size     : Bytes read, blocks of a byte or less carry no payload
+ *
+ * @return  none
+ ***************************************************************************************************/
+static void print_payload(const uint8_t *block, uint32_t size)
+{
+    if (size <= 1)
+        return;
+
+    size = block[TRILL_BLOCK_PAYLOAD_LEN_INDEX] + 1;
+    printf("Payload (%lu): %.*s\n", 
+        size, 
+        (int)size, 
+        &block[TRILL_BLOCK_PAYLOAD_INDEX]);
+    IA61x_LATENCY_MARK(IA61x_LAT_PAYLOAD);
+}
+
 static int uart_tx_api(void* drv, const char* buf, unsigned int size)
 {
     enum status_code status;
@@ -376,34 +515,93 @@ int main (void)
     IA61x_instance *IA61x;
     int32_t ret;
     //uint16_t pResponse;
-    uint8_t versionstring[50];
+    uint8_t versionstring[IA61x_VERSION_MAX + 1];
 	uint32_t rpt_count = 0;
     const char* stored_lic;
 
     /* Initialize the board. */
     system_init();
 
+    /*Start the boot timeline and the bus trace, both need the clocks set up by system_init*/
+    IA61x_prof_start();
+    IA61x_trace_start();
+
     /*Initialize the system clock tick counter for delay*/
     delay_init();
+    IA61x_PROFILE_MARK(IA61x_PROF_DELAY_INIT, 0);
 
     /*Configure LED0 on SAMD21 Xplained Pro board*/
     config_led();
 
     /*Initialize Debug UART port to enable the debug prints*/
     samd21_vcp_uart_init();
+    IA61x_PROFILE_MARK(IA61x_PROF_CONSOLE_INIT, 0);
 
 	nvm_util_init();
+    IA61x_PROFILE_MARK(IA61x_PROF_NVM_INIT, 0);
 
     /**printf function uses the Virtual com port of the SAMD21 Xplained pro.
     Debug USB port will be detected as virtual com port on the PC. Baudrate is set to 115200**/
     printf(EOL);
 	printf(HEADER_STRING);
-    printf(IA61X_HOST_INTERFACE);
 	printf(EOL);
     
     /* Insert application code here, after the board has been initialized. */
 	printf("MCU/Device ID: %s\n\n", trill_host_get_id());
+
+#if defined(IA61x_PARAM_SELFTEST) && IA61x_PARAM_SELFTEST
+    if (!IA61x_param_selftest())
+        printf("IA61x parameter shadow self-test FAILED\r\n");
+#endif
 	
+    /**Initialize SAMD21 USART port and Boot IA61x.
+    IA61x auto detects the UART interface.
+    Set UART baudrate.  Download the Config file **/
+    IA61x = IA61x_init(); /**Returns IA61x interface instance to access API functions**/
+	if (IA61x == NULL)
+	{
+		HW_Error(); //If failed to create the IA61x interface handle then jump to error loop and wait for HW reset.
+	}
+    IA61x_PROFILE_MARK(IA61x_PROF_IA61x_INIT, IA61x_warm_attached());
+    printf("-- IA61x Host Interface: %s --\r\n", IA61x_host_name());
+#ifdef IA61x_SAMD21_VQ_UART
+    if (IA61x_host() == IA61x_HOST_UART)
+        printf("IA61x UART Baud Rate: %lu\r\n", IA61x_samd21_vq_uart_baud());
+#endif
+
+
+    if (IA61x_warm_attached())
+    {
+        printf("IA61x Warm Attach: running firmware reused.\r\n");
+#ifdef IA61x_SAMD21_VQ_SPI
+        if (IA61x_host() == IA61x_HOST_SPI)
+            printf("IA61x SPI Clock: %lu\r\n", IA61x_samd21_vq_spi_sclk());
+#endif
+    }
+    else
+    {
+        ret = IA61x->download_config(); /**Download IA61x Firmvare binary**/
+        IA61x_PROFILE_MARK(IA61x_PROF_CONFIG, ret);
+        if (ret != CMD_SUCCESS)
+        {
+
+            printf("Error: Config Download Failed!!!\r\n");
+            HW_Error();
+        }
+        else
+        {
+            printf("IA61x Config file Downloaded.\r\n");
+            print_download_report("Config");
+        }
+
+        /*Firmware streams to IA61x while the Trillbit Host SDK starts, when the interface supports it*/
+        if (IA61x->download_start && (IA61x->download_start() != CMD_SUCCESS))
+        {
+            printf("Error: Firmware Download Failed!!!\r\n");
+            HW_Error();
+        }
+    }
+
 #ifndef USE_COMPILE_TIME_LICENSE
 	stored_lic = nvm_util_get_lic();
 	if (stored_lic[0] == 0xff)
@@ -441,51 +639,53 @@ int main (void)
 			}
 		}
 	}
-	
-    /**Initialize SAMD21 USART port and Boot IA61x.
-    IA61x auto detects the UART interface.
-    Set UART baudrate.  Download the Config file **/
-    IA61x = IA61x_init(); /**Returns IA61x interface instance to access API functions**/
-	if (IA61x == NULL)
-	{
-		HW_Error(); //If failed to create the IA61x interface handle then jump to error loop and wait for HW reset.
-	}
+    IA61x_PROFILE_MARK(IA61x_PROF_SDK_INIT, 0);
 
-    
-    ret = IA61x->download_config(); /**Download IA61x Firmvare binary**/
-    if (ret != CMD_SUCCESS)
-    {
-
-        printf("Error: Config Download Failed!!!\r\n");
-        HW_Error();
-    }
-    else
+    if (!IA61x_warm_attached())
     {
-        printf("IA61x Config file Downloaded.\r\n");
-    }
-
-    ret = IA61x->download_program(); /**Download IA61x Firmvare binary**/
-    if (ret != SYNC_RESP_NORM)
-    {
-        printf("Error: Firmware Download Failed!!!\r\n");
-        HW_Error();
+        if (IA61x->download_start)
+            ret = IA61x->download_finish(); /**Wait for the Firmware started before the SDK**/
+        else
+            ret = IA61x->download_program(); /**Download IA61x Firmvare binary**/
+        IA61x_PROFILE_MARK(IA61x_PROF_PROGRAM, ret);
+        if (ret != SYNC_RESP_NORM)
+        {
+            printf("Error: Firmware Download Failed!!!\r\n");
+            HW_Error();
+        }
+        else
+        {
+            printf("IA61x Firmware Downloaded.\r\n");
+            print_download_report("Firmware");
+#ifdef IA61x_SAMD21_VQ_SPI
+            if (IA61x_host() == IA61x_HOST_SPI)
+                printf("IA61x SPI Clock: %lu\r\n", IA61x_samd21_vq_spi_sclk());
+#endif
+        }
     }
-    else printf("IA61x Firmware Downloaded.\r\n");
 		
-	if(IA61x->VoiceWake())       // Stop --> Set --> Restart the route
+	if(IA61x->rearm())           // Stop --> Set --> Restart the route, state is not known yet
         HW_Error();         //if error then jump to HW error loop
+    IA61x_PROFILE_MARK(IA61x_PROF_VOICEWAKE, 0);
     printf("IA61x Route Setup Completed.\r\n");
 		
 	config_outClk();
+    IA61x_PROFILE_MARK(IA61x_PROF_OUTCLK, 0);
 	printf("IA61x External Clock Started.\r\n");
 		
 	//Print IA61x Firmware version information
     printf(EOL);
 	ret = VersionStringCmd(IA61x, versionstring, sizeof(versionstring), TRILL_IA61x_ALGO_ID);
+    IA61x_PROFILE_MARK(IA61x_PROF_VERSION_ALGO, ret);
 	printf("Trillbit IA61x Algorithm Version: %s\r\n",versionstring);
 	ret = VersionStringCmd(IA61x, versionstring, sizeof(versionstring), 0);
+    IA61x_PROFILE_MARK(IA61x_PROF_VERSION_FW, ret);
 	printf("Knowles IA61x Firmware Version: %s\r\n",versionstring);
 	printf(EOL);
+
+    IA61x_PROFILE_MARK(IA61x_PROF_READY, 0);
+    IA61x_prof_print();
+    printf(EOL);
         
     printf("Host is ready for authentication. Waiting for IA61x...\r\n");
     blink_led(1);
@@ -493,6 +693,10 @@ int main (void)
 	while (1)
     {
         uint32_t buf_size;
+        static uint32_t events_lost = 0;
+#if defined(IA61x_SAMD21_VQ_UART) && IA61x_UART_RX_RING
+        static uint32_t uart_lost = 0;
+#endif
 		
 		int kw = IA61x->wait_keyword(WAIT_KWD_DELAY); 
 		
@@ -519,6 +723,7 @@ int main (void)
                         printf("download_keyword failed = %ld\n", ret);
                         break;
                     }
+                    IA61x_LATENCY_MARK(IA61x_LAT_KEYWORD);
                 }
                 break;
             case TRILL_KW_HOST_AUTH_PASS:
@@ -527,17 +732,30 @@ int main (void)
 				blink_led(4);
                 break;
             case TRILL_KW_PAYLOAD_AVAILABLE:
-                buf_size = MAX_RDB_BLOCK_SIZE;
                 printf("%lu) %s", ++rpt_count, WAKE_KWD_STRING);
-                ret = IA61x->rdb(TRILL_IA61x_ALGO_ID, 1, payload_buffer, &buf_size);
-                if ((ret == 0) && (buf_size > 1))
+#if IA61x_RDB_DRAIN
+            {
+                //Read every block queued behind this event, before detection is resumed
+                IA61x_rdb_block blocks[IA61x_RDB_DRAIN];
+                uint32_t i, count;
+
+                for (i = 0; i < IA61x_RDB_DRAIN; i++)
                 {
-                    buf_size = payload_buffer[TRILL_BLOCK_PAYLOAD_LEN_INDEX] + 1;
-                    printf("Payload (%lu): %.*s\n", 
-                        buf_size, 
-                        (int)buf_size, 
-                        &payload_buffer[TRILL_BLOCK_PAYLOAD_INDEX]);
+                    blocks[i].data = &payload_buffer[i * RDB_SLOT_SIZE];
+                    blocks[i].size = RDB_SLOT_SIZE;
                 }
+                ret = IA61x->rdb_drain(TRILL_IA61x_ALGO_ID, 1, blocks, IA61x_RDB_DRAIN, &count);
+                for (i = 0; i < count; i++)
+                    print_payload(blocks[i].data, blocks[i].size);
+                if (ret != 0)
+                    printf("rdb_drain failed = %ld\n", ret);
+            }
+#else
+                buf_size = MAX_RDB_BLOCK_SIZE;
+                ret = IA61x->rdb(TRILL_IA61x_ALGO_ID, 1, payload_buffer, &buf_size);
+                if (ret == 0)
+                    print_payload(payload_buffer, buf_size);
+#endif
                 break;
 			case NO_KWD_DETECTED:
 				break;
@@ -546,10 +764,41 @@ int main (void)
                 break;
         }
 			
-        if (kw != 0)
+        if (kw == TRILL_KW_HOST_AUTH_NEEDED)
 		{
-			IA61x->VoiceWake(); //Reset the route and wait for wake keyword
+			//Keyword data was downloaded, reset the route and wait for wake keyword
+			IA61x_param_invalidate();   //Forces the full VoiceWake in rearm
+			if (IA61x->rearm())
+				HW_Error();
 		}
+        else if (kw != 0)
+		{
+			//Resume detection, the full VoiceWake unless an armed preset can be repeated
+			if (IA61x->rearm())
+				HW_Error();
+		}
+
+        if (kw != 0)
+        {
+            IA61x_LATENCY_MARK(IA61x_LAT_REARM);
+            IA61x_LATENCY_END((kw == TRILL_KW_PAYLOAD_AVAILABLE) ? IA61x_LAT_EV_PAYLOAD :
+                              (kw == TRILL_KW_HOST_AUTH_NEEDED) ? IA61x_LAT_EV_AUTH : IA61x_LAT_EV_OTHER);
+        }
+
+        if (IA61x_event_overruns() != events_lost)
+        {
+            events_lost = IA61x_event_overruns();
+            printf("IA61x events lost: %lu\r\n", events_lost);
+        }
+#if defined(IA61x_SAMD21_VQ_UART) && IA61x_UART_RX_RING
+        if (IA61x_samd21_vq_uart_rx_overruns() != uart_lost)
+        {
+            uart_lost = IA61x_samd21_vq_uart_rx_overruns();
+            printf("IA61x UART bytes lost: %lu\r\n", uart_lost);
+        }
+#endif
+
+        console_poll(); //Bus trace and latency commands, between events
     } //while (1)
     
     return (SUCCESS);
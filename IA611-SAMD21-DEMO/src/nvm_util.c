@@ -10,6 +10,8 @@
 #define LICENSE_ROW1			LICENSE_PAGE_ADDRESS
 #define LICENSE_ROW2			(1023 * NVMCTRL_ROW_PAGES * NVMCTRL_PAGE_SIZE)
 #define N_ROWS					((LICENSE_MAX_SIZE / NVMCTRL_PAGE_SIZE) / NVMCTRL_ROW_PAGES)
+// IA61x build string cache = 1 Row, just below the license
+#define VERSION_ROW_ADDRESS		(1021 * NVMCTRL_ROW_PAGES * NVMCTRL_PAGE_SIZE)
 
 static unsigned long rows[] = {
 		LICENSE_ROW1,
@@ -41,28 +43,10 @@ const char* nvm_util_get_lic(void)
 	return (const char*) (FLASH_ADDR + LICENSE_PAGE_ADDRESS);
 }
 
-int nvm_util_write_lic(char* buf, unsigned int size)
+static int nvm_util_write_pages(unsigned long address, const char* buf, unsigned int size)
 {
-	if ((!size) ||
-		(size > LICENSE_MAX_SIZE))
-	{
-		return -1;
-	}
-		
-	
 	enum status_code error_code;
 	
-	for (int i = 0; i < N_ROWS; i++)
-	{
-		do
-		{
-			error_code = nvm_erase_row(rows[i]);
-		} while (error_code == STATUS_BUSY);
-	
-		if (error_code != STATUS_OK)
-			return -1;
-	}
-	
 	unsigned int n_pages = size / NVMCTRL_PAGE_SIZE;
 	if ((size % NVMCTRL_PAGE_SIZE) != 0)
 	{
@@ -81,7 +65,7 @@ int nvm_util_write_lic(char* buf, unsigned int size)
 		do
 		{
 			error_code = nvm_write_buffer(
-					LICENSE_PAGE_ADDRESS + (i*NVMCTRL_PAGE_SIZE),
+					address + (i*NVMCTRL_PAGE_SIZE),
 					(const unsigned char*)&buf[(i*NVMCTRL_PAGE_SIZE)],
 					write_size);
 		} while (error_code == STATUS_BUSY);
@@ -95,3 +79,53 @@ int nvm_util_write_lic(char* buf, unsigned int size)
 	return 0;
 }
 
+int nvm_util_write_lic(char* buf, unsigned int size)
+{
+	if ((!size) ||
+		(size > LICENSE_MAX_SIZE))
+	{
+		return -1;
+	}
+		
+	
+	enum status_code error_code;
+	
+	for (int i = 0; i < N_ROWS; i++)
+	{
+		do
+		{
+			error_code = nvm_erase_row(rows[i]);
+		} while (error_code == STATUS_BUSY);
+	
+		if (error_code != STATUS_OK)
+			return -1;
+	}
+	
+	return nvm_util_write_pages(LICENSE_PAGE_ADDRESS, buf, size);
+}
+
+const void* nvm_util_get_version(void)
+{
+	return (const void*) (FLASH_ADDR + VERSION_ROW_ADDRESS);
+}
+
+int nvm_util_write_version(const void* buf, unsigned int size)
+{
+	if ((!size) ||
+		(size > VERSION_MAX_SIZE))
+	{
+		return -1;
+	}
+	
+	enum status_code error_code;
+	
+	do
+	{
+		error_code = nvm_erase_row(VERSION_ROW_ADDRESS);
+	} while (error_code == STATUS_BUSY);
+	
+	if (error_code != STATUS_OK)
+		return -1;
+	
+	return nvm_util_write_pages(VERSION_ROW_ADDRESS, (const char*)buf, size);
+}
@@ -11,9 +11,13 @@
 
 // multiple of NVM flash page size
 #define LICENSE_MAX_SIZE	512
+// one NVM row
+#define VERSION_MAX_SIZE	256
 
 void nvm_util_init(void);
 const char* nvm_util_get_lic(void);
 int nvm_util_write_lic(char* buf, unsigned int size);
+const void* nvm_util_get_version(void);
+int nvm_util_write_version(const void* buf, unsigned int size);
 
 #endif /* NVM_UTIL_H_ */
\ No newline at end of file